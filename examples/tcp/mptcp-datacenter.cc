@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This example compares Multipath TCP with coupled congestion control
+// against single-path DCTCP on a fabric with two parallel planes.
+//
+// The topology is roughly as follows
+//
+//            +---- A0 ===== A1 ----+            (plane A)
+//            |     |         |     |
+//  S1..Sn ---+   C1..Cm    D1..Dm  +--- R1..Rn
+//            |                     |
+//            +---- B0 ===== B1 ----+            (plane B)
+//
+// Each sender Si and each receiver Ri is dual-homed: it has one interface
+// on plane A and one on plane B.  The core links A0-A1 and B0-B1 are the
+// bottlenecks; their RED queues mark packets with ECN.  The cross-traffic
+// senders Cj are attached to plane A only and send single-path DCTCP
+// traffic to Dj, so that plane A is more loaded than plane B.
+//
+// Each Si sends a bulk transfer to Ri using the transport selected with
+// --transport:
+// * mptcp-lia, mptcp-olia, mptcp-dctcp: an MPTCP connection with the
+//   full-mesh path manager and the given coupled congestion control;
+// * dctcp: a single-path DCTCP connection, which follows plane A.
+//
+// After a convergence period, the program reports the goodput of each
+// flow during the measurement window, Jain's fairness index of the
+// Si flows, and the goodput of the cross traffic.  Multipath flows are
+// expected to move their traffic to the less loaded plane B.
+// Sample usage:  ./waf --run 'mptcp-datacenter --transport=mptcp-olia'
+
+#include <iostream>
+#include <iomanip>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MptcpDatacenter");
+
+/// Bytes received by each sink during the measurement window
+std::vector<uint64_t> rxBytes;
+
+void
+TraceSink (std::size_t index, Ptr<const Packet> p, const Address& a)
+{
+  rxBytes[index] += p->GetSize ();
+}
+
+void
+InitializeCounters (void)
+{
+  std::fill (rxBytes.begin (), rxBytes.end (), 0);
+}
+
+void
+PrintResults (Time measurementWindow, uint32_t nFlows, uint32_t nCross)
+{
+  double window = measurementWindow.GetSeconds ();
+  double sum = 0;
+  double sumSquares = 0;
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      double goodput = rxBytes[i] * 8 / window / 1e6;
+      std::cout << "S" << i + 1 << "-R" << i + 1 << " goodput: "
+                << std::fixed << std::setprecision (2) << goodput << " Mbps" << std::endl;
+      sum += goodput;
+      sumSquares += goodput * goodput;
+    }
+  double crossSum = 0;
+  for (uint32_t j = 0; j < nCross; j++)
+    {
+      crossSum += rxBytes[nFlows + j] * 8 / window / 1e6;
+    }
+  std::cout << "Aggregate goodput: " << std::fixed << std::setprecision (2) << sum
+            << " Mbps; Jain fairness: " << std::setprecision (3)
+            << (sumSquares > 0 ? sum * sum / (nFlows * sumSquares) : 0) << std::endl;
+  std::cout << "Cross traffic goodput: " << std::setprecision (2) << crossSum << " Mbps" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string transport = "mptcp-lia";
+  uint32_t nFlows = 4;
+  uint32_t nCross = 2;
+  DataRate hostRate ("10Gbps");
+  DataRate coreRate ("1Gbps");
+  Time linkDelay = MicroSeconds (10);
+  Time flowStartupWindow = Seconds (0.1);
+  Time convergenceTime = Seconds (0.5);
+  Time measurementWindow = Seconds (1);
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("transport", "mptcp-lia, mptcp-olia, mptcp-dctcp or dctcp", transport);
+  cmd.AddValue ("nFlows", "number of dual-homed sender/receiver pairs", nFlows);
+  cmd.AddValue ("nCross", "number of single-path cross-traffic flows on plane A", nCross);
+  cmd.AddValue ("coreRate", "rate of the core links", coreRate);
+  cmd.AddValue ("convergenceTime", "convergence time", convergenceTime);
+  cmd.AddValue ("measurementWindow", "measurement window", measurementWindow);
+  cmd.Parse (argc, argv);
+
+  TypeId socketFactory = MptcpSocketFactory::GetTypeId ();
+  if (transport == "mptcp-lia")
+    {
+      Config::SetDefault ("ns3::MptcpSocket::CongestionControl", TypeIdValue (MptcpLia::GetTypeId ()));
+    }
+  else if (transport == "mptcp-olia")
+    {
+      Config::SetDefault ("ns3::MptcpSocket::CongestionControl", TypeIdValue (MptcpOlia::GetTypeId ()));
+    }
+  else if (transport == "mptcp-dctcp")
+    {
+      Config::SetDefault ("ns3::MptcpSocket::CongestionControl", TypeIdValue (MptcpDctcp::GetTypeId ()));
+    }
+  else if (transport == "dctcp")
+    {
+      socketFactory = TcpSocketFactory::GetTypeId ();
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown transport " << transport);
+    }
+
+  // The cross traffic and the single-path flows use DCTCP; ECN is enabled on
+  // all the sockets, including the MPTCP subflows
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpDctcp"));
+  Config::SetDefault ("ns3::TcpSocketBase::UseEcn", StringValue ("On"));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 21));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 21));
+  Config::SetDefault ("ns3::MptcpSocket::PathManager", StringValue ("FullMesh"));
+
+  // RED on the core links marks on the instantaneous queue length
+  Config::SetDefault ("ns3::RedQueueDisc::UseEcn", BooleanValue (true));
+  Config::SetDefault ("ns3::RedQueueDisc::UseHardDrop", BooleanValue (false));
+  Config::SetDefault ("ns3::RedQueueDisc::MeanPktSize", UintegerValue (1500));
+  Config::SetDefault ("ns3::RedQueueDisc::MaxSize", QueueSizeValue (QueueSize ("2666p")));
+  Config::SetDefault ("ns3::RedQueueDisc::QW", DoubleValue (1));
+  Config::SetDefault ("ns3::RedQueueDisc::MinTh", DoubleValue (20));
+  Config::SetDefault ("ns3::RedQueueDisc::MaxTh", DoubleValue (60));
+
+  NodeContainer switches;
+  switches.Create (4);                 // A0, A1, B0, B1
+  NodeContainer senders;
+  senders.Create (nFlows);
+  NodeContainer receivers;
+  receivers.Create (nFlows);
+  NodeContainer crossSenders;
+  crossSenders.Create (nCross);
+  NodeContainer crossReceivers;
+  crossReceivers.Create (nCross);
+
+  InternetStackHelper internet;
+  internet.InstallAll ();
+
+  PointToPointHelper hostLink;
+  hostLink.SetDeviceAttribute ("DataRate", DataRateValue (hostRate));
+  hostLink.SetChannelAttribute ("Delay", TimeValue (linkDelay));
+  PointToPointHelper coreLink;
+  coreLink.SetDeviceAttribute ("DataRate", DataRateValue (coreRate));
+  coreLink.SetChannelAttribute ("Delay", TimeValue (linkDelay));
+
+  TrafficControlHelper red;
+  red.SetRootQueueDisc ("ns3::RedQueueDisc",
+                        "LinkBandwidth", DataRateValue (coreRate),
+                        "LinkDelay", TimeValue (linkDelay));
+  TrafficControlHelper fifo;
+  fifo.SetRootQueueDisc ("ns3::FifoQueueDisc", "MaxSize", QueueSizeValue (QueueSize ("2666p")));
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.252");
+  for (uint32_t plane = 0; plane < 2; plane++)
+    {
+      NetDeviceContainer core = coreLink.Install (switches.Get (2 * plane), switches.Get (2 * plane + 1));
+      red.Install (core);
+      address.Assign (core);
+      address.NewNetwork ();
+    }
+
+  // Global routing would reach both addresses of a dual-homed host through
+  // the same plane; host routes pin each address of a receiver (and of a
+  // sender, for the ACKs) to its own plane
+  Ipv4StaticRoutingHelper staticRouting;
+  std::vector<Ipv4Address> receiverAddresses;
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      Ipv4InterfaceContainer up[2];
+      Ipv4InterfaceContainer down[2];
+      for (uint32_t plane = 0; plane < 2; plane++)
+        {
+          NetDeviceContainer upLink = hostLink.Install (senders.Get (i), switches.Get (2 * plane));
+          fifo.Install (upLink);
+          up[plane] = address.Assign (upLink);
+          address.NewNetwork ();
+          NetDeviceContainer downLink = hostLink.Install (switches.Get (2 * plane + 1), receivers.Get (i));
+          fifo.Install (downLink);
+          down[plane] = address.Assign (downLink);
+          address.NewNetwork ();
+        }
+      receiverAddresses.push_back (down[0].GetAddress (1));
+      Ptr<Ipv4StaticRouting> senderRouting = staticRouting.GetStaticRouting (senders.Get (i)->GetObject<Ipv4> ());
+      Ptr<Ipv4StaticRouting> receiverRouting = staticRouting.GetStaticRouting (receivers.Get (i)->GetObject<Ipv4> ());
+      for (uint32_t plane = 0; plane < 2; plane++)
+        {
+          senderRouting->AddHostRouteTo (down[plane].GetAddress (1), up[plane].GetAddress (1), plane + 1);
+          receiverRouting->AddHostRouteTo (up[plane].GetAddress (0), down[plane].GetAddress (0), plane + 1);
+        }
+    }
+
+  std::vector<Ipv4Address> crossAddresses;
+  for (uint32_t j = 0; j < nCross; j++)
+    {
+      NetDeviceContainer up = hostLink.Install (crossSenders.Get (j), switches.Get (0));
+      fifo.Install (up);
+      address.Assign (up);
+      address.NewNetwork ();
+      NetDeviceContainer down = hostLink.Install (switches.Get (1), crossReceivers.Get (j));
+      fifo.Install (down);
+      Ipv4InterfaceContainer interfaces = address.Assign (down);
+      address.NewNetwork ();
+      crossAddresses.push_back (interfaces.GetAddress (1));
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  rxBytes.resize (nFlows + nCross, 0);
+  Ptr<UniformRandomVariable> startTime = CreateObject<UniformRandomVariable> ();
+  startTime->SetAttribute ("Max", DoubleValue (flowStartupWindow.GetSeconds ()));
+  uint16_t port = 50000;
+  for (uint32_t k = 0; k < nFlows + nCross; k++)
+    {
+      bool cross = (k >= nFlows);
+      Ptr<Node> sender = cross ? crossSenders.Get (k - nFlows) : senders.Get (k);
+      Ptr<Node> receiver = cross ? crossReceivers.Get (k - nFlows) : receivers.Get (k);
+      Ipv4Address remote = cross ? crossAddresses[k - nFlows] : receiverAddresses[k];
+      TypeId factory = cross ? TcpSocketFactory::GetTypeId () : socketFactory;
+
+      PacketSinkHelper sink (factory.GetName (), InetSocketAddress (Ipv4Address::GetAny (), port));
+      ApplicationContainer sinkApp = sink.Install (receiver);
+      sinkApp.Start (Seconds (0));
+      sinkApp.Get (0)->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&TraceSink, k));
+
+      BulkSendHelper source (factory.GetName (), InetSocketAddress (remote, port));
+      source.SetAttribute ("MaxBytes", UintegerValue (0));
+      ApplicationContainer sourceApp = source.Install (sender);
+      sourceApp.Start (Seconds (startTime->GetValue ()));
+      port++;
+    }
+
+  Time measurementStart = flowStartupWindow + convergenceTime;
+  Simulator::Schedule (measurementStart, &InitializeCounters);
+  Simulator::Schedule (measurementStart + measurementWindow, &PrintResults,
+                       measurementWindow, nFlows, nCross);
+
+  std::cout << "Running mptcp-datacenter with transport=" << transport << std::endl;
+  Simulator::Stop (measurementStart + measurementWindow);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return 0;
+}
@@ -56,6 +56,43 @@ void TraceAggregator (std::size_t index, Ptr<const Packet> p, const Address& a)
 
 
 
+uint64_t groPackets = 0;
+uint64_t groSegments = 0;
+void TraceGroFlush (Ptr<const Packet> p, uint32_t segments)
+{
+  groPackets++;
+  groSegments += segments;
+}
+
+uint32_t peakSharedBufferOccupancy = 0;
+void TraceSharedBufferOccupancy (uint32_t oldValue, uint32_t newValue)
+{
+  peakSharedBufferOccupancy = std::max (peakSharedBufferOccupancy, newValue);
+}
+
+uint64_t s1Dequeued = 0;
+Time s1SojournSum;
+Time s1SojournMax;
+void TraceS1Sojourn (Time sojourn)
+{
+  s1Dequeued++;
+  s1SojournSum += sojourn;
+  s1SojournMax = std::max (s1SojournMax, sojourn);
+}
+
+void TraceDcqcnAggregator (Ptr<const Packet> p)
+{
+  TraceAggregator (0, p, Address ());
+}
+
+uint32_t pfcPauses = 0;
+Time pfcPausedTime;
+void TracePfcPause (uint8_t priority, Time duration)
+{
+  pfcPauses++;
+  pfcPausedTime += duration;
+}
+
 int main (int argc, char *argv[])
 {
   std::string outputFilePath = "../outputs/";
@@ -64,6 +101,14 @@ int main (int argc, char *argv[])
   bool enableSwitchEcn = true;
   Time progressInterval = MicroSeconds (100);
   size_t numSenders = 9;
+  uint32_t gsoMaxSize = 0;
+  Time groTimeout = Seconds (0);
+  bool sharedBuffer = false;
+  double sharedBufferAlpha = 1;
+  bool pfc = false;
+  bool dcqcn = false;
+  std::string markingMode = "Enqueue";
+  bool stepMarking = false;
   CommandLine cmd (__FILE__);
   cmd.AddValue ("tcpTypeId", "ns-3 TCP TypeId", tcpTypeId);
   cmd.AddValue ("enableSwitchEcn", "enable ECN at switches", enableSwitchEcn);
@@ -71,10 +116,23 @@ int main (int argc, char *argv[])
   cmd.AddValue ("outputFilePath", "set path for output files", outputFilePath);
   cmd.AddValue ("outputFilename", "set filename for output file", outputFilename);
   cmd.AddValue ("numSenders", "number of client host machines", numSenders);
+  cmd.AddValue ("gsoMaxSize", "max TCP GSO super-segment size in bytes (0 disables GSO)", gsoMaxSize);
+  cmd.AddValue ("groTimeout", "GRO batch window at the aggregator (0 disables GRO)", groTimeout);
+  cmd.AddValue ("sharedBuffer", "share a 128KB buffer among the ports of each switch", sharedBuffer);
+  cmd.AddValue ("sharedBufferAlpha", "Dynamic Threshold alpha of the shared buffers", sharedBufferAlpha);
+  cmd.AddValue ("pfc", "pause the upstream devices with PFC when the shared buffers fill up "
+                "(implies sharedBuffer; use a large sharedBufferAlpha to leave headroom)", pfc);
+  cmd.AddValue ("dcqcn", "send with DCQCN over UDP instead of TCP, reacting to the same "
+                "RED marking at the switches", dcqcn);
+  cmd.AddValue ("markingMode", "where the switches mark packets: Enqueue (RED average), "
+                "DequeueLength or DequeueSojourn", markingMode);
+  cmd.AddValue ("stepMarking", "use step marking queue discs instead of RED at the switches",
+                stepMarking);
   cmd.AddValue ("printLastXBytesReceived", 
                 "print arrival times of bytes > (1MB - printLastXBytesReceived)", 
                 printLastXBytesReceived);
   cmd.Parse (argc, argv);
+  sharedBuffer = sharedBuffer || pfc;
   LogComponentEnable("DCTCP-PlusExperiment", LOG_LEVEL_DEBUG);
 
   Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::" + tcpTypeId));
@@ -106,6 +164,7 @@ int main (int argc, char *argv[])
   PointToPointHelper link;
   link.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
   link.SetChannelAttribute ("Delay", StringValue ("50us"));
+  link.SetDeviceAttribute ("PfcEnabled", BooleanValue (pfc));
   // Total of 13 links.
   // Layer 1
   NetDeviceContainer S1ToA = link.Install(S1, aggregator);
@@ -142,6 +201,7 @@ int main (int argc, char *argv[])
   Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (2));
   Config::SetDefault ("ns3::TcpSocketBase::UseEcn", StringValue ("On"));
   Config::SetDefault ("ns3::TcpSocketBase::MinRto", TimeValue (MilliSeconds (10)));
+  Config::SetDefault ("ns3::TcpSocketBase::GsoMaxSize", UintegerValue (gsoMaxSize));
   GlobalValue::Bind ("ChecksumEnabled", BooleanValue (false));
 
   // Set default parameters for RED queue disc
@@ -153,14 +213,28 @@ int main (int argc, char *argv[])
   Config::SetDefault ("ns3::RedQueueDisc::UseHardDrop", BooleanValue (false));
   Config::SetDefault ("ns3::RedQueueDisc::MeanPktSize", UintegerValue (1500));
   // DCTCP+ paper used switches with 128KB of buffer for all tests
-  // If every packet is 1500 bytes, ~85 packets can be stored in 128 KB
-  Config::SetDefault ("ns3::RedQueueDisc::MaxSize", QueueSizeValue (QueueSize ("85p")));
+  // If every packet is 1500 bytes, ~85 packets can be stored in 128 KB.
+  // With a shared buffer, the 128 KB are shared by the ports of a switch
+  // and the buffer admission decides which packets are dropped
+  Config::SetDefault ("ns3::RedQueueDisc::MaxSize",
+                      QueueSizeValue (QueueSize (sharedBuffer ? "1000p" : "85p")));
+  Config::SetDefault ("ns3::SharedBuffer::Size", QueueSizeValue (QueueSize ("128KB")));
+  Config::SetDefault ("ns3::SharedBuffer::Alpha", DoubleValue (sharedBufferAlpha));
+  // An ingress port keeps receiving about 100us * 1Gbps (plus two packets)
+  // after sending a pause, which the admission threshold has to leave room for
+  Config::SetDefault ("ns3::SharedBuffer::PfcXoffThreshold",
+                      QueueSizeValue (QueueSize (pfc ? "16KB" : "0B")));
+  Config::SetDefault ("ns3::SharedBuffer::PfcXonThreshold", QueueSizeValue (QueueSize ("8KB")));
   // DCTCP tracks instantaneous queue length only; so set QW = 1
   Config::SetDefault ("ns3::RedQueueDisc::QW", DoubleValue (1));
   
   // Same as K for DCTCP+
   Config::SetDefault ("ns3::RedQueueDisc::MinTh", DoubleValue (20));
   Config::SetDefault ("ns3::RedQueueDisc::MaxTh", DoubleValue (20));
+  // With dequeue marking, the sojourn time threshold is the time to drain
+  // the 20 packets of K at 1 Gbps
+  Config::SetDefault ("ns3::RedQueueDisc::MarkingMode", StringValue (markingMode));
+  Config::SetDefault ("ns3::RedQueueDisc::SojournThreshold", TimeValue (MicroSeconds (240)));
 
 
   /******** Install Internet Stack ********/
@@ -171,13 +245,26 @@ int main (int argc, char *argv[])
   TrafficControlHelper tchRed;
   // MinTh = 20, MaxTh = 60 recommended in ACM SIGCOMM 2010 DCTCP Paper
   // This yields a target queue depth of 250us at 1 Gb/s
-  tchRed.SetRootQueueDisc ("ns3::RedQueueDisc",
-                            "LinkBandwidth", StringValue ("1Gbps"),
-                            "LinkDelay", StringValue ("50us"),
-                            "MinTh", DoubleValue (20),
-                            "MaxTh", DoubleValue (20));
+  if (stepMarking)
+    {
+      tchRed.SetRootQueueDisc ("ns3::StepMarkingQueueDisc",
+                               "MaxSize", StringValue (sharedBuffer ? "1000p" : "85p"),
+                               "MarkingThreshold", StringValue ("20p"),
+                               "MarkingMode", StringValue (markingMode == "Enqueue" ? "EnqueueLength"
+                                                                                    : markingMode),
+                               "SojournThreshold", TimeValue (MicroSeconds (240)));
+    }
+  else
+    {
+      tchRed.SetRootQueueDisc ("ns3::RedQueueDisc",
+                               "LinkBandwidth", StringValue ("1Gbps"),
+                               "LinkDelay", StringValue ("50us"),
+                               "MinTh", DoubleValue (20),
+                               "MaxTh", DoubleValue (20));
+    }
   
   QueueDiscContainer queueDiscs = tchRed.Install (S1ToA);
+  queueDiscs.Get (0)->TraceConnectWithoutContext ("SojournTime", MakeCallback (&TraceS1Sojourn));
   for (std::size_t i = 0; i < numIntermediateSwitches; i++)
     {
       tchRed.Install (intermediateSwitchesToS1[i]);
@@ -186,6 +273,16 @@ int main (int argc, char *argv[])
     {
       tchRed.Install (sendersToIntermediateSwitches[i]);
     }
+  if (sharedBuffer)
+    {
+      Ptr<SharedBuffer> s1Buffer = CreateObject<SharedBuffer> ();
+      s1Buffer->TraceConnectWithoutContext ("Occupancy", MakeCallback (&TraceSharedBufferOccupancy));
+      tchRed.InstallSharedBuffer (S1, s1Buffer);
+      for (std::size_t i = 0; i < numIntermediateSwitches; i++)
+        {
+          tchRed.InstallSharedBuffer (switches234.Get (i), CreateObject<SharedBuffer> ());
+        }
+    }
 
   Ipv4AddressHelper address;
   address.SetBase("10.0.0.0", "255.255.255.0");
@@ -228,6 +325,19 @@ int main (int argc, char *argv[])
   aggregatorApp.Start (startTime);
   aggregatorApp.Stop (stopTime);
   Ptr<PacketSink> aggSink = aggregatorApp.Get (0)->GetObject<PacketSink> ();
+  // DCQCN flows go to a receiver which sends CNPs back for the packets
+  // marked by the RED queue discs
+  uint16_t dcqcnPort = aggregatorPort + 1;
+  Ptr<DcqcnReceiver> dcqcnReceiver;
+  if (dcqcn)
+    {
+      DcqcnReceiverHelper receiverHelper (dcqcnPort);
+      ApplicationContainer receiverApp = receiverHelper.Install (aggregator);
+      receiverApp.Start (startTime);
+      receiverApp.Stop (stopTime);
+      dcqcnReceiver = receiverApp.Get (0)->GetObject<DcqcnReceiver> ();
+      dcqcnReceiver->TraceConnectWithoutContext ("Rx", MakeCallback (&TraceDcqcnAggregator));
+    }
   // Sender Applications
   std::vector<BulkSendHelper> bulkSenders;
   bulkSenders.reserve (numFlows);
@@ -239,13 +349,25 @@ int main (int argc, char *argv[])
   */
   Ptr<UniformRandomVariable> aggregatorRequestDelay = CreateObject<UniformRandomVariable> ();
   for (std::size_t i = 0; i < numFlows; i++) {
-    BulkSendHelper ftp ("ns3::TcpSocketFactory", Address ());
-    ftp.SetAttribute ("Remote", aggregatorAddress);
-    ftp.SetAttribute ("SendSize", UintegerValue (tcpSegmentSize));
     uint64_t maxBytes = i < ONE_MB % numFlows ? ONE_MB / numFlows + 1 : ONE_MB / numFlows;
-    ftp.SetAttribute ("MaxBytes", UintegerValue (maxBytes));
-    bulkSenders.push_back (ftp);
-    ApplicationContainer senderApp = ftp.Install (senders.Get (i % numSenders));
+    ApplicationContainer senderApp;
+    if (dcqcn)
+      {
+        DcqcnSenderHelper dcqcnSender (InetSocketAddress (ipS1ToA.GetAddress (1), dcqcnPort));
+        dcqcnSender.SetAttribute ("LineRate", StringValue ("1Gbps"));
+        dcqcnSender.SetAttribute ("PacketSize", UintegerValue (tcpSegmentSize));
+        dcqcnSender.SetAttribute ("MaxBytes", UintegerValue (maxBytes));
+        senderApp = dcqcnSender.Install (senders.Get (i % numSenders));
+      }
+    else
+      {
+        BulkSendHelper ftp ("ns3::TcpSocketFactory", Address ());
+        ftp.SetAttribute ("Remote", aggregatorAddress);
+        ftp.SetAttribute ("SendSize", UintegerValue (tcpSegmentSize));
+        ftp.SetAttribute ("MaxBytes", UintegerValue (maxBytes));
+        bulkSenders.push_back (ftp);
+        senderApp = ftp.Install (senders.Get (i % numSenders));
+      }
     // delay is somewhere within 3 * link delay of 50µs (agg -> s1 -> intermediate -> sender)
     Time slightDelay = MicroSeconds(aggregatorRequestDelay->GetInteger(1, 150));
     firstFlowStart = firstFlowStart < slightDelay ? firstFlowStart : slightDelay;
@@ -257,12 +379,46 @@ int main (int argc, char *argv[])
   NS_LOG_DEBUG("Opening output file(s)...");
   completionTimesStream.open (outputFilePath + outputFilename, std::ios::out | std::ios::app);
   aggSink->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&TraceAggregator, 0));
+  Ptr<TcpL4Protocol> aggregatorTcp = aggregator->GetObject<TcpL4Protocol> ();
+  aggregatorTcp->SetAttribute ("GroTimeout", TimeValue (groTimeout));
+  aggregatorTcp->TraceConnectWithoutContext ("GroFlush", MakeCallback (&TraceGroFlush));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/PfcPause",
+                                 MakeCallback (&TracePfcPause));
   
   NS_LOG_DEBUG("Starting simulation...");
   Simulator::Stop (stopTime);
   Simulator::Run ();
 
   completionTimesStream.close ();
+  if (groPackets > 0)
+    {
+      std::cout << "GRO merged " << groSegments << " segments into " << groPackets
+                << " packets (" << groSegments - groPackets << " receive events saved)"
+                << std::endl;
+    }
+  if (s1Dequeued > 0)
+    {
+      std::cout << "Queueing delay at S1 towards the aggregator: mean "
+                << (s1SojournSum / s1Dequeued).As (Time::US) << ", max "
+                << s1SojournMax.As (Time::US) << std::endl;
+    }
+  if (sharedBuffer)
+    {
+      std::cout << "Peak occupancy of the S1 shared buffer: " << peakSharedBufferOccupancy
+                << " bytes" << std::endl;
+      std::cout << "Packets dropped by S1 towards the aggregator: "
+                << queueDiscs.Get (0)->GetStats ().nTotalDroppedPackets << std::endl;
+    }
+  if (dcqcn)
+    {
+      std::cout << "DCQCN bytes received: " << dcqcnReceiver->GetReceived ()
+                << ", CNPs sent: " << dcqcnReceiver->GetCnpSent () << std::endl;
+    }
+  if (pfc)
+    {
+      std::cout << "PFC pauses: " << pfcPauses << ", total paused time: "
+                << pfcPausedTime.As (Time::MS) << std::endl;
+    }
   Simulator::Destroy ();
   return 0;
 }
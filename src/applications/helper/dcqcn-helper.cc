@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "dcqcn-helper.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+DcqcnSenderHelper::DcqcnSenderHelper (Address remote)
+{
+  m_factory.SetTypeId (DcqcnSender::GetTypeId ());
+  SetAttribute ("Remote", AddressValue (remote));
+}
+
+void
+DcqcnSenderHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+DcqcnSenderHelper::Install (NodeContainer c)
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<DcqcnSender> sender = m_factory.Create<DcqcnSender> ();
+      (*i)->AddApplication (sender);
+      apps.Add (sender);
+    }
+  return apps;
+}
+
+DcqcnReceiverHelper::DcqcnReceiverHelper (uint16_t port)
+{
+  m_factory.SetTypeId (DcqcnReceiver::GetTypeId ());
+  SetAttribute ("Port", UintegerValue (port));
+}
+
+void
+DcqcnReceiverHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+DcqcnReceiverHelper::Install (NodeContainer c)
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<DcqcnReceiver> receiver = m_factory.Create<DcqcnReceiver> ();
+      (*i)->AddApplication (receiver);
+      apps.Add (receiver);
+    }
+  return apps;
+}
+
+} // namespace ns3
@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DCQCN_HELPER_H
+#define DCQCN_HELPER_H
+
+#include <stdint.h>
+#include "ns3/application-container.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/address.h"
+#include "ns3/dcqcn-sender.h"
+#include "ns3/dcqcn-receiver.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup dcqcn
+ * \brief Create DcqcnSender applications
+ */
+class DcqcnSenderHelper
+{
+public:
+  /**
+   * Create a DcqcnSenderHelper to make it easier to work with DcqcnSenders
+   *
+   * \param remote the address (InetSocketAddress or Inet6SocketAddress) of
+   *        the DcqcnReceiver
+   */
+  DcqcnSenderHelper (Address remote);
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Create one DcqcnSender on each of the nodes in the NodeContainer.
+   *
+   * \param c the nodes on which to create the Applications
+   * \returns the applications created, one Application per Node in the
+   *          NodeContainer.
+   */
+  ApplicationContainer Install (NodeContainer c);
+
+private:
+  ObjectFactory m_factory; //!< Object factory.
+};
+
+/**
+ * \ingroup dcqcn
+ * \brief Create DcqcnReceiver applications
+ */
+class DcqcnReceiverHelper
+{
+public:
+  /**
+   * Create a DcqcnReceiverHelper to make it easier to work with DcqcnReceivers
+   *
+   * \param port the port the receiver will wait on for incoming packets
+   */
+  DcqcnReceiverHelper (uint16_t port);
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Create one DcqcnReceiver on each of the nodes in the NodeContainer.
+   *
+   * \param c the nodes on which to create the Applications
+   * \returns the applications created, one Application per Node in the
+   *          NodeContainer.
+   */
+  ApplicationContainer Install (NodeContainer c);
+
+private:
+  ObjectFactory m_factory; //!< Object factory.
+};
+
+} // namespace ns3
+
+#endif /* DCQCN_HELPER_H */
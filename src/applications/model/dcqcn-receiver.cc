@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "dcqcn-receiver.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DcqcnReceiver");
+
+NS_OBJECT_ENSURE_REGISTERED (DcqcnReceiver);
+
+TypeId
+DcqcnReceiver::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DcqcnReceiver")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<DcqcnReceiver> ()
+    .AddAttribute ("Port", "Port on which we listen for incoming packets.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&DcqcnReceiver::m_port),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("CnpInterval",
+                   "The minimum interval between two CNPs sent to the same sender",
+                   TimeValue (MicroSeconds (50)),
+                   MakeTimeAccessor (&DcqcnReceiver::m_cnpInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("CnpSize", "The size of the UDP payload of the CNPs",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&DcqcnReceiver::m_cnpSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CnpTos", "The TOS (IPv4) or Traffic Class (IPv6) of the CNPs",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DcqcnReceiver::m_cnpTos),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddTraceSource ("Rx", "A packet has been received",
+                     MakeTraceSourceAccessor (&DcqcnReceiver::m_rxTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("Cnp", "A CNP has been sent",
+                     MakeTraceSourceAccessor (&DcqcnReceiver::m_cnpTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+DcqcnReceiver::DcqcnReceiver ()
+  : m_received (0),
+    m_cnpSent (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DcqcnReceiver::~DcqcnReceiver ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+DcqcnReceiver::GetReceived (void) const
+{
+  return m_received;
+}
+
+uint32_t
+DcqcnReceiver::GetCnpSent (void) const
+{
+  return m_cnpSent;
+}
+
+void
+DcqcnReceiver::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_socket = 0;
+  m_socket6 = 0;
+  Application::DoDispose ();
+}
+
+void
+DcqcnReceiver::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  if (m_socket == 0)
+    {
+      m_socket = Socket::CreateSocket (GetNode (), tid);
+      if (m_socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), m_port)) == -1)
+        {
+          NS_FATAL_ERROR ("Failed to bind socket");
+        }
+      m_socket->SetIpRecvTos (true);
+    }
+  m_socket->SetRecvCallback (MakeCallback (&DcqcnReceiver::HandleRead, this));
+
+  if (m_socket6 == 0)
+    {
+      m_socket6 = Socket::CreateSocket (GetNode (), tid);
+      if (m_socket6->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), m_port)) == -1)
+        {
+          NS_FATAL_ERROR ("Failed to bind socket");
+        }
+      m_socket6->SetIpv6RecvTclass (true);
+      m_socket6->SetIpv6Tclass (m_cnpTos);
+    }
+  m_socket6->SetRecvCallback (MakeCallback (&DcqcnReceiver::HandleRead, this));
+}
+
+void
+DcqcnReceiver::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_socket != 0)
+    {
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+  if (m_socket6 != 0)
+    {
+      m_socket6->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+}
+
+void
+DcqcnReceiver::HandleRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+    {
+      m_rxTrace (packet);
+      m_received += packet->GetSize ();
+
+      uint8_t ecn = 0;
+      SocketIpTosTag tosTag;
+      SocketIpv6TclassTag tclassTag;
+      if (packet->PeekPacketTag (tosTag))
+        {
+          ecn = tosTag.GetTos () & 0x3;
+        }
+      else if (packet->PeekPacketTag (tclassTag))
+        {
+          ecn = tclassTag.GetTclass () & 0x3;
+        }
+      if (ecn != 0x3)
+        {
+          continue;
+        }
+
+      auto it = m_lastCnp.find (from);
+      if (it != m_lastCnp.end () && Simulator::Now () < it->second + m_cnpInterval)
+        {
+          NS_LOG_LOGIC ("CE packet received, but a CNP was sent recently");
+          continue;
+        }
+      m_lastCnp[from] = Simulator::Now ();
+
+      Ptr<Packet> cnp = Create<Packet> (m_cnpSize);
+      NS_LOG_LOGIC ("CE packet received, sending a CNP");
+      m_cnpTrace (cnp);
+      if (InetSocketAddress::IsMatchingType (from))
+        {
+          // SendTo uses the TOS of the destination address
+          InetSocketAddress to = InetSocketAddress::ConvertFrom (from);
+          to.SetTos (m_cnpTos);
+          socket->SendTo (cnp, 0, to);
+        }
+      else
+        {
+          socket->SendTo (cnp, 0, from);
+        }
+      m_cnpSent++;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DCQCN_RECEIVER_H
+#define DCQCN_RECEIVER_H
+
+#include <map>
+#include "ns3/application.h"
+#include "ns3/address.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup dcqcn
+ *
+ * \brief The notification point of DCQCN
+ *
+ * The receiver listens on a UDP port (both IPv4 and IPv6) for the packets of
+ * DcqcnSender applications. When a packet is received with the ECN field of
+ * its TOS (or Traffic Class) set to CE, a Congestion Notification Packet
+ * (CNP) is sent back to the source address and port of the packet, unless a
+ * CNP was sent to the same sender in the last CnpInterval.
+ */
+class DcqcnReceiver : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  DcqcnReceiver ();
+  virtual ~DcqcnReceiver ();
+
+  /**
+   * \brief Get the number of bytes received
+   * \return the number of bytes of payload received
+   */
+  uint64_t GetReceived (void) const;
+  /**
+   * \brief Get the number of CNPs sent
+   * \return the number of CNPs sent
+   */
+  uint32_t GetCnpSent (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \brief Handle a packet reception, sending back a CNP if it is marked
+   * \param socket the socket the packet was received on
+   */
+  void HandleRead (Ptr<Socket> socket);
+
+  uint16_t m_port;                   //!< Port on which we listen
+  Time m_cnpInterval;                //!< Minimum interval between CNPs to a sender
+  uint32_t m_cnpSize;                //!< Size of the payload of the CNPs
+  uint8_t m_cnpTos;                  //!< TOS (or Traffic Class) of the CNPs
+  Ptr<Socket> m_socket;              //!< IPv4 Socket
+  Ptr<Socket> m_socket6;             //!< IPv6 Socket
+  uint64_t m_received;               //!< Bytes of payload received
+  uint32_t m_cnpSent;                //!< Number of CNPs sent
+  std::map<Address, Time> m_lastCnp; //!< Time of the last CNP sent to each sender
+
+  /// Traced Callback: received packets
+  TracedCallback<Ptr<const Packet> > m_rxTrace;
+  /// Traced Callback: sent CNPs
+  TracedCallback<Ptr<const Packet> > m_cnpTrace;
+};
+
+} // namespace ns3
+
+#endif /* DCQCN_RECEIVER_H */
@@ -0,0 +1,357 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/socket-factory.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/abort.h"
+#include "seq-ts-header.h"
+#include "dcqcn-sender.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DcqcnSender");
+
+NS_OBJECT_ENSURE_REGISTERED (DcqcnSender);
+
+TypeId
+DcqcnSender::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DcqcnSender")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<DcqcnSender> ()
+    .AddAttribute ("Remote", "The address of the DcqcnReceiver",
+                   AddressValue (),
+                   MakeAddressAccessor (&DcqcnSender::m_peer),
+                   MakeAddressChecker ())
+    .AddAttribute ("PacketSize", "The size of the UDP payload of the packets",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&DcqcnSender::m_pktSize),
+                   MakeUintegerChecker<uint32_t> (12))
+    .AddAttribute ("MaxBytes",
+                   "The total number of bytes of payload to send. "
+                   "The value zero means that there is no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DcqcnSender::m_maxBytes),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("Tos",
+                   "The TOS (IPv4) or Traffic Class (IPv6) of the packets, "
+                   "which should be ECN capable",
+                   UintegerValue (0x02),
+                   MakeUintegerAccessor (&DcqcnSender::m_tos),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("LineRate", "The maximum, and initial, rate",
+                   DataRateValue (DataRate ("1Gbps")),
+                   MakeDataRateAccessor (&DcqcnSender::m_lineRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("MinRate", "The minimum rate",
+                   DataRateValue (DataRate ("1Mbps")),
+                   MakeDataRateAccessor (&DcqcnSender::m_minRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("G", "The gain of the alpha update",
+                   DoubleValue (1.0 / 256),
+                   MakeDoubleAccessor (&DcqcnSender::m_g),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("AlphaResumeInterval",
+                   "The interval without CNPs after which alpha decays",
+                   TimeValue (MicroSeconds (55)),
+                   MakeTimeAccessor (&DcqcnSender::m_alphaInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("RateIncreaseInterval",
+                   "The interval of the rate increase timer",
+                   TimeValue (MicroSeconds (55)),
+                   MakeTimeAccessor (&DcqcnSender::m_increaseInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("ByteCounter",
+                   "The bytes sent between two rate increase events",
+                   UintegerValue (10000000),
+                   MakeUintegerAccessor (&DcqcnSender::m_byteCounter),
+                   MakeUintegerChecker<uint64_t> (1))
+    .AddAttribute ("FastRecoverySteps",
+                   "The number of rate increase events of the fast recovery stage",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&DcqcnSender::m_fastRecoverySteps),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("AdditiveIncrease",
+                   "The increase of the target rate in the additive increase stage",
+                   DataRateValue (DataRate ("5Mbps")),
+                   MakeDataRateAccessor (&DcqcnSender::m_rai),
+                   MakeDataRateChecker ())
+    .AddAttribute ("HyperIncrease",
+                   "The increase of the target rate in the hyper increase stage",
+                   DataRateValue (DataRate ("50Mbps")),
+                   MakeDataRateAccessor (&DcqcnSender::m_rhai),
+                   MakeDataRateChecker ())
+    .AddTraceSource ("Tx", "A new packet is sent",
+                     MakeTraceSourceAccessor (&DcqcnSender::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("Cnp", "A CNP is received",
+                     MakeTraceSourceAccessor (&DcqcnSender::m_cnpTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("Rate", "The current rate",
+                     MakeTraceSourceAccessor (&DcqcnSender::m_rate),
+                     "ns3::TracedValueCallback::DataRate")
+    .AddTraceSource ("Alpha", "The estimate of the fraction of marked packets",
+                     MakeTraceSourceAccessor (&DcqcnSender::m_alpha),
+                     "ns3::TracedValueCallback::Double")
+  ;
+  return tid;
+}
+
+DcqcnSender::DcqcnSender ()
+  : m_socket (0),
+    m_headerSize (0),
+    m_seq (0),
+    m_totBytes (0),
+    m_alpha (1.0),
+    m_timerStage (0),
+    m_byteStage (0),
+    m_bytesSinceIncrease (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DcqcnSender::~DcqcnSender ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DataRate
+DcqcnSender::GetRate (void) const
+{
+  return m_rate;
+}
+
+DataRate
+DcqcnSender::GetTargetRate (void) const
+{
+  return m_targetRate;
+}
+
+double
+DcqcnSender::GetAlpha (void) const
+{
+  return m_alpha;
+}
+
+uint64_t
+DcqcnSender::GetTotalTx (void) const
+{
+  return m_totBytes;
+}
+
+void
+DcqcnSender::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_socket = 0;
+  Application::DoDispose ();
+}
+
+void
+DcqcnSender::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_socket)
+    {
+      m_socket = Socket::CreateSocket (GetNode (), TypeId::LookupByName ("ns3::UdpSocketFactory"));
+      if (Inet6SocketAddress::IsMatchingType (m_peer))
+        {
+          NS_ABORT_MSG_IF (m_socket->Bind6 () == -1, "Failed to bind socket");
+          m_headerSize = 48;
+        }
+      else
+        {
+          NS_ABORT_MSG_IF (!InetSocketAddress::IsMatchingType (m_peer), "Incompatible address type: " << m_peer);
+          NS_ABORT_MSG_IF (m_socket->Bind () == -1, "Failed to bind socket");
+          m_headerSize = 28;
+        }
+      m_socket->Connect (m_peer);
+      // set the TOS after connecting, as Connect uses the TOS of the address
+      if (Inet6SocketAddress::IsMatchingType (m_peer))
+        {
+          m_socket->SetIpv6Tclass (m_tos);
+        }
+      else
+        {
+          m_socket->SetIpTos (m_tos);
+        }
+      m_socket->SetRecvCallback (MakeCallback (&DcqcnSender::HandleRead, this));
+      m_socket->SetAllowBroadcast (false);
+
+      m_rate = m_lineRate;
+      m_targetRate = m_lineRate;
+    }
+
+  m_sendEvent = Simulator::ScheduleNow (&DcqcnSender::Send, this);
+}
+
+void
+DcqcnSender::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_sendEvent);
+  Simulator::Cancel (m_alphaEvent);
+  Simulator::Cancel (m_increaseEvent);
+  if (m_socket)
+    {
+      m_socket->Close ();
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+}
+
+void
+DcqcnSender::Send (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t size = m_pktSize;
+  if (m_maxBytes > 0)
+    {
+      if (m_totBytes >= m_maxBytes)
+        {
+          NS_LOG_LOGIC ("All the bytes have been sent");
+          return;
+        }
+      size = static_cast<uint32_t> (std::min<uint64_t> (size, m_maxBytes - m_totBytes));
+    }
+
+  SeqTsHeader seqTs;
+  seqTs.SetSeq (m_seq++);
+  Ptr<Packet> p = Create<Packet> (size > seqTs.GetSerializedSize () ? size - seqTs.GetSerializedSize () : 0);
+  p->AddHeader (seqTs);
+  m_txTrace (p);
+  m_socket->Send (p);
+  m_totBytes += p->GetSize ();
+
+  // byte counter of the rate increase
+  m_bytesSinceIncrease += p->GetSize ();
+  if (m_bytesSinceIncrease >= m_byteCounter)
+    {
+      m_bytesSinceIncrease = 0;
+      if (m_rate.Get () < m_lineRate)
+        {
+          IncreaseRate ();
+          m_byteStage++;
+        }
+    }
+
+  DataRate rate = m_rate;
+  m_sendEvent = Simulator::Schedule (rate.CalculateBytesTxTime (p->GetSize () + m_headerSize),
+                                     &DcqcnSender::Send, this);
+}
+
+void
+DcqcnSender::HandleRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_cnpTrace (packet);
+      ReceiveCnp ();
+    }
+}
+
+void
+DcqcnSender::ReceiveCnp (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint64_t rate = m_rate.Get ().GetBitRate ();
+  m_targetRate = DataRate (rate);
+  m_rate = DataRate (std::max<uint64_t> (rate * (1 - m_alpha / 2), m_minRate.GetBitRate ()));
+  m_alpha = (1 - m_g) * m_alpha + m_g;
+  NS_LOG_DEBUG ("CNP: rate " << m_rate.Get () << ", target " << m_targetRate << ", alpha " << m_alpha);
+
+  // a CNP restarts the timers and the rate increase stages
+  m_timerStage = 0;
+  m_byteStage = 0;
+  m_bytesSinceIncrease = 0;
+  Simulator::Cancel (m_alphaEvent);
+  m_alphaEvent = Simulator::Schedule (m_alphaInterval, &DcqcnSender::AlphaTimerExpired, this);
+  Simulator::Cancel (m_increaseEvent);
+  m_increaseEvent = Simulator::Schedule (m_increaseInterval, &DcqcnSender::IncreaseTimerExpired, this);
+}
+
+void
+DcqcnSender::AlphaTimerExpired (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_alpha = (1 - m_g) * m_alpha;
+  // at the line rate, alpha keeps decaying until it is too small to have an
+  // effect on the next rate cut; the next CNP restarts the timer
+  if (m_rate.Get () < m_lineRate || m_alpha > 1e-6)
+    {
+      m_alphaEvent = Simulator::Schedule (m_alphaInterval, &DcqcnSender::AlphaTimerExpired, this);
+    }
+}
+
+void
+DcqcnSender::IncreaseTimerExpired (void)
+{
+  NS_LOG_FUNCTION (this);
+  IncreaseRate ();
+  m_timerStage++;
+  if (m_rate.Get () < m_lineRate)
+    {
+      m_increaseEvent = Simulator::Schedule (m_increaseInterval, &DcqcnSender::IncreaseTimerExpired, this);
+    }
+}
+
+void
+DcqcnSender::IncreaseRate (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint64_t target = m_targetRate.GetBitRate ();
+  if (std::max (m_timerStage, m_byteStage) < m_fastRecoverySteps)
+    {
+      NS_LOG_LOGIC ("Fast recovery");
+    }
+  else if (std::min (m_timerStage, m_byteStage) >= m_fastRecoverySteps)
+    {
+      NS_LOG_LOGIC ("Hyper increase");
+      target += m_rhai.GetBitRate ();
+    }
+  else
+    {
+      NS_LOG_LOGIC ("Additive increase");
+      target += m_rai.GetBitRate ();
+    }
+  target = std::min (target, m_lineRate.GetBitRate ());
+  m_targetRate = DataRate (target);
+  m_rate = DataRate ((target + m_rate.Get ().GetBitRate ()) / 2);
+
+  if (m_rate.Get ().GetBitRate () + 1 >= m_lineRate.GetBitRate ())
+    {
+      // the line rate is reached: the rate increase timer is no longer
+      // needed, while alpha keeps decaying
+      m_rate = m_lineRate;
+      Simulator::Cancel (m_increaseEvent);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DCQCN_SENDER_H
+#define DCQCN_SENDER_H
+
+#include "ns3/application.h"
+#include "ns3/address.h"
+#include "ns3/event-id.h"
+#include "ns3/data-rate.h"
+#include "ns3/traced-value.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup applications
+ * \defgroup dcqcn Dcqcn
+ */
+
+/**
+ * \ingroup dcqcn
+ *
+ * \brief The reaction point of DCQCN: a rate-based UDP sender
+ *
+ * The sender paces ECN capable (ECT(0)) UDP packets carrying a SeqTsHeader
+ * to a DcqcnReceiver at its current rate RC, counting the UDP and IP headers,
+ * and adapts RC to the Congestion Notification Packets (CNPs) sent back by
+ * the receiver, as described in "Congestion Control for Large-Scale RDMA
+ * Deployments" (Zhu et al., SIGCOMM 2015):
+ *
+ * - upon a CNP, the target rate RT is set to RC, RC is cut to
+ *   RC * (1 - alpha / 2) (not less than MinRate) and alpha is updated to
+ *   (1 - g) * alpha + g;
+ * - every AlphaResumeInterval without CNPs, alpha decays to (1 - g) * alpha;
+ * - every RateIncreaseInterval, and every ByteCounter bytes sent, RC is
+ *   increased to (RT + RC) / 2. During the first FastRecoverySteps timer and
+ *   byte counter events after a CNP (fast recovery), RT is left unchanged;
+ *   then RT is increased by AdditiveIncrease (additive increase) and, once
+ *   both the timer and the byte counter have completed FastRecoverySteps
+ *   events, by HyperIncrease (hyper increase). RT and RC never exceed the
+ *   LineRate.
+ *
+ * The sender starts at the LineRate, and the rate increase timer only runs
+ * while the rate is below the LineRate. The alpha timer keeps running at the
+ * LineRate, until alpha falls below 1e-6.
+ */
+class DcqcnSender : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  DcqcnSender ();
+  virtual ~DcqcnSender ();
+
+  /**
+   * \brief Get the current rate
+   * \return the current rate RC
+   */
+  DataRate GetRate (void) const;
+  /**
+   * \brief Get the target rate
+   * \return the target rate RT
+   */
+  DataRate GetTargetRate (void) const;
+  /**
+   * \brief Get the current alpha
+   * \return the estimate of the fraction of marked packets
+   */
+  double GetAlpha (void) const;
+  /**
+   * \brief Get the number of bytes sent
+   * \return the number of bytes of payload sent
+   */
+  uint64_t GetTotalTx (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \brief Send a packet and schedule the next one
+   */
+  void Send (void);
+  /**
+   * \brief Handle the CNPs received on the socket
+   * \param socket the socket
+   */
+  void HandleRead (Ptr<Socket> socket);
+  /**
+   * \brief Cut the rate upon a CNP
+   */
+  void ReceiveCnp (void);
+  /**
+   * \brief Decay alpha when no CNP was received for AlphaResumeInterval
+   */
+  void AlphaTimerExpired (void);
+  /**
+   * \brief Increase the rate every RateIncreaseInterval
+   */
+  void IncreaseTimerExpired (void);
+  /**
+   * \brief Increase the target and the current rate according to the stage
+   */
+  void IncreaseRate (void);
+
+  Address m_peer;                //!< Address of the receiver
+  uint32_t m_pktSize;            //!< Size of the payload of the packets
+  uint64_t m_maxBytes;           //!< Limit of bytes to send (0 for no limit)
+  uint8_t m_tos;                 //!< TOS (or Traffic Class) of the packets
+  DataRate m_lineRate;           //!< Line rate, also the initial rate
+  DataRate m_minRate;            //!< Minimum rate
+  double m_g;                    //!< Gain of the alpha update
+  Time m_alphaInterval;          //!< Interval of the alpha decay timer
+  Time m_increaseInterval;       //!< Interval of the rate increase timer
+  uint64_t m_byteCounter;        //!< Bytes between rate increase events
+  uint32_t m_fastRecoverySteps;  //!< Number of fast recovery steps (F)
+  DataRate m_rai;                //!< Additive increase of the target rate
+  DataRate m_rhai;               //!< Hyper increase of the target rate
+
+  Ptr<Socket> m_socket;          //!< The socket
+  uint32_t m_headerSize;         //!< Size of the UDP and IP headers
+  uint32_t m_seq;                //!< Sequence number of the next packet
+  uint64_t m_totBytes;           //!< Bytes of payload sent
+  TracedValue<DataRate> m_rate;  //!< Current rate (RC)
+  DataRate m_targetRate;         //!< Target rate (RT)
+  TracedValue<double> m_alpha;   //!< Alpha
+  uint32_t m_timerStage;         //!< Rate increase timer events since the last CNP
+  uint32_t m_byteStage;          //!< Byte counter events since the last CNP
+  uint64_t m_bytesSinceIncrease; //!< Bytes sent since the last byte counter event
+  EventId m_sendEvent;           //!< Next transmission
+  EventId m_alphaEvent;          //!< Alpha decay timer
+  EventId m_increaseEvent;       //!< Rate increase timer
+
+  /// Traced Callback: transmitted packets
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+  /// Traced Callback: received CNPs
+  TracedCallback<Ptr<const Packet> > m_cnpTrace;
+};
+
+} // namespace ns3
+
+#endif /* DCQCN_SENDER_H */
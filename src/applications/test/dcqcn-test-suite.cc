@@ -0,0 +1,286 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/dcqcn-helper.h"
+
+using namespace ns3;
+
+/**
+ * Create two nodes connected by SimpleNetDevices
+ * \param n the container of the nodes
+ * \return the interfaces of the two nodes
+ */
+static Ipv4InterfaceContainer
+CreateTwoNodes (NodeContainer &n)
+{
+  n.Create (2);
+  InternetStackHelper internet;
+  internet.SetIpv4ArpJitter (false);
+  internet.Install (n);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer d;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      n.Get (i)->AddDevice (dev);
+      dev->SetChannel (channel);
+      d.Add (dev);
+    }
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  return ipv4.Assign (d);
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief DCQCN rate adaptation test
+ *
+ * A plain UDP socket plays the role of the receiver and sends two CNPs to a
+ * DcqcnSender, 10us apart. The sequence of rates taken by the sender is
+ * checked: the two rate cuts, the fast recovery steps towards the target
+ * rate, and the first additive increase of the target rate. The decay of
+ * alpha is checked as well, including after the line rate is reached.
+ */
+class DcqcnRateTestCase : public TestCase
+{
+public:
+  DcqcnRateTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Receive the packets of the sender
+   * \param socket the socket
+   */
+  void Receive (Ptr<Socket> socket);
+  /**
+   * Send a CNP to the sender
+   */
+  void SendCnp (void);
+  /**
+   * Record a change of the rate of the sender
+   * \param oldRate the previous rate
+   * \param newRate the new rate
+   */
+  void RateChange (DataRate oldRate, DataRate newRate);
+
+  Ptr<Socket> m_socket;          //!< Socket of the receiver
+  Address m_sender;              //!< Address of the sender
+  std::vector<uint64_t> m_rates; //!< Rates taken by the sender
+};
+
+DcqcnRateTestCase::DcqcnRateTestCase ()
+  : TestCase ("Check the rate cuts and increases of the DCQCN sender")
+{
+}
+
+void
+DcqcnRateTestCase::Receive (Ptr<Socket> socket)
+{
+  while (socket->RecvFrom (m_sender))
+    {
+    }
+}
+
+void
+DcqcnRateTestCase::SendCnp (void)
+{
+  m_socket->SendTo (Create<Packet> (16), 0, m_sender);
+}
+
+void
+DcqcnRateTestCase::RateChange (DataRate oldRate, DataRate newRate)
+{
+  m_rates.push_back (newRate.GetBitRate ());
+}
+
+void
+DcqcnRateTestCase::DoRun (void)
+{
+  NodeContainer n;
+  Ipv4InterfaceContainer i = CreateTwoNodes (n);
+
+  uint16_t port = 4000;
+  m_socket = Socket::CreateSocket (n.Get (1), TypeId::LookupByName ("ns3::UdpSocketFactory"));
+  m_socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+  m_socket->SetRecvCallback (MakeCallback (&DcqcnRateTestCase::Receive, this));
+
+  DcqcnSenderHelper sender (InetSocketAddress (i.GetAddress (1), port));
+  sender.SetAttribute ("LineRate", DataRateValue (DataRate ("100Mbps")));
+  sender.SetAttribute ("G", DoubleValue (1.0 / 16));
+  ApplicationContainer apps = sender.Install (n.Get (0));
+  Ptr<DcqcnSender> app = DynamicCast<DcqcnSender> (apps.Get (0));
+  app->TraceConnectWithoutContext ("Rate", MakeCallback (&DcqcnRateTestCase::RateChange, this));
+  apps.Start (Seconds (0));
+
+  // RC = 100 * (1 - 1/2) = 50 and RT = 100, then RC = 50 * (1 - 1/2) = 25
+  // and RT = 50, since alpha stays at 1
+  Simulator::Schedule (MicroSeconds (100), &DcqcnRateTestCase::SendCnp, this);
+  Simulator::Schedule (MicroSeconds (110), &DcqcnRateTestCase::SendCnp, this);
+  // five fast recovery steps and an additive increase of RT to 55
+  Simulator::Stop (MicroSeconds (110 + 6 * 55 + 5));
+  Simulator::Run ();
+
+  std::vector<uint64_t> expected = {100000000, 50000000, 25000000, 37500000, 43750000,
+                                    46875000, 48437500, 49218750, 52109375};
+  NS_TEST_ASSERT_MSG_EQ (m_rates.size (), expected.size (), "Unexpected number of rate changes");
+  for (uint32_t j = 0; j < expected.size (); j++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rates[j], expected[j], "Unexpected rate at step " << j);
+    }
+  NS_TEST_EXPECT_MSG_EQ (app->GetTargetRate (), DataRate ("55Mbps"), "Unexpected target rate");
+  NS_TEST_EXPECT_MSG_EQ_TOL (app->GetAlpha (), std::pow (15.0 / 16, 6), 1e-9, "Unexpected alpha");
+
+  // the line rate is reached in a few ms, and alpha keeps decaying every
+  // 55us until 10ms
+  Simulator::Stop (MilliSeconds (10) - MicroSeconds (110 + 6 * 55 + 5));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (app->GetRate (), DataRate ("100Mbps"), "The line rate should be reached");
+  NS_TEST_EXPECT_MSG_EQ_TOL (app->GetAlpha (), std::pow (15.0 / 16, 179), 1e-12, "Alpha should keep decaying");
+
+  m_socket = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief DCQCN end-to-end test
+ *
+ * A DcqcnSender sends CE marked packets to a DcqcnReceiver, which sends back
+ * a CNP every CnpInterval at most, and the sender slows down. Packets which
+ * are not marked do not trigger CNPs.
+ */
+class DcqcnCnpTestCase : public TestCase
+{
+public:
+  DcqcnCnpTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Run a sender and a receiver for 1ms
+   * \param tos the TOS of the packets of the sender
+   * \param sent the number of CNPs sent by the receiver
+   * \param received the number of CNPs received by the sender
+   * \return the rate of the sender at the end of the simulation
+   */
+  DataRate Run (uint8_t tos, uint32_t &sent, uint32_t &received);
+  /**
+   * Count a CNP received by the sender
+   * \param p the CNP
+   */
+  void CountCnp (Ptr<const Packet> p);
+
+  uint32_t m_cnpReceived; //!< CNPs received by the sender
+};
+
+DcqcnCnpTestCase::DcqcnCnpTestCase ()
+  : TestCase ("Check the generation of CNPs by the DCQCN receiver")
+{
+}
+
+void
+DcqcnCnpTestCase::CountCnp (Ptr<const Packet> p)
+{
+  m_cnpReceived++;
+}
+
+DataRate
+DcqcnCnpTestCase::Run (uint8_t tos, uint32_t &sent, uint32_t &received)
+{
+  NodeContainer n;
+  Ipv4InterfaceContainer i = CreateTwoNodes (n);
+
+  uint16_t port = 4000;
+  DcqcnReceiverHelper receiver (port);
+  receiver.SetAttribute ("CnpInterval", TimeValue (MicroSeconds (100)));
+  ApplicationContainer apps = receiver.Install (n.Get (1));
+  Ptr<DcqcnReceiver> rx = DynamicCast<DcqcnReceiver> (apps.Get (0));
+
+  DcqcnSenderHelper sender (InetSocketAddress (i.GetAddress (1), port));
+  sender.SetAttribute ("LineRate", DataRateValue (DataRate ("100Mbps")));
+  sender.SetAttribute ("Tos", UintegerValue (tos));
+  apps.Add (sender.Install (n.Get (0)));
+  Ptr<DcqcnSender> tx = DynamicCast<DcqcnSender> (apps.Get (1));
+  m_cnpReceived = 0;
+  tx->TraceConnectWithoutContext ("Cnp", MakeCallback (&DcqcnCnpTestCase::CountCnp, this));
+  apps.Start (Seconds (0));
+
+  Simulator::Stop (MicroSeconds (1050));
+  Simulator::Run ();
+
+  sent = rx->GetCnpSent ();
+  received = m_cnpReceived;
+  DataRate rate = tx->GetRate ();
+  NS_TEST_EXPECT_MSG_GT (rx->GetReceived (), 0, "The receiver should receive packets");
+  Simulator::Destroy ();
+  return rate;
+}
+
+void
+DcqcnCnpTestCase::DoRun (void)
+{
+  uint32_t sent;
+  uint32_t received;
+
+  // CE marked packets: at most a CNP every 100us
+  DataRate rate = Run (0x03, sent, received);
+  NS_TEST_EXPECT_MSG_GT (sent, 1, "CNPs should be sent");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (sent, 11, "Too many CNPs were sent");
+  NS_TEST_EXPECT_MSG_EQ (received, sent, "All the CNPs should be received");
+  NS_TEST_EXPECT_MSG_LT (rate, DataRate ("100Mbps"), "The sender should slow down");
+
+  // ECT(0) packets: no CNP
+  rate = Run (0x02, sent, received);
+  NS_TEST_EXPECT_MSG_EQ (sent, 0, "No CNP should be sent");
+  NS_TEST_EXPECT_MSG_EQ (received, 0, "No CNP should be received");
+  NS_TEST_EXPECT_MSG_EQ (rate, DataRate ("100Mbps"), "The sender should send at the line rate");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief DCQCN Test Suite
+ */
+static class DcqcnTestSuite : public TestSuite
+{
+public:
+  DcqcnTestSuite ()
+    : TestSuite ("dcqcn", UNIT)
+  {
+    AddTestCase (new DcqcnRateTestCase (), TestCase::QUICK);
+    AddTestCase (new DcqcnCnpTestCase (), TestCase::QUICK);
+  }
+} g_dcqcnTestSuite; ///< the test suite
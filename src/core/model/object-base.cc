@@ -82,13 +82,15 @@ ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
   // loop over the inheritance tree back to the Object base class.
   NS_LOG_FUNCTION (this << &attributes);
   TypeId tid = GetInstanceTypeId ();
+  // the environment is looked up once rather than for each attribute
+  const char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
   do
     {
       // loop over all attributes in object type
       NS_LOG_DEBUG ("construct tid=" << tid.GetName () << ", params=" << tid.GetAttributeN ());
       for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
         {
-          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          const struct TypeId::AttributeInformation &info = tid.GetAttribute (i);
           NS_LOG_DEBUG ("try to construct \"" << tid.GetName () << "::" <<
                         info.name << "\"");
           // is this attribute stored in this AttributeConstructionList instance ?
@@ -126,7 +128,6 @@ ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
             }
 
           // No matching attribute value so we try to look at the env var.
-          const char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
           if (envVar != 0 && std::strlen (envVar) > 0)
             {
               std::string env = envVar;
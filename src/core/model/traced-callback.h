@@ -89,6 +89,15 @@ public:
    * \param [in] args The arguments to the functor
    */
   void operator() (Ts... args) const;
+  /**
+   * Checks if the Callbacks list is empty.
+   *
+   * Code that has to compute the arguments of the trace can check this
+   * first, so that nothing is done when no sink is connected.
+   *
+   * \return true if the Callbacks list is empty.
+   */
+  bool IsEmpty (void) const;
 
   /**
    *  TracedCallback signature for POD.
@@ -188,6 +197,13 @@ TracedCallback<Ts...>::operator() (Ts... args) const
     }
 }
 
+template<typename... Ts>
+bool
+TracedCallback<Ts...>::IsEmpty (void) const
+{
+  return m_callbackList.empty ();
+}
+
 } // namespace ns3
 
 #endif /* TRACED_CALLBACK_H */
@@ -228,7 +228,7 @@ public:
    * \param [in] i Index into attribute array
    * \returns The information associated to attribute whose index is \pname{i}.
    */
-  struct TypeId::AttributeInformation GetAttribute (uint16_t uid, std::size_t i) const;
+  const struct TypeId::AttributeInformation & GetAttribute (uint16_t uid, std::size_t i) const;
   /**
    * Record a new TraceSource.
    * \param [in] uid The id.
@@ -705,7 +705,7 @@ IidManager::GetAttributeN (uint16_t uid) const
   NS_LOG_LOGIC (IIDL << size);
   return size;
 }
-struct TypeId::AttributeInformation
+const struct TypeId::AttributeInformation &
 IidManager::GetAttribute (uint16_t uid, std::size_t i) const
 {
   NS_LOG_FUNCTION (IID << uid << i);
@@ -1080,7 +1080,7 @@ TypeId::GetAttributeN (void) const
   std::size_t n = IidManager::Get ()->GetAttributeN (m_tid);
   return n;
 }
-struct TypeId::AttributeInformation
+const struct TypeId::AttributeInformation &
 TypeId::GetAttribute (std::size_t i) const
 {
   NS_LOG_FUNCTION (this << i);
@@ -1090,7 +1090,7 @@ std::string
 TypeId::GetAttributeFullName (std::size_t i) const
 {
   NS_LOG_FUNCTION (this << i);
-  struct TypeId::AttributeInformation info = GetAttribute (i);
+  const struct TypeId::AttributeInformation &info = GetAttribute (i);
   return GetName () + "::" + info.name;
 }
 
@@ -256,8 +256,10 @@ public:
    *
    * \param [in] i Index into attribute array
    * \returns The information associated to attribute whose index is \pname{i}.
+   *          The reference is valid until a new attribute is added to this
+   *          TypeId.
    */
-  struct TypeId::AttributeInformation GetAttribute (std::size_t i) const;
+  const struct TypeId::AttributeInformation & GetAttribute (std::size_t i) const;
   /**
    * Get the Attribute name by index.
    *
@@ -18,6 +18,7 @@
 
 #include "ns3/test.h"
 #include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
 #include "ns3/unused.h"
 
 using namespace ns3;
@@ -101,11 +102,14 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_one, false, "Callback CbOne unexpectedly called");
   NS_TEST_ASSERT_MSG_EQ (m_two, false, "Callback CbTwo unexpectedly called");
 
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "No callback should be connected");
+
   //
   // If we connect them back up, then both callbacks should be called.
   //
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbOne, this));
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbTwo, this));
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), false, "Callbacks should be connected");
   m_one = false;
   m_two = false;
   trace (1, 2);
@@ -113,6 +117,73 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class TracedValueNotificationTestCase : public TestCase
+{
+public:
+  TracedValueNotificationTestCase ();
+  virtual ~TracedValueNotificationTestCase ()
+  {}
+
+private:
+  virtual void DoRun (void);
+
+  void Changed (uint32_t oldValue, uint32_t newValue);
+
+  uint32_t m_calls;
+  uint32_t m_oldValue;
+  uint32_t m_newValue;
+};
+
+TracedValueNotificationTestCase::TracedValueNotificationTestCase ()
+  : TestCase ("Check TracedValue notification with and without sinks")
+{}
+
+void
+TracedValueNotificationTestCase::Changed (uint32_t oldValue, uint32_t newValue)
+{
+  m_calls++;
+  m_oldValue = oldValue;
+  m_newValue = newValue;
+}
+
+void
+TracedValueNotificationTestCase::DoRun (void)
+{
+  m_calls = 0;
+  TracedValue<uint32_t> value (1);
+
+  //
+  // Without sinks, updates are stored and nothing else happens.
+  //
+  value = 2;
+  value += 3;
+  value++;
+  NS_TEST_ASSERT_MSG_EQ (value.Get (), 6, "Value not updated without sinks");
+
+  //
+  // Once a sink is connected, it sees the old and the new value of every
+  // change, and nothing when the value does not change.
+  //
+  value.ConnectWithoutContext (MakeCallback (&TracedValueNotificationTestCase::Changed, this));
+  value = 6;
+  NS_TEST_ASSERT_MSG_EQ (m_calls, 0, "Sink called for an unchanged value");
+  value = 7;
+  NS_TEST_ASSERT_MSG_EQ (m_calls, 1, "Sink not called");
+  NS_TEST_ASSERT_MSG_EQ (m_oldValue, 6, "Wrong old value");
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, 7, "Wrong new value");
+  --value;
+  NS_TEST_ASSERT_MSG_EQ (m_calls, 2, "Sink not called");
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, 6, "Wrong new value");
+
+  //
+  // After disconnecting, the sink is not called any longer.
+  //
+  value.DisconnectWithoutContext (MakeCallback (&TracedValueNotificationTestCase::Changed, this));
+  value = 8;
+  NS_TEST_ASSERT_MSG_EQ (m_calls, 2, "Sink unexpectedly called");
+  NS_TEST_ASSERT_MSG_EQ (value.Get (), 8, "Value not updated without sinks");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -123,6 +194,7 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new TracedValueNotificationTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/channel-list.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/arp-cache.h"
+#include "arp-cache-helper.h"
+#include <set>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ArpCacheHelper");
+
+ArpCacheHelper::ArpCacheHelper ()
+  : m_bypass (false)
+{
+}
+
+void
+ArpCacheHelper::SetPointToPointBypass (bool bypass)
+{
+  m_bypass = bypass;
+}
+
+void
+ArpCacheHelper::PopulateArpCaches (void) const
+{
+  NS_LOG_FUNCTION (this);
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+    {
+      PopulateArpCaches (*i);
+    }
+}
+
+void
+ArpCacheHelper::PopulateArpCaches (const NetDeviceContainer &c) const
+{
+  NS_LOG_FUNCTION (this);
+  std::set<Ptr<Channel> > done;
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Channel> channel = (*i)->GetChannel ();
+      if (channel != 0 && done.insert (channel).second)
+        {
+          PopulateArpCaches (channel);
+        }
+    }
+}
+
+void
+ArpCacheHelper::PopulateArpCaches (Ptr<Channel> channel) const
+{
+  NS_LOG_FUNCTION (this << channel);
+  // Collect the devices attached to the channel and their IPv4 interfaces
+  std::vector<std::pair<Ptr<NetDevice>, Ptr<Ipv4Interface> > > attached;
+  for (std::size_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = channel->GetDevice (i);
+      Ptr<Ipv4L3Protocol> ipv4 = device->GetNode ()->GetObject<Ipv4L3Protocol> ();
+      if (ipv4 == 0)
+        {
+          continue;
+        }
+      int32_t index = ipv4->GetInterfaceForDevice (device);
+      if (index < 0)
+        {
+          continue;
+        }
+      attached.push_back (std::make_pair (device, ipv4->GetInterface (index)));
+    }
+
+  if (m_bypass && channel->GetNDevices () == 2 && attached.size () == 2)
+    {
+      for (std::size_t i = 0; i < 2; i++)
+        {
+          if (attached[i].first->NeedsArp ())
+            {
+              NS_LOG_LOGIC ("Bypass ARP on " << attached[i].first);
+              attached[i].second->SetPeerHardwareAddress (attached[1 - i].first->GetAddress ());
+            }
+        }
+      return;
+    }
+
+  for (std::size_t i = 0; i < attached.size (); i++)
+    {
+      Ptr<ArpCache> cache = attached[i].second->GetArpCache ();
+      if (cache == 0)
+        {
+          continue;
+        }
+      for (std::size_t j = 0; j < attached.size (); j++)
+        {
+          if (i == j)
+            {
+              continue;
+            }
+          Address mac = attached[j].first->GetAddress ();
+          Ptr<Ipv4Interface> peer = attached[j].second;
+          for (uint32_t k = 0; k < peer->GetNAddresses (); k++)
+            {
+              Ipv4Address ip = peer->GetAddress (k).GetLocal ();
+              ArpCache::Entry *entry = cache->Lookup (ip);
+              if (entry == 0)
+                {
+                  entry = cache->Add (ip);
+                }
+              entry->SetMacAddress (mac);
+              entry->MarkPermanent ();
+              NS_LOG_LOGIC ("Node " << attached[i].first->GetNode ()->GetId ()
+                            << ": " << ip << " is at " << mac);
+            }
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef ARP_CACHE_HELPER_H
+#define ARP_CACHE_HELPER_H
+
+#include "ns3/ptr.h"
+#include "ns3/channel.h"
+#include "ns3/net-device-container.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Helpers
+ *
+ * \brief Helper class that fills the ARP caches from the topology.
+ *
+ * For every channel, the ARP cache of each IPv4 interface attached to the
+ * channel receives a permanent entry for every IPv4 address of the other
+ * interfaces attached to the same channel. Hence, no ARP request is sent
+ * when the simulation starts. The caches should be populated after the
+ * addresses have been assigned and before the simulation starts. Devices
+ * without an IPv4 interface (e.g., bridge ports) are ignored.
+ *
+ * Optionally, the interfaces of a device that needs ARP and is attached to a
+ * channel with a single other device can bypass ARP entirely: unicast
+ * packets are then sent to the hardware address of the peer without looking
+ * up the ARP cache (see Ipv4Interface::SetPeerHardwareAddress). Devices that
+ * do not need ARP, such as PointToPointNetDevice, never use ARP anyway.
+ *
+ * Note that ArpCache::Flush, which is called when the link of a device
+ * changes state, removes the permanent entries as well.
+ */
+class ArpCacheHelper
+{
+public:
+  /**
+   * \brief Construct a helper that does not bypass ARP.
+   */
+  ArpCacheHelper ();
+
+  /**
+   * \brief Set whether ARP is bypassed on channels with two devices.
+   * \param bypass true to send unicast packets to the peer without ARP
+   */
+  void SetPointToPointBypass (bool bypass);
+
+  /**
+   * \brief Populate the ARP caches of all the channels in the simulation.
+   */
+  void PopulateArpCaches (void) const;
+
+  /**
+   * \brief Populate the ARP caches of the interfaces attached to a channel.
+   * \param channel the channel
+   */
+  void PopulateArpCaches (Ptr<Channel> channel) const;
+
+  /**
+   * \brief Populate the ARP caches of the channels the given devices are
+   * attached to.
+   *
+   * The ARP caches of all the interfaces attached to such channels are
+   * populated, including those of devices not in the container.
+   *
+   * \param c the devices
+   */
+  void PopulateArpCaches (const NetDeviceContainer &c) const;
+
+private:
+  bool m_bypass; //!< Whether ARP is bypassed on channels with two devices
+};
+
+} // namespace ns3
+
+#endif /* ARP_CACHE_HELPER_H */
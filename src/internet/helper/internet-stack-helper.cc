@@ -107,7 +107,8 @@ InternetStackHelper::InternetStackHelper ()
     m_ipv4Enabled (true),
     m_ipv6Enabled (true),
     m_ipv4ArpJitterEnabled (true),
-    m_ipv6NsRsJitterEnabled (true)
+    m_ipv6NsRsJitterEnabled (true),
+    m_forwardingOnly (false)
 
 {
   Initialize ();
@@ -143,6 +144,7 @@ InternetStackHelper::InternetStackHelper (const InternetStackHelper &o)
   m_tcpFactory = o.m_tcpFactory;
   m_ipv4ArpJitterEnabled = o.m_ipv4ArpJitterEnabled;
   m_ipv6NsRsJitterEnabled = o.m_ipv6NsRsJitterEnabled;
+  m_forwardingOnly = o.m_forwardingOnly;
 }
 
 InternetStackHelper &
@@ -168,6 +170,7 @@ InternetStackHelper::Reset (void)
   m_ipv6Enabled = true;
   m_ipv4ArpJitterEnabled = true;
   m_ipv6NsRsJitterEnabled = true;
+  m_forwardingOnly = false;
   Initialize ();
 }
 
@@ -206,6 +209,15 @@ void InternetStackHelper::SetIpv6NsRsJitter (bool enable)
   m_ipv6NsRsJitterEnabled = enable;
 }
 
+void InternetStackHelper::SetForwardingOnly (bool enable)
+{
+  m_forwardingOnly = enable;
+  if (enable)
+    {
+      m_ipv6Enabled = false;
+    }
+}
+
 int64_t
 InternetStackHelper::AssignStreams (NodeContainer c, int64_t stream)
 {
@@ -346,6 +358,10 @@ InternetStackHelper::Install (Ptr<Node> node) const
   if (m_ipv4Enabled || m_ipv6Enabled)
     {
       CreateAndAggregateObjectFromTypeId (node, "ns3::TrafficControlLayer");
+    }
+
+  if ((m_ipv4Enabled || m_ipv6Enabled) && !m_forwardingOnly)
+    {
       CreateAndAggregateObjectFromTypeId (node, "ns3::UdpL4Protocol");
       node->AggregateObject (m_tcpFactory.Create<Object> ());
       Ptr<PacketSocketFactory> factory = CreateObject<PacketSocketFactory> ();
@@ -82,6 +82,12 @@ class Ipv6RoutingHelper;
  *  - a PacketSocketFactory
  *  - Ipv4 routing (a list routing object, a global routing object, and a static routing object)
  *  - Ipv6 routing (a static routing object)
+ *
+ * Nodes which only forward packets (e.g., the switches of a data center
+ * fabric) never terminate flows: SetForwardingOnly installs on them only
+ * ARP, IPv4 with its routing and ICMPv4, and the TrafficControlLayer, which
+ * reduces the memory used by each node and the time spent to install the
+ * stack.
  */
 class InternetStackHelper : public PcapHelperForIpv4, public PcapHelperForIpv6, 
                             public AsciiTraceHelperForIpv4, public AsciiTraceHelperForIpv6
@@ -211,6 +217,19 @@ public:
    */
   void SetIpv6StackInstall (bool enable);
 
+  /**
+   * \brief Enable/disable the forwarding-only mode.
+   *
+   * In the forwarding-only mode, the transport protocols (UDP and TCP) and
+   * the PacketSocketFactory are not installed, hence no application can run
+   * on the node. Enabling the mode also disables the IPv6 stack install:
+   * call SetIpv6StackInstall (true) afterwards to install IPv6 (with
+   * ICMPv6) as well.
+   *
+   * \param enable enable state
+   */
+  void SetForwardingOnly (bool enable);
+
   /**
    * \brief Enable/disable IPv4 ARP Jitter.
    * \param enable enable state
@@ -369,6 +388,11 @@ private:
    * \brief IPv6 IPv6 NS and RS Jitter state (enabled/disabled) ?
    */
   bool m_ipv6NsRsJitterEnabled;
+
+  /**
+   * \brief Install only the components needed to forward packets.
+   */
+  bool m_forwardingOnly;
 };
 
 } // namespace ns3
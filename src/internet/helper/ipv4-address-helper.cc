@@ -17,6 +17,7 @@
  */
 
 #include "ns3/assert.h"
+#include "ns3/abort.h"
 #include "ns3/log.h"
 #include "ns3/ptr.h"
 #include "ns3/node.h"
@@ -136,54 +137,87 @@ Ipv4AddressHelper::Assign (const NetDeviceContainer &c)
 {
   NS_LOG_FUNCTION_NOARGS ();
   Ipv4InterfaceContainer retval;
-  for (uint32_t i = 0; i < c.GetN (); ++i) {
-      Ptr<NetDevice> device = c.Get (i);
-
-      Ptr<Node> node = device->GetNode ();
-      NS_ASSERT_MSG (node, "Ipv4AddressHelper::Assign(): NetDevice is not not associated "
-                     "with any node -> fail");
-
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      NS_ASSERT_MSG (ipv4, "Ipv4AddressHelper::Assign(): NetDevice is associated"
-                     " with a node without IPv4 stack installed -> fail "
-                     "(maybe need to use InternetStackHelper?)");
+  TcHelperMap tcHelpers;
+  for (uint32_t i = 0; i < c.GetN (); ++i)
+    {
+      std::pair<Ptr<Ipv4>, uint32_t> interface = AssignDevice (c.Get (i), tcHelpers);
+      retval.Add (interface.first, interface.second);
+    }
+  return retval;
+}
 
-      int32_t interface = ipv4->GetInterfaceForDevice (device);
-      if (interface == -1)
+Ipv4InterfaceContainer
+Ipv4AddressHelper::AssignLinks (const NetDeviceContainer &c, uint32_t devicesPerLink)
+{
+  NS_LOG_FUNCTION (this << c.GetN () << devicesPerLink);
+  NS_ABORT_MSG_IF (devicesPerLink == 0 || c.GetN () % devicesPerLink != 0,
+                   "Ipv4AddressHelper::AssignLinks(): the number of devices (" << c.GetN ()
+                   << ") is not a multiple of the number of devices per link (" << devicesPerLink << ")");
+  Ipv4InterfaceContainer retval;
+  TcHelperMap tcHelpers;
+  for (uint32_t i = 0; i < c.GetN (); ++i)
+    {
+      std::pair<Ptr<Ipv4>, uint32_t> interface = AssignDevice (c.Get (i), tcHelpers);
+      retval.Add (interface.first, interface.second);
+      if ((i + 1) % devicesPerLink == 0)
         {
-          interface = ipv4->AddInterface (device);
+          NewNetwork ();
         }
-      NS_ASSERT_MSG (interface >= 0, "Ipv4AddressHelper::Assign(): "
-                     "Interface index not found");
-
-      Ipv4InterfaceAddress ipv4Addr = Ipv4InterfaceAddress (NewAddress (), m_mask);
-      ipv4->AddAddress (interface, ipv4Addr);
-      ipv4->SetMetric (interface, 1);
-      ipv4->SetUp (interface);
-      retval.Add (ipv4, interface);
-
-      // Install the default traffic control configuration if the traffic
-      // control layer has been aggregated, if this is not 
-      // a loopback interface, and there is no queue disc installed already
-      Ptr<TrafficControlLayer> tc = node->GetObject<TrafficControlLayer> ();
-      if (tc && DynamicCast<LoopbackNetDevice> (device) == 0 && tc->GetRootQueueDiscOnDevice (device) == 0)
+    }
+  return retval;
+}
+
+std::pair<Ptr<Ipv4>, uint32_t>
+Ipv4AddressHelper::AssignDevice (Ptr<NetDevice> device, TcHelperMap &tcHelpers)
+{
+  Ptr<Node> node = device->GetNode ();
+  NS_ASSERT_MSG (node, "Ipv4AddressHelper::Assign(): NetDevice is not not associated "
+                 "with any node -> fail");
+
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, "Ipv4AddressHelper::Assign(): NetDevice is associated"
+                 " with a node without IPv4 stack installed -> fail "
+                 "(maybe need to use InternetStackHelper?)");
+
+  int32_t interface = ipv4->GetInterfaceForDevice (device);
+  if (interface == -1)
+    {
+      interface = ipv4->AddInterface (device);
+    }
+  NS_ASSERT_MSG (interface >= 0, "Ipv4AddressHelper::Assign(): "
+                 "Interface index not found");
+
+  Ipv4InterfaceAddress ipv4Addr = Ipv4InterfaceAddress (NewAddress (), m_mask);
+  ipv4->AddAddress (interface, ipv4Addr);
+  ipv4->SetMetric (interface, 1);
+  ipv4->SetUp (interface);
+
+  // Install the default traffic control configuration if the traffic
+  // control layer has been aggregated, if this is not 
+  // a loopback interface, and there is no queue disc installed already
+  Ptr<TrafficControlLayer> tc = node->GetObject<TrafficControlLayer> ();
+  if (tc && DynamicCast<LoopbackNetDevice> (device) == 0 && tc->GetRootQueueDiscOnDevice (device) == 0)
+    {
+      Ptr<NetDeviceQueueInterface> ndqi = device->GetObject<NetDeviceQueueInterface> ();
+      // It is useless to install a queue disc if the device has no
+      // NetDeviceQueueInterface attached: the device queue is never
+      // stopped and every packet enqueued in the queue disc is
+      // immediately dequeued, hence there will never be backlog
+      if (ndqi)
         {
-          Ptr<NetDeviceQueueInterface> ndqi = device->GetObject<NetDeviceQueueInterface> ();
-          // It is useless to install a queue disc if the device has no
-          // NetDeviceQueueInterface attached: the device queue is never
-          // stopped and every packet enqueued in the queue disc is
-          // immediately dequeued, hence there will never be backlog
-          if (ndqi)
+          std::size_t nTxQueues = ndqi->GetNTxQueues ();
+          NS_LOG_LOGIC ("Installing default traffic control configuration ("
+                        << nTxQueues << " device queue(s))");
+          // the default configuration is built once per number of device queues
+          TcHelperMap::iterator it = tcHelpers.find (nTxQueues);
+          if (it == tcHelpers.end ())
             {
-              std::size_t nTxQueues = ndqi->GetNTxQueues ();
-              NS_LOG_LOGIC ("Installing default traffic control configuration ("
-                            << nTxQueues << " device queue(s))");
-              TrafficControlHelper tcHelper = TrafficControlHelper::Default (nTxQueues);
-              tcHelper.Install (device);
+              it = tcHelpers.insert ({nTxQueues, TrafficControlHelper::Default (nTxQueues)}).first;
             }
+          it->second.Install (device);
         }
     }
-  return retval;
+  return std::make_pair (ipv4, static_cast<uint32_t> (interface));
 }
 
 const uint32_t N_BITS = 32; //!< number of bits in a IPv4 address
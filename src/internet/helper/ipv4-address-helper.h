@@ -19,12 +19,15 @@
 #ifndef IPV4_ADDRESS_HELPER_H
 #define IPV4_ADDRESS_HELPER_H
 
+#include <map>
 #include "ns3/ipv4-address.h"
 #include "ns3/net-device-container.h"
 #include "ipv4-interface-container.h"
 
 namespace ns3 {
 
+class TrafficControlHelper;
+
 /**
  * \ingroup ipv4Helpers
  *
@@ -180,7 +183,38 @@ public:
  */
   Ipv4InterfaceContainer Assign (const NetDeviceContainer &c);
 
+/**
+ * @brief Assign a distinct network to each group of consecutive net devices
+ * in the container.
+ *
+ * This method is equivalent to calling Assign on each group of
+ * devicesPerLink consecutive net devices (e.g., the two devices of each
+ * point-to-point link, as returned by PointToPointHelper::Install), followed
+ * by NewNetwork, but it processes the whole container in a single pass: the
+ * default traffic control configuration is built once rather than for each
+ * device. After the call, the helper is set on a new network.
+ *
+ * @param c The NetDeviceContainer holding the net devices of all the links.
+ * @param devicesPerLink The number of net devices of each link.
+ *
+ * @returns A container holding the added interfaces, in the order of the
+ * net devices
+ * @see Assign
+ */
+  Ipv4InterfaceContainer AssignLinks (const NetDeviceContainer &c, uint32_t devicesPerLink = 2);
+
 private:
+  /// Default traffic control helpers, by number of device transmission queues
+  typedef std::map<std::size_t, TrafficControlHelper> TcHelperMap;
+
+  /**
+   * \brief Assign a new address of the current network to a net device
+   * \param device the net device
+   * \param tcHelpers the default traffic control helpers built so far
+   * \returns the Ipv4 object and the index of the interface of the device
+   */
+  std::pair<Ptr<Ipv4>, uint32_t> AssignDevice (Ptr<NetDevice> device, TcHelperMap &tcHelpers);
+
   /**
    * \brief Returns the number of address bits (hostpart) for a given netmask
    * \param maskbits the netmask
@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/channel.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/ipv4.h"
+#include "ns3/global-route-manager.h"
+#include "link-failure-helper.h"
+#include <set>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LinkFailureHelper");
+
+LinkFailureHelper::LinkFailureHelper ()
+{
+  m_ttf = CreateObjectWithAttributes<ExponentialRandomVariable> ("Mean", DoubleValue (10));
+  m_ttr = CreateObjectWithAttributes<ExponentialRandomVariable> ("Mean", DoubleValue (1));
+}
+
+void
+LinkFailureHelper::SetTimeToFailure (Ptr<RandomVariableStream> ttf)
+{
+  m_ttf = ttf;
+}
+
+void
+LinkFailureHelper::SetTimeToRepair (Ptr<RandomVariableStream> ttr)
+{
+  m_ttr = ttr;
+}
+
+void
+LinkFailureHelper::SetLinkState (Ptr<NetDevice> device, bool up)
+{
+  NS_LOG_FUNCTION (device << up);
+  Ptr<Channel> channel = device->GetChannel ();
+  uint32_t nDevices = (channel ? channel->GetNDevices () : 1);
+  // change the state of all the devices of the link before updating the
+  // routes, so that they are updated once, and not from a half-down link
+  GlobalRouteManager::DeferUpdates ();
+  for (uint32_t i = 0; i < nDevices; i++)
+    {
+      Ptr<NetDevice> nd = (channel ? channel->GetDevice (i) : device);
+      Ptr<Ipv4> ipv4 = nd->GetNode ()->GetObject<Ipv4> ();
+      if (ipv4 == 0)
+        {
+          continue;
+        }
+      int32_t interface = ipv4->GetInterfaceForDevice (nd);
+      if (interface < 0 || ipv4->IsUp (interface) == up)
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("Setting interface " << interface << " of node " << nd->GetNode ()->GetId ()
+                    << (up ? " up" : " down"));
+      if (up)
+        {
+          ipv4->SetUp (interface);
+        }
+      else
+        {
+          ipv4->SetDown (interface);
+        }
+    }
+  GlobalRouteManager::ResumeUpdates ();
+}
+
+void
+LinkFailureHelper::SetLinkDown (Ptr<NetDevice> device)
+{
+  SetLinkState (device, false);
+}
+
+void
+LinkFailureHelper::SetLinkUp (Ptr<NetDevice> device)
+{
+  SetLinkState (device, true);
+}
+
+bool
+LinkFailureHelper::IsLinkUp (Ptr<NetDevice> device)
+{
+  Ptr<Channel> channel = device->GetChannel ();
+  uint32_t nDevices = (channel ? channel->GetNDevices () : 1);
+  for (uint32_t i = 0; i < nDevices; i++)
+    {
+      Ptr<NetDevice> nd = (channel ? channel->GetDevice (i) : device);
+      Ptr<Ipv4> ipv4 = nd->GetNode ()->GetObject<Ipv4> ();
+      int32_t interface = (ipv4 ? ipv4->GetInterfaceForDevice (nd) : -1);
+      if (interface >= 0 && !ipv4->IsUp (interface))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+LinkFailureHelper::ScheduleFailure (Ptr<NetDevice> device, Time failure, Time repair) const
+{
+  NS_LOG_FUNCTION (this << device << failure << repair);
+  NS_ASSERT_MSG (failure <= repair, "The link must fail before being repaired");
+  Simulator::Schedule (failure, &LinkFailureHelper::SetLinkDown, device);
+  Simulator::Schedule (repair, &LinkFailureHelper::SetLinkUp, device);
+}
+
+void
+LinkFailureHelper::InstallRandomFailures (const NetDeviceContainer &c, Time start, Time stop) const
+{
+  NS_LOG_FUNCTION (this << start << stop);
+  std::set<Ptr<Channel> > done;
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Channel> channel = (*i)->GetChannel ();
+      if (channel != 0 && !done.insert (channel).second)
+        {
+          continue;
+        }
+      Time failure = start + Seconds (m_ttf->GetValue ());
+      if (failure < stop)
+        {
+          Simulator::Schedule (failure, &LinkFailureHelper::RandomFailure, *i,
+                               m_ttf, m_ttr, Simulator::Now () + stop);
+        }
+    }
+}
+
+void
+LinkFailureHelper::RandomFailure (Ptr<NetDevice> device, Ptr<RandomVariableStream> ttf,
+                                  Ptr<RandomVariableStream> ttr, Time stop)
+{
+  NS_LOG_FUNCTION (device << stop);
+  SetLinkDown (device);
+  Simulator::Schedule (Seconds (ttr->GetValue ()), &LinkFailureHelper::RandomRepair, device,
+                       ttf, ttr, stop);
+}
+
+void
+LinkFailureHelper::RandomRepair (Ptr<NetDevice> device, Ptr<RandomVariableStream> ttf,
+                                 Ptr<RandomVariableStream> ttr, Time stop)
+{
+  NS_LOG_FUNCTION (device << stop);
+  SetLinkUp (device);
+  Time failure = Seconds (ttf->GetValue ());
+  if (Simulator::Now () + failure < stop)
+    {
+      Simulator::Schedule (failure, &LinkFailureHelper::RandomFailure, device, ttf, ttr, stop);
+    }
+}
+
+int64_t
+LinkFailureHelper::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_ttf->SetStream (stream);
+  m_ttr->SetStream (stream + 1);
+  return 2;
+}
+
+} // namespace ns3
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef LINK_FAILURE_HELPER_H
+#define LINK_FAILURE_HELPER_H
+
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/net-device.h"
+#include "ns3/net-device-container.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Helpers
+ *
+ * \brief Helper class that fails and repairs links at given or random times.
+ *
+ * A link is the channel a device is attached to: failing a link sets down
+ * (Ipv4::SetDown) the IPv4 interfaces of all the devices attached to the
+ * channel, and repairing it sets them up again. The routing protocols are
+ * notified as for any interface going down or up; in particular, global
+ * routing recomputes its routes if its RespondToInterfaceEvents attribute
+ * is set, and only recomputes the routes affected by the link if its
+ * IncrementalUpdates attribute is set as well. Global routing updates its
+ * routes once, after all the devices of the link changed state.
+ *
+ * Failures can be scheduled at given times or drawn from a time to failure
+ * (whose mean is the MTBF) and a time to repair (whose mean is the MTTR)
+ * random variable, both exponential by default.
+ */
+class LinkFailureHelper
+{
+public:
+  /**
+   * \brief Construct a helper with exponential times to failure and to
+   * repair, whose means are 10 and 1 seconds.
+   */
+  LinkFailureHelper ();
+
+  /**
+   * \brief Set the random variable of the time between the repair of a link
+   * and its next failure.
+   * \param ttf the random variable, in seconds
+   */
+  void SetTimeToFailure (Ptr<RandomVariableStream> ttf);
+
+  /**
+   * \brief Set the random variable of the time needed to repair a link.
+   * \param ttr the random variable, in seconds
+   */
+  void SetTimeToRepair (Ptr<RandomVariableStream> ttr);
+
+  /**
+   * \brief Fail the link of a device now.
+   * \param device a device attached to the link
+   */
+  static void SetLinkDown (Ptr<NetDevice> device);
+
+  /**
+   * \brief Repair the link of a device now.
+   * \param device a device attached to the link
+   */
+  static void SetLinkUp (Ptr<NetDevice> device);
+
+  /**
+   * \param device a device attached to the link
+   * \returns true if the IPv4 interfaces of all the devices attached to the
+   * link are up
+   */
+  static bool IsLinkUp (Ptr<NetDevice> device);
+
+  /**
+   * \brief Schedule a failure of the link of a device.
+   * \param device a device attached to the link
+   * \param failure the time of the failure, relative to now
+   * \param repair the time of the repair, relative to now
+   */
+  void ScheduleFailure (Ptr<NetDevice> device, Time failure, Time repair) const;
+
+  /**
+   * \brief Fail and repair the links of the given devices at random times.
+   *
+   * Each link (whether one or several of its devices are in the container)
+   * fails after a time to failure from the start time, is repaired after a
+   * time to repair, fails again after a time to failure, and so on. No
+   * failure occurs after the stop time, but a link failed before the stop
+   * time is repaired.
+   *
+   * \param c the devices
+   * \param start the start time, relative to now
+   * \param stop the stop time, relative to now
+   */
+  void InstallRandomFailures (const NetDeviceContainer &c, Time start, Time stop) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this helper. Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this helper
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
+  /**
+   * \brief Fail a link and schedule its repair and next random failure.
+   * \param device a device attached to the link
+   * \param ttf the time to failure
+   * \param ttr the time to repair
+   * \param stop the absolute stop time
+   */
+  static void RandomFailure (Ptr<NetDevice> device, Ptr<RandomVariableStream> ttf,
+                             Ptr<RandomVariableStream> ttr, Time stop);
+
+  /**
+   * \brief Repair a link and schedule its next random failure.
+   * \param device a device attached to the link
+   * \param ttf the time to failure
+   * \param ttr the time to repair
+   * \param stop the absolute stop time
+   */
+  static void RandomRepair (Ptr<NetDevice> device, Ptr<RandomVariableStream> ttf,
+                            Ptr<RandomVariableStream> ttr, Time stop);
+
+  /**
+   * \brief Set the IPv4 interfaces of the devices attached to a link up or down.
+   * \param device a device attached to the link
+   * \param up true to set the interfaces up
+   */
+  static void SetLinkState (Ptr<NetDevice> device, bool up);
+
+  Ptr<RandomVariableStream> m_ttf; //!< Time to failure, in seconds
+  Ptr<RandomVariableStream> m_ttr; //!< Time to repair, in seconds
+};
+
+} // namespace ns3
+
+#endif /* LINK_FAILURE_HELPER_H */
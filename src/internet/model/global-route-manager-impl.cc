@@ -27,10 +27,17 @@
 #include <queue>
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <iterator>
+#include <map>
+#include <tuple>
+#include <set>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
@@ -494,17 +501,44 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
 
+void
+GlobalRouteManagerLSDB::Replace (Ipv4Address addr, GlobalRoutingLSA* lsa)
+{
+  NS_LOG_FUNCTION (this << addr << lsa);
+  NS_ASSERT (lsa->GetLSType () != GlobalRoutingLSA::ASExternalLSAs);
+  LSDBMap_t::iterator i = m_database.find (addr);
+  if (i != m_database.end ())
+    {
+      delete i->second;
+      i->second = lsa;
+    }
+  else
+    {
+      m_database.insert (LSDBPair_t (addr, lsa));
+    }
+}
+
+std::vector<GlobalRoutingLSA*>
+GlobalRouteManagerLSDB::GetLSAs (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<GlobalRoutingLSA*> lsas;
+  lsas.reserve (m_database.size ());
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      lsas.push_back (i->second);
+    }
+  return lsas;
+}
+
 GlobalRoutingLSA*
 GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
@@ -538,7 +572,9 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_deferUpdates (false),
+    m_deferredFullUpdate (false)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -577,19 +613,7 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
         {
           continue;
         }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteRoutes (router);
     }
   if (m_lsdb)
     {
@@ -599,6 +623,24 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
     }
 }
 
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<GlobalRouter> router)
+{
+  NS_LOG_FUNCTION (this << router);
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << nRoutes << " routes from router " << router->GetRouterId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from router " << router->GetRouterId ());
+}
+
 //
 // In order to build the routing database, we need to walk the list of nodes
 // in the system and look for those that support the GlobalRouter interface.
@@ -729,6 +771,611 @@ GlobalRouteManagerImpl::InitializeRoutes ()
   NS_LOG_INFO ("Finished SPF calculation");
 }
 
+//
+// When the link of a device goes up or down, only the LSAs of the routers
+// attached to the link change.  These routers compute their shortest paths
+// again.  Another router R only needs to change its routes to a router D
+// (to the addresses and networks advertised by D) if its exits towards D
+// change, which requires the distances to D to change or D to advertise
+// other prefixes:
+//
+// - removing the link x->y changes the distances to D only if it was the
+//   only shortest path from x to D, and it matters to other routers only if
+//   x is on a shortest path from one of its neighbors to D;
+// - adding the link x->y changes the distances to D only if it makes the
+//   path from x to D shorter, and it matters to other routers only if the
+//   path from one of the neighbors of x to D through x becomes a shortest
+//   one.
+//
+// These tests only need the distances to D from x, y and their neighbors,
+// computed with a Dijkstra calculation from each of them.  Then, for each
+// destination D that passes them, the distances of all the routers to D
+// before and after the change are computed (two Dijkstra calculations on
+// the reversed graphs), and the exits of each router towards D, namely its
+// links on a shortest path to D, are compared.  The routes via the old exits
+// are replaced with routes via the new exits for the prefixes of D.
+//
+// The LSA index and the graphs before and after the change are rebuilt from
+// the LSDB on every update, which takes a scan of all the link records.  The
+// cost of an update is therefore that scan, a few Dijkstra calculations on
+// the whole graph per affected destination, and the replacement of the
+// routes which change, instead of a shortest path calculation per router
+// for a full recomputation.
+//
+void
+GlobalRouteManagerImpl::UpdateRoutes (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  std::vector<Ptr<GlobalRouter> > routers;
+  Ptr<Channel> channel = device->GetChannel ();
+  uint32_t nDevices = (channel ? channel->GetNDevices () : 1);
+  for (uint32_t i = 0; i < nDevices; i++)
+    {
+      Ptr<NetDevice> nd = (channel ? channel->GetDevice (i) : device);
+      Ptr<GlobalRouter> rtr = nd->GetNode ()->GetObject<GlobalRouter> ();
+      if (rtr && std::find (routers.begin (), routers.end (), rtr) == routers.end ())
+        {
+          routers.push_back (rtr);
+        }
+    }
+
+  if (!UpdateRoutesIncrementally (routers))
+    {
+      NS_LOG_LOGIC ("Recomputing all the routes");
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+    }
+}
+
+void
+GlobalRouteManagerImpl::DeferUpdates ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (!m_deferUpdates, "The route updates are already deferred");
+  m_deferUpdates = true;
+}
+
+bool
+GlobalRouteManagerImpl::DeferUpdate (Ptr<NetDevice> device, bool incremental)
+{
+  NS_LOG_FUNCTION (this << device << incremental);
+  if (!m_deferUpdates)
+    {
+      return false;
+    }
+  if (incremental)
+    {
+      m_deferredDevices.push_back (device);
+    }
+  else
+    {
+      m_deferredFullUpdate = true;
+    }
+  return true;
+}
+
+void
+GlobalRouteManagerImpl::ResumeUpdates ()
+{
+  NS_LOG_FUNCTION (this);
+  m_deferUpdates = false;
+  std::vector<Ptr<NetDevice> > devices;
+  devices.swap (m_deferredDevices);
+  if (m_deferredFullUpdate)
+    {
+      NS_LOG_LOGIC ("Recomputing all the routes");
+      m_deferredFullUpdate = false;
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+  // UpdateRoutes handles all the devices attached to the channel of a device
+  std::set<Ptr<Channel> > channels;
+  for (uint32_t i = 0; i < devices.size (); i++)
+    {
+      Ptr<Channel> channel = devices[i]->GetChannel ();
+      if (channel == 0 || channels.insert (channel).second)
+        {
+          UpdateRoutes (devices[i]);
+        }
+    }
+}
+
+namespace {
+
+/// Links of each router of the LSDB: (index of the neighbor, metric)
+typedef std::vector<std::vector<std::pair<uint32_t, uint32_t> > > Adjacency_t;
+
+/// Distance to an unreachable router
+const uint64_t INFINITE_DISTANCE = std::numeric_limits<uint64_t>::max ();
+
+/**
+ * \brief Dijkstra calculation of the distances from a router
+ * \param adjacency the links of each router (reversed to get the distances to the router)
+ * \param source the index of the router
+ * \param distance the distances
+ */
+void
+ComputeDistances (const Adjacency_t &adjacency, uint32_t source, std::vector<uint64_t> &distance)
+{
+  typedef std::pair<uint64_t, uint32_t> Item_t;
+  std::priority_queue<Item_t, std::vector<Item_t>, std::greater<Item_t> > queue;
+  distance.assign (adjacency.size (), INFINITE_DISTANCE);
+  distance[source] = 0;
+  queue.push (Item_t (0, source));
+  while (!queue.empty ())
+    {
+      Item_t item = queue.top ();
+      queue.pop ();
+      if (item.first > distance[item.second])
+        {
+          continue;
+        }
+      const std::vector<std::pair<uint32_t, uint32_t> > &links = adjacency[item.second];
+      for (uint32_t j = 0; j < links.size (); j++)
+        {
+          uint64_t d = item.first + links[j].second;
+          if (d < distance[links[j].first])
+            {
+              distance[links[j].first] = d;
+              queue.push (Item_t (d, links[j].first));
+            }
+        }
+    }
+}
+
+/**
+ * \brief Get the distances from a router, computing them the first time
+ * \param adjacency the links of each router
+ * \param source the index of the router
+ * \param cache the distances already computed
+ * \returns the distances from the router
+ */
+const std::vector<uint64_t> &
+GetDistances (const Adjacency_t &adjacency, uint32_t source,
+              std::map<uint32_t, std::vector<uint64_t> > &cache)
+{
+  std::map<uint32_t, std::vector<uint64_t> >::iterator it = cache.find (source);
+  if (it == cache.end ())
+    {
+      it = cache.insert (std::make_pair (source, std::vector<uint64_t> ())).first;
+      ComputeDistances (adjacency, source, it->second);
+    }
+  return it->second;
+}
+
+/// A prefix advertised by a router: (host route, address, mask)
+typedef std::tuple<bool, uint32_t, uint32_t> Prefix_t;
+
+/**
+ * \brief Get the sorted prefixes that the routes to a router lead to
+ * \param lsa the router LSA
+ * \param prefixes the prefixes
+ */
+void
+GetPrefixes (GlobalRoutingLSA *lsa, std::vector<Prefix_t> &prefixes)
+{
+  for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+    {
+      GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+      if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+        {
+          prefixes.push_back (Prefix_t (true, l->GetLinkData ().Get (), Ipv4Mask::GetOnes ().Get ()));
+        }
+      else if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+        {
+          Ipv4Mask mask (l->GetLinkData ().Get ());
+          prefixes.push_back (Prefix_t (false, l->GetLinkId ().CombineMask (mask).Get (), mask.Get ()));
+        }
+    }
+  std::sort (prefixes.begin (), prefixes.end ());
+}
+
+} // anonymous namespace
+
+bool
+GlobalRouteManagerImpl::UpdateRoutesIncrementally (const std::vector<Ptr<GlobalRouter> > &routers)
+{
+  NS_LOG_FUNCTION (this);
+  if (routers.empty () || m_lsdb->GetNumExtLSAs () > 0)
+    {
+      return false;
+    }
+//
+// Index the routers of the LSDB, and discover the new LSAs of the routers
+// attached to the link.  lsas[0] holds the old LSAs and lsas[1] the new ones.
+//
+  std::vector<GlobalRoutingLSA*> lsas[2];
+  lsas[0] = m_lsdb->GetLSAs ();
+  uint32_t n = lsas[0].size ();
+  std::map<Ipv4Address, uint32_t> index;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      index[lsas[0][i]->GetLinkStateId ()] = i;
+    }
+  lsas[1] = lsas[0];
+  std::vector<GlobalRoutingLSA*> newLsas;
+  std::vector<bool> changed (n, false);
+  bool supported = true;
+  for (uint32_t r = 0; r < routers.size () && supported; r++)
+    {
+      std::map<Ipv4Address, uint32_t>::const_iterator it = index.find (routers[r]->GetRouterId ());
+      if (it == index.end () || changed[it->second] || routers[r]->DiscoverLSAs () != 1)
+        {
+          supported = false;
+          break;
+        }
+      GlobalRoutingLSA* lsa = new GlobalRoutingLSA ();
+      routers[r]->GetLSA (0, *lsa);
+      newLsas.push_back (lsa);
+      changed[it->second] = true;
+      lsas[1][it->second] = lsa;
+    }
+//
+// Build the graphs of the point-to-point links before and after the change.
+// Network LSAs, transit links, null metrics and parallel links between the
+// routers attached to the link are not supported.
+//
+  Adjacency_t links[2];
+  Adjacency_t reversed[2];
+  for (uint32_t g = 0; g < 2 && supported; g++)
+    {
+      links[g].resize (n);
+      reversed[g].resize (n);
+      for (uint32_t i = 0; i < n && supported; i++)
+        {
+          GlobalRoutingLSA* lsa = lsas[g][i];
+          supported = (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA);
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords () && supported; j++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+                {
+                  std::map<Ipv4Address, uint32_t>::const_iterator w = index.find (l->GetLinkId ());
+                  supported = (w != index.end () && l->GetMetric () > 0);
+                  for (uint32_t k = 0; supported && changed[i] && k < links[g][i].size (); k++)
+                    {
+                      supported = (links[g][i][k].first != w->second);
+                    }
+                  if (supported)
+                    {
+                      links[g][i].push_back (std::make_pair (w->second, l->GetMetric ()));
+                      reversed[g][w->second].push_back (std::make_pair (i, l->GetMetric ()));
+                    }
+                }
+              else if (l->GetLinkType () != GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  supported = false;
+                }
+            }
+        }
+    }
+  if (!supported)
+    {
+      for (uint32_t i = 0; i < newLsas.size (); i++)
+        {
+          delete newLsas[i];
+        }
+      return false;
+    }
+//
+// Find the destinations whose distances may change for a router which is
+// not attached to the link.  The distances are computed on the old graph
+// (the distances from the end points of an added link do not depend on it).
+//
+  std::vector<bool> affected (changed);
+  std::map<uint32_t, std::vector<uint64_t> > from;
+  for (uint32_t x = 0; x < n; x++)
+    {
+      if (!changed[x])
+        {
+          continue;
+        }
+      std::map<uint32_t, uint32_t> metric[2];
+      for (uint32_t g = 0; g < 2; g++)
+        {
+          for (uint32_t k = 0; k < links[g][x].size (); k++)
+            {
+              metric[g][links[g][x][k].first] = links[g][x][k].second;
+            }
+        }
+      const std::vector<uint64_t> &dx = GetDistances (links[0], x, from);
+      for (uint32_t g = 0; g < 2; g++)
+        {
+          for (std::map<uint32_t, uint32_t>::const_iterator e = metric[g].begin (); e != metric[g].end (); e++)
+            {
+              std::map<uint32_t, uint32_t>::const_iterator o = metric[1 - g].find (e->first);
+              if (o != metric[1 - g].end () && o->second == e->second)
+                {
+                  continue;
+                }
+              uint32_t y = e->first;
+              uint64_t c = e->second;
+              const std::vector<uint64_t> &dy = GetDistances (links[0], y, from);
+              for (uint32_t d = 0; d < n; d++)
+                {
+                  if (affected[d] || dy[d] == INFINITE_DISTANCE)
+                    {
+                      continue;
+                    }
+                  bool matters = false;
+                  if (g == 0 && dx[d] == c + dy[d])
+                    {
+                      // removed link on a shortest path from x: is there another one?
+                      matters = true;
+                      for (uint32_t k = 0; k < links[1][x].size () && matters; k++)
+                        {
+                          uint32_t z = links[1][x][k].first;
+                          std::map<uint32_t, uint32_t>::const_iterator oz = metric[0].find (z);
+                          if (oz == metric[0].end () || oz->second != links[1][x][k].second)
+                            {
+                              continue;
+                            }
+                          const std::vector<uint64_t> &dz = GetDistances (links[0], z, from);
+                          matters = !(dz[d] != INFINITE_DISTANCE && dx[d] == oz->second + dz[d]);
+                        }
+                      // is x on a shortest path from one of its neighbors?
+                      bool used = false;
+                      for (uint32_t k = 0; k < reversed[0][x].size () && matters && !used; k++)
+                        {
+                          const std::vector<uint64_t> &du = GetDistances (links[0], reversed[0][x][k].first, from);
+                          used = (du[d] == reversed[0][x][k].second + dx[d]);
+                        }
+                      matters = used;
+                    }
+                  else if (g == 1 && c + dy[d] < dx[d])
+                    {
+                      // added link shortening the paths from x: does a neighbor use them?
+                      for (uint32_t k = 0; k < reversed[0][x].size () && !matters; k++)
+                        {
+                          const std::vector<uint64_t> &du = GetDistances (links[0], reversed[0][x][k].first, from);
+                          matters = (reversed[0][x][k].first != y
+                                     && reversed[0][x][k].second + c + dy[d] <= du[d]);
+                        }
+                    }
+                  affected[d] = matters;
+                }
+            }
+        }
+    }
+//
+// Collect the links of the routers which keep their shortest paths
+// calculation: the local routers which are not attached to the link and
+// are not stub routers (the default route of a stub router does not depend
+// on the other links).
+//
+  struct Exit
+  {
+    uint32_t neighbor;         //!< index of the neighbor
+    uint32_t metric;           //!< metric of the link
+    int32_t outIf;             //!< outgoing interface
+    bool valid[2];             //!< whether the neighbor has a link back, before and after
+    Ipv4Address nextHop[2];    //!< address of the neighbor, before and after
+  };
+  struct Router
+  {
+    uint32_t index;            //!< index of the router
+    Ptr<Ipv4GlobalRouting> routing;                    //!< routing protocol
+    std::vector<Exit> exits;                           //!< links of the router
+    std::vector<Ipv4RoutingTableEntry> removed;        //!< routes to remove
+    std::vector<std::pair<bool, Ipv4RoutingTableEntry> > added;  //!< (host route, route) to add
+  };
+  std::vector<Router> others;
+  uint32_t systemId = Simulator::GetSystemId ();
+  for (uint32_t r = 0; r < n; r++)
+    {
+      Ptr<Node> node = lsas[0][r]->GetNode ();
+      if (changed[r] || node == 0 || node->GetSystemId () != systemId || IsStubRouter (lsas[0][r]))
+        {
+          continue;
+        }
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      NS_ASSERT (rtr && ipv4);
+      Router router;
+      router.index = r;
+      router.routing = rtr->GetRoutingProtocol ();
+      for (uint32_t j = 0; j < lsas[0][r]->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *l = lsas[0][r]->GetLinkRecord (j);
+          if (l->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+            {
+              continue;
+            }
+          Exit exit;
+          exit.neighbor = index[l->GetLinkId ()];
+          exit.metric = l->GetMetric ();
+          exit.outIf = ipv4->GetInterfaceForPrefix (l->GetLinkData (), Ipv4Mask::GetOnes ());
+          for (uint32_t g = 0; g < 2; g++)
+            {
+              exit.valid[g] = false;
+              GlobalRoutingLSA *w = lsas[g][exit.neighbor];
+              for (uint32_t k = 0; k < w->GetNLinkRecords () && !exit.valid[g]; k++)
+                {
+                  GlobalRoutingLinkRecord *back = w->GetLinkRecord (k);
+                  if (back->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+                      && back->GetLinkId () == lsas[0][r]->GetLinkStateId ())
+                    {
+                      exit.valid[g] = true;
+                      exit.nextHop[g] = back->GetLinkData ();
+                    }
+                }
+            }
+          router.exits.push_back (exit);
+        }
+      others.push_back (router);
+    }
+//
+// For each affected destination, compare the exits of the other routers
+// before and after the change, and collect the routes to replace.
+//
+  uint32_t nAffected = 0;
+  for (uint32_t d = 0; d < n; d++)
+    {
+      if (!affected[d])
+        {
+          continue;
+        }
+      nAffected++;
+      std::vector<uint64_t> to[2];
+      std::vector<Prefix_t> prefixes[2];
+      for (uint32_t g = 0; g < 2; g++)
+        {
+          ComputeDistances (reversed[g], d, to[g]);
+          GetPrefixes (lsas[g][d], prefixes[g]);
+        }
+      for (std::vector<Router>::iterator r = others.begin (); r != others.end (); r++)
+        {
+          if (r->index == d)
+            {
+              continue;
+            }
+          std::vector<SPFVertex::NodeExit_t> exits[2];
+          for (uint32_t g = 0; g < 2; g++)
+            {
+              uint64_t distance = to[g][r->index];
+              for (uint32_t k = 0; k < r->exits.size () && distance != INFINITE_DISTANCE; k++)
+                {
+                  const Exit &e = r->exits[k];
+                  if (e.valid[g] && e.outIf >= 0 && to[g][e.neighbor] != INFINITE_DISTANCE
+                      && e.metric + to[g][e.neighbor] == distance)
+                    {
+                      exits[g].push_back (SPFVertex::NodeExit_t (e.nextHop[g], e.outIf));
+                    }
+                }
+              std::sort (exits[g].begin (), exits[g].end ());
+              exits[g].erase (std::unique (exits[g].begin (), exits[g].end ()), exits[g].end ());
+            }
+          std::vector<Prefix_t> replaced[2];
+          if (exits[0] == exits[1])
+            {
+              if (prefixes[0] == prefixes[1])
+                {
+                  continue;
+                }
+              std::set_difference (prefixes[0].begin (), prefixes[0].end (),
+                                   prefixes[1].begin (), prefixes[1].end (),
+                                   std::back_inserter (replaced[0]));
+              std::set_difference (prefixes[1].begin (), prefixes[1].end (),
+                                   prefixes[0].begin (), prefixes[0].end (),
+                                   std::back_inserter (replaced[1]));
+            }
+          else
+            {
+              replaced[0] = prefixes[0];
+              replaced[1] = prefixes[1];
+            }
+          for (uint32_t g = 0; g < 2; g++)
+            {
+              for (uint32_t p = 0; p < replaced[g].size (); p++)
+                {
+                  bool host = std::get<0> (replaced[g][p]);
+                  Ipv4Address dest (std::get<1> (replaced[g][p]));
+                  Ipv4Mask mask (std::get<2> (replaced[g][p]));
+                  for (uint32_t k = 0; k < exits[g].size (); k++)
+                    {
+                      Ipv4RoutingTableEntry route =
+                        Ipv4RoutingTableEntry::CreateNetworkRouteTo (dest, mask, exits[g][k].first,
+                                                                     exits[g][k].second);
+                      if (g == 0)
+                        {
+                          r->removed.push_back (route);
+                        }
+                      else
+                        {
+                          r->added.push_back (std::make_pair (host, route));
+                        }
+                    }
+                }
+            }
+        }
+    }
+//
+// Install the new LSAs, compute the shortest paths of the routers attached
+// to the link and replace the routes of the other routers.
+//
+  for (uint32_t i = 0; i < newLsas.size (); i++)
+    {
+      m_lsdb->Replace (newLsas[i]->GetLinkStateId (), newLsas[i]);
+    }
+  for (uint32_t r = 0; r < n; r++)
+    {
+      Ptr<Node> node = lsas[1][r]->GetNode ();
+      if (changed[r] && node != 0 && node->GetSystemId () == systemId)
+        {
+          Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+          DeleteRoutes (rtr);
+          SPFCalculate (rtr->GetRouterId ());
+        }
+    }
+  uint32_t nReplaced = 0;
+  for (std::vector<Router>::iterator r = others.begin (); r != others.end (); r++)
+    {
+      if (!r->removed.empty ())
+        {
+          nReplaced += r->routing->RemoveRoutes (r->removed);
+        }
+      for (uint32_t i = 0; i < r->added.size (); i++)
+        {
+          const Ipv4RoutingTableEntry &route = r->added[i].second;
+          if (r->added[i].first)
+            {
+              r->routing->AddHostRouteTo (route.GetDestNetwork (), route.GetGateway (), route.GetInterface ());
+            }
+          else
+            {
+              r->routing->AddNetworkRouteTo (route.GetDestNetwork (), route.GetDestNetworkMask (),
+                                             route.GetGateway (), route.GetInterface ());
+            }
+        }
+      nReplaced += r->added.size ();
+    }
+  NS_LOG_INFO ("Updated routes: " << std::count (changed.begin (), changed.end (), true)
+               << " routers computed their shortest paths, " << nAffected << " of " << n
+               << " destinations affected, " << nReplaced << " routes removed or added");
+  return true;
+}
+
+bool
+GlobalRouteManagerImpl::IsStubRouter (GlobalRoutingLSA* lsa) const
+{
+  NS_LOG_FUNCTION (this << lsa);
+  int transits = 0;
+  GlobalRoutingLinkRecord *transitLink = 0;
+  for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+      if (l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork
+          || l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+        {
+          transits++;
+          transitLink = l;
+        }
+    }
+  if (transits == 0)
+    {
+      return true;
+    }
+  if (transits > 1 || transitLink->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+    {
+      return false;
+    }
+  // a default route is installed if the peer has a link back to the router
+  GlobalRoutingLSA *w_lsa = m_lsdb->GetLSA (transitLink->GetLinkId ());
+  for (uint32_t j = 0; w_lsa && j < w_lsa->GetNLinkRecords (); ++j)
+    {
+      GlobalRoutingLinkRecord *lr = w_lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+          && lr->GetLinkId () == lsa->GetLinkStateId ())
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
 //
 // This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
 // 16.1 (2) for further details.
@@ -1559,58 +2206,60 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node we're going to write the routing information to is the one that
+// originated the LSA of the root vertex.  Walking the list of nodes looking
+// for the router ID of the root vertex would cost a pass over all the nodes
+// for every vertex and stub of every SPF calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfroot->GetLSA ()->GetNode ();
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
+      NS_LOG_LOGIC ("No node for the root " << routerId);
+      return;
+    }
 //
 // The router ID is accessible through the GlobalRouter interface, so we need
 // to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
+// in question cannot be the router we want.
 // 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+  Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
 
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
+  if (rtr == 0)
+    {
+      NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
+      return;
+    }
 //
 // If the router ID of the current node is equal to the router ID of the 
 // root of the SPF tree, then this node is the one for which we need to 
 // write the routing tables.
 //
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
+  NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
 
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+  if (rtr->GetRouterId () == routerId)
+    {
+      NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4, 
+                     "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                     "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+      NS_ASSERT_MSG (v->GetLSA (), 
+                     "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                     "Expected valid LSA in SPFVertex* v");
+      Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+      Ipv4Address tempip = extlsa->GetLinkStateId ();
+      tempip = tempip.CombineMask (tempmask);
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1625,39 +2274,38 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
+      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          return;
+        }
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      NS_ASSERT (gr);
+      // walk through all next-hop-IPs and out-going-interfaces for reaching
+      // the stub network gateway 'v' from the root node
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
             {
-              continue;
+              gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " add external network route to " << tempip <<
+                            " using next hop " << nextHop <<
+                            " via interface " << outIf);
             }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+          else
             {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " NOT able to add network route to " << tempip <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative");
             }
-          return;
-        } // if
-    } // for
+        }
+      return;
+    } // if
 }
 
 
@@ -1728,60 +2376,62 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node we're going to write the routing information to is the one that
+// originated the LSA of the root vertex.  Walking the list of nodes looking
+// for the router ID of the root vertex would cost a pass over all the nodes
+// for every vertex and stub of every SPF calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfroot->GetLSA ()->GetNode ();
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
+      NS_LOG_LOGIC ("No node for the root " << routerId);
+      return;
+    }
 //
 // The router ID is accessible through the GlobalRouter interface, so we need
 // to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
+// in question cannot be the router we want.
 // 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
+  Ptr<GlobalRouter> rtr = 
+    node->GetObject<GlobalRouter> ();
 
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
+  if (rtr == 0)
+    {
+      NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
+                    node->GetId ());
+      return;
+    }
 //
 // If the router ID of the current node is equal to the router ID of the 
 // root of the SPF tree, then this node is the one for which we need to 
 // write the routing tables.
 //
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
+  NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
 
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+  if (rtr->GetRouterId () == routerId)
+    {
+      NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4, 
+                     "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                     "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+      NS_ASSERT_MSG (v->GetLSA (), 
+                     "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                     "Expected valid LSA in SPFVertex* v");
+      Ipv4Mask tempmask (l->GetLinkData ().Get ());
+      Ipv4Address tempip = l->GetLinkId ();
+      tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1796,39 +2446,38 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // which the packets should be send for forwarding.
 //
 
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
+      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          return;
+        }
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      NS_ASSERT (gr);
+      // walk through all next-hop-IPs and out-going-interfaces for reaching
+      // the stub network gateway 'v' from the root node
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
             {
-              continue;
+              gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " add network route to " << tempip <<
+                            " using next hop " << nextHop <<
+                            " via interface " << outIf);
             }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+          else
             {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " NOT able to add network route to " << tempip <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative");
             }
-          return;
-        } // if
-    } // for
+        }
+      return;
+    } // if
 }
 
 //
@@ -1856,51 +2505,51 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 // the node at the root of the SPF tree.  This is the node for which we are
 // building the routing table.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfroot->GetLSA ()->GetNode ();
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
+      NS_LOG_LOGIC ("No node for the root " << routerId);
+      return -1;
+    }
 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
+  Ptr<GlobalRouter> rtr = 
+    node->GetObject<GlobalRouter> ();
 //
 // If the node doesn't have a GlobalRouter interface it can't be the one
 // we're interested in.
 //
-      if (rtr == 0)
-        {
-          continue;
-        }
+  if (rtr == 0)
+    {
+      return -1;
+    }
 
-      if (rtr->GetRouterId () == routerId)
-        {
+  if (rtr->GetRouterId () == routerId)
+    {
 //
 // This is the node we're building the routing table for.  We're going to need
 // the Ipv4 interface to look for the ipv4 interface index.  Since this node
 // is participating in routing IP version 4 packets, it certainly must have 
 // an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4, 
+                     "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
+                     "GetObject for <Ipv4> interface failed");
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+      int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
+      if (interface < 0)
+        {
+          NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                          "Expected an interface associated with address a:" << a);
         }
+#endif 
+      return interface;
     }
 //
 // Couldn't find it.
@@ -1943,60 +2592,62 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node we're going to write the routing information to is the one that
+// originated the LSA of the root vertex.  Walking the list of nodes looking
+// for the router ID of the root vertex would cost a pass over all the nodes
+// for every vertex and stub of every SPF calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfroot->GetLSA ()->GetNode ();
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
+      NS_LOG_LOGIC ("No node for the root " << routerId);
+      return;
+    }
 //
 // The router ID is accessible through the GlobalRouter interface, so we need
 // to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
+// the node in question cannot be the router we want.
 // 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
+  Ptr<GlobalRouter> rtr = 
+    node->GetObject<GlobalRouter> ();
 
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
+  if (rtr == 0)
+    {
+      NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
+                    node->GetId ());
+      return;
+    }
 //
 // If the router ID of the current node is equal to the router ID of the 
 // root of the SPF tree, then this node is the one for which we need to 
 // write the routing tables.
 //
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
+  NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
 
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+  if (rtr->GetRouterId () == routerId)
+    {
+      NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4, 
+                     "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                     "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+      GlobalRoutingLSA *lsa = v->GetLSA ();
+      NS_ASSERT_MSG (lsa, 
+                     "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                     "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+      uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2005,18 +2656,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+      NS_LOG_LOGIC (" Node " << node->GetId () <<
+                    " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+      for (uint32_t j = 0; j < nLinkRecords; ++j)
+        {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+            {
+              continue;
+            }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2030,44 +2681,43 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
+          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+          if (router == 0)
+            {
+              continue;
+            }
+          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+          NS_ASSERT (gr);
+          // walk through all available exit directions due to ECMP,
+          // and add host route for each of the exit direction toward
+          // the vertex 'v'
+          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+            {
+              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+              Ipv4Address nextHop = exit.first;
+              int32_t outIf = exit.second;
+              if (outIf >= 0)
                 {
-                  continue;
+                  gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                      outIf);
+                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                                " adding host route to " << lr->GetLinkData () <<
+                                " using next hop " << nextHop <<
+                                " and outgoing interface " << outIf);
                 }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+              else
                 {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
-            }
+                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                                " NOT able to add host route to " << lr->GetLinkData () <<
+                                " using next hop " << nextHop <<
+                                " since outgoing interface id is negative " << outIf);
+                }
+            } // for all routes from the root the vertex 'v'
+        }
 //
 // Done adding the routes for the selected node.
 //
-          return;
-        }
+      return;
     }
 }
 void
@@ -2088,95 +2738,96 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node we're going to write the routing information to is the one that
+// originated the LSA of the root vertex.  Walking the list of nodes looking
+// for the router ID of the root vertex would cost a pass over all the nodes
+// for every vertex and stub of every SPF calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfroot->GetLSA ()->GetNode ();
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
+      NS_LOG_LOGIC ("No node for the root " << routerId);
+      return;
+    }
 //
 // The router ID is accessible through the GlobalRouter interface, so we need
 // to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
+// the node in question cannot be the router we want.
 // 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
+  Ptr<GlobalRouter> rtr = 
+    node->GetObject<GlobalRouter> ();
 
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
+  if (rtr == 0)
+    {
+      NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
+                    node->GetId ());
+      return;
+    }
 //
 // If the router ID of the current node is equal to the router ID of the 
 // root of the SPF tree, then this node is the one for which we need to 
 // write the routing tables.
 //
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
+  NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
 
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
+  if (rtr->GetRouterId () == routerId)
+    {
+      NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4, 
+                     "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                     "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
+      GlobalRoutingLSA *lsa = v->GetLSA ();
+      NS_ASSERT_MSG (lsa, 
+                     "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                     "Expected valid LSA in SPFVertex* v");
+      Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+      Ipv4Address tempip = lsa->GetLinkStateId ();
+      tempip = tempip.CombineMask (tempmask);
+      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          return;
+        }
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      NS_ASSERT (gr);
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+
+          if (outIf >= 0)
             {
-              continue;
+              gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " add network route to " << tempip <<
+                            " using next hop " << nextHop <<
+                            " via interface " << outIf);
             }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+          else
             {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " NOT able to add network route to " << tempip <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
             }
         }
-    } 
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
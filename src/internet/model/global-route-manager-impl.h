@@ -38,6 +38,7 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class NetDevice;
 
 /**
  * \ingroup globalrouting
@@ -627,6 +628,26 @@ public:
  * by the IP address addr.
  */
   GlobalRoutingLSA* GetLSA (Ipv4Address addr) const;
+
+/**
+ * @brief Replace the Link State Advertisement associated with the given
+ * link state ID (address).
+ *
+ * The Link State Advertisement previously associated with the address, if
+ * any, is deleted.
+ *
+ * @param addr The IP address associated with the LSA.  Typically the Router 
+ * ID.
+ * @param lsa A pointer to the new Link State Advertisement for the router.
+ */
+  void Replace (Ipv4Address addr, GlobalRoutingLSA* lsa);
+
+/**
+ * @brief Get all the Link State Advertisements, except the External ones.
+ *
+ * @returns the Link State Advertisements, ordered by link state ID
+ */
+  std::vector<GlobalRoutingLSA*> GetLSAs (void) const;
 /**
  * @brief Look up the Link State Advertisement associated with the given
  * link state ID (address).  This is a variation of the GetLSA call
@@ -735,6 +756,39 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Update the routes after the link of a device went up or down
+ *
+ * Only the routers attached to the link compute their shortest paths
+ * again; the other routers only replace their routes to the routers
+ * whose exits (next hops and interfaces) changed.  The routes end up the
+ * same as after a full recomputation, but may be in a different order.
+ *
+ * @param device the device whose link went up or down
+ */
+  virtual void UpdateRoutes (Ptr<NetDevice> device);
+
+/**
+ * @brief Defer the route updates triggered by interface events
+ * @see GlobalRouteManager::DeferUpdates
+ */
+  void DeferUpdates ();
+
+/**
+ * @brief Record an interface event if the route updates are deferred
+ * @param device the device whose interface went up or down
+ * @param incremental false if all the routes must be computed again
+ * @returns true if the event was recorded
+ */
+  bool DeferUpdate (Ptr<NetDevice> device, bool incremental);
+
+/**
+ * @brief Update the routes once for the deferred interface events: all the
+ * routes are computed again if one of the events requires it, otherwise
+ * the routes are updated once per channel
+ */
+  void ResumeUpdates ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -768,6 +822,35 @@ private:
 
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  bool m_deferUpdates; //!< whether the route updates are deferred
+  bool m_deferredFullUpdate; //!< whether a deferred event requires computing all the routes again
+  std::vector<Ptr<NetDevice> > m_deferredDevices; //!< the devices of the deferred events
+
+  /**
+   * \brief Delete all the routes of a router
+   *
+   * \param router the router
+   */
+  void DeleteRoutes (Ptr<GlobalRouter> router);
+
+  /**
+   * \brief Update the LSAs of the given routers and the routes which
+   * depend on them, computing the shortest paths of these routers only.
+   *
+   * \param routers the routers whose links changed
+   * \returns false if the routes cannot be updated incrementally, in which
+   * case neither the LSDB nor the routes have been modified
+   */
+  bool UpdateRoutesIncrementally (const std::vector<Ptr<GlobalRouter> > &routers);
+
+  /**
+   * \brief Test if a router is a stub, without adding its default route
+   *
+   * \param lsa the LSA of the router
+   * \returns true if CheckForStubNode would return true for the router
+   * \see CheckForStubNode
+   */
+  bool IsStubRouter (GlobalRoutingLSA* lsa) const;
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
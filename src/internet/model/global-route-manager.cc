@@ -58,6 +58,38 @@ GlobalRouteManager::InitializeRoutes (void)
   InitializeRoutes ();
 }
 
+void
+GlobalRouteManager::UpdateRoutes (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (device);
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  UpdateRoutes (device);
+}
+
+void
+GlobalRouteManager::DeferUpdates (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  DeferUpdates ();
+}
+
+bool
+GlobalRouteManager::DeferUpdate (Ptr<NetDevice> device, bool incremental)
+{
+  NS_LOG_FUNCTION (device << incremental);
+  return SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+         DeferUpdate (device, incremental);
+}
+
+void
+GlobalRouteManager::ResumeUpdates (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  ResumeUpdates ();
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId (void)
 {
@@ -22,8 +22,12 @@
 #ifndef GLOBAL_ROUTE_MANAGER_H
 #define GLOBAL_ROUTE_MANAGER_H
 
+#include "ns3/ptr.h"
+
 namespace ns3 {
 
+class NetDevice;
+
 /**
  * \ingroup globalrouting
  *
@@ -65,6 +69,46 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Update the routes after the link of a device went up or down
+ *
+ * The Link State Advertisements of the routers attached to the channel of
+ * the device are discovered again, and only the routers whose shortest paths
+ * may go through the link that changed compute their routes again.  The
+ * other routers only update their routes to the addresses and networks of
+ * the link.  Falls back to deleting and computing again all the routes if
+ * the routing database holds network LSAs or AS external LSAs.
+ *
+ * @param device the device whose link went up or down
+ */
+  static void UpdateRoutes (Ptr<NetDevice> device);
+
+/**
+ * @brief Defer the route updates triggered by interface events
+ *
+ * Until ResumeUpdates is called, the interfaces going up or down are only
+ * recorded, so that the routes are updated once after all the devices of a
+ * link changed state rather than once per device.
+ */
+  static void DeferUpdates ();
+
+/**
+ * @brief Record an interface event if the route updates are deferred
+ *
+ * @param device the device whose interface went up or down
+ * @param incremental true if the routes can be updated incrementally, false
+ * if they must all be computed again
+ * @returns true if the event was recorded, in which case the caller must not
+ * update the routes
+ */
+  static bool DeferUpdate (Ptr<NetDevice> device, bool incremental);
+
+/**
+ * @brief Stop deferring the route updates and update the routes once for
+ * the interface events recorded since DeferUpdates was called
+ */
+  static void ResumeUpdates ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -390,6 +390,11 @@ Ptr<Node>
 GlobalRoutingLSA::GetNode (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_node_id >= NodeList::GetNNodes ())
+    {
+      // an LSA built by hand, not by a GlobalRouter
+      return 0;
+    }
   return NodeList::GetNode (m_node_id);
 }
 
@@ -487,7 +487,7 @@ public:
 
 /**
  * @brief Get the Node pointer of the node that originated this LSA
- * @returns Node pointer
+ * @returns Node pointer, or 0 if the node does not exist
  */
   Ptr<Node> GetNode (void) const;
 
@@ -365,8 +365,29 @@ Ipv4AddressGeneratorImpl::AddAllocated (const Ipv4Address address)
 
   uint32_t addr = address.Get ();
 
-  NS_ABORT_MSG_UNLESS (addr, "Ipv4AddressGeneratorImpl::Add(): Allocating the broadcast address is not a good idea"); 
- 
+  NS_ABORT_MSG_UNLESS (addr, "Ipv4AddressGeneratorImpl::Add(): Allocating the broadcast address is not a good idea");
+
+//
+// Addresses are usually allocated in increasing order (e.g., one network per
+// link of a large topology), so check the last block first to avoid walking
+// the whole list when the new address is above all the allocated ones.
+//
+  if (!m_entries.empty () && addr > m_entries.back ().addrHigh)
+    {
+      if (addr == m_entries.back ().addrHigh + 1)
+        {
+          NS_LOG_LOGIC ("New addrHigh = " << Ipv4Address (addr));
+          m_entries.back ().addrHigh = addr;
+        }
+      else
+        {
+          Entry entry;
+          entry.addrLow = entry.addrHigh = addr;
+          m_entries.push_back (entry);
+        }
+      return true;
+    }
+
   std::list<Entry>::iterator i;
 
   for (i = m_entries.begin (); i != m_entries.end (); ++i)
@@ -17,7 +17,10 @@
 //
 
 #include <vector>
+#include <map>
+#include <tuple>
 #include <iomanip>
+#include <cstring>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -27,6 +30,10 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/hash.h"
+#include "ns3/trace-source-accessor.h"
 #include "ns3/node.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
@@ -53,13 +60,44 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_respondToInterfaceEvents),
                    MakeBooleanChecker ())
+    .AddAttribute ("IncrementalUpdates",
+                   "Set to true if, when responding to an interface going up or down, only the routes affected by the change should be recomputed",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_incrementalUpdates),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EcmpMode",
+                   "The policy used to choose among equal cost routes",
+                   EnumValue (ECMP_NONE),
+                   MakeEnumAccessor (&Ipv4GlobalRouting::m_ecmpMode),
+                   MakeEnumChecker (ECMP_NONE, "None",
+                                    ECMP_RANDOM, "Random",
+                                    ECMP_HASH, "Hash",
+                                    ECMP_FLOWLET, "Flowlet",
+                                    ECMP_SPRAY, "Spray"))
+    .AddAttribute ("EcmpHashSeed",
+                   "The seed of the hash of the five-tuple used by the Hash, Flowlet and Spray modes",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4GlobalRouting::m_hashSeed),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("FlowletTimeout",
+                   "The gap between the packets of a flow that starts a new flowlet",
+                   TimeValue (MicroSeconds (500)),
+                   MakeTimeAccessor (&Ipv4GlobalRouting::m_flowletTimeout),
+                   MakeTimeChecker ())
+    .AddTraceSource ("EcmpPath",
+                     "A packet was routed to a destination having several equal cost routes",
+                     MakeTraceSourceAccessor (&Ipv4GlobalRouting::m_ecmpPathTrace),
+                     "ns3::Ipv4GlobalRouting::EcmpPathTracedCallback")
   ;
   return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_incrementalUpdates (false),
+    m_ecmpMode (ECMP_NONE),
+    m_hashSeed (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +118,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  FlushRouteCache ();
 }
 
 void 
@@ -90,6 +129,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  FlushRouteCache ();
 }
 
 void 
@@ -105,6 +145,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  FlushRouteCache ();
 }
 
 void 
@@ -118,6 +159,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  FlushRouteCache ();
 }
 
 void 
@@ -133,19 +175,14 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  FlushRouteCache ();
 }
 
 
-Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+void
+Ipv4GlobalRouting::FindRoutes (Ipv4Address dest, Ptr<NetDevice> oif, RouteVec_t &routes) const
 {
   NS_LOG_FUNCTION (this << dest << oif);
-  NS_LOG_LOGIC ("Looking for route for destination " << dest);
-  Ptr<Ipv4Route> rtentry = 0;
-  // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
-
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
   for (HostRoutesCI i = m_hostRoutes.begin (); 
        i != m_hostRoutes.end (); 
@@ -162,14 +199,14 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
                   continue;
                 }
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          routes.push_back (*i);
+          NS_LOG_LOGIC (routes.size () << "Found global host route" << *i); 
         }
     }
-  if (allRoutes.size () == 0) // if no host route is found
+  if (routes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
+      for (NetworkRoutesCI j = m_networkRoutes.begin (); 
            j != m_networkRoutes.end (); 
            j++) 
         {
@@ -185,14 +222,14 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
                       continue;
                     }
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              routes.push_back (*j);
+              NS_LOG_LOGIC (routes.size () << "Found global network route" << *j);
             }
         }
     }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
+  if (routes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
+      for (ASExternalRoutesCI k = m_ASexternalRoutes.begin ();
            k != m_ASexternalRoutes.end ();
            k++)
         {
@@ -209,42 +246,178 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
                       continue;
                     }
                 }
-              allRoutes.push_back (*k);
+              routes.push_back (*k);
               break;
             }
         }
     }
-  if (allRoutes.size () > 0 ) // if route(s) is found
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::LookupGlobal (const Ipv4Header &header, Ptr<const Packet> p,
+                                 bool hasL4Header, Ptr<NetDevice> oif)
+{
+  Ipv4Address dest = header.GetDestination ();
+  NS_LOG_FUNCTION (this << dest << oif);
+  NS_LOG_LOGIC ("Looking for route for destination " << dest);
+
+  // store all available routes that bring packets to their destination;
+  // unless a specific output interface is requested, the routes found for
+  // a destination are cached until the routing table changes
+  RouteVec_t oifRoutes;
+  const RouteVec_t *routes = &oifRoutes;
+  if (oif == 0)
     {
-      // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
-      uint32_t selectIndex;
-      if (m_randomEcmpRouting)
+      auto it = m_routeCache.find (dest.Get ());
+      if (it == m_routeCache.end ())
         {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
+          it = m_routeCache.insert ({dest.Get (), RouteVec_t ()}).first;
+          FindRoutes (dest, 0, it->second);
         }
-      else 
+      routes = &it->second;
+    }
+  else
+    {
+      FindRoutes (dest, oif, oifRoutes);
+    }
+
+  if (routes->empty ())
+    {
+      return 0;
+    }
+
+  uint32_t selectIndex = 0;
+  if (routes->size () > 1)
+    {
+      selectIndex = SelectRoute (routes->size (), header, p, hasL4Header);
+      if (p != 0)
         {
-          selectIndex = 0;
+          m_ecmpPathTrace (p, header, routes->at (selectIndex)->GetInterface ());
         }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
-      // create a Ipv4Route object from the selected routing table entry
-      rtentry = Create<Ipv4Route> ();
-      rtentry->SetDestination (route->GetDest ());
-      /// \todo handle multi-address case
-      rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
-      rtentry->SetGateway (route->GetGateway ());
-      uint32_t interfaceIdx = route->GetInterface ();
-      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-      return rtentry;
-    }
-  else 
+    }
+  Ipv4RoutingTableEntry* route = routes->at (selectIndex);
+  // create a Ipv4Route object from the selected routing table entry
+  Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
+  rtentry->SetDestination (route->GetDest ());
+  /// \todo handle multi-address case
+  rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
+  rtentry->SetGateway (route->GetGateway ());
+  uint32_t interfaceIdx = route->GetInterface ();
+  rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+  return rtentry;
+}
+
+uint32_t
+Ipv4GlobalRouting::SelectRoute (uint32_t nRoutes, const Ipv4Header &header,
+                                Ptr<const Packet> p, bool hasL4Header)
+{
+  NS_LOG_FUNCTION (this << nRoutes);
+
+  EcmpMode mode = m_ecmpMode;
+  if (m_randomEcmpRouting && mode == ECMP_NONE)
+    {
+      mode = ECMP_RANDOM;
+    }
+
+  switch (mode)
     {
+    case ECMP_RANDOM:
+      return m_rand->GetInteger (0, nRoutes - 1);
+    case ECMP_HASH:
+      return GetFlowHash (header, p, hasL4Header, m_hashSeed) % nRoutes;
+    case ECMP_FLOWLET:
+      {
+        EvictIdleFlows ();
+        auto ret = m_flowlets.insert ({GetFlowHash (header, p, hasL4Header, m_hashSeed), Flowlet ()});
+        Flowlet &flowlet = ret.first->second;
+        if (ret.second || Simulator::Now () - flowlet.lastSeen > m_flowletTimeout
+            || flowlet.index >= nRoutes)
+          {
+            flowlet.index = m_rand->GetInteger (0, nRoutes - 1);
+            NS_LOG_LOGIC ("New flowlet on route " << flowlet.index);
+          }
+        flowlet.lastSeen = Simulator::Now ();
+        return flowlet.index;
+      }
+    case ECMP_SPRAY:
+      {
+        EvictIdleFlows ();
+        auto ret = m_sprayNext.insert ({GetFlowHash (header, p, hasL4Header, m_hashSeed), Flowlet ()});
+        Flowlet &flow = ret.first->second;
+        if (ret.second)
+          {
+            flow.index = m_rand->GetInteger (0, nRoutes - 1);
+          }
+        flow.lastSeen = Simulator::Now ();
+        uint32_t index = flow.index % nRoutes;
+        flow.index = index + 1;
+        return index;
+      }
+    case ECMP_NONE:
+    default:
       return 0;
     }
 }
 
+uint32_t
+Ipv4GlobalRouting::GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p,
+                                bool hasL4Header, uint32_t seed)
+{
+  uint8_t buf[17];
+  buf[0] = (seed >> 24) & 0xff;
+  buf[1] = (seed >> 16) & 0xff;
+  buf[2] = (seed >> 8) & 0xff;
+  buf[3] = seed & 0xff;
+  header.GetSource ().Serialize (buf + 4);
+  header.GetDestination ().Serialize (buf + 8);
+  buf[12] = header.GetProtocol ();
+  std::memset (buf + 13, 0, 4);
+
+  // TCP and UDP ports are the first four bytes of the transport header,
+  // which is only present in the first fragment
+  if (hasL4Header && p != 0 && header.GetFragmentOffset () == 0
+      && (header.GetProtocol () == 6 || header.GetProtocol () == 17)
+      && p->GetSize () >= 4)
+    {
+      p->CopyData (buf + 13, 4);
+    }
+
+  return Hash32 ((char *) buf, sizeof (buf));
+}
+
+void
+Ipv4GlobalRouting::FlushRouteCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routeCache.clear ();
+}
+
+void
+Ipv4GlobalRouting::EvictIdleFlows (void)
+{
+  Time now = Simulator::Now ();
+  if (now < m_nextEviction)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_nextEviction = now + m_flowletTimeout;
+  for (auto flows : {&m_flowlets, &m_sprayNext})
+    {
+      for (auto it = flows->begin (); it != flows->end (); )
+        {
+          if (now - it->second.lastSeen > m_flowletTimeout)
+            {
+              it = flows->erase (it);
+            }
+          else
+            {
+              ++it;
+            }
+        }
+    }
+}
+
 uint32_t 
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -309,6 +482,7 @@ void
 Ipv4GlobalRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
+  FlushRouteCache ();
   if (index < m_hostRoutes.size ())
     {
       uint32_t tmp = 0;
@@ -362,6 +536,45 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
   NS_ASSERT (false);
 }
 
+uint32_t
+Ipv4GlobalRouting::RemoveRoutes (const std::vector<Ipv4RoutingTableEntry> &routes)
+{
+  NS_LOG_FUNCTION (this << routes.size ());
+  // number of routes to remove, by destination, mask, gateway and interface
+  typedef std::tuple<uint32_t, uint32_t, uint32_t, uint32_t> Key_t;
+  std::map<Key_t, uint32_t> remove;
+  for (std::vector<Ipv4RoutingTableEntry>::const_iterator r = routes.begin (); r != routes.end (); r++)
+    {
+      remove[Key_t (r->GetDestNetwork ().Get (), r->GetDestNetworkMask ().Get (),
+                    r->GetGateway ().Get (), r->GetInterface ())]++;
+    }
+  uint32_t removed = 0;
+  std::list<Ipv4RoutingTableEntry *> *tables[] = {&m_hostRoutes, &m_networkRoutes};
+  for (uint32_t t = 0; t < 2 && removed < routes.size (); t++)
+    {
+      for (std::list<Ipv4RoutingTableEntry *>::iterator i = tables[t]->begin (); i != tables[t]->end (); )
+        {
+          std::map<Key_t, uint32_t>::iterator it =
+            remove.find (Key_t ((*i)->GetDestNetwork ().Get (), (*i)->GetDestNetworkMask ().Get (),
+                                (*i)->GetGateway ().Get (), (*i)->GetInterface ()));
+          if (it != remove.end () && it->second > 0)
+            {
+              it->second--;
+              removed++;
+              delete *i;
+              i = tables[t]->erase (i);
+            }
+          else
+            {
+              i++;
+            }
+        }
+    }
+  NS_LOG_LOGIC ("Removed " << removed << " of " << routes.size () << " routes");
+  FlushRouteCache ();
+  return removed;
+}
+
 int64_t
 Ipv4GlobalRouting::AssignStreams (int64_t stream)
 {
@@ -374,6 +587,9 @@ void
 Ipv4GlobalRouting::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  FlushRouteCache ();
+  m_flowlets.clear ();
+  m_sprayNext.clear ();
   for (HostRoutesI i = m_hostRoutes.begin (); 
        i != m_hostRoutes.end (); 
        i = m_hostRoutes.erase (i)) 
@@ -468,7 +684,8 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
 // See if this is a unicast packet we have a route for.
 //
   NS_LOG_LOGIC ("Unicast destination- looking up");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif);
+  // the transport protocols add their header before looking up the route
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header, p, p != 0, oif);
   if (rtentry)
     {
       sockerr = Socket::ERROR_NOTERROR;
@@ -517,7 +734,7 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, P
     }
   // Next, try to find a route
   NS_LOG_LOGIC ("Unicast destination- looking up global route");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination ());
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header, p, true);
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
@@ -537,6 +754,15 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
+      if (GlobalRouteManager::DeferUpdate (m_ipv4->GetNetDevice (i), m_incrementalUpdates))
+        {
+          return;
+        }
+      if (m_incrementalUpdates)
+        {
+          GlobalRouteManager::UpdateRoutes (m_ipv4->GetNetDevice (i));
+          return;
+        }
       GlobalRouteManager::DeleteGlobalRoutes ();
       GlobalRouteManager::BuildGlobalRoutingDatabase ();
       GlobalRouteManager::InitializeRoutes ();
@@ -549,6 +775,15 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
+      if (GlobalRouteManager::DeferUpdate (m_ipv4->GetNetDevice (i), m_incrementalUpdates))
+        {
+          return;
+        }
+      if (m_incrementalUpdates)
+        {
+          GlobalRouteManager::UpdateRoutes (m_ipv4->GetNetDevice (i));
+          return;
+        }
       GlobalRouteManager::DeleteGlobalRoutes ();
       GlobalRouteManager::BuildGlobalRoutingDatabase ();
       GlobalRouteManager::InitializeRoutes ();
@@ -21,6 +21,8 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +30,8 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
 
 namespace ns3 {
 
@@ -65,6 +69,35 @@ class Node;
  *
  * This class deals with Ipv4 unicast routes only.
  *
+ * When several equal cost routes lead to a destination, the EcmpMode
+ * attribute selects how one of them is chosen for each packet:
+ *
+ * - None: the first route is always used;
+ * - Random: a route is chosen uniformly at random for every packet (this is
+ *   also the behavior when the RandomEcmpRouting attribute is true);
+ * - Hash: the route is chosen by hashing the five-tuple of the packet
+ *   (addresses, protocol and, for TCP and UDP, ports) together with the
+ *   EcmpHashSeed of the node, hence all the packets of a flow follow the
+ *   same path. Setting different seeds on the nodes avoids hash
+ *   polarization across tiers. The ports of the packets originated by the
+ *   node are hashed as well, since the transport protocols add their header
+ *   before looking up the route;
+ * - Flowlet: a random route is chosen for the first packet of every flowlet,
+ *   i.e., whenever no packet of the flow (identified as in the Hash mode) was
+ *   routed in the last FlowletTimeout, and is used for the following packets
+ *   of the flowlet. The flowlets idle for longer are discarded;
+ * - Spray: the packets of every flow (identified as in the Hash mode) are
+ *   sprayed in round robin over the routes, starting from a random route,
+ *   so that each flow spreads evenly over all the paths. As with Flowlet,
+ *   the flows idle for longer than FlowletTimeout are discarded. Senders should
+ *   use a reordering-tolerant loss detection (see the RackTlp attribute of
+ *   TcpSocketBase).
+ *
+ * The routes to a destination are cached, so that the routing table is not
+ * scanned for every packet. The EcmpPath trace source is fired for every
+ * packet routed to a destination having several routes, and can be used to
+ * measure the utilization of each path.
+ *
  * \see Ipv4RoutingProtocol
  * \see GlobalRouteManager
  */
@@ -87,6 +120,23 @@ public:
   Ipv4GlobalRouting ();
   virtual ~Ipv4GlobalRouting ();
 
+  /**
+   * \brief Compute the hash of the five-tuple of a packet.
+   *
+   * The ports are only hashed for the first fragment of TCP and UDP packets
+   * which start with the transport header. This hash is shared by all the
+   * devices which balance flows over several paths, so that a flow is
+   * identified in the same way everywhere.
+   *
+   * \param header the IPv4 header of the packet
+   * \param p the packet, if any
+   * \param hasL4Header true if the packet starts with the transport header
+   * \param seed the seed of the hash
+   * \return the hash of the five-tuple and of the seed
+   */
+  static uint32_t GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p,
+                               bool hasL4Header, uint32_t seed);
+
   // These methods inherited from base class
   virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
 
@@ -218,6 +268,18 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Remove some routes from the global unicast routing table.
+   *
+   * For each of the given routes, the first route of the table having the
+   * same destination, mask, gateway and interface is removed.  The table is
+   * walked only once, whatever the number of routes to remove.
+   *
+   * \param routes the routes to remove
+   * \returns the number of routes removed
+   */
+  uint32_t RemoveRoutes (const std::vector<Ipv4RoutingTableEntry> &routes);
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -228,6 +290,27 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /// Policy used to choose among equal cost routes
+  enum EcmpMode
+  {
+    ECMP_NONE,    //!< Always use the first route
+    ECMP_RANDOM,  //!< Choose a random route for every packet
+    ECMP_HASH,    //!< Choose the route by hashing the five-tuple
+    ECMP_FLOWLET, //!< Choose a random route for every flowlet
+    ECMP_SPRAY    //!< Spray the packets of every flow in round robin
+  };
+
+  /**
+   * TracedCallback signature for the packets routed among equal cost routes.
+   *
+   * \param [in] packet The packet (starting with the transport header, if
+   *             forwarded, or its payload, if originated by the node).
+   * \param [in] header The IPv4 header of the packet.
+   * \param [in] interface The output interface of the chosen route.
+   */
+  typedef void (* EcmpPathTracedCallback)
+    (Ptr<const Packet> packet, const Ipv4Header &header, uint32_t interface);
+
 protected:
   void DoDispose (void);
 
@@ -236,6 +319,8 @@ private:
   bool m_randomEcmpRouting;
   /// Set to true if this interface should respond to interface events by globallly recomputing routes 
   bool m_respondToInterfaceEvents;
+  /// Set to true if interface events only update the routes affected by the change
+  bool m_incrementalUpdates;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
 
@@ -260,13 +345,67 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
+  /// container of the routes to a destination
+  typedef std::vector<Ipv4RoutingTableEntry *> RouteVec_t;
+
   /**
    * \brief Lookup in the forwarding table for destination.
-   * \param dest destination address
+   * \param header the IPv4 header of the packet
+   * \param p the packet, if any
+   * \param hasL4Header true if the packet starts with the transport header
    * \param oif output interface if any (put 0 otherwise)
    * \return Ipv4Route to route the packet to reach dest address
    */
-  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  Ptr<Ipv4Route> LookupGlobal (const Ipv4Header &header, Ptr<const Packet> p,
+                               bool hasL4Header, Ptr<NetDevice> oif = 0);
+
+  /**
+   * \brief Scan the forwarding table for the routes to a destination.
+   * \param dest destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \param routes the vector to fill with the routes found
+   */
+  void FindRoutes (Ipv4Address dest, Ptr<NetDevice> oif, RouteVec_t &routes) const;
+
+  /**
+   * \brief Choose one of the equal cost routes according to the EcmpMode.
+   * \param nRoutes the number of routes (greater than one)
+   * \param header the IPv4 header of the packet
+   * \param p the packet, if any
+   * \param hasL4Header true if the packet starts with the transport header
+   * \return the index of the chosen route
+   */
+  uint32_t SelectRoute (uint32_t nRoutes, const Ipv4Header &header,
+                        Ptr<const Packet> p, bool hasL4Header);
+
+  /// Invalidate the cache of the routes to the destinations
+  void FlushRouteCache (void);
+
+  /**
+   * \brief Discard the flowlets and the sprayed flows idle for more than
+   * FlowletTimeout.
+   *
+   * The flows are scanned at most once per FlowletTimeout, so that the
+   * state of the finished flows does not accumulate.
+   */
+  void EvictIdleFlows (void);
+
+  /// State of a flowlet, or of a sprayed flow
+  struct Flowlet
+  {
+    Time lastSeen;   //!< Time the last packet of the flow was routed
+    uint32_t index;  //!< Index of the route used by the flowlet, or of the next route of a sprayed flow
+  };
+
+  EcmpMode m_ecmpMode;                  //!< Policy used to choose among equal cost routes
+  uint32_t m_hashSeed;                  //!< Seed of the five-tuple hash
+  Time m_flowletTimeout;                //!< Gap between packets starting a new flowlet
+  std::unordered_map<uint32_t, RouteVec_t> m_routeCache; //!< Routes to the destinations looked up
+  std::unordered_map<uint32_t, Flowlet> m_flowlets;      //!< Flowlets, indexed by flow hash
+  Time m_nextEviction;                  //!< Time of the next scan of the idle flows
+  std::unordered_map<uint32_t, Flowlet> m_sprayNext;     //!< Next route of the sprayed flows, indexed by flow hash
+  /// Trace of the packets routed among equal cost routes
+  TracedCallback<Ptr<const Packet>, const Ipv4Header &, uint32_t> m_ecmpPathTrace;
 
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
@@ -162,6 +162,20 @@ Ipv4Interface::GetArpCache () const
   return m_cache;
 }
 
+void
+Ipv4Interface::SetPeerHardwareAddress (Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  m_peerAddress = address;
+}
+
+Address
+Ipv4Interface::GetPeerHardwareAddress (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_peerAddress;
+}
+
 /**
  * These are IP interface states and may be distinct from 
  * NetDevice states, such as found in real implementations
@@ -278,6 +292,12 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
                   break;
                 }
             }
+          if (!found && !m_peerAddress.IsInvalid ())
+            {
+              NS_LOG_LOGIC ("ARP bypassed");
+              hardwareDestination = m_peerAddress;
+              found = true;
+            }
           if (!found)
             {
               NS_LOG_LOGIC ("ARP Lookup");
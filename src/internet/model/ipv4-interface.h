@@ -25,6 +25,7 @@
 #include <list>
 #include "ns3/ptr.h"
 #include "ns3/object.h"
+#include "ns3/address.h"
 
 namespace ns3 {
 
@@ -93,6 +94,24 @@ public:
    */
   Ptr<ArpCache> GetArpCache () const;
 
+  /**
+   * \brief Set the hardware address of the only peer of this interface.
+   *
+   * If a valid address is set, unicast packets sent on a device that needs
+   * ARP are sent to this address without ARP resolution. This is meant for
+   * devices that need ARP but are attached to a channel with a single other
+   * device. Setting an invalid address restores the ARP resolution.
+   *
+   * \param address the hardware address of the peer
+   */
+  void SetPeerHardwareAddress (Address address);
+
+  /**
+   * \return the hardware address of the peer, or an invalid address if
+   * unicast packets are resolved by ARP
+   */
+  Address GetPeerHardwareAddress (void) const;
+
   /**
    * \param metric configured routing metric (cost) of this interface
    *
@@ -239,6 +258,7 @@ private:
   Ptr<NetDevice> m_device; //!< The associated NetDevice
   Ptr<TrafficControlLayer> m_tc; //!< The associated TrafficControlLayer
   Ptr<ArpCache> m_cache; //!< ARP cache
+  Address m_peerAddress; //!< Hardware address of the peer bypassing ARP
 };
 
 } // namespace ns3
@@ -20,6 +20,8 @@
 #include "ipv4-queue-disc-item.h"
 #include "ns3/tcp-header.h"
 #include "ns3/udp-header.h"
+#include "ns3/node.h"
+#include "tcp-gso-tag.h"
 
 namespace ns3 {
 
@@ -166,4 +168,66 @@ Ipv4QueueDiscItem::Hash (uint32_t perturbation) const
   return hash;
 }
 
+bool
+Ipv4QueueDiscItem::Segment (std::vector<Ptr<QueueDiscItem> > &segments) const
+{
+  NS_LOG_FUNCTION (this);
+
+  TcpGsoTag gsoTag;
+  if (m_headerAdded || m_header.GetProtocol () != 6
+      || !GetPacket ()->PeekPacketTag (gsoTag))
+    {
+      return false;
+    }
+
+  Ptr<Packet> payload = GetPacket ()->Copy ();
+  payload->RemovePacketTag (gsoTag);
+  TcpHeader tcpHeader;
+  payload->RemoveHeader (tcpHeader);
+
+  uint32_t segmentSize = gsoTag.GetSegmentSize ();
+  uint32_t payloadSize = payload->GetSize ();
+  NS_ASSERT (segmentSize > 0);
+  uint8_t flags = tcpHeader.GetFlags ();
+  uint16_t id = m_header.GetIdentification ();
+
+  for (uint32_t offset = 0; offset < payloadSize; offset += segmentSize)
+    {
+      uint32_t size = std::min (segmentSize, payloadSize - offset);
+      Ptr<Packet> p = payload->CreateFragment (offset, size);
+
+      TcpHeader segHeader = tcpHeader;
+      uint8_t segFlags = flags;
+      if (offset > 0)
+        {
+          segFlags &= ~TcpHeader::CWR;
+        }
+      if (offset + size < payloadSize)
+        {
+          segFlags &= ~(TcpHeader::FIN | TcpHeader::PSH);
+        }
+      segHeader.SetFlags (segFlags);
+      segHeader.SetSequenceNumber (tcpHeader.GetSequenceNumber () + offset);
+      if (Node::ChecksumEnabled ())
+        {
+          segHeader.EnableChecksums ();
+        }
+      segHeader.InitializeChecksum (m_header.GetSource (), m_header.GetDestination (), 6);
+      p->AddHeader (segHeader);
+
+      Ipv4Header ipHeader = m_header;
+      ipHeader.SetPayloadSize (p->GetSize ());
+      ipHeader.SetIdentification (id++);
+
+      Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, GetAddress (),
+                                                               GetProtocol (), ipHeader);
+      item->SetTxQueueIndex (GetTxQueueIndex ());
+      segments.push_back (item);
+    }
+
+  NS_LOG_DEBUG ("Split a GSO packet of " << payloadSize << " bytes into "
+                << segments.size () << " segments");
+  return true;
+}
+
 } // namespace ns3
@@ -95,6 +95,21 @@ public:
    */
   virtual uint32_t Hash (uint32_t perturbation) const;
 
+  /**
+   * \brief Split a TCP super-segment carrying a TcpGsoTag into wire segments
+   *
+   * Each resulting item carries a copy of the TCP header with the sequence
+   * number adjusted to its payload. The CWR flag is only kept on the first
+   * segment, while the FIN and PSH flags are only kept on the last one.
+   * The IPv4 header of each segment is a copy of the header of this item,
+   * with the payload size updated and the identification incremented as
+   * done by Linux.
+   *
+   * \param segments the vector to which the resulting items are appended
+   * \return true if this item carries a TcpGsoTag and has been split
+   */
+  virtual bool Segment (std::vector<Ptr<QueueDiscItem> > &segments) const;
+
 private:
   /**
    * \brief Default constructor
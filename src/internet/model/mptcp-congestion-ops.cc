@@ -0,0 +1,438 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mptcp-congestion-ops.h"
+#include "mptcp-socket.h"
+#include "mptcp-subflow.h"
+#include "ns3/log.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MptcpCongestionOps");
+
+NS_OBJECT_ENSURE_REGISTERED (MptcpCoupling);
+
+/**
+ * \brief Apply a window change, accumulating it until it amounts to a segment
+ * \param tcb the state of the subflow
+ * \param change the change of the congestion window, in bytes
+ * \param fraction the accumulated change not yet applied
+ */
+static void
+ApplyWindowChange (Ptr<TcpSocketState> tcb, double change, double &fraction)
+{
+  fraction += change;
+  double segments = std::trunc (fraction / tcb->m_segmentSize);
+  if (segments == 0)
+    {
+      return;
+    }
+  fraction -= segments * tcb->m_segmentSize;
+  double cWnd = static_cast<double> (tcb->m_cWnd.Get ()) + segments * tcb->m_segmentSize;
+  tcb->m_cWnd = static_cast<uint32_t> (std::max (cWnd, static_cast<double> (tcb->m_segmentSize)));
+}
+
+TypeId
+MptcpCoupling::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MptcpCoupling")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<MptcpCoupling> ()
+  ;
+  return tid;
+}
+
+MptcpCoupling::MptcpCoupling ()
+  : m_meta (nullptr),
+    m_bytesBetweenLosses (0),
+    m_bytesSinceLoss (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpCoupling::~MptcpCoupling ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MptcpCoupling::SetMeta (MptcpSocket *meta)
+{
+  NS_LOG_FUNCTION (this << meta);
+  m_meta = meta;
+}
+
+void
+MptcpCoupling::OnAck (uint32_t bytes)
+{
+  m_bytesSinceLoss += bytes;
+}
+
+void
+MptcpCoupling::OnLoss (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_bytesBetweenLosses = m_bytesSinceLoss;
+  m_bytesSinceLoss = 0;
+}
+
+uint64_t
+MptcpCoupling::GetLossInterval (void) const
+{
+  return std::max (m_bytesBetweenLosses, m_bytesSinceLoss);
+}
+
+bool
+MptcpCoupling::GetLiaIncrease (Ptr<const TcpSocketState> tcb, uint32_t segmentsAcked,
+                               double &increase) const
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+
+  if (m_meta == nullptr)
+    {
+      return false;
+    }
+
+  double totalCwnd = 0;
+  double bestPath = 0;
+  double sumRate = 0;
+  bool found = false;
+  for (const Ptr<MptcpSubflow> &sf : m_meta->GetSubflows ())
+    {
+      if (!sf->IsEstablished ())
+        {
+          continue;
+        }
+      double cWnd = sf->GetSocketState ()->m_cWnd.Get ();
+      double rtt = std::max (sf->GetSmoothedRtt ().GetSeconds (), 1e-6);
+      totalCwnd += cWnd;
+      bestPath = std::max (bestPath, cWnd / (rtt * rtt));
+      sumRate += cWnd / rtt;
+      found |= (PeekPointer (sf->GetSocketState ()) == PeekPointer (tcb));
+    }
+  if (!found || sumRate == 0)
+    {
+      return false;
+    }
+
+  double alpha = totalCwnd * bestPath / (sumRate * sumRate);
+  double bytesAcked = static_cast<double> (segmentsAcked) * tcb->m_segmentSize;
+  increase = std::min (alpha * bytesAcked * tcb->m_segmentSize / totalCwnd,
+                       bytesAcked * tcb->m_segmentSize / tcb->m_cWnd.Get ());
+  NS_LOG_DEBUG ("LIA alpha " << alpha << " increase " << increase);
+  return true;
+}
+
+bool
+MptcpCoupling::GetOliaIncrease (Ptr<const TcpSocketState> tcb, uint32_t segmentsAcked,
+                                double &increase) const
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+
+  if (m_meta == nullptr)
+    {
+      return false;
+    }
+
+  // Per path: window in segments, RTT, and the quality metric of the path
+  // ((l_r / rtt_r)^2 in the paper, l_r / rtt_r ranks the paths the same way)
+  struct Path
+  {
+    double w;
+    double rtt;
+    double quality;
+    bool self;
+  };
+  std::vector<Path> paths;
+  double sumRate = 0;
+  double maxW = 0;
+  double maxQuality = 0;
+  bool found = false;
+  for (const Ptr<MptcpSubflow> &sf : m_meta->GetSubflows ())
+    {
+      if (!sf->IsEstablished ())
+        {
+          continue;
+        }
+      Ptr<TcpSocketState> state = sf->GetSocketState ();
+      Ptr<MptcpCoupling> coupling = state->GetObject<MptcpCoupling> ();
+      Path path;
+      path.w = static_cast<double> (state->m_cWnd.Get ()) / state->m_segmentSize;
+      path.rtt = std::max (sf->GetSmoothedRtt ().GetSeconds (), 1e-6);
+      path.quality = (coupling != 0 ? coupling->GetLossInterval () : 0) / path.rtt;
+      path.self = (PeekPointer (state) == PeekPointer (tcb));
+      found |= path.self;
+      sumRate += path.w / path.rtt;
+      maxW = std::max (maxW, path.w);
+      maxQuality = std::max (maxQuality, path.quality);
+      paths.push_back (path);
+    }
+  if (!found || sumRate == 0)
+    {
+      return false;
+    }
+
+  // M: paths with the largest window; B: presumably best paths.
+  // The paths in B but not in M gain alpha, the paths in M lose it.
+  uint32_t nMax = 0;
+  uint32_t nCollected = 0;
+  for (const Path &path : paths)
+    {
+      bool inMax = (path.w == maxW);
+      bool inBest = (path.quality == maxQuality);
+      nMax += inMax ? 1 : 0;
+      nCollected += (inBest && !inMax) ? 1 : 0;
+    }
+
+  double alpha = 0;
+  double n = paths.size ();
+  for (const Path &path : paths)
+    {
+      if (!path.self || nCollected == 0)
+        {
+          continue;
+        }
+      if (path.quality == maxQuality && path.w != maxW)
+        {
+          alpha = 1 / (n * nCollected);
+        }
+      else if (path.w == maxW)
+        {
+          alpha = -1 / (n * nMax);
+        }
+    }
+
+  double w = static_cast<double> (tcb->m_cWnd.Get ()) / tcb->m_segmentSize;
+  double rtt = 0;
+  for (const Path &path : paths)
+    {
+      if (path.self)
+        {
+          rtt = path.rtt;
+        }
+    }
+  double perSegment = (w / (rtt * rtt)) / (sumRate * sumRate) + alpha / w;
+  increase = perSegment * segmentsAcked * tcb->m_segmentSize;
+  NS_LOG_DEBUG ("OLIA alpha " << alpha << " increase " << increase);
+  return true;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (MptcpLia);
+
+TypeId
+MptcpLia::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MptcpLia")
+    .SetParent<TcpLinuxReno> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<MptcpLia> ()
+  ;
+  return tid;
+}
+
+MptcpLia::MptcpLia ()
+  : TcpLinuxReno (),
+    m_cWndFraction (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpLia::MptcpLia (const MptcpLia& sock)
+  : TcpLinuxReno (sock),
+    m_cWndFraction (sock.m_cWndFraction)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpLia::~MptcpLia ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+MptcpLia::GetName () const
+{
+  return "MptcpLia";
+}
+
+Ptr<TcpCongestionOps>
+MptcpLia::Fork ()
+{
+  return CopyObject<MptcpLia> (this);
+}
+
+void
+MptcpLia::CongestionAvoidance (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+
+  Ptr<MptcpCoupling> coupling = tcb->GetObject<MptcpCoupling> ();
+  double increase;
+  if (coupling == 0 || !coupling->GetLiaIncrease (tcb, segmentsAcked, increase))
+    {
+      TcpLinuxReno::CongestionAvoidance (tcb, segmentsAcked);
+      return;
+    }
+  ApplyWindowChange (tcb, increase, m_cWndFraction);
+}
+
+NS_OBJECT_ENSURE_REGISTERED (MptcpOlia);
+
+TypeId
+MptcpOlia::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MptcpOlia")
+    .SetParent<TcpLinuxReno> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<MptcpOlia> ()
+  ;
+  return tid;
+}
+
+MptcpOlia::MptcpOlia ()
+  : TcpLinuxReno (),
+    m_cWndFraction (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpOlia::MptcpOlia (const MptcpOlia& sock)
+  : TcpLinuxReno (sock),
+    m_cWndFraction (sock.m_cWndFraction)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpOlia::~MptcpOlia ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+MptcpOlia::GetName () const
+{
+  return "MptcpOlia";
+}
+
+Ptr<TcpCongestionOps>
+MptcpOlia::Fork ()
+{
+  return CopyObject<MptcpOlia> (this);
+}
+
+uint32_t
+MptcpOlia::GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << tcb << bytesInFlight);
+
+  Ptr<MptcpCoupling> coupling = tcb->GetObject<MptcpCoupling> ();
+  if (coupling != 0)
+    {
+      coupling->OnLoss ();
+    }
+  return TcpLinuxReno::GetSsThresh (tcb, bytesInFlight);
+}
+
+void
+MptcpOlia::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time &rtt)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
+
+  Ptr<MptcpCoupling> coupling = tcb->GetObject<MptcpCoupling> ();
+  if (coupling != 0)
+    {
+      coupling->OnAck (segmentsAcked * tcb->m_segmentSize);
+    }
+}
+
+void
+MptcpOlia::CongestionAvoidance (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+
+  Ptr<MptcpCoupling> coupling = tcb->GetObject<MptcpCoupling> ();
+  double increase;
+  if (coupling == 0 || !coupling->GetOliaIncrease (tcb, segmentsAcked, increase))
+    {
+      TcpLinuxReno::CongestionAvoidance (tcb, segmentsAcked);
+      return;
+    }
+  ApplyWindowChange (tcb, increase, m_cWndFraction);
+}
+
+NS_OBJECT_ENSURE_REGISTERED (MptcpDctcp);
+
+TypeId
+MptcpDctcp::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MptcpDctcp")
+    .SetParent<TcpDctcp> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<MptcpDctcp> ()
+  ;
+  return tid;
+}
+
+MptcpDctcp::MptcpDctcp ()
+  : TcpDctcp (),
+    m_cWndFraction (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpDctcp::MptcpDctcp (const MptcpDctcp& sock)
+  : TcpDctcp (sock),
+    m_cWndFraction (sock.m_cWndFraction)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpDctcp::~MptcpDctcp ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+MptcpDctcp::GetName () const
+{
+  return "MptcpDctcp";
+}
+
+Ptr<TcpCongestionOps>
+MptcpDctcp::Fork ()
+{
+  return CopyObject<MptcpDctcp> (this);
+}
+
+void
+MptcpDctcp::CongestionAvoidance (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+
+  Ptr<MptcpCoupling> coupling = tcb->GetObject<MptcpCoupling> ();
+  double increase;
+  if (coupling == 0 || !coupling->GetLiaIncrease (tcb, segmentsAcked, increase))
+    {
+      TcpDctcp::CongestionAvoidance (tcb, segmentsAcked);
+      return;
+    }
+  ApplyWindowChange (tcb, increase, m_cWndFraction);
+}
+
+} // namespace ns3
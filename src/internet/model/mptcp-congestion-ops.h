@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MPTCP_CONGESTION_OPS_H
+#define MPTCP_CONGESTION_OPS_H
+
+#include "ns3/tcp-linux-reno.h"
+#include "ns3/tcp-dctcp.h"
+
+namespace ns3 {
+
+class MptcpSocket;
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief State shared by the coupled congestion controls of a subflow
+ *
+ * MptcpSocket aggregates an instance of this class to the TcpSocketState of
+ * each of its subflows. Through it, the congestion control of a subflow
+ * reaches the congestion windows and the RTTs of the other subflows of the
+ * same connection. A congestion control that does not find it (a plain
+ * TcpSocketBase, or a subflow that fell back to TCP) behaves as its
+ * uncoupled parent.
+ */
+class MptcpCoupling : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MptcpCoupling ();
+  virtual ~MptcpCoupling ();
+
+  /**
+   * \brief Set the connection the subflow belongs to
+   * \param meta the connection, or nullptr to decouple the subflow
+   */
+  void SetMeta (MptcpSocket *meta);
+
+  /**
+   * \brief Compute the window increase of \RFC{6356} (LIA)
+   *
+   * \param tcb the state of the subflow that received the ACK
+   * \param segmentsAcked the segments acknowledged
+   * \param increase set to the increase of the congestion window, in bytes
+   * \return false if the subflow is not coupled to any other subflow
+   */
+  bool GetLiaIncrease (Ptr<const TcpSocketState> tcb, uint32_t segmentsAcked,
+                       double &increase) const;
+
+  /**
+   * \brief Compute the window increase of OLIA
+   *
+   * R. Khalili, N. Gast, M. Popovic, J.-Y. Le Boudec, "MPTCP is not
+   * Pareto-optimal: performance issues and a possible solution",
+   * IEEE/ACM Transactions on Networking, 2013.
+   *
+   * \param tcb the state of the subflow that received the ACK
+   * \param segmentsAcked the segments acknowledged
+   * \param increase set to the change of the congestion window, in bytes
+   *        (negative for the paths with the largest window when better
+   *        paths exist)
+   * \return false if the subflow is not coupled to any other subflow
+   */
+  bool GetOliaIncrease (Ptr<const TcpSocketState> tcb, uint32_t segmentsAcked,
+                        double &increase) const;
+
+  /**
+   * \brief Account for bytes acknowledged on the subflow
+   * \param bytes the bytes acknowledged
+   */
+  void OnAck (uint32_t bytes);
+
+  /**
+   * \brief Record a loss (or congestion mark) on the subflow
+   */
+  void OnLoss (void);
+
+  /**
+   * \brief Get the OLIA loss interval of the subflow
+   * \return the bytes acknowledged between the last two losses, or since
+   *         the last loss if that is larger
+   */
+  uint64_t GetLossInterval (void) const;
+
+private:
+  MptcpSocket *m_meta;            //!< Connection of the subflow
+  uint64_t m_bytesBetweenLosses;  //!< Bytes acknowledged between the last two losses
+  uint64_t m_bytesSinceLoss;      //!< Bytes acknowledged since the last loss
+};
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief Linked Increases Algorithm (\RFC{6356}) for MPTCP subflows
+ *
+ * Slow start and the reaction to losses are those of TcpLinuxReno; in
+ * congestion avoidance the increase of each subflow is coupled to the other
+ * subflows of the connection, so that the connection as a whole is no more
+ * aggressive than a single TCP flow on its best path.
+ */
+class MptcpLia : public TcpLinuxReno
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MptcpLia ();
+  /**
+   * \brief Copy constructor.
+   * \param sock object to copy.
+   */
+  MptcpLia (const MptcpLia& sock);
+  virtual ~MptcpLia ();
+
+  virtual std::string GetName () const;
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+protected:
+  virtual void CongestionAvoidance (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+
+private:
+  double m_cWndFraction;   //!< Fractional part of the window increase, in bytes
+};
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief Opportunistic Linked Increases Algorithm for MPTCP subflows
+ *
+ * As MptcpLia, but the congestion avoidance increase follows OLIA, which
+ * moves traffic from the paths with the largest windows to the paths that
+ * are presumably the best (largest number of bytes between losses over the
+ * RTT), and is Pareto-optimal where LIA is not.
+ */
+class MptcpOlia : public TcpLinuxReno
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MptcpOlia ();
+  /**
+   * \brief Copy constructor.
+   * \param sock object to copy.
+   */
+  MptcpOlia (const MptcpOlia& sock);
+  virtual ~MptcpOlia ();
+
+  virtual std::string GetName () const;
+  virtual Ptr<TcpCongestionOps> Fork ();
+  virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
+                                uint32_t bytesInFlight);
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                          const Time &rtt);
+
+protected:
+  virtual void CongestionAvoidance (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+
+private:
+  double m_cWndFraction;   //!< Fractional part of the window change, in bytes
+};
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief DCTCP for MPTCP subflows, with the LIA coupled increase
+ *
+ * Each subflow keeps its own DCTCP estimate of the fraction of marked bytes
+ * and reduces its window in proportion to it, as TcpDctcp; the congestion
+ * avoidance increase is coupled across the subflows as in MptcpLia.
+ */
+class MptcpDctcp : public TcpDctcp
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MptcpDctcp ();
+  /**
+   * \brief Copy constructor.
+   * \param sock object to copy.
+   */
+  MptcpDctcp (const MptcpDctcp& sock);
+  virtual ~MptcpDctcp ();
+
+  virtual std::string GetName () const;
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+protected:
+  virtual void CongestionAvoidance (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+
+private:
+  double m_cWndFraction;   //!< Fractional part of the window increase, in bytes
+};
+
+} // namespace ns3
+
+#endif /* MPTCP_CONGESTION_OPS_H */
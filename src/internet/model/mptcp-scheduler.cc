@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mptcp-scheduler.h"
+#include "mptcp-subflow.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MptcpScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (MptcpScheduler);
+
+TypeId
+MptcpScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MptcpScheduler")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+  ;
+  return tid;
+}
+
+MptcpScheduler::MptcpScheduler ()
+  : Object ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpScheduler::~MptcpScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+NS_OBJECT_ENSURE_REGISTERED (MptcpSchedulerMinRtt);
+
+TypeId
+MptcpSchedulerMinRtt::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MptcpSchedulerMinRtt")
+    .SetParent<MptcpScheduler> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<MptcpSchedulerMinRtt> ()
+  ;
+  return tid;
+}
+
+MptcpSchedulerMinRtt::MptcpSchedulerMinRtt ()
+  : MptcpScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpSchedulerMinRtt::~MptcpSchedulerMinRtt ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+MptcpSchedulerMinRtt::GetName (void) const
+{
+  return "MptcpSchedulerMinRtt";
+}
+
+uint32_t
+MptcpSchedulerMinRtt::GetNextSubflow (const std::vector<Ptr<MptcpSubflow> > &candidates)
+{
+  NS_LOG_FUNCTION (this << candidates.size ());
+  NS_ASSERT (!candidates.empty ());
+
+  uint32_t best = 0;
+  for (uint32_t i = 1; i < candidates.size (); ++i)
+    {
+      if (candidates[i]->GetSmoothedRtt () < candidates[best]->GetSmoothedRtt ())
+        {
+          best = i;
+        }
+    }
+  return best;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (MptcpSchedulerRoundRobin);
+
+TypeId
+MptcpSchedulerRoundRobin::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MptcpSchedulerRoundRobin")
+    .SetParent<MptcpScheduler> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<MptcpSchedulerRoundRobin> ()
+  ;
+  return tid;
+}
+
+MptcpSchedulerRoundRobin::MptcpSchedulerRoundRobin ()
+  : MptcpScheduler (),
+    m_last (nullptr)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpSchedulerRoundRobin::~MptcpSchedulerRoundRobin ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+MptcpSchedulerRoundRobin::GetName (void) const
+{
+  return "MptcpSchedulerRoundRobin";
+}
+
+uint32_t
+MptcpSchedulerRoundRobin::GetNextSubflow (const std::vector<Ptr<MptcpSubflow> > &candidates)
+{
+  NS_LOG_FUNCTION (this << candidates.size ());
+  NS_ASSERT (!candidates.empty ());
+
+  // The candidates are ordered by creation: pick the first one created
+  // after the subflow chosen last time, wrapping around
+  uint32_t next = 0;
+  for (uint32_t i = 0; i < candidates.size (); ++i)
+    {
+      if (PeekPointer (candidates[i]) == m_last)
+        {
+          next = (i + 1) % candidates.size ();
+          break;
+        }
+      if (m_last != nullptr && candidates[i]->GetSubflowId () > m_last->GetSubflowId ())
+        {
+          next = i;
+          break;
+        }
+    }
+  m_last = PeekPointer (candidates[next]);
+  return next;
+}
+
+} // namespace ns3
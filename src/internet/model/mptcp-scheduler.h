@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MPTCP_SCHEDULER_H
+#define MPTCP_SCHEDULER_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include <vector>
+
+namespace ns3 {
+
+class MptcpSubflow;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Interface of the packet schedulers of MptcpSocket
+ *
+ * Every time the connection has data to send, the scheduler chooses the
+ * subflow that carries the next chunk among the subflows that have room in
+ * their congestion window.
+ */
+class MptcpScheduler : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MptcpScheduler ();
+  virtual ~MptcpScheduler ();
+
+  /**
+   * \brief Get the name of the scheduler
+   * \return the name of the scheduler
+   */
+  virtual std::string GetName (void) const = 0;
+
+  /**
+   * \brief Choose the subflow for the next chunk of data
+   * \param candidates the established subflows with room in their window,
+   *        in the order they were created (never empty)
+   * \return the index in candidates of the chosen subflow
+   */
+  virtual uint32_t GetNextSubflow (const std::vector<Ptr<MptcpSubflow> > &candidates) = 0;
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Scheduler sending on the subflow with the lowest smoothed RTT
+ *
+ * This is the default scheduler of the Linux implementation: the fastest
+ * subflow is filled first, and the others are used once its congestion
+ * window is full.
+ */
+class MptcpSchedulerMinRtt : public MptcpScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MptcpSchedulerMinRtt ();
+  virtual ~MptcpSchedulerMinRtt ();
+
+  virtual std::string GetName (void) const;
+  virtual uint32_t GetNextSubflow (const std::vector<Ptr<MptcpSubflow> > &candidates);
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Scheduler cycling over the subflows with room in their window
+ */
+class MptcpSchedulerRoundRobin : public MptcpScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MptcpSchedulerRoundRobin ();
+  virtual ~MptcpSchedulerRoundRobin ();
+
+  virtual std::string GetName (void) const;
+  virtual uint32_t GetNextSubflow (const std::vector<Ptr<MptcpSubflow> > &candidates);
+
+private:
+  const MptcpSubflow *m_last;   //!< Subflow chosen last time
+};
+
+} // namespace ns3
+
+#endif /* MPTCP_SCHEDULER_H */
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mptcp-socket-factory.h"
+#include "mptcp-socket.h"
+#include "tcp-l4-protocol.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MptcpSocketFactory");
+
+NS_OBJECT_ENSURE_REGISTERED (MptcpSocketFactory);
+
+TypeId
+MptcpSocketFactory::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MptcpSocketFactory")
+    .SetParent<SocketFactory> ()
+    .SetGroupName ("Internet")
+  ;
+  return tid;
+}
+
+MptcpSocketFactory::MptcpSocketFactory ()
+  : m_tcp (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpSocketFactory::~MptcpSocketFactory ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MptcpSocketFactory::SetTcp (Ptr<TcpL4Protocol> tcp)
+{
+  m_tcp = tcp;
+}
+
+Ptr<TcpL4Protocol>
+MptcpSocketFactory::GetTcp (void) const
+{
+  return m_tcp;
+}
+
+Ptr<Socket>
+MptcpSocketFactory::CreateSocket (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<MptcpSocket> socket = CreateObject<MptcpSocket> ();
+  socket->SetNode (m_tcp->GetObject<Node> ());
+  socket->SetFactory (this);
+  return socket;
+}
+
+void
+MptcpSocketFactory::AddSocket (Ptr<MptcpSocket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  m_sockets.insert (socket);
+}
+
+void
+MptcpSocketFactory::RemoveSocket (Ptr<MptcpSocket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  for (auto it = m_tokens.begin (); it != m_tokens.end (); )
+    {
+      if (it->second == socket)
+        {
+          it = m_tokens.erase (it);
+        }
+      else
+        {
+          ++it;
+        }
+    }
+  m_sockets.erase (socket);
+}
+
+void
+MptcpSocketFactory::RegisterToken (uint32_t token, Ptr<MptcpSocket> socket)
+{
+  NS_LOG_FUNCTION (this << token << socket);
+  m_tokens[token] = socket;
+}
+
+Ptr<MptcpSocket>
+MptcpSocketFactory::LookupToken (uint32_t token) const
+{
+  auto it = m_tokens.find (token);
+  if (it == m_tokens.end ())
+    {
+      return 0;
+    }
+  return it->second;
+}
+
+void
+MptcpSocketFactory::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tokens.clear ();
+  std::set<Ptr<MptcpSocket> > sockets;
+  sockets.swap (m_sockets);
+  for (auto it = sockets.begin (); it != sockets.end (); ++it)
+    {
+      (*it)->SetFactory (0);
+    }
+  m_tcp = 0;
+  SocketFactory::DoDispose ();
+}
+
+} // namespace ns3
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MPTCP_SOCKET_FACTORY_H
+#define MPTCP_SOCKET_FACTORY_H
+
+#include "ns3/socket-factory.h"
+#include "ns3/ptr.h"
+#include <map>
+#include <set>
+
+namespace ns3 {
+
+class TcpL4Protocol;
+class MptcpSocket;
+
+/**
+ * \ingroup socket
+ * \ingroup tcp
+ *
+ * \brief Socket factory for Multipath TCP connections
+ *
+ * Aggregated to each node by TcpL4Protocol, next to the TcpSocketFactory.
+ * Besides creating MptcpSocket instances, the factory keeps alive the
+ * connections accepted by a listening MptcpSocket and maps the token of
+ * each connection to its MptcpSocket, so that the subflows joining a
+ * connection can be attached to it.
+ */
+class MptcpSocketFactory : public SocketFactory
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MptcpSocketFactory ();
+  virtual ~MptcpSocketFactory ();
+
+  /**
+   * \brief Set the associated TCP L4 protocol.
+   * \param tcp the TCP L4 protocol
+   */
+  void SetTcp (Ptr<TcpL4Protocol> tcp);
+
+  /**
+   * \brief Get the associated TCP L4 protocol.
+   * \return the TCP L4 protocol
+   */
+  Ptr<TcpL4Protocol> GetTcp (void) const;
+
+  virtual Ptr<Socket> CreateSocket (void);
+
+  /**
+   * \brief Keep a connection alive until it is removed
+   * \param socket the connection
+   */
+  void AddSocket (Ptr<MptcpSocket> socket);
+
+  /**
+   * \brief Release a connection and its token
+   * \param socket the connection
+   */
+  void RemoveSocket (Ptr<MptcpSocket> socket);
+
+  /**
+   * \brief Register the token of a connection
+   * \param token the token
+   * \param socket the connection
+   */
+  void RegisterToken (uint32_t token, Ptr<MptcpSocket> socket);
+
+  /**
+   * \brief Find the connection identified by a token
+   * \param token the token
+   * \return the connection, or 0 if the token is unknown
+   */
+  Ptr<MptcpSocket> LookupToken (uint32_t token) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  Ptr<TcpL4Protocol> m_tcp;                          //!< the associated TCP L4 protocol
+  std::set<Ptr<MptcpSocket> > m_sockets;             //!< Connections kept alive
+  std::map<uint32_t, Ptr<MptcpSocket> > m_tokens;    //!< Token of each connection
+};
+
+} // namespace ns3
+
+#endif /* MPTCP_SOCKET_FACTORY_H */
@@ -0,0 +1,1203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mptcp-socket.h"
+#include "mptcp-subflow.h"
+#include "mptcp-scheduler.h"
+#include "mptcp-socket-factory.h"
+#include "mptcp-congestion-ops.h"
+#include "tcp-l4-protocol.h"
+#include "tcp-recovery-ops.h"
+#include "ipv4.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/hash.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/type-id.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/trace-source-accessor.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MptcpSocket");
+
+NS_OBJECT_ENSURE_REGISTERED (MptcpSocket);
+
+/**
+ * \brief Serialize a key in network order, as hashed by \RFC{6824}
+ * \param key the key
+ * \param buffer the 8-byte buffer
+ */
+static void
+SerializeKey (uint64_t key, char *buffer)
+{
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      buffer[i] = static_cast<char> ((key >> (56 - 8 * i)) & 0xff);
+    }
+}
+
+/**
+ * \brief Compute the token that identifies a connection from the key of its receiver
+ * \param key the key
+ * \return the token
+ */
+static uint32_t
+TokenFromKey (uint64_t key)
+{
+  char buffer[8];
+  SerializeKey (key, buffer);
+  return Hash32 (buffer, 8);
+}
+
+/**
+ * \brief Compute the initial data sequence number of a sender from its key
+ * \param key the key
+ * \return the initial data sequence number
+ */
+static uint32_t
+IdsnFromKey (uint64_t key)
+{
+  char buffer[8];
+  SerializeKey (key, buffer);
+  return static_cast<uint32_t> (Hash64 (buffer, 8));
+}
+
+TypeId
+MptcpSocket::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MptcpSocket")
+    .SetParent<TcpSocket> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<MptcpSocket> ()
+    .AddAttribute ("CongestionControl",
+                   "TypeId of the congestion control of the subflows",
+                   TypeIdValue (MptcpLia::GetTypeId ()),
+                   MakeTypeIdAccessor (&MptcpSocket::m_congestionTypeId),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("Scheduler",
+                   "TypeId of the scheduler choosing the subflow of each chunk of data",
+                   TypeIdValue (MptcpSchedulerMinRtt::GetTypeId ()),
+                   MakeTypeIdAccessor (&MptcpSocket::m_schedulerTypeId),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("PathManager",
+                   "How the client opens the additional subflows",
+                   EnumValue (MptcpSocket::FULLMESH),
+                   MakeEnumAccessor (&MptcpSocket::m_pathManager),
+                   MakeEnumChecker (MptcpSocket::NDIFFPORTS, "NdiffPorts",
+                                    MptcpSocket::FULLMESH, "FullMesh"))
+    .AddAttribute ("NumSubflows",
+                   "Number of subflows opened by NdiffPorts, maximum number of subflows of FullMesh",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&MptcpSocket::m_numSubflows),
+                   MakeUintegerChecker<uint32_t> (1, 255))
+    .AddTraceSource ("SubflowAdded",
+                     "A subflow was added to the connection",
+                     MakeTraceSourceAccessor (&MptcpSocket::m_subflowAdded),
+                     "ns3::MptcpSocket::SubflowTracedCallback")
+  ;
+  return tid;
+}
+
+MptcpSocket::MptcpSocket (void)
+  : TcpSocket (),
+    m_pathManager (FULLMESH),
+    m_numSubflows (8),
+    m_sndBufSize (0),
+    m_rcvBufSize (0),
+    m_segmentSize (0),
+    m_initialSsThresh (0),
+    m_initialCwnd (0),
+    m_synRetries (0),
+    m_dataRetries (0),
+    m_delAckMaxCount (0),
+    m_noDelay (false),
+    m_state (CLOSED),
+    m_errno (ERROR_NOTERROR),
+    m_mptcp (false),
+    m_isClient (false),
+    m_closeOnEmpty (false),
+    m_shutdownSend (false),
+    m_shutdownRecv (false),
+    m_closeNotified (false),
+    m_remoteAddress (Ipv4Address::GetAny (), 0),
+    m_nextSubflowId (0),
+    m_localKey (0),
+    m_remoteKey (0),
+    m_remoteToken (0),
+    m_txPending (Create<Packet> ()),
+    m_rxAvailable (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_rng = CreateObject<UniformRandomVariable> ();
+}
+
+MptcpSocket::MptcpSocket (const MptcpSocket& sock)
+  : TcpSocket (sock),
+    m_congestionTypeId (sock.m_congestionTypeId),
+    m_schedulerTypeId (sock.m_schedulerTypeId),
+    m_pathManager (sock.m_pathManager),
+    m_numSubflows (sock.m_numSubflows),
+    m_sndBufSize (sock.m_sndBufSize),
+    m_rcvBufSize (sock.m_rcvBufSize),
+    m_segmentSize (sock.m_segmentSize),
+    m_initialSsThresh (sock.m_initialSsThresh),
+    m_initialCwnd (sock.m_initialCwnd),
+    m_connTimeout (sock.m_connTimeout),
+    m_synRetries (sock.m_synRetries),
+    m_dataRetries (sock.m_dataRetries),
+    m_delAckTimeout (sock.m_delAckTimeout),
+    m_delAckMaxCount (sock.m_delAckMaxCount),
+    m_noDelay (sock.m_noDelay),
+    m_persistTimeout (sock.m_persistTimeout),
+    m_node (sock.m_node),
+    m_factory (sock.m_factory),
+    m_rng (sock.m_rng),
+    m_state (CLOSED),
+    m_errno (ERROR_NOTERROR),
+    m_mptcp (false),
+    m_isClient (false),
+    m_closeOnEmpty (false),
+    m_shutdownSend (sock.m_shutdownSend),
+    m_shutdownRecv (sock.m_shutdownRecv),
+    m_closeNotified (false),
+    m_localAddress (sock.m_localAddress),
+    m_remoteAddress (Ipv4Address::GetAny (), 0),
+    m_nextSubflowId (0),
+    m_localKey (0),
+    m_remoteKey (0),
+    m_remoteToken (0),
+    m_txPending (Create<Packet> ()),
+    m_rxAvailable (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpSocket::~MptcpSocket (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MptcpSocket::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Ptr<MptcpSubflow> > subflows;
+  subflows.swap (m_subflows);
+  if (m_listener != 0)
+    {
+      subflows.push_back (m_listener);
+      m_listener->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                                     MakeNullCallback<void, Ptr<Socket>, const Address &> ());
+      m_listener = 0;
+    }
+  for (const Ptr<MptcpSubflow> &sf : subflows)
+    {
+      sf->SetMeta (nullptr);
+      sf->SetConnectCallback (MakeNullCallback<void, Ptr<Socket> > (),
+                              MakeNullCallback<void, Ptr<Socket> > ());
+      sf->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (),
+                             MakeNullCallback<void, Ptr<Socket> > ());
+      sf->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      sf->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+    }
+  m_closedSubflows.clear ();
+  m_rxOutOfOrder.clear ();
+  m_rxReady.clear ();
+  m_txPending = 0;
+  m_scheduler = 0;
+  m_factory = 0;
+  m_node = 0;
+  m_rng = 0;
+  TcpSocket::DoDispose ();
+}
+
+void
+MptcpSocket::SetNode (Ptr<Node> node)
+{
+  m_node = node;
+}
+
+void
+MptcpSocket::SetFactory (Ptr<MptcpSocketFactory> factory)
+{
+  m_factory = factory;
+}
+
+const std::vector<Ptr<MptcpSubflow> > &
+MptcpSocket::GetSubflows (void) const
+{
+  return m_subflows;
+}
+
+bool
+MptcpSocket::IsMptcp (void) const
+{
+  return m_mptcp;
+}
+
+uint64_t
+MptcpSocket::GenerateKey (void)
+{
+  uint64_t high = m_rng->GetInteger (0, 0xffffffff);
+  return (high << 32) | m_rng->GetInteger (0, 0xffffffff);
+}
+
+int64_t
+MptcpSocket::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rng->SetStream (stream);
+  return 1;
+}
+
+SequenceNumber32
+MptcpSocket::GetDataAck (void) const
+{
+  return m_dataRcvNxt;
+}
+
+void
+MptcpSocket::InitDataSequences (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_mptcp)
+    {
+      m_dataSndUna = SequenceNumber32 (IdsnFromKey (m_localKey)) + SequenceNumber32 (1);
+      m_dataRcvNxt = SequenceNumber32 (IdsnFromKey (m_remoteKey)) + SequenceNumber32 (1);
+      m_remoteToken = TokenFromKey (m_remoteKey);
+    }
+  else
+    {
+      // Fallback: the data sequence numbers are the offsets in the stream
+      m_dataSndUna = SequenceNumber32 (0);
+      m_dataRcvNxt = SequenceNumber32 (0);
+    }
+  m_dataSndNxt = m_dataSndUna;
+}
+
+Ptr<MptcpSubflow>
+MptcpSocket::CreateSubflow (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_factory == 0, "The connection is not bound to a node");
+
+  Ptr<TcpL4Protocol> tcp = m_factory->GetTcp ();
+  TypeIdValue recovery;
+  tcp->GetAttribute ("RecoveryType", recovery);
+  Ptr<MptcpSubflow> sf = DynamicCast<MptcpSubflow> (tcp->CreateSocket (m_congestionTypeId, recovery.Get (),
+                                                                       MptcpSubflow::GetTypeId ()));
+  sf->SetAttribute ("SndBufSize", UintegerValue (m_sndBufSize));
+  sf->SetAttribute ("RcvBufSize", UintegerValue (m_rcvBufSize));
+  sf->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  sf->SetAttribute ("InitialSlowStartThreshold", UintegerValue (m_initialSsThresh));
+  sf->SetAttribute ("InitialCwnd", UintegerValue (m_initialCwnd));
+  sf->SetAttribute ("ConnTimeout", TimeValue (m_connTimeout));
+  sf->SetAttribute ("ConnCount", UintegerValue (m_synRetries));
+  sf->SetAttribute ("DataRetries", UintegerValue (m_dataRetries));
+  sf->SetAttribute ("DelAckTimeout", TimeValue (m_delAckTimeout));
+  sf->SetAttribute ("DelAckCount", UintegerValue (m_delAckMaxCount));
+  sf->SetAttribute ("TcpNoDelay", BooleanValue (m_noDelay));
+  sf->SetAttribute ("PersistTimeout", TimeValue (m_persistTimeout));
+  sf->SetMeta (this);
+  return sf;
+}
+
+void
+MptcpSocket::AttachSubflow (Ptr<MptcpSubflow> subflow)
+{
+  NS_LOG_FUNCTION (this << subflow);
+  subflow->SetMeta (this);
+  subflow->SetSubflowId (m_nextSubflowId++);
+  subflow->SetConnectCallback (MakeCallback (&MptcpSocket::SubflowConnected, this),
+                               MakeCallback (&MptcpSocket::SubflowConnectionFailed, this));
+  subflow->SetCloseCallbacks (MakeCallback (&MptcpSocket::SubflowNormalClose, this),
+                              MakeCallback (&MptcpSocket::SubflowErrorClose, this));
+  subflow->SetRecvCallback (MakeCallback (&MptcpSocket::SubflowRecv, this));
+  subflow->SetSendCallback (MakeCallback (&MptcpSocket::SubflowSend, this));
+  m_subflows.push_back (subflow);
+  m_subflowAdded (subflow);
+}
+
+std::vector<Ipv4Address>
+MptcpSocket::GetLocalAddresses (void) const
+{
+  std::vector<Ipv4Address> addresses;
+  Ptr<Ipv4> ipv4 = m_node->GetObject<Ipv4> ();
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); ++i)
+    {
+      if (!ipv4->IsUp (i) || ipv4->GetNAddresses (i) == 0)
+        {
+          continue;
+        }
+      Ipv4Address address = ipv4->GetAddress (i, 0).GetLocal ();
+      if (!address.IsLocalhost ())
+        {
+          addresses.push_back (address);
+        }
+    }
+  return addresses;
+}
+
+void
+MptcpSocket::OpenSubflows (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_mptcp || !m_isClient || m_closeOnEmpty || m_state != ESTABLISHED)
+    {
+      return;
+    }
+
+  if (m_pathManager == NDIFFPORTS)
+    {
+      Address local;
+      m_subflows.front ()->GetSockName (local);
+      Ipv4Address localIp = InetSocketAddress::ConvertFrom (local).GetIpv4 ();
+      while (m_subflows.size () < m_numSubflows)
+        {
+          OpenSubflow (localIp, 0, m_remoteAddress);
+        }
+      return;
+    }
+
+  std::vector<Ipv4Address> locals = GetLocalAddresses ();
+  for (uint32_t i = 0; i < locals.size (); ++i)
+    {
+      for (const auto &remote : m_remoteAddresses)
+        {
+          if (m_subflows.size () >= m_numSubflows)
+            {
+              return;
+            }
+          std::pair<uint32_t, uint32_t> path (locals[i].Get (), remote.second.GetIpv4 ().Get ());
+          if (m_paths.insert (path).second)
+            {
+              OpenSubflow (locals[i], static_cast<uint8_t> (i), remote.second);
+            }
+        }
+    }
+}
+
+void
+MptcpSocket::OpenSubflow (Ipv4Address local, uint8_t addressId, InetSocketAddress remote)
+{
+  NS_LOG_FUNCTION (this << local << static_cast<uint32_t> (addressId) << remote.GetIpv4 ());
+
+  Ptr<MptcpSubflow> sf = CreateSubflow ();
+  AttachSubflow (sf);
+  sf->SetJoin (m_remoteToken, addressId);
+  if (sf->Bind (InetSocketAddress (local, 0)) != 0 || sf->Connect (remote) != 0)
+    {
+      NS_LOG_WARN ("Cannot open a subflow from " << local << " to " << remote.GetIpv4 ());
+      SubflowClosed (sf, true);
+    }
+}
+
+void
+MptcpSocket::AddRemoteAddress (uint8_t addressId, Ipv4Address address, uint16_t port)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (addressId) << address << port);
+
+  if (!m_isClient || m_remoteAddresses.find (addressId) != m_remoteAddresses.end ())
+    {
+      return;
+    }
+  InetSocketAddress remote (address, port != 0 ? port : m_remoteAddress.GetPort ());
+  m_remoteAddresses.insert (std::make_pair (addressId, remote));
+  if (m_pathManager == FULLMESH)
+    {
+      OpenSubflows ();
+    }
+}
+
+void
+MptcpSocket::SendPendingData (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_state != ESTABLISHED)
+    {
+      return;
+    }
+  if (m_scheduler == 0)
+    {
+      ObjectFactory factory;
+      factory.SetTypeId (m_schedulerTypeId);
+      m_scheduler = factory.Create<MptcpScheduler> ();
+    }
+
+  // A DSS mapping is at most 64 KB long; keep the chunks segment-aligned
+  uint32_t maxChunk = std::max (m_segmentSize, 0xffff / m_segmentSize * m_segmentSize);
+  while (m_txPending->GetSize () > 0)
+    {
+      uint32_t pending = m_txPending->GetSize ();
+      std::vector<Ptr<MptcpSubflow> > candidates;
+      for (const Ptr<MptcpSubflow> &sf : m_subflows)
+        {
+          if (m_closedSubflows.count (PeekPointer (sf)) > 0
+              || (!m_mptcp && sf != m_subflows.front ()))
+            {
+              continue;
+            }
+          if (sf->GetSchedulingWindow () >= std::min (pending, m_segmentSize))
+            {
+              candidates.push_back (sf);
+            }
+        }
+      if (candidates.empty ())
+        {
+          break;
+        }
+
+      Ptr<MptcpSubflow> sf = candidates[m_scheduler->GetNextSubflow (candidates)];
+      uint32_t size = std::min (std::min (pending, sf->GetSchedulingWindow ()), maxChunk);
+      if (size < pending && size > m_segmentSize)
+        {
+          size -= size % m_segmentSize;
+        }
+      NS_LOG_LOGIC ("Mapping " << size << " bytes at " << m_dataSndNxt
+                    << " on subflow " << sf->GetSubflowId ());
+      if (sf->SendMapped (m_txPending->CreateFragment (0, size), m_dataSndNxt) <= 0)
+        {
+          break;
+        }
+      m_txPending->RemoveAtStart (size);
+      m_dataSndNxt += size;
+    }
+
+  if (m_closeOnEmpty && m_txPending->GetSize () == 0)
+    {
+      CloseSubflows ();
+    }
+}
+
+void
+MptcpSocket::CloseSubflows (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Ptr<MptcpSubflow> > subflows = m_subflows;
+  for (const Ptr<MptcpSubflow> &sf : subflows)
+    {
+      if (m_closedSubflows.count (PeekPointer (sf)) == 0)
+        {
+          sf->Close ();
+        }
+    }
+}
+
+void
+MptcpSocket::ReceivedDataAck (SequenceNumber32 dataAck)
+{
+  NS_LOG_FUNCTION (this << dataAck);
+
+  if (dataAck <= m_dataSndUna)
+    {
+      return;
+    }
+  m_dataSndUna = std::min (dataAck, m_dataSndNxt);
+  if (GetTxAvailable () > 0)
+    {
+      NotifySend (GetTxAvailable ());
+    }
+}
+
+bool
+MptcpSocket::AddRxData (Ptr<Packet> p, SequenceNumber32 dataSeq)
+{
+  NS_LOG_FUNCTION (this << p << dataSeq);
+
+  SequenceNumber32 end = dataSeq + SequenceNumber32 (p->GetSize ());
+  if (end <= m_dataRcvNxt)
+    {
+      return false;
+    }
+  if (dataSeq < m_dataRcvNxt)
+    {
+      p->RemoveAtStart (m_dataRcvNxt - dataSeq);
+      dataSeq = m_dataRcvNxt;
+    }
+  if (dataSeq > m_dataRcvNxt)
+    {
+      auto it = m_rxOutOfOrder.find (dataSeq);
+      if (it == m_rxOutOfOrder.end () || it->second->GetSize () < p->GetSize ())
+        {
+          m_rxOutOfOrder[dataSeq] = p;
+        }
+      return false;
+    }
+
+  m_rxReady.push_back (p);
+  m_rxAvailable += p->GetSize ();
+  m_dataRcvNxt = end;
+  while (!m_rxOutOfOrder.empty () && m_rxOutOfOrder.begin ()->first <= m_dataRcvNxt)
+    {
+      Ptr<Packet> next = m_rxOutOfOrder.begin ()->second;
+      SequenceNumber32 nextSeq = m_rxOutOfOrder.begin ()->first;
+      m_rxOutOfOrder.erase (m_rxOutOfOrder.begin ());
+      SequenceNumber32 nextEnd = nextSeq + SequenceNumber32 (next->GetSize ());
+      if (nextEnd <= m_dataRcvNxt)
+        {
+          continue;
+        }
+      next->RemoveAtStart (m_dataRcvNxt - nextSeq);
+      m_rxReady.push_back (next);
+      m_rxAvailable += next->GetSize ();
+      m_dataRcvNxt = nextEnd;
+    }
+  return true;
+}
+
+void
+MptcpSocket::SubflowClosed (Ptr<MptcpSubflow> subflow, bool error)
+{
+  NS_LOG_FUNCTION (this << subflow << error);
+
+  if (!m_closedSubflows.insert (PeekPointer (subflow)).second)
+    {
+      return;
+    }
+  if (m_closedSubflows.size () < m_subflows.size () || m_state == SYN_SENT)
+    {
+      // Without reinjection, the data queued on a failed subflow is lost
+      // for the connection: the others keep going
+      return;
+    }
+
+  NS_LOG_DEBUG ("All the subflows are closed");
+  m_state = CLOSED;
+  if (!m_closeNotified)
+    {
+      m_closeNotified = true;
+      if (error && !m_closeOnEmpty)
+        {
+          NotifyErrorClose ();
+        }
+      else
+        {
+          NotifyNormalClose ();
+        }
+    }
+  if (m_factory != 0)
+    {
+      // Not now: the connection may be released with the factory reference
+      Simulator::ScheduleNow (&MptcpSocketFactory::RemoveSocket, m_factory,
+                              Ptr<MptcpSocket> (this));
+    }
+}
+
+void
+MptcpSocket::SubflowConnected (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<MptcpSubflow> sf = DynamicCast<MptcpSubflow> (socket);
+
+  if (m_state == SYN_SENT && sf == m_subflows.front ())
+    {
+      m_mptcp = sf->IsMpCapable ();
+      m_remoteKey = sf->GetRemoteKey ();
+      InitDataSequences ();
+      m_state = ESTABLISHED;
+      NS_LOG_INFO ("Connection established, " << (m_mptcp ? "MPTCP" : "fallback to TCP"));
+      if (m_mptcp)
+        {
+          Address local;
+          sf->GetSockName (local);
+          m_paths.insert (std::make_pair (InetSocketAddress::ConvertFrom (local).GetIpv4 ().Get (),
+                                          m_remoteAddress.GetIpv4 ().Get ()));
+          m_remoteAddresses.insert (std::make_pair (0, m_remoteAddress));
+        }
+      NotifyConnectionSucceeded ();
+      OpenSubflows ();
+      SendPendingData ();
+      if (GetTxAvailable () > 0)
+        {
+          NotifySend (GetTxAvailable ());
+        }
+      return;
+    }
+
+  if (!sf->IsMpCapable () || m_closeOnEmpty)
+    {
+      NS_LOG_INFO ("Closing subflow " << sf->GetSubflowId ());
+      sf->Close ();
+      return;
+    }
+  SendPendingData ();
+}
+
+void
+MptcpSocket::SubflowConnectionFailed (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<MptcpSubflow> sf = DynamicCast<MptcpSubflow> (socket);
+
+  if (m_state == SYN_SENT && sf == m_subflows.front ())
+    {
+      m_state = CLOSED;
+      m_closedSubflows.insert (PeekPointer (sf));
+      NotifyConnectionFailed ();
+      return;
+    }
+  SubflowClosed (sf, true);
+}
+
+bool
+MptcpSocket::SubflowConnectionRequest (Ptr<Socket> socket, const Address &from)
+{
+  NS_LOG_FUNCTION (this << socket << from);
+  return NotifyConnectionRequest (from);
+}
+
+void
+MptcpSocket::SubflowAccepted (Ptr<Socket> socket, const Address &from)
+{
+  NS_LOG_FUNCTION (this << socket << from);
+  Ptr<MptcpSubflow> sf = DynamicCast<MptcpSubflow> (socket);
+
+  if (sf->IsJoin ())
+    {
+      Ptr<MptcpSocket> meta = (m_factory != 0) ? m_factory->LookupToken (sf->GetJoinToken ()) : 0;
+      if (meta == 0 || meta->m_state != ESTABLISHED)
+        {
+          NS_LOG_WARN ("MP_JOIN for an unknown connection, token " << sf->GetJoinToken ());
+          sf->SetMeta (nullptr);
+          sf->Close ();
+          return;
+        }
+      meta->AttachSubflow (sf);
+      meta->SendPendingData ();
+      return;
+    }
+
+  Ptr<MptcpSocket> meta = CopyObject<MptcpSocket> (this);
+  meta->m_mptcp = sf->IsMpCapable ();
+  meta->m_localKey = sf->GetLocalKey ();
+  meta->m_remoteKey = sf->GetRemoteKey ();
+  meta->InitDataSequences ();
+  meta->m_state = ESTABLISHED;
+  meta->m_remoteAddress = InetSocketAddress::ConvertFrom (from);
+  meta->AttachSubflow (sf);
+  if (m_factory != 0)
+    {
+      m_factory->AddSocket (meta);
+      if (meta->m_mptcp)
+        {
+          m_factory->RegisterToken (TokenFromKey (meta->m_localKey), meta);
+        }
+    }
+  if (meta->m_mptcp)
+    {
+      // Advertise the other addresses of the node, for the full-mesh path
+      // manager of the peer
+      Address local;
+      sf->GetSockName (local);
+      Ipv4Address localIp = InetSocketAddress::ConvertFrom (local).GetIpv4 ();
+      uint8_t addressId = 1;
+      for (const Ipv4Address &address : GetLocalAddresses ())
+        {
+          if (address != localIp)
+            {
+              sf->AdvertiseAddress (addressId++, address);
+            }
+        }
+    }
+  NotifyNewConnectionCreated (meta, from);
+}
+
+void
+MptcpSocket::SubflowRecv (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<MptcpSubflow> sf = DynamicCast<MptcpSubflow> (socket);
+
+  bool ready = false;
+  SequenceNumber32 dataSeq;
+  Ptr<Packet> p;
+  while ((p = sf->RecvMapped (dataSeq)) != 0)
+    {
+      ready |= AddRxData (p, dataSeq);
+    }
+  if (ready && !m_shutdownRecv)
+    {
+      NotifyDataRecv ();
+    }
+}
+
+void
+MptcpSocket::SubflowSend (Ptr<Socket> socket, uint32_t available)
+{
+  NS_LOG_FUNCTION (this << socket << available);
+  SendPendingData ();
+}
+
+void
+MptcpSocket::SubflowNormalClose (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<MptcpSubflow> sf = DynamicCast<MptcpSubflow> (socket);
+
+  if (sf->IsEstablished ())
+    {
+      // The peer closed the subflow: close our side once the subflow is
+      // done processing the FIN
+      Simulator::ScheduleNow (&MptcpSubflow::Close, sf);
+    }
+  SubflowClosed (sf, false);
+}
+
+void
+MptcpSocket::SubflowErrorClose (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  SubflowClosed (DynamicCast<MptcpSubflow> (socket), true);
+}
+
+enum Socket::SocketErrno
+MptcpSocket::GetErrno (void) const
+{
+  return m_errno;
+}
+
+enum Socket::SocketType
+MptcpSocket::GetSocketType (void) const
+{
+  return NS3_SOCK_STREAM;
+}
+
+Ptr<Node>
+MptcpSocket::GetNode (void) const
+{
+  return m_node;
+}
+
+int
+MptcpSocket::Bind (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_localAddress = Address ();
+  return 0;
+}
+
+int
+MptcpSocket::Bind6 (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_errno = ERROR_AFNOSUPPORT;
+  return -1;
+}
+
+int
+MptcpSocket::Bind (const Address &address)
+{
+  NS_LOG_FUNCTION (this << address);
+  if (!InetSocketAddress::IsMatchingType (address))
+    {
+      m_errno = ERROR_AFNOSUPPORT;
+      return -1;
+    }
+  m_localAddress = address;
+  return 0;
+}
+
+int
+MptcpSocket::Connect (const Address &address)
+{
+  NS_LOG_FUNCTION (this << address);
+
+  if (m_state != CLOSED)
+    {
+      m_errno = ERROR_INVAL;
+      return -1;
+    }
+  if (!InetSocketAddress::IsMatchingType (address))
+    {
+      m_errno = ERROR_AFNOSUPPORT;
+      return -1;
+    }
+
+  m_isClient = true;
+  m_remoteAddress = InetSocketAddress::ConvertFrom (address);
+  m_localKey = GenerateKey ();
+  Ptr<MptcpSubflow> sf = CreateSubflow ();
+  AttachSubflow (sf);
+  sf->SetLocalKey (m_localKey);
+  int ret = m_localAddress.IsInvalid () ? sf->Bind () : sf->Bind (m_localAddress);
+  if (ret == 0)
+    {
+      ret = sf->Connect (address);
+    }
+  if (ret != 0)
+    {
+      m_errno = sf->GetErrno ();
+      return ret;
+    }
+  m_state = SYN_SENT;
+  return 0;
+}
+
+int
+MptcpSocket::Listen (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_state != CLOSED)
+    {
+      m_errno = ERROR_INVAL;
+      return -1;
+    }
+  m_listener = CreateSubflow ();
+  m_listener->SetAcceptCallback (MakeCallback (&MptcpSocket::SubflowConnectionRequest, this),
+                                 MakeCallback (&MptcpSocket::SubflowAccepted, this));
+  int ret = m_localAddress.IsInvalid () ? m_listener->Bind () : m_listener->Bind (m_localAddress);
+  if (ret == 0)
+    {
+      ret = m_listener->Listen ();
+    }
+  if (ret != 0)
+    {
+      m_errno = m_listener->GetErrno ();
+      return ret;
+    }
+  m_state = LISTEN;
+  return 0;
+}
+
+int
+MptcpSocket::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_state == LISTEN)
+    {
+      m_listener->Close ();
+      m_state = CLOSED;
+      return 0;
+    }
+  if (m_state == CLOSED || m_closeOnEmpty)
+    {
+      return 0;
+    }
+  m_closeOnEmpty = true;
+  m_shutdownSend = true;
+  if (m_state == ESTABLISHED && m_txPending->GetSize () == 0)
+    {
+      CloseSubflows ();
+    }
+  return 0;
+}
+
+int
+MptcpSocket::ShutdownSend (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_state == SYN_SENT || m_state == ESTABLISHED)
+    {
+      return Close ();
+    }
+  m_shutdownSend = true;
+  return 0;
+}
+
+int
+MptcpSocket::ShutdownRecv (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_shutdownRecv = true;
+  return 0;
+}
+
+uint32_t
+MptcpSocket::GetTxAvailable (void) const
+{
+  uint32_t used = static_cast<uint32_t> (m_dataSndNxt - m_dataSndUna) + m_txPending->GetSize ();
+  return used >= m_sndBufSize ? 0 : m_sndBufSize - used;
+}
+
+int
+MptcpSocket::Send (Ptr<Packet> p, uint32_t flags)
+{
+  NS_LOG_FUNCTION (this << p << flags);
+
+  if (m_shutdownSend)
+    {
+      m_errno = ERROR_SHUTDOWN;
+      return -1;
+    }
+  if (m_state != SYN_SENT && m_state != ESTABLISHED)
+    {
+      m_errno = ERROR_NOTCONN;
+      return -1;
+    }
+  if (p->GetSize () > GetTxAvailable ())
+    {
+      m_errno = ERROR_MSGSIZE;
+      return -1;
+    }
+  m_txPending->AddAtEnd (p);
+  SendPendingData ();
+  return p->GetSize ();
+}
+
+int
+MptcpSocket::SendTo (Ptr<Packet> p, uint32_t flags, const Address &toAddress)
+{
+  NS_LOG_FUNCTION (this << p << flags << toAddress);
+  return Send (p, flags);
+}
+
+uint32_t
+MptcpSocket::GetRxAvailable (void) const
+{
+  return m_rxAvailable;
+}
+
+Ptr<Packet>
+MptcpSocket::Recv (uint32_t maxSize, uint32_t flags)
+{
+  NS_LOG_FUNCTION (this << maxSize << flags);
+
+  if (m_rxReady.empty ())
+    {
+      return 0;
+    }
+  Ptr<Packet> out = Create<Packet> ();
+  while (!m_rxReady.empty () && out->GetSize () < maxSize)
+    {
+      Ptr<Packet> front = m_rxReady.front ();
+      uint32_t room = maxSize - out->GetSize ();
+      if (front->GetSize () <= room)
+        {
+          out->AddAtEnd (front);
+          m_rxReady.pop_front ();
+        }
+      else
+        {
+          out->AddAtEnd (front->CreateFragment (0, room));
+          front->RemoveAtStart (room);
+        }
+    }
+  m_rxAvailable -= out->GetSize ();
+  return out;
+}
+
+Ptr<Packet>
+MptcpSocket::RecvFrom (uint32_t maxSize, uint32_t flags, Address &fromAddress)
+{
+  NS_LOG_FUNCTION (this << maxSize << flags);
+  Ptr<Packet> p = Recv (maxSize, flags);
+  if (p != 0 && p->GetSize () > 0)
+    {
+      fromAddress = m_remoteAddress;
+    }
+  return p;
+}
+
+int
+MptcpSocket::GetSockName (Address &address) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_listener != 0)
+    {
+      return m_listener->GetSockName (address);
+    }
+  if (!m_subflows.empty ())
+    {
+      return m_subflows.front ()->GetSockName (address);
+    }
+  address = m_localAddress.IsInvalid () ? Address (InetSocketAddress (Ipv4Address::GetZero (), 0))
+                                        : m_localAddress;
+  return 0;
+}
+
+int
+MptcpSocket::GetPeerName (Address &address) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_state != ESTABLISHED)
+    {
+      m_errno = ERROR_NOTCONN;
+      return -1;
+    }
+  address = m_remoteAddress;
+  return 0;
+}
+
+bool
+MptcpSocket::SetAllowBroadcast (bool allowBroadcast)
+{
+  return !allowBroadcast;
+}
+
+bool
+MptcpSocket::GetAllowBroadcast (void) const
+{
+  return false;
+}
+
+void
+MptcpSocket::SetSndBufSize (uint32_t size)
+{
+  m_sndBufSize = size;
+}
+
+uint32_t
+MptcpSocket::GetSndBufSize (void) const
+{
+  return m_sndBufSize;
+}
+
+void
+MptcpSocket::SetRcvBufSize (uint32_t size)
+{
+  m_rcvBufSize = size;
+}
+
+uint32_t
+MptcpSocket::GetRcvBufSize (void) const
+{
+  return m_rcvBufSize;
+}
+
+void
+MptcpSocket::SetSegSize (uint32_t size)
+{
+  m_segmentSize = size;
+}
+
+uint32_t
+MptcpSocket::GetSegSize (void) const
+{
+  return m_segmentSize;
+}
+
+void
+MptcpSocket::SetInitialSSThresh (uint32_t threshold)
+{
+  m_initialSsThresh = threshold;
+}
+
+uint32_t
+MptcpSocket::GetInitialSSThresh (void) const
+{
+  return m_initialSsThresh;
+}
+
+void
+MptcpSocket::SetInitialCwnd (uint32_t cwnd)
+{
+  m_initialCwnd = cwnd;
+}
+
+uint32_t
+MptcpSocket::GetInitialCwnd (void) const
+{
+  return m_initialCwnd;
+}
+
+void
+MptcpSocket::SetConnTimeout (Time timeout)
+{
+  m_connTimeout = timeout;
+}
+
+Time
+MptcpSocket::GetConnTimeout (void) const
+{
+  return m_connTimeout;
+}
+
+void
+MptcpSocket::SetSynRetries (uint32_t count)
+{
+  m_synRetries = count;
+}
+
+uint32_t
+MptcpSocket::GetSynRetries (void) const
+{
+  return m_synRetries;
+}
+
+void
+MptcpSocket::SetDataRetries (uint32_t retries)
+{
+  m_dataRetries = retries;
+}
+
+uint32_t
+MptcpSocket::GetDataRetries (void) const
+{
+  return m_dataRetries;
+}
+
+void
+MptcpSocket::SetDelAckTimeout (Time timeout)
+{
+  m_delAckTimeout = timeout;
+}
+
+Time
+MptcpSocket::GetDelAckTimeout (void) const
+{
+  return m_delAckTimeout;
+}
+
+void
+MptcpSocket::SetDelAckMaxCount (uint32_t count)
+{
+  m_delAckMaxCount = count;
+}
+
+uint32_t
+MptcpSocket::GetDelAckMaxCount (void) const
+{
+  return m_delAckMaxCount;
+}
+
+void
+MptcpSocket::SetTcpNoDelay (bool noDelay)
+{
+  m_noDelay = noDelay;
+}
+
+bool
+MptcpSocket::GetTcpNoDelay (void) const
+{
+  return m_noDelay;
+}
+
+void
+MptcpSocket::SetPersistTimeout (Time timeout)
+{
+  m_persistTimeout = timeout;
+}
+
+Time
+MptcpSocket::GetPersistTimeout (void) const
+{
+  return m_persistTimeout;
+}
+
+} // namespace ns3
@@ -0,0 +1,391 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MPTCP_SOCKET_H
+#define MPTCP_SOCKET_H
+
+#include "ns3/tcp-socket.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/sequence-number.h"
+#include "ns3/traced-callback.h"
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+class Packet;
+class MptcpSubflow;
+class MptcpScheduler;
+class MptcpSocketFactory;
+class UniformRandomVariable;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief A Multipath TCP connection (\RFC{6824})
+ *
+ * MptcpSocket is the socket seen by the application: it offers the stream
+ * semantics of TcpSocket over several MptcpSubflow, each a TcpSocketBase
+ * with its own congestion control. It is created through
+ * MptcpSocketFactory, e.g. by setting the "Protocol" attribute of
+ * BulkSendApplication and PacketSink to ns3::MptcpSocketFactory.
+ *
+ * The first subflow negotiates MPTCP with MP_CAPABLE; if the peer does not
+ * answer, the connection falls back to plain TCP over that subflow. Once
+ * the connection is established, the path manager of the client opens the
+ * other subflows with MP_JOIN:
+ *
+ * - NDIFFPORTS opens NumSubflows subflows between the same pair of
+ *   addresses, with different source ports, to be spread over the paths
+ *   by ECMP;
+ * - FULLMESH opens a subflow between each local address and each address of
+ *   the peer (the initial one and those advertised with ADD_ADDR), up to
+ *   NumSubflows subflows.
+ *
+ * The data of the application gets a data sequence number and is queued on
+ * the subflows in chunks chosen by an MptcpScheduler; each chunk is signaled
+ * to the receiver with a DSS mapping. The receiver reorders the data of all
+ * the subflows in the data sequence space and acknowledges it with the data
+ * ACK of the DSS option; the data ACK frees the send buffer of the
+ * connection.
+ *
+ * The congestion control of the subflows is given by the CongestionControl
+ * attribute; the coupled algorithms (MptcpLia, MptcpOlia, MptcpDctcp) use
+ * the state of all the subflows of the connection.
+ *
+ * Not modeled: the HMAC authentication of MP_JOIN, the 64-bit data sequence
+ * numbers, the DSS checksum, DATA_FIN (the connection is closed when all its
+ * subflows are closed), and the reinjection of the data of a failed subflow
+ * on the others.
+ */
+class MptcpSocket : public TcpSocket
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Path managers
+   */
+  enum PathManager
+  {
+    NDIFFPORTS,     //!< Several subflows between the same addresses
+    FULLMESH        //!< One subflow per pair of addresses
+  };
+
+  MptcpSocket (void);
+  /**
+   * \brief Clone a listening connection for a new connection
+   * \param sock the listening connection
+   */
+  MptcpSocket (const MptcpSocket& sock);
+  virtual ~MptcpSocket (void);
+
+  /**
+   * \brief Set the node of the connection
+   * \param node the node
+   */
+  void SetNode (Ptr<Node> node);
+
+  /**
+   * \brief Set the factory that created the connection
+   * \param factory the factory, or 0 when it is disposed
+   */
+  void SetFactory (Ptr<MptcpSocketFactory> factory);
+
+  /**
+   * \brief Get the subflows of the connection
+   * \return the subflows, in the order they were created
+   */
+  const std::vector<Ptr<MptcpSubflow> > & GetSubflows (void) const;
+
+  /**
+   * \brief Check whether MPTCP was negotiated
+   * \return false before the connection is established, and after a fallback to TCP
+   */
+  bool IsMptcp (void) const;
+
+  /**
+   * \brief Draw a random 64-bit number (keys and nonces)
+   * \return the number
+   */
+  uint64_t GenerateKey (void);
+
+  /**
+   * \brief Get the data ACK to signal to the peer
+   * \return the next data sequence number expected
+   */
+  SequenceNumber32 GetDataAck (void) const;
+
+  /**
+   * \brief Process a data ACK received on a subflow
+   * \param dataAck the data ACK
+   */
+  void ReceivedDataAck (SequenceNumber32 dataAck);
+
+  /**
+   * \brief Process an address advertised by the peer with ADD_ADDR
+   * \param addressId the identifier of the address
+   * \param address the address
+   * \param port the port, or 0 to use the port of the connection
+   */
+  void AddRemoteAddress (uint8_t addressId, Ipv4Address address, uint16_t port);
+
+  /**
+   * \brief Assign a fixed random variable stream number to the random
+   * variables used by this model.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * TracedCallback signature for new subflows.
+   *
+   * \param [in] subflow The new subflow.
+   */
+  typedef void (* SubflowTracedCallback)(Ptr<MptcpSubflow> subflow);
+
+  // Inherited from Socket
+  virtual enum SocketErrno GetErrno (void) const;
+  virtual enum SocketType GetSocketType (void) const;
+  virtual Ptr<Node> GetNode (void) const;
+  virtual int Bind (void);
+  virtual int Bind6 (void);
+  virtual int Bind (const Address &address);
+  virtual int Close (void);
+  virtual int ShutdownSend (void);
+  virtual int ShutdownRecv (void);
+  virtual int Connect (const Address &address);
+  virtual int Listen (void);
+  virtual uint32_t GetTxAvailable (void) const;
+  virtual int Send (Ptr<Packet> p, uint32_t flags);
+  virtual int SendTo (Ptr<Packet> p, uint32_t flags, const Address &toAddress);
+  virtual uint32_t GetRxAvailable (void) const;
+  virtual Ptr<Packet> Recv (uint32_t maxSize, uint32_t flags);
+  virtual Ptr<Packet> RecvFrom (uint32_t maxSize, uint32_t flags,
+                                Address &fromAddress);
+  virtual int GetSockName (Address &address) const;
+  virtual int GetPeerName (Address &address) const;
+  virtual bool SetAllowBroadcast (bool allowBroadcast);
+  virtual bool GetAllowBroadcast (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+  // Inherited from TcpSocket
+  virtual void     SetSndBufSize (uint32_t size);
+  virtual uint32_t GetSndBufSize (void) const;
+  virtual void     SetRcvBufSize (uint32_t size);
+  virtual uint32_t GetRcvBufSize (void) const;
+  virtual void     SetSegSize (uint32_t size);
+  virtual uint32_t GetSegSize (void) const;
+  virtual void     SetInitialSSThresh (uint32_t threshold);
+  virtual uint32_t GetInitialSSThresh (void) const;
+  virtual void     SetInitialCwnd (uint32_t cwnd);
+  virtual uint32_t GetInitialCwnd (void) const;
+  virtual void     SetConnTimeout (Time timeout);
+  virtual Time     GetConnTimeout (void) const;
+  virtual void     SetSynRetries (uint32_t count);
+  virtual uint32_t GetSynRetries (void) const;
+  virtual void     SetDataRetries (uint32_t retries);
+  virtual uint32_t GetDataRetries (void) const;
+  virtual void     SetDelAckTimeout (Time timeout);
+  virtual Time     GetDelAckTimeout (void) const;
+  virtual void     SetDelAckMaxCount (uint32_t count);
+  virtual uint32_t GetDelAckMaxCount (void) const;
+  virtual void     SetTcpNoDelay (bool noDelay);
+  virtual bool     GetTcpNoDelay (void) const;
+  virtual void     SetPersistTimeout (Time timeout);
+  virtual Time     GetPersistTimeout (void) const;
+
+private:
+  /**
+   * \brief Create a subflow with the settings of the connection
+   * \return the subflow
+   */
+  Ptr<MptcpSubflow> CreateSubflow (void);
+
+  /**
+   * \brief Attach a subflow to the connection
+   * \param subflow the subflow
+   */
+  void AttachSubflow (Ptr<MptcpSubflow> subflow);
+
+  /**
+   * \brief Initialize the data sequence spaces from the keys
+   */
+  void InitDataSequences (void);
+
+  /**
+   * \brief Open the subflows requested by the path manager
+   */
+  void OpenSubflows (void);
+
+  /**
+   * \brief Open a subflow joining the connection
+   * \param local the local address
+   * \param addressId the identifier of the local address
+   * \param remote the address of the peer
+   */
+  void OpenSubflow (Ipv4Address local, uint8_t addressId, InetSocketAddress remote);
+
+  /**
+   * \brief Get the IPv4 addresses of the node
+   * \return the address of each up, non-loopback interface
+   */
+  std::vector<Ipv4Address> GetLocalAddresses (void) const;
+
+  /**
+   * \brief Queue pending data on the subflows chosen by the scheduler
+   */
+  void SendPendingData (void);
+
+  /**
+   * \brief Close all the subflows
+   */
+  void CloseSubflows (void);
+
+  /**
+   * \brief Insert received data in the data sequence space
+   * \param p the data
+   * \param dataSeq the data sequence number of the first byte
+   * \return true if in-order data became available to the application
+   */
+  bool AddRxData (Ptr<Packet> p, SequenceNumber32 dataSeq);
+
+  /**
+   * \brief Account for a subflow that is closed
+   * \param subflow the subflow
+   * \param error true if the subflow was closed by an error
+   */
+  void SubflowClosed (Ptr<MptcpSubflow> subflow, bool error);
+
+  // Callbacks of the subflows
+  /**
+   * \brief A subflow completed its handshake
+   * \param socket the subflow
+   */
+  void SubflowConnected (Ptr<Socket> socket);
+  /**
+   * \brief A subflow failed its handshake
+   * \param socket the subflow
+   */
+  void SubflowConnectionFailed (Ptr<Socket> socket);
+  /**
+   * \brief A listening subflow received a SYN
+   * \param socket the listening subflow
+   * \param from the address of the peer
+   * \return true to accept the connection
+   */
+  bool SubflowConnectionRequest (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief A listening subflow accepted a subflow
+   * \param socket the new subflow
+   * \param from the address of the peer
+   */
+  void SubflowAccepted (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief A subflow has data to read
+   * \param socket the subflow
+   */
+  void SubflowRecv (Ptr<Socket> socket);
+  /**
+   * \brief A subflow has room in its send buffer
+   * \param socket the subflow
+   * \param available the room in the send buffer
+   */
+  void SubflowSend (Ptr<Socket> socket, uint32_t available);
+  /**
+   * \brief A subflow was closed normally
+   * \param socket the subflow
+   */
+  void SubflowNormalClose (Ptr<Socket> socket);
+  /**
+   * \brief A subflow was closed by an error
+   * \param socket the subflow
+   */
+  void SubflowErrorClose (Ptr<Socket> socket);
+
+  // Attributes
+  TypeId m_congestionTypeId;            //!< Congestion control of the subflows
+  TypeId m_schedulerTypeId;             //!< Scheduler
+  PathManager m_pathManager;            //!< Path manager
+  uint32_t m_numSubflows;               //!< Number of subflows (NDIFFPORTS) or maximum (FULLMESH)
+
+  // TcpSocket settings, applied to the subflows
+  uint32_t m_sndBufSize;                //!< Send buffer of the connection
+  uint32_t m_rcvBufSize;                //!< Receive buffer of the subflows
+  uint32_t m_segmentSize;               //!< Segment size of the subflows
+  uint32_t m_initialSsThresh;           //!< Initial ssthresh of the subflows
+  uint32_t m_initialCwnd;               //!< Initial cwnd of the subflows, in segments
+  Time m_connTimeout;                   //!< Connection timeout of the subflows
+  uint32_t m_synRetries;                //!< SYN retries of the subflows
+  uint32_t m_dataRetries;               //!< Data retries of the subflows
+  Time m_delAckTimeout;                 //!< Delayed ACK timeout of the subflows
+  uint32_t m_delAckMaxCount;            //!< Delayed ACK count of the subflows
+  bool m_noDelay;                       //!< Nagle's algorithm disabled on the subflows
+  Time m_persistTimeout;                //!< Persist timeout of the subflows
+
+  Ptr<Node> m_node;                     //!< Node of the connection
+  Ptr<MptcpSocketFactory> m_factory;    //!< Factory that created the connection
+  Ptr<MptcpScheduler> m_scheduler;      //!< Scheduler
+  Ptr<UniformRandomVariable> m_rng;     //!< Keys and nonces
+  TcpStates_t m_state;                  //!< State of the connection
+  mutable enum SocketErrno m_errno;     //!< Socket error code
+  bool m_mptcp;                         //!< MPTCP negotiated with the peer
+  bool m_isClient;                      //!< The connection was opened by this side
+  bool m_closeOnEmpty;                  //!< Close the subflows when the data is queued
+  bool m_shutdownSend;                  //!< Send no longer allowed
+  bool m_shutdownRecv;                  //!< Receive no longer allowed
+  bool m_closeNotified;                 //!< Told the application the connection is closed
+  Address m_localAddress;               //!< Address bound by the application
+  InetSocketAddress m_remoteAddress;    //!< Initial address of the peer
+
+  Ptr<MptcpSubflow> m_listener;                 //!< Listening subflow
+  std::vector<Ptr<MptcpSubflow> > m_subflows;   //!< Subflows of the connection
+  std::set<MptcpSubflow *> m_closedSubflows;    //!< Subflows closed
+  uint32_t m_nextSubflowId;                     //!< Identifier of the next subflow
+  std::set<std::pair<uint32_t, uint32_t> > m_paths; //!< (local, remote) addresses with a subflow
+  std::map<uint8_t, InetSocketAddress> m_remoteAddresses; //!< Addresses of the peer, by identifier
+
+  uint64_t m_localKey;                  //!< Local key
+  uint64_t m_remoteKey;                 //!< Key of the peer
+  uint32_t m_remoteToken;               //!< Token of the peer
+
+  SequenceNumber32 m_dataSndUna;        //!< First data byte not acknowledged
+  SequenceNumber32 m_dataSndNxt;        //!< Next data byte to map on a subflow
+  Ptr<Packet> m_txPending;              //!< Data not yet mapped on a subflow
+  SequenceNumber32 m_dataRcvNxt;        //!< Next data byte expected
+  std::map<SequenceNumber32, Ptr<Packet> > m_rxOutOfOrder; //!< Data received out of order
+  std::deque<Ptr<Packet> > m_rxReady;   //!< In-order data not yet read by the application
+  uint32_t m_rxAvailable;               //!< Bytes in m_rxReady
+
+  TracedCallback<Ptr<MptcpSubflow> > m_subflowAdded; //!< Trace of the new subflows
+};
+
+} // namespace ns3
+
+#endif /* MPTCP_SOCKET_H */
@@ -0,0 +1,529 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mptcp-subflow.h"
+#include "mptcp-socket.h"
+#include "mptcp-congestion-ops.h"
+#include "tcp-option-mptcp.h"
+#include "tcp-tx-buffer.h"
+#include "tcp-rx-buffer.h"
+#include "rtt-estimator.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MptcpSubflow");
+
+NS_OBJECT_ENSURE_REGISTERED (MptcpSubflow);
+
+TypeId
+MptcpSubflow::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MptcpSubflow")
+    .SetParent<TcpSocketBase> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<MptcpSubflow> ()
+  ;
+  return tid;
+}
+
+TypeId
+MptcpSubflow::GetInstanceTypeId () const
+{
+  return MptcpSubflow::GetTypeId ();
+}
+
+MptcpSubflow::MptcpSubflow (void)
+  : TcpSocketBase (),
+    m_meta (nullptr),
+    m_subflowId (0),
+    m_mptcpEnabled (false),
+    m_mpCapable (false),
+    m_join (false),
+    m_sendCapableAck (false),
+    m_localKey (0),
+    m_remoteKey (0),
+    m_joinToken (0),
+    m_addressId (0),
+    m_hasPendingMapping (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpSubflow::MptcpSubflow (const MptcpSubflow& sock)
+  : TcpSocketBase (sock),
+    m_meta (sock.m_meta),
+    m_subflowId (0),
+    m_mptcpEnabled (sock.m_mptcpEnabled),
+    m_mpCapable (false),
+    m_join (false),
+    m_sendCapableAck (false),
+    m_localKey (0),
+    m_remoteKey (0),
+    m_joinToken (0),
+    m_addressId (0),
+    m_hasPendingMapping (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MptcpSubflow::~MptcpSubflow (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MptcpSubflow::SetMeta (MptcpSocket *meta)
+{
+  NS_LOG_FUNCTION (this << meta);
+  m_meta = meta;
+  if (meta == nullptr)
+    {
+      Ptr<MptcpCoupling> coupling = m_tcb->GetObject<MptcpCoupling> ();
+      if (coupling != 0)
+        {
+          coupling->SetMeta (nullptr);
+        }
+      return;
+    }
+
+  m_mptcpEnabled = true;
+  // The DSS option describes each segment: segments cannot be merged
+  m_gsoMaxSize = 0;
+  Ptr<MptcpCoupling> coupling = m_tcb->GetObject<MptcpCoupling> ();
+  if (coupling == 0)
+    {
+      coupling = CreateObject<MptcpCoupling> ();
+      m_tcb->AggregateObject (coupling);
+    }
+  coupling->SetMeta (meta);
+}
+
+void
+MptcpSubflow::SetSubflowId (uint32_t id)
+{
+  m_subflowId = id;
+}
+
+uint32_t
+MptcpSubflow::GetSubflowId (void) const
+{
+  return m_subflowId;
+}
+
+void
+MptcpSubflow::SetLocalKey (uint64_t key)
+{
+  NS_LOG_FUNCTION (this << key);
+  m_localKey = key;
+}
+
+void
+MptcpSubflow::SetJoin (uint32_t token, uint8_t addressId)
+{
+  NS_LOG_FUNCTION (this << token << static_cast<uint32_t> (addressId));
+  m_join = true;
+  m_joinToken = token;
+  m_addressId = addressId;
+}
+
+bool
+MptcpSubflow::IsMpCapable (void) const
+{
+  return m_mpCapable;
+}
+
+bool
+MptcpSubflow::IsJoin (void) const
+{
+  return m_join;
+}
+
+uint64_t
+MptcpSubflow::GetLocalKey (void) const
+{
+  return m_localKey;
+}
+
+uint64_t
+MptcpSubflow::GetRemoteKey (void) const
+{
+  return m_remoteKey;
+}
+
+uint32_t
+MptcpSubflow::GetJoinToken (void) const
+{
+  return m_joinToken;
+}
+
+bool
+MptcpSubflow::IsEstablished (void) const
+{
+  return m_state == ESTABLISHED || m_state == CLOSE_WAIT;
+}
+
+Time
+MptcpSubflow::GetSmoothedRtt (void) const
+{
+  return m_rtt->GetEstimate ();
+}
+
+Ptr<TcpSocketState>
+MptcpSubflow::GetSocketState (void) const
+{
+  return m_tcb;
+}
+
+uint32_t
+MptcpSubflow::GetSchedulingWindow (void) const
+{
+  if (!IsEstablished () || m_closeOnEmpty)
+    {
+      return 0;
+    }
+  uint32_t window = std::min (m_tcb->m_cWnd.Get (), GetRWnd ());
+  uint32_t queued = m_txBuffer->Size ();
+  if (queued >= window)
+    {
+      return 0;
+    }
+  return std::min (window - queued, GetTxAvailable ());
+}
+
+int
+MptcpSubflow::SendMapped (Ptr<Packet> p, SequenceNumber32 dataSeq)
+{
+  NS_LOG_FUNCTION (this << p << dataSeq);
+  NS_ASSERT (p->GetSize () <= 0xffff);
+
+  SequenceNumber32 tail = m_txBuffer->TailSequence ();
+  if (m_mpCapable)
+    {
+      Mapping mapping;
+      mapping.dataSeq = dataSeq;
+      mapping.length = static_cast<uint16_t> (p->GetSize ());
+      m_txMappings[tail] = mapping;
+    }
+  int sent = Send (p, 0);
+  if (sent < 0)
+    {
+      m_txMappings.erase (tail);
+    }
+  return sent;
+}
+
+Ptr<Packet>
+MptcpSubflow::RecvMapped (SequenceNumber32 &dataSeq)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t maxSize = GetRxAvailable ();
+  if (maxSize == 0)
+    {
+      return 0;
+    }
+  if (m_mpCapable)
+    {
+      auto it = m_rxMappings.upper_bound (m_rxReadSeq);
+      if (it == m_rxMappings.begin ())
+        {
+          NS_LOG_WARN ("No mapping for subflow sequence " << m_rxReadSeq);
+          return 0;
+        }
+      --it;
+      SequenceNumber32 end = it->first + it->second.length;
+      if (m_rxReadSeq >= end)
+        {
+          NS_LOG_WARN ("No mapping for subflow sequence " << m_rxReadSeq);
+          return 0;
+        }
+      maxSize = std::min<uint32_t> (maxSize, end - m_rxReadSeq);
+      dataSeq = it->second.dataSeq + (m_rxReadSeq - it->first);
+    }
+  else
+    {
+      // Fallback: the subflow carries the whole data stream
+      dataSeq = SequenceNumber32 (m_rxReadSeq - (m_peerIsn + 1));
+    }
+
+  Ptr<Packet> p = Recv (maxSize, 0);
+  if (p == 0 || p->GetSize () == 0)
+    {
+      return 0;
+    }
+  m_rxReadSeq += p->GetSize ();
+  while (!m_rxMappings.empty ()
+         && m_rxMappings.begin ()->first + m_rxMappings.begin ()->second.length <= m_rxReadSeq)
+    {
+      m_rxMappings.erase (m_rxMappings.begin ());
+    }
+  return p;
+}
+
+void
+MptcpSubflow::AdvertiseAddress (uint8_t addressId, Ipv4Address address)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (addressId) << address);
+  Ptr<TcpOptionMptcpAddAddress> option = CreateObject<TcpOptionMptcpAddAddress> ();
+  option->SetAddress (addressId, address);
+  m_addAddresses.push_back (option);
+}
+
+Ptr<TcpSocketBase>
+MptcpSubflow::Fork (void)
+{
+  return CopyObject<MptcpSubflow> (this);
+}
+
+void
+MptcpSubflow::CompleteFork (Ptr<Packet> p, const TcpHeader& tcpHeader,
+                            const Address& fromAddress, const Address& toAddress)
+{
+  NS_LOG_FUNCTION (this << p << tcpHeader << fromAddress << toAddress);
+
+  m_peerIsn = tcpHeader.GetSequenceNumber ();
+  m_rxReadSeq = m_peerIsn + SequenceNumber32 (1);
+  if (m_mptcpEnabled && m_meta != nullptr)
+    {
+      for (const Ptr<const TcpOption> &option : tcpHeader.GetOptionList ())
+        {
+          if (option->GetKind () != TcpOption::MPTCP)
+            {
+              continue;
+            }
+          Ptr<const TcpOptionMptcpCapable> capable = DynamicCast<const TcpOptionMptcpCapable> (option);
+          Ptr<const TcpOptionMptcpJoin> join = DynamicCast<const TcpOptionMptcpJoin> (option);
+          if (capable != 0)
+            {
+              m_mpCapable = true;
+              m_remoteKey = capable->GetSenderKey ();
+              m_localKey = m_meta->GenerateKey ();
+            }
+          else if (join != 0)
+            {
+              m_mpCapable = true;
+              m_join = true;
+              m_joinToken = join->GetToken ();
+            }
+        }
+    }
+  NS_LOG_DEBUG ("Forked subflow " << (m_join ? "joining" : (m_mpCapable ? "MP_CAPABLE" : "fallback")));
+
+  TcpSocketBase::CompleteFork (p, tcpHeader, fromAddress, toAddress);
+}
+
+void
+MptcpSubflow::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
+                           const Address &toAddress)
+{
+  if (m_meta == nullptr || !m_mptcpEnabled || m_state == LISTEN)
+    {
+      TcpSocketBase::DoForwardUp (packet, fromAddress, toAddress);
+      return;
+    }
+
+  TcpHeader tcpHeader;
+  packet->PeekHeader (tcpHeader);
+  uint8_t flags = tcpHeader.GetFlags ();
+
+  Ptr<const TcpOptionMptcpCapable> capable;
+  Ptr<const TcpOptionMptcpDss> dss;
+  bool joinAck = false;
+  std::vector<Ptr<const TcpOptionMptcpAddAddress> > addresses;
+  for (const Ptr<const TcpOption> &option : tcpHeader.GetOptionList ())
+    {
+      if (option->GetKind () != TcpOption::MPTCP)
+        {
+          continue;
+        }
+      switch (DynamicCast<const TcpOptionMptcp> (option)->GetSubType ())
+        {
+        case TcpOptionMptcp::MP_CAPABLE:
+          capable = DynamicCast<const TcpOptionMptcpCapable> (option);
+          break;
+        case TcpOptionMptcp::MP_JOIN:
+          joinAck = true;
+          break;
+        case TcpOptionMptcp::DSS:
+          dss = DynamicCast<const TcpOptionMptcpDss> (option);
+          break;
+        case TcpOptionMptcp::ADD_ADDR:
+          addresses.push_back (DynamicCast<const TcpOptionMptcpAddAddress> (option));
+          break;
+        default:
+          break;
+        }
+    }
+
+  if (m_state == SYN_SENT
+      && (flags & (TcpHeader::SYN | TcpHeader::ACK)) == (TcpHeader::SYN | TcpHeader::ACK))
+    {
+      m_peerIsn = tcpHeader.GetSequenceNumber ();
+      m_rxReadSeq = m_peerIsn + SequenceNumber32 (1);
+      if (m_join)
+        {
+          m_mpCapable = joinAck;
+        }
+      else if (capable != 0)
+        {
+          m_mpCapable = true;
+          m_remoteKey = capable->GetSenderKey ();
+          m_sendCapableAck = true;
+        }
+      else
+        {
+          NS_LOG_INFO ("The peer did not answer MP_CAPABLE, falling back to TCP");
+          m_mpCapable = false;
+        }
+    }
+
+  if (m_mpCapable && dss != 0 && dss->HasMapping ())
+    {
+      Mapping mapping;
+      mapping.dataSeq = dss->GetDataSequence ();
+      mapping.length = dss->GetDataLength ();
+      m_rxMappings[m_peerIsn + SequenceNumber32 (dss->GetSubflowSequence ())] = mapping;
+    }
+
+  // The data ACK and the addresses are handed to the connection once the
+  // segment has been processed by the subflow
+  Ptr<MptcpSubflow> self = this;
+  TcpSocketBase::DoForwardUp (packet, fromAddress, toAddress);
+
+  if (m_meta == nullptr)
+    {
+      return;
+    }
+  if (m_mpCapable)
+    {
+      if (dss != 0 && dss->HasDataAck ())
+        {
+          m_meta->ReceivedDataAck (dss->GetDataAck ());
+        }
+      for (const Ptr<const TcpOptionMptcpAddAddress> &address : addresses)
+        {
+          m_meta->AddRemoteAddress (address->GetAddressId (), address->GetAddress (),
+                                    address->GetPort ());
+        }
+    }
+  else if (m_connected)
+    {
+      // Fallback: the subflow ACKs acknowledge the data stream
+      m_meta->ReceivedDataAck (SequenceNumber32 (m_txBuffer->HeadSequence ()
+                                                 - (m_localIsn + SequenceNumber32 (1))));
+    }
+}
+
+uint32_t
+MptcpSubflow::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool withAck)
+{
+  NS_LOG_FUNCTION (this << seq << maxSize << withAck);
+
+  if (m_mpCapable)
+    {
+      while (!m_txMappings.empty ()
+             && m_txMappings.begin ()->first + m_txMappings.begin ()->second.length
+                <= m_txBuffer->HeadSequence ())
+        {
+          m_txMappings.erase (m_txMappings.begin ());
+        }
+      auto it = m_txMappings.upper_bound (seq);
+      if (it != m_txMappings.begin ())
+        {
+          --it;
+          SequenceNumber32 end = it->first + it->second.length;
+          if (seq < end)
+            {
+              maxSize = std::min<uint32_t> (maxSize, end - seq);
+              m_hasPendingMapping = true;
+              m_pendingSubflowSeq = it->first;
+              m_pendingMapping = it->second;
+            }
+        }
+    }
+
+  uint32_t sz = TcpSocketBase::SendDataPacket (seq, maxSize, withAck);
+  m_hasPendingMapping = false;
+  return sz;
+}
+
+void
+MptcpSubflow::AddOptions (TcpHeader& header)
+{
+  NS_LOG_FUNCTION (this << header);
+
+  TcpSocketBase::AddOptions (header);
+  if (m_meta == nullptr || !m_mptcpEnabled)
+    {
+      return;
+    }
+
+  uint8_t flags = header.GetFlags ();
+  if (flags & TcpHeader::SYN)
+    {
+      m_localIsn = header.GetSequenceNumber ();
+      if (m_join)
+        {
+          Ptr<TcpOptionMptcpJoin> join = CreateObject<TcpOptionMptcpJoin> ();
+          join->SetToken ((flags & TcpHeader::ACK) ? 0 : m_joinToken);
+          join->SetNonce (static_cast<uint32_t> (m_meta->GenerateKey ()));
+          join->SetAddressId (m_addressId);
+          header.AppendOption (join);
+        }
+      else if (!(flags & TcpHeader::ACK) || m_mpCapable)
+        {
+          Ptr<TcpOptionMptcpCapable> capable = CreateObject<TcpOptionMptcpCapable> ();
+          capable->SetSenderKey (m_localKey);
+          header.AppendOption (capable);
+        }
+      return;
+    }
+
+  if (!m_mpCapable)
+    {
+      return;
+    }
+
+  if (m_sendCapableAck && (flags & TcpHeader::ACK))
+    {
+      Ptr<TcpOptionMptcpCapable> capable = CreateObject<TcpOptionMptcpCapable> ();
+      capable->SetSenderKey (m_localKey);
+      capable->SetReceiverKey (m_remoteKey);
+      header.AppendOption (capable);
+      m_sendCapableAck = false;
+    }
+
+  Ptr<TcpOptionMptcpDss> dss = CreateObject<TcpOptionMptcpDss> ();
+  dss->SetDataAck (m_meta->GetDataAck ());
+  if (m_hasPendingMapping)
+    {
+      dss->SetMapping (m_pendingMapping.dataSeq, m_pendingSubflowSeq - m_localIsn,
+                       m_pendingMapping.length);
+    }
+  if (!header.AppendOption (dss))
+    {
+      NS_LOG_WARN ("No room for the DSS option");
+    }
+
+  if (!m_addAddresses.empty () && header.AppendOption (m_addAddresses.front ()))
+    {
+      m_addAddresses.pop_front ();
+    }
+}
+
+} // namespace ns3
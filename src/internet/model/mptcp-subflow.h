@@ -0,0 +1,229 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MPTCP_SUBFLOW_H
+#define MPTCP_SUBFLOW_H
+
+#include "ns3/tcp-socket-base.h"
+#include "ns3/ipv4-address.h"
+#include <map>
+#include <deque>
+
+namespace ns3 {
+
+class MptcpSocket;
+class TcpOptionMptcpAddAddress;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief A subflow of a Multipath TCP connection
+ *
+ * A subflow is a TcpSocketBase, with its own sequence space, congestion
+ * control and loss recovery, that carries part of the data of an
+ * MptcpSocket. On top of the TCP machinery it signals the MPTCP options
+ * (\RFC{6824}): MP_CAPABLE or MP_JOIN on the handshake, and DSS on every
+ * established segment, carrying the data ACK of the connection and the
+ * mapping between the subflow and the data sequence spaces. Segments are
+ * never built across two mappings, so that every segment carries the
+ * mapping of its payload.
+ *
+ * A subflow whose peer does not answer MP_CAPABLE falls back to plain TCP:
+ * no MPTCP option is sent anymore, and the connection uses this subflow
+ * only.
+ *
+ * Subflows are created and owned by MptcpSocket; applications never use
+ * them directly.
+ */
+class MptcpSubflow : public TcpSocketBase
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId () const;
+
+  MptcpSubflow (void);
+  /**
+   * \brief Clone a subflow, as done by a listening subflow receiving a SYN
+   * \param sock the subflow to clone
+   */
+  MptcpSubflow (const MptcpSubflow& sock);
+  virtual ~MptcpSubflow (void);
+
+  /**
+   * \brief Attach the subflow to a connection
+   *
+   * Also couples the congestion control of the subflow with the other
+   * subflows of the connection.
+   *
+   * \param meta the connection, or nullptr to detach the subflow
+   */
+  void SetMeta (MptcpSocket *meta);
+
+  /**
+   * \brief Set the identifier of the subflow within its connection
+   * \param id the identifier
+   */
+  void SetSubflowId (uint32_t id);
+
+  /**
+   * \brief Get the identifier of the subflow within its connection
+   * \return the identifier
+   */
+  uint32_t GetSubflowId (void) const;
+
+  /**
+   * \brief Set the key sent in MP_CAPABLE (first subflow of a client)
+   * \param key the local key
+   */
+  void SetLocalKey (uint64_t key);
+
+  /**
+   * \brief Make the subflow join an existing connection
+   * \param token the token of the peer
+   * \param addressId the identifier of the local address of the subflow
+   */
+  void SetJoin (uint32_t token, uint8_t addressId);
+
+  /**
+   * \brief Check whether the handshake negotiated MPTCP
+   * \return true if MP_CAPABLE or MP_JOIN was accepted by the peer
+   */
+  bool IsMpCapable (void) const;
+
+  /**
+   * \brief Check whether the subflow joined an existing connection
+   * \return true for a subflow opened with MP_JOIN
+   */
+  bool IsJoin (void) const;
+
+  /**
+   * \brief Get the local key exchanged in MP_CAPABLE
+   * \return the local key
+   */
+  uint64_t GetLocalKey (void) const;
+
+  /**
+   * \brief Get the key of the peer exchanged in MP_CAPABLE
+   * \return the key of the peer
+   */
+  uint64_t GetRemoteKey (void) const;
+
+  /**
+   * \brief Get the token carried by the received MP_JOIN
+   * \return the token
+   */
+  uint32_t GetJoinToken (void) const;
+
+  /**
+   * \brief Check whether the subflow can carry data
+   * \return true in the ESTABLISHED and CLOSE_WAIT states
+   */
+  bool IsEstablished (void) const;
+
+  /**
+   * \brief Get the smoothed RTT of the subflow
+   * \return the RTT estimate
+   */
+  Time GetSmoothedRtt (void) const;
+
+  /**
+   * \brief Get the congestion control state of the subflow
+   * \return the TcpSocketState
+   */
+  Ptr<TcpSocketState> GetSocketState (void) const;
+
+  /**
+   * \brief Get the room left in the congestion and receive windows
+   *
+   * The data already queued in the subflow, sent or not, counts against
+   * the window, so that the scheduler never queues more than the subflow
+   * can send in the current round trip.
+   *
+   * \return the bytes the subflow can accept now
+   */
+  uint32_t GetSchedulingWindow (void) const;
+
+  /**
+   * \brief Queue data of the connection on the subflow
+   * \param p the data
+   * \param dataSeq the data sequence number of the first byte
+   * \return the number of bytes queued, or -1 on error
+   */
+  int SendMapped (Ptr<Packet> p, SequenceNumber32 dataSeq);
+
+  /**
+   * \brief Read in-order data from the subflow, up to the end of a mapping
+   * \param dataSeq set to the data sequence number of the first byte read
+   * \return the data, or 0 if nothing can be read
+   */
+  Ptr<Packet> RecvMapped (SequenceNumber32 &dataSeq);
+
+  /**
+   * \brief Advertise a local address to the peer with ADD_ADDR
+   * \param addressId the identifier of the address
+   * \param address the address
+   */
+  void AdvertiseAddress (uint8_t addressId, Ipv4Address address);
+
+protected:
+  virtual Ptr<TcpSocketBase> Fork (void);
+  virtual void CompleteFork (Ptr<Packet> p, const TcpHeader& tcpHeader,
+                             const Address& fromAddress, const Address& toAddress);
+  virtual void DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
+                            const Address &toAddress);
+  virtual uint32_t SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool withAck);
+  virtual void AddOptions (TcpHeader& tcpHeader);
+
+private:
+  /**
+   * \brief A mapping of subflow sequence numbers onto the data sequence space
+   */
+  struct Mapping
+  {
+    SequenceNumber32 dataSeq;  //!< Data sequence number of the first byte
+    uint16_t length;           //!< Length of the mapping
+  };
+
+  MptcpSocket *m_meta;            //!< Connection (owns the subflow)
+  uint32_t m_subflowId;           //!< Identifier within the connection
+  bool m_mptcpEnabled;            //!< MPTCP options are sent on the handshake
+  bool m_mpCapable;               //!< The peer accepted MPTCP on this subflow
+  bool m_join;                    //!< The subflow joins an existing connection
+  bool m_sendCapableAck;          //!< MP_CAPABLE still to be echoed on the third ACK
+  uint64_t m_localKey;            //!< Local key (MP_CAPABLE)
+  uint64_t m_remoteKey;           //!< Key of the peer (MP_CAPABLE)
+  uint32_t m_joinToken;           //!< Token of the connection to join (MP_JOIN)
+  uint8_t m_addressId;            //!< Identifier of the local address (MP_JOIN)
+  SequenceNumber32 m_localIsn;    //!< Initial sequence number of the subflow
+  SequenceNumber32 m_peerIsn;     //!< Initial sequence number of the peer
+  SequenceNumber32 m_rxReadSeq;   //!< Subflow sequence number of the next byte to read
+
+  std::map<SequenceNumber32, Mapping> m_txMappings;  //!< Mappings of the queued data
+  std::map<SequenceNumber32, Mapping> m_rxMappings;  //!< Mappings of the received data
+  bool m_hasPendingMapping;         //!< A segment is being built inside a mapping
+  SequenceNumber32 m_pendingSubflowSeq;  //!< Start of the mapping of the segment being built
+  Mapping m_pendingMapping;              //!< Mapping of the segment being built
+  std::deque<Ptr<TcpOptionMptcpAddAddress> > m_addAddresses; //!< ADD_ADDR still to send
+};
+
+} // namespace ns3
+
+#endif /* MPTCP_SUBFLOW_H */
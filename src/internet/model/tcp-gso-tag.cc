@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-gso-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (TcpGsoTag);
+
+TcpGsoTag::TcpGsoTag ()
+  : m_segmentSize (0)
+{
+}
+
+void
+TcpGsoTag::SetSegmentSize (uint16_t segmentSize)
+{
+  m_segmentSize = segmentSize;
+}
+
+uint16_t
+TcpGsoTag::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+TypeId
+TcpGsoTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpGsoTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpGsoTag> ()
+    ;
+  return tid;
+}
+
+TypeId
+TcpGsoTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+TcpGsoTag::GetSerializedSize (void) const
+{
+  return sizeof (uint16_t);
+}
+
+void
+TcpGsoTag::Serialize (TagBuffer i) const
+{
+  i.WriteU16 (m_segmentSize);
+}
+
+void
+TcpGsoTag::Deserialize (TagBuffer i)
+{
+  m_segmentSize = i.ReadU16 ();
+}
+
+void
+TcpGsoTag::Print (std::ostream &os) const
+{
+  os << "GSO segment size = " << m_segmentSize;
+}
+
+} // namespace ns3
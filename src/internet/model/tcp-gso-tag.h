@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_GSO_TAG_H
+#define TCP_GSO_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Marks a TCP super-segment built by generic segmentation offload
+ *
+ * A TcpSocketBase with GSO enabled may hand to the IP layer a single packet
+ * carrying several consecutive segments behind one TCP header. The packet
+ * carries this tag, which records the size of the wire segments the packet
+ * has to be split into. The split is performed by the traffic control
+ * layer (see QueueDiscItem::Segment), i.e., right before the first point
+ * where per-packet behavior (queue disc or netdevice) matters.
+ */
+class TcpGsoTag : public Tag
+{
+public:
+  TcpGsoTag ();
+
+  /**
+   * \brief Set the size of the payload of the wire segments
+   *
+   * \param segmentSize the segment size (bytes)
+   */
+  void SetSegmentSize (uint16_t segmentSize);
+
+  /**
+   * \brief Get the size of the payload of the wire segments
+   *
+   * \returns the segment size (bytes)
+   */
+  uint16_t GetSegmentSize (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  // inherited function, no need to doc.
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  // inherited function, no need to doc.
+  virtual uint32_t GetSerializedSize (void) const;
+
+  // inherited function, no need to doc.
+  virtual void Serialize (TagBuffer i) const;
+
+  // inherited function, no need to doc.
+  virtual void Deserialize (TagBuffer i);
+
+  // inherited function, no need to doc.
+  virtual void Print (std::ostream &os) const;
+private:
+  uint16_t m_segmentSize;  //!< the payload size of each wire segment
+};
+
+} // namespace ns3
+
+#endif /* TCP_GSO_TAG_H */
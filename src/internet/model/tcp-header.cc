@@ -22,6 +22,7 @@
 #include <iostream>
 #include "tcp-header.h"
 #include "tcp-option.h"
+#include "tcp-option-mptcp.h"
 #include "ns3/buffer.h"
 #include "ns3/address-utils.h"
 #include "ns3/log.h"
@@ -385,7 +386,19 @@ TcpHeader::Deserialize (Buffer::Iterator start)
       uint8_t kind = i.PeekU8 ();
       Ptr<TcpOption> op;
       uint32_t optionSize;
-      if (TcpOption::IsKindKnown (kind))
+      if (kind == TcpOption::MPTCP && optionLen >= 3)
+        {
+          // All the MPTCP signals share one kind; the subtype follows the length
+          Buffer::Iterator j = i;
+          j.Next (2);
+          op = TcpOptionMptcp::CreateMptcpOption (j.PeekU8 () >> 4);
+        }
+      else if (kind == TcpOption::MPTCP)
+        {
+          op = TcpOption::CreateOption (TcpOption::UNKNOWN);
+          NS_LOG_WARN ("MPTCP option without subtype, skipping.");
+        }
+      else if (TcpOption::IsKindKnown (kind))
         {
           op = TcpOption::CreateOption (kind);
         }
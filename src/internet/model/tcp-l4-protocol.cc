@@ -22,6 +22,8 @@
 #include "ns3/log.h"
 #include "ns3/nstime.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
 #include "ns3/object-vector.h"
 
 #include "ns3/packet.h"
@@ -40,10 +42,12 @@
 #include "ipv6-l3-protocol.h"
 #include "ipv6-routing-protocol.h"
 #include "tcp-socket-factory-impl.h"
+#include "mptcp-socket-factory.h"
 #include "tcp-socket-base.h"
 #include "tcp-congestion-ops.h"
 #include "tcp-recovery-ops.h"
 #include "tcp-prr-recovery.h"
+#include "tcp-option-ts.h"
 #include "rtt-estimator.h"
 
 #include <vector>
@@ -91,12 +95,32 @@ TcpL4Protocol::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TcpL4Protocol::m_sockets),
                    MakeObjectVectorChecker<TcpSocketBase> ())
+    .AddAttribute ("GroTimeout",
+                   "Batch window of generic receive offload: in-order IPv4 "
+                   "data segments of a flow received within this time from "
+                   "the first one are merged before TCP processing. "
+                   "A zero value disables GRO.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TcpL4Protocol::m_groTimeout),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("GroMaxSize",
+                   "Maximum size (bytes) of a packet merged by generic receive offload",
+                   UintegerValue (65535),
+                   MakeUintegerAccessor (&TcpL4Protocol::m_groMaxSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("GroFlush",
+                     "A packet merged by generic receive offload is handed to "
+                     "TCP, along with the number of segments it was merged from",
+                     MakeTraceSourceAccessor (&TcpL4Protocol::m_groFlushTrace),
+                     "ns3::TcpL4Protocol::GroFlushTracedCallback")
   ;
   return tid;
 }
 
 TcpL4Protocol::TcpL4Protocol ()
-  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ())
+  : m_endPoints (new Ipv4EndPointDemux ()),
+    m_endPoints6 (new Ipv6EndPointDemux ()),
+    m_groMaxSize (65535)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -129,6 +153,9 @@ TcpL4Protocol::NotifyNewAggregate ()
           Ptr<TcpSocketFactoryImpl> tcpFactory = CreateObject<TcpSocketFactoryImpl> ();
           tcpFactory->SetTcp (this);
           node->AggregateObject (tcpFactory);
+          Ptr<MptcpSocketFactory> mptcpFactory = CreateObject<MptcpSocketFactory> ();
+          mptcpFactory->SetTcp (this);
+          node->AggregateObject (mptcpFactory);
         }
     }
 
@@ -174,6 +201,12 @@ TcpL4Protocol::DoDispose (void)
       m_endPoints6 = 0;
     }
 
+  for (auto &flow : m_groFlows)
+    {
+      flow.second.m_flushEvent.Cancel ();
+    }
+  m_groFlows.clear ();
+
   m_node = 0;
   m_downTarget.Nullify ();
   m_downTarget6.Nullify ();
@@ -189,16 +222,25 @@ TcpL4Protocol::CreateSocket (TypeId congestionTypeId)
 Ptr<Socket>
 TcpL4Protocol::CreateSocket (TypeId congestionTypeId, TypeId recoveryTypeId)
 {
-  NS_LOG_FUNCTION (this << congestionTypeId.GetName ());
+  return CreateSocket (congestionTypeId, recoveryTypeId, TcpSocketBase::GetTypeId ());
+}
+
+Ptr<Socket>
+TcpL4Protocol::CreateSocket (TypeId congestionTypeId, TypeId recoveryTypeId,
+                             TypeId socketTypeId)
+{
+  NS_LOG_FUNCTION (this << congestionTypeId.GetName () << socketTypeId.GetName ());
   ObjectFactory rttFactory;
   ObjectFactory congestionAlgorithmFactory;
   ObjectFactory recoveryAlgorithmFactory;
+  ObjectFactory socketFactory;
   rttFactory.SetTypeId (m_rttTypeId);
   congestionAlgorithmFactory.SetTypeId (congestionTypeId);
   recoveryAlgorithmFactory.SetTypeId (recoveryTypeId);
+  socketFactory.SetTypeId (socketTypeId);
 
   Ptr<RttEstimator> rtt = rttFactory.Create<RttEstimator> ();
-  Ptr<TcpSocketBase> socket = CreateObject<TcpSocketBase> ();
+  Ptr<TcpSocketBase> socket = socketFactory.Create<TcpSocketBase> ();
   Ptr<TcpCongestionOps> algo = congestionAlgorithmFactory.Create<TcpCongestionOps> ();
   Ptr<TcpRecoveryOps> recovery = recoveryAlgorithmFactory.Create<TcpRecoveryOps> ();
 
@@ -449,6 +491,21 @@ TcpL4Protocol::Receive (Ptr<Packet> packet,
       return checksumControl;
     }
 
+  if (m_groTimeout.IsStrictlyPositive ())
+    {
+      return GroReceive (packet, incomingTcpHeader, incomingIpHeader, incomingInterface);
+    }
+
+  return DeliverV4 (packet, incomingTcpHeader, incomingIpHeader, incomingInterface);
+}
+
+enum IpL4Protocol::RxStatus
+TcpL4Protocol::DeliverV4 (Ptr<Packet> packet, const TcpHeader &incomingTcpHeader,
+                          const Ipv4Header &incomingIpHeader,
+                          Ptr<Ipv4Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << packet << incomingTcpHeader << incomingIpHeader << incomingInterface);
+
   Ipv4EndPointDemux::EndPoints endPoints;
   endPoints = m_endPoints->Lookup (incomingIpHeader.GetDestination (),
                                    incomingTcpHeader.GetDestinationPort (),
@@ -497,6 +554,127 @@ TcpL4Protocol::Receive (Ptr<Packet> packet,
   return IpL4Protocol::RX_OK;
 }
 
+bool
+TcpL4Protocol::GroHeadersMatch (const TcpHeader &a, const TcpHeader &b)
+{
+  if (a.GetFlags () != b.GetFlags ()
+      || a.GetAckNumber () != b.GetAckNumber ()
+      || a.GetWindowSize () != b.GetWindowSize ()
+      || a.GetUrgentPointer () != b.GetUrgentPointer ()
+      || a.GetOptionList ().size () != b.GetOptionList ().size ())
+    {
+      return false;
+    }
+
+  // Only the timestamp option (and padding) may be present, and it must be
+  // the same in both headers
+  TcpHeader::TcpOptionList::const_iterator itA = a.GetOptionList ().begin ();
+  TcpHeader::TcpOptionList::const_iterator itB = b.GetOptionList ().begin ();
+  for (; itA != a.GetOptionList ().end (); ++itA, ++itB)
+    {
+      uint8_t kind = (*itA)->GetKind ();
+      if (kind != (*itB)->GetKind ())
+        {
+          return false;
+        }
+      if (kind == TcpOption::TS)
+        {
+          Ptr<const TcpOptionTS> tsA = DynamicCast<const TcpOptionTS> (*itA);
+          Ptr<const TcpOptionTS> tsB = DynamicCast<const TcpOptionTS> (*itB);
+          if (tsA->GetTimestamp () != tsB->GetTimestamp () || tsA->GetEcho () != tsB->GetEcho ())
+            {
+              return false;
+            }
+        }
+      else if (kind != TcpOption::END && kind != TcpOption::NOP)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+enum IpL4Protocol::RxStatus
+TcpL4Protocol::GroReceive (Ptr<Packet> packet, const TcpHeader &incomingTcpHeader,
+                           const Ipv4Header &incomingIpHeader,
+                           Ptr<Ipv4Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << packet << incomingTcpHeader << incomingIpHeader << incomingInterface);
+
+  GroFlowKey key (incomingIpHeader.GetSource (), incomingIpHeader.GetDestination (),
+                  incomingTcpHeader.GetSourcePort (), incomingTcpHeader.GetDestinationPort ());
+  uint32_t payloadSize = packet->GetSize () - incomingTcpHeader.GetSerializedSize ();
+
+  // Only pure data segments are merged; anything carrying control
+  // information (SYN, FIN, RST, PSH, URG, ECE, CWR) goes up on its own
+  bool mergeable = payloadSize > 0 && incomingTcpHeader.GetFlags () == TcpHeader::ACK;
+
+  auto it = m_groFlows.find (key);
+  if (it != m_groFlows.end ())
+    {
+      GroFlow &flow = it->second;
+      if (mergeable
+          && incomingTcpHeader.GetSequenceNumber () == flow.m_nextSeq
+          && incomingIpHeader.GetEcn () == flow.m_ipHeader.GetEcn ()
+          && flow.m_packet->GetSize () + payloadSize <= m_groMaxSize
+          && GroHeadersMatch (flow.m_tcpHeader, incomingTcpHeader))
+        {
+          Ptr<Packet> payload = packet->Copy ();
+          TcpHeader tcpHeader;
+          payload->RemoveHeader (tcpHeader);
+          flow.m_packet->AddAtEnd (payload);
+          flow.m_nextSeq += payloadSize;
+          flow.m_segments++;
+          NS_LOG_LOGIC ("GRO merged seq " << incomingTcpHeader.GetSequenceNumber () <<
+                        ", " << flow.m_segments << " segments held");
+          return IpL4Protocol::RX_OK;
+        }
+      // The segment cannot extend the held packet: deliver the latter first
+      // so that TCP sees the segments in their arrival order
+      GroFlush (key);
+    }
+
+  // A segment is only held if a socket will receive it: the others are
+  // delivered at once, so that they get the usual ICMP/RST handling
+  if (!mergeable
+      || m_endPoints->Lookup (incomingIpHeader.GetDestination (),
+                              incomingTcpHeader.GetDestinationPort (),
+                              incomingIpHeader.GetSource (),
+                              incomingTcpHeader.GetSourcePort (),
+                              incomingInterface).empty ())
+    {
+      return DeliverV4 (packet, incomingTcpHeader, incomingIpHeader, incomingInterface);
+    }
+
+  GroFlow &flow = m_groFlows[key];
+  flow.m_packet = packet->Copy ();
+  flow.m_tcpHeader = incomingTcpHeader;
+  flow.m_ipHeader = incomingIpHeader;
+  flow.m_interface = incomingInterface;
+  flow.m_nextSeq = incomingTcpHeader.GetSequenceNumber () + payloadSize;
+  flow.m_segments = 1;
+  flow.m_flushEvent = Simulator::Schedule (m_groTimeout, &TcpL4Protocol::GroFlush, this, key);
+  return IpL4Protocol::RX_OK;
+}
+
+void
+TcpL4Protocol::GroFlush (GroFlowKey key)
+{
+  NS_LOG_FUNCTION (this);
+
+  auto it = m_groFlows.find (key);
+  NS_ASSERT (it != m_groFlows.end ());
+  GroFlow flow = it->second;
+  flow.m_flushEvent.Cancel ();
+  m_groFlows.erase (it);
+
+  NS_LOG_LOGIC ("GRO delivers seq " << flow.m_tcpHeader.GetSequenceNumber () <<
+                " merged from " << flow.m_segments << " segments");
+  flow.m_ipHeader.SetPayloadSize (flow.m_packet->GetSize ());
+  m_groFlushTrace (flow.m_packet, flow.m_segments);
+  DeliverV4 (flow.m_packet, flow.m_tcpHeader, flow.m_ipHeader, flow.m_interface);
+}
+
 enum IpL4Protocol::RxStatus
 TcpL4Protocol::Receive (Ptr<Packet> packet,
                         Ipv6Header const &incomingIpHeader,
@@ -22,18 +22,24 @@
 #define TCP_L4_PROTOCOL_H
 
 #include <stdint.h>
+#include <map>
+#include <tuple>
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/sequence-number.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-callback.h"
 #include "ip-l4-protocol.h"
+#include "ipv4-header.h"
+#include "tcp-header.h"
 
 
 namespace ns3 {
 
 class Node;
 class Socket;
-class TcpHeader;
 class Ipv4EndPointDemux;
 class Ipv6EndPointDemux;
 class Ipv4Interface;
@@ -89,6 +95,14 @@ public:
   TcpL4Protocol ();
   virtual ~TcpL4Protocol ();
 
+  /**
+   * TracedCallback signature for packets delivered by generic receive offload.
+   *
+   * \param [in] packet The merged packet, TCP header included.
+   * \param [in] segments The number of segments the packet was merged from.
+   */
+  typedef void (* GroFlushTracedCallback)(Ptr<const Packet> packet, uint32_t segments);
+
   /**
    * Set node associated with this stack
    * \param node the node
@@ -118,6 +132,21 @@ public:
    */
   Ptr<Socket> CreateSocket (TypeId congestionTypeId, TypeId recoveryTypeId);
 
+  /**
+   * \brief Create a TCP socket of a subclass of TcpSocketBase
+   *
+   * Used by protocols layered on top of TCP (e.g., the subflows of
+   * MptcpSocket) to obtain sockets that are initialized and demultiplexed
+   * like the native ones.
+   *
+   * \param congestionTypeId the congestion control algorithm TypeId
+   * \param recoveryTypeId the recovery algorithm TypeId
+   * \param socketTypeId the TypeId of the socket, a subclass of TcpSocketBase
+   * \return A smart Socket pointer to the socket
+   */
+  Ptr<Socket> CreateSocket (TypeId congestionTypeId, TypeId recoveryTypeId,
+                            TypeId socketTypeId);
+
   /**
     * \brief Create a TCP socket using the specified congestion control algorithm
     * \return A smart Socket pointer to a TcpSocket allocated by this instance
@@ -314,6 +343,73 @@ protected:
                          const Address &incomingDAddr);
 
 private:
+  /**
+   * \brief Hand an IPv4 segment to the endpoint it belongs to
+   *
+   * \param packet the segment, TCP header included
+   * \param incomingTcpHeader the TCP header of the segment
+   * \param incomingIpHeader the IPv4 header of the segment
+   * \param incomingInterface the interface the segment was received on
+   * \return the receive status
+   */
+  enum IpL4Protocol::RxStatus
+  DeliverV4 (Ptr<Packet> packet, const TcpHeader &incomingTcpHeader,
+             const Ipv4Header &incomingIpHeader, Ptr<Ipv4Interface> incomingInterface);
+
+  /**
+   * \brief Generic receive offload for an IPv4 segment
+   *
+   * In-order data segments of the same flow that arrive within GroTimeout
+   * of the first one are merged into a single packet before being handed to
+   * the socket. Segments are merged only if their TCP headers differ in the
+   * sequence number only and they carry the same ECN codepoint, so that
+   * CE marks are preserved. Any other segment flushes the packet held for
+   * its flow and is delivered immediately, as is a segment that matches no
+   * IPv4 endpoint.
+   *
+   * \param packet the segment, TCP header included
+   * \param incomingTcpHeader the TCP header of the segment
+   * \param incomingIpHeader the IPv4 header of the segment
+   * \param incomingInterface the interface the segment was received on
+   * \return the receive status
+   */
+  enum IpL4Protocol::RxStatus
+  GroReceive (Ptr<Packet> packet, const TcpHeader &incomingTcpHeader,
+              const Ipv4Header &incomingIpHeader, Ptr<Ipv4Interface> incomingInterface);
+
+  /**
+   * \brief Check whether two TCP headers only differ in the sequence number
+   *
+   * \param a the first header
+   * \param b the second header
+   * \return true if the segments carrying the headers can be merged
+   */
+  static bool GroHeadersMatch (const TcpHeader &a, const TcpHeader &b);
+
+  /// Key of a GRO flow: source and destination addresses and ports
+  typedef std::tuple<Ipv4Address, Ipv4Address, uint16_t, uint16_t> GroFlowKey;
+
+  /**
+   * \brief Deliver the packet held for a GRO flow
+   *
+   * \param key the flow
+   */
+  void GroFlush (GroFlowKey key);
+
+  /**
+   * \brief Segments of a flow held by GRO
+   */
+  struct GroFlow
+  {
+    Ptr<Packet> m_packet;          //!< merged packet, TCP header of the first segment included
+    TcpHeader m_tcpHeader;         //!< TCP header of the first segment
+    Ipv4Header m_ipHeader;         //!< IPv4 header of the first segment
+    Ptr<Ipv4Interface> m_interface; //!< incoming interface
+    SequenceNumber32 m_nextSeq;    //!< sequence number of the next in-order segment
+    uint32_t m_segments;           //!< number of segments merged
+    EventId m_flushEvent;          //!< event delivering the merged packet
+  };
+
   Ptr<Node> m_node;                //!< the node this stack is associated with
   Ipv4EndPointDemux *m_endPoints;  //!< A list of IPv4 end points.
   Ipv6EndPointDemux *m_endPoints6; //!< A list of IPv6 end points.
@@ -323,6 +419,15 @@ private:
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
+  Time m_groTimeout;                               //!< GRO batch window (zero disables GRO)
+  uint32_t m_groMaxSize;                           //!< Max size of a packet merged by GRO
+  std::map<GroFlowKey, GroFlow> m_groFlows;        //!< Flows with segments held by GRO
+
+  /**
+   * \brief Trace of the packets delivered by GRO, with the number of
+   * segments they were merged from
+   */
+  TracedCallback<Ptr<const Packet>, uint32_t> m_groFlushTrace;
 
   /**
    * \brief Copy constructor
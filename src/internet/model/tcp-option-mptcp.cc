@@ -0,0 +1,633 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-option-mptcp.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpOptionMptcp");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpOptionMptcp);
+
+TcpOptionMptcp::TcpOptionMptcp ()
+  : TcpOption ()
+{
+}
+
+TcpOptionMptcp::~TcpOptionMptcp ()
+{
+}
+
+TypeId
+TcpOptionMptcp::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpOptionMptcp")
+    .SetParent<TcpOption> ()
+    .SetGroupName ("Internet")
+  ;
+  return tid;
+}
+
+uint8_t
+TcpOptionMptcp::GetKind (void) const
+{
+  return TcpOption::MPTCP;
+}
+
+Ptr<TcpOption>
+TcpOptionMptcp::CreateMptcpOption (uint8_t subType)
+{
+  switch (subType)
+    {
+    case MP_CAPABLE:
+      return CreateObject<TcpOptionMptcpCapable> ();
+    case MP_JOIN:
+      return CreateObject<TcpOptionMptcpJoin> ();
+    case DSS:
+      return CreateObject<TcpOptionMptcpDss> ();
+    case ADD_ADDR:
+      return CreateObject<TcpOptionMptcpAddAddress> ();
+    default:
+      NS_LOG_WARN ("MPTCP option subtype " << static_cast<int> (subType) << " unknown, skipping.");
+      return CreateObject<TcpOptionUnknown> ();
+    }
+}
+
+uint8_t
+TcpOptionMptcp::ReadHeader (Buffer::Iterator &i, const uint8_t *length, uint8_t nLength,
+                            uint8_t &subTypeByte) const
+{
+  uint8_t readKind = i.ReadU8 ();
+  if (readKind != GetKind ())
+    {
+      NS_LOG_WARN ("Malformed MPTCP option");
+      return 0;
+    }
+
+  uint8_t size = i.ReadU8 ();
+  subTypeByte = i.ReadU8 ();
+  if ((subTypeByte >> 4) != GetSubType ())
+    {
+      NS_LOG_WARN ("Malformed MPTCP option: wrong subtype");
+      return 0;
+    }
+
+  for (uint8_t l = 0; l < nLength; ++l)
+    {
+      if (length[l] == size)
+        {
+          return size;
+        }
+    }
+
+  NS_LOG_WARN ("Malformed MPTCP option: wrong length " << static_cast<int> (size));
+  return 0;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (TcpOptionMptcpCapable);
+
+TcpOptionMptcpCapable::TcpOptionMptcpCapable ()
+  : TcpOptionMptcp (),
+    m_senderKey (0),
+    m_receiverKey (0),
+    m_hasReceiverKey (false)
+{
+}
+
+TcpOptionMptcpCapable::~TcpOptionMptcpCapable ()
+{
+}
+
+TypeId
+TcpOptionMptcpCapable::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpOptionMptcpCapable")
+    .SetParent<TcpOptionMptcp> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpOptionMptcpCapable> ()
+  ;
+  return tid;
+}
+
+TypeId
+TcpOptionMptcpCapable::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+TcpOptionMptcpCapable::Print (std::ostream &os) const
+{
+  os << "MP_CAPABLE " << m_senderKey;
+  if (m_hasReceiverKey)
+    {
+      os << ";" << m_receiverKey;
+    }
+}
+
+uint32_t
+TcpOptionMptcpCapable::GetSerializedSize (void) const
+{
+  return m_hasReceiverKey ? 20 : 12;
+}
+
+uint8_t
+TcpOptionMptcpCapable::GetSubType (void) const
+{
+  return MP_CAPABLE;
+}
+
+void
+TcpOptionMptcpCapable::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteU8 (GetKind ());
+  i.WriteU8 (static_cast<uint8_t> (GetSerializedSize ()));
+  i.WriteU8 (GetSubType () << 4); // Version 0
+  i.WriteU8 (0x01); // HMAC-SHA1, no DSS checksum
+  i.WriteHtonU64 (m_senderKey);
+  if (m_hasReceiverKey)
+    {
+      i.WriteHtonU64 (m_receiverKey);
+    }
+}
+
+uint32_t
+TcpOptionMptcpCapable::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  static const uint8_t lengths[] = { 12, 20 };
+  uint8_t subTypeByte;
+  uint8_t size = ReadHeader (i, lengths, 2, subTypeByte);
+  if (size == 0)
+    {
+      return 0;
+    }
+  i.ReadU8 (); // Flags
+  m_senderKey = i.ReadNtohU64 ();
+  m_hasReceiverKey = (size == 20);
+  if (m_hasReceiverKey)
+    {
+      m_receiverKey = i.ReadNtohU64 ();
+    }
+  return GetSerializedSize ();
+}
+
+void
+TcpOptionMptcpCapable::SetSenderKey (uint64_t key)
+{
+  m_senderKey = key;
+}
+
+uint64_t
+TcpOptionMptcpCapable::GetSenderKey (void) const
+{
+  return m_senderKey;
+}
+
+void
+TcpOptionMptcpCapable::SetReceiverKey (uint64_t key)
+{
+  m_receiverKey = key;
+  m_hasReceiverKey = true;
+}
+
+uint64_t
+TcpOptionMptcpCapable::GetReceiverKey (void) const
+{
+  return m_receiverKey;
+}
+
+bool
+TcpOptionMptcpCapable::HasReceiverKey (void) const
+{
+  return m_hasReceiverKey;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (TcpOptionMptcpJoin);
+
+TcpOptionMptcpJoin::TcpOptionMptcpJoin ()
+  : TcpOptionMptcp (),
+    m_token (0),
+    m_nonce (0),
+    m_addressId (0),
+    m_backup (false)
+{
+}
+
+TcpOptionMptcpJoin::~TcpOptionMptcpJoin ()
+{
+}
+
+TypeId
+TcpOptionMptcpJoin::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpOptionMptcpJoin")
+    .SetParent<TcpOptionMptcp> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpOptionMptcpJoin> ()
+  ;
+  return tid;
+}
+
+TypeId
+TcpOptionMptcpJoin::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+TcpOptionMptcpJoin::Print (std::ostream &os) const
+{
+  os << "MP_JOIN token " << m_token << " id " << static_cast<uint32_t> (m_addressId);
+}
+
+uint32_t
+TcpOptionMptcpJoin::GetSerializedSize (void) const
+{
+  return 12;
+}
+
+uint8_t
+TcpOptionMptcpJoin::GetSubType (void) const
+{
+  return MP_JOIN;
+}
+
+void
+TcpOptionMptcpJoin::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteU8 (GetKind ());
+  i.WriteU8 (12);
+  i.WriteU8 ((GetSubType () << 4) | (m_backup ? 0x01 : 0x00));
+  i.WriteU8 (m_addressId);
+  i.WriteHtonU32 (m_token);
+  i.WriteHtonU32 (m_nonce);
+}
+
+uint32_t
+TcpOptionMptcpJoin::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  static const uint8_t lengths[] = { 12 };
+  uint8_t subTypeByte;
+  if (ReadHeader (i, lengths, 1, subTypeByte) == 0)
+    {
+      return 0;
+    }
+  m_backup = (subTypeByte & 0x01);
+  m_addressId = i.ReadU8 ();
+  m_token = i.ReadNtohU32 ();
+  m_nonce = i.ReadNtohU32 ();
+  return GetSerializedSize ();
+}
+
+void
+TcpOptionMptcpJoin::SetToken (uint32_t token)
+{
+  m_token = token;
+}
+
+uint32_t
+TcpOptionMptcpJoin::GetToken (void) const
+{
+  return m_token;
+}
+
+void
+TcpOptionMptcpJoin::SetNonce (uint32_t nonce)
+{
+  m_nonce = nonce;
+}
+
+uint32_t
+TcpOptionMptcpJoin::GetNonce (void) const
+{
+  return m_nonce;
+}
+
+void
+TcpOptionMptcpJoin::SetAddressId (uint8_t addressId)
+{
+  m_addressId = addressId;
+}
+
+uint8_t
+TcpOptionMptcpJoin::GetAddressId (void) const
+{
+  return m_addressId;
+}
+
+void
+TcpOptionMptcpJoin::SetBackup (bool backup)
+{
+  m_backup = backup;
+}
+
+bool
+TcpOptionMptcpJoin::IsBackup (void) const
+{
+  return m_backup;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (TcpOptionMptcpDss);
+
+TcpOptionMptcpDss::TcpOptionMptcpDss ()
+  : TcpOptionMptcp (),
+    m_flags (0),
+    m_subflowSeq (0),
+    m_dataLength (0)
+{
+}
+
+TcpOptionMptcpDss::~TcpOptionMptcpDss ()
+{
+}
+
+TypeId
+TcpOptionMptcpDss::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpOptionMptcpDss")
+    .SetParent<TcpOptionMptcp> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpOptionMptcpDss> ()
+  ;
+  return tid;
+}
+
+TypeId
+TcpOptionMptcpDss::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+TcpOptionMptcpDss::Print (std::ostream &os) const
+{
+  os << "DSS";
+  if (HasDataAck ())
+    {
+      os << " ack " << m_dataAck;
+    }
+  if (HasMapping ())
+    {
+      os << " map " << m_dataSeq << "->" << m_subflowSeq << " len " << m_dataLength;
+    }
+}
+
+uint32_t
+TcpOptionMptcpDss::GetSerializedSize (void) const
+{
+  return 4 + (HasDataAck () ? 4 : 0) + (HasMapping () ? 10 : 0);
+}
+
+uint8_t
+TcpOptionMptcpDss::GetSubType (void) const
+{
+  return DSS;
+}
+
+void
+TcpOptionMptcpDss::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteU8 (GetKind ());
+  i.WriteU8 (static_cast<uint8_t> (GetSerializedSize ()));
+  i.WriteU8 (GetSubType () << 4);
+  i.WriteU8 (m_flags);
+  if (HasDataAck ())
+    {
+      i.WriteHtonU32 (m_dataAck.GetValue ());
+    }
+  if (HasMapping ())
+    {
+      i.WriteHtonU32 (m_dataSeq.GetValue ());
+      i.WriteHtonU32 (m_subflowSeq);
+      i.WriteHtonU16 (m_dataLength);
+    }
+}
+
+uint32_t
+TcpOptionMptcpDss::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  static const uint8_t lengths[] = { 4, 8, 14, 18 };
+  uint8_t subTypeByte;
+  uint8_t size = ReadHeader (i, lengths, 4, subTypeByte);
+  if (size == 0)
+    {
+      return 0;
+    }
+  m_flags = i.ReadU8 ();
+  if (m_flags & (DATA_ACK_8 | DSN_8))
+    {
+      NS_LOG_WARN ("8-byte DSS fields are not supported");
+      return 0;
+    }
+  if (HasDataAck ())
+    {
+      m_dataAck = SequenceNumber32 (i.ReadNtohU32 ());
+    }
+  if (HasMapping ())
+    {
+      m_dataSeq = SequenceNumber32 (i.ReadNtohU32 ());
+      m_subflowSeq = i.ReadNtohU32 ();
+      m_dataLength = i.ReadNtohU16 ();
+    }
+  if (size != GetSerializedSize ())
+    {
+      NS_LOG_WARN ("Malformed DSS option: length does not match the flags");
+      return 0;
+    }
+  return GetSerializedSize ();
+}
+
+void
+TcpOptionMptcpDss::SetDataAck (SequenceNumber32 dataAck)
+{
+  m_flags |= DATA_ACK;
+  m_dataAck = dataAck;
+}
+
+bool
+TcpOptionMptcpDss::HasDataAck (void) const
+{
+  return m_flags & DATA_ACK;
+}
+
+SequenceNumber32
+TcpOptionMptcpDss::GetDataAck (void) const
+{
+  return m_dataAck;
+}
+
+void
+TcpOptionMptcpDss::SetMapping (SequenceNumber32 dataSeq, uint32_t subflowSeq, uint16_t length)
+{
+  m_flags |= MAPPING;
+  m_dataSeq = dataSeq;
+  m_subflowSeq = subflowSeq;
+  m_dataLength = length;
+}
+
+bool
+TcpOptionMptcpDss::HasMapping (void) const
+{
+  return m_flags & MAPPING;
+}
+
+SequenceNumber32
+TcpOptionMptcpDss::GetDataSequence (void) const
+{
+  return m_dataSeq;
+}
+
+uint32_t
+TcpOptionMptcpDss::GetSubflowSequence (void) const
+{
+  return m_subflowSeq;
+}
+
+uint16_t
+TcpOptionMptcpDss::GetDataLength (void) const
+{
+  return m_dataLength;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (TcpOptionMptcpAddAddress);
+
+TcpOptionMptcpAddAddress::TcpOptionMptcpAddAddress ()
+  : TcpOptionMptcp (),
+    m_addressId (0),
+    m_port (0)
+{
+}
+
+TcpOptionMptcpAddAddress::~TcpOptionMptcpAddAddress ()
+{
+}
+
+TypeId
+TcpOptionMptcpAddAddress::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpOptionMptcpAddAddress")
+    .SetParent<TcpOptionMptcp> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpOptionMptcpAddAddress> ()
+  ;
+  return tid;
+}
+
+TypeId
+TcpOptionMptcpAddAddress::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+TcpOptionMptcpAddAddress::Print (std::ostream &os) const
+{
+  os << "ADD_ADDR id " << static_cast<uint32_t> (m_addressId) << " " << m_address;
+  if (m_port != 0)
+    {
+      os << ":" << m_port;
+    }
+}
+
+uint32_t
+TcpOptionMptcpAddAddress::GetSerializedSize (void) const
+{
+  return m_port != 0 ? 10 : 8;
+}
+
+uint8_t
+TcpOptionMptcpAddAddress::GetSubType (void) const
+{
+  return ADD_ADDR;
+}
+
+void
+TcpOptionMptcpAddAddress::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteU8 (GetKind ());
+  i.WriteU8 (static_cast<uint8_t> (GetSerializedSize ()));
+  i.WriteU8 ((GetSubType () << 4) | 4); // IPv4
+  i.WriteU8 (m_addressId);
+  i.WriteHtonU32 (m_address.Get ());
+  if (m_port != 0)
+    {
+      i.WriteHtonU16 (m_port);
+    }
+}
+
+uint32_t
+TcpOptionMptcpAddAddress::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  static const uint8_t lengths[] = { 8, 10 };
+  uint8_t subTypeByte;
+  uint8_t size = ReadHeader (i, lengths, 2, subTypeByte);
+  if (size == 0)
+    {
+      return 0;
+    }
+  if ((subTypeByte & 0x0F) != 4)
+    {
+      NS_LOG_WARN ("Only IPv4 addresses are supported in ADD_ADDR");
+      return 0;
+    }
+  m_addressId = i.ReadU8 ();
+  m_address = Ipv4Address (i.ReadNtohU32 ());
+  m_port = (size == 10) ? i.ReadNtohU16 () : 0;
+  return GetSerializedSize ();
+}
+
+void
+TcpOptionMptcpAddAddress::SetAddress (uint8_t addressId, Ipv4Address address)
+{
+  m_addressId = addressId;
+  m_address = address;
+}
+
+void
+TcpOptionMptcpAddAddress::SetPort (uint16_t port)
+{
+  m_port = port;
+}
+
+uint8_t
+TcpOptionMptcpAddAddress::GetAddressId (void) const
+{
+  return m_addressId;
+}
+
+Ipv4Address
+TcpOptionMptcpAddAddress::GetAddress (void) const
+{
+  return m_address;
+}
+
+uint16_t
+TcpOptionMptcpAddAddress::GetPort (void) const
+{
+  return m_port;
+}
+
+} // namespace ns3
@@ -0,0 +1,373 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCP_OPTION_MPTCP_H
+#define TCP_OPTION_MPTCP_H
+
+#include "ns3/tcp-option.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/sequence-number.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Base class for the TCP option of kind 30 (Multipath TCP) as in \RFC{6824}
+ *
+ * All the MPTCP signals share the same option kind; the subtype, stored in
+ * the upper nibble of the third byte, identifies the signal.
+ */
+class TcpOptionMptcp : public TcpOption
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpOptionMptcp ();
+  virtual ~TcpOptionMptcp ();
+
+  /**
+   * The MPTCP option subtypes.
+   */
+  enum SubType
+  {
+    MP_CAPABLE = 0,             //!< Multipath capable
+    MP_JOIN = 1,                //!< Join a connection
+    DSS = 2,                    //!< Data sequence signal
+    ADD_ADDR = 3                //!< Add address
+  };
+
+  virtual uint8_t GetKind (void) const;
+
+  /**
+   * \brief Get the MPTCP subtype of the option
+   * \return the subtype
+   */
+  virtual uint8_t GetSubType (void) const = 0;
+
+  /**
+   * \brief Create an MPTCP option
+   * \param subType the subtype read from the buffer
+   * \return the requested option, or a TcpOptionUnknown if the subtype is not supported
+   */
+  static Ptr<TcpOption> CreateMptcpOption (uint8_t subType);
+
+protected:
+  /**
+   * \brief Check kind, length and subtype of a serialized option
+   * \param i the buffer iterator, moved past the subtype byte
+   * \param length the expected lengths of the option (any of them)
+   * \param nLength the number of valid lengths
+   * \param subTypeByte set to the full third byte of the option
+   * \return the length of the option, or 0 if the option is malformed
+   */
+  uint8_t ReadHeader (Buffer::Iterator &i, const uint8_t *length, uint8_t nLength,
+                      uint8_t &subTypeByte) const;
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief MP_CAPABLE option, exchanged on the three-way handshake of the
+ * first subflow
+ *
+ * The SYN and the SYN+ACK carry the key of the sender (12 bytes); the third
+ * ACK echoes both keys (20 bytes).
+ */
+class TcpOptionMptcpCapable : public TcpOptionMptcp
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  TcpOptionMptcpCapable ();
+  virtual ~TcpOptionMptcpCapable ();
+
+  virtual void Print (std::ostream &os) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual uint8_t GetSubType (void) const;
+
+  /**
+   * \brief Set the key of the sender of the option
+   * \param key the key
+   */
+  void SetSenderKey (uint64_t key);
+  /**
+   * \brief Get the key of the sender of the option
+   * \return the key
+   */
+  uint64_t GetSenderKey (void) const;
+  /**
+   * \brief Set the key of the receiver of the option (third ACK only)
+   * \param key the key
+   */
+  void SetReceiverKey (uint64_t key);
+  /**
+   * \brief Get the key of the receiver of the option
+   * \return the key
+   */
+  uint64_t GetReceiverKey (void) const;
+  /**
+   * \brief Check if the option carries the key of the receiver
+   * \return true for the 20-byte form of the option
+   */
+  bool HasReceiverKey (void) const;
+
+private:
+  uint64_t m_senderKey;      //!< Key of the sender
+  uint64_t m_receiverKey;    //!< Key of the receiver
+  bool m_hasReceiverKey;     //!< Whether the receiver key is present
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief MP_JOIN option, carried by the SYN of an additional subflow
+ *
+ * Only the 12-byte SYN form is modeled: the HMAC exchange that
+ * authenticates the join on the SYN+ACK and the third ACK is not.
+ */
+class TcpOptionMptcpJoin : public TcpOptionMptcp
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  TcpOptionMptcpJoin ();
+  virtual ~TcpOptionMptcpJoin ();
+
+  virtual void Print (std::ostream &os) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual uint8_t GetSubType (void) const;
+
+  /**
+   * \brief Set the token of the connection to join
+   * \param token the token of the receiver
+   */
+  void SetToken (uint32_t token);
+  /**
+   * \brief Get the token of the connection to join
+   * \return the token
+   */
+  uint32_t GetToken (void) const;
+  /**
+   * \brief Set the random number of the sender
+   * \param nonce the random number
+   */
+  void SetNonce (uint32_t nonce);
+  /**
+   * \brief Get the random number of the sender
+   * \return the random number
+   */
+  uint32_t GetNonce (void) const;
+  /**
+   * \brief Set the address identifier of the source of the subflow
+   * \param addressId the address identifier
+   */
+  void SetAddressId (uint8_t addressId);
+  /**
+   * \brief Get the address identifier of the source of the subflow
+   * \return the address identifier
+   */
+  uint8_t GetAddressId (void) const;
+  /**
+   * \brief Set the backup flag
+   * \param backup whether the subflow is a backup path
+   */
+  void SetBackup (bool backup);
+  /**
+   * \brief Get the backup flag
+   * \return true if the subflow is a backup path
+   */
+  bool IsBackup (void) const;
+
+private:
+  uint32_t m_token;          //!< Token of the receiver
+  uint32_t m_nonce;          //!< Random number of the sender
+  uint8_t m_addressId;       //!< Address identifier
+  bool m_backup;             //!< Backup flag
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Data Sequence Signal option
+ *
+ * The DSS option carries the cumulative data-level acknowledgment and/or the
+ * mapping of a range of subflow sequence numbers onto the data sequence
+ * space. Only the 4-byte forms of the data ACK and of the data sequence
+ * number are used, and no DSS checksum is carried.
+ */
+class TcpOptionMptcpDss : public TcpOptionMptcp
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  TcpOptionMptcpDss ();
+  virtual ~TcpOptionMptcpDss ();
+
+  virtual void Print (std::ostream &os) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual uint8_t GetSubType (void) const;
+
+  /**
+   * \brief Set the data ACK
+   * \param dataAck the next data sequence number expected by the sender
+   */
+  void SetDataAck (SequenceNumber32 dataAck);
+  /**
+   * \brief Check if the option carries a data ACK
+   * \return true if the data ACK is present
+   */
+  bool HasDataAck (void) const;
+  /**
+   * \brief Get the data ACK
+   * \return the data ACK
+   */
+  SequenceNumber32 GetDataAck (void) const;
+  /**
+   * \brief Set the mapping carried by the option
+   * \param dataSeq the data sequence number of the first mapped byte
+   * \param subflowSeq the subflow sequence number (relative to the initial
+   *        sequence number of the subflow) of the first mapped byte
+   * \param length the length of the mapping
+   */
+  void SetMapping (SequenceNumber32 dataSeq, uint32_t subflowSeq, uint16_t length);
+  /**
+   * \brief Check if the option carries a mapping
+   * \return true if the mapping is present
+   */
+  bool HasMapping (void) const;
+  /**
+   * \brief Get the data sequence number of the mapping
+   * \return the data sequence number of the first mapped byte
+   */
+  SequenceNumber32 GetDataSequence (void) const;
+  /**
+   * \brief Get the relative subflow sequence number of the mapping
+   * \return the relative subflow sequence number of the first mapped byte
+   */
+  uint32_t GetSubflowSequence (void) const;
+  /**
+   * \brief Get the length of the mapping
+   * \return the length of the mapping
+   */
+  uint16_t GetDataLength (void) const;
+
+  /**
+   * \brief DSS flags
+   */
+  enum Flags
+  {
+    DATA_ACK = 0x01,           //!< Data ACK present
+    DATA_ACK_8 = 0x02,         //!< Data ACK is 8 bytes (not used)
+    MAPPING = 0x04,            //!< Mapping present
+    DSN_8 = 0x08,              //!< Data sequence number is 8 bytes (not used)
+    DATA_FIN = 0x10            //!< DATA_FIN (not used)
+  };
+
+private:
+  uint8_t m_flags;               //!< DSS flags
+  SequenceNumber32 m_dataAck;    //!< Data ACK
+  SequenceNumber32 m_dataSeq;    //!< Data sequence number of the mapping
+  uint32_t m_subflowSeq;         //!< Relative subflow sequence number of the mapping
+  uint16_t m_dataLength;         //!< Length of the mapping
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief ADD_ADDR option, advertising an additional IPv4 address of the sender
+ */
+class TcpOptionMptcpAddAddress : public TcpOptionMptcp
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  TcpOptionMptcpAddAddress ();
+  virtual ~TcpOptionMptcpAddAddress ();
+
+  virtual void Print (std::ostream &os) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual uint8_t GetSubType (void) const;
+
+  /**
+   * \brief Set the advertised address
+   * \param addressId the address identifier
+   * \param address the address
+   */
+  void SetAddress (uint8_t addressId, Ipv4Address address);
+  /**
+   * \brief Set the advertised port
+   * \param port the port (0 to omit it)
+   */
+  void SetPort (uint16_t port);
+  /**
+   * \brief Get the address identifier
+   * \return the address identifier
+   */
+  uint8_t GetAddressId (void) const;
+  /**
+   * \brief Get the advertised address
+   * \return the address
+   */
+  Ipv4Address GetAddress (void) const;
+  /**
+   * \brief Get the advertised port
+   * \return the port, or 0 if the option carries no port
+   */
+  uint16_t GetPort (void) const;
+
+private:
+  uint8_t m_addressId;       //!< Address identifier
+  Ipv4Address m_address;     //!< Advertised address
+  uint16_t m_port;           //!< Advertised port (0 if absent)
+};
+
+} // namespace ns3
+
+#endif /* TCP_OPTION_MPTCP_H */
@@ -0,0 +1,265 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-rack-tlp.h"
+#include "tcp-tx-buffer.h"
+#include "tcp-tx-item.h"
+
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpRackTlp");
+NS_OBJECT_ENSURE_REGISTERED (TcpRackTlp);
+
+/**
+ * Number of loss recoveries without spurious retransmissions after which
+ * the reordering window multiplier is reset (RFC 8985, Section 6.2)
+ */
+static const uint32_t REO_WND_PERSIST = 16;
+
+/**
+ * \brief Check whether a segment has been sent after another one
+ * \param t1 the transmission time of the first segment
+ * \param seq1 the end sequence of the first segment
+ * \param t2 the transmission time of the second segment
+ * \param seq2 the end sequence of the second segment
+ * \return true if the first segment has been sent after the second one
+ */
+static bool
+SentAfter (const Time &t1, const SequenceNumber32 &seq1,
+           const Time &t2, const SequenceNumber32 &seq2)
+{
+  // Many segments are sent at the same time in a simulation: break the
+  // ties with the sequence numbers
+  return t1 > t2 || (t1 == t2 && seq1 > seq2);
+}
+
+TypeId
+TcpRackTlp::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpRackTlp")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpRackTlp> ()
+    .AddAttribute ("MaxAckDelay",
+                   "Worst case delayed ACK timer of the receiver, added to "
+                   "the probe timeout when a single segment is in flight",
+                   TimeValue (MilliSeconds (200)),
+                   MakeTimeAccessor (&TcpRackTlp::m_maxAckDelay),
+                   MakeTimeChecker ())
+    .AddAttribute ("Tlp",
+                   "Enable the tail loss probes",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpRackTlp::m_tlpEnabled),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+TcpRackTlp::TcpRackTlp (void)
+  : Object ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpRackTlp::TcpRackTlp (const TcpRackTlp &other)
+  : Object (other),
+    m_maxAckDelay (other.m_maxAckDelay),
+    m_tlpEnabled (other.m_tlpEnabled),
+    m_hasSample (other.m_hasSample),
+    m_xmitTs (other.m_xmitTs),
+    m_endSeq (other.m_endSeq),
+    m_rtt (other.m_rtt),
+    m_xmitRetrans (other.m_xmitRetrans),
+    m_fack (other.m_fack),
+    m_minRtt (other.m_minRtt),
+    m_reorderingSeen (other.m_reorderingSeen),
+    m_reoWndMult (other.m_reoWndMult),
+    m_reoWndPersist (other.m_reoWndPersist),
+    m_lastReoWndInc (other.m_lastReoWndInc)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpRackTlp::~TcpRackTlp (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+TcpRackTlp::GetName (void) const
+{
+  return "TcpRackTlp";
+}
+
+void
+TcpRackTlp::UpdateStats (const TcpTxItem *item)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time now = Simulator::Now ();
+  Time rtt = now - item->GetLastSent ();
+  SequenceNumber32 endSeq = item->GetStartSeq () + item->GetSeqSize ();
+
+  if (item->IsRetrans () && m_minRtt != Time::Max () && rtt < m_minRtt)
+    {
+      // The ACK is for the original transmission: the retransmission was
+      // spurious, so the reordering window was too small. Widen it at most
+      // once per round trip.
+      NS_LOG_INFO ("Spurious retransmission of " << item->GetStartSeq ());
+      m_reorderingSeen = true;
+      if (now - m_lastReoWndInc >= m_rtt)
+        {
+          m_reoWndMult++;
+          m_reoWndPersist = REO_WND_PERSIST;
+          m_lastReoWndInc = now;
+        }
+      return;
+    }
+
+  if (!item->IsRetrans ())
+    {
+      m_minRtt = std::min (m_minRtt, rtt);
+    }
+
+  if (!m_hasSample || SentAfter (item->GetLastSent (), endSeq, m_xmitTs, m_endSeq))
+    {
+      m_xmitTs = item->GetLastSent ();
+      m_endSeq = endSeq;
+      m_rtt = rtt;
+      m_xmitRetrans = item->IsRetrans ();
+    }
+
+  if (!m_hasSample || endSeq > m_fack)
+    {
+      m_fack = endSeq;
+    }
+  else if (!item->IsRetrans () && endSeq < m_fack)
+    {
+      // A segment never retransmitted is delivered after a segment with a
+      // higher sequence number
+      NS_LOG_INFO ("Reordering of " << item->GetStartSeq () << ", highest delivered " << m_fack);
+      m_reorderingSeen = true;
+    }
+  m_hasSample = true;
+}
+
+Time
+TcpRackTlp::GetReorderingWindow (const Time &srtt, bool inRecovery, bool dupThreshReached) const
+{
+  if (!m_reorderingSeen && (inRecovery || dupThreshReached))
+    {
+      return Seconds (0);
+    }
+  Time minRtt = (m_minRtt == Time::Max () ? srtt : m_minRtt);
+  return std::min (TimeStep (minRtt.GetTimeStep () / 4 * m_reoWndMult), srtt);
+}
+
+uint32_t
+TcpRackTlp::DetectLoss (Ptr<TcpTxBuffer> txBuffer, const Time &srtt,
+                        bool inRecovery, bool dupThreshReached)
+{
+  NS_LOG_FUNCTION (this << srtt << inRecovery << dupThreshReached);
+
+  m_reoTimeout = Time::Max ();
+  if (!m_hasSample)
+    {
+      return 0;
+    }
+  // Without SACKed segments, a segment sent before the most recently
+  // delivered one is either a retransmission or, if the latter is a
+  // retransmission, an original transmission: skip the common case of
+  // in-order delivery without walking the sent list
+  if (txBuffer->GetSacked () == 0 && txBuffer->GetRetransmitsCount () == 0 && !m_xmitRetrans)
+    {
+      return 0;
+    }
+  m_reoWnd = GetReorderingWindow (srtt, inRecovery, dupThreshReached);
+  uint32_t lost = txBuffer->MarkLost (MakeCallback (&TcpRackTlp::CheckLost, this));
+  NS_LOG_DEBUG ("Reordering window " << m_reoWnd.As (Time::US) << ", " << lost <<
+                " bytes marked as lost");
+  return lost;
+}
+
+bool
+TcpRackTlp::CheckLost (const TcpTxItem *item)
+{
+  if (!SentAfter (m_xmitTs, m_endSeq, item->GetLastSent (), item->GetStartSeq () + item->GetSeqSize ()))
+    {
+      return false;
+    }
+  Time left = item->GetLastSent () + m_rtt + m_reoWnd - Simulator::Now ();
+  if (left.IsStrictlyPositive ())
+    {
+      m_reoTimeout = std::min (m_reoTimeout, left);
+      return false;
+    }
+  return true;
+}
+
+Time
+TcpRackTlp::GetReorderTimeout (void) const
+{
+  return (m_reoTimeout == Time::Max () ? Seconds (0) : m_reoTimeout);
+}
+
+void
+TcpRackTlp::ExitRecovery (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_reoWndPersist > 0 && --m_reoWndPersist == 0)
+    {
+      m_reoWndMult = 1;
+    }
+}
+
+bool
+TcpRackTlp::IsReorderingSeen (void) const
+{
+  return m_reorderingSeen;
+}
+
+bool
+TcpRackTlp::IsTlpEnabled (void) const
+{
+  return m_tlpEnabled;
+}
+
+Time
+TcpRackTlp::GetProbeTimeout (const Time &srtt, uint32_t bytesInFlight, uint32_t segmentSize) const
+{
+  if (srtt.IsZero ())
+    {
+      return Seconds (1);
+    }
+  Time pto = srtt + srtt;
+  if (bytesInFlight <= segmentSize)
+    {
+      pto += m_maxAckDelay;
+    }
+  return pto;
+}
+
+Ptr<TcpRackTlp>
+TcpRackTlp::Fork (void)
+{
+  return CopyObject<TcpRackTlp> (this);
+}
+
+} // namespace ns3
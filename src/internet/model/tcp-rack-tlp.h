@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TCP_RACK_TLP_H
+#define TCP_RACK_TLP_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/sequence-number.h"
+
+namespace ns3 {
+
+class TcpTxItem;
+class TcpTxBuffer;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Time-based loss detection with RACK-TLP (RFC 8985)
+ *
+ * RACK (Recent ACKnowledgment) declares a segment lost when a segment sent
+ * sufficiently later has been delivered, i.e., when the segment has not
+ * been (s)acked a reordering window after the RTT of the most recently
+ * delivered segment. Unlike the duplicate acknowledgment threshold, the
+ * detection does not depend on the number of segments delivered out of
+ * order, hence it is robust to the reordering caused by per-packet load
+ * balancing: once reordering has been observed, the reordering window
+ * (a quarter of the minimum RTT by default) lets the out-of-order segments
+ * arrive before declaring the missing ones lost.
+ *
+ * TLP (Tail Loss Probe) sends a probe segment when no ACK has been received
+ * for about two smoothed RTTs, so that the losses at the tail of a flight
+ * trigger the SACK feedback needed by RACK instead of a retransmission
+ * timeout.
+ *
+ * As TcpRecoveryOps, this class only holds the algorithm state, while the
+ * socket (TcpSocketBase) drives it: it feeds the delivered segments to
+ * UpdateStats (), runs DetectLoss () after each ACK and schedules the
+ * reordering timer and the loss probes. Since the receivers in ns-3 do not
+ * send D-SACK blocks, a retransmitted segment acknowledged less than a
+ * minimum RTT after its retransmission is taken as the evidence of a
+ * spurious retransmission, which widens the reordering window.
+ */
+class TcpRackTlp : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpRackTlp (void);
+
+  /**
+   * \brief Copy constructor.
+   * \param other object to copy.
+   */
+  TcpRackTlp (const TcpRackTlp &other);
+
+  virtual ~TcpRackTlp (void);
+
+  /**
+   * \brief Get the name of the loss detection algorithm
+   * \return A string identifying the name
+   */
+  std::string GetName (void) const;
+
+  /**
+   * \brief Update the RACK state with a segment which has just been
+   * delivered (RFC 8985, Section 6.2, steps 1-3)
+   *
+   * Must be called once per delivered segment, when it is SACKed or, if it
+   * was not SACKed before, when it is cumulatively acknowledged.
+   *
+   * \param item the delivered segment
+   */
+  void UpdateStats (const TcpTxItem *item);
+
+  /**
+   * \brief Mark as lost the segments sent before the most recently delivered
+   * one and not delivered within the reordering window (RFC 8985, Section
+   * 6.2, steps 4-5)
+   *
+   * \param txBuffer the transmission buffer holding the segments
+   * \param srtt the smoothed RTT
+   * \param inRecovery true if the socket is in fast recovery
+   * \param dupThreshReached true if at least DupThresh segments are SACKed
+   * \return the number of bytes newly marked as lost
+   */
+  uint32_t DetectLoss (Ptr<TcpTxBuffer> txBuffer, const Time &srtt,
+                       bool inRecovery, bool dupThreshReached);
+
+  /**
+   * \brief Get the delay of the reordering timer
+   *
+   * \return the time left, after the last DetectLoss (), before the first
+   * segment still in its reordering window is declared lost, or zero if
+   * no such segment exists
+   */
+  Time GetReorderTimeout (void) const;
+
+  /**
+   * \brief Get the reordering window (RFC 8985, Section 6.2, step 4)
+   *
+   * \param srtt the smoothed RTT
+   * \param inRecovery true if the socket is in fast recovery
+   * \param dupThreshReached true if at least DupThresh segments are SACKed
+   * \return the reordering window
+   */
+  Time GetReorderingWindow (const Time &srtt, bool inRecovery, bool dupThreshReached) const;
+
+  /**
+   * \brief Notify the end of a loss recovery episode
+   *
+   * After 16 episodes without spurious retransmissions, the reordering
+   * window goes back to its initial value.
+   */
+  void ExitRecovery (void);
+
+  /**
+   * \brief Check whether reordering has been observed on the connection
+   * \return true if a segment has been delivered after a segment sent later
+   */
+  bool IsReorderingSeen (void) const;
+
+  /**
+   * \brief Check whether the tail loss probes are enabled
+   * \return true if the tail loss probes are enabled
+   */
+  bool IsTlpEnabled (void) const;
+
+  /**
+   * \brief Get the probe timeout (RFC 8985, Section 7.2)
+   *
+   * \param srtt the smoothed RTT (zero if no RTT sample is available)
+   * \param bytesInFlight the bytes in flight
+   * \param segmentSize the segment size
+   * \return the time after which a loss probe is sent if no ACK is received
+   */
+  Time GetProbeTimeout (const Time &srtt, uint32_t bytesInFlight, uint32_t segmentSize) const;
+
+  /**
+   * \brief Copy the loss detection algorithm across socket clones
+   * \return a pointer to the copied object
+   */
+  Ptr<TcpRackTlp> Fork (void);
+
+private:
+  /**
+   * \brief Check whether a segment sent before the most recently delivered
+   * one is lost, and keep track of the time left otherwise
+   * \param item the segment
+   * \return true if the segment is lost
+   */
+  bool CheckLost (const TcpTxItem *item);
+
+  Time m_maxAckDelay;                 //!< Worst case delayed ACK timer of the receiver
+  bool m_tlpEnabled;                  //!< Whether the tail loss probes are enabled
+
+  bool m_hasSample {false};           //!< Whether a segment has been delivered
+  Time m_xmitTs {Seconds (0)};        //!< Transmission time of the most recently sent segment delivered
+  SequenceNumber32 m_endSeq {0};      //!< End sequence of the most recently sent segment delivered
+  Time m_rtt {Seconds (0)};           //!< RTT of the most recently sent segment delivered
+  bool m_xmitRetrans {false};         //!< Whether the most recently sent segment delivered was retransmitted
+  SequenceNumber32 m_fack {0};        //!< Highest end sequence delivered
+  Time m_minRtt {Time::Max ()};       //!< Minimum RTT of the segments delivered
+  bool m_reorderingSeen {false};      //!< Whether reordering has been observed
+  uint32_t m_reoWndMult {1};          //!< Multiplier of the reordering window
+  uint32_t m_reoWndPersist {0};       //!< Recoveries before resetting the multiplier
+  Time m_lastReoWndInc {Seconds (0)}; //!< Time of the last increase of the multiplier
+  Time m_reoWnd {Seconds (0)};        //!< Reordering window of the current detection
+  Time m_reoTimeout {Time::Max ()};   //!< Time left before the next segment is lost
+};
+
+} // namespace ns3
+
+#endif /* TCP_RACK_TLP_H */
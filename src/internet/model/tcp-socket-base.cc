@@ -58,7 +58,9 @@
 #include "tcp-option-sack.h"
 #include "tcp-congestion-ops.h"
 #include "tcp-recovery-ops.h"
+#include "tcp-rack-tlp.h"
 #include "ns3/tcp-rate-ops.h"
+#include "tcp-gso-tag.h"
 
 #include <math.h>
 #include <algorithm>
@@ -69,6 +71,43 @@ NS_LOG_COMPONENT_DEFINE ("TcpSocketBase");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpSocketBase);
 
+class TcpSocketBase::TcbTraceSourceAccessor : public TraceSourceAccessor
+{
+public:
+  /**
+   * \brief Constructor
+   * \param name the name of the TcpSocketState trace source
+   */
+  TcbTraceSourceAccessor (std::string name)
+    : m_name (name)
+  {
+  }
+
+  virtual bool ConnectWithoutContext (ObjectBase *obj, const CallbackBase &cb) const
+  {
+    TcpSocketBase *sock = dynamic_cast<TcpSocketBase *> (obj);
+    return sock != nullptr && sock->m_tcb->TraceConnectWithoutContext (m_name, cb);
+  }
+  virtual bool Connect (ObjectBase *obj, std::string context, const CallbackBase &cb) const
+  {
+    TcpSocketBase *sock = dynamic_cast<TcpSocketBase *> (obj);
+    return sock != nullptr && sock->m_tcb->TraceConnect (m_name, context, cb);
+  }
+  virtual bool DisconnectWithoutContext (ObjectBase *obj, const CallbackBase &cb) const
+  {
+    TcpSocketBase *sock = dynamic_cast<TcpSocketBase *> (obj);
+    return sock != nullptr && sock->m_tcb->TraceDisconnectWithoutContext (m_name, cb);
+  }
+  virtual bool Disconnect (ObjectBase *obj, std::string context, const CallbackBase &cb) const
+  {
+    TcpSocketBase *sock = dynamic_cast<TcpSocketBase *> (obj);
+    return sock != nullptr && sock->m_tcb->TraceDisconnect (m_name, context, cb);
+  }
+
+private:
+  std::string m_name; //!< Name of the TcpSocketState trace source
+};
+
 TypeId
 TcpSocketBase::GetTypeId (void)
 {
@@ -147,6 +186,27 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("GsoMaxSize",
+                   "Maximum size (bytes) of the super-segments handed to the IPv4 "
+                   "layer when generic segmentation offload is used. The super-segments "
+                   "are split into SegmentSize segments by the traffic control layer. "
+                   "A value not larger than SegmentSize disables segmentation offload.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpSocketBase::m_gsoMaxSize),
+                   MakeUintegerChecker<uint32_t> (0, 65535))
+    .AddAttribute ("HeaderPrediction",
+                   "Process pure ACKs and in-order data of established "
+                   "connections in steady state through a fast path",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpSocketBase::m_headerPrediction),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RackTlp",
+                   "Detect the lost segments with RACK-TLP (RFC 8985) instead "
+                   "of the duplicate ACK threshold. Requires SACK.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::SetRackTlp,
+                                        &TcpSocketBase::GetRackTlp),
+                   MakeBooleanChecker ())
     .AddAttribute ("UseEcn", "Parameter to set ECN functionality",
                    EnumValue (TcpSocketState::Off),
                    MakeEnumAccessor (&TcpSocketBase::SetUseEcn),
@@ -159,15 +219,15 @@ TcpSocketBase::GetTypeId (void)
                      "ns3::TracedValueCallback::Time")
     .AddTraceSource ("RTT",
                      "Last RTT sample",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_lastRttTrace),
+                     Create<TcbTraceSourceAccessor> ("RTT"),
                      "ns3::TracedValueCallback::Time")
     .AddTraceSource ("NextTxSequence",
                      "Next sequence number to send (SND.NXT)",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_nextTxSequenceTrace),
+                     Create<TcbTraceSourceAccessor> ("NextTxSequence"),
                      "ns3::SequenceNumber32TracedValueCallback")
     .AddTraceSource ("HighestSequence",
                      "Highest sequence number ever sent in socket's life time",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_highTxMarkTrace),
+                     Create<TcbTraceSourceAccessor> ("HighestSequence"),
                      "ns3::TracedValueCallback::SequenceNumber32")
     .AddTraceSource ("State",
                      "TCP state",
@@ -175,11 +235,11 @@ TcpSocketBase::GetTypeId (void)
                      "ns3::TcpStatesTracedValueCallback")
     .AddTraceSource ("CongState",
                      "TCP Congestion machine state",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_congStateTrace),
+                     Create<TcbTraceSourceAccessor> ("CongState"),
                      "ns3::TcpSocketState::TcpCongStatesTracedValueCallback")
     .AddTraceSource ("EcnState",
                      "Trace ECN state change of socket",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_ecnStateTrace),
+                     Create<TcbTraceSourceAccessor> ("EcnState"),
                      "ns3::TcpSocketState::EcnStatesTracedValueCallback")
     .AddTraceSource ("AdvWND",
                      "Advertised Window Size",
@@ -191,7 +251,7 @@ TcpSocketBase::GetTypeId (void)
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("BytesInFlight",
                      "Socket estimation of bytes in flight",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_bytesInFlightTrace),
+                     Create<TcbTraceSourceAccessor> ("BytesInFlight"),
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("HighestRxSequence",
                      "Highest sequence number received from peer",
@@ -203,19 +263,19 @@ TcpSocketBase::GetTypeId (void)
                      "ns3::TracedValueCallback::SequenceNumber32")
     .AddTraceSource ("PacingRate",
                      "The current TCP pacing rate",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_pacingRateTrace),
+                     Create<TcbTraceSourceAccessor> ("PacingRate"),
                      "ns3::TracedValueCallback::DataRate")
     .AddTraceSource ("CongestionWindow",
                      "The TCP connection's congestion window",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_cWndTrace),
+                     Create<TcbTraceSourceAccessor> ("CongestionWindow"),
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("CongestionWindowInflated",
                      "The TCP connection's congestion window inflates as in older RFC",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_cWndInflTrace),
+                     Create<TcbTraceSourceAccessor> ("CongestionWindowInflated"),
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("SlowStartThreshold",
                      "TCP slow start threshold (bytes)",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_ssThTrace),
+                     Create<TcbTraceSourceAccessor> ("SlowStartThreshold"),
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("Tx",
                      "Send tcp packet to IP protocol",
@@ -262,48 +322,6 @@ TcpSocketBase::TcpSocketBase (void)
   m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
 
   m_tcb->m_sendEmptyPacketCallback = MakeCallback (&TcpSocketBase::SendEmptyPacket, this);
-
-  bool ok;
-
-  ok = m_tcb->TraceConnectWithoutContext ("PacingRate",
-                                          MakeCallback (&TcpSocketBase::UpdatePacingRateTrace, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongestionWindow",
-                                          MakeCallback (&TcpSocketBase::UpdateCwnd, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongestionWindowInflated",
-                                          MakeCallback (&TcpSocketBase::UpdateCwndInfl, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("SlowStartThreshold",
-                                          MakeCallback (&TcpSocketBase::UpdateSsThresh, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongState",
-                                          MakeCallback (&TcpSocketBase::UpdateCongState, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("EcnState",
-                                          MakeCallback (&TcpSocketBase::UpdateEcnState, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("NextTxSequence",
-                                          MakeCallback (&TcpSocketBase::UpdateNextTxSequence, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("HighestSequence",
-                                          MakeCallback (&TcpSocketBase::UpdateHighTxMark, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("BytesInFlight",
-                                          MakeCallback (&TcpSocketBase::UpdateBytesInFlight, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("RTT",
-                                          MakeCallback (&TcpSocketBase::UpdateRtt, this));
-  NS_ASSERT (ok == true);
 }
 
 TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
@@ -354,6 +372,8 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
     m_pacingTimer (Timer::CANCEL_ON_DESTROY),
+    m_headerPrediction (sock.m_headerPrediction),
+    m_gsoMaxSize (sock.m_gsoMaxSize),
     m_ecnEchoSeq (sock.m_ecnEchoSeq),
     m_ecnCESeq (sock.m_ecnCESeq),
     m_ecnCWRSeq (sock.m_ecnCWRSeq)
@@ -392,52 +412,16 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
       m_recoveryOps = sock.m_recoveryOps->Fork ();
     }
 
+  if (sock.m_rackTlp)
+    {
+      m_rackTlp = sock.m_rackTlp->Fork ();
+    }
+
   m_rateOps = CreateObject <TcpRateLinux> ();
   if (m_tcb->m_sendEmptyPacketCallback.IsNull ())
     {
       m_tcb->m_sendEmptyPacketCallback = MakeCallback (&TcpSocketBase::SendEmptyPacket, this);
     }
-
-  bool ok;
-
-  ok = m_tcb->TraceConnectWithoutContext ("PacingRate",
-                                          MakeCallback (&TcpSocketBase::UpdatePacingRateTrace, this));
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongestionWindow",
-                                          MakeCallback (&TcpSocketBase::UpdateCwnd, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongestionWindowInflated",
-                                          MakeCallback (&TcpSocketBase::UpdateCwndInfl, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("SlowStartThreshold",
-                                          MakeCallback (&TcpSocketBase::UpdateSsThresh, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongState",
-                                          MakeCallback (&TcpSocketBase::UpdateCongState, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("EcnState",
-                                          MakeCallback (&TcpSocketBase::UpdateEcnState, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("NextTxSequence",
-                                          MakeCallback (&TcpSocketBase::UpdateNextTxSequence, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("HighestSequence",
-                                          MakeCallback (&TcpSocketBase::UpdateHighTxMark, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("BytesInFlight",
-                                          MakeCallback (&TcpSocketBase::UpdateBytesInFlight, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("RTT",
-                                          MakeCallback (&TcpSocketBase::UpdateRtt, this));
-  NS_ASSERT (ok == true);
 }
 
 TcpSocketBase::~TcpSocketBase (void)
@@ -1296,6 +1280,11 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
 
   m_rxTrace (packet, tcpHeader, this);
 
+  if (m_headerPrediction && ProcessEstablishedFast (packet, tcpHeader))
+    {
+      return;
+    }
+
   if (tcpHeader.GetFlags () & TcpHeader::SYN)
     {
       /* The window field in a segment where the SYN bit is set (i.e., a <SYN>
@@ -1321,6 +1310,8 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
         {
           m_sackEnabled = false;
           m_txBuffer->SetSackEnabled (false);
+          // RACK-TLP relies on the SACK blocks
+          SetRackTlp (false);
         }
 
       // When receiving a <SYN> or <SYN-ACK> we should adapt TS to the other end
@@ -1525,6 +1516,87 @@ TcpSocketBase::ProcessEstablished (Ptr<Packet> packet, const TcpHeader& tcpHeade
     }
 }
 
+bool
+TcpSocketBase::ProcessEstablishedFast (Ptr<Packet> packet, const TcpHeader& tcpHeader)
+{
+  // Prediction: ACK only, steady state, window unchanged
+  if (m_state != ESTABLISHED
+      || (tcpHeader.GetFlags () & ~TcpHeader::PSH) != TcpHeader::ACK
+      || m_tcb->m_congState != TcpSocketState::CA_OPEN
+      || m_tcb->m_ecnState == TcpSocketState::ECN_ECE_RCVD
+      || m_congestionControl->HasCongControl ()
+      || m_rWnd.Get () == 0
+      || (static_cast<uint32_t> (tcpHeader.GetWindowSize ()) << m_sndWindShift) != m_rWnd.Get ()
+      || !m_persistEvent.IsExpired ())
+    {
+      return false;
+    }
+
+  SequenceNumber32 ackNumber = tcpHeader.GetAckNumber ();
+  bool pureAck = packet->GetSize () == 0;
+  if (pureAck)
+    {
+      // A pure ACK of new data
+      if (ackNumber <= m_txBuffer->HeadSequence () || ackNumber > m_tcb->m_highTxMark)
+        {
+          return false;
+        }
+    }
+  else
+    {
+      // The next in-order data segment, acking nothing new, with nothing
+      // outstanding or to be sent
+      if (tcpHeader.GetSequenceNumber () != m_tcb->m_rxBuffer->NextRxSequence ()
+          || ackNumber != m_txBuffer->HeadSequence ()
+          || m_txBuffer->Size () != 0
+          || m_tcb->m_bytesInFlight.Get () != 0)
+        {
+          return false;
+        }
+    }
+
+  // Only timestamps (and padding) are allowed; no SACK blocks
+  bool hasTs = false;
+  for (const Ptr<const TcpOption> &option : tcpHeader.GetOptionList ())
+    {
+      uint8_t kind = option->GetKind ();
+      if (kind == TcpOption::TS)
+        {
+          hasTs = true;
+        }
+      else if (kind != TcpOption::END && kind != TcpOption::NOP)
+        {
+          return false;
+        }
+    }
+  if (m_timestampEnabled && !hasTs)
+    {
+      return false;
+    }
+
+  NS_LOG_FUNCTION (this << tcpHeader);
+
+  if (m_timestampEnabled)
+    {
+      ProcessOptionTimestamp (tcpHeader.GetOption (TcpOption::TS),
+                              tcpHeader.GetSequenceNumber ());
+    }
+  EstimateRtt (tcpHeader);
+  UpdateWindowSize (tcpHeader);
+
+  if (pureAck)
+    {
+      ReceivedAck (packet, tcpHeader);
+    }
+  else
+    {
+      // ReceivedAck would not change anything but the last acked sequence
+      m_tcb->m_lastAckedSeq = ackNumber;
+      ReceivedData (packet, tcpHeader);
+    }
+  return true;
+}
+
 bool
 TcpSocketBase::IsTcpOptionEnabled (uint8_t kind) const
 {
@@ -1612,7 +1684,7 @@ TcpSocketBase::EnterRecovery (uint32_t currentDelivered)
       m_txBuffer->AddRenoSack ();
       m_txBuffer->MarkHeadAsLost ();
     }
-  else
+  else if (m_rackTlp == nullptr)
     {
       if (!m_txBuffer->IsLost (m_txBuffer->HeadSequence ()))
         {
@@ -1706,6 +1778,11 @@ TcpSocketBase::DupAck (uint32_t currentDelivered)
                        "Increase cwnd to " << m_tcb->m_cWnd);
         }
     }
+  else if (m_tcb->m_congState == TcpSocketState::CA_DISORDER && m_rackTlp != nullptr)
+    {
+      // The losses are detected by RACK-TLP in ReceivedAck, regardless of
+      // the number of duplicate ACKs
+    }
   else if (m_tcb->m_congState == TcpSocketState::CA_DISORDER)
     {
       // m_dupackCount should not exceed its threshold in CA_DISORDER state
@@ -1808,10 +1885,22 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
         }
     }
 
-  m_txBuffer->DiscardUpTo (ackNumber, MakeCallback (&TcpRateOps::SkbDelivered, m_rateOps));
+  m_txBuffer->DiscardUpTo (ackNumber, MakeCallback (&TcpSocketBase::SegmentAcked, this));
 
   uint32_t currentDelivered = static_cast<uint32_t> (m_rateOps->GetConnectionRate ().m_delivered - previousDelivered);
 
+  // With RACK-TLP, mark the lost segments before processing the ACK, which
+  // may retransmit them
+  uint32_t rackLost = 0;
+  if (m_rackTlp != nullptr)
+    {
+      if (ackNumber > oldHeadSequence || bytesSacked > 0)
+        {
+          m_tlpOutstanding = false;
+        }
+      rackLost = RackDetectLoss ();
+    }
+
   if (m_tcb->m_congState == TcpSocketState::CA_CWR && (ackNumber > m_recover))
     {
       // Recovery is over after the window exceeds m_recover
@@ -1854,6 +1943,11 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
   ProcessAck (ackNumber, (bytesSacked > 0), currentDelivered, oldHeadSequence);
   m_tcb->m_isRetransDataAcked = false;
 
+  if (rackLost > 0)
+    {
+      RackEnterRecovery (currentDelivered);
+    }
+
   if (m_congestionControl->HasCongControl ())
     {
       uint32_t currentLost = m_txBuffer->GetLost ();
@@ -1872,6 +1966,11 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       ReceivedData (packet, tcpHeader);
     }
 
+  if (m_rackTlp != nullptr)
+    {
+      ScheduleLossProbe ();
+    }
+
   // RFC 6675, Section 5, point (C), try to send more data. NB: (C) is implemented
   // inside SendPendingData
   SendPendingData (m_connected);
@@ -2004,8 +2103,11 @@ TcpSocketBase::ProcessAck(const SequenceNumber32 &ackNumber, bool scoreboardUpda
               m_recoveryOps->DoRecovery (m_tcb, currentDelivered);
             }
 
-          // If the packet is already retransmitted do not retransmit it
-          if (!m_txBuffer->IsRetransmittedDataAcked (ackNumber + m_tcb->m_segmentSize))
+          // If the packet is already retransmitted do not retransmit it.
+          // With RACK-TLP, the segments are retransmitted only once marked
+          // as lost.
+          if (m_rackTlp == nullptr
+              && !m_txBuffer->IsRetransmittedDataAcked (ackNumber + m_tcb->m_segmentSize))
             {
               DoRetransmit (); // Assume the next seq is lost. Retransmit lost packet
               m_tcb->m_cWndInfl = SafeSubtraction (m_tcb->m_cWndInfl, bytesAcked);
@@ -2151,6 +2253,10 @@ TcpSocketBase::ProcessAck(const SequenceNumber32 &ackNumber, bool scoreboardUpda
               NewAck (ackNumber, true);
               m_tcb->m_cWnd = m_tcb->m_ssThresh.Get ();
               m_recoveryOps->ExitRecovery (m_tcb);
+              if (m_rackTlp != nullptr)
+                {
+                  m_rackTlp->ExitRecovery ();
+                }
               NS_LOG_DEBUG ("Leaving Fast Recovery; BytesInFlight() = " <<
                             BytesInFlight () << "; cWnd = " << m_tcb->m_cWnd);
             }
@@ -2672,6 +2778,9 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
       return;
     }
 
+  // Control segments must not overtake the data of a pending super-segment
+  FlushGsoSegment ();
+
   Ptr<Packet> p = Create<Packet> ();
   TcpHeader header;
   SequenceNumber32 s = m_tcb->m_nextTxSequence;
@@ -2847,7 +2956,11 @@ TcpSocketBase::SetupEndpoint ()
       return -1;
     }
   NS_LOG_LOGIC ("Route exists");
-  m_endPoint->SetLocalAddress (route->GetSource ());
+  // Keep the local address chosen by Bind (), e.g., by an MPTCP subflow
+  if (m_endPoint->GetLocalAddress () == Ipv4Address::GetAny ())
+    {
+      m_endPoint->SetLocalAddress (route->GetSource ());
+    }
   return 0;
 }
 
@@ -3134,8 +3247,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
   if (m_endPoint)
     {
-      m_tcp->SendPacket (p, header, m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), m_boundnetdevice);
+      SendSegment (p, header);
       NS_LOG_DEBUG ("Send segment of size " << sz << " with remaining data " <<
                     remainingData << " via TcpL4Protocol to " <<  m_endPoint->GetPeerAddress () <<
                     ". Header " << header);
@@ -3168,6 +3280,66 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   return sz;
 }
 
+void
+TcpSocketBase::SendSegment (Ptr<Packet> p, const TcpHeader &header)
+{
+  NS_LOG_FUNCTION (this << p << header);
+
+  if (!m_gsoBatching)
+    {
+      m_tcp->SendPacket (p, header, m_endPoint->GetLocalAddress (),
+                         m_endPoint->GetPeerAddress (), m_boundnetdevice);
+      return;
+    }
+
+  if (m_gsoPacket != nullptr)
+    {
+      // All the segments but the last one must be full-sized and contiguous,
+      // and nothing can follow a FIN or precede a CWR
+      uint32_t pending = m_gsoPacket->GetSize ();
+      if (m_gsoHeader.GetSequenceNumber () + pending == header.GetSequenceNumber ()
+          && pending % m_tcb->m_segmentSize == 0
+          && pending + p->GetSize () <= m_gsoMaxSize
+          && (m_gsoHeader.GetFlags () & TcpHeader::FIN) == 0
+          && (header.GetFlags () & TcpHeader::CWR) == 0)
+        {
+          m_gsoPacket->AddAtEnd (p);
+          m_gsoHeader.SetFlags (m_gsoHeader.GetFlags () | (header.GetFlags () & TcpHeader::FIN));
+          return;
+        }
+      FlushGsoSegment ();
+    }
+
+  // The segment has been passed to the Tx trace, which may keep it: grow a
+  // copy of it, so that the traced packet is not modified
+  m_gsoPacket = p->Copy ();
+  m_gsoHeader = header;
+}
+
+void
+TcpSocketBase::FlushGsoSegment (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_gsoPacket == nullptr)
+    {
+      return;
+    }
+
+  if (m_gsoPacket->GetSize () > m_tcb->m_segmentSize)
+    {
+      TcpGsoTag gsoTag;
+      gsoTag.SetSegmentSize (static_cast<uint16_t> (m_tcb->m_segmentSize));
+      m_gsoPacket->AddPacketTag (gsoTag);
+      NS_LOG_DEBUG ("Send GSO super-segment of size " << m_gsoPacket->GetSize ());
+    }
+
+  Ptr<Packet> p = m_gsoPacket;
+  m_gsoPacket = nullptr;
+  m_tcp->SendPacket (p, m_gsoHeader, m_endPoint->GetLocalAddress (),
+                     m_endPoint->GetPeerAddress (), m_boundnetdevice);
+}
+
 void
 TcpSocketBase::UpdateRttHistory (const SequenceNumber32 &seq, uint32_t sz,
                                  bool isRetransmission)
@@ -3211,6 +3383,10 @@ TcpSocketBase::SendPendingData (bool withAck)
   uint32_t nPacketsSent = 0;
   uint32_t availableWindow = AvailableWindow ();
 
+  // With GSO, consecutive segments are coalesced into super-segments which
+  // are split by the traffic control layer (IPv4 only)
+  m_gsoBatching = m_gsoMaxSize > m_tcb->m_segmentSize && m_endPoint != nullptr;
+
   // RFC 6675, Section (C)
   // If cwnd - pipe >= 1 SMSS, the sender SHOULD transmit one or more
   // segments as follows:
@@ -3337,6 +3513,17 @@ TcpSocketBase::SendPendingData (bool withAck)
       // loop again!
     }
 
+  if (m_gsoBatching)
+    {
+      FlushGsoSegment ();
+      m_gsoBatching = false;
+    }
+
+  if (nPacketsSent > 0 && m_rackTlp != nullptr && !m_tlpEvent.IsRunning ())
+    {
+      ScheduleLossProbe ();
+    }
+
   if (nPacketsSent > 0)
     {
       if (!m_sackEnabled)
@@ -3679,6 +3866,9 @@ TcpSocketBase::ReTxTimeout ()
     }
 
   uint32_t inFlightBeforeRto = BytesInFlight ();
+  m_rackEvent.Cancel ();
+  m_tlpEvent.Cancel ();
+  m_tlpOutstanding = false;
   bool resetSack = !m_sackEnabled; // Reset SACK information if SACK is not enabled.
                                    // The information in the TcpTxBuffer is guessed, in this case.
 
@@ -3881,6 +4071,133 @@ TcpSocketBase::DoRetransmit ()
   NS_ASSERT (sz > 0);
 }
 
+void
+TcpSocketBase::SegmentSacked (TcpTxItem *item)
+{
+  m_rateOps->SkbDelivered (item);
+  if (m_rackTlp != nullptr)
+    {
+      m_rackTlp->UpdateStats (item);
+    }
+}
+
+void
+TcpSocketBase::SegmentAcked (TcpTxItem *item)
+{
+  m_rateOps->SkbDelivered (item);
+  // A segment SACKed before has already been accounted for
+  if (m_rackTlp != nullptr && !item->IsSacked ())
+    {
+      m_rackTlp->UpdateStats (item);
+    }
+}
+
+uint32_t
+TcpSocketBase::RackDetectLoss (void)
+{
+  NS_LOG_FUNCTION (this);
+  bool inRecovery = m_tcb->m_congState == TcpSocketState::CA_RECOVERY;
+  bool dupThreshReached = m_txBuffer->GetSacked () >= m_retxThresh * m_tcb->m_segmentSize;
+  uint32_t lost = m_rackTlp->DetectLoss (m_txBuffer, m_rtt->GetEstimate (),
+                                         inRecovery, dupThreshReached);
+
+  m_rackEvent.Cancel ();
+  Time timeout = m_rackTlp->GetReorderTimeout ();
+  if (timeout.IsStrictlyPositive ())
+    {
+      NS_LOG_LOGIC (this << " Schedule RackTimeout in " << timeout.As (Time::US));
+      m_rackEvent = Simulator::Schedule (timeout, &TcpSocketBase::RackTimeout, this);
+    }
+  return lost;
+}
+
+void
+TcpSocketBase::RackEnterRecovery (uint32_t currentDelivered)
+{
+  NS_LOG_FUNCTION (this << currentDelivered);
+  // As for the duplicate ACKs, do not start a new recovery phase before
+  // the previous one is over (RFC 6675, Section 5.1)
+  if ((m_tcb->m_congState == TcpSocketState::CA_OPEN
+       || m_tcb->m_congState == TcpSocketState::CA_DISORDER)
+      && ((m_highRxAckMark >= m_recover) || !m_recoverActive))
+    {
+      EnterRecovery (currentDelivered);
+      NS_ASSERT (m_tcb->m_congState == TcpSocketState::CA_RECOVERY);
+    }
+}
+
+void
+TcpSocketBase::RackTimeout (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (RackDetectLoss () > 0)
+    {
+      RackEnterRecovery (0);
+      SendPendingData (m_connected);
+    }
+}
+
+void
+TcpSocketBase::ScheduleLossProbe (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tlpEvent.Cancel ();
+
+  // RFC 8985, Section 7.2: a probe is scheduled in the open state, when
+  // data are in flight and no probe is outstanding
+  uint32_t bytesInFlight = BytesInFlight ();
+  if (!m_rackTlp->IsTlpEnabled () || m_tlpOutstanding || bytesInFlight == 0
+      || m_tcb->m_congState != TcpSocketState::CA_OPEN)
+    {
+      return;
+    }
+  Time pto = m_rackTlp->GetProbeTimeout (m_rtt->GetEstimate (), bytesInFlight,
+                                         m_tcb->m_segmentSize);
+  if (m_retxEvent.IsRunning () && pto >= Simulator::GetDelayLeft (m_retxEvent))
+    {
+      // The retransmission timeout expires first
+      return;
+    }
+  NS_LOG_LOGIC (this << " Schedule TlpTimeout in " << pto.As (Time::US));
+  m_tlpEvent = Simulator::Schedule (pto, &TcpSocketBase::TlpTimeout, this);
+}
+
+void
+TcpSocketBase::TlpTimeout (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_tcb->m_congState != TcpSocketState::CA_OPEN || BytesInFlight () == 0
+      || m_state == CLOSED || m_state == TIME_WAIT)
+    {
+      return;
+    }
+
+  // RFC 8985, Section 7.3: send one segment of new data if the receiver
+  // window allows, otherwise retransmit the last segment sent
+  SequenceNumber32 highTxMark = m_tcb->m_highTxMark;
+  SequenceNumber32 rWndEnd = m_highRxAckMark + SequenceNumber32 (m_rWnd);
+  uint32_t s = 0;
+  if (rWndEnd > highTxMark)
+    {
+      s = std::min (m_tcb->m_segmentSize, m_txBuffer->SizeFromSequence (highTxMark));
+      s = std::min (s, static_cast<uint32_t> (rWndEnd - highTxMark));
+    }
+  SequenceNumber32 seq = highTxMark;
+  if (s == 0)
+    {
+      seq = std::max (m_txBuffer->HeadSequence (),
+                      highTxMark - static_cast<int32_t> (m_tcb->m_segmentSize));
+      s = static_cast<uint32_t> (highTxMark - seq);
+    }
+  NS_LOG_DEBUG ("Tail loss probe of " << s << " bytes from " << seq);
+
+  m_tlpOutstanding = true;
+  // The retransmission timer is restarted by SendDataPacket
+  m_retxEvent.Cancel ();
+  m_tcb->m_nextTxSequence = seq;
+  m_tcb->m_nextTxSequence += SendDataPacket (seq, s, true);
+}
+
 void
 TcpSocketBase::CancelAllTimers ()
 {
@@ -3891,6 +4208,8 @@ TcpSocketBase::CancelAllTimers ()
   m_timewaitEvent.Cancel ();
   m_sendPendingDataEvent.Cancel ();
   m_pacingTimer.Cancel ();
+  m_rackEvent.Cancel ();
+  m_tlpEvent.Cancel ();
 }
 
 /* Move TCP to Time_Wait state and schedule a transition to Closed state */
@@ -4164,7 +4483,7 @@ TcpSocketBase::ProcessOptionSack (const Ptr<const TcpOption> option)
   NS_LOG_FUNCTION (this << option);
 
   Ptr<const TcpOptionSack> s = DynamicCast<const TcpOptionSack> (option);
-  return m_txBuffer->Update (s->GetSackList (), MakeCallback (&TcpRateOps::SkbDelivered, m_rateOps));
+  return m_txBuffer->Update (s->GetSackList (), MakeCallback (&TcpSocketBase::SegmentSacked, this));
 }
 
 void
@@ -4351,67 +4670,26 @@ TcpSocketBase::SetRetxThresh (uint32_t retxThresh)
 }
 
 void
-TcpSocketBase::UpdatePacingRateTrace (DataRate oldValue, DataRate newValue)
+TcpSocketBase::SetRackTlp (bool enabled)
 {
-  m_pacingRateTrace (oldValue, newValue);
-}
-
-void
-TcpSocketBase::UpdateCwnd (uint32_t oldValue, uint32_t newValue)
-{
-  m_cWndTrace (oldValue, newValue);
-}
-
-void
-TcpSocketBase::UpdateCwndInfl (uint32_t oldValue, uint32_t newValue)
-{
-  m_cWndInflTrace (oldValue, newValue);
-}
-
-void
-TcpSocketBase::UpdateSsThresh (uint32_t oldValue, uint32_t newValue)
-{
-  m_ssThTrace (oldValue, newValue);
-}
-
-void
-TcpSocketBase::UpdateCongState (TcpSocketState::TcpCongState_t oldValue,
-                                TcpSocketState::TcpCongState_t newValue)
-{
-  m_congStateTrace (oldValue, newValue);
-}
-
- void
-TcpSocketBase::UpdateEcnState (TcpSocketState::EcnState_t oldValue,
-                                TcpSocketState::EcnState_t newValue)
-{
-  m_ecnStateTrace (oldValue, newValue);
-}
-
-void
-TcpSocketBase::UpdateNextTxSequence (SequenceNumber32 oldValue,
-                                     SequenceNumber32 newValue)
-
-{
-  m_nextTxSequenceTrace (oldValue, newValue);
-}
-
-void
-TcpSocketBase::UpdateHighTxMark (SequenceNumber32 oldValue, SequenceNumber32 newValue)
-{
-  m_highTxMarkTrace (oldValue, newValue);
-}
-
-void
-TcpSocketBase::UpdateBytesInFlight (uint32_t oldValue, uint32_t newValue)
-{
-  m_bytesInFlightTrace (oldValue, newValue);
+  NS_LOG_FUNCTION (this << enabled);
+  if (enabled && m_rackTlp == nullptr)
+    {
+      m_rackTlp = CreateObject<TcpRackTlp> ();
+    }
+  else if (!enabled)
+    {
+      m_rackTlp = nullptr;
+      m_rackEvent.Cancel ();
+      m_tlpEvent.Cancel ();
+    }
+  m_txBuffer->SetDupAckLossMarking (!enabled);
 }
 
-void
-TcpSocketBase::UpdateRtt (Time oldValue, Time newValue)
+bool
+TcpSocketBase::GetRackTlp (void) const
 {
-  m_lastRttTrace (oldValue, newValue);
+  return m_rackTlp != nullptr;
 }
 
 void
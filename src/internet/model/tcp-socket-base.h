@@ -50,6 +50,8 @@ class TcpOption;
 class Ipv4Interface;
 class Ipv6Interface;
 class TcpRateOps;
+class TcpRackTlp;
+class TcpTxItem;
 
 /**
  * \ingroup tcp
@@ -190,6 +192,16 @@ public:
  * of sent packet is set as lost entirely, and the transmission is re-started
  * from the SND.UNA sequence number.
  *
+ * RACK-TLP
+ * --------
+ *
+ * With the RackTlp attribute (and SACK), the lost segments are detected by
+ * TcpRackTlp, from the time elapsed since their transmission, rather than
+ * after ReTxThreshold duplicate ACKs: after each ACK, RackDetectLoss marks the
+ * lost segments in the TcpTxBuffer and, if any, the socket enters the fast
+ * recovery. The RackTimeout and TlpTimeout methods manage the reordering
+ * timer and the tail loss probes.
+ *
  * Options management
  * ------------------
  *
@@ -318,126 +330,16 @@ public:
   uint32_t GetRetxThresh (void) const { return m_retxThresh; }
 
   /**
-   * \brief Callback pointer for pacing rate trace chaining
-   */
-  TracedCallback<DataRate, DataRate>  m_pacingRateTrace;
-
-  /**
-   * \brief Callback pointer for cWnd trace chaining
-   */
-  TracedCallback<uint32_t, uint32_t> m_cWndTrace;
-
-  /**
-   * \brief Callback pointer for cWndInfl trace chaining
-   */
-  TracedCallback<uint32_t, uint32_t> m_cWndInflTrace;
-
-  /**
-   * \brief Callback pointer for ssTh trace chaining
-   */
-  TracedCallback<uint32_t, uint32_t> m_ssThTrace;
-
-  /**
-   * \brief Callback pointer for congestion state trace chaining
-   */
-  TracedCallback<TcpSocketState::TcpCongState_t, TcpSocketState::TcpCongState_t> m_congStateTrace;
-
-   /**
-   * \brief Callback pointer for ECN state trace chaining
-   */
-  TracedCallback<TcpSocketState::EcnState_t, TcpSocketState::EcnState_t> m_ecnStateTrace;
-
-  /**
-   * \brief Callback pointer for high tx mark chaining
-   */
-  TracedCallback <SequenceNumber32, SequenceNumber32> m_highTxMarkTrace;
-
-  /**
-   * \brief Callback pointer for next tx sequence chaining
-   */
-  TracedCallback<SequenceNumber32, SequenceNumber32> m_nextTxSequenceTrace;
-
-  /**
-   * \brief Callback pointer for bytesInFlight trace chaining
-   */
-  TracedCallback<uint32_t, uint32_t> m_bytesInFlightTrace;
-
-  /**
-   * \brief Callback pointer for RTT trace chaining
-   */
-  TracedCallback<Time, Time> m_lastRttTrace;
-
-  /**
-   * \brief Callback function to hook to TcpSocketState pacing rate
-   * \param oldValue old pacing rate value
-   * \param newValue new pacing rate value
-   */
-  void UpdatePacingRateTrace (DataRate oldValue, DataRate newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState congestion window
-   * \param oldValue old cWnd value
-   * \param newValue new cWnd value
-   */
-  void UpdateCwnd (uint32_t oldValue, uint32_t newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState inflated congestion window
-   * \param oldValue old cWndInfl value
-   * \param newValue new cWndInfl value
-   */
-  void UpdateCwndInfl (uint32_t oldValue, uint32_t newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState slow start threshold
-   * \param oldValue old ssTh value
-   * \param newValue new ssTh value
-   */
-  void UpdateSsThresh (uint32_t oldValue, uint32_t newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState congestion state
-   * \param oldValue old congestion state value
-   * \param newValue new congestion state value
-   */
-  void UpdateCongState (TcpSocketState::TcpCongState_t oldValue,
-                        TcpSocketState::TcpCongState_t newValue);
-
-   /**
-   * \brief Callback function to hook to EcnState state
-   * \param oldValue old ecn state value
-   * \param newValue new ecn state value
-   */
-  void UpdateEcnState (TcpSocketState::EcnState_t oldValue,
-                        TcpSocketState::EcnState_t newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState high tx mark
-   * \param oldValue old high tx mark
-   * \param newValue new high tx mark
+   * \brief Enable or disable the RACK-TLP loss detection
+   * \param enabled true to detect the lost segments with TcpRackTlp
    */
-  void UpdateHighTxMark (SequenceNumber32 oldValue, SequenceNumber32 newValue);
+  void SetRackTlp (bool enabled);
 
   /**
-   * \brief Callback function to hook to TcpSocketState next tx sequence
-   * \param oldValue old nextTxSeq value
-   * \param newValue new nextTxSeq value
+   * \brief Check whether the RACK-TLP loss detection is enabled
+   * \return true if the lost segments are detected with TcpRackTlp
    */
-  void UpdateNextTxSequence (SequenceNumber32 oldValue, SequenceNumber32 newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState bytes inflight
-   * \param oldValue old bytesInFlight value
-   * \param newValue new bytesInFlight value
-   */
-  void UpdateBytesInFlight (uint32_t oldValue, uint32_t newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState rtt
-   * \param oldValue old rtt value
-   * \param newValue new rtt value
-   */
-  void UpdateRtt (Time oldValue, Time newValue);
+  bool GetRackTlp (void) const;
 
   /**
    * \brief Install a congestion control algorithm on this socket
@@ -778,6 +680,20 @@ protected:
    */
   virtual uint32_t SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool withAck);
 
+  /**
+   * \brief Hand a data segment to TcpL4Protocol, or append it to the
+   *        pending GSO super-segment if segmentation offload is active
+   *
+   * \param p the segment payload
+   * \param header the TCP header of the segment
+   */
+  void SendSegment (Ptr<Packet> p, const TcpHeader &header);
+
+  /**
+   * \brief Send the pending GSO super-segment (if any) to TcpL4Protocol
+   */
+  void FlushGsoSegment (void);
+
   /**
    * \brief Send a empty packet that carries a flag, e.g., ACK
    *
@@ -870,6 +786,23 @@ protected:
    */
   void ProcessEstablished (Ptr<Packet> packet, const TcpHeader& tcpHeader); // Received a packet upon ESTABLISHED state
 
+  /**
+   * \brief Header prediction fast path for ESTABLISHED state.
+   *
+   * This function is mimicking the fast path of tcp_rcv_established() in
+   * tcp_input.c in Linux kernel. If the connection is in steady state
+   * (open congestion state, no persist timer, unchanged window) and the
+   * segment is either a pure ACK of new data or the next in-order data
+   * segment of a connection with nothing to send, the segment is processed
+   * without the generic option, state and flag handling of DoForwardUp.
+   * The outcome is the same as with the slow path.
+   *
+   * \param packet the packet, TCP header removed
+   * \param tcpHeader the packet's TCP header
+   * \return false (and nothing done) if the segment has to take the slow path
+   */
+  bool ProcessEstablishedFast (Ptr<Packet> packet, const TcpHeader& tcpHeader);
+
   /**
    * \brief Received a packet upon LISTEN state.
    *
@@ -1084,6 +1017,48 @@ protected:
    */
   void DoRetransmit (void);
 
+  /**
+   * \brief Account for a segment newly SACKed
+   * \param item the SACKed segment
+   */
+  void SegmentSacked (TcpTxItem *item);
+
+  /**
+   * \brief Account for a segment cumulatively ACKed
+   * \param item the ACKed segment
+   */
+  void SegmentAcked (TcpTxItem *item);
+
+  /**
+   * \brief Mark the lost segments with RACK and (re)schedule the reordering
+   * timer
+   * \return the number of bytes newly marked as lost
+   */
+  uint32_t RackDetectLoss (void);
+
+  /**
+   * \brief Enter the fast recovery after RACK detected a loss, unless already
+   * recovering
+   * \param currentDelivered Currently (S)ACKed bytes
+   */
+  void RackEnterRecovery (uint32_t currentDelivered);
+
+  /**
+   * \brief Reordering timer expiration: a segment left its reordering window
+   */
+  void RackTimeout (void);
+
+  /**
+   * \brief Schedule a tail loss probe, if allowed, in place of the pending one
+   */
+  void ScheduleLossProbe (void);
+
+  /**
+   * \brief Tail loss probe expiration: send new data or retransmit the last
+   * segment
+   */
+  void TlpTimeout (void);
+
   /** \brief Add options to TcpHeader
    *
    * Test each option, and if it is enabled on our side, add it
@@ -1091,7 +1066,7 @@ protected:
    *
    * \param tcpHeader TcpHeader to add options to
    */
-  void AddOptions (TcpHeader& tcpHeader);
+  virtual void AddOptions (TcpHeader& tcpHeader);
 
   /**
    * \brief Read TCP options before Ack processing
@@ -1243,6 +1218,15 @@ protected:
   SequenceNumber32 GetHighRxAck (void) const;
 
 protected:
+  /**
+   * \brief Forward the socket-level congestion trace sources to the
+   * TcpSocketState of the socket
+   *
+   * Sinks are connected directly to the TcpSocketState traced values, so
+   * updating them costs nothing beyond a branch when nobody listens.
+   */
+  class TcbTraceSourceAccessor;
+
   // Counters and events
   EventId           m_retxEvent     {}; //!< Retransmission event
   EventId           m_lastAckEvent  {}; //!< Last ACK timeout event
@@ -1344,6 +1328,20 @@ protected:
   // Pacing related variable
   Timer m_pacingTimer {Timer::CANCEL_ON_DESTROY}; //!< Pacing Event
 
+  bool m_headerPrediction {true};     //!< Use the fast path for established connections
+
+  // RACK-TLP loss detection
+  Ptr<TcpRackTlp> m_rackTlp;                 //!< RACK-TLP state (null if disabled)
+  EventId         m_rackEvent      {};        //!< Reordering timer event
+  EventId         m_tlpEvent       {};        //!< Tail loss probe event
+  bool            m_tlpOutstanding {false};   //!< A probe has been sent and no ACK received since
+
+  // Generic segmentation offload
+  uint32_t    m_gsoMaxSize  {0};       //!< Max size of a GSO super-segment (0 disables GSO)
+  bool        m_gsoBatching {false};   //!< True while SendPendingData is building super-segments
+  Ptr<Packet> m_gsoPacket   {nullptr}; //!< Payload of the pending super-segment
+  TcpHeader   m_gsoHeader;             //!< Header of the pending super-segment
+
   // Parameters related to Explicit Congestion Notification
   TracedValue<SequenceNumber32> m_ecnEchoSeq {0};      //!< Sequence number of the last received ECN Echo
   TracedValue<SequenceNumber32> m_ecnCESeq   {0};      //!< Sequence number of the last received Congestion Experienced
@@ -136,6 +136,12 @@ TcpTxBuffer::SetDupAckThresh (uint32_t dupAckThresh)
   m_dupAckThresh = dupAckThresh;
 }
 
+void
+TcpTxBuffer::SetDupAckLossMarking (bool enabled)
+{
+  m_dupAckLossMarking = enabled;
+}
+
 void
 TcpTxBuffer::SetSegmentSize (uint32_t segmentSize)
 {
@@ -870,7 +876,10 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
   if (bytesSacked > 0)
     {
       NS_ASSERT_MSG (m_highestSack.first != m_sentList.end(), "Buffer status: " << *this);
-      UpdateLostCount ();
+      if (m_dupAckLossMarking)
+        {
+          UpdateLostCount ();
+        }
     }
 
   NS_ASSERT ((*(m_sentList.begin ()))->m_sacked == false);
@@ -1387,6 +1396,36 @@ TcpTxBuffer::MarkHeadAsLost ()
   ConsistencyCheck ();
 }
 
+uint32_t
+TcpTxBuffer::MarkLost (const Callback<bool, const TcpTxItem *> &isLost)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t lost = 0;
+  for (TcpTxItem *item : m_sentList)
+    {
+      if (item->m_sacked || (item->m_lost && !item->m_retrans) || !isLost (item))
+        {
+          continue;
+        }
+      uint32_t size = item->m_packet->GetSize ();
+      if (item->m_retrans)
+        {
+          // The retransmission is lost as well
+          item->m_retrans = false;
+          m_retrans -= size;
+        }
+      if (!item->m_lost)
+        {
+          item->m_lost = true;
+          m_lostOut += size;
+        }
+      lost += size;
+    }
+  NS_LOG_INFO ("Marked " << lost << " bytes as lost, status: " << *this);
+  ConsistencyCheck ();
+  return lost;
+}
+
 void
 TcpTxBuffer::AddRenoSack (void)
 {
@@ -190,6 +190,16 @@ public:
    */
   void SetDupAckThresh (uint32_t dupAckThresh);
 
+  /**
+   * \brief Enable or disable the loss marking based on the DupAckThresh
+   *
+   * When a time-based loss detection (e.g., TcpRackTlp) marks the lost
+   * segments through MarkLost, the SACK processing must not mark a segment
+   * as lost as soon as DupAckThresh segments above it are SACKed.
+   * \param enabled true if the SACK processing marks the lost segments
+   */
+  void SetDupAckLossMarking (bool enabled);
+
   /**
    * \brief Set the segment size
    * \param segmentSize the segment size
@@ -380,6 +390,19 @@ public:
    */
   void MarkHeadAsLost ();
 
+  /**
+   * \brief Mark the sent segments as lost according to a loss detection
+   * algorithm
+   *
+   * The callback is invoked on each sent segment which is neither SACKed nor
+   * marked as lost and waiting for its retransmission. A retransmitted
+   * segment found lost again loses its retransmitted flag, so that it can be
+   * retransmitted once more.
+   * \param isLost callback returning true if the segment is lost
+   * \return the number of bytes newly marked as lost
+   */
+  uint32_t MarkLost (const Callback<bool, const TcpTxItem *> &isLost);
+
   /**
    * \brief Emulate SACKs for SACKless connection: account for a new dupack.
    *
@@ -616,6 +639,7 @@ private:
   uint32_t m_retrans   {0}; //!< Number of retransmitted bytes
 
   uint32_t m_dupAckThresh {0}; //!< Duplicate Ack threshold from TcpSocketBase
+  bool     m_dupAckLossMarking {true}; //!< Whether the SACKs mark the lost segments
   uint32_t m_segmentSize {0}; //!< Segment size from TcpSocketBase
   bool     m_renoSack {false}; //!< Indicates if AddRenoSack was called
   bool     m_sackEnabled {true}; //!< Indicates if SACK is enabled on this connection
@@ -64,6 +64,12 @@ TcpTxItem::GetSeqSize (void) const
   return m_packet && m_packet->GetSize () > 0 ? m_packet->GetSize () : 1;
 }
 
+const SequenceNumber32 &
+TcpTxItem::GetStartSeq (void) const
+{
+  return m_startSeq;
+}
+
 bool
 TcpTxItem::IsSacked (void) const
 {
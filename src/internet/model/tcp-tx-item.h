@@ -48,6 +48,12 @@ public:
    */
   uint32_t GetSeqSize (void) const;
 
+  /**
+   * \brief Get the sequence number of the first byte of the item
+   * \return the sequence number of the item (if transmitted)
+   */
+  const SequenceNumber32 & GetStartSeq (void) const;
+
   /**
    * \brief Is the item sacked?
    * \return true if the item is sacked, false otherwise
@@ -36,6 +36,7 @@
 #include "ns3/ipv6-packet-info-tag.h"
 #include "udp-socket-impl.h"
 #include "udp-l4-protocol.h"
+#include "udp-header.h"
 #include "ipv4-end-point.h"
 #include "ipv6-end-point.h"
 #include <limits>
@@ -618,7 +619,14 @@ UdpSocketImpl::DoSendTo (Ptr<Packet> p, Ipv4Address dest, uint16_t port, uint8_t
       Ptr<Ipv4Route> route;
       Ptr<NetDevice> oif = m_boundnetdevice; //specify non-zero if bound to a specific device
       // TBD-- we could cache the route and just check its validity
-      route = ipv4->GetRoutingProtocol ()->RouteOutput (p, header, oif, errno_); 
+      // The UDP header is only added by UdpL4Protocol: add it while the route
+      // is looked up, so that the routing protocol finds the ports
+      UdpHeader udpHeader;
+      udpHeader.SetSourcePort (m_endPoint->GetLocalPort ());
+      udpHeader.SetDestinationPort (port);
+      p->AddHeader (udpHeader);
+      route = ipv4->GetRoutingProtocol ()->RouteOutput (p, header, oif, errno_);
+      p->RemoveHeader (udpHeader);
       if (route != 0)
         {
           NS_LOG_LOGIC ("Route exists");
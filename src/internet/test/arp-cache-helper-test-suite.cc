@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/arp-cache-helper.h"
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/socket.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that populating the ARP caches (or bypassing ARP) before the
+ * simulation starts suppresses the ARP exchange triggered by the first
+ * packet sent to a neighbor.
+ */
+class ArpCacheHelperTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param nNodes the number of nodes attached to the channel
+   * \param populate whether to populate the ARP caches
+   * \param bypass whether to bypass ARP on channels with two devices
+   */
+  ArpCacheHelperTestCase (uint32_t nNodes, bool populate, bool bypass);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Count the ARP packets received by a node.
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \param to the destination address
+   * \param type the packet type
+   */
+  void ArpReceived (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                    const Address &from, const Address &to, NetDevice::PacketType type);
+  /**
+   * Send a UDP packet.
+   * \param socket the sending socket
+   */
+  void SendPacket (Ptr<Socket> socket);
+  /**
+   * Receive the UDP packets.
+   * \param socket the receiving socket
+   */
+  void UdpReceived (Ptr<Socket> socket);
+
+  uint32_t m_nNodes;     //!< Number of nodes attached to the channel
+  bool m_populate;       //!< Whether to populate the ARP caches
+  bool m_bypass;         //!< Whether to bypass ARP
+  uint32_t m_arpPackets; //!< Number of ARP packets received
+  uint32_t m_udpPackets; //!< Number of UDP packets received
+};
+
+ArpCacheHelperTestCase::ArpCacheHelperTestCase (uint32_t nNodes, bool populate, bool bypass)
+  : TestCase ("ARP caches of " + std::to_string (nNodes) + " nodes, populate "
+              + std::to_string (populate) + ", bypass " + std::to_string (bypass)),
+    m_nNodes (nNodes),
+    m_populate (populate),
+    m_bypass (bypass),
+    m_arpPackets (0),
+    m_udpPackets (0)
+{
+}
+
+void
+ArpCacheHelperTestCase::ArpReceived (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                                     const Address &from, const Address &to,
+                                     NetDevice::PacketType type)
+{
+  m_arpPackets++;
+}
+
+void
+ArpCacheHelperTestCase::SendPacket (Ptr<Socket> socket)
+{
+  socket->Send (Create<Packet> (100));
+}
+
+void
+ArpCacheHelperTestCase::UdpReceived (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_udpPackets++;
+    }
+}
+
+void
+ArpCacheHelperTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (m_nNodes);
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices = simple.Install (nodes);
+
+  InternetStackHelper stack;
+  stack.SetIpv6StackInstall (false);
+  stack.Install (nodes);
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  if (m_populate)
+    {
+      ArpCacheHelper arp;
+      arp.SetPointToPointBypass (m_bypass);
+      arp.PopulateArpCaches ();
+    }
+
+  for (uint32_t i = 0; i < m_nNodes; i++)
+    {
+      nodes.Get (i)->RegisterProtocolHandler (MakeCallback (&ArpCacheHelperTestCase::ArpReceived, this),
+                                              ArpL3Protocol::PROT_NUMBER, devices.Get (i));
+    }
+
+  Ipv4Address destination = interfaces.GetAddress (m_nNodes - 1);
+  Ptr<Socket> rxSocket = Socket::CreateSocket (nodes.Get (m_nNodes - 1), UdpSocketFactory::GetTypeId ());
+  rxSocket->Bind (InetSocketAddress (destination, 1234));
+  rxSocket->SetRecvCallback (MakeCallback (&ArpCacheHelperTestCase::UdpReceived, this));
+  Ptr<Socket> txSocket = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  txSocket->Connect (InetSocketAddress (destination, 1234));
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (Seconds (1), &ArpCacheHelperTestCase::SendPacket, this, txSocket);
+    }
+
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_udpPackets, 3, "The UDP packets were not received");
+  if (!m_populate)
+    {
+      NS_TEST_EXPECT_MSG_GT (m_arpPackets, 0, "ARP was expected to resolve the destination");
+      Simulator::Destroy ();
+      return;
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_arpPackets, 0, "No ARP packet was expected");
+
+  for (uint32_t i = 0; i < m_nNodes; i++)
+    {
+      Ptr<Ipv4L3Protocol> ipv4 = nodes.Get (i)->GetObject<Ipv4L3Protocol> ();
+      Ptr<Ipv4Interface> interface = ipv4->GetInterface (interfaces.Get (i).second);
+      Ptr<ArpCache> cache = interface->GetArpCache ();
+      for (uint32_t j = 0; j < m_nNodes; j++)
+        {
+          ArpCache::Entry *entry = cache->Lookup (interfaces.GetAddress (j));
+          if (i == j || (m_bypass && m_nNodes == 2))
+            {
+              NS_TEST_EXPECT_MSG_EQ ((entry == 0), true, "Unexpected ARP cache entry");
+              continue;
+            }
+          NS_TEST_ASSERT_MSG_NE (entry, 0, "Missing ARP cache entry");
+          NS_TEST_EXPECT_MSG_EQ (entry->IsPermanent (), true, "ARP cache entry not permanent");
+          NS_TEST_EXPECT_MSG_EQ (entry->GetMacAddress (), devices.Get (j)->GetAddress (),
+                                 "Wrong MAC address");
+        }
+      Address peer = interface->GetPeerHardwareAddress ();
+      if (m_bypass && m_nNodes == 2)
+        {
+          NS_TEST_EXPECT_MSG_EQ (peer, devices.Get (1 - i)->GetAddress (), "Wrong peer address");
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (peer.IsInvalid (), true, "ARP unexpectedly bypassed");
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief ArpCacheHelper TestSuite
+ */
+class ArpCacheHelperTestSuite : public TestSuite
+{
+public:
+  ArpCacheHelperTestSuite ()
+    : TestSuite ("arp-cache-helper", UNIT)
+  {
+    AddTestCase (new ArpCacheHelperTestCase (4, false, false), TestCase::QUICK);
+    AddTestCase (new ArpCacheHelperTestCase (4, true, false), TestCase::QUICK);
+    AddTestCase (new ArpCacheHelperTestCase (4, true, true), TestCase::QUICK);
+    AddTestCase (new ArpCacheHelperTestCase (2, true, false), TestCase::QUICK);
+    AddTestCase (new ArpCacheHelperTestCase (2, true, true), TestCase::QUICK);
+  }
+};
+
+static ArpCacheHelperTestSuite g_arpCacheHelperTestSuite; //!< Static variable for test initialization
@@ -20,6 +20,10 @@
 #include "ns3/ipv4-address-generator.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-interface-container.h"
 
 using namespace ns3;
 
@@ -279,6 +283,67 @@ IpAddressHelperTestCasev4::DoTeardown (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 address helper AssignLinks Test
+ *
+ * Checks that each link gets its own network, that the interfaces are
+ * returned in the order of the devices and that the helper is left on a new
+ * network.
+ */
+class AssignLinksHelperTestCase : public TestCase
+{
+public:
+  AssignLinksHelperTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+AssignLinksHelperTestCase::AssignLinksHelperTestCase ()
+  : TestCase ("Ipv4AddressHelper AssignLinks test case")
+{
+}
+
+void
+AssignLinksHelperTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  // a chain of three links
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer links;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      links.Add (simple.Install (NodeContainer (nodes.Get (i), nodes.Get (i + 1))));
+    }
+
+  Ipv4AddressHelper ip ("10.1.0.0", "255.255.255.252");
+  Ipv4InterfaceContainer ifc = ip.AssignLinks (links, 2);
+  NS_TEST_ASSERT_MSG_EQ (ifc.GetN (), 6, "Wrong number of interfaces");
+
+  const char *expected[] = {"10.1.0.1", "10.1.0.2", "10.1.0.5", "10.1.0.6", "10.1.0.9", "10.1.0.10"};
+  for (uint32_t i = 0; i < ifc.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (ifc.GetAddress (i), Ipv4Address (expected[i]), "Wrong address of interface " << i);
+      NS_TEST_EXPECT_MSG_EQ (ifc.Get (i).first->GetNetDevice (ifc.Get (i).second), links.Get (i),
+                             "Wrong device of interface " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (ip.NewAddress (), Ipv4Address ("10.1.0.13"), "The helper should be on a new network");
+}
+
+void
+AssignLinksHelperTestCase::DoTeardown (void)
+{
+  Ipv4AddressGenerator::Reset ();
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -299,6 +364,7 @@ Ipv4AddressHelperTestSuite::Ipv4AddressHelperTestSuite ()
   AddTestCase (new AddressAllocatorHelperTestCase (), TestCase::QUICK);
   AddTestCase (new ResetAllocatorHelperTestCase (), TestCase::QUICK);
   AddTestCase (new IpAddressHelperTestCasev4 (), TestCase::QUICK);
+  AddTestCase (new AssignLinksHelperTestCase (), TestCase::QUICK);
 }
 
 static Ipv4AddressHelperTestSuite g_ipv4AddressHelperTestSuite; //!< Static variable for test initialization
@@ -33,6 +33,7 @@
 
 #include "ns3/arp-l3-protocol.h"
 #include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv6.h"
 #include "ns3/icmpv4-l4-protocol.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/ipv4-static-routing.h"
@@ -52,10 +53,14 @@ using namespace ns3;
  * \ingroup tests
  *
  * \brief IPv4 Forwarding Test
+ *
+ * The forwarding node has either the full Internet stack or only the
+ * components installed by InternetStackHelper::SetForwardingOnly.
  */
 class Ipv4ForwardingTest : public TestCase
 {
   Ptr<Packet> m_receivedPacket; //!< Received packet
+  bool m_forwardingOnly;        //!< Install only the forwarding components on the forwarding node
 
   /**
    * \brief Send data.
@@ -72,7 +77,11 @@ class Ipv4ForwardingTest : public TestCase
 
 public:
   virtual void DoRun (void);
-  Ipv4ForwardingTest ();
+  /**
+   * \brief Constructor.
+   * \param forwardingOnly install only the forwarding components on the forwarding node
+   */
+  Ipv4ForwardingTest (bool forwardingOnly);
 
   /**
    * \brief Receive data.
@@ -81,8 +90,9 @@ public:
   void ReceivePkt (Ptr<Socket> socket);
 };
 
-Ipv4ForwardingTest::Ipv4ForwardingTest ()
-  : TestCase ("UDP socket implementation")
+Ipv4ForwardingTest::Ipv4ForwardingTest (bool forwardingOnly)
+  : TestCase (forwardingOnly ? "UDP socket implementation, forwarding-only node" : "UDP socket implementation"),
+    m_forwardingOnly (forwardingOnly)
 {
 }
 
@@ -138,7 +148,19 @@ Ipv4ForwardingTest::DoRun (void)
   // Forwarding Node
   Ptr<Node> fwNode = CreateObject<Node> ();
 
-  internet.Install (fwNode);
+  // The forwarding-only mode disables IPv6 on its own
+  InternetStackHelper fwInternet;
+  if (!m_forwardingOnly)
+    {
+      fwInternet.SetIpv6StackInstall (false);
+    }
+  fwInternet.SetForwardingOnly (m_forwardingOnly);
+  fwInternet.Install (fwNode);
+  NS_TEST_EXPECT_MSG_EQ ((fwNode->GetObject<UdpL4Protocol> () == 0), m_forwardingOnly,
+                         "UDP should only be installed on a full stack");
+  NS_TEST_EXPECT_MSG_EQ ((fwNode->GetObject<Icmpv4L4Protocol> () != 0), true,
+                         "ICMPv4 should always be installed");
+  NS_TEST_EXPECT_MSG_EQ ((fwNode->GetObject<Ipv6> () == 0), true, "IPv6 should not be installed");
   Ptr<SimpleNetDevice> fwDev1, fwDev2;
   { // first interface
     fwDev1 = CreateObject<SimpleNetDevice> ();
@@ -234,7 +256,8 @@ private:
 Ipv4ForwardingTestSuite::Ipv4ForwardingTestSuite ()
   : TestSuite ("ipv4-forwarding", UNIT)
 {
-  AddTestCase (new Ipv4ForwardingTest, TestCase::QUICK);
+  AddTestCase (new Ipv4ForwardingTest (false), TestCase::QUICK);
+  AddTestCase (new Ipv4ForwardingTest (true), TestCase::QUICK);
 }
 
 static Ipv4ForwardingTestSuite g_ipv4forwardingTestSuite; //!< Static variable for test initialization
@@ -42,6 +42,10 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/enum.h"
+#include "ns3/udp-header.h"
+#include <map>
+#include <set>
 
 using namespace ns3;
 
@@ -1244,6 +1248,247 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting ECMP test
+ *
+ * UDP packets are sent from S to R over two equal cost paths:
+ *
+ *          +--B--+
+ *  S -- A -|     |- D -- R
+ *          +--C--+
+ *
+ * In the Hash mode, several flows are sent and all the packets of each flow
+ * must be routed by A on the same path, while both paths must be used, and
+ * the same holds for flows originated by A itself. In the Flowlet mode, a single flow is sent in bursts separated by gaps larger than
+ * the flowlet timeout: all the packets of a burst must be routed on the same
+ * path, while both paths must be used. In the Spray mode, the same flows as in
+ * the Hash mode are sent and consecutive packets of each flow must be routed
+ * on different paths.
+ */
+class Ipv4GlobalRoutingEcmpTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param mode the ECMP mode
+   */
+  Ipv4GlobalRoutingEcmpTestCase (Ipv4GlobalRouting::EcmpMode mode);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Record the path chosen by A for a packet.
+   * \param p the packet, starting with the UDP header
+   * \param header the IPv4 header
+   * \param interface the output interface
+   */
+  void EcmpPath (Ptr<const Packet> p, const Ipv4Header &header, uint32_t interface);
+  /**
+   * \brief Receive a packet.
+   * \param socket The receiving socket.
+   */
+  void ReceivePkt (Ptr<Socket> socket);
+  /**
+   * \brief Send a packet.
+   * \param socket The sending socket.
+   * \param to The address of the receiver.
+   */
+  void SendPkt (Ptr<Socket> socket, Ipv4Address to);
+
+  Ipv4GlobalRouting::EcmpMode m_mode;                 //!< The ECMP mode
+  std::map<uint32_t, std::set<uint32_t> > m_paths;    //!< Interfaces used by each flow or burst
+  std::set<uint32_t> m_interfaces;                    //!< Interfaces used
+  std::map<uint32_t, uint32_t> m_lastInterface;       //!< Interface of the last packet of each flow
+  uint32_t m_repeated;                                //!< Packets routed as the previous one of the flow
+  uint32_t m_received;                                //!< Number of received packets
+};
+
+Ipv4GlobalRoutingEcmpTestCase::Ipv4GlobalRoutingEcmpTestCase (Ipv4GlobalRouting::EcmpMode mode)
+  : TestCase (mode == Ipv4GlobalRouting::ECMP_HASH ? "ECMP with five-tuple hash" :
+              mode == Ipv4GlobalRouting::ECMP_SPRAY ? "ECMP with packet spraying" : "ECMP with flowlets"),
+    m_mode (mode),
+    m_repeated (0),
+    m_received (0)
+{
+}
+
+void
+Ipv4GlobalRoutingEcmpTestCase::EcmpPath (Ptr<const Packet> p, const Ipv4Header &header, uint32_t interface)
+{
+  uint32_t key;
+  if (m_mode != Ipv4GlobalRouting::ECMP_FLOWLET)
+    {
+      // the flow is identified by the source port
+      UdpHeader udpHeader;
+      p->PeekHeader (udpHeader);
+      key = udpHeader.GetSourcePort ();
+    }
+  else
+    {
+      // bursts start every millisecond
+      key = Simulator::Now ().GetMilliSeconds ();
+    }
+  auto last = m_lastInterface.find (key);
+  if (last != m_lastInterface.end () && last->second == interface)
+    {
+      m_repeated++;
+    }
+  m_lastInterface[key] = interface;
+  m_paths[key].insert (interface);
+  m_interfaces.insert (interface);
+}
+
+void
+Ipv4GlobalRoutingEcmpTestCase::ReceivePkt (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+void
+Ipv4GlobalRoutingEcmpTestCase::SendPkt (Ptr<Socket> socket, Ipv4Address to)
+{
+  socket->SendTo (Create<Packet> (100), 0, InetSocketAddress (to, 1234));
+}
+
+void
+Ipv4GlobalRoutingEcmpTestCase::DoRun (void)
+{
+  NodeContainer c;
+  c.Create (6);
+  Ptr<Node> nS = c.Get (0);
+  Ptr<Node> nA = c.Get (1);
+  Ptr<Node> nB = c.Get (2);
+  Ptr<Node> nC = c.Get (3);
+  Ptr<Node> nD = c.Get (4);
+  Ptr<Node> nR = c.Get (5);
+
+  InternetStackHelper internet;
+  internet.Install (c);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4 ("10.1.1.0", "255.255.255.0");
+  std::vector<std::pair<Ptr<Node>, Ptr<Node> > > links = {{nS, nA}, {nA, nB}, {nA, nC},
+                                                          {nB, nD}, {nC, nD}, {nD, nR}};
+  Ipv4InterfaceContainer iDiR;
+  for (auto& link : links)
+    {
+      iDiR = ipv4.Assign (devHelper.Install (NodeContainer (link.first, link.second)));
+      ipv4.NewNetwork ();
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Ptr<Ipv4GlobalRouting> routingA =
+    Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting> (nA->GetObject<Ipv4> ()->GetRoutingProtocol ());
+  routingA->SetAttribute ("EcmpMode", EnumValue (m_mode));
+  routingA->SetAttribute ("EcmpHashSeed", UintegerValue (7));
+  routingA->TraceConnectWithoutContext ("EcmpPath",
+                                        MakeCallback (&Ipv4GlobalRoutingEcmpTestCase::EcmpPath, this));
+
+  Ptr<Socket> rxSocket = nR->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rxSocket->SetRecvCallback (MakeCallback (&Ipv4GlobalRoutingEcmpTestCase::ReceivePkt, this));
+
+  Ipv4Address to = iDiR.GetAddress (1);
+  uint32_t nSent = 0;
+  if (m_mode != Ipv4GlobalRouting::ECMP_FLOWLET)
+    {
+      // 16 flows of 5 packets, interleaved
+      std::vector<Ptr<Socket> > txSockets;
+      for (uint32_t f = 0; f < 16; f++)
+        {
+          txSockets.push_back (nS->GetObject<UdpSocketFactory> ()->CreateSocket ());
+          txSockets.back ()->Bind ();
+        }
+      for (uint32_t i = 0; i < 5; i++)
+        {
+          for (uint32_t f = 0; f < 16; f++)
+            {
+              Simulator::Schedule (Seconds (1) + MicroSeconds (10 * (16 * i + f)),
+                                   &Ipv4GlobalRoutingEcmpTestCase::SendPkt, this, txSockets[f], to);
+              nSent++;
+            }
+        }
+    }
+  else
+    {
+      // 10 bursts of 5 packets, one every millisecond
+      Ptr<Socket> txSocket = nS->GetObject<UdpSocketFactory> ()->CreateSocket ();
+      txSocket->Bind ();
+      for (uint32_t b = 0; b < 10; b++)
+        {
+          for (uint32_t i = 0; i < 5; i++)
+            {
+              Simulator::Schedule (Seconds (1) + MilliSeconds (b) + MicroSeconds (10 * i),
+                                   &Ipv4GlobalRoutingEcmpTestCase::SendPkt, this, txSocket, to);
+              nSent++;
+            }
+        }
+    }
+
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, nSent, "All the packets should be received");
+  NS_TEST_EXPECT_MSG_EQ (m_paths.size (), (m_mode == Ipv4GlobalRouting::ECMP_FLOWLET ? 10 : 16),
+                         "Unexpected number of flows or bursts");
+  if (m_mode == Ipv4GlobalRouting::ECMP_SPRAY)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_repeated, 0, "Consecutive packets of a flow routed on the same path");
+    }
+  else
+    {
+      for (auto& path : m_paths)
+        {
+          NS_TEST_EXPECT_MSG_EQ (path.second.size (), 1, "Packets of flow or burst " << path.first
+                                 << " routed on different paths");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_interfaces.size (), 2, "Both paths should be used");
+
+  if (m_mode == Ipv4GlobalRouting::ECMP_HASH)
+    {
+      // the ports of the packets originated by A are hashed as well
+      m_paths.clear ();
+      m_interfaces.clear ();
+      m_received = 0;
+      std::vector<Ptr<Socket> > txSockets;
+      for (uint32_t f = 0; f < 16; f++)
+        {
+          txSockets.push_back (nA->GetObject<UdpSocketFactory> ()->CreateSocket ());
+          txSockets.back ()->Bind ();
+        }
+      for (uint32_t i = 0; i < 2; i++)
+        {
+          for (uint32_t f = 0; f < 16; f++)
+            {
+              Simulator::Schedule (MicroSeconds (10 * (16 * i + f)),
+                                   &Ipv4GlobalRoutingEcmpTestCase::SendPkt, this, txSockets[f], to);
+            }
+        }
+      Simulator::Stop (Seconds (1));
+      Simulator::Run ();
+
+      NS_TEST_EXPECT_MSG_EQ (m_received, 32, "All the packets originated by A should be received");
+      NS_TEST_EXPECT_MSG_EQ (m_paths.size (), 16, "Unexpected number of flows originated by A");
+      for (auto& path : m_paths)
+        {
+          NS_TEST_EXPECT_MSG_EQ (path.second.size (), 1, "Packets of flow " << path.first
+                                 << " originated by A routed on different paths");
+        }
+      NS_TEST_EXPECT_MSG_EQ (m_interfaces.size (), 2, "Both paths should be used by A");
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1512,9 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingEcmpTestCase (Ipv4GlobalRouting::ECMP_HASH), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingEcmpTestCase (Ipv4GlobalRouting::ECMP_FLOWLET), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingEcmpTestCase (Ipv4GlobalRouting::ECMP_SPRAY), TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,337 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-channel.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/link-failure-helper.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/socket.h"
+#include <sstream>
+#include <set>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that scheduled and random failures bring the interfaces of
+ * both ends of a link down and up at the expected times.
+ */
+class LinkFailureScheduleTestCase : public TestCase
+{
+public:
+  LinkFailureScheduleTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the state of a link.
+   * \param device a device attached to the link
+   * \param up whether the link should be up
+   */
+  void CheckLink (Ptr<NetDevice> device, bool up);
+};
+
+LinkFailureScheduleTestCase::LinkFailureScheduleTestCase ()
+  : TestCase ("Check the scheduled and random link failures")
+{
+}
+
+void
+LinkFailureScheduleTestCase::CheckLink (Ptr<NetDevice> device, bool up)
+{
+  NS_TEST_EXPECT_MSG_EQ (LinkFailureHelper::IsLinkUp (device), up,
+                         "Unexpected link state at " << Simulator::Now ().GetSeconds ());
+  // both ends are in the same state
+  Ptr<Channel> channel = device->GetChannel ();
+  for (uint32_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> nd = channel->GetDevice (i);
+      Ptr<Ipv4> ipv4 = nd->GetNode ()->GetObject<Ipv4> ();
+      NS_TEST_EXPECT_MSG_EQ (ipv4->IsUp (ipv4->GetInterfaceForDevice (nd)), up,
+                             "Unexpected interface state at " << Simulator::Now ().GetSeconds ());
+    }
+}
+
+void
+LinkFailureScheduleTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  NetDeviceContainer link0 = simpleHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1)));
+  NetDeviceContainer link1 = simpleHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2)));
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  ipv4.Assign (link0);
+  ipv4.NewNetwork ();
+  ipv4.Assign (link1);
+
+  LinkFailureHelper failures;
+  failures.ScheduleFailure (link0.Get (1), Seconds (0.3), Seconds (0.6));
+  Simulator::Schedule (Seconds (0.2), &LinkFailureScheduleTestCase::CheckLink, this, link0.Get (0), true);
+  Simulator::Schedule (Seconds (0.4), &LinkFailureScheduleTestCase::CheckLink, this, link0.Get (0), false);
+  Simulator::Schedule (Seconds (0.7), &LinkFailureScheduleTestCase::CheckLink, this, link0.Get (0), true);
+
+  // fail at 1, repair at 1.5, fail at 2.5, repair at 3, and no failure at 4
+  failures.SetTimeToFailure (CreateObjectWithAttributes<ConstantRandomVariable> ("Constant", DoubleValue (1)));
+  failures.SetTimeToRepair (CreateObjectWithAttributes<ConstantRandomVariable> ("Constant", DoubleValue (0.5)));
+  failures.InstallRandomFailures (link1, Seconds (0), Seconds (3.2));
+  double times[] = {0.9, 1.2, 1.7, 2.7, 3.1, 4.5};
+  bool up[] = {true, false, true, false, true, true};
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Simulator::Schedule (Seconds (times[i]), &LinkFailureScheduleTestCase::CheckLink, this,
+                           link1.Get (0), up[i]);
+    }
+
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the routes incrementally updated after links fail and
+ * are repaired are the same as the routes computed from scratch, that the
+ * route updates can be deferred, and that packets are rerouted.  Host h0 is attached to r0 and host h1 to r5, and
+ * the routers are connected by the links r0-r1, r0-r2, r1-r3, r1-r4, r2-r3,
+ * r2-r5, r3-r4 and r4-r5, which provide equal cost paths.
+ */
+class LinkFailureRoutingTestCase : public TestCase
+{
+public:
+  LinkFailureRoutingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \returns the routing table of every node, as a set of strings
+   */
+  std::vector<std::multiset<std::string> > GetRoutes (void) const;
+  /**
+   * Compare the current routes with the routes computed from scratch.
+   * \param step the name of the step
+   */
+  void CheckRoutes (std::string step);
+  /**
+   * Check that the routes are not updated while the updates are deferred,
+   * and are updated when they are resumed.
+   * \param device the device whose interface is set down and up
+   */
+  void CheckDeferredUpdates (Ptr<NetDevice> device);
+  /**
+   * Send a packet from h0 to h1.
+   */
+  void SendPacket (void);
+  /**
+   * Receive the packets.
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  NodeContainer m_nodes;     //!< The nodes
+  Ptr<Socket> m_tx;          //!< The sending socket
+  uint32_t m_sent;           //!< Number of packets sent
+  uint32_t m_received;       //!< Number of packets received
+};
+
+LinkFailureRoutingTestCase::LinkFailureRoutingTestCase ()
+  : TestCase ("Check the routes updated incrementally after link failures and repairs"),
+    m_sent (0),
+    m_received (0)
+{
+}
+
+std::vector<std::multiset<std::string> >
+LinkFailureRoutingTestCase::GetRoutes (void) const
+{
+  std::vector<std::multiset<std::string> > tables;
+  for (uint32_t n = 0; n < m_nodes.GetN (); n++)
+    {
+      Ptr<Ipv4GlobalRouting> gr = m_nodes.Get (n)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::multiset<std::string> table;
+      for (uint32_t i = 0; i < gr->GetNRoutes (); i++)
+        {
+          std::ostringstream oss;
+          oss << *gr->GetRoute (i);
+          table.insert (oss.str ());
+        }
+      tables.push_back (table);
+    }
+  return tables;
+}
+
+void
+LinkFailureRoutingTestCase::CheckRoutes (std::string step)
+{
+  std::vector<std::multiset<std::string> > incremental = GetRoutes ();
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  std::vector<std::multiset<std::string> > full = GetRoutes ();
+  for (uint32_t n = 0; n < m_nodes.GetN (); n++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (incremental[n].size (), full[n].size (),
+                             "Unexpected number of routes of node " << n << " after " << step);
+      NS_TEST_EXPECT_MSG_EQ ((incremental[n] == full[n]), true,
+                             "Unexpected routes of node " << n << " after " << step);
+    }
+}
+
+void
+LinkFailureRoutingTestCase::CheckDeferredUpdates (Ptr<NetDevice> device)
+{
+  std::vector<std::multiset<std::string> > before = GetRoutes ();
+  Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+  uint32_t interface = ipv4->GetInterfaceForDevice (device);
+  GlobalRouteManager::DeferUpdates ();
+  ipv4->SetDown (interface);
+  NS_TEST_EXPECT_MSG_EQ ((GetRoutes () == before), true, "The routes were updated while deferred");
+  GlobalRouteManager::ResumeUpdates ();
+  NS_TEST_EXPECT_MSG_EQ ((GetRoutes () == before), false, "The routes were not updated when resumed");
+  ipv4->SetUp (interface);
+  CheckRoutes ("deferred updates");
+}
+
+void
+LinkFailureRoutingTestCase::SendPacket (void)
+{
+  m_tx->Send (Create<Packet> (100));
+  m_sent++;
+}
+
+void
+LinkFailureRoutingTestCase::Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+void
+LinkFailureRoutingTestCase::DoRun (void)
+{
+  // h0 = 0, r0..r5 = 1..6, h1 = 7
+  m_nodes.Create (8);
+  uint32_t ends[][2] = {{0, 1}, {1, 2}, {1, 3}, {2, 4}, {2, 5}, {3, 4}, {3, 6}, {4, 5}, {5, 6}, {6, 7}};
+  const uint32_t nLinks = sizeof (ends) / sizeof (ends[0]);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  InternetStackHelper internet;
+  internet.Install (m_nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  std::vector<NetDeviceContainer> links;
+  Ipv4InterfaceContainer h1Interface;
+  for (uint32_t i = 0; i < nLinks; i++)
+    {
+      links.push_back (simpleHelper.Install (NodeContainer (m_nodes.Get (ends[i][0]),
+                                                            m_nodes.Get (ends[i][1]))));
+      h1Interface = ipv4.Assign (links.back ());
+      ipv4.NewNetwork ();
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  for (uint32_t n = 0; n < m_nodes.GetN (); n++)
+    {
+      Ptr<Ipv4GlobalRouting> gr = m_nodes.Get (n)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      gr->SetAttribute ("RespondToInterfaceEvents", BooleanValue (true));
+      gr->SetAttribute ("IncrementalUpdates", BooleanValue (true));
+    }
+
+  Ptr<Socket> rx = Socket::CreateSocket (m_nodes.Get (7), UdpSocketFactory::GetTypeId ());
+  rx->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rx->SetRecvCallback (MakeCallback (&LinkFailureRoutingTestCase::Receive, this));
+  m_tx = Socket::CreateSocket (m_nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  m_tx->Connect (InetSocketAddress (h1Interface.GetAddress (1), 1234));
+
+  // links r1-r3 (3), r3-r4 (7), r0-r2 (2), r2-r5 (6) and h0-r0 (0) fail and
+  // are repaired; the routes are not checked (hence not computed from
+  // scratch) after some events, so that several updates accumulate
+  Simulator::Schedule (Seconds (0.5), &LinkFailureRoutingTestCase::CheckDeferredUpdates, this,
+                       links[3].Get (0));
+
+  struct Event { double time; uint32_t link; bool up; bool check; };
+  Event events[] = {{1, 3, false, true}, {2, 3, true, true}, {3, 7, false, false},
+                    {4, 2, false, false}, {5, 6, false, true}, {6, 7, true, false},
+                    {7, 6, true, true}, {8, 2, true, true}, {9, 0, false, true},
+                    {10, 0, true, true}};
+  for (uint32_t i = 0; i < sizeof (events) / sizeof (events[0]); i++)
+    {
+      Ptr<NetDevice> device = links[events[i].link].Get (i % 2);
+      Simulator::Schedule (Seconds (events[i].time),
+                           (events[i].up ? &LinkFailureHelper::SetLinkUp : &LinkFailureHelper::SetLinkDown),
+                           device);
+      if (events[i].check)
+        {
+          std::ostringstream step;
+          step << "link " << events[i].link << (events[i].up ? " up" : " down") << " at " << events[i].time;
+          Simulator::Schedule (Seconds (events[i].time), &LinkFailureRoutingTestCase::CheckRoutes, this,
+                               step.str ());
+        }
+      if (events[i].link != 0)
+        {
+          Simulator::Schedule (Seconds (events[i].time + 0.5), &LinkFailureRoutingTestCase::SendPacket, this);
+        }
+    }
+
+  Simulator::Stop (Seconds (11));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_received, m_sent, "All the packets should have been rerouted");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief LinkFailureHelper TestSuite
+ */
+class LinkFailureHelperTestSuite : public TestSuite
+{
+public:
+  LinkFailureHelperTestSuite ()
+    : TestSuite ("link-failure-helper", UNIT)
+  {
+    AddTestCase (new LinkFailureScheduleTestCase (), TestCase::QUICK);
+    AddTestCase (new LinkFailureRoutingTestCase (), TestCase::QUICK);
+  }
+};
+
+static LinkFailureHelperTestSuite g_linkFailureHelperTestSuite; //!< Static variable for test initialization
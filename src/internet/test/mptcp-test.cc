@@ -0,0 +1,353 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mptcp-socket.h"
+#include "ns3/mptcp-subflow.h"
+#include "ns3/mptcp-socket-factory.h"
+#include "ns3/mptcp-scheduler.h"
+#include "ns3/tcp-option-mptcp.h"
+#include "tcp-bulk-transfer.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MptcpTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the serialization of the MPTCP options in a TcpHeader
+ */
+class MptcpOptionTestCase : public TestCase
+{
+public:
+  MptcpOptionTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Serialize a header with the given option and read it back
+   * \param option the option
+   * \return the option of the deserialized header, or 0 if it has none
+   */
+  Ptr<const TcpOption> RoundTrip (Ptr<const TcpOption> option);
+};
+
+MptcpOptionTestCase::MptcpOptionTestCase ()
+  : TestCase ("MPTCP option serialization")
+{
+}
+
+Ptr<const TcpOption>
+MptcpOptionTestCase::RoundTrip (Ptr<const TcpOption> option)
+{
+  TcpHeader header;
+  header.AppendOption (option);
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (header);
+
+  TcpHeader copy;
+  p->RemoveHeader (copy);
+  NS_TEST_EXPECT_MSG_EQ (copy.HasOption (TcpOption::MPTCP), true, "The option was not deserialized");
+  Ptr<const TcpOption> read = copy.GetOption (TcpOption::MPTCP);
+  if (read == 0)
+    {
+      return 0;
+    }
+  NS_TEST_EXPECT_MSG_EQ (read->GetSerializedSize (), option->GetSerializedSize (), "Wrong length");
+  return read;
+}
+
+void
+MptcpOptionTestCase::DoRun (void)
+{
+  Ptr<TcpOptionMptcpCapable> capable = CreateObject<TcpOptionMptcpCapable> ();
+  capable->SetSenderKey (0x0123456789abcdefULL);
+  NS_TEST_EXPECT_MSG_EQ (capable->GetSerializedSize (), 12, "MP_CAPABLE on SYN is 12 bytes");
+  Ptr<const TcpOptionMptcpCapable> readCapable = DynamicCast<const TcpOptionMptcpCapable> (RoundTrip (capable));
+  NS_TEST_ASSERT_MSG_NE (readCapable, 0, "Not an MP_CAPABLE option");
+  NS_TEST_EXPECT_MSG_EQ (readCapable->GetSenderKey (), 0x0123456789abcdefULL, "Wrong sender key");
+  NS_TEST_EXPECT_MSG_EQ (readCapable->HasReceiverKey (), false, "Unexpected receiver key");
+
+  capable->SetReceiverKey (0xfedcba9876543210ULL);
+  NS_TEST_EXPECT_MSG_EQ (capable->GetSerializedSize (), 20, "MP_CAPABLE on the third ACK is 20 bytes");
+  readCapable = DynamicCast<const TcpOptionMptcpCapable> (RoundTrip (capable));
+  NS_TEST_ASSERT_MSG_NE (readCapable, 0, "Not an MP_CAPABLE option");
+  NS_TEST_EXPECT_MSG_EQ (readCapable->GetReceiverKey (), 0xfedcba9876543210ULL, "Wrong receiver key");
+
+  Ptr<TcpOptionMptcpJoin> join = CreateObject<TcpOptionMptcpJoin> ();
+  join->SetToken (0xdeadbeef);
+  join->SetNonce (12345);
+  join->SetAddressId (3);
+  join->SetBackup (true);
+  Ptr<const TcpOptionMptcpJoin> readJoin = DynamicCast<const TcpOptionMptcpJoin> (RoundTrip (join));
+  NS_TEST_ASSERT_MSG_NE (readJoin, 0, "Not an MP_JOIN option");
+  NS_TEST_EXPECT_MSG_EQ (readJoin->GetToken (), 0xdeadbeef, "Wrong token");
+  NS_TEST_EXPECT_MSG_EQ (readJoin->GetNonce (), 12345, "Wrong nonce");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (readJoin->GetAddressId ()), 3, "Wrong address id");
+  NS_TEST_EXPECT_MSG_EQ (readJoin->IsBackup (), true, "Wrong backup flag");
+
+  Ptr<TcpOptionMptcpDss> dss = CreateObject<TcpOptionMptcpDss> ();
+  dss->SetDataAck (SequenceNumber32 (1000));
+  NS_TEST_EXPECT_MSG_EQ (dss->GetSerializedSize (), 8, "DSS with data ACK only is 8 bytes");
+  Ptr<const TcpOptionMptcpDss> readDss = DynamicCast<const TcpOptionMptcpDss> (RoundTrip (dss));
+  NS_TEST_ASSERT_MSG_NE (readDss, 0, "Not a DSS option");
+  NS_TEST_EXPECT_MSG_EQ (readDss->HasDataAck (), true, "Missing data ACK");
+  NS_TEST_EXPECT_MSG_EQ (readDss->HasMapping (), false, "Unexpected mapping");
+  NS_TEST_EXPECT_MSG_EQ (readDss->GetDataAck (), SequenceNumber32 (1000), "Wrong data ACK");
+
+  dss->SetMapping (SequenceNumber32 (4000000000U), 1, 1400);
+  NS_TEST_EXPECT_MSG_EQ (dss->GetSerializedSize (), 18, "DSS with data ACK and mapping is 18 bytes");
+  readDss = DynamicCast<const TcpOptionMptcpDss> (RoundTrip (dss));
+  NS_TEST_ASSERT_MSG_NE (readDss, 0, "Not a DSS option");
+  NS_TEST_EXPECT_MSG_EQ (readDss->HasMapping (), true, "Missing mapping");
+  NS_TEST_EXPECT_MSG_EQ (readDss->GetDataSequence (), SequenceNumber32 (4000000000U), "Wrong DSN");
+  NS_TEST_EXPECT_MSG_EQ (readDss->GetSubflowSequence (), 1, "Wrong subflow sequence");
+  NS_TEST_EXPECT_MSG_EQ (readDss->GetDataLength (), 1400, "Wrong data length");
+
+  Ptr<TcpOptionMptcpAddAddress> addAddress = CreateObject<TcpOptionMptcpAddAddress> ();
+  addAddress->SetAddress (2, Ipv4Address ("10.2.3.4"));
+  Ptr<const TcpOptionMptcpAddAddress> readAddress = DynamicCast<const TcpOptionMptcpAddAddress> (RoundTrip (addAddress));
+  NS_TEST_ASSERT_MSG_NE (readAddress, 0, "Not an ADD_ADDR option");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (readAddress->GetAddressId ()), 2, "Wrong address id");
+  NS_TEST_EXPECT_MSG_EQ (readAddress->GetAddress (), Ipv4Address ("10.2.3.4"), "Wrong address");
+  NS_TEST_EXPECT_MSG_EQ (readAddress->GetPort (), 0, "Unexpected port");
+
+  addAddress->SetPort (5000);
+  readAddress = DynamicCast<const TcpOptionMptcpAddAddress> (RoundTrip (addAddress));
+  NS_TEST_ASSERT_MSG_NE (readAddress, 0, "Not an ADD_ADDR option");
+  NS_TEST_EXPECT_MSG_EQ (readAddress->GetPort (), 5000, "Wrong port");
+
+  // An MPTCP option ending the option space before its subtype is skipped:
+  // a 24-byte header whose options are NOP, NOP and a 2-byte MPTCP option
+  Buffer buffer;
+  buffer.AddAtStart (24);
+  Buffer::Iterator i = buffer.Begin ();
+  i.WriteHtonU16 (1000);
+  i.WriteHtonU16 (2000);
+  i.WriteHtonU32 (1);
+  i.WriteHtonU32 (1);
+  i.WriteHtonU16 ((6 << 12) | TcpHeader::ACK);
+  i.WriteHtonU16 (1000);
+  i.WriteHtonU16 (0);
+  i.WriteHtonU16 (0);
+  i.WriteU8 (TcpOption::NOP);
+  i.WriteU8 (TcpOption::NOP);
+  i.WriteU8 (TcpOption::MPTCP);
+  i.WriteU8 (2);
+  TcpHeader truncated;
+  NS_TEST_EXPECT_MSG_EQ (truncated.Deserialize (buffer.Begin ()), 24, "Wrong header length");
+  NS_TEST_EXPECT_MSG_NE (DynamicCast<const TcpOptionUnknown> (truncated.GetOption (TcpOption::MPTCP)), 0,
+                         "A truncated MPTCP option should be read as an unknown option");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Transfer data over an MPTCP connection between two dual-homed nodes
+ *
+ * The nodes are connected by two point-to-point links. The receiver checks
+ * that the byte stream is delivered complete and in order, and the test
+ * checks how many subflows were opened and how many of them carried data.
+ * Either side can be a plain TCP socket, to check the fallback to TCP.
+ */
+class MptcpTransferTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param name the name of the test
+   * \param mptcpClient whether the client uses MPTCP
+   * \param mptcpServer whether the server uses MPTCP
+   * \param pathManager the path manager of the client
+   * \param scheduler the scheduler of the client
+   * \param expectedSubflows the expected number of subflows of the client
+   */
+  MptcpTransferTestCase (std::string name, bool mptcpClient, bool mptcpServer,
+                         MptcpSocket::PathManager pathManager, TypeId scheduler,
+                         uint32_t expectedSubflows);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief A subflow was added to the sender connection
+   * \param subflow the subflow
+   */
+  void SubflowAdded (Ptr<MptcpSubflow> subflow);
+  /**
+   * \brief Count the payload sent by each subflow
+   * \param p the packet
+   * \param header the TCP header
+   * \param socket the subflow
+   */
+  void SubflowTx (Ptr<const Packet> p, const TcpHeader &header, Ptr<const TcpSocketBase> socket);
+
+  bool m_mptcpClient;                  //!< The client uses MPTCP
+  bool m_mptcpServer;                  //!< The server uses MPTCP
+  MptcpSocket::PathManager m_pathManager; //!< Path manager of the client
+  TypeId m_scheduler;                  //!< Scheduler of the client
+  uint32_t m_expectedSubflows;         //!< Expected number of subflows
+  TcpBulkTransfer m_transfer {2000000}; //!< Transfer from the client to the server
+  uint32_t m_subflows {0};             //!< Subflows of the sender
+  std::map<const TcpSocketBase *, uint32_t> m_txBytes; //!< Payload sent by each subflow
+};
+
+MptcpTransferTestCase::MptcpTransferTestCase (std::string name, bool mptcpClient, bool mptcpServer,
+                                              MptcpSocket::PathManager pathManager,
+                                              TypeId scheduler, uint32_t expectedSubflows)
+  : TestCase (name),
+    m_mptcpClient (mptcpClient),
+    m_mptcpServer (mptcpServer),
+    m_pathManager (pathManager),
+    m_scheduler (scheduler),
+    m_expectedSubflows (expectedSubflows)
+{
+}
+
+void
+MptcpTransferTestCase::SubflowAdded (Ptr<MptcpSubflow> subflow)
+{
+  m_subflows++;
+  subflow->TraceConnectWithoutContext ("Tx", MakeCallback (&MptcpTransferTestCase::SubflowTx, this));
+}
+
+void
+MptcpTransferTestCase::SubflowTx (Ptr<const Packet> p, const TcpHeader &header,
+                                  Ptr<const TcpSocketBase> socket)
+{
+  m_txBytes[PeekPointer (socket)] += p->GetSize ();
+}
+
+void
+MptcpTransferTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1000));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (256000));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (256000));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  internet.AssignStreams (nodes, 0);
+
+  SimpleNetDeviceHelper simple;
+  simple.SetNetDevicePointToPointMode (true);
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+  simple.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  simple.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("50p"));
+  NetDeviceContainer link1 = simple.Install (nodes);
+  simple.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (3)));
+  NetDeviceContainer link2 = simple.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces1 = ipv4.Assign (link1);
+  ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+  ipv4.Assign (link2);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  TypeId serverFactory = m_mptcpServer ? MptcpSocketFactory::GetTypeId () : TcpSocketFactory::GetTypeId ();
+  Ptr<Socket> receiver = Socket::CreateSocket (nodes.Get (1), serverFactory);
+  receiver->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  receiver->Listen ();
+
+  TypeId clientFactory = m_mptcpClient ? MptcpSocketFactory::GetTypeId () : TcpSocketFactory::GetTypeId ();
+  Ptr<Socket> sender = Socket::CreateSocket (nodes.Get (0), clientFactory);
+  Ptr<MptcpSocket> meta = DynamicCast<MptcpSocket> (sender);
+  if (meta != 0)
+    {
+      meta->SetAttribute ("PathManager", EnumValue (m_pathManager));
+      meta->SetAttribute ("NumSubflows", UintegerValue (3));
+      meta->SetAttribute ("Scheduler", TypeIdValue (m_scheduler));
+      meta->AssignStreams (100);
+      meta->TraceConnectWithoutContext ("SubflowAdded",
+                                        MakeCallback (&MptcpTransferTestCase::SubflowAdded, this));
+    }
+  m_transfer.SetCheckData (true);
+  m_transfer.SetCloseOnCompletion (true);
+  m_transfer.Start (sender, receiver, InetSocketAddress (interfaces1.GetAddress (1), 5000),
+                    MilliSeconds (1));
+
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_transfer.GetReceivedBytes (), m_transfer.GetTotalBytes (),
+                         "Not all the data was received");
+  NS_TEST_EXPECT_MSG_EQ (m_transfer.IsCorrupted (), false, "The data was not received in order");
+  NS_TEST_EXPECT_MSG_EQ (m_transfer.IsReceiverClosed (), true,
+                         "The receiver connection was not closed");
+  if (meta != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (meta->IsMptcp (), m_mptcpServer, "Wrong MPTCP negotiation");
+      NS_TEST_EXPECT_MSG_EQ (m_subflows, m_expectedSubflows, "Wrong number of subflows");
+      uint32_t used = 0;
+      for (const auto &tx : m_txBytes)
+        {
+          used += (tx.second > 0) ? 1 : 0;
+        }
+      NS_TEST_EXPECT_MSG_EQ ((used > 1), (m_expectedSubflows > 1), "The data did not use all the paths");
+    }
+
+  Simulator::Destroy ();
+  Config::Reset ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for Multipath TCP
+ */
+class MptcpTestSuite : public TestSuite
+{
+public:
+  MptcpTestSuite () : TestSuite ("mptcp", UNIT)
+  {
+    AddTestCase (new MptcpOptionTestCase (), TestCase::QUICK);
+    AddTestCase (new MptcpTransferTestCase ("Full-mesh transfer between dual-homed nodes", true, true,
+                                            MptcpSocket::FULLMESH,
+                                            MptcpSchedulerMinRtt::GetTypeId (), 3),
+                 TestCase::QUICK);
+    AddTestCase (new MptcpTransferTestCase ("Round-robin scheduler", true, true,
+                                            MptcpSocket::FULLMESH,
+                                            MptcpSchedulerRoundRobin::GetTypeId (), 3),
+                 TestCase::QUICK);
+    AddTestCase (new MptcpTransferTestCase ("Ndiffports transfer", true, true,
+                                            MptcpSocket::NDIFFPORTS,
+                                            MptcpSchedulerMinRtt::GetTypeId (), 3),
+                 TestCase::QUICK);
+    AddTestCase (new MptcpTransferTestCase ("Fallback to a TCP server", true, false,
+                                            MptcpSocket::FULLMESH,
+                                            MptcpSchedulerMinRtt::GetTypeId (), 1),
+                 TestCase::QUICK);
+    AddTestCase (new MptcpTransferTestCase ("Fallback to a TCP client", false, true,
+                                            MptcpSocket::FULLMESH,
+                                            MptcpSchedulerMinRtt::GetTypeId (), 1),
+                 TestCase::QUICK);
+  }
+};
+
+static MptcpTestSuite g_mptcpTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,177 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "tcp-bulk-transfer.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpBulkTransfer");
+
+TcpBulkTransfer::TcpBulkTransfer (uint32_t totalBytes)
+  : m_totalBytes (totalBytes)
+{
+}
+
+void
+TcpBulkTransfer::SetCheckData (bool check)
+{
+  m_checkData = check;
+}
+
+void
+TcpBulkTransfer::SetCloseOnCompletion (bool close)
+{
+  m_closeOnCompletion = close;
+}
+
+void
+TcpBulkTransfer::SetRecvCallback (Callback<void, Ptr<const Packet> > cb)
+{
+  m_recvCb = cb;
+}
+
+void
+TcpBulkTransfer::Start (Ptr<Socket> sender, Ptr<Socket> receiver, Address remote, Time delay)
+{
+  NS_LOG_FUNCTION (this << sender << receiver << remote << delay);
+  m_sentBytes = 0;
+  m_receivedBytes = 0;
+  m_corrupted = false;
+  m_receiverClosed = false;
+
+  receiver->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                               MakeCallback (&TcpBulkTransfer::ReceiverAccept, this));
+  sender->SetSendCallback (MakeCallback (&TcpBulkTransfer::SenderSend, this));
+  Simulator::Schedule (delay, &TcpBulkTransfer::StartTransfer, this, sender, remote);
+}
+
+uint32_t
+TcpBulkTransfer::GetTotalBytes (void) const
+{
+  return m_totalBytes;
+}
+
+uint32_t
+TcpBulkTransfer::GetSentBytes (void) const
+{
+  return m_sentBytes;
+}
+
+uint32_t
+TcpBulkTransfer::GetReceivedBytes (void) const
+{
+  return m_receivedBytes;
+}
+
+bool
+TcpBulkTransfer::IsCorrupted (void) const
+{
+  return m_corrupted;
+}
+
+bool
+TcpBulkTransfer::IsReceiverClosed (void) const
+{
+  return m_receiverClosed;
+}
+
+void
+TcpBulkTransfer::StartTransfer (Ptr<Socket> sock, Address remote)
+{
+  sock->Connect (remote);
+  SenderSend (sock, sock->GetTxAvailable ());
+}
+
+void
+TcpBulkTransfer::SenderSend (Ptr<Socket> sock, uint32_t available)
+{
+  while (m_sentBytes < m_totalBytes && sock->GetTxAvailable () > 0)
+    {
+      uint32_t toSend = std::min (m_totalBytes - m_sentBytes, sock->GetTxAvailable ());
+      Ptr<Packet> p;
+      if (m_checkData)
+        {
+          std::vector<uint8_t> data (toSend);
+          for (uint32_t i = 0; i < toSend; ++i)
+            {
+              data[i] = static_cast<uint8_t> ((m_sentBytes + i) % 251);
+            }
+          p = Create<Packet> (data.data (), toSend);
+        }
+      else
+        {
+          p = Create<Packet> (toSend);
+        }
+      int sent = sock->Send (p);
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_sentBytes += sent;
+    }
+  if (m_closeOnCompletion && m_sentBytes == m_totalBytes)
+    {
+      sock->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+      sock->Close ();
+    }
+}
+
+void
+TcpBulkTransfer::ReceiverAccept (Ptr<Socket> sock, const Address &from)
+{
+  sock->SetRecvCallback (MakeCallback (&TcpBulkTransfer::ReceiverRecv, this));
+  sock->SetCloseCallbacks (MakeCallback (&TcpBulkTransfer::ReceiverClosed, this),
+                           MakeCallback (&TcpBulkTransfer::ReceiverClosed, this));
+}
+
+void
+TcpBulkTransfer::ReceiverRecv (Ptr<Socket> sock)
+{
+  Ptr<Packet> p;
+  while ((p = sock->Recv ()) && p->GetSize () > 0)
+    {
+      if (m_checkData)
+        {
+          std::vector<uint8_t> data (p->GetSize ());
+          p->CopyData (data.data (), data.size ());
+          for (uint32_t i = 0; i < data.size (); ++i)
+            {
+              if (data[i] != static_cast<uint8_t> ((m_receivedBytes + i) % 251))
+                {
+                  m_corrupted = true;
+                }
+            }
+        }
+      m_receivedBytes += p->GetSize ();
+      if (!m_recvCb.IsNull ())
+        {
+          m_recvCb (p);
+        }
+    }
+}
+
+void
+TcpBulkTransfer::ReceiverClosed (Ptr<Socket> sock)
+{
+  m_receiverClosed = true;
+}
+
+} // namespace ns3
@@ -0,0 +1,138 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef TCP_BULK_TRANSFER_H
+#define TCP_BULK_TRANSFER_H
+
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief A bulk transfer between two sockets, for the tests that only need
+ * some data to flow between a sender and a listening receiver.
+ *
+ * The sender keeps its Tx buffer full until the given amount of bytes has
+ * been written, and the receiver reads everything it is given. Optionally,
+ * the payload carries a known pattern which is checked by the receiver, and
+ * the sender closes the connection once all the data has been written.
+ *
+ * The object must outlive the simulation, as the socket callbacks point to it.
+ */
+class TcpBulkTransfer
+{
+public:
+  /**
+   * \brief Constructor
+   * \param totalBytes the bytes to transfer
+   */
+  TcpBulkTransfer (uint32_t totalBytes);
+
+  /**
+   * \brief Write a known pattern and check it at the receiver
+   * \param check whether the payload is checked
+   */
+  void SetCheckData (bool check);
+  /**
+   * \brief Close the sender once all the data has been written
+   * \param close whether the sender is closed
+   */
+  void SetCloseOnCompletion (bool close);
+  /**
+   * \brief Set a callback invoked for every packet read by the receiver
+   * \param cb the callback
+   */
+  void SetRecvCallback (Callback<void, Ptr<const Packet> > cb);
+
+  /**
+   * \brief Reset the counters and start the transfer after a delay
+   * \param sender the sender socket
+   * \param receiver the listening receiver socket
+   * \param remote the address of the receiver
+   * \param delay the delay before the sender connects
+   */
+  void Start (Ptr<Socket> sender, Ptr<Socket> receiver, Address remote, Time delay);
+
+  /**
+   * \return the bytes to transfer
+   */
+  uint32_t GetTotalBytes (void) const;
+  /**
+   * \return the bytes written by the sender
+   */
+  uint32_t GetSentBytes (void) const;
+  /**
+   * \return the bytes read by the receiver
+   */
+  uint32_t GetReceivedBytes (void) const;
+  /**
+   * \return true if the receiver read bytes which do not match the pattern
+   */
+  bool IsCorrupted (void) const;
+  /**
+   * \return true if the receiver connection was closed
+   */
+  bool IsReceiverClosed (void) const;
+
+private:
+  /**
+   * \brief Connect the sender and start the transfer
+   * \param sock the sender socket
+   * \param remote the address of the receiver
+   */
+  void StartTransfer (Ptr<Socket> sock, Address remote);
+  /**
+   * \brief Fill the Tx buffer of the sender
+   * \param sock the sender socket
+   * \param available the available Tx buffer space
+   */
+  void SenderSend (Ptr<Socket> sock, uint32_t available);
+  /**
+   * \brief Accept a connection on the receiver
+   * \param sock the new socket
+   * \param from the address of the peer
+   */
+  void ReceiverAccept (Ptr<Socket> sock, const Address &from);
+  /**
+   * \brief Read data on the receiver
+   * \param sock the receiver socket
+   */
+  void ReceiverRecv (Ptr<Socket> sock);
+  /**
+   * \brief The receiver connection was closed
+   * \param sock the receiver socket
+   */
+  void ReceiverClosed (Ptr<Socket> sock);
+
+  uint32_t m_totalBytes;             //!< Bytes to transfer
+  bool m_checkData {false};          //!< Whether the payload is checked
+  bool m_closeOnCompletion {false};  //!< Whether the sender is closed at the end
+  Callback<void, Ptr<const Packet> > m_recvCb; //!< Invoked for every packet read
+  uint32_t m_sentBytes {0};          //!< Bytes written by the sender
+  uint32_t m_receivedBytes {0};      //!< Bytes read by the receiver
+  bool m_corrupted {false};          //!< The receiver read unexpected bytes
+  bool m_receiverClosed {false};     //!< The receiver connection was closed
+};
+
+} // namespace ns3
+
+#endif /* TCP_BULK_TRANSFER_H */
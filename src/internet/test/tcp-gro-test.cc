@@ -0,0 +1,323 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-helper.h"
+#include "tcp-bulk-transfer.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpGroTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check which segments are merged by TcpL4Protocol GRO
+ *
+ * Segments are injected directly into TcpL4Protocol. Two in-order ECT(0)
+ * segments are followed by two in-order CE segments, a CE segment after a
+ * gap and, once the batch window has expired, a segment with the PSH flag.
+ * GRO must deliver three packets, merged from 2, 2 and 1 segments, with the
+ * CE codepoint of each merged packet equal to that of its segments, and must
+ * not hold the PSH segment. A segment towards a port without an endpoint
+ * must not be held either, but delivered at once to get an RST in reply.
+ */
+class TcpGroMergeTest : public TestCase
+{
+public:
+  TcpGroMergeTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Inject a data segment into TCP
+   * \param tcp the TCP L4 protocol
+   * \param interface the incoming interface
+   * \param port the destination port of the segment
+   * \param seq the sequence number of the segment
+   * \param ecn the ECN codepoint of the segment
+   * \param flags the TCP flags of the segment
+   */
+  void Inject (Ptr<TcpL4Protocol> tcp, Ptr<Ipv4Interface> interface, uint16_t port,
+               uint32_t seq, Ipv4Header::EcnType ecn, uint8_t flags);
+  /**
+   * \brief Trace packets delivered by GRO
+   * \param p the merged packet
+   * \param segments the number of segments merged
+   */
+  void GroFlush (Ptr<const Packet> p, uint32_t segments);
+
+  std::vector<uint32_t> m_segments; //!< Segments per delivered packet
+  std::vector<uint32_t> m_sizes;    //!< Payload size per delivered packet
+  std::vector<uint32_t> m_seqs;     //!< Sequence number per delivered packet
+  std::vector<IpL4Protocol::RxStatus> m_status; //!< Receive status per injected segment
+};
+
+TcpGroMergeTest::TcpGroMergeTest ()
+  : TestCase ("Merge rules of generic receive offload")
+{
+}
+
+void
+TcpGroMergeTest::Inject (Ptr<TcpL4Protocol> tcp, Ptr<Ipv4Interface> interface, uint16_t port,
+                         uint32_t seq, Ipv4Header::EcnType ecn, uint8_t flags)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  TcpHeader tcpHeader;
+  tcpHeader.SetSourcePort (5000);
+  tcpHeader.SetDestinationPort (port);
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (seq));
+  tcpHeader.SetAckNumber (SequenceNumber32 (1));
+  tcpHeader.SetFlags (flags);
+  p->AddHeader (tcpHeader);
+
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.1.1.1"));
+  ipHeader.SetDestination (Ipv4Address ("10.1.1.2"));
+  ipHeader.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+  ipHeader.SetEcn (ecn);
+  ipHeader.SetPayloadSize (p->GetSize ());
+
+  m_status.push_back (tcp->Receive (p, ipHeader, interface));
+}
+
+void
+TcpGroMergeTest::GroFlush (Ptr<const Packet> p, uint32_t segments)
+{
+  TcpHeader tcpHeader;
+  p->PeekHeader (tcpHeader);
+  m_segments.push_back (segments);
+  m_sizes.push_back (p->GetSize () - tcpHeader.GetSerializedSize ());
+  m_seqs.push_back (tcpHeader.GetSequenceNumber ().GetValue ());
+}
+
+void
+TcpGroMergeTest::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (node);
+
+  Ptr<TcpL4Protocol> tcp = node->GetObject<TcpL4Protocol> ();
+  tcp->SetAttribute ("GroTimeout", TimeValue (MicroSeconds (100)));
+  tcp->TraceConnectWithoutContext ("GroFlush", MakeCallback (&TcpGroMergeTest::GroFlush, this));
+  Ptr<Ipv4Interface> interface = node->GetObject<Ipv4L3Protocol> ()->GetInterface (0);
+  tcp->Allocate (0, Ipv4Address ("10.1.1.2"), 6000, Ipv4Address ("10.1.1.1"), 5000);
+
+  Simulator::Schedule (MicroSeconds (10), &TcpGroMergeTest::Inject, this, tcp, interface,
+                       6000, 1, Ipv4Header::ECN_ECT0, TcpHeader::ACK);
+  Simulator::Schedule (MicroSeconds (20), &TcpGroMergeTest::Inject, this, tcp, interface,
+                       6000, 1001, Ipv4Header::ECN_ECT0, TcpHeader::ACK);
+  Simulator::Schedule (MicroSeconds (30), &TcpGroMergeTest::Inject, this, tcp, interface,
+                       6000, 2001, Ipv4Header::ECN_CE, TcpHeader::ACK);
+  Simulator::Schedule (MicroSeconds (40), &TcpGroMergeTest::Inject, this, tcp, interface,
+                       6000, 3001, Ipv4Header::ECN_CE, TcpHeader::ACK);
+  Simulator::Schedule (MicroSeconds (50), &TcpGroMergeTest::Inject, this, tcp, interface,
+                       6000, 5001, Ipv4Header::ECN_CE, TcpHeader::ACK);
+  Simulator::Schedule (MilliSeconds (1), &TcpGroMergeTest::Inject, this, tcp, interface,
+                       6000, 6001, Ipv4Header::ECN_ECT0, TcpHeader::ACK | TcpHeader::PSH);
+  Simulator::Schedule (MilliSeconds (2), &TcpGroMergeTest::Inject, this, tcp, interface,
+                       7000, 1, Ipv4Header::ECN_ECT0, TcpHeader::ACK);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_segments.size (), 3, "Unexpected number of merged packets");
+  NS_TEST_ASSERT_MSG_EQ (m_segments[0], 2, "The ECT(0) segments should be merged");
+  NS_TEST_ASSERT_MSG_EQ (m_seqs[0], 1, "Unexpected sequence number");
+  NS_TEST_ASSERT_MSG_EQ (m_sizes[0], 2000, "Unexpected payload size");
+  NS_TEST_ASSERT_MSG_EQ (m_segments[1], 2, "The CE segments should be merged apart");
+  NS_TEST_ASSERT_MSG_EQ (m_seqs[1], 2001, "Unexpected sequence number");
+  NS_TEST_ASSERT_MSG_EQ (m_sizes[1], 2000, "Unexpected payload size");
+  NS_TEST_ASSERT_MSG_EQ (m_segments[2], 1, "An out-of-order segment must not be merged");
+  NS_TEST_ASSERT_MSG_EQ (m_seqs[2], 5001, "Unexpected sequence number");
+  NS_TEST_ASSERT_MSG_EQ (m_status.size (), 7, "Unexpected number of injected segments");
+  NS_TEST_EXPECT_MSG_EQ (m_status[6], IpL4Protocol::RX_ENDPOINT_CLOSED,
+                         "A segment without endpoint must not be held");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check a bulk transfer towards a receiver with GRO
+ *
+ * The same transfer is run with and without GRO at the receiver. The test
+ * checks that all the data is received in both cases, that every data
+ * segment received by the IPv4 layer is accounted for by the GroFlush trace,
+ * and that GRO reduces the number of packets processed and of ACKs sent by
+ * the receiver.
+ */
+class TcpGroTransferTest : public TestCase
+{
+public:
+  TcpGroTransferTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Run the transfer
+   * \param groTimeout the GroTimeout attribute of the receiver
+   */
+  void RunTransfer (Time groTimeout);
+  /**
+   * \brief Trace packets received by the IPv4 layer of the receiver
+   * \param p the packet
+   * \param ipv4 the IPv4 object
+   * \param interface the interface
+   */
+  void ReceiverIpRx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+  /**
+   * \brief Trace packets sent by the IPv4 layer of the receiver
+   * \param p the packet
+   * \param ipv4 the IPv4 object
+   * \param interface the interface
+   */
+  void ReceiverIpTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+  /**
+   * \brief Trace packets delivered by GRO
+   * \param p the merged packet
+   * \param segments the number of segments merged
+   */
+  void GroFlush (Ptr<const Packet> p, uint32_t segments);
+
+  uint32_t m_segmentSize {1000};     //!< TCP segment size
+  TcpBulkTransfer m_transfer {500000}; //!< Transfer from the sender to the receiver
+  uint32_t m_dataPackets;            //!< Data packets received by the receiver IPv4 layer
+  uint32_t m_acks;                   //!< Packets sent by the receiver IPv4 layer
+  uint32_t m_groPackets;             //!< Packets delivered by GRO
+  uint32_t m_groSegments;            //!< Segments merged by GRO
+};
+
+TcpGroTransferTest::TcpGroTransferTest ()
+  : TestCase ("Bulk transfer with and without generic receive offload")
+{
+}
+
+void
+TcpGroTransferTest::ReceiverIpRx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (p->GetSize () > 100)
+    {
+      m_dataPackets++;
+    }
+}
+
+void
+TcpGroTransferTest::ReceiverIpTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  m_acks++;
+}
+
+void
+TcpGroTransferTest::GroFlush (Ptr<const Packet> p, uint32_t segments)
+{
+  m_groPackets++;
+  m_groSegments += segments;
+}
+
+void
+TcpGroTransferTest::RunTransfer (Time groTimeout)
+{
+  m_dataPackets = 0;
+  m_acks = 0;
+  m_groPackets = 0;
+  m_groSegments = 0;
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simple;
+  simple.SetNetDevicePointToPointMode (true);
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Gbps")));
+  simple.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (50)));
+  NetDeviceContainer devices = simple.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Ptr<TcpL4Protocol> tcp = nodes.Get (1)->GetObject<TcpL4Protocol> ();
+  tcp->SetAttribute ("GroTimeout", TimeValue (groTimeout));
+  tcp->TraceConnectWithoutContext ("GroFlush",
+                                   MakeCallback (&TcpGroTransferTest::GroFlush, this));
+  nodes.Get (1)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Rx",
+    MakeCallback (&TcpGroTransferTest::ReceiverIpRx, this));
+  nodes.Get (1)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Tx",
+    MakeCallback (&TcpGroTransferTest::ReceiverIpTx, this));
+
+  Ptr<Socket> receiver = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  receiver->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  receiver->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  receiver->Listen ();
+
+  Ptr<Socket> sender = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  sender->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  sender->SetAttribute ("InitialCwnd", UintegerValue (10));
+  m_transfer.Start (sender, receiver, InetSocketAddress (interfaces.GetAddress (1), 5000),
+                    MilliSeconds (1));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+TcpGroTransferTest::DoRun (void)
+{
+  RunTransfer (Seconds (0));
+  NS_TEST_ASSERT_MSG_EQ (m_transfer.GetReceivedBytes (), m_transfer.GetTotalBytes (),
+                         "Not all the data was received");
+  NS_TEST_ASSERT_MSG_EQ (m_groPackets, 0, "GRO should be disabled");
+  uint32_t acksWithoutGro = m_acks;
+
+  RunTransfer (MicroSeconds (50));
+  NS_TEST_ASSERT_MSG_EQ (m_transfer.GetReceivedBytes (), m_transfer.GetTotalBytes (),
+                         "Not all the data was received");
+  NS_TEST_ASSERT_MSG_EQ (m_groSegments, m_dataPackets,
+                         "Every data segment should go through GRO");
+  NS_TEST_ASSERT_MSG_LT (m_groPackets, m_groSegments, "No segment was merged");
+  NS_TEST_ASSERT_MSG_LT (m_acks, acksWithoutGro, "GRO should reduce the number of ACKs");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for TCP generic receive offload
+ */
+class TcpGroTestSuite : public TestSuite
+{
+public:
+  TcpGroTestSuite () : TestSuite ("tcp-gro", UNIT)
+  {
+    AddTestCase (new TcpGroMergeTest (), TestCase::QUICK);
+    AddTestCase (new TcpGroTransferTest (), TestCase::QUICK);
+  }
+};
+
+static TcpGroTestSuite g_tcpGroTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,298 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/tcp-gso-tag.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "tcp-bulk-transfer.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpGsoTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that Ipv4QueueDiscItem splits a GSO super-segment correctly
+ */
+class TcpGsoSegmentTest : public TestCase
+{
+public:
+  TcpGsoSegmentTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpGsoSegmentTest::TcpGsoSegmentTest ()
+  : TestCase ("Split of a TCP super-segment into wire segments")
+{
+}
+
+void
+TcpGsoSegmentTest::DoRun (void)
+{
+  Ptr<Packet> p = Create<Packet> (2500);
+  TcpHeader tcpHeader;
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (1000));
+  tcpHeader.SetFlags (TcpHeader::ACK | TcpHeader::CWR | TcpHeader::FIN);
+  p->AddHeader (tcpHeader);
+  TcpGsoTag gsoTag;
+  gsoTag.SetSegmentSize (1000);
+  p->AddPacketTag (gsoTag);
+
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.0.0.1"));
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.2"));
+  ipHeader.SetProtocol (6);
+  ipHeader.SetIdentification (7);
+  ipHeader.SetPayloadSize (p->GetSize ());
+
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, Mac48Address::GetBroadcast (),
+                                                           0x0800, ipHeader);
+  std::vector<Ptr<QueueDiscItem> > segments;
+  NS_TEST_ASSERT_MSG_EQ (item->Segment (segments), true, "The item should be split");
+  NS_TEST_ASSERT_MSG_EQ (segments.size (), 3, "Unexpected number of segments");
+
+  uint32_t expectedSize[] = {1000, 1000, 500};
+  for (uint32_t i = 0; i < segments.size (); i++)
+    {
+      Ptr<Ipv4QueueDiscItem> seg = DynamicCast<Ipv4QueueDiscItem> (segments[i]);
+      NS_TEST_ASSERT_MSG_NE (seg, 0, "Segments must be IPv4 items");
+      NS_TEST_ASSERT_MSG_EQ (seg->GetHeader ().GetIdentification (), 7 + i, "Unexpected IP id");
+      NS_TEST_ASSERT_MSG_EQ (seg->GetHeader ().GetPayloadSize (), expectedSize[i] + 20,
+                             "Unexpected IP payload size");
+      NS_TEST_ASSERT_MSG_EQ (seg->GetSize (), expectedSize[i] + 40, "Unexpected item size");
+
+      Ptr<Packet> segPacket = seg->GetPacket ()->Copy ();
+      NS_TEST_ASSERT_MSG_EQ (segPacket->PeekPacketTag (gsoTag), false,
+                             "Wire segments must not carry the GSO tag");
+      TcpHeader segHeader;
+      segPacket->RemoveHeader (segHeader);
+      NS_TEST_ASSERT_MSG_EQ (segPacket->GetSize (), expectedSize[i], "Unexpected payload size");
+      NS_TEST_ASSERT_MSG_EQ (segHeader.GetSequenceNumber (), SequenceNumber32 (1000 + 1000 * i),
+                             "Unexpected sequence number");
+      NS_TEST_ASSERT_MSG_EQ (((segHeader.GetFlags () & TcpHeader::CWR) != 0), (i == 0),
+                             "CWR must be set on the first segment only");
+      NS_TEST_ASSERT_MSG_EQ (((segHeader.GetFlags () & TcpHeader::FIN) != 0), (i == 2),
+                             "FIN must be set on the last segment only");
+      NS_TEST_ASSERT_MSG_EQ (((segHeader.GetFlags () & TcpHeader::ACK) != 0), true,
+                             "ACK must be set on every segment");
+    }
+
+  // Items without the GSO tag are not split
+  Ptr<Packet> plain = Create<Packet> (2500);
+  plain->AddHeader (tcpHeader);
+  Ptr<Ipv4QueueDiscItem> plainItem = Create<Ipv4QueueDiscItem> (plain, Mac48Address::GetBroadcast (),
+                                                                0x0800, ipHeader);
+  segments.clear ();
+  NS_TEST_ASSERT_MSG_EQ (plainItem->Segment (segments), false, "The item should not be split");
+  NS_TEST_ASSERT_MSG_EQ (segments.size (), 0, "No segment expected");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check a bulk transfer with segmentation offload
+ *
+ * A sender transfers a given amount of data to a receiver over a
+ * point-to-point SimpleNetDevice link. The test checks that all the data is
+ * received, that the IPv4 layer of the sender handles fewer (super-)segments
+ * than the receiver when GSO is enabled, that no packet larger than the
+ * segment size reaches the wire, and that no payload is appended to the
+ * segments passed to the Tx trace of the sender socket.
+ */
+class TcpGsoTransferTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param gsoMaxSize the GsoMaxSize attribute of the sender
+   * \param queueDisc whether a queue disc is installed on the devices
+   */
+  TcpGsoTransferTest (uint32_t gsoMaxSize, bool queueDisc);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Trace packets sent by the IPv4 layer of the sender
+   * \param p the packet
+   * \param ipv4 the IPv4 object
+   * \param interface the interface
+   */
+  void SenderIpTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+  /**
+   * \brief Trace packets received by the IPv4 layer of the receiver
+   * \param p the packet
+   * \param ipv4 the IPv4 object
+   * \param interface the interface
+   */
+  void ReceiverIpRx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+  /**
+   * \brief Trace segments sent by the sender socket
+   * \param p the segment
+   * \param header the TCP header
+   * \param socket the socket
+   */
+  void SenderTcpTx (Ptr<const Packet> p, const TcpHeader &header, Ptr<const TcpSocketBase> socket);
+
+  uint32_t m_gsoMaxSize;             //!< GsoMaxSize attribute of the sender
+  bool m_queueDisc;                  //!< Whether to install a queue disc
+  uint32_t m_segmentSize {1000};     //!< TCP segment size
+  TcpBulkTransfer m_transfer {200000}; //!< Transfer from the sender to the receiver
+  uint32_t m_senderDataPackets {0};  //!< Data packets sent by the sender IPv4 layer
+  uint32_t m_receiverDataPackets {0}; //!< Data packets received by the receiver IPv4 layer
+  uint32_t m_maxRxSize {0};          //!< Largest packet received
+  std::vector<std::pair<Ptr<const Packet>, uint32_t> > m_txSegments; //!< Traced segments and their size
+};
+
+TcpGsoTransferTest::TcpGsoTransferTest (uint32_t gsoMaxSize, bool queueDisc)
+  : TestCase ("Bulk transfer with GsoMaxSize=" + std::to_string (gsoMaxSize)
+              + (queueDisc ? " and a queue disc" : " and no queue disc")),
+    m_gsoMaxSize (gsoMaxSize),
+    m_queueDisc (queueDisc)
+{
+}
+
+void
+TcpGsoTransferTest::SenderIpTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (p->GetSize () > 100)
+    {
+      m_senderDataPackets++;
+    }
+}
+
+void
+TcpGsoTransferTest::SenderTcpTx (Ptr<const Packet> p, const TcpHeader &header, Ptr<const TcpSocketBase> socket)
+{
+  m_txSegments.push_back (std::make_pair (p, p->GetSize ()));
+}
+
+void
+TcpGsoTransferTest::ReceiverIpRx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (p->GetSize () > 100)
+    {
+      m_receiverDataPackets++;
+    }
+  m_maxRxSize = std::max (m_maxRxSize, p->GetSize ());
+}
+
+void
+TcpGsoTransferTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simple;
+  simple.SetNetDevicePointToPointMode (true);
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Gbps")));
+  simple.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (50)));
+  NetDeviceContainer devices = simple.Install (nodes);
+
+  TrafficControlHelper tch;
+  if (m_queueDisc)
+    {
+      tch.SetRootQueueDisc ("ns3::FifoQueueDisc", "MaxSize", StringValue ("1000p"));
+      tch.Install (devices);
+    }
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  if (!m_queueDisc)
+    {
+      tch.Uninstall (devices);
+    }
+
+  nodes.Get (0)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Tx",
+    MakeCallback (&TcpGsoTransferTest::SenderIpTx, this));
+  nodes.Get (1)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Rx",
+    MakeCallback (&TcpGsoTransferTest::ReceiverIpRx, this));
+
+  Ptr<Socket> receiver = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  receiver->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  receiver->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  receiver->Listen ();
+
+  Ptr<Socket> sender = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  sender->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  sender->SetAttribute ("GsoMaxSize", UintegerValue (m_gsoMaxSize));
+  sender->SetAttribute ("InitialCwnd", UintegerValue (10));
+  sender->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpGsoTransferTest::SenderTcpTx, this));
+  m_transfer.Start (sender, receiver, InetSocketAddress (interfaces.GetAddress (1), 5000),
+                    MilliSeconds (1));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_transfer.GetReceivedBytes (), m_transfer.GetTotalBytes (),
+                         "Not all the data was received");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_maxRxSize, m_segmentSize + 100,
+                               "A super-segment reached the receiver");
+  // the TCP header (at most 60 bytes) is added to the traced segments when
+  // they are sent, but no payload may be appended to them
+  for (const auto &segment : m_txSegments)
+    {
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (segment.first->GetSize (), segment.second + 60,
+                                   "A segment passed to the Tx trace was grown");
+    }
+  if (m_gsoMaxSize > m_segmentSize)
+    {
+      NS_TEST_ASSERT_MSG_LT (m_senderDataPackets, m_receiverDataPackets,
+                             "Segments were not coalesced by the sender");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_senderDataPackets, m_receiverDataPackets,
+                             "Segments were coalesced with GSO disabled");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for TCP segmentation offload
+ */
+class TcpGsoTestSuite : public TestSuite
+{
+public:
+  TcpGsoTestSuite () : TestSuite ("tcp-gso", UNIT)
+  {
+    AddTestCase (new TcpGsoSegmentTest (), TestCase::QUICK);
+    AddTestCase (new TcpGsoTransferTest (0, true), TestCase::QUICK);
+    AddTestCase (new TcpGsoTransferTest (16000, true), TestCase::QUICK);
+    AddTestCase (new TcpGsoTransferTest (16000, false), TestCase::QUICK);
+    AddTestCase (new TcpGsoTransferTest (65000, true), TestCase::QUICK);
+  }
+};
+
+static TcpGsoTestSuite g_tcpGsoTestSuite; //!< Static variable for test initialization
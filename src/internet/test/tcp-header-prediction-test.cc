@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/red-queue-disc.h"
+#include "tcp-bulk-transfer.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpHeaderPredictionTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the header prediction fast path does not change TCP behavior
+ *
+ * The same bulk transfer through a congested queue disc is run with and
+ * without the HeaderPrediction attribute. The congestion window trace of the
+ * sender and the reception times of the receiver must be identical.
+ */
+class TcpHeaderPredictionTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param congControl the congestion control TypeId
+   * \param ecn whether the bottleneck marks packets instead of dropping them
+   */
+  TcpHeaderPredictionTest (TypeId congControl, bool ecn);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Run the transfer
+   * \param headerPrediction the HeaderPrediction attribute of the sockets
+   */
+  void RunTransfer (bool headerPrediction);
+  /**
+   * \brief Trace the congestion window of the sender
+   * \param oldValue the old value
+   * \param newValue the new value
+   */
+  void CwndChange (uint32_t oldValue, uint32_t newValue);
+  /**
+   * \brief Trace the data read by the receiver
+   * \param p the packet read
+   */
+  void ReceiverRx (Ptr<const Packet> p);
+
+  TypeId m_congControl;              //!< Congestion control
+  bool m_ecn;                        //!< Whether ECN is used
+  TcpBulkTransfer m_transfer {300000}; //!< Transfer from the sender to the receiver
+  std::vector<std::pair<int64_t, uint32_t> > m_cwnd; //!< Congestion window trace
+  std::vector<std::pair<int64_t, uint32_t> > m_rx;   //!< Reception trace
+};
+
+TcpHeaderPredictionTest::TcpHeaderPredictionTest (TypeId congControl, bool ecn)
+  : TestCase ("Header prediction with " + congControl.GetName ()
+              + (ecn ? " and ECN marking" : " and drops")),
+    m_congControl (congControl),
+    m_ecn (ecn)
+{
+}
+
+void
+TcpHeaderPredictionTest::ReceiverRx (Ptr<const Packet> p)
+{
+  m_rx.push_back (std::make_pair (Simulator::Now ().GetNanoSeconds (), p->GetSize ()));
+}
+
+void
+TcpHeaderPredictionTest::CwndChange (uint32_t oldValue, uint32_t newValue)
+{
+  m_cwnd.push_back (std::make_pair (Simulator::Now ().GetNanoSeconds (), newValue));
+}
+
+void
+TcpHeaderPredictionTest::RunTransfer (bool headerPrediction)
+{
+  m_cwnd.clear ();
+  m_rx.clear ();
+
+  Config::SetDefault ("ns3::TcpSocketBase::HeaderPrediction", BooleanValue (headerPrediction));
+  Config::SetDefault ("ns3::TcpSocketBase::UseEcn", StringValue (m_ecn ? "On" : "Off"));
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (m_congControl));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1000));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  internet.AssignStreams (nodes, 0);
+
+  SimpleNetDeviceHelper simple;
+  simple.SetNetDevicePointToPointMode (true);
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Mbps")));
+  simple.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (100)));
+  NetDeviceContainer devices = simple.Install (nodes);
+
+  TrafficControlHelper tch;
+  if (m_ecn)
+    {
+      tch.SetRootQueueDisc ("ns3::RedQueueDisc",
+                            "UseEcn", BooleanValue (true),
+                            "UseHardDrop", BooleanValue (false),
+                            "QW", DoubleValue (1),
+                            "MinTh", DoubleValue (10),
+                            "MaxTh", DoubleValue (10),
+                            "MaxSize", QueueSizeValue (QueueSize ("100p")));
+    }
+  else
+    {
+      tch.SetRootQueueDisc ("ns3::FifoQueueDisc", "MaxSize", StringValue ("15p"));
+    }
+  QueueDiscContainer queueDiscs = tch.Install (devices);
+  if (m_ecn)
+    {
+      for (uint32_t i = 0; i < queueDiscs.GetN (); i++)
+        {
+          DynamicCast<RedQueueDisc> (queueDiscs.Get (i))->AssignStreams (100 + i);
+        }
+    }
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Ptr<Socket> receiver = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  receiver->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  receiver->Listen ();
+
+  Ptr<Socket> sender = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  sender->TraceConnectWithoutContext ("CongestionWindow",
+                                      MakeCallback (&TcpHeaderPredictionTest::CwndChange, this));
+  m_transfer.SetRecvCallback (MakeCallback (&TcpHeaderPredictionTest::ReceiverRx, this));
+  m_transfer.Start (sender, receiver, InetSocketAddress (interfaces.GetAddress (1), 5000),
+                    MilliSeconds (1));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+TcpHeaderPredictionTest::DoRun (void)
+{
+  RunTransfer (false);
+  NS_TEST_ASSERT_MSG_EQ (m_transfer.GetReceivedBytes (), m_transfer.GetTotalBytes (),
+                         "Not all the data was received");
+  std::vector<std::pair<int64_t, uint32_t> > slowCwnd = m_cwnd;
+  std::vector<std::pair<int64_t, uint32_t> > slowRx = m_rx;
+
+  RunTransfer (true);
+  NS_TEST_ASSERT_MSG_EQ (m_transfer.GetReceivedBytes (), m_transfer.GetTotalBytes (),
+                         "Not all the data was received");
+  NS_TEST_ASSERT_MSG_EQ (m_cwnd.size (), slowCwnd.size (), "Different cwnd traces");
+  NS_TEST_ASSERT_MSG_GT (m_cwnd.size (), 1, "The cwnd never changed");
+  NS_TEST_ASSERT_MSG_EQ ((m_cwnd == slowCwnd), true, "Different cwnd traces");
+  NS_TEST_ASSERT_MSG_EQ (m_rx.size (), slowRx.size (), "Different reception traces");
+  NS_TEST_ASSERT_MSG_EQ ((m_rx == slowRx), true, "Different reception traces");
+
+  Config::Reset ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for the TCP header prediction fast path
+ */
+class TcpHeaderPredictionTestSuite : public TestSuite
+{
+public:
+  TcpHeaderPredictionTestSuite () : TestSuite ("tcp-header-prediction", UNIT)
+  {
+    AddTestCase (new TcpHeaderPredictionTest (TcpNewReno::GetTypeId (), false), TestCase::QUICK);
+    AddTestCase (new TcpHeaderPredictionTest (TcpDctcp::GetTypeId (), true), TestCase::QUICK);
+  }
+};
+
+static TcpHeaderPredictionTestSuite g_tcpHeaderPredictionTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,261 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-rack-tlp.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-tx-item.h"
+#include "ns3/tcp-option-sack.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpRackTlpTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief RACK loss detection test
+ *
+ * Four 1000-byte segments are sent at time 0 and the second one is SACKed
+ * after 10 ms. In the loss scenario, the DupThresh segments are SACKed and,
+ * as no reordering has been observed, the first segment is marked as lost
+ * at once. In the reordering scenario, the first segment is not marked as
+ * lost within the reordering window (a quarter of the minimum RTT) and is
+ * acknowledged 1 ms later, which reveals the reordering. The next flight
+ * of four segments, whose first segment is missing, is then SACKed: the
+ * missing segment is only marked as lost when the reordering timer expires,
+ * even though DupThresh segments have been SACKed.
+ */
+class TcpRackTlpLossDetectionTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param reordering true to run the reordering scenario
+   */
+  TcpRackTlpLossDetectionTest (bool reordering);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Send the segments not sent yet, up to a sequence number
+   * \param highTx the end sequence of the last segment to send
+   */
+  void Send (SequenceNumber32 highTx);
+  /**
+   * \brief SACK a block and run the loss detection
+   * \param begin the first sequence of the block
+   * \param end the end sequence of the block
+   * \param dupThreshReached whether DupThresh segments are SACKed
+   * \param expectedLost the expected bytes marked as lost
+   * \param expectedTimeout the expected delay of the reordering timer
+   */
+  void Sack (SequenceNumber32 begin, SequenceNumber32 end, bool dupThreshReached,
+             uint32_t expectedLost, Time expectedTimeout);
+  /**
+   * \brief Cumulatively acknowledge the segments up to a sequence number
+   * \param seq the acknowledged sequence number
+   */
+  void Ack (SequenceNumber32 seq);
+  /**
+   * \brief Run the loss detection when the reordering timer expires
+   * \param expectedLost the expected bytes marked as lost
+   */
+  void Timeout (uint32_t expectedLost);
+  /**
+   * \brief Deliver a segment to RACK, as TcpSocketBase does
+   * \param item the delivered segment
+   */
+  void Delivered (TcpTxItem *item);
+  /**
+   * \brief Deliver a cumulatively acknowledged segment to RACK, unless it
+   * was SACKed before, as TcpSocketBase does
+   * \param item the acknowledged segment
+   */
+  void Acked (TcpTxItem *item);
+  /**
+   * \brief Callback to provide a value of receiver window
+   * \returns the receiver window
+   */
+  uint32_t GetRWnd (void) const;
+
+  bool m_reordering;                  //!< Whether the reordering scenario is run
+  Ptr<TcpTxBuffer> m_txBuf;           //!< Transmission buffer
+  Ptr<TcpRackTlp> m_rack;             //!< Loss detection under test
+  Ptr<TcpOptionSack> m_sack;          //!< SACK blocks received
+  SequenceNumber32 m_highTx {1};      //!< Next sequence to send
+  const Time m_srtt {MilliSeconds (10)}; //!< Smoothed RTT
+};
+
+TcpRackTlpLossDetectionTest::TcpRackTlpLossDetectionTest (bool reordering)
+  : TestCase (reordering ? "RACK loss detection with reordering" : "RACK loss detection"),
+    m_reordering (reordering)
+{
+}
+
+uint32_t
+TcpRackTlpLossDetectionTest::GetRWnd (void) const
+{
+  return 100000;
+}
+
+void
+TcpRackTlpLossDetectionTest::Delivered (TcpTxItem *item)
+{
+  m_rack->UpdateStats (item);
+}
+
+void
+TcpRackTlpLossDetectionTest::Acked (TcpTxItem *item)
+{
+  if (!item->IsSacked ())
+    {
+      m_rack->UpdateStats (item);
+    }
+}
+
+void
+TcpRackTlpLossDetectionTest::Send (SequenceNumber32 highTx)
+{
+  while (m_highTx < highTx)
+    {
+      m_txBuf->CopyFromSequence (1000, m_highTx);
+      m_highTx += 1000;
+    }
+}
+
+void
+TcpRackTlpLossDetectionTest::Sack (SequenceNumber32 begin, SequenceNumber32 end,
+                                   bool dupThreshReached, uint32_t expectedLost,
+                                   Time expectedTimeout)
+{
+  m_sack->AddSackBlock (TcpOptionSack::SackBlock (begin, end));
+  m_txBuf->Update (m_sack->GetSackList (), MakeCallback (&TcpRackTlpLossDetectionTest::Delivered, this));
+
+  uint32_t lost = m_rack->DetectLoss (m_txBuf, m_srtt, false, dupThreshReached);
+  NS_TEST_EXPECT_MSG_EQ (lost, expectedLost, "Unexpected bytes marked as lost at " << Simulator::Now ().As (Time::MS));
+  NS_TEST_EXPECT_MSG_EQ (m_txBuf->GetLost (), expectedLost, "Unexpected lost count");
+  NS_TEST_EXPECT_MSG_EQ (m_rack->GetReorderTimeout (), expectedTimeout, "Unexpected reordering timer");
+}
+
+void
+TcpRackTlpLossDetectionTest::Ack (SequenceNumber32 seq)
+{
+  m_sack = CreateObject<TcpOptionSack> ();
+  m_txBuf->DiscardUpTo (seq, MakeCallback (&TcpRackTlpLossDetectionTest::Acked, this));
+  NS_TEST_EXPECT_MSG_EQ (m_rack->IsReorderingSeen (), true, "Reordering not detected");
+}
+
+void
+TcpRackTlpLossDetectionTest::Timeout (uint32_t expectedLost)
+{
+  uint32_t lost = m_rack->DetectLoss (m_txBuf, m_srtt, false, true);
+  NS_TEST_EXPECT_MSG_EQ (lost, expectedLost, "Unexpected bytes marked as lost at the reordering timeout");
+  NS_TEST_EXPECT_MSG_EQ (m_txBuf->GetLost (), expectedLost, "Unexpected lost count");
+}
+
+void
+TcpRackTlpLossDetectionTest::DoRun (void)
+{
+  m_txBuf = CreateObject<TcpTxBuffer> ();
+  m_txBuf->SetRWndCallback (MakeCallback (&TcpRackTlpLossDetectionTest::GetRWnd, this));
+  m_txBuf->SetSegmentSize (1000);
+  m_txBuf->SetHeadSequence (SequenceNumber32 (1));
+  m_txBuf->SetDupAckLossMarking (false);
+  m_txBuf->Add (Create<Packet> (8000));
+  m_rack = CreateObject<TcpRackTlp> ();
+  m_sack = CreateObject<TcpOptionSack> ();
+
+  Send (SequenceNumber32 (4001));
+  if (!m_reordering)
+    {
+      Simulator::Schedule (MilliSeconds (10), &TcpRackTlpLossDetectionTest::Sack, this,
+                           SequenceNumber32 (1001), SequenceNumber32 (4001), true, 1000, Seconds (0));
+    }
+  else
+    {
+      Simulator::Schedule (MilliSeconds (10), &TcpRackTlpLossDetectionTest::Sack, this,
+                           SequenceNumber32 (1001), SequenceNumber32 (2001), false, 0,
+                           MicroSeconds (2500));
+      Simulator::Schedule (MilliSeconds (11), &TcpRackTlpLossDetectionTest::Ack, this,
+                           SequenceNumber32 (4001));
+      Simulator::Schedule (MilliSeconds (11), &TcpRackTlpLossDetectionTest::Send, this,
+                           SequenceNumber32 (8001));
+      Simulator::Schedule (MilliSeconds (21), &TcpRackTlpLossDetectionTest::Sack, this,
+                           SequenceNumber32 (5001), SequenceNumber32 (8001), true, 0,
+                           MicroSeconds (2500));
+      Simulator::Schedule (MicroSeconds (23500), &TcpRackTlpLossDetectionTest::Timeout, this, 1000);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the probe timeout of TLP
+ */
+class TcpRackTlpProbeTimeoutTest : public TestCase
+{
+public:
+  TcpRackTlpProbeTimeoutTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpRackTlpProbeTimeoutTest::TcpRackTlpProbeTimeoutTest ()
+  : TestCase ("TLP probe timeout")
+{
+}
+
+void
+TcpRackTlpProbeTimeoutTest::DoRun (void)
+{
+  Ptr<TcpRackTlp> rack = CreateObject<TcpRackTlp> ();
+  NS_TEST_EXPECT_MSG_EQ (rack->IsTlpEnabled (), true, "TLP should be enabled by default");
+  NS_TEST_EXPECT_MSG_EQ (rack->GetProbeTimeout (Seconds (0), 1000, 1000), Seconds (1),
+                         "The probe timeout should be 1 s without RTT samples");
+  NS_TEST_EXPECT_MSG_EQ (rack->GetProbeTimeout (MilliSeconds (10), 2000, 1000), MilliSeconds (20),
+                         "The probe timeout should be two smoothed RTTs");
+  NS_TEST_EXPECT_MSG_EQ (rack->GetProbeTimeout (MilliSeconds (10), 1000, 1000), MilliSeconds (220),
+                         "The delayed ACK timer should be added with a single segment in flight");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for RACK-TLP
+ */
+class TcpRackTlpTestSuite : public TestSuite
+{
+public:
+  TcpRackTlpTestSuite ()
+    : TestSuite ("tcp-rack-tlp", UNIT)
+  {
+    AddTestCase (new TcpRackTlpLossDetectionTest (false), TestCase::QUICK);
+    AddTestCase (new TcpRackTlpLossDetectionTest (true), TestCase::QUICK);
+    AddTestCase (new TcpRackTlpProbeTimeoutTest (), TestCase::QUICK);
+  }
+};
+
+static TcpRackTlpTestSuite g_tcpRackTlpTestSuite; //!< Static variable for test initialization
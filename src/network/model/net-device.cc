@@ -41,4 +41,25 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+uint32_t
+NetDevice::GetSendBatchCapacity (void) const
+{
+  return 0;
+}
+
+uint32_t
+NetDevice::SendBatch (const std::vector<BatchItem> &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+  uint32_t sent = 0;
+  for (const auto &item : items)
+    {
+      if (Send (item.packet, item.dest, item.protocolNumber))
+        {
+          sent++;
+        }
+    }
+  return sent;
+}
+
 } // namespace ns3
@@ -22,6 +22,7 @@
 #define NET_DEVICE_H
 
 #include <stdint.h>
+#include <vector>
 #include "ns3/callback.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -260,6 +261,38 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber) = 0;
+
+  /**
+   * \brief A packet handed to SendBatch, with its destination and protocol
+   */
+  struct BatchItem
+  {
+    Ptr<Packet> packet;      //!< the packet
+    Address dest;            //!< mac address of the destination
+    uint16_t protocolNumber; //!< type of payload contained in the packet
+  };
+
+  /**
+   * \brief Get the number of packets the device can accept in a batch
+   *
+   * Devices that are able to take several packets in a single call (and start
+   * their transmission machinery only once) return the number of packets
+   * they can accept right now without dropping any. The default
+   * implementation returns zero, i.e., batches are not supported and
+   * callers have to use Send.
+   *
+   * \return the number of packets that can be passed to SendBatch
+   */
+  virtual uint32_t GetSendBatchCapacity (void) const;
+  /**
+   * \brief Send a batch of packets
+   *
+   * The default implementation calls Send for each packet.
+   *
+   * \param items the packets to send, in transmission order
+   * \return the number of packets that were accepted by the device
+   */
+  virtual uint32_t SendBatch (const std::vector<BatchItem> &items);
   /**
    * \returns the node base class which contains this network
    *          interface.
@@ -0,0 +1,307 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/circular-buffer.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/packet.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the buffer preserves the FIFO order while wrapping around and
+ * growing, and that iterators survive the growth.
+ */
+class CircularBufferFifoTestCase : public TestCase
+{
+public:
+  CircularBufferFifoTestCase ();
+  virtual void DoRun (void);
+};
+
+CircularBufferFifoTestCase::CircularBufferFifoTestCase ()
+  : TestCase ("Check FIFO order, wrap around and growth of the circular buffer")
+{
+}
+
+void
+CircularBufferFifoTestCase::DoRun (void)
+{
+  CircularBuffer<int> buffer;
+  NS_TEST_EXPECT_MSG_EQ (buffer.empty (), true, "The buffer should be empty");
+  NS_TEST_EXPECT_MSG_EQ ((buffer.begin () == buffer.end ()), true, "begin () should be end ()");
+
+  // wrap around the initial array several times without growing
+  int next = 1;
+  int expected = 1;
+  for (int round = 0; round < 10; round++)
+    {
+      for (int i = 0; i < 5; i++)
+        {
+          buffer.push_back (next++);
+        }
+      for (int i = 0; i < 5; i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (buffer.front (), expected++, "Unexpected FIFO order");
+          buffer.pop_front ();
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (buffer.capacity (), 8, "The buffer should not have grown");
+
+  // grow while holding an iterator to the first element
+  buffer.push_back (next++);
+  CircularBuffer<int>::const_iterator first = buffer.begin ();
+  for (int i = 0; i < 100; i++)
+    {
+      buffer.push_back (next++);
+    }
+  NS_TEST_EXPECT_MSG_EQ (buffer.size (), 101, "Unexpected number of elements");
+  NS_TEST_EXPECT_MSG_EQ (buffer.capacity (), 128, "The capacity should double");
+  NS_TEST_EXPECT_MSG_EQ ((first == buffer.begin ()), true, "The iterator should remain valid");
+  NS_TEST_EXPECT_MSG_EQ (*first, expected, "The iterator should refer to the first element");
+  NS_TEST_EXPECT_MSG_EQ (buffer.back (), next - 1, "Unexpected last element");
+
+  for (auto it = buffer.begin (); it != buffer.end (); ++it)
+    {
+      NS_TEST_EXPECT_MSG_EQ (*it, expected++, "Unexpected order after growing");
+    }
+
+  buffer.push_front (-1);
+  NS_TEST_EXPECT_MSG_EQ (buffer.front (), -1, "push_front should insert before the first element");
+  NS_TEST_EXPECT_MSG_EQ (*std::next (buffer.begin ()), *first, "The iterator should remain valid");
+
+  buffer.clear ();
+  NS_TEST_EXPECT_MSG_EQ (buffer.empty (), true, "The buffer should be empty");
+  NS_TEST_EXPECT_MSG_EQ ((buffer.begin () == buffer.end ()), true, "begin () should be end ()");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that erasing and inserting at arbitrary positions behave as with a
+ * list, including the erase-while-iterating idiom used by queue subclasses.
+ */
+class CircularBufferEraseInsertTestCase : public TestCase
+{
+public:
+  CircularBufferEraseInsertTestCase ();
+  virtual void DoRun (void);
+};
+
+CircularBufferEraseInsertTestCase::CircularBufferEraseInsertTestCase ()
+  : TestCase ("Check erase and insert at arbitrary positions of the circular buffer")
+{
+}
+
+void
+CircularBufferEraseInsertTestCase::DoRun (void)
+{
+  CircularBuffer<int> buffer;
+  for (int i = 1; i <= 10; i++)
+    {
+      buffer.push_back (i);
+    }
+
+  // erase the even elements while iterating
+  CircularBuffer<int>::const_iterator it = buffer.begin ();
+  CircularBuffer<int>::const_iterator seven;
+  while (it != buffer.end ())
+    {
+      if (*it == 7)
+        {
+          seven = it;
+        }
+      if (*it % 2 == 0)
+        {
+          auto curr = it++;
+          buffer.erase (curr);
+        }
+      else
+        {
+          it++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (buffer.size (), 5, "Five elements should be left");
+  std::vector<int> left (buffer.begin (), buffer.end ());
+  NS_TEST_EXPECT_MSG_EQ ((left == std::vector<int> {1, 3, 5, 7, 9}), true, "Unexpected elements");
+  NS_TEST_EXPECT_MSG_EQ (buffer.back (), 9, "Unexpected last element");
+  NS_TEST_EXPECT_MSG_EQ (*--buffer.end (), 9, "Decrementing end () should skip the hole");
+
+  // erasing an element returns the following one
+  it = buffer.erase (buffer.begin ());
+  NS_TEST_EXPECT_MSG_EQ (*it, 3, "erase should return the following element");
+  NS_TEST_EXPECT_MSG_EQ ((it == buffer.begin ()), true, "The first element should be 3");
+  NS_TEST_EXPECT_MSG_EQ (*seven, 7, "Erasing should not invalidate other iterators");
+
+  // inserting before 7 fills the hole left by 6
+  it = buffer.insert (seven, 6);
+  NS_TEST_EXPECT_MSG_EQ (*it, 6, "insert should return the inserted element");
+  NS_TEST_EXPECT_MSG_EQ (*seven, 7, "Filling a hole should not invalidate other iterators");
+
+  // inserting before 3 (the first element) and in the middle
+  buffer.insert (buffer.begin (), 2);
+  buffer.insert (std::next (buffer.begin ()), 20);
+  buffer.insert (buffer.end (), 11);
+  left.assign (buffer.begin (), buffer.end ());
+  NS_TEST_EXPECT_MSG_EQ ((left == std::vector<int> {2, 20, 3, 5, 6, 7, 9, 11}), true,
+                         "Unexpected elements after insertion");
+  NS_TEST_EXPECT_MSG_EQ (buffer.size (), 8, "Unexpected number of elements");
+
+  // erasing the last element
+  it = buffer.erase (--buffer.end ());
+  NS_TEST_EXPECT_MSG_EQ ((it == buffer.end ()), true, "erase should return end ()");
+  NS_TEST_EXPECT_MSG_EQ (buffer.back (), 9, "Unexpected last element");
+  while (!buffer.empty ())
+    {
+      buffer.pop_front ();
+    }
+  NS_TEST_EXPECT_MSG_EQ ((buffer.begin () == buffer.end ()), true, "begin () should be end ()");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the capacity remains bounded when elements are repeatedly
+ * erased behind a front element which stays, as done by WifiMacQueue when
+ * dequeuing by address or TID.
+ */
+class CircularBufferHolesTestCase : public TestCase
+{
+public:
+  CircularBufferHolesTestCase ();
+  virtual void DoRun (void);
+};
+
+CircularBufferHolesTestCase::CircularBufferHolesTestCase ()
+  : TestCase ("Check that the holes left behind the front element are reclaimed")
+{
+}
+
+void
+CircularBufferHolesTestCase::DoRun (void)
+{
+  CircularBuffer<int> buffer;
+  buffer.push_back (1);
+  buffer.push_back (2);
+  for (int i = 3; i < 100000; i++)
+    {
+      // append an element and erase the second one
+      buffer.push_back (i);
+      buffer.erase (std::next (buffer.begin ()));
+    }
+  NS_TEST_EXPECT_MSG_EQ (buffer.size (), 2, "Unexpected number of elements");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (buffer.capacity (), 16, "The holes should have been reclaimed");
+  NS_TEST_EXPECT_MSG_EQ (buffer.front (), 1, "The front element should stay");
+  NS_TEST_EXPECT_MSG_EQ (buffer.back (), 99999, "Unexpected last element");
+
+  // compaction keeps the order of the elements and of an insertion in the middle
+  for (int i = 0; i < 6; i++)
+    {
+      buffer.push_back (100000 + i);
+    }
+  for (int i = 0; i < 6; i++)
+    {
+      buffer.erase (std::next (buffer.begin ()));
+    }
+  auto it = buffer.insert (std::next (buffer.begin ()), 7);
+  NS_TEST_EXPECT_MSG_EQ (*it, 7, "insert should return the inserted element");
+  std::vector<int> left (buffer.begin (), buffer.end ());
+  NS_TEST_EXPECT_MSG_EQ ((left == std::vector<int> {1, 7, 100005}), true,
+                         "Unexpected elements after compaction");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a drop tail queue backed by the circular buffer keeps the FIFO
+ * order across many wrap arounds.
+ */
+class CircularBufferQueueTestCase : public TestCase
+{
+public:
+  CircularBufferQueueTestCase ();
+  virtual void DoRun (void);
+};
+
+CircularBufferQueueTestCase::CircularBufferQueueTestCase ()
+  : TestCase ("Check the FIFO order of a drop tail queue over many wrap arounds")
+{
+}
+
+void
+CircularBufferQueueTestCase::DoRun (void)
+{
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetMaxSize (QueueSize ("50p"));
+
+  std::vector<Ptr<Packet> > packets;
+  for (uint32_t i = 0; i < 60; i++)
+    {
+      packets.push_back (Create<Packet> (i + 1));
+    }
+
+  uint32_t in = 0;
+  uint32_t out = 0;
+  for (uint32_t round = 0; round < 100; round++)
+    {
+      // fill the queue up to a varying occupancy, then drain half of it
+      while (queue->GetNPackets () < 10 + round % 40)
+        {
+          NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (packets[in++ % 60]), true, "Enqueue failed");
+        }
+      uint32_t n = queue->GetNPackets () / 2;
+      for (uint32_t i = 0; i < n; i++)
+        {
+          Ptr<Packet> p = queue->Dequeue ();
+          NS_TEST_ASSERT_MSG_EQ (p, packets[out++ % 60], "Unexpected FIFO order");
+        }
+    }
+  while (!queue->IsEmpty ())
+    {
+      NS_TEST_EXPECT_MSG_EQ (queue->Dequeue (), packets[out++ % 60], "Unexpected FIFO order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (in, out, "All the packets should have been dequeued");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 0, "No packet should be dropped");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief CircularBuffer TestSuite
+ */
+class CircularBufferTestSuite : public TestSuite
+{
+public:
+  CircularBufferTestSuite ()
+    : TestSuite ("circular-buffer", UNIT)
+  {
+    AddTestCase (new CircularBufferFifoTestCase (), TestCase::QUICK);
+    AddTestCase (new CircularBufferEraseInsertTestCase (), TestCase::QUICK);
+    AddTestCase (new CircularBufferHolesTestCase (), TestCase::QUICK);
+    AddTestCase (new CircularBufferQueueTestCase (), TestCase::QUICK);
+  }
+};
+
+static CircularBufferTestSuite g_circularBufferTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,467 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef CIRCULAR_BUFFER_H
+#define CIRCULAR_BUFFER_H
+
+#include "ns3/assert.h"
+#include <cstddef>
+#include <stdint.h>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A growable double-ended container storing its elements in a
+ * contiguous circular array
+ *
+ * Appending to the back, prepending to the front and removing from the front
+ * take constant (amortized) time and do not allocate memory unless the
+ * capacity needs to grow (the capacity doubles when the array is full of
+ * elements and never shrinks). This is the container backing the Queue class, whose
+ * subclasses mostly enqueue at the back and dequeue from the front.
+ *
+ * Elements are identified by a sequence number, which selects a slot of the
+ * array. Erasing an element which is not the front one leaves a hole in its
+ * slot (a value-initialized element) rather than shifting the following
+ * elements, and iterators skip the holes. Hence, as for std::list:
+ *
+ * - inserting at the front or at the back and erasing any element do not
+ *   invalidate the iterators referring to the other elements, even when
+ *   the capacity grows;
+ * - erasing an element returns an iterator referring to the following one.
+ *
+ * Unlike std::list, inserting at the back invalidates the past-the-end
+ * iterator (which refers to the new element, if the buffer was not empty)
+ * and inserting in the middle invalidates the iterators referring to the
+ * following elements, unless a hole precedes the insertion position.
+ *
+ * The holes are released when the front element is erased. When elements
+ * are repeatedly erased behind a front element which stays, the holes are
+ * instead reclaimed by an insertion which finds the array full: if the
+ * holes are at least as many as the elements, the elements are compacted
+ * towards the front instead of growing the array, so that the capacity
+ * remains bounded by four times the largest number of elements. Such an
+ * insertion invalidates all the iterators.
+ *
+ * A value-initialized element (e.g., a null Ptr) marks a hole, hence it
+ * cannot be stored in the buffer.
+ *
+ * \tparam T \explicit the type of the elements
+ */
+template <typename T>
+class CircularBuffer
+{
+  /**
+   * \brief Bidirectional iterator over the elements of the buffer
+   * \tparam IsConst whether the elements are accessed as const
+   */
+  template <bool IsConst>
+  class IteratorBase
+  {
+  public:
+    /// Iterator category
+    typedef std::bidirectional_iterator_tag iterator_category;
+    /// Element type
+    typedef T value_type;
+    /// Difference type
+    typedef std::ptrdiff_t difference_type;
+    /// Pointer to an element
+    typedef typename std::conditional<IsConst, const T *, T *>::type pointer;
+    /// Reference to an element
+    typedef typename std::conditional<IsConst, const T &, T &>::type reference;
+    /// Pointer to the buffer
+    typedef typename std::conditional<IsConst, const CircularBuffer *, CircularBuffer *>::type BufferPointer;
+
+    IteratorBase ()
+      : m_buffer (0),
+        m_seq (0)
+    {
+    }
+
+    /**
+     * Construct an iterator.
+     * \param buffer the buffer
+     * \param seq the sequence number of the element
+     */
+    IteratorBase (BufferPointer buffer, uint64_t seq)
+      : m_buffer (buffer),
+        m_seq (seq)
+    {
+    }
+
+    /**
+     * Convert an iterator into a const iterator.
+     * \param o the iterator
+     */
+    template <bool C, typename = typename std::enable_if<IsConst && !C>::type>
+    IteratorBase (const IteratorBase<C> &o)
+      : m_buffer (o.m_buffer),
+        m_seq (o.m_seq)
+    {
+    }
+
+    /// \returns a reference to the element
+    reference operator* () const
+    {
+      return m_buffer->m_slots[m_seq & m_buffer->m_mask];
+    }
+
+    /// \returns a pointer to the element
+    pointer operator-> () const
+    {
+      return &m_buffer->m_slots[m_seq & m_buffer->m_mask];
+    }
+
+    /// \returns the iterator referring to the next element
+    IteratorBase & operator++ ()
+    {
+      do
+        {
+          ++m_seq;
+        }
+      while (m_seq != m_buffer->m_tail && m_buffer->IsHole (m_seq));
+      return *this;
+    }
+
+    /// \returns the iterator before the increment
+    IteratorBase operator++ (int)
+    {
+      IteratorBase tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    /// \returns the iterator referring to the previous element
+    IteratorBase & operator-- ()
+    {
+      do
+        {
+          --m_seq;
+        }
+      while (m_seq != m_buffer->m_head && m_buffer->IsHole (m_seq));
+      return *this;
+    }
+
+    /// \returns the iterator before the decrement
+    IteratorBase operator-- (int)
+    {
+      IteratorBase tmp = *this;
+      --*this;
+      return tmp;
+    }
+
+    /**
+     * \param o another iterator
+     * \returns true if both iterators refer to the same element
+     */
+    template <bool C>
+    bool operator== (const IteratorBase<C> &o) const
+    {
+      return m_buffer == o.m_buffer && m_seq == o.m_seq;
+    }
+
+    /**
+     * \param o another iterator
+     * \returns true if the iterators refer to different elements
+     */
+    template <bool C>
+    bool operator!= (const IteratorBase<C> &o) const
+    {
+      return !(*this == o);
+    }
+
+  private:
+    template <bool C> friend class IteratorBase;
+    friend class CircularBuffer;
+
+    BufferPointer m_buffer;  //!< the buffer
+    uint64_t m_seq;          //!< the sequence number of the element
+  };
+
+public:
+  /// Element type
+  typedef T value_type;
+  /// Size type
+  typedef std::size_t size_type;
+  /// Iterator
+  typedef IteratorBase<false> iterator;
+  /// Const iterator
+  typedef IteratorBase<true> const_iterator;
+
+  CircularBuffer ()
+    : m_mask (0),
+      m_head (0),
+      m_tail (0),
+      m_size (0)
+  {
+  }
+
+  /// \returns the number of elements
+  size_type size (void) const
+  {
+    return m_size;
+  }
+
+  /// \returns true if the buffer has no element
+  bool empty (void) const
+  {
+    return m_size == 0;
+  }
+
+  /// \returns the number of slots of the array
+  size_type capacity (void) const
+  {
+    return m_slots.size ();
+  }
+
+  /// \returns an iterator referring to the first element
+  iterator begin (void)
+  {
+    return iterator (this, m_head);
+  }
+
+  /// \returns a const iterator referring to the first element
+  const_iterator begin (void) const
+  {
+    return const_iterator (this, m_head);
+  }
+
+  /// \returns a const iterator referring to the first element
+  const_iterator cbegin (void) const
+  {
+    return const_iterator (this, m_head);
+  }
+
+  /// \returns the past-the-end iterator
+  iterator end (void)
+  {
+    return iterator (this, m_tail);
+  }
+
+  /// \returns the past-the-end const iterator
+  const_iterator end (void) const
+  {
+    return const_iterator (this, m_tail);
+  }
+
+  /// \returns the past-the-end const iterator
+  const_iterator cend (void) const
+  {
+    return const_iterator (this, m_tail);
+  }
+
+  /// \returns the first element
+  const T & front (void) const
+  {
+    NS_ASSERT (!empty ());
+    return m_slots[m_head & m_mask];
+  }
+
+  /// \returns the last element
+  const T & back (void) const
+  {
+    NS_ASSERT (!empty ());
+    return *--end ();
+  }
+
+  /**
+   * \brief Append an element
+   * \param value the element
+   */
+  void push_back (const T &value)
+  {
+    insert (end (), value);
+  }
+
+  /**
+   * \brief Prepend an element
+   * \param value the element
+   */
+  void push_front (const T &value)
+  {
+    insert (begin (), value);
+  }
+
+  /**
+   * \brief Remove the first element
+   */
+  void pop_front (void)
+  {
+    erase (begin ());
+  }
+
+  /**
+   * \brief Insert an element
+   * \param pos the element before which the new element is inserted
+   * \param value the element
+   * \returns an iterator referring to the inserted element
+   */
+  iterator insert (const_iterator pos, const T &value)
+  {
+    NS_ASSERT (pos.m_buffer == this && pos.m_seq - m_head <= m_tail - m_head);
+    NS_ASSERT_MSG (!(value == T ()), "Cannot store a value-initialized element");
+    uint64_t seq = pos.m_seq;
+    ++m_size;
+    if (seq != m_head && IsHole (seq - 1))
+      {
+        // fill the hole preceding pos
+        m_slots[(seq - 1) & m_mask] = value;
+        return iterator (this, seq - 1);
+      }
+    if (m_tail - m_head + 1 > m_slots.size () && 2 * (m_size - 1) <= m_tail - m_head)
+      {
+        // the holes outnumber the elements (not counting the new one)
+        seq = Compact (seq);
+      }
+    Reserve (m_tail - m_head + 1);
+    if (seq == m_head)
+      {
+        --m_head;
+        m_slots[m_head & m_mask] = value;
+        return iterator (this, m_head);
+      }
+    // shift the following elements towards the back
+    for (uint64_t s = m_tail; s != seq; --s)
+      {
+        m_slots[s & m_mask] = std::move (m_slots[(s - 1) & m_mask]);
+      }
+    ++m_tail;
+    m_slots[seq & m_mask] = value;
+    return iterator (this, seq);
+  }
+
+  /**
+   * \brief Erase an element
+   * \param pos the element to erase
+   * \returns an iterator referring to the element following the erased one
+   */
+  iterator erase (const_iterator pos)
+  {
+    NS_ASSERT (pos.m_buffer == this && pos.m_seq - m_head < m_tail - m_head);
+    NS_ASSERT (!IsHole (pos.m_seq));
+    iterator next (this, pos.m_seq);
+    ++next;
+    m_slots[pos.m_seq & m_mask] = T ();
+    --m_size;
+    if (pos.m_seq == m_head)
+      {
+        // release the holes at the front
+        m_head = next.m_seq;
+      }
+    return next;
+  }
+
+  /**
+   * \brief Erase all the elements
+   *
+   * The capacity is unchanged.
+   */
+  void clear (void)
+  {
+    for (uint64_t s = m_head; s != m_tail; ++s)
+      {
+        m_slots[s & m_mask] = T ();
+      }
+    m_head = m_tail;
+    m_size = 0;
+  }
+
+private:
+  /**
+   * \param seq a sequence number
+   * \returns true if the slot of the given sequence number is a hole
+   */
+  bool IsHole (uint64_t seq) const
+  {
+    return m_slots[seq & m_mask] == T ();
+  }
+
+  /**
+   * \brief Move the elements towards the front to fill the holes
+   * \param pos the sequence number of an insertion position
+   * \returns the sequence number of the insertion position after compaction
+   */
+  uint64_t Compact (uint64_t pos)
+  {
+    uint64_t dst = m_head;
+    uint64_t newPos = m_tail;
+    for (uint64_t s = m_head; s != m_tail; ++s)
+      {
+        if (s == pos)
+          {
+            newPos = dst;
+          }
+        if (!IsHole (s))
+          {
+            if (dst != s)
+              {
+                m_slots[dst & m_mask] = std::move (m_slots[s & m_mask]);
+                m_slots[s & m_mask] = T ();
+              }
+            ++dst;
+          }
+      }
+    if (pos == m_tail)
+      {
+        newPos = dst;
+      }
+    m_tail = dst;
+    return newPos;
+  }
+
+  /**
+   * \brief Grow the array, if needed, to have the given number of slots
+   * \param n the number of slots
+   */
+  void Reserve (uint64_t n)
+  {
+    if (n <= m_slots.size ())
+      {
+        return;
+      }
+    std::size_t capacity = (m_slots.empty () ? 8 : m_slots.size ());
+    while (capacity < n)
+      {
+        capacity *= 2;
+      }
+    // the sequence numbers are kept, so that the iterators remain valid
+    std::vector<T> slots (capacity);
+    uint64_t mask = capacity - 1;
+    for (uint64_t s = m_head; s != m_tail; ++s)
+      {
+        slots[s & mask] = std::move (m_slots[s & m_mask]);
+      }
+    m_slots.swap (slots);
+    m_mask = mask;
+  }
+
+  std::vector<T> m_slots;  //!< the array, whose size is a power of two
+  uint64_t m_mask;         //!< the size of the array minus one
+  uint64_t m_head;         //!< the sequence number of the first element
+  uint64_t m_tail;         //!< the sequence number following the last element
+  size_type m_size;        //!< the number of elements
+};
+
+} // namespace ns3
+
+#endif /* CIRCULAR_BUFFER_H */
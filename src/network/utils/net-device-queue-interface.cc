@@ -36,6 +36,12 @@ NetDeviceQueue::GetTypeId (void)
     .SetParent<Object> ()
     .SetGroupName("Network")
     .AddConstructor<NetDeviceQueue> ()
+    .AddAttribute ("WakeThreshold",
+                   "The number of MTU-sized packets that must fit in the device "
+                   "queue for a stopped queue to be woken up",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&NetDeviceQueue::m_wakeThreshold),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
@@ -43,6 +49,7 @@ NetDeviceQueue::GetTypeId (void)
 NetDeviceQueue::NetDeviceQueue ()
   : m_stoppedByDevice (false),
     m_stoppedByQueueLimits (false),
+    m_wakeThreshold (1),
     NS_LOG_TEMPLATE_DEFINE ("NetDeviceQueueInterface")
 {
   NS_LOG_FUNCTION (this);
@@ -51,6 +51,12 @@ class QueueItem;
  * includes the state of the transmission queue (whether it has been
  * stopped or not) and data used by techniques such as Byte Queue Limits.
  *
+ * A queue stopped by the device is woken up when a packet is dequeued and the
+ * device queue has room for WakeThreshold MTU-sized packets (or is empty).
+ * Thresholds larger than one (like the TX wake thresholds of many Linux
+ * drivers) let the queue disc send larger batches of packets to the devices
+ * that support them, with fewer wake-ups.
+ *
  * This class roughly models the struct netdev_queue of Linux.
  */
 class NetDeviceQueue : public Object
@@ -209,6 +215,7 @@ private:
   Ptr<QueueLimits> m_queueLimits; //!< Queue limits object
   WakeCallback m_wakeCallback;    //!< Wake callback
   Ptr<NetDevice> m_device;        //!< the netdevice aggregated to the NetDeviceQueueInterface
+  uint32_t m_wakeThreshold;       //!< Room (in MTU-sized packets) needed to wake the queue
 
   NS_LOG_TEMPLATE_DECLARE;        //!< redefinition of the log component
 };
@@ -372,11 +379,17 @@ NetDeviceQueue::PacketDequeued (QueueType* queue, Ptr<const typename QueueType::
   NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
   Ptr<Packet> p = Create<Packet> (m_device->GetMtu ());
 
-  // After dequeuing a packet, if there is room for another packet we
+  // After dequeuing a packet, if there is room for WakeThreshold packets we
   // call Wake () that ensures that the queue is not stopped and restarts
   // the queue disc if the queue was stopped
 
-  if (queue->GetCurrentSize () + p <= queue->GetMaxSize ())
+  auto room = queue->GetCurrentSize ();
+  for (uint32_t i = 0; i < m_wakeThreshold; i++)
+    {
+      room = room + p;
+    }
+
+  if (room <= queue->GetMaxSize () || queue->IsEmpty ())
     {
       Wake ();
     }
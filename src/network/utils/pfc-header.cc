@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "pfc-header.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PfcHeader");
+
+NS_OBJECT_ENSURE_REGISTERED (PfcHeader);
+
+constexpr uint16_t PfcHeader::PROT_NUMBER;
+constexpr uint16_t PfcHeader::OPCODE;
+constexpr uint8_t PfcHeader::N_PRIORITIES;
+constexpr uint32_t PfcHeader::QUANTUM_BITS;
+
+/// Size of a PFC frame: the minimum Ethernet payload
+static const uint32_t PFC_FRAME_SIZE = 46;
+
+PfcHeader::PfcHeader ()
+  : m_opcode (OPCODE),
+    m_classEnable (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_quanta.fill (0);
+}
+
+void
+PfcHeader::SetPauseQuanta (uint8_t priority, uint16_t quanta)
+{
+  NS_LOG_FUNCTION (this << +priority << quanta);
+  NS_ASSERT (priority < N_PRIORITIES);
+  m_classEnable |= (1 << priority);
+  m_quanta[priority] = quanta;
+}
+
+uint16_t
+PfcHeader::GetPauseQuanta (uint8_t priority) const
+{
+  NS_ASSERT (priority < N_PRIORITIES);
+  return m_quanta[priority];
+}
+
+bool
+PfcHeader::IsEnabled (uint8_t priority) const
+{
+  NS_ASSERT (priority < N_PRIORITIES);
+  return m_opcode == OPCODE && (m_classEnable & (1 << priority));
+}
+
+Time
+PfcHeader::QuantaToTime (uint16_t quanta, DataRate rate)
+{
+  return rate.CalculateBytesTxTime (quanta * QUANTUM_BITS / 8);
+}
+
+TypeId
+PfcHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PfcHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Network")
+    .AddConstructor<PfcHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+PfcHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+PfcHeader::Print (std::ostream &os) const
+{
+  os << "opcode=0x" << std::hex << m_opcode << std::dec;
+  for (uint8_t i = 0; i < N_PRIORITIES; i++)
+    {
+      if (m_classEnable & (1 << i))
+        {
+          os << " prio" << +i << "=" << m_quanta[i];
+        }
+    }
+}
+
+uint32_t
+PfcHeader::GetSerializedSize (void) const
+{
+  return PFC_FRAME_SIZE;
+}
+
+void
+PfcHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteHtonU16 (m_opcode);
+  i.WriteHtonU16 (m_classEnable);
+  for (uint16_t quanta : m_quanta)
+    {
+      i.WriteHtonU16 (quanta);
+    }
+  i.WriteU8 (0, PFC_FRAME_SIZE - 4 - 2 * N_PRIORITIES);
+}
+
+uint32_t
+PfcHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_opcode = i.ReadNtohU16 ();
+  m_classEnable = i.ReadNtohU16 ();
+  for (uint16_t &quanta : m_quanta)
+    {
+      quanta = i.ReadNtohU16 ();
+    }
+  i.Next (PFC_FRAME_SIZE - 4 - 2 * N_PRIORITIES);
+  return GetSerializedSize ();
+}
+
+} // namespace ns3
@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PFC_HEADER_H
+#define PFC_HEADER_H
+
+#include <stdint.h>
+#include <array>
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Priority-based Flow Control (IEEE 802.1Qbb) frame
+ *
+ * A PFC frame is a MAC Control frame (EtherType 0x8808, opcode 0x0101) which
+ * asks the receiver to stop transmitting the frames of the priorities enabled
+ * in its class-enable vector for the given time, expressed in pause quanta of
+ * 512 bit times at the speed of the link. A time of zero resumes the priority
+ * immediately. The frame is padded to the minimum Ethernet payload (46 bytes).
+ */
+class PfcHeader : public Header
+{
+public:
+  PfcHeader ();
+
+  /**
+   * \brief Enable a priority and set its pause time
+   * \param priority the priority
+   * \param quanta the pause time in pause quanta (zero to resume)
+   */
+  void SetPauseQuanta (uint8_t priority, uint16_t quanta);
+  /**
+   * \brief Get the pause time of a priority
+   * \param priority the priority
+   * \return the pause time in pause quanta
+   */
+  uint16_t GetPauseQuanta (uint8_t priority) const;
+  /**
+   * \brief Check whether a priority is enabled in the class-enable vector
+   * \param priority the priority
+   * \return true if the frame applies to the given priority
+   */
+  bool IsEnabled (uint8_t priority) const;
+
+  /**
+   * \brief Convert a pause time into a duration
+   * \param quanta the pause time in pause quanta
+   * \param rate the speed of the link
+   * \return the duration of the pause
+   */
+  static Time QuantaToTime (uint16_t quanta, DataRate rate);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  static constexpr uint16_t PROT_NUMBER = 0x8808;  //!< EtherType of MAC Control frames
+  static constexpr uint16_t OPCODE = 0x0101;       //!< Opcode of PFC frames
+  static constexpr uint8_t N_PRIORITIES = 8;       //!< Number of priorities
+  static constexpr uint32_t QUANTUM_BITS = 512;    //!< Bit times in a pause quantum
+
+private:
+  uint16_t m_opcode;                              //!< MAC Control opcode
+  uint16_t m_classEnable;                         //!< Class-enable vector
+  std::array<uint16_t, N_PRIORITIES> m_quanta;    //!< Pause time of each priority
+};
+
+} // namespace ns3
+
+#endif /* PFC_HEADER_H */
@@ -146,4 +146,11 @@ QueueDiscItem::Hash (uint32_t perturbation) const
   return 0;
 }
 
+bool
+QueueDiscItem::Segment (std::vector<Ptr<QueueDiscItem> > &segments) const
+{
+  NS_LOG_FUNCTION (this);
+  return false;
+}
+
 } // namespace ns3
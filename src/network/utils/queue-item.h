@@ -24,6 +24,7 @@
 #include "ns3/simple-ref-count.h"
 #include <ns3/address.h>
 #include "ns3/nstime.h"
+#include <vector>
 
 namespace ns3 {
 
@@ -226,6 +227,21 @@ public:
    */
   virtual uint32_t Hash (uint32_t perturbation = 0) const;
 
+  /**
+   * \brief Split a segmentation offload (GSO) super-packet into wire packets
+   *
+   * Transport protocols may hand down to the traffic control layer a single
+   * packet carrying several segments, which must be split before being
+   * enqueued in a queue disc or sent to a device. This method just returns
+   * false, meaning that the item does not need to be split. Subclasses that
+   * support segmentation offload append the resulting items to the given
+   * vector and return true.
+   *
+   * \param segments the vector to which the resulting items are appended
+   * \return true if this item was split into the given segments
+   */
+  virtual bool Segment (std::vector<Ptr<QueueDiscItem> > &segments) const;
+
 private:
   /**
    * \brief Default constructor
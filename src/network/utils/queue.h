@@ -31,9 +31,9 @@
 #include "ns3/log.h"
 #include "ns3/queue-size.h"
 #include "ns3/queue-item.h"
+#include "ns3/circular-buffer.h"
 #include <string>
 #include <sstream>
-#include <list>
 
 namespace ns3 {
 
@@ -301,9 +301,9 @@ public:
 protected:
 
   /// Const iterator.
-  typedef typename std::list<Ptr<Item> >::const_iterator ConstIterator;
+  typedef typename CircularBuffer<Ptr<Item> >::const_iterator ConstIterator;
   /// Iterator.
-  typedef typename std::list<Ptr<Item> >::iterator Iterator;
+  typedef typename CircularBuffer<Ptr<Item> >::iterator Iterator;
 
   /**
    * \brief Get a const iterator which refers to the first item in the queue.
@@ -419,7 +419,7 @@ protected:
   void DropAfterDequeue (Ptr<Item> item);
 
 private:
-  std::list<Ptr<Item> > m_packets;          //!< the items in the queue
+  CircularBuffer<Ptr<Item> > m_packets;     //!< the items in the queue
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
 
   /// Traced callback: fired when a packet is enqueued
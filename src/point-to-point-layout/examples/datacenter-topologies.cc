@@ -0,0 +1,212 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program builds a fat-tree, leaf-spine or dragonfly topology with the
+// datacenter topology helpers and reports the number of nodes and links and
+// the wall-clock time spent in each phase of the construction. Unless
+// routing is disabled, global routing tables are populated and the first
+// host sends a few UDP echo requests to the last host. If switchDevices is
+// enabled, the switches are modeled by FabricSwitchNetDevice objects (which
+// forward packets without the Internet stack, optionally in cut-through
+// mode) and their forwarding tables are populated instead. Otherwise, if
+// forwardingOnly is enabled, only the components needed to forward packets
+// are installed on the switches (no transport protocols and no IPv6).
+// Sample usage:
+//   ./waf --run 'datacenter-topologies --topology=fat-tree --k=34 --routing=false'
+//   ./waf --run 'datacenter-topologies --topology=leaf-spine --nLeaf=32 --oversubscription=3'
+//   ./waf --run 'datacenter-topologies --topology=dragonfly --p=4 --a=8 --h=4'
+//   ./waf --run 'datacenter-topologies --switchDevices=true --cutThrough=true'
+//   ./waf --run 'datacenter-topologies --forwardingOnly=true'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/traffic-control-module.h"
+#include "ns3/applications-module.h"
+#include <iostream>
+#include <memory>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DatacenterTopologies");
+
+/**
+ * Print the time spent in a phase and restart the clock.
+ * \param clock the clock
+ * \param phase the name of the phase
+ */
+static void
+Report (SystemWallClockMs &clock, std::string phase)
+{
+  std::cout << phase << ": " << clock.End () << " ms" << std::endl;
+  clock.Start ();
+}
+
+/**
+ * Count the echo replies.
+ * \param replies the number of replies
+ * \param p the reply
+ */
+static void
+CountReply (uint32_t *replies, Ptr<const Packet> p)
+{
+  (*replies)++;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string topology = "fat-tree";
+  uint32_t k = 4;
+  uint32_t nLeaf = 4;
+  uint32_t nSpine = 2;
+  uint32_t hostsPerLeaf = 8;
+  double oversubscription = 0;
+  uint32_t p = 2;
+  uint32_t a = 4;
+  uint32_t h = 2;
+  uint32_t g = 0;
+  bool routing = true;
+  bool switchDevices = false;
+  bool cutThrough = false;
+  bool forwardingOnly = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("topology", "Topology to build (fat-tree, leaf-spine or dragonfly)", topology);
+  cmd.AddValue ("k", "Number of ports of the fat-tree switches", k);
+  cmd.AddValue ("nLeaf", "Number of leaf switches", nLeaf);
+  cmd.AddValue ("nSpine", "Number of spine switches", nSpine);
+  cmd.AddValue ("hostsPerLeaf", "Number of hosts per leaf switch", hostsPerLeaf);
+  cmd.AddValue ("oversubscription", "Oversubscription of the leaf switches (0 to keep the uplink rate)", oversubscription);
+  cmd.AddValue ("p", "Number of hosts per dragonfly router", p);
+  cmd.AddValue ("a", "Number of routers per dragonfly group", a);
+  cmd.AddValue ("h", "Number of global links per dragonfly router", h);
+  cmd.AddValue ("g", "Number of dragonfly groups (0 for the maximum)", g);
+  cmd.AddValue ("routing", "Populate the routing tables and send echo requests", routing);
+  cmd.AddValue ("switchDevices", "Model the switches with FabricSwitchNetDevice objects", switchDevices);
+  cmd.AddValue ("cutThrough", "Enable cut-through switching in the switch devices", cutThrough);
+  cmd.AddValue ("forwardingOnly", "Install only the forwarding components of the Internet stack on the switches", forwardingOnly);
+  cmd.Parse (argc, argv);
+
+  PointToPointHelper hostLinks;
+  hostLinks.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  hostLinks.SetChannelAttribute ("Delay", StringValue ("1us"));
+
+  PointToPointHelper fabricLinks;
+  fabricLinks.SetDeviceAttribute ("DataRate", StringValue ("40Gbps"));
+  fabricLinks.SetChannelAttribute ("Delay", StringValue ("1us"));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+
+  std::unique_ptr<PointToPointFabricHelper> fabric;
+  if (topology == "fat-tree")
+    {
+      fabric.reset (new PointToPointFatTreeHelper (k, hostLinks, fabricLinks));
+    }
+  else if (topology == "leaf-spine")
+    {
+      auto leafSpine = new PointToPointLeafSpineHelper (nLeaf, nSpine, hostsPerLeaf,
+                                                        hostLinks, fabricLinks, oversubscription);
+      std::cout << "Oversubscription: " << leafSpine->GetOversubscription () << std::endl;
+      fabric.reset (leafSpine);
+    }
+  else if (topology == "dragonfly")
+    {
+      PointToPointHelper globalLinks;
+      globalLinks.SetDeviceAttribute ("DataRate", StringValue ("40Gbps"));
+      globalLinks.SetChannelAttribute ("Delay", StringValue ("5us"));
+      fabric.reset (new PointToPointDragonflyHelper (p, a, h, g, hostLinks, fabricLinks, globalLinks));
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown topology " << topology);
+    }
+  std::cout << fabric->HostCount () << " hosts, " << fabric->SwitchCount () << " switches, "
+            << fabric->FabricLinkCount () << " fabric links" << std::endl;
+  Report (clock, "Nodes and links");
+
+  if (switchDevices)
+    {
+      fabric->SetSwitchDeviceAttribute ("CutThrough", BooleanValue (cutThrough));
+      fabric->InstallSwitchDevices ();
+      Report (clock, "Switch devices");
+    }
+
+  InternetStackHelper stack;
+  InternetStackHelper switchStack;
+  switchStack.SetForwardingOnly (forwardingOnly);
+  fabric->InstallStack (stack, switchStack);
+  Report (clock, "Internet stack");
+
+  TrafficControlHelper hostTch;
+  hostTch.SetRootQueueDisc ("ns3::FifoQueueDisc");
+  TrafficControlHelper switchTch;
+  switchTch.SetRootQueueDisc ("ns3::RedQueueDisc",
+                              "UseEcn", BooleanValue (true),
+                              "MinTh", DoubleValue (65),
+                              "MaxTh", DoubleValue (65));
+  fabric->InstallTrafficControl (hostTch, switchTch);
+  Report (clock, "Traffic control");
+
+  if (switchDevices)
+    {
+      fabric->AssignHostIpv4Addresses (Ipv4AddressHelper ("10.0.0.0", "255.0.0.0"));
+    }
+  else
+    {
+      fabric->AssignIpv4Addresses (Ipv4AddressHelper ("10.0.0.0", "255.255.255.252"),
+                                   Ipv4AddressHelper ("11.0.0.0", "255.255.255.252"));
+    }
+  Report (clock, "IPv4 addresses");
+
+  if (!routing)
+    {
+      Simulator::Destroy ();
+      return 0;
+    }
+
+  if (switchDevices)
+    {
+      fabric->PopulateSwitchTables ();
+    }
+  else
+    {
+      Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+    }
+  Report (clock, "Routing tables");
+
+  uint32_t last = fabric->HostCount () - 1;
+  UdpEchoServerHelper server (9);
+  server.Install (fabric->GetHost (last)).Start (Seconds (0));
+  UdpEchoClientHelper client (fabric->GetHostIpv4Address (last), 9);
+  client.SetAttribute ("MaxPackets", UintegerValue (3));
+  client.SetAttribute ("Interval", TimeValue (MilliSeconds (1)));
+  ApplicationContainer apps = client.Install (fabric->GetHost (0));
+  apps.Start (Seconds (0));
+
+  uint32_t replies = 0;
+  apps.Get (0)->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&CountReply, &replies));
+
+  Simulator::Stop (MilliSeconds (10));
+  Simulator::Run ();
+  Report (clock, "Simulation");
+  std::cout << "Echo replies from " << fabric->GetHostIpv4Address (last) << ": " << replies << std::endl;
+  Simulator::Destroy ();
+
+  return 0;
+}
@@ -0,0 +1,432 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Implement a lightweight switch forwarding IPv4 packets between p2p devices.
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/channel.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/ppp-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/fabric-switch-net-device.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FabricSwitchNetDevice");
+
+NS_OBJECT_ENSURE_REGISTERED (FabricSwitchNetDevice);
+
+TypeId
+FabricSwitchNetDevice::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FabricSwitchNetDevice")
+    .SetParent<NetDevice> ()
+    .SetGroupName ("PointToPointLayout")
+    .AddConstructor<FabricSwitchNetDevice> ()
+    .AddAttribute ("Mtu", "The MAC-level Maximum Transmission Unit",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&FabricSwitchNetDevice::SetMtu,
+                                         &FabricSwitchNetDevice::GetMtu),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("CutThrough",
+                   "Whether the ports receive packets as soon as their first "
+                   "CutThroughBytes bytes have been received",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FabricSwitchNetDevice::m_cutThrough),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CutThroughBytes",
+                   "The number of bytes received before a packet is forwarded, "
+                   "if cut-through switching is enabled",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&FabricSwitchNetDevice::m_cutThroughBytes),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ForwardingDelay",
+                   "The latency of the switching pipeline",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&FabricSwitchNetDevice::m_forwardingDelay),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("EcmpHashSeed",
+                   "The seed of the hash of the five-tuple used to select "
+                   "among the ports of a route",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FabricSwitchNetDevice::m_hashSeed),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("Drop",
+                     "A packet has been dropped because its TTL expired "
+                     "or no route matched its destination",
+                     MakeTraceSourceAccessor (&FabricSwitchNetDevice::m_dropTrace),
+                     "ns3::FabricSwitchNetDevice::DropTracedCallback")
+  ;
+  return tid;
+}
+
+FabricSwitchNetDevice::FabricSwitchNetDevice ()
+  : m_node (0),
+    m_ifIndex (0),
+    m_mtu (1500),
+    m_cutThrough (false),
+    m_cutThroughBytes (64),
+    m_hashSeed (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FabricSwitchNetDevice::~FabricSwitchNetDevice ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FabricSwitchNetDevice::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_ports.clear ();
+  m_portIndex.clear ();
+  m_routes.clear ();
+  m_tc = 0;
+  m_node = 0;
+  NetDevice::DoDispose ();
+}
+
+uint32_t
+FabricSwitchNetDevice::AddPort (Ptr<PointToPointNetDevice> port)
+{
+  NS_LOG_FUNCTION (this << port);
+  NS_ASSERT_MSG (m_node != 0, "The switch must be added to a node before its ports");
+  NS_ASSERT_MSG (port->GetNode () == m_node, "The port must belong to the node of the switch");
+
+  if (m_tc == 0)
+    {
+      m_tc = m_node->GetObject<TrafficControlLayer> ();
+      if (m_tc == 0)
+        {
+          m_tc = CreateObject<TrafficControlLayer> ();
+          m_node->AggregateObject (m_tc);
+        }
+    }
+  if (m_address == Mac48Address ())
+    {
+      m_address = Mac48Address::ConvertFrom (port->GetAddress ());
+    }
+  if (m_cutThrough)
+    {
+      port->SetAttribute ("CutThroughBytes", UintegerValue (m_cutThroughBytes));
+    }
+
+  // Packets go through the traffic control layer, which accounts for them
+  // in the shared buffer, if any, before handing them to the switch
+  m_node->RegisterProtocolHandler (MakeCallback (&TrafficControlLayer::Receive, m_tc),
+                                   0, port);
+  m_tc->RegisterProtocolHandler (MakeCallback (&FabricSwitchNetDevice::ReceiveFromPort, this),
+                                 0, port);
+
+  uint32_t index = m_ports.size ();
+  m_ports.push_back (port);
+  m_portIndex[port] = index;
+  return index;
+}
+
+uint32_t
+FabricSwitchNetDevice::GetNPorts (void) const
+{
+  return m_ports.size ();
+}
+
+Ptr<PointToPointNetDevice>
+FabricSwitchNetDevice::GetPort (uint32_t n) const
+{
+  NS_ASSERT (n < m_ports.size ());
+  return m_ports[n];
+}
+
+void
+FabricSwitchNetDevice::AddRoute (Ipv4Address network, Ipv4Mask mask, uint32_t port)
+{
+  NS_LOG_FUNCTION (this << network << mask << port);
+  NS_ASSERT_MSG (port < m_ports.size (), "Invalid port " << port);
+
+  std::vector<uint32_t> &ports = m_routes[mask.GetPrefixLength ()][network.Get () & mask.Get ()];
+  if (std::find (ports.begin (), ports.end (), port) == ports.end ())
+    {
+      ports.push_back (port);
+    }
+}
+
+void
+FabricSwitchNetDevice::ClearRoutes (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routes.clear ();
+}
+
+uint32_t
+FabricSwitchNetDevice::GetNRoutes (void) const
+{
+  uint32_t n = 0;
+  for (auto& routes : m_routes)
+    {
+      n += routes.second.size ();
+    }
+  return n;
+}
+
+const std::vector<uint32_t> *
+FabricSwitchNetDevice::Lookup (Ipv4Address destination) const
+{
+  for (auto& routes : m_routes)
+    {
+      uint32_t mask = (routes.first == 0 ? 0 : 0xffffffff << (32 - routes.first));
+      auto it = routes.second.find (destination.Get () & mask);
+      if (it != routes.second.end ())
+        {
+          return &it->second;
+        }
+    }
+  return 0;
+}
+
+void
+FabricSwitchNetDevice::ReceiveFromPort (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                        uint16_t protocol, const Address &source,
+                                        const Address &destination, PacketType packetType)
+{
+  NS_LOG_FUNCTION (this << device << packet << protocol);
+
+  auto it = m_portIndex.find (device);
+  NS_ASSERT (it != m_portIndex.end ());
+  uint32_t inPort = it->second;
+
+  if (protocol != Ipv4L3Protocol::PROT_NUMBER)
+    {
+      NS_LOG_LOGIC ("Ignore a packet of protocol " << protocol);
+      return;
+    }
+
+  Ptr<Packet> p = packet->Copy ();
+  Ipv4Header header;
+  p->RemoveHeader (header);
+
+  if (header.GetTtl () <= 1)
+    {
+      NS_LOG_LOGIC ("TTL expired for " << header.GetDestination ());
+      m_dropTrace (header, p, inPort);
+      return;
+    }
+  header.SetTtl (header.GetTtl () - 1);
+  if (Node::ChecksumEnabled ())
+    {
+      header.EnableChecksum ();
+    }
+
+  const std::vector<uint32_t> *ports = Lookup (header.GetDestination ());
+  if (ports == 0)
+    {
+      NS_LOG_LOGIC ("No route to " << header.GetDestination ());
+      m_dropTrace (header, p, inPort);
+      return;
+    }
+  uint32_t outPort = (*ports)[0];
+  if (ports->size () > 1)
+    {
+      outPort = (*ports)[Ipv4GlobalRouting::GetFlowHash (header, p, true, m_hashSeed) % ports->size ()];
+    }
+
+  Time delay = m_forwardingDelay;
+  // A packet received before its end (cut-through) must be held until it
+  // has been entirely received if the output port is faster than the input
+  // port, otherwise its transmission would end before its reception
+  Ptr<PointToPointNetDevice> in = m_ports[inPort];
+  uint32_t size = packet->GetSize () + PppHeader ().GetSerializedSize ();
+  uint32_t received = in->GetCutThroughBytes ();
+  if (received > 0 && received < size && m_ports[outPort]->GetDataRate () > in->GetDataRate ())
+    {
+      delay += in->GetDataRate ().CalculateBytesTxTime (size - received);
+    }
+
+  if (delay.IsZero ())
+    {
+      Forward (header, p, outPort);
+    }
+  else
+    {
+      Simulator::Schedule (delay, &FabricSwitchNetDevice::Forward, this, header, p, outPort);
+    }
+}
+
+void
+FabricSwitchNetDevice::Forward (Ipv4Header header, Ptr<Packet> packet, uint32_t port)
+{
+  NS_LOG_FUNCTION (this << packet << port);
+  Ptr<PointToPointNetDevice> device = m_ports[port];
+  m_tc->Send (device, Create<Ipv4QueueDiscItem> (packet, device->GetBroadcast (),
+                                                 Ipv4L3Protocol::PROT_NUMBER, header));
+}
+
+void
+FabricSwitchNetDevice::SetIfIndex (const uint32_t index)
+{
+  m_ifIndex = index;
+}
+
+uint32_t
+FabricSwitchNetDevice::GetIfIndex (void) const
+{
+  return m_ifIndex;
+}
+
+Ptr<Channel>
+FabricSwitchNetDevice::GetChannel (void) const
+{
+  return 0;
+}
+
+void
+FabricSwitchNetDevice::SetAddress (Address address)
+{
+  m_address = Mac48Address::ConvertFrom (address);
+}
+
+Address
+FabricSwitchNetDevice::GetAddress (void) const
+{
+  return m_address;
+}
+
+bool
+FabricSwitchNetDevice::SetMtu (const uint16_t mtu)
+{
+  m_mtu = mtu;
+  return true;
+}
+
+uint16_t
+FabricSwitchNetDevice::GetMtu (void) const
+{
+  return m_mtu;
+}
+
+bool
+FabricSwitchNetDevice::IsLinkUp (void) const
+{
+  return true;
+}
+
+void
+FabricSwitchNetDevice::AddLinkChangeCallback (Callback<void> callback)
+{
+}
+
+bool
+FabricSwitchNetDevice::IsBroadcast (void) const
+{
+  return false;
+}
+
+Address
+FabricSwitchNetDevice::GetBroadcast (void) const
+{
+  return Mac48Address ("ff:ff:ff:ff:ff:ff");
+}
+
+bool
+FabricSwitchNetDevice::IsMulticast (void) const
+{
+  return false;
+}
+
+Address
+FabricSwitchNetDevice::GetMulticast (Ipv4Address multicastGroup) const
+{
+  return Mac48Address::GetMulticast (multicastGroup);
+}
+
+Address
+FabricSwitchNetDevice::GetMulticast (Ipv6Address addr) const
+{
+  return Mac48Address::GetMulticast (addr);
+}
+
+bool
+FabricSwitchNetDevice::IsPointToPoint (void) const
+{
+  return false;
+}
+
+bool
+FabricSwitchNetDevice::IsBridge (void) const
+{
+  return false;
+}
+
+bool
+FabricSwitchNetDevice::Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << packet);
+  NS_LOG_WARN ("A FabricSwitchNetDevice does not originate packets");
+  return false;
+}
+
+bool
+FabricSwitchNetDevice::SendFrom (Ptr<Packet> packet, const Address& source,
+                                 const Address& dest, uint16_t protocolNumber)
+{
+  return Send (packet, dest, protocolNumber);
+}
+
+Ptr<Node>
+FabricSwitchNetDevice::GetNode (void) const
+{
+  return m_node;
+}
+
+void
+FabricSwitchNetDevice::SetNode (Ptr<Node> node)
+{
+  m_node = node;
+}
+
+bool
+FabricSwitchNetDevice::NeedsArp (void) const
+{
+  return false;
+}
+
+void
+FabricSwitchNetDevice::SetReceiveCallback (NetDevice::ReceiveCallback cb)
+{
+}
+
+void
+FabricSwitchNetDevice::SetPromiscReceiveCallback (NetDevice::PromiscReceiveCallback cb)
+{
+}
+
+bool
+FabricSwitchNetDevice::SupportsSendFrom () const
+{
+  return false;
+}
+
+} // namespace ns3
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Define a lightweight switch forwarding IPv4 packets between p2p devices.
+
+#ifndef FABRIC_SWITCH_NET_DEVICE_H
+#define FABRIC_SWITCH_NET_DEVICE_H
+
+#include "ns3/net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/point-to-point-net-device.h"
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+class TrafficControlLayer;
+
+/**
+ * \ingroup point-to-point-layout
+ *
+ * \brief A virtual net device that turns a node into a switch forwarding
+ * IPv4 packets between point-to-point devices
+ *
+ * Packets received by a port are forwarded to the port selected by a
+ * forwarding table, without traversing the Internet stack of the node (which
+ * does not need to be installed): the IPv4 header is parsed, the TTL is
+ * decremented and the packet is handed to the traffic control layer of the
+ * node (created if needed), so that the queue discs installed on the ports
+ * (e.g., RED with ECN marking) are used. The forwarding table maps IPv4
+ * prefixes to one or more ports; the longest matching prefix is selected and
+ * a hash of the five-tuple (see Ipv4GlobalRouting::GetFlowHash) selects one
+ * of its ports.
+ *
+ * If cut-through switching is enabled, the ports receive a packet as soon as
+ * its first CutThroughBytes bytes have been received (see the CutThroughBytes
+ * attribute of PointToPointNetDevice), so that the transmission on the
+ * output port can overlap with the reception on the input port. As real
+ * switches, the device falls back to store-and-forward when the output port
+ * is faster than the input port, by holding the packet until it has been
+ * entirely received. In both modes, the ForwardingDelay attribute models the
+ * latency of the switching pipeline.
+ *
+ * The ports must be added after the attributes have been set. The device
+ * does not originate packets and has no IPv4 address.
+ */
+class FabricSwitchNetDevice : public NetDevice
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  FabricSwitchNetDevice ();
+  virtual ~FabricSwitchNetDevice ();
+
+  /**
+   * \brief Add a port to the switch
+   *
+   * The node must have been set (i.e., the switch must have been added to
+   * the node) and the port must not be used by the Internet stack.
+   *
+   * \param port the device to add
+   * \returns the index of the port
+   */
+  uint32_t AddPort (Ptr<PointToPointNetDevice> port);
+
+  /**
+   * \returns the number of ports
+   */
+  uint32_t GetNPorts (void) const;
+
+  /**
+   * \param n the port index
+   * \returns the n-th port
+   */
+  Ptr<PointToPointNetDevice> GetPort (uint32_t n) const;
+
+  /**
+   * \brief Add a route to the forwarding table
+   *
+   * Adding several routes to the same prefix creates an equal cost group.
+   *
+   * \param network the destination network
+   * \param mask the network mask
+   * \param port the index of the output port
+   */
+  void AddRoute (Ipv4Address network, Ipv4Mask mask, uint32_t port);
+
+  /**
+   * \brief Remove all the routes of the forwarding table
+   */
+  void ClearRoutes (void);
+
+  /**
+   * \returns the number of prefixes in the forwarding table
+   */
+  uint32_t GetNRoutes (void) const;
+
+  /**
+   * \brief Look up the ports of the longest prefix matching an address
+   * \param destination the destination address
+   * \returns the ports of the route, or null if no route matches
+   */
+  const std::vector<uint32_t> * Lookup (Ipv4Address destination) const;
+
+  // inherited from NetDevice base class.
+  virtual void SetIfIndex (const uint32_t index);
+  virtual uint32_t GetIfIndex (void) const;
+  virtual Ptr<Channel> GetChannel (void) const;
+  virtual void SetAddress (Address address);
+  virtual Address GetAddress (void) const;
+  virtual bool SetMtu (const uint16_t mtu);
+  virtual uint16_t GetMtu (void) const;
+  virtual bool IsLinkUp (void) const;
+  virtual void AddLinkChangeCallback (Callback<void> callback);
+  virtual bool IsBroadcast (void) const;
+  virtual Address GetBroadcast (void) const;
+  virtual bool IsMulticast (void) const;
+  virtual Address GetMulticast (Ipv4Address multicastGroup) const;
+  virtual Address GetMulticast (Ipv6Address addr) const;
+  virtual bool IsPointToPoint (void) const;
+  virtual bool IsBridge (void) const;
+  virtual bool Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber);
+  virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  virtual Ptr<Node> GetNode (void) const;
+  virtual void SetNode (Ptr<Node> node);
+  virtual bool NeedsArp (void) const;
+  virtual void SetReceiveCallback (NetDevice::ReceiveCallback cb);
+  virtual void SetPromiscReceiveCallback (NetDevice::PromiscReceiveCallback cb);
+  virtual bool SupportsSendFrom () const;
+
+  /**
+   * TracedCallback signature for packets dropped by the switch
+   *
+   * \param [in] header the IPv4 header of the packet
+   * \param [in] packet the packet, without the IPv4 header
+   * \param [in] port the index of the input port
+   */
+  typedef void (* DropTracedCallback)(const Ipv4Header &header, Ptr<const Packet> packet,
+                                      uint32_t port);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Receive a packet from a port
+   * \param device the input port
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param source the source address
+   * \param destination the destination address
+   * \param packetType the packet type
+   */
+  void ReceiveFromPort (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                        const Address &source, const Address &destination, PacketType packetType);
+
+  /**
+   * \brief Send a packet to the traffic control layer of an output port
+   * \param header the IPv4 header
+   * \param packet the packet, without the IPv4 header
+   * \param port the index of the output port
+   */
+  void Forward (Ipv4Header header, Ptr<Packet> packet, uint32_t port);
+
+  /// Ports indexed by prefix, for a given prefix length
+  typedef std::unordered_map<uint32_t, std::vector<uint32_t> > PrefixMap;
+
+  Ptr<Node> m_node;                                   //!< Node owning this device
+  uint32_t m_ifIndex;                                 //!< Interface index
+  Mac48Address m_address;                             //!< MAC address
+  uint16_t m_mtu;                                     //!< MTU
+  Ptr<TrafficControlLayer> m_tc;                      //!< Traffic control layer of the node
+  std::vector<Ptr<PointToPointNetDevice> > m_ports;   //!< Ports
+  std::map<Ptr<NetDevice>, uint32_t> m_portIndex;     //!< Index of each port
+  std::map<uint8_t, PrefixMap, std::greater<uint8_t> > m_routes; //!< Routes by decreasing prefix length
+  bool m_cutThrough;                                  //!< Whether cut-through switching is enabled
+  uint32_t m_cutThroughBytes;                         //!< Bytes received before forwarding
+  Time m_forwardingDelay;                             //!< Latency of the switching pipeline
+  uint32_t m_hashSeed;                                //!< Seed of the five-tuple hash
+
+  /// Trace of the packets dropped because of the TTL or of a missing route
+  TracedCallback<const Ipv4Header &, Ptr<const Packet>, uint32_t> m_dropTrace;
+};
+
+} // namespace ns3
+
+#endif /* FABRIC_SWITCH_NET_DEVICE_H */
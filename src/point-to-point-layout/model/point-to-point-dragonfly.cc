@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Implement an object to create a dragonfly topology.
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/point-to-point-dragonfly.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointDragonflyHelper");
+
+PointToPointDragonflyHelper::PointToPointDragonflyHelper (uint32_t p,
+                                                          uint32_t a,
+                                                          uint32_t h,
+                                                          uint32_t g,
+                                                          PointToPointHelper hostHelper,
+                                                          PointToPointHelper localHelper,
+                                                          PointToPointHelper globalHelper)
+  : m_p (p),
+    m_a (a),
+    m_g (g == 0 ? a * h + 1 : g),
+    m_nGlobal (0)
+{
+  NS_LOG_FUNCTION (this << p << a << h << g);
+  NS_ABORT_MSG_IF (a == 0, "A dragonfly group needs at least one router");
+  NS_ABORT_MSG_IF (m_g > a * h + 1, "A dragonfly with " << a * h << " global ports per group "
+                   "cannot have more than " << a * h + 1 << " groups");
+
+  CreateNodes (m_g * a * p, m_g * a);
+
+  // Add the links of the hosts
+  for (uint32_t i = 0; i < m_g * a * p; ++i)
+    {
+      ConnectHost (i, i / p, hostHelper);
+    }
+  // Add the local links of each group
+  for (uint32_t group = 0; group < m_g; ++group)
+    {
+      for (uint32_t r1 = 0; r1 < a; ++r1)
+        {
+          for (uint32_t r2 = r1 + 1; r2 < a; ++r2)
+            {
+              ConnectSwitches (group * a + r1, group * a + r2, localHelper);
+            }
+        }
+    }
+  // Add the global links. The q'th global port of group i is connected to
+  // group t, whose i'th global port (i < t) is connected back to group i
+  for (uint32_t i = 0; i < m_g; ++i)
+    {
+      for (uint32_t q = i; q < a * h; ++q)
+        {
+          uint32_t t = q + 1;
+          if (t >= m_g)
+            {
+              break;
+            }
+          ConnectSwitches (i * a + q / h, t * a + i / h, globalHelper);
+          m_nGlobal++;
+        }
+    }
+}
+
+PointToPointDragonflyHelper::~PointToPointDragonflyHelper ()
+{
+}
+
+Ptr<Node>
+PointToPointDragonflyHelper::GetRouter (uint32_t group, uint32_t i) const
+{
+  NS_ASSERT (group < m_g && i < m_a);
+  return GetSwitch (group * m_a + i);
+}
+
+uint32_t
+PointToPointDragonflyHelper::GroupCount (void) const
+{
+  return m_g;
+}
+
+uint32_t
+PointToPointDragonflyHelper::GetHostGroup (uint32_t i) const
+{
+  return i / (m_a * m_p);
+}
+
+uint32_t
+PointToPointDragonflyHelper::GlobalLinkCount (void) const
+{
+  return m_nGlobal;
+}
+
+} // namespace ns3
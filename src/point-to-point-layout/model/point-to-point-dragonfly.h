@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Define an object to create a dragonfly topology.
+
+#ifndef POINT_TO_POINT_DRAGONFLY_HELPER_H
+#define POINT_TO_POINT_DRAGONFLY_HELPER_H
+
+#include "point-to-point-fabric.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point-layout
+ *
+ * \brief A helper to make it easier to create a dragonfly topology
+ * with p2p links
+ *
+ * The dragonfly has g groups of a routers (switches). Each router is
+ * connected to p hosts, to all the other routers of its group by local links
+ * and to routers of other groups by h global links. Global links use the
+ * absolute arrangement: the q'th global port of group i, i.e., the
+ * (q mod h)'th global port of the router q/h, is connected to the group q if
+ * q < i, and to the group q+1 otherwise. With the maximum number of groups,
+ * a*h+1, every pair of groups is connected by exactly one global link; with
+ * fewer groups, some global ports are left unconnected.
+ *
+ * Hosts are numbered by router, and routers are numbered by group. Fabric
+ * links are numbered starting from the local links of each group, followed
+ * by the global links.
+ */
+class PointToPointDragonflyHelper : public PointToPointFabricHelper
+{
+public:
+  /**
+   * Create a PointToPointDragonflyHelper in order to easily create
+   * dragonfly topologies using p2p links
+   *
+   * \param p number of hosts connected to each router
+   *
+   * \param a number of routers in each group
+   *
+   * \param h number of global links of each router
+   *
+   * \param g number of groups, at most a*h+1 (the default, if zero)
+   *
+   * \param hostHelper PointToPointHelper used to install the links
+   *                   between the hosts and the routers
+   *
+   * \param localHelper PointToPointHelper used to install the links
+   *                    between the routers of a group
+   *
+   * \param globalHelper PointToPointHelper used to install the links
+   *                     between the groups
+   */
+  PointToPointDragonflyHelper (uint32_t p,
+                               uint32_t a,
+                               uint32_t h,
+                               uint32_t g,
+                               PointToPointHelper hostHelper,
+                               PointToPointHelper localHelper,
+                               PointToPointHelper globalHelper);
+
+  virtual ~PointToPointDragonflyHelper ();
+
+  /**
+   * \returns pointer to the i'th router of a group
+   * \param group group number
+   * \param i router number in the group
+   */
+  Ptr<Node> GetRouter (uint32_t group, uint32_t i) const;
+
+  /**
+   * \returns the number of groups
+   */
+  uint32_t GroupCount (void) const;
+
+  /**
+   * \returns the number of the group a host belongs to
+   * \param i host number
+   */
+  uint32_t GetHostGroup (uint32_t i) const;
+
+  /**
+   * \returns the number of global links
+   */
+  uint32_t GlobalLinkCount (void) const;
+
+private:
+  uint32_t m_p;        //!< Number of hosts per router
+  uint32_t m_a;        //!< Number of routers per group
+  uint32_t m_g;        //!< Number of groups
+  uint32_t m_nGlobal;  //!< Number of global links
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_DRAGONFLY_HELPER_H */
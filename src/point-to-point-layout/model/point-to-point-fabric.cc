@@ -0,0 +1,314 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Implement the base class of the datacenter topology helpers.
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/channel.h"
+#include "ns3/point-to-point-fabric.h"
+#include <deque>
+#include <unordered_map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointFabricHelper");
+
+PointToPointFabricHelper::PointToPointFabricHelper ()
+{
+  m_switchFactory.SetTypeId ("ns3::FabricSwitchNetDevice");
+}
+
+PointToPointFabricHelper::~PointToPointFabricHelper ()
+{
+}
+
+uint32_t
+PointToPointFabricHelper::HostCount (void) const
+{
+  return m_hosts.GetN ();
+}
+
+uint32_t
+PointToPointFabricHelper::SwitchCount (void) const
+{
+  return m_switches.GetN ();
+}
+
+Ptr<Node>
+PointToPointFabricHelper::GetHost (uint32_t i) const
+{
+  return m_hosts.Get (i);
+}
+
+Ptr<Node>
+PointToPointFabricHelper::GetSwitch (uint32_t i) const
+{
+  return m_switches.Get (i);
+}
+
+NodeContainer
+PointToPointFabricHelper::GetHosts (void) const
+{
+  return m_hosts;
+}
+
+NodeContainer
+PointToPointFabricHelper::GetSwitches (void) const
+{
+  return m_switches;
+}
+
+uint32_t
+PointToPointFabricHelper::FabricLinkCount (void) const
+{
+  return m_fabricDevices.GetN () / 2;
+}
+
+NetDeviceContainer
+PointToPointFabricHelper::GetHostLink (uint32_t i) const
+{
+  return NetDeviceContainer (m_hostDevices.Get (i), m_hostSwitchDevices.Get (i));
+}
+
+NetDeviceContainer
+PointToPointFabricHelper::GetFabricLink (uint32_t i) const
+{
+  return NetDeviceContainer (m_fabricDevices.Get (2 * i), m_fabricDevices.Get (2 * i + 1));
+}
+
+Ipv4Address
+PointToPointFabricHelper::GetHostIpv4Address (uint32_t i) const
+{
+  return m_hostInterfaces.GetAddress (i);
+}
+
+Ptr<FabricSwitchNetDevice>
+PointToPointFabricHelper::GetSwitchDevice (uint32_t i) const
+{
+  NS_ASSERT_MSG (i < m_switchDevices.size (), "The switch devices have not been installed");
+  return m_switchDevices[i];
+}
+
+void
+PointToPointFabricHelper::InstallStack (InternetStackHelper stack)
+{
+  InstallStack (stack, stack);
+}
+
+void
+PointToPointFabricHelper::InstallStack (InternetStackHelper hostStack,
+                                        InternetStackHelper switchStack)
+{
+  hostStack.Install (m_hosts);
+  if (m_switchDevices.empty ())
+    {
+      switchStack.Install (m_switches);
+    }
+}
+
+void
+PointToPointFabricHelper::InstallTrafficControl (TrafficControlHelper hostTch,
+                                                 TrafficControlHelper switchTch)
+{
+  hostTch.Install (m_hostDevices);
+  switchTch.Install (m_hostSwitchDevices);
+  switchTch.Install (m_fabricDevices);
+}
+
+void
+PointToPointFabricHelper::AssignIpv4Addresses (Ipv4AddressHelper hostIp,
+                                               Ipv4AddressHelper fabricIp)
+{
+  // Assign to the host links
+  NetDeviceContainer hostLinks;
+  for (uint32_t i = 0; i < m_hostDevices.GetN (); ++i)
+    {
+      hostLinks.Add (GetHostLink (i));
+    }
+  Ipv4InterfaceContainer ifc = hostIp.AssignLinks (hostLinks, 2);
+  for (uint32_t i = 0; i < ifc.GetN (); i += 2)
+    {
+      m_hostInterfaces.Add (ifc.Get (i));
+      m_hostSwitchInterfaces.Add (ifc.Get (i + 1));
+    }
+  // Assign to the fabric links
+  m_fabricInterfaces.Add (fabricIp.AssignLinks (m_fabricDevices, 2));
+}
+
+void
+PointToPointFabricHelper::SetSwitchDeviceAttribute (std::string name, const AttributeValue &value)
+{
+  m_switchFactory.Set (name, value);
+}
+
+void
+PointToPointFabricHelper::InstallSwitchDevices (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (!m_switchDevices.empty (), "The switch devices are already installed");
+  for (uint32_t i = 0; i < m_switches.GetN (); ++i)
+    {
+      Ptr<Node> node = m_switches.Get (i);
+      Ptr<FabricSwitchNetDevice> sw = m_switchFactory.Create<FabricSwitchNetDevice> ();
+      uint32_t nDevices = node->GetNDevices ();
+      node->AddDevice (sw);
+      for (uint32_t j = 0; j < nDevices; ++j)
+        {
+          Ptr<PointToPointNetDevice> port = DynamicCast<PointToPointNetDevice> (node->GetDevice (j));
+          if (port != 0)
+            {
+              sw->AddPort (port);
+            }
+        }
+      m_switchDevices.push_back (sw);
+    }
+}
+
+void
+PointToPointFabricHelper::AssignHostIpv4Addresses (Ipv4AddressHelper hostIp)
+{
+  m_hostInterfaces.Add (hostIp.Assign (m_hostDevices));
+}
+
+void
+PointToPointFabricHelper::PopulateSwitchTables (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_switchDevices.empty (), "The switch devices have not been installed");
+  NS_ABORT_MSG_IF (m_hostInterfaces.GetN () != m_hosts.GetN (), "The hosts have no address");
+
+  std::unordered_map<uint32_t, uint32_t> switchIndex;
+  for (uint32_t i = 0; i < m_switches.GetN (); ++i)
+    {
+      switchIndex[m_switches.Get (i)->GetId ()] = i;
+    }
+
+  // The neighbor switches of each switch and the hosts connected to each
+  // switch, with the index of the port to reach them
+  uint32_t nSwitches = m_switches.GetN ();
+  std::vector<std::vector<std::pair<uint32_t, uint32_t> > > neighbors (nSwitches);
+  std::vector<std::vector<std::pair<uint32_t, uint32_t> > > hosts (nSwitches);
+  for (uint32_t i = 0; i < m_hostDevices.GetN (); ++i)
+    {
+      Ptr<NetDevice> port = m_hostSwitchDevices.Get (i);
+      uint32_t sw = switchIndex[port->GetNode ()->GetId ()];
+      for (uint32_t p = 0; p < m_switchDevices[sw]->GetNPorts (); ++p)
+        {
+          if (m_switchDevices[sw]->GetPort (p) == port)
+            {
+              hosts[sw].push_back ({i, p});
+              break;
+            }
+        }
+    }
+  for (uint32_t sw = 0; sw < nSwitches; ++sw)
+    {
+      Ptr<FabricSwitchNetDevice> dev = m_switchDevices[sw];
+      for (uint32_t p = 0; p < dev->GetNPorts (); ++p)
+        {
+          Ptr<Channel> channel = dev->GetPort (p)->GetChannel ();
+          for (std::size_t d = 0; d < channel->GetNDevices (); ++d)
+            {
+              auto peer = switchIndex.find (channel->GetDevice (d)->GetNode ()->GetId ());
+              if (peer != switchIndex.end () && peer->second != sw)
+                {
+                  neighbors[sw].push_back ({peer->second, p});
+                }
+            }
+        }
+    }
+
+  Ipv4Mask hostMask ("255.255.255.255");
+  std::vector<uint32_t> distance (nSwitches);
+  for (uint32_t dst = 0; dst < nSwitches; ++dst)
+    {
+      if (hosts[dst].empty ())
+        {
+          continue;
+        }
+      for (auto& host : hosts[dst])
+        {
+          m_switchDevices[dst]->AddRoute (m_hostInterfaces.GetAddress (host.first), hostMask,
+                                          host.second);
+        }
+
+      // Breadth-first search of the distance of every switch from dst
+      std::fill (distance.begin (), distance.end (), UINT32_MAX);
+      distance[dst] = 0;
+      std::deque<uint32_t> queue (1, dst);
+      while (!queue.empty ())
+        {
+          uint32_t sw = queue.front ();
+          queue.pop_front ();
+          for (auto& neighbor : neighbors[sw])
+            {
+              if (distance[neighbor.first] == UINT32_MAX)
+                {
+                  distance[neighbor.first] = distance[sw] + 1;
+                  queue.push_back (neighbor.first);
+                }
+            }
+        }
+
+      // Every switch reaches the hosts of dst through the neighbors closer to dst
+      for (uint32_t sw = 0; sw < nSwitches; ++sw)
+        {
+          if (sw == dst || distance[sw] == UINT32_MAX)
+            {
+              continue;
+            }
+          for (auto& neighbor : neighbors[sw])
+            {
+              if (distance[neighbor.first] + 1 != distance[sw])
+                {
+                  continue;
+                }
+              for (auto& host : hosts[dst])
+                {
+                  m_switchDevices[sw]->AddRoute (m_hostInterfaces.GetAddress (host.first),
+                                                 hostMask, neighbor.second);
+                }
+            }
+        }
+    }
+}
+
+void
+PointToPointFabricHelper::CreateNodes (uint32_t nHosts, uint32_t nSwitches)
+{
+  NS_LOG_FUNCTION (this << nHosts << nSwitches);
+  m_hosts.Create (nHosts);
+  m_switches.Create (nSwitches);
+}
+
+void
+PointToPointFabricHelper::ConnectHost (uint32_t host, uint32_t sw, PointToPointHelper &helper)
+{
+  NS_ASSERT_MSG (host == m_hostDevices.GetN (), "Hosts must be connected in order");
+  NetDeviceContainer c = helper.Install (m_hosts.Get (host), m_switches.Get (sw));
+  m_hostDevices.Add (c.Get (0));
+  m_hostSwitchDevices.Add (c.Get (1));
+}
+
+void
+PointToPointFabricHelper::ConnectSwitches (uint32_t a, uint32_t b, PointToPointHelper &helper)
+{
+  m_fabricDevices.Add (helper.Install (m_switches.Get (a), m_switches.Get (b)));
+}
+
+} // namespace ns3
@@ -0,0 +1,234 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Define the base class of the datacenter topology helpers.
+
+#ifndef POINT_TO_POINT_FABRIC_HELPER_H
+#define POINT_TO_POINT_FABRIC_HELPER_H
+
+#include "point-to-point-helper.h"
+#include "ipv4-address-helper.h"
+#include "internet-stack-helper.h"
+#include "ipv4-interface-container.h"
+#include "traffic-control-helper.h"
+#include "object-factory.h"
+#include "fabric-switch-net-device.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point-layout
+ *
+ * \brief Base class of the helpers that create datacenter topologies
+ * (switch fabrics) with p2p links
+ *
+ * A fabric is made of hosts, each connected to a single switch by a host
+ * link, and of switches interconnected by fabric links. Subclasses create
+ * the nodes and the links in their constructor, while this class provides
+ * the methods to install the Internet stack and the traffic control layer and
+ * to assign IPv4 addresses to all the nodes at once, and to access the
+ * nodes and the links.
+ *
+ * The methods must be called in this order: InstallStack,
+ * InstallTrafficControl (if needed) and AssignIpv4Addresses, because
+ * assigning addresses installs the default root queue disc on the devices
+ * that do not have one yet.
+ *
+ * Alternatively, the switches can be modeled by FabricSwitchNetDevice
+ * objects, which forward packets without the Internet stack, by calling
+ * InstallSwitchDevices, InstallStack (which then installs the stack on the
+ * hosts only), InstallTrafficControl (if needed), AssignHostIpv4Addresses and
+ * PopulateSwitchTables.
+ */
+class PointToPointFabricHelper
+{
+public:
+  PointToPointFabricHelper ();
+  virtual ~PointToPointFabricHelper ();
+
+  /**
+   * \returns the total number of hosts
+   */
+  uint32_t HostCount (void) const;
+
+  /**
+   * \returns the total number of switches
+   */
+  uint32_t SwitchCount (void) const;
+
+  /**
+   * \returns pointer to the i'th host
+   * \param i host number
+   */
+  Ptr<Node> GetHost (uint32_t i) const;
+
+  /**
+   * \returns pointer to the i'th switch
+   * \param i switch number
+   */
+  Ptr<Node> GetSwitch (uint32_t i) const;
+
+  /**
+   * \returns all the hosts
+   */
+  NodeContainer GetHosts (void) const;
+
+  /**
+   * \returns all the switches
+   */
+  NodeContainer GetSwitches (void) const;
+
+  /**
+   * \returns the number of fabric (switch to switch) links
+   */
+  uint32_t FabricLinkCount (void) const;
+
+  /**
+   * \returns the devices of the link of the i'th host, the device of the
+   *          host first
+   * \param i host number
+   */
+  NetDeviceContainer GetHostLink (uint32_t i) const;
+
+  /**
+   * \returns the devices of the i'th fabric link
+   * \param i fabric link number
+   */
+  NetDeviceContainer GetFabricLink (uint32_t i) const;
+
+  /**
+   * \returns the Ipv4Address of the i'th host
+   * \param i host number
+   */
+  Ipv4Address GetHostIpv4Address (uint32_t i) const;
+
+  /**
+   * \returns the FabricSwitchNetDevice of the i'th switch, if the switch
+   *          devices have been installed
+   * \param i switch number
+   */
+  Ptr<FabricSwitchNetDevice> GetSwitchDevice (uint32_t i) const;
+
+  /**
+   * \param stack an InternetStackHelper which is used to install
+   *              on every node in the fabric (on the hosts only if the
+   *              switch devices have been installed)
+   */
+  void InstallStack (InternetStackHelper stack);
+
+  /**
+   * \param hostStack an InternetStackHelper which is used to install
+   *                  on the hosts
+   * \param switchStack an InternetStackHelper which is used to install
+   *                    on the switches (e.g., in forwarding-only mode, see
+   *                    InternetStackHelper::SetForwardingOnly), unless the
+   *                    switch devices have been installed
+   */
+  void InstallStack (InternetStackHelper hostStack, InternetStackHelper switchStack);
+
+  /**
+   * \param hostTch TrafficControlHelper used to install the queue discs
+   *                on the devices of the hosts
+   * \param switchTch TrafficControlHelper used to install the queue discs
+   *                  on all the devices of the switches
+   */
+  void InstallTrafficControl (TrafficControlHelper hostTch, TrafficControlHelper switchTch);
+
+  /**
+   * Assign a distinct network to every link
+   *
+   * \param hostIp Ipv4AddressHelper to assign Ipv4 addresses to the
+   *               interfaces of the host links
+   * \param fabricIp Ipv4AddressHelper to assign Ipv4 addresses to the
+   *                 interfaces of the fabric links
+   */
+  void AssignIpv4Addresses (Ipv4AddressHelper hostIp, Ipv4AddressHelper fabricIp);
+
+  /**
+   * Set an attribute of the FabricSwitchNetDevice objects created by
+   * InstallSwitchDevices
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetSwitchDeviceAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Add a FabricSwitchNetDevice to every switch, with all the devices of the
+   * switch as ports
+   */
+  void InstallSwitchDevices (void);
+
+  /**
+   * Assign the addresses of the hosts from a single network, so that every
+   * host can reach the others through its only interface. The switches have
+   * no address.
+   *
+   * \param hostIp Ipv4AddressHelper to assign Ipv4 addresses to the hosts
+   */
+  void AssignHostIpv4Addresses (Ipv4AddressHelper hostIp);
+
+  /**
+   * Fill the forwarding tables of the switch devices with a route to every
+   * host through all the shortest paths (in number of hops)
+   */
+  void PopulateSwitchTables (void);
+
+protected:
+  /**
+   * Create the nodes of the fabric
+   *
+   * \param nHosts the number of hosts
+   * \param nSwitches the number of switches
+   */
+  void CreateNodes (uint32_t nHosts, uint32_t nSwitches);
+
+  /**
+   * Connect a host to a switch. Hosts must be connected in order.
+   *
+   * \param host the host number
+   * \param sw the switch number
+   * \param helper the helper used to install the link
+   */
+  void ConnectHost (uint32_t host, uint32_t sw, PointToPointHelper &helper);
+
+  /**
+   * Connect two switches
+   *
+   * \param a the number of the first switch
+   * \param b the number of the second switch
+   * \param helper the helper used to install the link
+   */
+  void ConnectSwitches (uint32_t a, uint32_t b, PointToPointHelper &helper);
+
+private:
+  NodeContainer          m_hosts;               //!< Hosts
+  NodeContainer          m_switches;            //!< Switches
+  NetDeviceContainer     m_hostDevices;         //!< Devices of the hosts
+  NetDeviceContainer     m_hostSwitchDevices;   //!< Devices of the switches on the host links
+  NetDeviceContainer     m_fabricDevices;       //!< Devices of the fabric links, in pairs
+  Ipv4InterfaceContainer m_hostInterfaces;      //!< Interfaces of the hosts
+  Ipv4InterfaceContainer m_hostSwitchInterfaces; //!< Interfaces of the switches on the host links
+  Ipv4InterfaceContainer m_fabricInterfaces;    //!< Interfaces of the fabric links, in pairs
+  ObjectFactory          m_switchFactory;       //!< Factory of the switch devices
+  std::vector<Ptr<FabricSwitchNetDevice> > m_switchDevices; //!< Switch devices
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_FABRIC_HELPER_H */
@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Implement an object to create a k-ary fat-tree topology.
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/point-to-point-fat-tree.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointFatTreeHelper");
+
+PointToPointFatTreeHelper::PointToPointFatTreeHelper (uint32_t k,
+                                                      PointToPointHelper hostHelper,
+                                                      PointToPointHelper fabricHelper)
+  : m_k (k)
+{
+  NS_LOG_FUNCTION (this << k);
+  NS_ABORT_MSG_IF (k < 2 || k % 2, "The number of ports of a fat-tree must be even");
+
+  uint32_t half = k / 2;
+  CreateNodes (k * k * k / 4, half * half + k * k);
+
+  uint32_t host = 0;
+  for (uint32_t pod = 0; pod < k; ++pod)
+    {
+      for (uint32_t e = 0; e < half; ++e)
+        {
+          // Add the links of the hosts of the edge switch
+          uint32_t edge = half * half + pod * k + half + e;
+          for (uint32_t h = 0; h < half; ++h)
+            {
+              ConnectHost (host++, edge, hostHelper);
+            }
+          // Add the links to the aggregation switches of the pod
+          for (uint32_t a = 0; a < half; ++a)
+            {
+              ConnectSwitches (edge, half * half + pod * k + a, fabricHelper);
+            }
+        }
+    }
+  // Add the links between the aggregation and the core switches
+  for (uint32_t pod = 0; pod < k; ++pod)
+    {
+      for (uint32_t a = 0; a < half; ++a)
+        {
+          for (uint32_t c = 0; c < half; ++c)
+            {
+              ConnectSwitches (half * half + pod * k + a, a * half + c, fabricHelper);
+            }
+        }
+    }
+}
+
+PointToPointFatTreeHelper::~PointToPointFatTreeHelper ()
+{
+}
+
+uint32_t
+PointToPointFatTreeHelper::GetK (void) const
+{
+  return m_k;
+}
+
+Ptr<Node>
+PointToPointFatTreeHelper::GetCoreSwitch (uint32_t i) const
+{
+  NS_ASSERT (i < m_k * m_k / 4);
+  return GetSwitch (i);
+}
+
+Ptr<Node>
+PointToPointFatTreeHelper::GetAggregationSwitch (uint32_t pod, uint32_t i) const
+{
+  NS_ASSERT (pod < m_k && i < m_k / 2);
+  return GetSwitch (m_k * m_k / 4 + pod * m_k + i);
+}
+
+Ptr<Node>
+PointToPointFatTreeHelper::GetEdgeSwitch (uint32_t pod, uint32_t i) const
+{
+  NS_ASSERT (pod < m_k && i < m_k / 2);
+  return GetSwitch (m_k * m_k / 4 + pod * m_k + m_k / 2 + i);
+}
+
+uint32_t
+PointToPointFatTreeHelper::GetHostPod (uint32_t i) const
+{
+  return i / (m_k * m_k / 4);
+}
+
+} // namespace ns3
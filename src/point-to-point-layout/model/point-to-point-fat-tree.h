@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Define an object to create a k-ary fat-tree topology.
+
+#ifndef POINT_TO_POINT_FAT_TREE_HELPER_H
+#define POINT_TO_POINT_FAT_TREE_HELPER_H
+
+#include "point-to-point-fabric.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point-layout
+ *
+ * \brief A helper to make it easier to create a k-ary fat-tree topology
+ * with p2p links
+ *
+ * The fat-tree has k pods, each made of k/2 edge switches and k/2
+ * aggregation switches, and (k/2)^2 core switches. Each edge switch is
+ * connected to k/2 hosts and to all the aggregation switches of its pod. The
+ * i'th aggregation switch of each pod is connected to the core switches
+ * i*k/2 to (i+1)*k/2-1. The topology has k^3/4 hosts, hence k=34 gives
+ * 9826 hosts.
+ *
+ * Hosts are numbered by pod, then by edge switch. Switches are numbered
+ * starting from the core switches, followed by the aggregation and the edge
+ * switches of each pod. Fabric links are numbered starting from the edge to
+ * aggregation links of each pod, followed by the aggregation to core links.
+ */
+class PointToPointFatTreeHelper : public PointToPointFabricHelper
+{
+public:
+  /**
+   * Create a PointToPointFatTreeHelper in order to easily create
+   * fat-tree topologies using p2p links
+   *
+   * \param k the number of ports of the switches, must be even
+   *
+   * \param hostHelper PointToPointHelper used to install the links
+   *                   between the hosts and the edge switches
+   *
+   * \param fabricHelper PointToPointHelper used to install the links
+   *                     between the switches
+   */
+  PointToPointFatTreeHelper (uint32_t k,
+                             PointToPointHelper hostHelper,
+                             PointToPointHelper fabricHelper);
+
+  virtual ~PointToPointFatTreeHelper ();
+
+  /**
+   * \returns the number of ports of the switches
+   */
+  uint32_t GetK (void) const;
+
+  /**
+   * \returns pointer to the i'th core switch
+   * \param i core switch number
+   */
+  Ptr<Node> GetCoreSwitch (uint32_t i) const;
+
+  /**
+   * \returns pointer to the i'th aggregation switch of a pod
+   * \param pod pod number
+   * \param i aggregation switch number in the pod
+   */
+  Ptr<Node> GetAggregationSwitch (uint32_t pod, uint32_t i) const;
+
+  /**
+   * \returns pointer to the i'th edge switch of a pod
+   * \param pod pod number
+   * \param i edge switch number in the pod
+   */
+  Ptr<Node> GetEdgeSwitch (uint32_t pod, uint32_t i) const;
+
+  /**
+   * \returns the number of the pod a host belongs to
+   * \param i host number
+   */
+  uint32_t GetHostPod (uint32_t i) const;
+
+private:
+  uint32_t m_k;    //!< Number of ports of the switches
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_FAT_TREE_HELPER_H */
@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Implement an object to create a leaf-spine topology.
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/data-rate.h"
+#include "ns3/point-to-point-leaf-spine.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointLeafSpineHelper");
+
+/**
+ * \param dev a point-to-point device
+ * \returns the data rate of the device
+ */
+static DataRate
+GetDeviceDataRate (Ptr<NetDevice> dev)
+{
+  DataRateValue rate;
+  dev->GetAttribute ("DataRate", rate);
+  return rate.Get ();
+}
+
+PointToPointLeafSpineHelper::PointToPointLeafSpineHelper (uint32_t nLeaf,
+                                                          uint32_t nSpine,
+                                                          uint32_t hostsPerLeaf,
+                                                          PointToPointHelper hostHelper,
+                                                          PointToPointHelper fabricHelper,
+                                                          double oversubscription)
+  : m_nLeaf (nLeaf),
+    m_nSpine (nSpine),
+    m_hostsPerLeaf (hostsPerLeaf)
+{
+  NS_LOG_FUNCTION (this << nLeaf << nSpine << hostsPerLeaf << oversubscription);
+  NS_ABORT_MSG_IF (nLeaf == 0 || nSpine == 0, "A leaf-spine needs leaf and spine switches");
+
+  CreateNodes (nLeaf * hostsPerLeaf, nSpine + nLeaf);
+
+  // Add the links of the hosts
+  for (uint32_t i = 0; i < nLeaf * hostsPerLeaf; ++i)
+    {
+      ConnectHost (i, nSpine + i / hostsPerLeaf, hostHelper);
+    }
+
+  if (oversubscription > 0 && hostsPerLeaf > 0)
+    {
+      uint64_t hostRate = GetDeviceDataRate (GetHostLink (0).Get (0)).GetBitRate ();
+      double uplinkRate = hostRate * hostsPerLeaf / (nSpine * oversubscription);
+      NS_LOG_LOGIC ("Data rate of the uplinks: " << uplinkRate << "bps");
+      fabricHelper.SetDeviceAttribute ("DataRate",
+                                       DataRateValue (DataRate (static_cast<uint64_t> (uplinkRate))));
+    }
+
+  // Add the links between the leaf and the spine switches
+  for (uint32_t l = 0; l < nLeaf; ++l)
+    {
+      for (uint32_t s = 0; s < nSpine; ++s)
+        {
+          ConnectSwitches (nSpine + l, s, fabricHelper);
+        }
+    }
+}
+
+PointToPointLeafSpineHelper::~PointToPointLeafSpineHelper ()
+{
+}
+
+Ptr<Node>
+PointToPointLeafSpineHelper::GetLeaf (uint32_t i) const
+{
+  NS_ASSERT (i < m_nLeaf);
+  return GetSwitch (m_nSpine + i);
+}
+
+Ptr<Node>
+PointToPointLeafSpineHelper::GetSpine (uint32_t i) const
+{
+  NS_ASSERT (i < m_nSpine);
+  return GetSwitch (i);
+}
+
+uint32_t
+PointToPointLeafSpineHelper::LeafCount (void) const
+{
+  return m_nLeaf;
+}
+
+uint32_t
+PointToPointLeafSpineHelper::SpineCount (void) const
+{
+  return m_nSpine;
+}
+
+double
+PointToPointLeafSpineHelper::GetOversubscription (void) const
+{
+  double down = 0;
+  for (uint32_t i = 0; i < m_hostsPerLeaf; ++i)
+    {
+      down += GetDeviceDataRate (GetHostLink (i).Get (1)).GetBitRate ();
+    }
+  double up = 0;
+  for (uint32_t s = 0; s < m_nSpine; ++s)
+    {
+      up += GetDeviceDataRate (GetFabricLink (s).Get (0)).GetBitRate ();
+    }
+  return down / up;
+}
+
+} // namespace ns3
@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Define an object to create a leaf-spine topology.
+
+#ifndef POINT_TO_POINT_LEAF_SPINE_HELPER_H
+#define POINT_TO_POINT_LEAF_SPINE_HELPER_H
+
+#include "point-to-point-fabric.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point-layout
+ *
+ * \brief A helper to make it easier to create a leaf-spine topology
+ * with p2p links
+ *
+ * Each leaf switch is connected to its hosts and to every spine switch.
+ * The oversubscription of the leaf switches is the ratio between the
+ * capacity of the host links and the capacity of the uplinks of a leaf
+ * switch. It is either determined by the data rates set on the
+ * PointToPointHelper objects or, if a positive oversubscription is passed
+ * to the constructor, enforced by setting the data rate of the uplinks.
+ *
+ * Hosts are numbered by leaf switch. Switches are numbered starting from the
+ * spine switches, followed by the leaf switches. Fabric links are numbered by
+ * leaf switch, then by spine switch.
+ */
+class PointToPointLeafSpineHelper : public PointToPointFabricHelper
+{
+public:
+  /**
+   * Create a PointToPointLeafSpineHelper in order to easily create
+   * leaf-spine topologies using p2p links
+   *
+   * \param nLeaf number of leaf switches
+   *
+   * \param nSpine number of spine switches
+   *
+   * \param hostsPerLeaf number of hosts connected to each leaf switch
+   *
+   * \param hostHelper PointToPointHelper used to install the links
+   *                   between the hosts and the leaf switches
+   *
+   * \param fabricHelper PointToPointHelper used to install the links
+   *                     between the leaf and the spine switches
+   *
+   * \param oversubscription if positive, the data rate of the links between
+   *                         the leaf and the spine switches is set to
+   *                         achieve this oversubscription
+   */
+  PointToPointLeafSpineHelper (uint32_t nLeaf,
+                               uint32_t nSpine,
+                               uint32_t hostsPerLeaf,
+                               PointToPointHelper hostHelper,
+                               PointToPointHelper fabricHelper,
+                               double oversubscription = 0);
+
+  virtual ~PointToPointLeafSpineHelper ();
+
+  /**
+   * \returns pointer to the i'th leaf switch
+   * \param i leaf switch number
+   */
+  Ptr<Node> GetLeaf (uint32_t i) const;
+
+  /**
+   * \returns pointer to the i'th spine switch
+   * \param i spine switch number
+   */
+  Ptr<Node> GetSpine (uint32_t i) const;
+
+  /**
+   * \returns the number of leaf switches
+   */
+  uint32_t LeafCount (void) const;
+
+  /**
+   * \returns the number of spine switches
+   */
+  uint32_t SpineCount (void) const;
+
+  /**
+   * \returns the oversubscription of the leaf switches, computed from the
+   *          data rates of the devices of the first leaf switch
+   */
+  double GetOversubscription (void) const;
+
+private:
+  uint32_t m_nLeaf;         //!< Number of leaf switches
+  uint32_t m_nSpine;        //!< Number of spine switches
+  uint32_t m_hostsPerLeaf;  //!< Number of hosts per leaf switch
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_LEAF_SPINE_HELPER_H */
@@ -0,0 +1,24 @@
+#! /usr/bin/env python3
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+
+# A list of C++ examples to run in order to ensure that they remain
+# buildable and runnable over time.  Each tuple in the list contains
+#
+#     (example_name, do_run, do_valgrind_run).
+#
+# See test.py for more information.
+cpp_examples = [
+    ("datacenter-topologies --topology=fat-tree --k=4", "True", "True"),
+    ("datacenter-topologies --topology=leaf-spine --nLeaf=4 --nSpine=2 --hostsPerLeaf=4 --oversubscription=2", "True", "True"),
+    ("datacenter-topologies --topology=dragonfly --p=2 --a=4 --h=2", "True", "True"),
+    ("datacenter-topologies --topology=fat-tree --k=4 --switchDevices=true --cutThrough=true", "True", "True"),
+    ("datacenter-topologies --topology=fat-tree --k=4 --forwardingOnly=true", "True", "True"),
+]
+
+# A list of Python examples to run in order to ensure that they remain
+# runnable over time.  Each tuple in the list contains
+#
+#     (example_name, do_run).
+#
+# See test.py for more information.
+python_examples = []
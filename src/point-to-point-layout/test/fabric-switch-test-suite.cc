@@ -0,0 +1,312 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/queue-disc.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/point-to-point-leaf-spine.h"
+#include "ns3/fabric-switch-net-device.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup point-to-point-layout
+ * \defgroup point-to-point-layout-test point-to-point-layout module tests
+ */
+
+/**
+ * \ingroup point-to-point-layout-test
+ * \ingroup tests
+ *
+ * \brief Base class of the tests of the FabricSwitchNetDevice, which build
+ * a leaf-spine fabric of switch devices
+ */
+class FabricSwitchTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param name the name of the test
+   */
+  FabricSwitchTestCase (std::string name);
+
+protected:
+  /**
+   * Build the fabric.
+   * \param nLeaf the number of leaf switches
+   * \param nSpine the number of spine switches
+   * \param hostsPerLeaf the number of hosts per leaf switch
+   * \param hostRate the data rate of the host links
+   * \param fabricRate the data rate of the fabric links
+   * \param cutThrough whether cut-through switching is enabled
+   * \param switchTch the traffic control helper of the switches
+   * \returns the fabric
+   */
+  PointToPointLeafSpineHelper * Build (uint32_t nLeaf, uint32_t nSpine, uint32_t hostsPerLeaf,
+                                       std::string hostRate, std::string fabricRate,
+                                       bool cutThrough, TrafficControlHelper switchTch);
+  /**
+   * Send a UDP packet.
+   * \param socket the sending socket
+   * \param size the payload size
+   */
+  void SendPacket (Ptr<Socket> socket, uint32_t size);
+  /**
+   * Receive the UDP packets and record the time of the last reception.
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  uint32_t m_received; //!< Number of packets received
+  Time m_lastRx;       //!< Time of the last reception
+};
+
+FabricSwitchTestCase::FabricSwitchTestCase (std::string name)
+  : TestCase (name),
+    m_received (0)
+{
+}
+
+PointToPointLeafSpineHelper *
+FabricSwitchTestCase::Build (uint32_t nLeaf, uint32_t nSpine, uint32_t hostsPerLeaf,
+                             std::string hostRate, std::string fabricRate,
+                             bool cutThrough, TrafficControlHelper switchTch)
+{
+  // Packets wait in the queue discs rather than in the device queues
+  PointToPointHelper hostLinks;
+  hostLinks.SetDeviceAttribute ("DataRate", StringValue (hostRate));
+  hostLinks.SetChannelAttribute ("Delay", StringValue ("1us"));
+  hostLinks.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("1p"));
+  PointToPointHelper fabricLinks;
+  fabricLinks.SetDeviceAttribute ("DataRate", StringValue (fabricRate));
+  fabricLinks.SetChannelAttribute ("Delay", StringValue ("1us"));
+  fabricLinks.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("1p"));
+
+  PointToPointLeafSpineHelper *fabric = new PointToPointLeafSpineHelper (nLeaf, nSpine, hostsPerLeaf,
+                                                                         hostLinks, fabricLinks);
+  fabric->SetSwitchDeviceAttribute ("CutThrough", BooleanValue (cutThrough));
+  fabric->InstallSwitchDevices ();
+  fabric->InstallStack (InternetStackHelper ());
+  TrafficControlHelper hostTch;
+  hostTch.SetRootQueueDisc ("ns3::FifoQueueDisc");
+  fabric->InstallTrafficControl (hostTch, switchTch);
+  fabric->AssignHostIpv4Addresses (Ipv4AddressHelper ("10.0.0.0", "255.255.0.0"));
+  fabric->PopulateSwitchTables ();
+  return fabric;
+}
+
+void
+FabricSwitchTestCase::SendPacket (Ptr<Socket> socket, uint32_t size)
+{
+  socket->Send (Create<Packet> (size));
+}
+
+void
+FabricSwitchTestCase::Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+      m_lastRx = Simulator::Now ();
+    }
+}
+
+/**
+ * \ingroup point-to-point-layout-test
+ * \ingroup tests
+ *
+ * \brief Check the forwarding table and the latency of a packet crossing a
+ * leaf, a spine and a leaf in store-and-forward and cut-through modes
+ */
+class FabricSwitchLatencyTest : public FabricSwitchTestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param fabricRate the data rate of the fabric links
+   * \param cutThrough whether cut-through switching is enabled
+   * \param latency the expected latency
+   */
+  FabricSwitchLatencyTest (std::string fabricRate, bool cutThrough, Time latency);
+
+private:
+  virtual void DoRun (void);
+
+  std::string m_fabricRate; //!< Data rate of the fabric links
+  bool m_cutThrough;        //!< Whether cut-through switching is enabled
+  Time m_latency;           //!< Expected latency
+};
+
+FabricSwitchLatencyTest::FabricSwitchLatencyTest (std::string fabricRate, bool cutThrough,
+                                                  Time latency)
+  : FabricSwitchTestCase ("Latency with " + fabricRate + " fabric links, cut-through "
+                          + std::to_string (cutThrough)),
+    m_fabricRate (fabricRate),
+    m_cutThrough (cutThrough),
+    m_latency (latency)
+{
+}
+
+void
+FabricSwitchLatencyTest::DoRun (void)
+{
+  TrafficControlHelper switchTch;
+  switchTch.SetRootQueueDisc ("ns3::FifoQueueDisc");
+  PointToPointLeafSpineHelper *fabric = Build (2, 1, 2, "1Gbps", m_fabricRate, m_cutThrough, switchTch);
+
+  // Spine, then leaf switches; every switch has a route to each host
+  for (uint32_t i = 0; i < fabric->SwitchCount (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (fabric->GetSwitchDevice (i)->GetNRoutes (), 4, "Wrong number of routes");
+    }
+  Ptr<FabricSwitchNetDevice> leaf = fabric->GetSwitchDevice (1);
+  NS_TEST_EXPECT_MSG_EQ ((leaf->Lookup (Ipv4Address ("10.1.0.1")) == 0), true, "Unexpected route");
+  leaf->AddRoute (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), 0);
+  NS_TEST_EXPECT_MSG_EQ ((leaf->Lookup (Ipv4Address ("10.1.0.1")) != 0), true, "Missing route");
+  const std::vector<uint32_t> *ports = leaf->Lookup (fabric->GetHostIpv4Address (3));
+  NS_TEST_ASSERT_MSG_NE (ports, 0, "Missing route");
+  NS_TEST_EXPECT_MSG_EQ (ports->size (), 1, "A single port leads to the spine");
+  NS_TEST_EXPECT_MSG_EQ (leaf->GetPort ((*ports)[0])->GetDataRate (), DataRate (m_fabricRate),
+                         "The route to a remote host does not lead to the spine");
+
+  Ptr<Socket> rxSocket = Socket::CreateSocket (fabric->GetHost (3), UdpSocketFactory::GetTypeId ());
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rxSocket->SetRecvCallback (MakeCallback (&FabricSwitchLatencyTest::Receive, this));
+  Ptr<Socket> txSocket = Socket::CreateSocket (fabric->GetHost (0), UdpSocketFactory::GetTypeId ());
+  txSocket->Connect (InetSocketAddress (fabric->GetHostIpv4Address (3), 1234));
+  Simulator::Schedule (Seconds (1), &FabricSwitchLatencyTest::SendPacket, this, txSocket, 1000);
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 1, "The packet was not received");
+  NS_TEST_EXPECT_MSG_EQ (m_lastRx - Seconds (1), m_latency, "Wrong latency");
+
+  Simulator::Destroy ();
+  delete fabric;
+}
+
+/**
+ * \ingroup point-to-point-layout-test
+ * \ingroup tests
+ *
+ * \brief Check that the flows are spread over the spines and that the queue
+ * discs of the switches mark the packets of a congested port
+ */
+class FabricSwitchEcmpEcnTest : public FabricSwitchTestCase
+{
+public:
+  FabricSwitchEcmpEcnTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FabricSwitchEcmpEcnTest::FabricSwitchEcmpEcnTest ()
+  : FabricSwitchTestCase ("ECMP over the spines and ECN marking by the queue discs")
+{
+}
+
+void
+FabricSwitchEcmpEcnTest::DoRun (void)
+{
+  TrafficControlHelper switchTch;
+  switchTch.SetRootQueueDisc ("ns3::RedQueueDisc",
+                              "UseEcn", BooleanValue (true),
+                              "MinTh", DoubleValue (5),
+                              "MaxTh", DoubleValue (5),
+                              "MaxSize", StringValue ("100p"),
+                              "MarkingMode", StringValue ("DequeueLength"));
+  PointToPointLeafSpineHelper *fabric = Build (2, 2, 4, "1Gbps", "1Gbps", true, switchTch);
+
+  // The four hosts of the first leaf send bursts of ECN capable packets
+  // to the first host of the second leaf, from several source ports
+  Ptr<Socket> rxSocket = Socket::CreateSocket (fabric->GetHost (4), UdpSocketFactory::GetTypeId ());
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rxSocket->SetRecvCallback (MakeCallback (&FabricSwitchEcmpEcnTest::Receive, this));
+  for (uint32_t h = 0; h < 4; h++)
+    {
+      for (uint32_t s = 0; s < 4; s++)
+        {
+          Ptr<Socket> txSocket = Socket::CreateSocket (fabric->GetHost (h), UdpSocketFactory::GetTypeId ());
+          txSocket->Connect (InetSocketAddress (fabric->GetHostIpv4Address (4), 1234));
+          txSocket->SetIpTos (Ipv4Header::ECN_ECT0);
+          for (uint32_t i = 0; i < 5; i++)
+            {
+              Simulator::Schedule (Seconds (1), &FabricSwitchEcmpEcnTest::SendPacket, this, txSocket, 1000);
+            }
+        }
+    }
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 80, "Packets were lost");
+  for (uint32_t spine = 0; spine < 2; spine++)
+    {
+      uint32_t forwarded = 0;
+      Ptr<FabricSwitchNetDevice> sw = fabric->GetSwitchDevice (spine);
+      for (uint32_t p = 0; p < sw->GetNPorts (); p++)
+        {
+          Ptr<TrafficControlLayer> tc = sw->GetNode ()->GetObject<TrafficControlLayer> ();
+          forwarded += tc->GetRootQueueDiscOnDevice (sw->GetPort (p))->GetStats ().nTotalReceivedPackets;
+        }
+      NS_TEST_EXPECT_MSG_GT (forwarded, 0, "No flow crossed spine " << spine);
+    }
+  // The port of the second leaf toward the receiver is congested
+  Ptr<NetDevice> port = fabric->GetHostLink (4).Get (1);
+  Ptr<TrafficControlLayer> tc = port->GetNode ()->GetObject<TrafficControlLayer> ();
+  QueueDisc::Stats stats = tc->GetRootQueueDiscOnDevice (port)->GetStats ();
+  NS_TEST_EXPECT_MSG_GT (stats.nTotalMarkedPackets, 0, "No packet was marked");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalDroppedPackets, 0, "Packets were dropped");
+
+  Simulator::Destroy ();
+  delete fabric;
+}
+
+/**
+ * \ingroup point-to-point-layout-test
+ * \ingroup tests
+ *
+ * \brief FabricSwitchNetDevice TestSuite
+ */
+class FabricSwitchTestSuite : public TestSuite
+{
+public:
+  FabricSwitchTestSuite ()
+    : TestSuite ("fabric-switch", UNIT)
+  {
+    // A packet of 1030 bytes (with the PPP header) crosses four links with a
+    // delay of 1us. Store-and-forward: (8.24 + 1) * 4 us. Cut-through, 64
+    // bytes received in 512 ns: 8.24 + 0.512 * 3 + 4 us
+    AddTestCase (new FabricSwitchLatencyTest ("1Gbps", false, NanoSeconds (36960)), TestCase::QUICK);
+    AddTestCase (new FabricSwitchLatencyTest ("1Gbps", true, NanoSeconds (13776)), TestCase::QUICK);
+    // With 4Gbps fabric links, the first leaf stores the packet because its
+    // uplink is faster than the host link: 9.24 + (0.128 + 1) * 2 + 9.24 us
+    AddTestCase (new FabricSwitchLatencyTest ("4Gbps", false, NanoSeconds (24600)), TestCase::QUICK);
+    AddTestCase (new FabricSwitchLatencyTest ("4Gbps", true, NanoSeconds (20736)), TestCase::QUICK);
+    AddTestCase (new FabricSwitchEcmpEcnTest, TestCase::QUICK);
+  }
+};
+
+static FabricSwitchTestSuite g_fabricSwitchTestSuite; //!< Static variable for test initialization
@@ -22,6 +22,9 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
+
+#include <iterator>
 
 namespace ns3 {
 
@@ -40,6 +43,12 @@ PointToPointChannel::GetTypeId (void)
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&PointToPointChannel::m_delay),
                    MakeTimeChecker ())
+    .AddAttribute ("EnableDeliveryFifo",
+                   "Deliver the packets in flight on each wire through a FIFO "
+                   "served by a single event, instead of an event per packet",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointChannel::m_deliveryFifo),
+                   MakeBooleanChecker ())
     .AddTraceSource ("TxRxPointToPoint",
                      "Trace source indicating transmission of packet "
                      "from the PointToPointChannel, used by the Animation "
@@ -57,6 +66,7 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
+    m_deliveryFifo (false),
     m_nDevices (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -97,15 +107,83 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
-                                  txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p->Copy ());
+  // A cut-through receiver gets the packet as soon as the given number of
+  // bytes has been received
+  Time rxTime = txTime;
+  uint32_t cutThroughBytes = m_link[wire].m_dst->GetCutThroughBytes ();
+  if (cutThroughBytes > 0 && cutThroughBytes < p->GetSize ())
+    {
+      rxTime = TimeStep (txTime.GetTimeStep () * cutThroughBytes / p->GetSize ());
+    }
+
+  if (m_deliveryFifo)
+    {
+      // Packets leave the wire in the same order they enter it, unless the
+      // delay has been lowered, hence the packet is normally appended and
+      // only the delivery of the head of the FIFO needs to be scheduled
+      Link &link = m_link[wire];
+      Time arrival = Simulator::Now () + rxTime + m_delay;
+      auto it = link.m_inFlight.end ();
+      while (it != link.m_inFlight.begin () && std::prev (it)->first > arrival)
+        {
+          --it;
+        }
+      bool head = (it == link.m_inFlight.begin ());
+      link.m_inFlight.insert (it, {arrival, p->Copy ()});
+      if (head)
+        {
+          ScheduleDelivery (wire, rxTime + m_delay);
+        }
+    }
+  else
+    {
+      Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+                                      rxTime + m_delay, &PointToPointNetDevice::Receive,
+                                      m_link[wire].m_dst, p->Copy ());
+    }
 
   // Call the tx anim callback on the net device
-  m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+  m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, rxTime + m_delay);
   return true;
 }
 
+void
+PointToPointChannel::ScheduleDelivery (uint32_t wire, Time delay)
+{
+  NS_LOG_FUNCTION (this << wire << delay);
+
+  Link &link = m_link[wire];
+  Simulator::ScheduleWithContext (link.m_dst->GetNode ()->GetId (), delay,
+                                  &PointToPointChannel::Deliver, this, wire, ++link.m_deliveryId);
+}
+
+void
+PointToPointChannel::Deliver (uint32_t wire, uint32_t id)
+{
+  NS_LOG_FUNCTION (this << wire << id);
+
+  Link &link = m_link[wire];
+  if (id != link.m_deliveryId)
+    {
+      NS_LOG_LOGIC ("Delivery superseded by a packet overtaking the packets in flight");
+      return;
+    }
+  NS_ASSERT (!link.m_inFlight.empty ());
+  NS_ASSERT (link.m_inFlight.front ().first == Simulator::Now ());
+  Ptr<Packet> p = link.m_inFlight.front ().second;
+  link.m_inFlight.pop_front ();
+
+  // Schedule the next delivery before the reception of this packet, as the
+  // reception of the next packet was scheduled before in the event per
+  // packet model
+  if (!link.m_inFlight.empty ())
+    {
+      ScheduleDelivery (wire, link.m_inFlight.front ().first - Simulator::Now ());
+    }
+
+  link.m_dst->Receive (p);
+}
+
 std::size_t
 PointToPointChannel::GetNDevices (void) const
 {
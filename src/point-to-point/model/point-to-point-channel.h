@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_CHANNEL_H
 
 #include <list>
+#include <deque>
 #include "ns3/channel.h"
 #include "ns3/ptr.h"
 #include "ns3/nstime.h"
@@ -44,6 +45,19 @@ class Packet;
  * [0] wire to transmit on.  The second device gets the [1] wire.  There is a
  * state (IDLE, TRANSMITTING) associated with each wire.
  *
+ * By default, the reception of every packet at the other end of the wire is
+ * a separate event, scheduled when the transmission starts, hence a busy
+ * wire keeps as many pending events as the packets in flight. If the
+ * EnableDeliveryFifo attribute is true, the packets in flight are instead
+ * stored in a FIFO and a single event per wire, scheduled at the arrival time
+ * of the head of the FIFO, delivers them in turn. The FIFO is sorted by
+ * arrival time, so that a packet sent after the Delay attribute has been
+ * lowered overtakes the packets in flight, as with an event per packet.
+ * Packets are delivered at the same times and in the same order, but events
+ * of other objects expiring at exactly the same time as a delivery may be
+ * executed in a different order, because the delivery event is scheduled
+ * later.
+ *
  * \see Attach
  * \see TransmitStart
  */
@@ -149,7 +163,23 @@ private:
   /** Each point to point link has exactly two net devices. */
   static const std::size_t N_DEVICES = 2;
 
+  /**
+   * \brief Schedule the delivery of the packet at the head of the FIFO of a
+   *        wire, superseding the delivery already scheduled, if any
+   * \param wire the index of the wire
+   * \param delay the time until the arrival of the packet
+   */
+  void ScheduleDelivery (uint32_t wire, Time delay);
+  /**
+   * \brief Deliver the packet at the head of the FIFO of a wire and schedule
+   *        the delivery of the next one, if any
+   * \param wire the index of the wire
+   * \param id the identifier of the delivery event, ignored if superseded
+   */
+  void Deliver (uint32_t wire, uint32_t id);
+
   Time          m_delay;    //!< Propagation delay
+  bool          m_deliveryFifo; //!< Deliver the packets in flight through a FIFO
   std::size_t        m_nDevices; //!< Devices of this channel
 
   /**
@@ -194,11 +224,14 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_deliveryId (0) {}
 
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    /// Packets in flight, sorted by arrival time, if the delivery FIFO is enabled
+    std::deque<std::pair<Time, Ptr<Packet> > > m_inFlight;
+    uint32_t                   m_deliveryId; //!< Identifier of the current delivery event
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
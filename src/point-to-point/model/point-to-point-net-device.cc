@@ -25,9 +25,14 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/socket.h"
+#include "ns3/pfc-header.h"
+#include "ns3/net-device-queue-interface.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -67,6 +72,20 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("CutThroughBytes",
+                   "The number of bytes of a packet that must be received "
+                   "before the packet is passed up (e.g., by the port of a "
+                   "cut-through switch). Zero to pass packets up when they "
+                   "have been entirely received",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_cutThroughBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PfcEnabled",
+                   "Whether the transmission of a priority is paused by the "
+                   "PFC frames received from the peer",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_pfcEnabled),
+                   MakeBooleanChecker ())
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -167,6 +186,21 @@ PointToPointNetDevice::GetTypeId (void)
                      "attached to the device",
                      MakeTraceSourceAccessor (&PointToPointNetDevice::m_promiscSnifferTrace),
                      "ns3::Packet::TracedCallback")
+
+    //
+    // Trace sources of Priority-based Flow Control.
+    //
+    .AddTraceSource ("PfcPause",
+                     "A priority paused by the peer has been resumed, "
+                     "with the duration of the pause",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_pfcPauseTrace),
+                     "ns3::PointToPointNetDevice::PfcPauseTracedCallback")
+    .AddTraceSource ("HolBlocking",
+                     "A packet which blocked the transmit queue because its "
+                     "priority was paused is being transmitted, with the "
+                     "time it was blocked",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_holBlockingTrace),
+                     "ns3::PointToPointNetDevice::HolBlockingTracedCallback")
   ;
   return tid;
 }
@@ -177,9 +211,13 @@ PointToPointNetDevice::PointToPointNetDevice ()
     m_txMachineState (READY),
     m_channel (0),
     m_linkUp (false),
-    m_currentPkt (0)
+    m_currentPkt (0),
+    m_cutThroughBytes (0),
+    m_pfcEnabled (false),
+    m_holBlocked (false)
 {
   NS_LOG_FUNCTION (this);
+  m_paused.fill (false);
 }
 
 PointToPointNetDevice::~PointToPointNetDevice ()
@@ -215,6 +253,11 @@ PointToPointNetDevice::DoDispose ()
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
   m_queue = 0;
+  m_controlQueue.clear ();
+  for (auto &event : m_pauseEvent)
+    {
+      event.Cancel ();
+    }
   NetDevice::DoDispose ();
 }
 
@@ -225,6 +268,18 @@ PointToPointNetDevice::SetDataRate (DataRate bps)
   m_bps = bps;
 }
 
+DataRate
+PointToPointNetDevice::GetDataRate (void) const
+{
+  return m_bps;
+}
+
+uint32_t
+PointToPointNetDevice::GetCutThroughBytes (void) const
+{
+  return m_cutThroughBytes;
+}
+
 void
 PointToPointNetDevice::SetInterframeGap (Time t)
 {
@@ -281,13 +336,69 @@ PointToPointNetDevice::TransmitComplete (void)
   m_phyTxEndTrace (m_currentPkt);
   m_currentPkt = 0;
 
+  TransmitNext ();
+}
+
+void
+PointToPointNetDevice::TransmitNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
+
+  //
+  // PFC frames are not queued behind the data, which they have to control
+  //
+  if (!m_controlQueue.empty ())
+    {
+      Ptr<Packet> p = m_controlQueue.front ();
+      m_controlQueue.pop_front ();
+      m_snifferTrace (p);
+      m_promiscSnifferTrace (p);
+      TransmitStart (p);
+      return;
+    }
+
+  if (m_pfcEnabled)
+    {
+      Ptr<const Packet> head = m_queue->Peek ();
+      if (head != 0 && m_paused[GetPriority (head)])
+        {
+          if (!m_holBlocked)
+            {
+              //
+              // The packets behind the head of the queue cannot be sent either,
+              // hence stop the upper layers until the priority is resumed
+              //
+              NS_LOG_LOGIC ("The head of the queue is paused");
+              m_holBlocked = true;
+              m_holStart = Simulator::Now ();
+              Ptr<NetDeviceQueueInterface> ndqi = GetObject<NetDeviceQueueInterface> ();
+              if (ndqi != 0)
+                {
+                  ndqi->GetTxQueue (0)->Stop ();
+                }
+            }
+          return;
+        }
+    }
+
+  //
+  // The dequeue wakes the NetDeviceQueue, if it was stopped and there is room
+  // in the queue
+  //
   Ptr<Packet> p = m_queue->Dequeue ();
   if (p == 0)
     {
-      NS_LOG_LOGIC ("No pending packets in device queue after tx complete");
+      NS_LOG_LOGIC ("No pending packets in device queue");
       return;
     }
 
+  if (m_holBlocked)
+    {
+      m_holBlocked = false;
+      m_holBlockingTrace (p, Simulator::Now () - m_holStart);
+    }
+
   //
   // Got another packet off of the queue, so start the transmit process again.
   //
@@ -296,6 +407,98 @@ PointToPointNetDevice::TransmitComplete (void)
   TransmitStart (p);
 }
 
+bool
+PointToPointNetDevice::IsPaused (uint8_t priority) const
+{
+  NS_ASSERT (priority < PFC_PRIORITIES);
+  return m_paused[priority];
+}
+
+void
+PointToPointNetDevice::ReceivePfc (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  if (!m_pfcEnabled)
+    {
+      NS_LOG_LOGIC ("PFC is disabled, ignore the frame");
+      return;
+    }
+
+  PfcHeader pfc;
+  p->RemoveHeader (pfc);
+
+  for (uint8_t i = 0; i < PFC_PRIORITIES; i++)
+    {
+      if (!pfc.IsEnabled (i))
+        {
+          continue;
+        }
+      if (pfc.GetPauseQuanta (i) == 0)
+        {
+          Resume (i);
+          continue;
+        }
+
+      // a new pause time overrides the current one
+      Time duration = PfcHeader::QuantaToTime (pfc.GetPauseQuanta (i), m_bps);
+      NS_LOG_LOGIC ("Pause priority " << +i << " for " << duration.As (Time::US));
+      if (!m_paused[i])
+        {
+          m_paused[i] = true;
+          m_pauseStart[i] = Simulator::Now ();
+        }
+      m_pauseEvent[i].Cancel ();
+      m_pauseEvent[i] = Simulator::Schedule (duration, &PointToPointNetDevice::Resume, this, i);
+    }
+}
+
+void
+PointToPointNetDevice::Resume (uint8_t priority)
+{
+  NS_LOG_FUNCTION (this << +priority);
+
+  if (!m_paused[priority])
+    {
+      return;
+    }
+  m_paused[priority] = false;
+  m_pauseEvent[priority].Cancel ();
+  m_pfcPauseTrace (priority, Simulator::Now () - m_pauseStart[priority]);
+
+  if (m_txMachineState == READY)
+    {
+      TransmitNext ();
+    }
+}
+
+uint8_t
+PointToPointNetDevice::GetPriority (Ptr<const Packet> p)
+{
+  SocketPriorityTag priorityTag;
+  if (p->PeekPacketTag (priorityTag))
+    {
+      return std::min<uint8_t> (priorityTag.GetPriority (), PFC_PRIORITIES - 1);
+    }
+
+  // read the TOS (IPv4) or the Traffic Class (IPv6) after the PPP header
+  uint8_t buf[4];
+  if (p->CopyData (buf, 4) < 4)
+    {
+      return 0;
+    }
+  uint16_t protocol = (buf[0] << 8) | buf[1];
+  if (protocol == 0x0021)
+    {
+      return Socket::IpTos2Priority (buf[3]);
+    }
+  if (protocol == 0x0057)
+    {
+      return Socket::IpTos2Priority (((buf[2] & 0x0f) << 4) | (buf[3] >> 4));
+    }
+  return 0;
+}
+
 bool
 PointToPointNetDevice::Attach (Ptr<PointToPointChannel> ch)
 {
@@ -367,6 +570,15 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
       //
       ProcessHeader (packet, protocol);
 
+      //
+      // PFC frames are consumed by the MAC layer
+      //
+      if (protocol == PfcHeader::PROT_NUMBER)
+        {
+          ReceivePfc (packet);
+          return;
+        }
+
       if (!m_promiscCallback.IsNull ())
         {
           m_macPromiscRxTrace (originalPacket);
@@ -513,6 +725,75 @@ PointToPointNetDevice::Send (
   NS_LOG_LOGIC ("p=" << packet << ", dest=" << &dest);
   NS_LOG_LOGIC ("UID is " << packet->GetUid ());
 
+  if (!EnqueueForTransmission (packet, protocolNumber))
+    {
+      return false;
+    }
+
+  //
+  // If the channel is ready for transition we send the packet right now
+  //
+  if (m_txMachineState == READY)
+    {
+      TransmitNext ();
+    }
+  return true;
+}
+
+uint32_t
+PointToPointNetDevice::GetSendBatchCapacity (void) const
+{
+  if (IsLinkUp () == false)
+    {
+      return 0;
+    }
+
+  QueueSize maxSize = m_queue->GetMaxSize ();
+  if (maxSize.GetUnit () == QueueSizeUnit::PACKETS)
+    {
+      uint32_t nPackets = m_queue->GetNPackets ();
+      return (nPackets < maxSize.GetValue () ? maxSize.GetValue () - nPackets : 0);
+    }
+
+  //
+  // Make sure that packets as large as the MTU (plus the PPP header) fit
+  //
+  uint32_t nBytes = m_queue->GetNBytes ();
+  uint32_t frameSize = m_mtu + PppHeader ().GetSerializedSize ();
+  return (nBytes < maxSize.GetValue () ? (maxSize.GetValue () - nBytes) / frameSize : 0);
+}
+
+uint32_t
+PointToPointNetDevice::SendBatch (const std::vector<BatchItem> &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  //
+  // Enqueue all the packets first, so that the transmission of the batch is
+  // started with a single call
+  //
+  uint32_t sent = 0;
+  for (const auto &item : items)
+    {
+      NS_LOG_LOGIC ("UID is " << item.packet->GetUid ());
+      if (EnqueueForTransmission (item.packet, item.protocolNumber))
+        {
+          sent++;
+        }
+    }
+
+  if (sent > 0 && m_txMachineState == READY)
+    {
+      TransmitNext ();
+    }
+  return sent;
+}
+
+bool
+PointToPointNetDevice::EnqueueForTransmission (Ptr<Packet> packet, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << packet << protocolNumber);
+
   //
   // If IsLinkUp() is false it means there is no channel to send any packet 
   // over so we just hit the drop trace on the packet and return an error.
@@ -531,22 +812,20 @@ PointToPointNetDevice::Send (
 
   m_macTxTrace (packet);
 
+  //
+  // PFC frames bypass the transmit queue
+  //
+  if (protocolNumber == PfcHeader::PROT_NUMBER)
+    {
+      m_controlQueue.push_back (packet);
+      return true;
+    }
+
   //
   // We should enqueue and dequeue the packet to hit the tracing hooks.
   //
   if (m_queue->Enqueue (packet))
     {
-      //
-      // If the channel is ready for transition we send the packet right now
-      // 
-      if (m_txMachineState == READY)
-        {
-          packet = m_queue->Dequeue ();
-          m_snifferTrace (packet);
-          m_promiscSnifferTrace (packet);
-          bool ret = TransmitStart (packet);
-          return ret;
-        }
       return true;
     }
 
@@ -653,6 +932,7 @@ PointToPointNetDevice::PppToEther (uint16_t proto)
     {
     case 0x0021: return 0x0800;   //IPv4
     case 0x0057: return 0x86DD;   //IPv6
+    case 0x8808: return 0x8808;   //MAC Control
     default: NS_ASSERT_MSG (false, "PPP Protocol number not defined!");
     }
   return 0;
@@ -666,6 +946,7 @@ PointToPointNetDevice::EtherToPpp (uint16_t proto)
     {
     case 0x0800: return 0x0021;   //IPv4
     case 0x86DD: return 0x0057;   //IPv6
+    case 0x8808: return 0x8808;   //MAC Control (not a PPP protocol)
     default: NS_ASSERT_MSG (false, "PPP Protocol number not defined!");
     }
   return 0;
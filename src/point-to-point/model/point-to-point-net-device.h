@@ -30,6 +30,9 @@
 #include "ns3/data-rate.h"
 #include "ns3/ptr.h"
 #include "ns3/mac48-address.h"
+#include "ns3/event-id.h"
+#include <array>
+#include <deque>
 
 namespace ns3 {
 
@@ -58,6 +61,18 @@ class ErrorModel;
  * Key parameters or objects that can be specified for this device 
  * include a queue, data rate, and interframe transmission gap (the 
  * propagation delay is set in the PointToPointChannel).
+ *
+ * The device can take part in Priority-based Flow Control (PFC, IEEE
+ * 802.1Qbb). PFC frames (see PfcHeader) handed to Send () with the MAC
+ * Control protocol number are transmitted ahead of the packets of the
+ * transmit queue. If PfcEnabled is true, the PFC frames received from the
+ * peer pause and resume the transmission of the packets of the given
+ * priorities, i.e., the SocketPriorityTag of the packet, if any, or else
+ * the priority mapped from the TOS or Traffic Class of its IP header (as
+ * done by Socket::IpTos2Priority). Since the device has a single transmit
+ * queue, a paused packet at the head of the queue blocks all the packets
+ * behind it; the device then stops its NetDeviceQueue, if any, so that the
+ * pause propagates to the queue disc, until the packet can be transmitted.
  */
 class PointToPointNetDevice : public NetDevice
 {
@@ -94,6 +109,18 @@ public:
    */
   void SetDataRate (DataRate bps);
 
+  /**
+   * \returns the data rate used for transmission of packets
+   */
+  DataRate GetDataRate (void) const;
+
+  /**
+   * \returns the number of bytes of a packet that must be received before
+   * the packet is passed up, or zero if packets are passed up when they have
+   * been entirely received
+   */
+  uint32_t GetCutThroughBytes (void) const;
+
   /**
    * Set the interframe gap used to separate packets.  The interframe gap
    * defines the minimum space required between packets sent by this device.
@@ -178,6 +205,27 @@ public:
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
 
+  /**
+   * \brief Get the number of packets the device can accept in a batch
+   *
+   * This is the number of packets that fit in the free room of the transmit
+   * queue (if the queue is limited in bytes, the number of MTU-sized frames
+   * that fit), or zero if the link is down.
+   *
+   * \return the number of packets that can be passed to SendBatch
+   */
+  virtual uint32_t GetSendBatchCapacity (void) const;
+  /**
+   * \brief Send a batch of packets
+   *
+   * All the packets are enqueued in the transmit queue before the
+   * transmitter is started, if idle.
+   *
+   * \param items the packets to send, in transmission order
+   * \return the number of packets that were accepted by the device
+   */
+  virtual uint32_t SendBatch (const std::vector<BatchItem> &items);
+
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
 
@@ -190,6 +238,29 @@ public:
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
 
+  /**
+   * \brief Check whether the transmission of a priority is paused by PFC
+   * \param priority the priority
+   * \return true if the priority is paused
+   */
+  bool IsPaused (uint8_t priority) const;
+
+  /**
+   * TracedCallback signature for the end of a PFC pause.
+   *
+   * \param [in] priority The priority which was paused.
+   * \param [in] duration The duration of the pause.
+   */
+  typedef void (* PfcPauseTracedCallback)(uint8_t priority, Time duration);
+
+  /**
+   * TracedCallback signature for head-of-line blocking.
+   *
+   * \param [in] packet The packet which was blocked at the head of the queue.
+   * \param [in] duration The time during which it was blocked.
+   */
+  typedef void (* HolBlockingTracedCallback)(Ptr<const Packet> packet, Time duration);
+
 protected:
   /**
    * \brief Handler for MPI receive event
@@ -275,6 +346,44 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * Start the transmission of the next PFC frame, if any, or else of the
+   * packet at the head of the transmit queue, unless its priority is paused.
+   * The transmitter must be READY.
+   */
+  void TransmitNext (void);
+
+  /**
+   * Add the PPP header to a packet and store it in the transmit queue (or in
+   * the queue of PFC frames) without starting the transmitter.
+   *
+   * \param packet the packet to send
+   * \param protocolNumber the protocol number of the payload
+   * \return true if the packet was queued, false if it was dropped
+   */
+  bool EnqueueForTransmission (Ptr<Packet> packet, uint16_t protocolNumber);
+
+  /**
+   * Pause or resume the priorities enabled in a received PFC frame.
+   *
+   * \param p the PFC frame, without the PPP header
+   */
+  void ReceivePfc (Ptr<Packet> p);
+
+  /**
+   * Resume the transmission of a paused priority.
+   *
+   * \param priority the priority
+   */
+  void Resume (uint8_t priority);
+
+  /**
+   * \brief Get the priority of a packet of the transmit queue
+   * \param p the packet, including its PPP header
+   * \return the priority of the packet
+   */
+  static uint8_t GetPriority (Ptr<const Packet> p);
+
   /**
    * \brief Make the link up and running
    *
@@ -457,6 +566,22 @@ private:
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
 
+  static const uint8_t PFC_PRIORITIES = 8; //!< Number of PFC priorities
+
+  uint32_t m_cutThroughBytes;                          //!< Bytes received before passing a packet up
+  bool m_pfcEnabled;                                   //!< Whether received PFC frames are obeyed
+  std::deque<Ptr<Packet> > m_controlQueue;             //!< PFC frames waiting to be transmitted
+  std::array<bool, PFC_PRIORITIES> m_paused;           //!< Whether each priority is paused
+  std::array<Time, PFC_PRIORITIES> m_pauseStart;       //!< Start of the pause of each priority
+  std::array<EventId, PFC_PRIORITIES> m_pauseEvent;    //!< Expiration of the pause of each priority
+  bool m_holBlocked;                                   //!< Whether the head of the queue is paused
+  Time m_holStart;                                     //!< When the head of the queue was paused
+
+  /// Traced callback: fired when a paused priority is resumed
+  TracedCallback<uint8_t, Time> m_pfcPauseTrace;
+  /// Traced callback: fired when a packet blocked at the head of the queue is transmitted
+  TracedCallback<Ptr<const Packet>, Time> m_holBlockingTrace;
+
   /**
    * \brief PPP to Ethernet protocol number mapping
    * \param protocol A PPP protocol number
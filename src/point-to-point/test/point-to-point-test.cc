@@ -24,6 +24,11 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/pfc-header.h"
+#include "ns3/socket.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include <tuple>
 
 using namespace ns3;
 
@@ -94,6 +99,612 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for Priority-based Flow Control
+ *
+ * A device at 8Mbps (a pause quantum lasts 64us) obeys the PFC frames sent
+ * by its peer. The test checks that the packets of a paused priority, and
+ * the packets queued behind them, are held until the pause expires or is
+ * cancelled, that other priorities are not paused, and the PfcPause and
+ * HolBlocking traces.
+ */
+class PointToPointPfcTest : public TestCase
+{
+public:
+  PointToPointPfcTest ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a data packet
+   * \param device the sending device
+   * \param priority the priority of the packet
+   */
+  void SendData (Ptr<PointToPointNetDevice> device, uint8_t priority);
+  /**
+   * \brief Send an IPv4-like packet with the given TOS
+   * \param device the sending device
+   * \param tos the TOS byte
+   */
+  void SendTos (Ptr<PointToPointNetDevice> device, uint8_t tos);
+  /**
+   * \brief Send a PFC frame
+   * \param device the sending device
+   * \param priority the priority
+   * \param quanta the pause time
+   */
+  void SendPfc (Ptr<PointToPointNetDevice> device, uint8_t priority, uint16_t quanta);
+  /**
+   * \brief Receive a packet
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+  /**
+   * \brief Trace the end of a pause
+   * \param priority the priority
+   * \param duration the duration of the pause
+   */
+  void PfcPause (uint8_t priority, Time duration);
+  /**
+   * \brief Trace head-of-line blocking
+   * \param p the blocked packet
+   * \param duration the time it was blocked
+   */
+  void HolBlocking (Ptr<const Packet> p, Time duration);
+
+  std::vector<std::pair<uint32_t, Time> > m_received;   //!< Size and time of the received packets
+  std::vector<std::pair<uint8_t, Time> > m_pauses;      //!< Priority and duration of the pauses
+  std::vector<Time> m_blocked;                          //!< Durations of head-of-line blocking
+};
+
+PointToPointPfcTest::PointToPointPfcTest ()
+  : TestCase ("PointToPoint PFC")
+{
+}
+
+void
+PointToPointPfcTest::SendData (Ptr<PointToPointNetDevice> device, uint8_t priority)
+{
+  Ptr<Packet> p = Create<Packet> (998 - priority);
+  SocketPriorityTag priorityTag;
+  priorityTag.SetPriority (priority);
+  p->AddPacketTag (priorityTag);
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+void
+PointToPointPfcTest::SendTos (Ptr<PointToPointNetDevice> device, uint8_t tos)
+{
+  uint8_t buf[498] = {0x45, tos};
+  device->Send (Create<Packet> (buf, sizeof (buf)), device->GetBroadcast (), 0x800);
+}
+
+void
+PointToPointPfcTest::SendPfc (Ptr<PointToPointNetDevice> device, uint8_t priority, uint16_t quanta)
+{
+  PfcHeader pfc;
+  pfc.SetPauseQuanta (priority, quanta);
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (pfc);
+  device->Send (p, device->GetBroadcast (), PfcHeader::PROT_NUMBER);
+}
+
+bool
+PointToPointPfcTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_received.push_back ({p->GetSize (), Simulator::Now ()});
+  return true;
+}
+
+void
+PointToPointPfcTest::PfcPause (uint8_t priority, Time duration)
+{
+  m_pauses.push_back ({priority, duration});
+}
+
+void
+PointToPointPfcTest::HolBlocking (Ptr<const Packet> p, Time duration)
+{
+  m_blocked.push_back (duration);
+}
+
+void
+PointToPointPfcTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  for (auto dev : {devA, devB})
+    {
+      dev->Attach (channel);
+      dev->SetAddress (Mac48Address::Allocate ());
+      dev->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+      dev->SetDataRate (DataRate ("8Mbps"));
+    }
+  devA->SetAttribute ("PfcEnabled", BooleanValue (true));
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointPfcTest::Receive, this));
+  devA->TraceConnectWithoutContext ("PfcPause", MakeCallback (&PointToPointPfcTest::PfcPause, this));
+  devA->TraceConnectWithoutContext ("HolBlocking", MakeCallback (&PointToPointPfcTest::HolBlocking, this));
+
+  // A PFC frame (48 bytes with the PPP header) pauses priority 3 for 6.4ms
+  // from 48us. The packet of priority 3 sent at 1ms blocks the packet of
+  // priority 0 behind it until 6.448ms
+  Simulator::Schedule (Seconds (0), &PointToPointPfcTest::SendPfc, this, devB, 3, 100);
+  Simulator::Schedule (MilliSeconds (1), &PointToPointPfcTest::SendData, this, devA, 3);
+  Simulator::Schedule (MilliSeconds (1), &PointToPointPfcTest::SendData, this, devA, 0);
+
+  // Priority 0 is not paused by a pause of priority 2
+  Simulator::Schedule (MilliSeconds (10), &PointToPointPfcTest::SendPfc, this, devB, 2, 0xffff);
+  Simulator::Schedule (MilliSeconds (11), &PointToPointPfcTest::SendData, this, devA, 0);
+
+  // A frame of null pause time resumes priority 2 after 2ms. The priority
+  // of a packet without tag is read from its IPv4 header: TOS 0x08 maps to
+  // priority 2
+  Simulator::Schedule (MilliSeconds (12), &PointToPointPfcTest::SendTos, this, devA, 0x08);
+  Simulator::Schedule (MilliSeconds (12), &PointToPointPfcTest::SendPfc, this, devB, 2, 0);
+  Simulator::Schedule (MilliSeconds (13), &PointToPointPfcTest::SendData, this, devA, 0);
+  Simulator::Schedule (MilliSeconds (13), &PointToPointPfcTest::SendData, this, devA, 2);
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received.size (), 6, "All the data packets should be received, not the PFC frames");
+  NS_TEST_EXPECT_MSG_EQ (m_received[0].first, 995, "The packet of priority 3 should be received first");
+  NS_TEST_EXPECT_MSG_EQ (m_received[0].second, MicroSeconds (7445), "Wrong reception time");
+  NS_TEST_EXPECT_MSG_EQ (m_received[1].second, MicroSeconds (8445), "Wrong reception time");
+  NS_TEST_EXPECT_MSG_EQ (m_received[2].second, MicroSeconds (12000), "Priority 0 should not be paused");
+  NS_TEST_EXPECT_MSG_EQ (m_received[3].first, 498, "The IPv4 packet should be received after the resume");
+  NS_TEST_EXPECT_MSG_EQ (m_received[3].second, MicroSeconds (12548), "Wrong reception time");
+  NS_TEST_EXPECT_MSG_EQ (m_received[4].second, MicroSeconds (14000), "Priority 0 should not be paused");
+  NS_TEST_EXPECT_MSG_EQ (m_received[5].second, MicroSeconds (14998), "Priority 2 should not be paused");
+
+  NS_TEST_ASSERT_MSG_EQ (m_pauses.size (), 2, "Two pauses should have ended");
+  NS_TEST_EXPECT_MSG_EQ (+m_pauses[0].first, 3, "Priority 3 should have been paused first");
+  NS_TEST_EXPECT_MSG_EQ (m_pauses[0].second, MicroSeconds (6400), "Wrong duration of the pause");
+  NS_TEST_EXPECT_MSG_EQ (+m_pauses[1].first, 2, "Priority 2 should have been paused next");
+  NS_TEST_EXPECT_MSG_EQ (m_pauses[1].second, MilliSeconds (2), "Wrong duration of the pause");
+  NS_TEST_ASSERT_MSG_EQ (m_blocked.size (), 2, "The queue should have been blocked twice");
+  NS_TEST_EXPECT_MSG_EQ (m_blocked[0], MicroSeconds (5448), "Wrong duration of the blocking");
+  NS_TEST_EXPECT_MSG_EQ (m_blocked[1], MicroSeconds (48), "Wrong duration of the blocking");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test class for the batch send interface of PointToPointNetDevice
+ *
+ * It checks that the capacity reported by the device matches the free room
+ * in its transmit queue and that the packets of a batch are all delivered,
+ * in order.
+ */
+class PointToPointBatchTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointBatchTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Receive a packet
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  std::vector<uint64_t> m_received; //!< UIDs of the received packets
+};
+
+PointToPointBatchTest::PointToPointBatchTest ()
+  : TestCase ("PointToPoint batch send")
+{
+}
+
+bool
+PointToPointBatchTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_received.push_back (p->GetUid ());
+  return true;
+}
+
+void
+PointToPointBatchTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  Ptr<Queue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetMaxSize (QueueSize ("5p"));
+  devA->SetQueue (queue);
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointBatchTest::Receive, this));
+
+  NS_TEST_EXPECT_MSG_EQ (devA->GetSendBatchCapacity (), 5, "The queue is empty");
+
+  std::vector<NetDevice::BatchItem> batch;
+  std::vector<uint64_t> uids;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (100);
+      uids.push_back (p->GetUid ());
+      batch.push_back ({p, devB->GetAddress (), 0x800});
+    }
+  NS_TEST_EXPECT_MSG_EQ (devA->SendBatch (batch), 4, "All the packets fit in the queue");
+
+  // the first packet is being transmitted, the others are queued
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 3, "Three packets should be queued");
+  NS_TEST_EXPECT_MSG_EQ (devA->GetSendBatchCapacity (), 2, "Two packets fit in the queue");
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received.size (), 4, "All the packets should be received");
+  for (uint32_t i = 0; i < m_received.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_received[i], uids[i], "Packets received out of order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (devA->GetSendBatchCapacity (), 5, "The queue is empty");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Regression test for the delivery FIFO of PointToPointChannel
+ *
+ * Four senders send bursts of packets at the same times to a switch, which
+ * forwards them to a receiver through a bottleneck link with a small queue;
+ * the receiver sends every packet back to the first sender. The times and
+ * order of all the packet receptions and the drops at the bottleneck must be
+ * the same with the event per packet model and with the delivery FIFO.
+ */
+class PointToPointDeliveryFifoTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointDeliveryFifoTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /// A packet reception: time, receiving node and packet UID
+  typedef std::tuple<Time, uint32_t, uint64_t> Reception;
+
+  /**
+   * \brief Run the scenario
+   * \param fifo whether the delivery FIFO is enabled
+   * \param receptions the packet receptions
+   * \return the number of packets dropped at the bottleneck
+   */
+  uint32_t RunScenario (bool fifo, std::vector<Reception> &receptions);
+  /**
+   * \brief Receive a packet at the switch and forward it
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \return true
+   */
+  bool SwitchReceive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+  /**
+   * \brief Receive a packet at the receiver and send it back
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \return true
+   */
+  bool ReceiverReceive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+  /**
+   * \brief Record a packet reception at a sender
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \return true
+   */
+  bool SenderReceive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+  /**
+   * \brief Send a burst of packets
+   * \param device the sending device
+   * \param n the number of packets
+   */
+  void SendBurst (Ptr<PointToPointNetDevice> device, uint32_t n);
+
+  std::vector<Reception> *m_receptions;  //!< Receptions of the current run
+  uint64_t m_firstUid;                   //!< UID of the first packet of the current run
+  Ptr<NetDevice> m_bottleneck;           //!< Device of the switch towards the receiver
+  Ptr<NetDevice> m_backDevice;           //!< Device of the switch towards the first sender
+};
+
+PointToPointDeliveryFifoTest::PointToPointDeliveryFifoTest ()
+  : TestCase ("PointToPoint delivery FIFO regression"),
+    m_receptions (0),
+    m_firstUid (0)
+{
+}
+
+bool
+PointToPointDeliveryFifoTest::SwitchReceive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_receptions->push_back (Reception (Simulator::Now (), device->GetNode ()->GetId (), p->GetUid () - m_firstUid));
+  // echoes from the receiver go back to the first sender, everything else
+  // goes to the receiver
+  Ptr<NetDevice> out = (device == m_bottleneck ? m_backDevice : m_bottleneck);
+  out->Send (p->Copy (), out->GetBroadcast (), protocol);
+  return true;
+}
+
+bool
+PointToPointDeliveryFifoTest::ReceiverReceive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_receptions->push_back (Reception (Simulator::Now (), device->GetNode ()->GetId (), p->GetUid () - m_firstUid));
+  device->Send (p->Copy (), device->GetBroadcast (), protocol);
+  return true;
+}
+
+bool
+PointToPointDeliveryFifoTest::SenderReceive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_receptions->push_back (Reception (Simulator::Now (), device->GetNode ()->GetId (), p->GetUid () - m_firstUid));
+  return true;
+}
+
+void
+PointToPointDeliveryFifoTest::SendBurst (Ptr<PointToPointNetDevice> device, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      device->Send (Create<Packet> (1000), device->GetBroadcast (), 0x800);
+    }
+}
+
+uint32_t
+PointToPointDeliveryFifoTest::RunScenario (bool fifo, std::vector<Reception> &receptions)
+{
+  const uint32_t nSenders = 4;
+  m_receptions = &receptions;
+  m_firstUid = Create<Packet> ()->GetUid ();
+
+  Ptr<Node> sw = CreateObject<Node> ();
+  Ptr<Node> receiver = CreateObject<Node> ();
+
+  auto connect = [fifo] (Ptr<Node> a, Ptr<Node> b, std::string rate, uint32_t queueSize)
+    {
+      Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MicroSeconds (50)));
+      channel->SetAttribute ("EnableDeliveryFifo", BooleanValue (fifo));
+      std::vector<Ptr<PointToPointNetDevice> > devices;
+      for (auto& node : {a, b})
+        {
+          Ptr<PointToPointNetDevice> dev = CreateObject<PointToPointNetDevice> ();
+          dev->SetAttribute ("DataRate", DataRateValue (DataRate (rate)));
+          dev->SetAddress (Mac48Address::Allocate ());
+          Ptr<Queue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+          queue->SetMaxSize (QueueSize (QueueSizeUnit::PACKETS, queueSize));
+          dev->SetQueue (queue);
+          dev->Attach (channel);
+          node->AddDevice (dev);
+          devices.push_back (dev);
+        }
+      return devices;
+    };
+
+  std::vector<Ptr<PointToPointNetDevice> > senderDevices;
+  for (uint32_t i = 0; i < nSenders; i++)
+    {
+      Ptr<Node> sender = CreateObject<Node> ();
+      auto devices = connect (sender, sw, "1Gbps", 100);
+      devices[0]->SetReceiveCallback (MakeCallback (&PointToPointDeliveryFifoTest::SenderReceive, this));
+      devices[1]->SetReceiveCallback (MakeCallback (&PointToPointDeliveryFifoTest::SwitchReceive, this));
+      senderDevices.push_back (devices[0]);
+      if (i == 0)
+        {
+          m_backDevice = devices[1];
+        }
+    }
+  auto devices = connect (sw, receiver, "2Gbps", 10);
+  devices[0]->SetReceiveCallback (MakeCallback (&PointToPointDeliveryFifoTest::SwitchReceive, this));
+  devices[1]->SetReceiveCallback (MakeCallback (&PointToPointDeliveryFifoTest::ReceiverReceive, this));
+  m_bottleneck = devices[0];
+
+  for (uint32_t b = 0; b < 5; b++)
+    {
+      for (uint32_t i = 0; i < nSenders; i++)
+        {
+          Simulator::Schedule (MicroSeconds (200 * b), &PointToPointDeliveryFifoTest::SendBurst,
+                               this, senderDevices[i], 10 + i);
+        }
+    }
+
+  Simulator::Run ();
+
+  uint32_t drops = m_bottleneck->GetObject<PointToPointNetDevice> ()->GetQueue ()->GetTotalDroppedPackets ();
+  m_bottleneck = 0;
+  m_backDevice = 0;
+  Simulator::Destroy ();
+  return drops;
+}
+
+void
+PointToPointDeliveryFifoTest::DoRun (void)
+{
+  std::vector<Reception> eventPerPacket;
+  std::vector<Reception> deliveryFifo;
+  uint32_t drops = RunScenario (false, eventPerPacket);
+  NS_TEST_EXPECT_MSG_GT (drops, 0, "The bottleneck should drop packets");
+  NS_TEST_EXPECT_MSG_EQ (RunScenario (true, deliveryFifo), drops, "Different number of drops");
+
+  NS_TEST_ASSERT_MSG_EQ (deliveryFifo.size (), eventPerPacket.size (), "Different number of receptions");
+  for (uint32_t i = 0; i < eventPerPacket.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((deliveryFifo[i] == eventPerPacket[i]), true,
+                             "Reception " << i << " differs: packet " << std::get<2> (deliveryFifo[i])
+                             << " received by node " << std::get<1> (deliveryFifo[i])
+                             << " at " << std::get<0> (deliveryFifo[i]).As (Time::US)
+                             << " instead of packet " << std::get<2> (eventPerPacket[i])
+                             << " received by node " << std::get<1> (eventPerPacket[i])
+                             << " at " << std::get<0> (eventPerPacket[i]).As (Time::US));
+    }
+}
+
+/**
+ * \brief Check the delivery FIFO of PointToPointChannel when the delay changes
+ *
+ * A burst of packets is sent over a link whose delay is lowered during the
+ * burst, hence the packets sent after the change overtake the packets in
+ * flight. The times and order of the receptions must be the same with the
+ * event per packet model and with the delivery FIFO.
+ */
+class PointToPointDeliveryFifoDelayTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointDeliveryFifoDelayTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /// A packet reception: time and packet UID
+  typedef std::pair<Time, uint64_t> Reception;
+
+  /**
+   * \brief Run the scenario
+   * \param fifo whether the delivery FIFO is enabled
+   * \param receptions the packet receptions
+   */
+  void RunScenario (bool fifo, std::vector<Reception> &receptions);
+  /**
+   * \brief Record a packet reception
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+  /**
+   * \brief Change the delay of a channel
+   * \param channel the channel
+   * \param delay the new delay
+   */
+  void SetDelay (Ptr<PointToPointChannel> channel, Time delay);
+
+  std::vector<Reception> *m_receptions;  //!< Receptions of the current run
+  uint64_t m_firstUid;                   //!< UID of the first packet of the current run
+};
+
+PointToPointDeliveryFifoDelayTest::PointToPointDeliveryFifoDelayTest ()
+  : TestCase ("PointToPoint delivery FIFO with a delay change"),
+    m_receptions (0),
+    m_firstUid (0)
+{
+}
+
+bool
+PointToPointDeliveryFifoDelayTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_receptions->push_back (Reception (Simulator::Now (), p->GetUid () - m_firstUid));
+  return true;
+}
+
+void
+PointToPointDeliveryFifoDelayTest::SetDelay (Ptr<PointToPointChannel> channel, Time delay)
+{
+  channel->SetAttribute ("Delay", TimeValue (delay));
+}
+
+void
+PointToPointDeliveryFifoDelayTest::RunScenario (bool fifo, std::vector<Reception> &receptions)
+{
+  m_receptions = &receptions;
+  m_firstUid = Create<Packet> ()->GetUid () + 1;
+
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MicroSeconds (100)));
+  channel->SetAttribute ("EnableDeliveryFifo", BooleanValue (fifo));
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  for (auto& dev : {devA, devB})
+    {
+      dev->SetAttribute ("DataRate", DataRateValue (DataRate ("1Gbps")));
+      dev->SetAddress (Mac48Address::Allocate ());
+      dev->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+      dev->Attach (channel);
+    }
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointDeliveryFifoDelayTest::Receive, this));
+
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      devA->Send (Create<Packet> (1000), devA->GetBroadcast (), 0x800);
+    }
+  Simulator::Schedule (MicroSeconds (40), &PointToPointDeliveryFifoDelayTest::SetDelay,
+                       this, channel, MicroSeconds (10));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+PointToPointDeliveryFifoDelayTest::DoRun (void)
+{
+  std::vector<Reception> eventPerPacket;
+  std::vector<Reception> deliveryFifo;
+  RunScenario (false, eventPerPacket);
+  RunScenario (true, deliveryFifo);
+
+  NS_TEST_ASSERT_MSG_EQ (eventPerPacket.size (), 20, "All the packets should be received");
+  NS_TEST_EXPECT_MSG_NE (eventPerPacket.front ().second, 0, "No packet overtook the first one");
+  NS_TEST_ASSERT_MSG_EQ (deliveryFifo.size (), eventPerPacket.size (), "Different number of receptions");
+  for (uint32_t i = 0; i < eventPerPacket.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((deliveryFifo[i] == eventPerPacket[i]), true,
+                             "Reception " << i << " differs: packet " << deliveryFifo[i].second
+                             << " received at " << deliveryFifo[i].first.As (Time::US)
+                             << " instead of packet " << eventPerPacket[i].second
+                             << " received at " << eventPerPacket[i].first.As (Time::US));
+    }
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +721,10 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointPfcTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBatchTest, TestCase::QUICK);
+  AddTestCase (new PointToPointDeliveryFifoTest, TestCase::QUICK);
+  AddTestCase (new PointToPointDeliveryFifoDelayTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -0,0 +1,290 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** Network topology
+ *
+ *   s0 ------|
+ *   s1 ------|     1Gb/s, 10us
+ *   ...      sw ----------------- r
+ *   sN-1 ----|   PifoQueueDisc
+ *
+ * The senders start TCP flows of mixed sizes (mostly short flows of a few
+ * kilobytes, and some long flows of a few megabytes) towards the receiver,
+ * and the flow completion times (FCT) of the short and long flows are
+ * reported. The PifoQueueDisc on the bottleneck device of the switch ranks
+ * the packets according to the --scheduler argument:
+ *
+ * - fifo:    every packet has rank 0 (a plain FIFO)
+ * - srpt:    rank = bytes of the flow not sent yet when the segment left the
+ *            sender (Shortest Remaining Processing Time)
+ * - pfabric: the srpt rank, plus pushing out the highest rank packet when
+ *            the queue is full, as in pFabric
+ * - las:     rank = bytes of the flow already sent (Least Attained Service),
+ *            which does not need to know the flow sizes
+ *
+ * The flow of each packet is identified by its TCP destination port, and
+ * the bytes already sent by the TCP sequence number of the segment.
+ *
+ * Sample usage: ./waf --run "pifo-fct-example --scheduler=pfabric"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+#include <algorithm>
+#include <iomanip>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PifoFctExample");
+
+static const uint16_t g_basePort = 9000;   //!< Port of the first flow
+static std::vector<uint64_t> g_flowSize;   //!< Size of each flow
+static std::vector<uint64_t> g_received;   //!< Bytes received of each flow
+static std::vector<Time> g_start;          //!< Start time of each flow
+static std::vector<Time> g_fct;            //!< Completion time of each flow
+
+/**
+ * Get the flow and the bytes already sent of a TCP data segment
+ * \param item the packet
+ * \param flow the index of the flow
+ * \param sent the bytes of the flow sent before this segment
+ * \return false if the packet is not a data segment of a known flow
+ */
+static bool
+GetFlowState (Ptr<const QueueDiscItem> item, uint32_t &flow, uint64_t &sent)
+{
+  Ptr<const Ipv4QueueDiscItem> ipItem = DynamicCast<const Ipv4QueueDiscItem> (item);
+  if (!ipItem || ipItem->GetHeader ().GetProtocol () != TcpL4Protocol::PROT_NUMBER)
+    {
+      return false;
+    }
+  TcpHeader tcpHeader;
+  uint32_t headerSize = item->GetPacket ()->PeekHeader (tcpHeader);
+  uint16_t port = tcpHeader.GetDestinationPort ();
+  if (item->GetPacket ()->GetSize () == headerSize || port < g_basePort)
+    {
+      // SYN, FIN, pure ACK or unknown flow
+      return false;
+    }
+  std::size_t index = port - g_basePort;
+  if (index >= g_flowSize.size ())
+    {
+      return false;
+    }
+  flow = static_cast<uint32_t> (index);
+  // the SYN takes sequence number 0
+  sent = tcpHeader.GetSequenceNumber ().GetValue () - 1;
+  return true;
+}
+
+/**
+ * SRPT and pFabric rank: the bytes of the flow not sent yet
+ * \param item the packet
+ * \return the rank
+ */
+static uint64_t
+RemainingSizeRank (Ptr<const QueueDiscItem> item)
+{
+  uint32_t flow;
+  uint64_t sent;
+  if (!GetFlowState (item, flow, sent))
+    {
+      return 0;
+    }
+  return g_flowSize[flow] > sent ? g_flowSize[flow] - sent : 0;
+}
+
+/**
+ * LAS rank: the bytes of the flow already sent
+ * \param item the packet
+ * \return the rank
+ */
+static uint64_t
+AttainedServiceRank (Ptr<const QueueDiscItem> item)
+{
+  uint32_t flow;
+  uint64_t sent;
+  if (!GetFlowState (item, flow, sent))
+    {
+      return 0;
+    }
+  return sent;
+}
+
+/**
+ * Record the bytes received by a flow
+ * \param flow the index of the flow
+ * \param p the packet
+ * \param from the sender address
+ */
+static void
+RxTrace (uint32_t flow, Ptr<const Packet> p, const Address &from)
+{
+  g_received[flow] += p->GetSize ();
+  if (g_received[flow] >= g_flowSize[flow] && g_fct[flow].IsZero ())
+    {
+      g_fct[flow] = Simulator::Now () - g_start[flow];
+    }
+}
+
+/**
+ * Print the mean and maximum FCT of a set of flows
+ * \param name the name of the set
+ * \param fcts the FCTs of the completed flows of the set
+ * \param nFlows the number of flows of the set
+ */
+static void
+PrintFct (std::string name, std::vector<Time> fcts, uint32_t nFlows)
+{
+  std::cout << std::left << std::setw (12) << name << fcts.size () << "/" << nFlows << " completed";
+  if (!fcts.empty ())
+    {
+      Time sum;
+      for (const auto &fct : fcts)
+        {
+          sum += fct;
+        }
+      std::cout << ", mean FCT " << sum.GetSeconds () * 1e3 / fcts.size () << " ms"
+                << ", max FCT " << std::max_element (fcts.begin (), fcts.end ())->GetSeconds () * 1e3 << " ms";
+    }
+  std::cout << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nSenders = 8;
+  uint32_t nFlows = 80;
+  double shortFraction = 0.8;
+  std::string scheduler = "pfabric";
+  std::string queueSize = "100p";
+  double stopTime = 5;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("nSenders", "Number of senders", nSenders);
+  cmd.AddValue ("nFlows", "Number of flows", nFlows);
+  cmd.AddValue ("shortFraction", "Fraction of short flows", shortFraction);
+  cmd.AddValue ("scheduler", "fifo, srpt, pfabric or las", scheduler);
+  cmd.AddValue ("queueSize", "Size of the PifoQueueDisc", queueSize);
+  cmd.AddValue ("stopTime", "Stop time of the simulation (seconds)", stopTime);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_UNLESS (scheduler == "fifo" || scheduler == "srpt" || scheduler == "pfabric"
+                       || scheduler == "las", "Unknown scheduler " << scheduler);
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocket::InitialCwnd", UintegerValue (10));
+  // datacenter timers: the RTT is a few tens of microseconds
+  Config::SetDefault ("ns3::TcpSocketBase::MinRto", TimeValue (MilliSeconds (10)));
+  Config::SetDefault ("ns3::TcpSocket::ConnTimeout", TimeValue (MilliSeconds (10)));
+  Config::SetDefault ("ns3::RttEstimator::InitialEstimation", TimeValue (MilliSeconds (1)));
+  // with a 10ms RTO, delaying the ACK of a lone segment would trigger spurious timeouts
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (1));
+
+  NodeContainer senders;
+  senders.Create (nSenders);
+  Ptr<Node> sw = CreateObject<Node> ();
+  Ptr<Node> receiver = CreateObject<Node> ();
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("10us"));
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("1p"));
+
+  InternetStackHelper stack;
+  stack.InstallAll ();
+
+  TrafficControlHelper fifo;
+  fifo.SetRootQueueDisc ("ns3::FifoQueueDisc", "MaxSize", StringValue ("1000p"));
+  TrafficControlHelper pifo;
+  pifo.SetRootQueueDisc ("ns3::PifoQueueDisc",
+                         "MaxSize", StringValue (queueSize),
+                         "Granularity", UintegerValue (1448),
+                         "PushOut", BooleanValue (scheduler == "pfabric"));
+
+  Ipv4AddressHelper address ("10.1.0.0", "255.255.255.0");
+  for (uint32_t i = 0; i < nSenders; i++)
+    {
+      NetDeviceContainer devices = p2p.Install (senders.Get (i), sw);
+      fifo.Install (devices);
+      address.Assign (devices);
+      address.NewNetwork ();
+    }
+  NetDeviceContainer bottleneck = p2p.Install (sw, receiver);
+  Ptr<PifoQueueDisc> queueDisc = DynamicCast<PifoQueueDisc> (pifo.Install (bottleneck.Get (0)).Get (0));
+  fifo.Install (bottleneck.Get (1));
+  Ipv4InterfaceContainer receiverInterfaces = address.Assign (bottleneck);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  if (scheduler == "srpt" || scheduler == "pfabric")
+    {
+      queueDisc->SetRankCallback (MakeCallback (&RemainingSizeRank));
+    }
+  else if (scheduler == "las")
+    {
+      queueDisc->SetRankCallback (MakeCallback (&AttainedServiceRank));
+    }
+
+  Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable> ();
+  uv->SetStream (1);
+  g_flowSize.resize (nFlows);
+  g_received.assign (nFlows, 0);
+  g_start.resize (nFlows);
+  g_fct.assign (nFlows, Seconds (0));
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      bool isShort = uv->GetValue () < shortFraction;
+      g_flowSize[i] = isShort ? uv->GetInteger (2000, 50000) : uv->GetInteger (500000, 2000000);
+      g_start[i] = Seconds (uv->GetValue (0.1, 0.2));
+
+      uint16_t port = g_basePort + i;
+      PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+      ApplicationContainer sinkApp = sinkHelper.Install (receiver);
+      sinkApp.Start (Seconds (0));
+      sinkApp.Get (0)->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&RxTrace, i));
+
+      BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (receiverInterfaces.GetAddress (1), port));
+      source.SetAttribute ("MaxBytes", UintegerValue (g_flowSize[i]));
+      source.SetAttribute ("SendSize", UintegerValue (1448));
+      ApplicationContainer sourceApp = source.Install (senders.Get (i % nSenders));
+      sourceApp.Start (g_start[i]);
+    }
+
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+
+  std::vector<Time> shortFcts, longFcts;
+  uint32_t nShort = 0;
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      bool isShort = g_flowSize[i] <= 50000;
+      nShort += isShort;
+      if (!g_fct[i].IsZero ())
+        {
+          (isShort ? shortFcts : longFcts).push_back (g_fct[i]);
+        }
+    }
+  std::cout << "Scheduler " << scheduler << std::endl;
+  PrintFct ("Short flows", shortFcts, nShort);
+  PrintFct ("Long flows", longFcts, nFlows - nShort);
+  std::cout << queueDisc->GetStats () << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
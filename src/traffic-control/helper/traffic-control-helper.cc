@@ -25,6 +25,8 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/shared-buffer.h"
+#include "ns3/node.h"
 #include "traffic-control-helper.h"
 
 namespace ns3 {
@@ -284,5 +286,22 @@ TrafficControlHelper::Uninstall (NetDeviceContainer c)
     }
 }
 
+void
+TrafficControlHelper::InstallSharedBuffer (Ptr<Node> node, Ptr<SharedBuffer> buffer)
+{
+  Ptr<TrafficControlLayer> tc = node->GetObject<TrafficControlLayer> ();
+  NS_ASSERT (tc != 0);
+
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<QueueDisc> qd = tc->GetRootQueueDiscOnDevice (node->GetDevice (i));
+      if (qd != 0)
+        {
+          qd->SetSharedBuffer (buffer);
+        }
+    }
+  node->AggregateObject (buffer);
+}
+
 
 } // namespace ns3
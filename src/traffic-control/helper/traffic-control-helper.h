@@ -30,6 +30,9 @@
 
 namespace ns3 {
 
+class Node;
+class SharedBuffer;
+
 /**
  * \ingroup traffic-control
  *
@@ -283,6 +286,16 @@ public:
    */
   void Uninstall (Ptr<NetDevice> d);
 
+  /**
+   * \param node the node (e.g., a switch)
+   * \param buffer the shared buffer
+   *
+   * This method makes the root queue discs installed on the devices of the
+   * given node draw from the given shared buffer, which is also aggregated to
+   * the node. It has to be called after the queue discs are installed.
+   */
+  void InstallSharedBuffer (Ptr<Node> node, Ptr<SharedBuffer> buffer);
+
 private:
   /**
    * Actual implementation of the SetRootQueueDisc method.
@@ -0,0 +1,252 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/socket.h"
+#include "ns3/net-device-queue-interface.h"
+#include "drr-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DrrQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (DrrClass);
+
+TypeId DrrClass::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DrrClass")
+    .SetParent<QueueDiscClass> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<DrrClass> ()
+    .AddAttribute ("Quantum",
+                   "The bytes the class may send in a round. If null, it is "
+                   "set to the MTU of the device",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DrrClass::SetQuantum,
+                                         &DrrClass::GetQuantum),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+DrrClass::DrrClass ()
+  : m_quantum (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DrrClass::~DrrClass ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DrrClass::SetQuantum (uint32_t quantum)
+{
+  NS_LOG_FUNCTION (this << quantum);
+  m_quantum = quantum;
+}
+
+uint32_t
+DrrClass::GetQuantum (void) const
+{
+  return m_quantum;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (DrrQueueDisc);
+
+TypeId DrrQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DrrQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<DrrQueueDisc> ()
+  ;
+  return tid;
+}
+
+DrrQueueDisc::DrrQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::NO_LIMITS)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DrrQueueDisc::~DrrQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DrrQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_active.clear ();
+  QueueDisc::DoDispose ();
+}
+
+int32_t
+DrrQueueDisc::GetDeficit (uint32_t classId) const
+{
+  NS_ASSERT (classId < m_deficit.size ());
+  return m_deficit[classId];
+}
+
+bool
+DrrQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  int32_t ret = Classify (item);
+  uint32_t classId;
+
+  if (ret != PacketFilter::PF_NO_MATCH && ret >= 0
+      && static_cast<uint32_t> (ret) < GetNQueueDiscClasses ())
+    {
+      NS_LOG_DEBUG ("Packet filters returned " << ret);
+      classId = ret;
+    }
+  else
+    {
+      SocketPriorityTag priorityTag;
+      if (!item->GetPacket ()->PeekPacketTag (priorityTag)
+          || priorityTag.GetPriority () >= GetNQueueDiscClasses ())
+        {
+          NS_LOG_DEBUG ("No class found for the packet");
+          DropBeforeEnqueue (item, UNCLASSIFIED_DROP);
+          return false;
+        }
+      classId = priorityTag.GetPriority ();
+    }
+
+  Ptr<QueueDisc> qd = GetQueueDiscClass (classId)->GetQueueDisc ();
+  bool retval = qd->Enqueue (item);
+
+  // If Queue::Enqueue fails, QueueDisc::Drop is called by the child queue disc
+  // because QueueDisc::AddQueueDiscClass sets the drop callback
+
+  if (!m_isActive[classId] && qd->GetNPackets () > 0)
+    {
+      NS_LOG_LOGIC ("Class " << classId << " is now backlogged");
+      m_isActive[classId] = true;
+      m_deficit[classId] = m_quantum[classId];
+      m_active.push_back (classId);
+    }
+
+  return retval;
+}
+
+Ptr<QueueDiscItem>
+DrrQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  while (!m_active.empty ())
+    {
+      uint32_t classId = m_active.front ();
+      Ptr<QueueDisc> qd = GetQueueDiscClass (classId)->GetQueueDisc ();
+      Ptr<const QueueDiscItem> itemPeek = qd->Peek ();
+
+      if (!itemPeek)
+        {
+          // the child queue disc may have dropped all of its packets
+          NS_LOG_LOGIC ("Class " << classId << " has no packet to send");
+          m_isActive[classId] = false;
+          m_active.pop_front ();
+          continue;
+        }
+
+      if (static_cast<int64_t> (itemPeek->GetSize ()) <= m_deficit[classId])
+        {
+          Ptr<QueueDiscItem> item = qd->Dequeue ();
+          m_deficit[classId] -= item->GetSize ();
+          NS_LOG_LOGIC ("Dequeued from class " << classId << ", deficit " << m_deficit[classId]);
+
+          if (qd->GetNPackets () == 0)
+            {
+              m_isActive[classId] = false;
+              m_active.pop_front ();
+            }
+          return item;
+        }
+
+      m_deficit[classId] += m_quantum[classId];
+      m_active.splice (m_active.end (), m_active, m_active.begin ());
+    }
+
+  NS_LOG_LOGIC ("Queue empty");
+  return 0;
+}
+
+bool
+DrrQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("DrrQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  if (GetNQueueDiscClasses () == 0)
+    {
+      NS_LOG_ERROR ("DrrQueueDisc needs at least a class");
+      return false;
+    }
+
+  uint32_t mtu = 0;
+  Ptr<NetDeviceQueueInterface> ndqi = GetNetDeviceQueueInterface ();
+  Ptr<NetDevice> dev;
+  // if the NetDeviceQueueInterface object is aggregated to a
+  // NetDevice, get the MTU of such NetDevice
+  if (ndqi && (dev = ndqi->GetObject<NetDevice> ()))
+    {
+      mtu = dev->GetMtu ();
+    }
+
+  m_quantum.clear ();
+  for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
+    {
+      Ptr<DrrClass> c = DynamicCast<DrrClass> (GetQueueDiscClass (i));
+      uint32_t quantum = (c ? c->GetQuantum () : 0);
+
+      if (!quantum)
+        {
+          NS_LOG_DEBUG ("Setting the quantum of class " << i << " to the MTU of the device: " << mtu);
+          quantum = mtu;
+        }
+
+      if (!quantum)
+        {
+          NS_LOG_ERROR ("The quantum of class " << i << " cannot be null");
+          return false;
+        }
+      m_quantum.push_back (quantum);
+    }
+
+  return true;
+}
+
+void
+DrrQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_active.clear ();
+  m_isActive.assign (GetNQueueDiscClasses (), false);
+  m_deficit.assign (GetNQueueDiscClasses (), 0);
+}
+
+} // namespace ns3
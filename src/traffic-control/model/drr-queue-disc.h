@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DRR_QUEUE_DISC_H
+#define DRR_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A class of the DRR queue disc
+ */
+class DrrClass : public QueueDiscClass {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief DrrClass constructor
+   */
+  DrrClass ();
+
+  virtual ~DrrClass ();
+
+  /**
+   * \brief Set the quantum of this class
+   * \param quantum the bytes this class may send in a round
+   */
+  void SetQuantum (uint32_t quantum);
+  /**
+   * \brief Get the quantum of this class
+   * \return the bytes this class may send in a round
+   */
+  uint32_t GetQuantum (void) const;
+
+private:
+  uint32_t m_quantum;   //!< Bytes this class may send in a round
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Deficit Round Robin (DRR) queue disc
+ *
+ * The DRR queue disc serves its classes, each of which has a child queue
+ * disc, in a deficit round robin fashion: in each round, a backlogged class
+ * may send up to its quantum of bytes (plus the bytes left over from the
+ * previous rounds), hence the link capacity is shared among the backlogged
+ * classes in proportion to their quantum. Only the backlogged classes are
+ * visited, in the order in which they became backlogged, so that the cost of
+ * a dequeue does not depend on the number of idle classes.
+ *
+ * Packets are assigned the class returned by the packet filters, if any is
+ * able to classify them, or else the class whose index is the priority of the
+ * packet (SocketPriorityTag). Packets which cannot be classified this way are
+ * dropped. Classes with a null quantum are given the MTU of the device.
+ *
+ * The DRR queue disc is work conserving, hence it needs no timer.
+ */
+class DrrQueueDisc : public QueueDisc {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief DrrQueueDisc constructor
+   */
+  DrrQueueDisc ();
+
+  virtual ~DrrQueueDisc ();
+
+  /**
+   * \brief Get the deficit of a class
+   * \param classId the index of the class
+   * \return the bytes the class may still send in the current round
+   */
+  int32_t GetDeficit (uint32_t classId) const;
+
+  // Reasons for dropping packets
+  static constexpr const char* UNCLASSIFIED_DROP = "Unclassified packet";  //!< No class found for the packet
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  std::list<uint32_t> m_active;       //!< Backlogged classes, in round robin order
+  std::vector<bool> m_isActive;       //!< Whether each class is backlogged
+  std::vector<int32_t> m_deficit;     //!< Deficit of each class
+  std::vector<uint32_t> m_quantum;    //!< Quantum of each class
+};
+
+} // namespace ns3
+
+#endif /* DRR_QUEUE_DISC_H */
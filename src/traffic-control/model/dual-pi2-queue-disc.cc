@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/drop-tail-queue.h"
+#include "dual-pi2-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DualPi2QueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (DualPi2QueueDisc);
+
+constexpr uint32_t DualPi2QueueDisc::CLASSIC;
+constexpr uint32_t DualPi2QueueDisc::L4S;
+
+TypeId DualPi2QueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DualPi2QueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<DualPi2QueueDisc> ()
+    .AddAttribute ("MaxSize",
+                   "The maximum number of packets accepted by the two queues together",
+                   QueueSizeValue (QueueSize ("10000p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("Target",
+                   "Queue delay target of the Classic queue",
+                   TimeValue (MilliSeconds (15)),
+                   MakeTimeAccessor (&DualPi2QueueDisc::m_target),
+                   MakeTimeChecker ())
+    .AddAttribute ("Tupdate",
+                   "Time period to update the base probability",
+                   TimeValue (MilliSeconds (16)),
+                   MakeTimeAccessor (&DualPi2QueueDisc::m_tUpdate),
+                   MakeTimeChecker (Time (1)))
+    .AddAttribute ("Alpha",
+                   "Integral gain of the PI controller, in Hz",
+                   DoubleValue (0.16),
+                   MakeDoubleAccessor (&DualPi2QueueDisc::m_alpha),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("Beta",
+                   "Proportional gain of the PI controller, in Hz",
+                   DoubleValue (3.2),
+                   MakeDoubleAccessor (&DualPi2QueueDisc::m_beta),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("K",
+                   "Coupling factor between the L4S marking and the base probability",
+                   DoubleValue (2),
+                   MakeDoubleAccessor (&DualPi2QueueDisc::m_k),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MinTh",
+                   "Sojourn time above which the L4S packets are marked",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&DualPi2QueueDisc::m_minTh),
+                   MakeTimeChecker ())
+    .AddAttribute ("Range",
+                   "Range of the L4S marking ramp above MinTh (0 for a step)",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&DualPi2QueueDisc::m_range),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("TimeShift",
+                   "How much longer than the head of the L4S queue the head of the "
+                   "Classic queue has to wait before being served",
+                   TimeValue (MilliSeconds (40)),
+                   MakeTimeAccessor (&DualPi2QueueDisc::m_timeShift),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("UseEcn",
+                   "True to mark ECN capable Classic packets instead of dropping them",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DualPi2QueueDisc::m_useEcn),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("BaseProbability",
+                     "Base probability p' computed by the PI controller",
+                     MakeTraceSourceAccessor (&DualPi2QueueDisc::m_baseProb),
+                     "ns3::TracedValueCallback::Double")
+    .AddTraceSource ("ClassicProbability",
+                     "Drop/mark probability of the Classic packets",
+                     MakeTraceSourceAccessor (&DualPi2QueueDisc::m_classicProb),
+                     "ns3::TracedValueCallback::Double")
+    .AddTraceSource ("CoupledProbability",
+                     "Coupled marking probability of the L4S packets",
+                     MakeTraceSourceAccessor (&DualPi2QueueDisc::m_coupledProb),
+                     "ns3::TracedValueCallback::Double")
+  ;
+  return tid;
+}
+
+DualPi2QueueDisc::DualPi2QueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES),
+    m_baseProb (0),
+    m_classicProb (0),
+    m_coupledProb (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = CreateObject<UniformRandomVariable> ();
+}
+
+DualPi2QueueDisc::~DualPi2QueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DualPi2QueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = 0;
+  m_rtrsEvent.Cancel ();
+  QueueDisc::DoDispose ();
+}
+
+double
+DualPi2QueueDisc::GetBaseProbability (void) const
+{
+  return m_baseProb;
+}
+
+int64_t
+DualPi2QueueDisc::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uv->SetStream (stream);
+  return 1;
+}
+
+bool
+DualPi2QueueDisc::IsL4s (Ptr<const QueueDiscItem> item)
+{
+  uint8_t tosByte = 0;
+  // ECT(1) (01) and CE (11) both have the least significant bit set
+  return item->GetUint8Value (QueueItem::IP_DSFIELD, tosByte) && (tosByte & 0x1);
+}
+
+Time
+DualPi2QueueDisc::GetHeadSojourn (uint32_t index) const
+{
+  Ptr<const QueueDiscItem> item = GetInternalQueue (index)->Peek ();
+  if (!item)
+    {
+      return Seconds (0);
+    }
+  return Simulator::Now () - item->GetTimeStamp ();
+}
+
+bool
+DualPi2QueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      DropBeforeEnqueue (item, FORCED_DROP);
+      return false;
+    }
+
+  uint32_t index = IsL4s (item) ? L4S : CLASSIC;
+  NS_LOG_LOGIC ("Enqueue in the " << (index == L4S ? "L4S" : "Classic") << " queue");
+
+  // If Queue::Enqueue fails, QueueDisc::DropBeforeEnqueue is called by the
+  // internal queue because QueueDisc::AddInternalQueue sets the trace callback
+  return GetInternalQueue (index)->Enqueue (item);
+}
+
+Ptr<QueueDiscItem>
+DualPi2QueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  while (GetInternalQueue (L4S)->GetNPackets () + GetInternalQueue (CLASSIC)->GetNPackets () > 0)
+    {
+      Time lSojourn = GetHeadSojourn (L4S);
+
+      // Time-shifted FIFO scheduler
+      if (!GetInternalQueue (L4S)->IsEmpty ()
+          && (GetInternalQueue (CLASSIC)->IsEmpty ()
+              || lSojourn + m_timeShift >= GetHeadSojourn (CLASSIC)))
+        {
+          Ptr<QueueDiscItem> item = GetInternalQueue (L4S)->Dequeue ();
+
+          // Native L4S AQM: step (or ramp) on the sojourn time
+          double nativeProb = 0;
+          if (lSojourn > m_minTh)
+            {
+              nativeProb = m_range.IsZero () ? 1.
+                : std::min (1., (lSojourn - m_minTh).GetSeconds () / m_range.GetSeconds ());
+            }
+
+          if (nativeProb >= 1 || (nativeProb > 0 && m_uv->GetValue () < nativeProb))
+            {
+              Mark (item, STEP_MARK);
+            }
+          else if (m_coupledProb > 0 && m_uv->GetValue () < m_coupledProb)
+            {
+              Mark (item, UNFORCED_L4S_MARK);
+            }
+          return item;
+        }
+
+      Ptr<QueueDiscItem> item = GetInternalQueue (CLASSIC)->Dequeue ();
+
+      if (m_classicProb > 0 && m_uv->GetValue () < m_classicProb)
+        {
+          if (!m_useEcn || !Mark (item, UNFORCED_CLASSIC_MARK))
+            {
+              DropAfterDequeue (item, UNFORCED_CLASSIC_DROP);
+              continue;
+            }
+        }
+      return item;
+    }
+
+  NS_LOG_LOGIC ("Queue empty");
+  return 0;
+}
+
+void
+DualPi2QueueDisc::CalculateP (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time curQ = GetHeadSojourn (CLASSIC);
+  double p = m_baseProb + m_alpha * (curQ - m_target).GetSeconds ()
+             + m_beta * (curQ - m_prevQ).GetSeconds ();
+  p = std::max (0., std::min (1., p));
+
+  m_baseProb = p;
+  m_classicProb = p * p;
+  m_coupledProb = std::min (1., m_k * p);
+  m_prevQ = curQ;
+  NS_LOG_DEBUG ("Classic queue delay " << curQ.GetMilliSeconds () << "ms, base probability " << p);
+
+  m_rtrsEvent = Simulator::Schedule (m_tUpdate, &DualPi2QueueDisc::CalculateP, this);
+}
+
+bool
+DualPi2QueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("DualPi2QueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNPacketFilters () > 0)
+    {
+      NS_LOG_ERROR ("DualPi2QueueDisc cannot have packet filters");
+      return false;
+    }
+
+  if (GetNInternalQueues () == 0)
+    {
+      // the Classic and the L4S queues, limited together by DoEnqueue
+      for (uint32_t i = 0; i < 2; i++)
+        {
+          AddInternalQueue (CreateObjectWithAttributes<DropTailQueue<QueueDiscItem> >
+                              ("MaxSize", QueueSizeValue (GetMaxSize ())));
+        }
+    }
+
+  if (GetNInternalQueues () != 2)
+    {
+      NS_LOG_ERROR ("DualPi2QueueDisc needs 2 internal queues");
+      return false;
+    }
+
+  return true;
+}
+
+void
+DualPi2QueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_baseProb = 0;
+  m_classicProb = 0;
+  m_coupledProb = 0;
+  m_prevQ = Seconds (0);
+  m_rtrsEvent = Simulator::Schedule (m_tUpdate, &DualPi2QueueDisc::CalculateP, this);
+}
+
+} // namespace ns3
@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DUAL_PI2_QUEUE_DISC_H
+#define DUAL_PI2_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-value.h"
+
+namespace ns3 {
+
+class UniformRandomVariable;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief DualQ Coupled AQM with a PI2 Classic AQM (DualPI2, RFC 9332)
+ *
+ * Packets carrying ECT(1) or CE in the ECN field of the IP header are stored
+ * in the L4S (L) queue, all the others in the Classic (C) queue. A PI
+ * controller periodically updates a base probability p' from the sojourn
+ * time of the packet at the head of the C queue. Classic packets are dropped
+ * (or marked, if ECN capable and UseEcn is true) with probability p'^2, while
+ * L4S packets are marked with the coupled probability K * p' or when their
+ * sojourn time exceeds the shallow threshold of the native L4S AQM, whichever
+ * happens first. The L queue is served first unless the head of the C queue
+ * has waited more than TimeShift longer than the head of the L queue
+ * (time-shifted FIFO). Both queues share the MaxSize limit.
+ */
+class DualPi2QueueDisc : public QueueDisc
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief DualPi2QueueDisc Constructor
+   */
+  DualPi2QueueDisc ();
+
+  /**
+   * \brief DualPi2QueueDisc Destructor
+   */
+  virtual ~DualPi2QueueDisc ();
+
+  static constexpr uint32_t CLASSIC = 0; //!< Index of the Classic internal queue
+  static constexpr uint32_t L4S = 1;     //!< Index of the L4S internal queue
+
+  /**
+   * \brief Get the base probability p' computed by the PI controller
+   * \return the base probability
+   */
+  double GetBaseProbability (void) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  // Reasons for dropping packets
+  static constexpr const char* UNFORCED_CLASSIC_DROP = "Unforced drop in classic queue"; //!< PI2 drops of Classic packets
+  static constexpr const char* FORCED_DROP = "Forced drop";                              //!< Drops due to the shared limit
+  // Reasons for marking packets
+  static constexpr const char* UNFORCED_CLASSIC_MARK = "Unforced mark in classic queue"; //!< PI2 marks of Classic packets
+  static constexpr const char* UNFORCED_L4S_MARK = "Unforced mark in L4S queue";         //!< Coupled marks of L4S packets
+  static constexpr const char* STEP_MARK = "Step mark in L4S queue";                     //!< Native AQM marks of L4S packets
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief Check whether a packet belongs to the L4S queue
+   * \param item the packet
+   * \return true if the ECN field of the packet is ECT(1) or CE
+   */
+  static bool IsL4s (Ptr<const QueueDiscItem> item);
+
+  /**
+   * \brief Get the sojourn time of the packet at the head of an internal queue
+   * \param index the index of the internal queue
+   * \return the sojourn time, zero if the queue is empty
+   */
+  Time GetHeadSojourn (uint32_t index) const;
+
+  /**
+   * \brief Update the base probability (PI controller)
+   */
+  void CalculateP (void);
+
+  // ** Variables supplied by user
+  Time m_target;                     //!< Classic queue delay target
+  Time m_tUpdate;                    //!< Update interval of the PI controller
+  double m_alpha;                    //!< Integral gain, in Hz
+  double m_beta;                     //!< Proportional gain, in Hz
+  double m_k;                        //!< Coupling factor
+  Time m_minTh;                      //!< Sojourn time above which L4S packets are marked
+  Time m_range;                      //!< Range of the L4S marking ramp (zero for a step)
+  Time m_timeShift;                  //!< Time shift of the Classic queue in the scheduler
+  bool m_useEcn;                     //!< Mark ECN capable Classic packets instead of dropping them
+
+  // ** Variables maintained by DualPI2
+  TracedValue<double> m_baseProb;    //!< Base probability p'
+  TracedValue<double> m_classicProb; //!< Classic drop/mark probability p'^2
+  TracedValue<double> m_coupledProb; //!< Coupled L4S marking probability K * p'
+  Time m_prevQ;                      //!< Classic queue delay at the previous update
+  EventId m_rtrsEvent;               //!< Event to update the base probability
+  Ptr<UniformRandomVariable> m_uv;   //!< Rng stream
+};
+
+} // namespace ns3
+
+#endif /* DUAL_PI2_QUEUE_DISC_H */
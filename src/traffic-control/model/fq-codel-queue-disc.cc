@@ -106,6 +106,8 @@ FqCoDelFlow::GetIndex (void) const
 
 NS_OBJECT_ENSURE_REGISTERED (FqCoDelQueueDisc);
 
+constexpr uint32_t FqCoDelQueueDisc::NO_FLOW;
+
 TypeId FqCoDelQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::FqCoDelQueueDisc")
@@ -174,7 +176,9 @@ TypeId FqCoDelQueueDisc::GetTypeId (void)
 
 FqCoDelQueueDisc::FqCoDelQueueDisc ()
   : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
-    m_quantum (0)
+    m_quantum (0),
+    m_newFlows {NO_FLOW, NO_FLOW},
+    m_oldFlows {NO_FLOW, NO_FLOW}
 {
   NS_LOG_FUNCTION (this);
 }
@@ -184,6 +188,16 @@ FqCoDelQueueDisc::~FqCoDelQueueDisc ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+FqCoDelQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flowTable.clear ();
+  m_newFlows = {NO_FLOW, NO_FLOW};
+  m_oldFlows = {NO_FLOW, NO_FLOW};
+  QueueDisc::DoDispose ();
+}
+
 void
 FqCoDelQueueDisc::SetQuantum (uint32_t quantum)
 {
@@ -208,24 +222,48 @@ FqCoDelQueueDisc::SetAssociativeHash (uint32_t flowHash)
 
   for (uint32_t i = outerHash; i < outerHash + m_setWays; i++)
     {
-      auto it = m_flowsIndices.find (i);
+      FlowTableEntry &entry = m_flowTable[i];
 
-      if (it == m_flowsIndices.end ()
-          || (m_tags.find (i) != m_tags.end () && m_tags[i] == flowHash)
-          || StaticCast<FqCoDelFlow> (GetQueueDiscClass (it->second))->GetStatus () == FqCoDelFlow::INACTIVE)
+      if (entry.tag == flowHash || entry.flow->GetStatus () == FqCoDelFlow::INACTIVE)
         {
-          // this queue has not been created yet or is associated with this flow
-          // or is inactive, hence we can use it
-          m_tags[i] = flowHash;
+          // this queue is associated with this flow or is inactive, hence we
+          // can use it
+          entry.tag = flowHash;
           return i;
         }
     }
 
   // all the queues of the set are used. Use the first queue of the set
-  m_tags[outerHash] = flowHash;
+  m_flowTable[outerHash].tag = flowHash;
   return outerHash;
 }
 
+void
+FqCoDelQueueDisc::PushBack (FlowList &list, uint32_t h)
+{
+  m_flowTable[h].next = NO_FLOW;
+  if (list.tail == NO_FLOW)
+    {
+      list.head = h;
+    }
+  else
+    {
+      m_flowTable[list.tail].next = h;
+    }
+  list.tail = h;
+}
+
+void
+FqCoDelQueueDisc::PopFront (FlowList &list)
+{
+  NS_ASSERT (list.head != NO_FLOW);
+  list.head = m_flowTable[list.head].next;
+  if (list.head == NO_FLOW)
+    {
+      list.tail = NO_FLOW;
+    }
+}
+
 bool
 FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 {
@@ -262,42 +300,18 @@ FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       h = flowHash % m_flows;
     }
 
-  Ptr<FqCoDelFlow> flow;
-  if (m_flowsIndices.find (h) == m_flowsIndices.end ())
-    {
-      NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
-      flow = m_flowFactory.Create<FqCoDelFlow> ();
-      Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc> ();
-      // If CoDel, Set values of CoDelQueueDisc to match this QueueDisc
-      Ptr<CoDelQueueDisc> codel = qd->GetObject<CoDelQueueDisc> ();
-      if (codel)
-        {
-          codel->SetAttribute ("UseEcn", BooleanValue (m_useEcn));
-          codel->SetAttribute ("CeThreshold", TimeValue (m_ceThreshold));
-          codel->SetAttribute ("UseL4s", BooleanValue (m_useL4s));
-        }
-      qd->Initialize ();
-      flow->SetQueueDisc (qd);
-      flow->SetIndex (h);
-      AddQueueDiscClass (flow);
-
-      m_flowsIndices[h] = GetNQueueDiscClasses () - 1;
-    }
-  else
-    {
-      flow = StaticCast<FqCoDelFlow> (GetQueueDiscClass (m_flowsIndices[h]));
-    }
+  const Ptr<FqCoDelFlow> &flow = m_flowTable[h].flow;
 
   if (flow->GetStatus () == FqCoDelFlow::INACTIVE)
     {
       flow->SetStatus (FqCoDelFlow::NEW_FLOW);
       flow->SetDeficit (m_quantum);
-      m_newFlows.push_back (flow);
+      PushBack (m_newFlows, h);
     }
 
   flow->GetQueueDisc ()->Enqueue (item);
 
-  NS_LOG_DEBUG ("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+  NS_LOG_DEBUG ("Packet enqueued into flow " << h);
 
   if (GetCurrentSize () > GetMaxSize ())
     {
@@ -320,17 +334,17 @@ FqCoDelQueueDisc::DoDequeue (void)
     {
       bool found = false;
 
-      while (!found && !m_newFlows.empty ())
+      while (!found && m_newFlows.head != NO_FLOW)
         {
-          flow = m_newFlows.front ();
+          flow = m_flowTable[m_newFlows.head].flow;
 
           if (flow->GetDeficit () <= 0)
             {
               NS_LOG_DEBUG ("Increase deficit for new flow index " << flow->GetIndex ());
               flow->IncreaseDeficit (m_quantum);
               flow->SetStatus (FqCoDelFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              PopFront (m_newFlows);
+              PushBack (m_oldFlows, flow->GetIndex ());
             }
           else
             {
@@ -339,16 +353,16 @@ FqCoDelQueueDisc::DoDequeue (void)
             }
         }
 
-      while (!found && !m_oldFlows.empty ())
+      while (!found && m_oldFlows.head != NO_FLOW)
         {
-          flow = m_oldFlows.front ();
+          flow = m_flowTable[m_oldFlows.head].flow;
 
           if (flow->GetDeficit () <= 0)
             {
               NS_LOG_DEBUG ("Increase deficit for old flow index " << flow->GetIndex ());
               flow->IncreaseDeficit (m_quantum);
-              m_oldFlows.push_back (flow);
-              m_oldFlows.pop_front ();
+              PopFront (m_oldFlows);
+              PushBack (m_oldFlows, flow->GetIndex ());
             }
           else
             {
@@ -368,16 +382,16 @@ FqCoDelQueueDisc::DoDequeue (void)
       if (!item)
         {
           NS_LOG_DEBUG ("Could not get a packet from the selected flow queue");
-          if (!m_newFlows.empty ())
+          if (m_newFlows.head != NO_FLOW)
             {
               flow->SetStatus (FqCoDelFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              PopFront (m_newFlows);
+              PushBack (m_oldFlows, flow->GetIndex ());
             }
           else
             {
               flow->SetStatus (FqCoDelFlow::INACTIVE);
-              m_oldFlows.pop_front ();
+              PopFront (m_oldFlows);
             }
         }
       else
@@ -457,6 +471,24 @@ FqCoDelQueueDisc::InitializeParams (void)
   m_queueDiscFactory.Set ("MaxSize", QueueSizeValue (GetMaxSize ()));
   m_queueDiscFactory.Set ("Interval", StringValue (m_interval));
   m_queueDiscFactory.Set ("Target", StringValue (m_target));
+  m_queueDiscFactory.Set ("UseEcn", BooleanValue (m_useEcn));
+  m_queueDiscFactory.Set ("CeThreshold", TimeValue (m_ceThreshold));
+  m_queueDiscFactory.Set ("UseL4s", BooleanValue (m_useL4s));
+
+  // the flow queues (and their CoDel queue discs) are all created here, so
+  // that no object is created when packets are enqueued. The flow queue of
+  // bucket i is the i-th class of this queue disc
+  m_flowTable.assign (m_flows, FlowTableEntry {0, 0, NO_FLOW});
+  for (uint32_t h = 0; h < m_flows; h++)
+    {
+      Ptr<FqCoDelFlow> flow = m_flowFactory.Create<FqCoDelFlow> ();
+      Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc> ();
+      qd->Initialize ();
+      flow->SetQueueDisc (qd);
+      flow->SetIndex (h);
+      AddQueueDiscClass (flow);
+      m_flowTable[h].flow = flow;
+    }
 }
 
 uint32_t
@@ -467,21 +499,25 @@ FqCoDelQueueDisc::FqCoDelDrop (void)
   uint32_t maxBacklog = 0, index = 0;
   Ptr<QueueDisc> qd;
 
-  /* Queue is full! Find the fat flow and drop packet(s) from it */
-  for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
+  /* Queue is full! Find the fat flow and drop packet(s) from it. Only the
+     flows in the lists of new and old queues may hold packets */
+  for (uint32_t head : {m_newFlows.head, m_oldFlows.head})
     {
-      qd = GetQueueDiscClass (i)->GetQueueDisc ();
-      uint32_t bytes = qd->GetNBytes ();
-      if (bytes > maxBacklog)
+      for (uint32_t i = head; i != NO_FLOW; i = m_flowTable[i].next)
         {
-          maxBacklog = bytes;
-          index = i;
+          qd = m_flowTable[i].flow->GetQueueDisc ();
+          uint32_t bytes = qd->GetNBytes ();
+          if (bytes > maxBacklog)
+            {
+              maxBacklog = bytes;
+              index = i;
+            }
         }
     }
 
   /* Our goal is to drop half of this fat flow backlog */
   uint32_t len = 0, count = 0, threshold = maxBacklog >> 1;
-  qd = GetQueueDiscClass (index)->GetQueueDisc ();
+  qd = m_flowTable[index].flow->GetQueueDisc ();
   Ptr<QueueDiscItem> item;
 
   do
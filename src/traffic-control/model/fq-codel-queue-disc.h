@@ -24,8 +24,7 @@
 
 #include "ns3/queue-disc.h"
 #include "ns3/object-factory.h"
-#include <list>
-#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -141,12 +140,52 @@ public:
   static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
   static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
 
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
 private:
   virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
   virtual Ptr<QueueDiscItem> DoDequeue (void);
   virtual bool CheckConfig (void);
   virtual void InitializeParams (void);
 
+  static constexpr uint32_t NO_FLOW = UINT32_MAX;  //!< Marks the end of a list of flows
+
+  /**
+   * \brief An entry of the flow table, which is indexed by hash bucket
+   */
+  struct FlowTableEntry
+  {
+    Ptr<FqCoDelFlow> flow;  //!< The flow queue of the bucket
+    uint32_t tag;           //!< Hash of the flow last assigned to the bucket (set associative hash)
+    uint32_t next;          //!< Next bucket in the list of new or old flows
+  };
+
+  /**
+   * \brief A FIFO list of flows, linked through the entries of the flow table
+   */
+  struct FlowList
+  {
+    uint32_t head;          //!< First bucket of the list
+    uint32_t tail;          //!< Last bucket of the list
+  };
+
+  /**
+   * \brief Append a bucket to a list of flows
+   * \param list the list
+   * \param h the bucket
+   */
+  void PushBack (FlowList &list, uint32_t h);
+
+  /**
+   * \brief Remove the first bucket from a list of flows
+   * \param list the list
+   */
+  void PopFront (FlowList &list);
+
   /**
    * \brief Drop a packet from the head of the queue with the largest current byte count
    * \return the index of the queue with the largest current byte count
@@ -174,11 +213,9 @@ private:
   bool m_enableSetAssociativeHash; //!< whether to enable set associative hash
   bool m_useL4s;             //!< True if L4S is used (ECT1 packets are marked at CE threshold)
 
-  std::list<Ptr<FqCoDelFlow> > m_newFlows;    //!< The list of new flows
-  std::list<Ptr<FqCoDelFlow> > m_oldFlows;    //!< The list of old flows
-
-  std::map<uint32_t, uint32_t> m_flowsIndices;    //!< Map with the index of class for each flow
-  std::map<uint32_t, uint32_t> m_tags;            //!< Tags used by set associative hash
+  std::vector<FlowTableEntry> m_flowTable;  //!< The flow table, with an entry per bucket
+  FlowList m_newFlows;                      //!< The list of new flows
+  FlowList m_oldFlows;                      //!< The list of old flows
 
   ObjectFactory m_flowFactory;         //!< Factory to create a new flow
   ObjectFactory m_queueDiscFactory;    //!< Factory to create a new queue
@@ -0,0 +1,542 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/integer.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/net-device-queue-interface.h"
+#include "htb-queue-disc.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HtbQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (HtbClass);
+
+TypeId HtbClass::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HtbClass")
+    .SetParent<QueueDiscClass> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<HtbClass> ()
+    .AddAttribute ("Parent",
+                   "The index of the parent class, -1 for a root class",
+                   IntegerValue (-1),
+                   MakeIntegerAccessor (&HtbClass::m_parent),
+                   MakeIntegerChecker<int32_t> (-1))
+    .AddAttribute ("Rate",
+                   "The rate guaranteed to the class",
+                   DataRateValue (DataRate ("0bps")),
+                   MakeDataRateAccessor (&HtbClass::m_rate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Ceil",
+                   "The maximum rate of the class, borrowing included. "
+                   "If null, it is equal to Rate",
+                   DataRateValue (DataRate ("0bps")),
+                   MakeDataRateAccessor (&HtbClass::m_ceil),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Burst",
+                   "Size of the bucket of the guaranteed rate in bytes. If null, "
+                   "it is set to the bytes sent at Rate in 1ms plus the MTU",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HtbClass::m_burst),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Cburst",
+                   "Size of the bucket of the maximum rate in bytes. If null, "
+                   "it is set to the bytes sent at Ceil in 1ms plus the MTU",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HtbClass::m_cburst),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Quantum",
+                   "The bytes a leaf may send in a round when sharing the "
+                   "capacity with the leaves of the same priority. If null, it "
+                   "is set to Rate (in bytes/s) divided by the R2q of the queue disc",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HtbClass::m_quantum),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Priority",
+                   "The priority of a leaf (lower values are served first)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HtbClass::m_priority),
+                   MakeUintegerChecker<uint8_t> (0, HtbQueueDisc::N_PRIORITIES - 1))
+  ;
+  return tid;
+}
+
+HtbClass::HtbClass ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HtbClass::~HtbClass ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+int32_t
+HtbClass::GetParent (void) const
+{
+  return m_parent;
+}
+
+DataRate
+HtbClass::GetRate (void) const
+{
+  return m_rate;
+}
+
+DataRate
+HtbClass::GetCeil (void) const
+{
+  return m_ceil;
+}
+
+uint32_t
+HtbClass::GetBurst (void) const
+{
+  return m_burst;
+}
+
+uint32_t
+HtbClass::GetCburst (void) const
+{
+  return m_cburst;
+}
+
+uint32_t
+HtbClass::GetQuantum (void) const
+{
+  return m_quantum;
+}
+
+uint8_t
+HtbClass::GetPriority (void) const
+{
+  return m_priority;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (HtbQueueDisc);
+
+constexpr uint8_t HtbQueueDisc::N_PRIORITIES;
+constexpr uint32_t HtbQueueDisc::NO_LEVEL;
+
+TypeId HtbQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HtbQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<HtbQueueDisc> ()
+    .AddAttribute ("DefaultClass",
+                   "The index of the leaf of the packets that cannot be classified "
+                   "otherwise. If it is not a leaf, such packets are dropped",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HtbQueueDisc::m_defaultClass),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("R2q",
+                   "The divisor of the rate (in bytes/s) of a leaf giving its "
+                   "quantum, if not set",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&HtbQueueDisc::m_r2q),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+HtbQueueDisc::HtbQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::NO_LIMITS)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HtbQueueDisc::~HtbQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HtbQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_watchdog.Cancel ();
+  m_state.clear ();
+  for (auto &active : m_active)
+    {
+      active.clear ();
+    }
+  QueueDisc::DoDispose ();
+}
+
+uint32_t
+HtbQueueDisc::GetLevel (uint32_t classId) const
+{
+  NS_ASSERT (classId < m_state.size ());
+  return m_state[classId].level;
+}
+
+void
+HtbQueueDisc::Refill (uint32_t classId, Time now)
+{
+  ClassState &c = m_state[classId];
+  double delta = (now - c.checkPoint).GetSeconds ();
+  c.tokens = std::min (c.burst, c.tokens + delta * c.rate);
+  c.ctokens = std::min (c.cburst, c.ctokens + delta * c.ceil);
+  c.checkPoint = now;
+}
+
+uint32_t
+HtbQueueDisc::GetSendLevel (uint32_t leaf, Time now)
+{
+  int32_t classId = leaf;
+  while (classId >= 0)
+    {
+      Refill (classId, now);
+      const ClassState &c = m_state[classId];
+      if (c.ctokens < 0)
+        {
+          // the class cannot send, nor borrow
+          return NO_LEVEL;
+        }
+      if (c.tokens >= 0)
+        {
+          return c.level;
+        }
+      // the class may borrow from its parent
+      classId = c.parent;
+    }
+  return NO_LEVEL;
+}
+
+void
+HtbQueueDisc::Charge (uint32_t leaf, uint32_t bytes, uint32_t level)
+{
+  for (int32_t classId = leaf; classId >= 0; classId = m_state[classId].parent)
+    {
+      ClassState &c = m_state[classId];
+      c.ctokens -= bytes;
+      // the classes below the lender only borrowed the capacity
+      if (c.level >= level)
+        {
+          c.tokens -= bytes;
+        }
+    }
+}
+
+void
+HtbQueueDisc::ScheduleWatchdog (void)
+{
+  double wait = -1;
+  for (const auto &active : m_active)
+    {
+      for (uint32_t leaf : active)
+        {
+          for (int32_t classId = leaf; classId >= 0; classId = m_state[classId].parent)
+            {
+              const ClassState &c = m_state[classId];
+              if (c.tokens < 0 && (wait < 0 || -c.tokens / c.rate < wait))
+                {
+                  wait = -c.tokens / c.rate;
+                }
+              if (c.ctokens < 0 && (wait < 0 || -c.ctokens / c.ceil < wait))
+                {
+                  wait = -c.ctokens / c.ceil;
+                }
+            }
+        }
+    }
+
+  if (wait < 0)
+    {
+      return;
+    }
+
+  // round up, so that the bucket is no longer empty when the watchdog expires
+  Time delay = NanoSeconds (static_cast<int64_t> (std::ceil (wait * 1e9)));
+  if (m_watchdog.IsRunning () && Simulator::GetDelayLeft (m_watchdog) <= delay)
+    {
+      return;
+    }
+  m_watchdog.Cancel ();
+  m_watchdog = Simulator::Schedule (delay, &QueueDisc::Run, this);
+  NS_LOG_LOGIC ("Watchdog scheduled in " << delay);
+}
+
+bool
+HtbQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  int32_t ret = Classify (item);
+  uint32_t classId = m_defaultClass;
+
+  if (ret != PacketFilter::PF_NO_MATCH && ret >= 0
+      && static_cast<uint32_t> (ret) < m_state.size () && m_state[ret].leaf)
+    {
+      NS_LOG_DEBUG ("Packet filters returned " << ret);
+      classId = ret;
+    }
+  else
+    {
+      SocketPriorityTag priorityTag;
+      if (item->GetPacket ()->PeekPacketTag (priorityTag)
+          && priorityTag.GetPriority () < m_state.size ()
+          && m_state[priorityTag.GetPriority ()].leaf)
+        {
+          classId = priorityTag.GetPriority ();
+        }
+    }
+
+  if (classId >= m_state.size () || !m_state[classId].leaf)
+    {
+      NS_LOG_DEBUG ("No leaf found for the packet");
+      DropBeforeEnqueue (item, UNCLASSIFIED_DROP);
+      return false;
+    }
+
+  Ptr<QueueDisc> qd = GetQueueDiscClass (classId)->GetQueueDisc ();
+  bool retval = qd->Enqueue (item);
+
+  // If Queue::Enqueue fails, QueueDisc::Drop is called by the child queue disc
+  // because QueueDisc::AddQueueDiscClass sets the drop callback
+
+  ClassState &c = m_state[classId];
+  if (!c.active && qd->GetNPackets () > 0)
+    {
+      NS_LOG_LOGIC ("Leaf " << classId << " is now backlogged");
+      c.active = true;
+      m_active[c.priority].push_back (classId);
+    }
+
+  return retval;
+}
+
+Ptr<QueueDiscItem>
+HtbQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time now = Simulator::Now ();
+
+  while (true)
+    {
+      // find the backlogged leaf that can send at the lowest level, with the
+      // lowest priority value, and first in round robin order
+      uint32_t bestLevel = NO_LEVEL;
+      uint8_t bestPriority = 0;
+      std::list<uint32_t>::iterator bestIt;
+
+      for (uint8_t prio = 0; prio < N_PRIORITIES && bestLevel > 0; prio++)
+        {
+          for (auto it = m_active[prio].begin (); it != m_active[prio].end (); it++)
+            {
+              uint32_t level = GetSendLevel (*it, now);
+              if (level < bestLevel)
+                {
+                  bestLevel = level;
+                  bestPriority = prio;
+                  bestIt = it;
+                  if (level == 0)
+                    {
+                      break;
+                    }
+                }
+            }
+        }
+
+      if (bestLevel == NO_LEVEL)
+        {
+          NS_LOG_LOGIC ("No leaf can send");
+          ScheduleWatchdog ();
+          return 0;
+        }
+
+      uint32_t leaf = *bestIt;
+      ClassState &c = m_state[leaf];
+      Ptr<QueueDisc> qd = GetQueueDiscClass (leaf)->GetQueueDisc ();
+      Ptr<QueueDiscItem> item = qd->Dequeue ();
+
+      if (!item)
+        {
+          // the child queue disc may have dropped all of its packets
+          NS_LOG_LOGIC ("Leaf " << leaf << " has no packet to send");
+          c.active = false;
+          m_active[bestPriority].erase (bestIt);
+          continue;
+        }
+
+      Charge (leaf, item->GetSize (), bestLevel);
+      NS_LOG_LOGIC ("Dequeued from leaf " << leaf << " at level " << bestLevel);
+
+      if (qd->GetNPackets () == 0)
+        {
+          c.active = false;
+          m_active[bestPriority].erase (bestIt);
+        }
+      else
+        {
+          c.deficit -= item->GetSize ();
+          if (c.deficit < 0)
+            {
+              c.deficit += c.quantum;
+              m_active[bestPriority].splice (m_active[bestPriority].end (),
+                                             m_active[bestPriority], bestIt);
+            }
+        }
+      return item;
+    }
+}
+
+bool
+HtbQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("HtbQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  if (GetNQueueDiscClasses () == 0)
+    {
+      NS_LOG_ERROR ("HtbQueueDisc needs at least a class");
+      return false;
+    }
+
+  uint32_t mtu = 0;
+  Ptr<NetDeviceQueueInterface> ndqi = GetNetDeviceQueueInterface ();
+  Ptr<NetDevice> dev;
+  // if the NetDeviceQueueInterface object is aggregated to a
+  // NetDevice, get the MTU of such NetDevice
+  if (ndqi && (dev = ndqi->GetObject<NetDevice> ()))
+    {
+      mtu = dev->GetMtu ();
+    }
+  if (!mtu)
+    {
+      mtu = 1500;
+    }
+
+  uint32_t n = GetNQueueDiscClasses ();
+  m_state.assign (n, ClassState ());
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<HtbClass> htbClass = DynamicCast<HtbClass> (GetQueueDiscClass (i));
+      if (!htbClass)
+        {
+          NS_LOG_ERROR ("The classes of HtbQueueDisc must be HtbClass objects");
+          return false;
+        }
+
+      ClassState &c = m_state[i];
+      c.parent = htbClass->GetParent ();
+      if (c.parent >= static_cast<int32_t> (i))
+        {
+          NS_LOG_ERROR ("The parent of class " << i << " must have a lower index");
+          return false;
+        }
+
+      DataRate rate = htbClass->GetRate ();
+      DataRate ceil = htbClass->GetCeil ();
+      if (rate.GetBitRate () == 0)
+        {
+          NS_LOG_ERROR ("The rate of class " << i << " cannot be null");
+          return false;
+        }
+      if (ceil.GetBitRate () == 0)
+        {
+          ceil = rate;
+        }
+      if (ceil < rate)
+        {
+          NS_LOG_ERROR ("The ceil of class " << i << " cannot be lower than its rate");
+          return false;
+        }
+
+      c.rate = rate.GetBitRate () / 8.0;
+      c.ceil = ceil.GetBitRate () / 8.0;
+      c.burst = htbClass->GetBurst () ? htbClass->GetBurst () : c.rate * 1e-3 + mtu;
+      c.cburst = htbClass->GetCburst () ? htbClass->GetCburst () : c.ceil * 1e-3 + mtu;
+      c.quantum = htbClass->GetQuantum ();
+      if (!c.quantum)
+        {
+          c.quantum = std::max (1000.0, std::min (200000.0, c.rate / m_r2q));
+        }
+      c.priority = htbClass->GetPriority ();
+      c.leaf = true;
+      c.level = 0;
+    }
+
+  // the parent of a class has a lower index, hence the levels of the children
+  // are final when their parent is visited
+  for (uint32_t i = n; i-- > 0; )
+    {
+      if (m_state[i].parent >= 0)
+        {
+          ClassState &parent = m_state[m_state[i].parent];
+          parent.leaf = false;
+          parent.level = std::max (parent.level, m_state[i].level + 1);
+        }
+    }
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double childrenRate = 0;
+      for (uint32_t j = i + 1; j < n; j++)
+        {
+          if (m_state[j].parent == static_cast<int32_t> (i))
+            {
+              childrenRate += m_state[j].rate;
+            }
+        }
+      if (childrenRate > m_state[i].rate)
+        {
+          NS_LOG_WARN ("The rates guaranteed to the children of class " << i
+                       << " exceed its own rate");
+        }
+    }
+
+  if (m_defaultClass >= n || !m_state[m_defaultClass].leaf)
+    {
+      NS_LOG_DEBUG ("Unclassified packets will be dropped");
+    }
+
+  return true;
+}
+
+void
+HtbQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Token buckets are full at the beginning
+  for (auto &c : m_state)
+    {
+      c.tokens = c.burst;
+      c.ctokens = c.cburst;
+      c.checkPoint = Seconds (0);
+      c.deficit = 0;
+      c.active = false;
+    }
+  for (auto &active : m_active)
+    {
+      active.clear ();
+    }
+  m_watchdog.Cancel ();
+}
+
+} // namespace ns3
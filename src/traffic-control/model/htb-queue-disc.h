@@ -0,0 +1,230 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HTB_QUEUE_DISC_H
+#define HTB_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include <array>
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A class of the HTB queue disc
+ *
+ * The class is guaranteed its Rate and may borrow the unused capacity of its
+ * ancestors up to its Ceil rate. The hierarchy is described by the Parent
+ * attribute, i.e., the index of the parent class in the HTB queue disc, which
+ * has to be lower than the index of the class itself.
+ */
+class HtbClass : public QueueDiscClass {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief HtbClass constructor
+   */
+  HtbClass ();
+
+  virtual ~HtbClass ();
+
+  /**
+   * \brief Get the index of the parent class
+   * \return the index of the parent class, -1 for a root class
+   */
+  int32_t GetParent (void) const;
+  /**
+   * \brief Get the guaranteed rate
+   * \return the guaranteed rate
+   */
+  DataRate GetRate (void) const;
+  /**
+   * \brief Get the maximum rate
+   * \return the maximum rate, null if equal to the guaranteed rate
+   */
+  DataRate GetCeil (void) const;
+  /**
+   * \brief Get the size of the bucket of the guaranteed rate
+   * \return the size of the bucket in bytes, null to compute it from the rate
+   */
+  uint32_t GetBurst (void) const;
+  /**
+   * \brief Get the size of the bucket of the maximum rate
+   * \return the size of the bucket in bytes, null to compute it from the ceil
+   */
+  uint32_t GetCburst (void) const;
+  /**
+   * \brief Get the quantum
+   * \return the quantum in bytes, null to compute it from the rate
+   */
+  uint32_t GetQuantum (void) const;
+  /**
+   * \brief Get the priority
+   * \return the priority (lower values are served first)
+   */
+  uint8_t GetPriority (void) const;
+
+private:
+  int32_t m_parent;       //!< Index of the parent class
+  DataRate m_rate;        //!< Guaranteed rate
+  DataRate m_ceil;        //!< Maximum rate
+  uint32_t m_burst;       //!< Size of the bucket of the guaranteed rate
+  uint32_t m_cburst;      //!< Size of the bucket of the maximum rate
+  uint32_t m_quantum;     //!< Quantum used to share the borrowed capacity
+  uint8_t m_priority;     //!< Priority of the class
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Hierarchical Token Bucket (HTB) queue disc
+ *
+ * The HTB queue disc shapes the traffic of a hierarchy of HtbClass classes.
+ * Only the leaf classes (i.e., the classes which are not the parent of any
+ * other class) store packets, in their child queue disc; the child queue
+ * disc of inner classes is never used.
+ *
+ * Each class has two token buckets, filled at its Rate and at its Ceil. A
+ * class whose rate bucket is not empty can send; otherwise, if its ceil
+ * bucket is not empty, it may borrow from its parent, and so on up to the
+ * root. A packet is charged to the ceil bucket of its leaf and of all its
+ * ancestors, and to the rate bucket of the class it was borrowed from (the
+ * leaf itself if it could send) and of the ancestors of that class. Leaves
+ * which can send without borrowing are served first, then the leaves
+ * borrowing from the lowest levels of the hierarchy; at the same level,
+ * leaves are served in order of priority, and leaves of the same priority in
+ * deficit round robin according to their quantum.
+ *
+ * Packets are assigned the leaf returned by the packet filters, if any is
+ * able to classify them, or else the leaf whose index is the priority of the
+ * packet (SocketPriorityTag), or else the DefaultClass. Packets which cannot
+ * be assigned a leaf are dropped.
+ *
+ * When backlogged leaves exist but none of them can send, a single watchdog
+ * event per queue disc is scheduled at the earliest time at which a bucket of
+ * a backlogged leaf or of one of its ancestors is no longer empty, instead of
+ * a timer per class.
+ */
+class HtbQueueDisc : public QueueDisc {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief HtbQueueDisc constructor
+   */
+  HtbQueueDisc ();
+
+  virtual ~HtbQueueDisc ();
+
+  /**
+   * \brief Get the level of a class in the hierarchy
+   * \param classId the index of the class
+   * \return 0 for a leaf, or one plus the highest level of its children
+   */
+  uint32_t GetLevel (uint32_t classId) const;
+
+  // Reasons for dropping packets
+  static constexpr const char* UNCLASSIFIED_DROP = "Unclassified packet";  //!< No leaf found for the packet
+
+  /// Number of priorities of the leaf classes
+  static constexpr uint8_t N_PRIORITIES = 8;
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief Add the tokens accumulated by a class since its last update
+   * \param classId the index of the class
+   * \param now the current time
+   */
+  void Refill (uint32_t classId, Time now);
+
+  /**
+   * \brief Find the class a leaf can send from
+   * \param leaf the index of the leaf
+   * \param now the current time
+   * \return the level of the leaf or of the ancestor it can borrow from,
+   *         NO_LEVEL if the leaf cannot send
+   */
+  uint32_t GetSendLevel (uint32_t leaf, Time now);
+
+  /**
+   * \brief Charge the transmission of a packet
+   * \param leaf the index of the leaf
+   * \param bytes the size of the packet
+   * \param level the level returned by GetSendLevel
+   */
+  void Charge (uint32_t leaf, uint32_t bytes, uint32_t level);
+
+  /**
+   * \brief Schedule the watchdog when the first bucket of a backlogged leaf
+   *        or of one of its ancestors is no longer empty
+   */
+  void ScheduleWatchdog (void);
+
+  static constexpr uint32_t NO_LEVEL = UINT32_MAX;  //!< A leaf that cannot send
+
+  /// Configuration and state of a class
+  struct ClassState
+  {
+    int32_t parent;       //!< Index of the parent class, -1 for a root class
+    uint32_t level;       //!< Level of the class
+    bool leaf;            //!< Whether the class is a leaf
+    uint8_t priority;     //!< Priority of the leaf
+    double rate;          //!< Guaranteed rate (bytes/s)
+    double ceil;          //!< Maximum rate (bytes/s)
+    double burst;         //!< Size of the bucket of the guaranteed rate
+    double cburst;        //!< Size of the bucket of the maximum rate
+    int32_t quantum;      //!< Quantum of the leaf
+    double tokens;        //!< Tokens of the bucket of the guaranteed rate
+    double ctokens;       //!< Tokens of the bucket of the maximum rate
+    Time checkPoint;      //!< Time of the last update of the buckets
+    int32_t deficit;      //!< Deficit of the leaf
+    bool active;          //!< Whether the leaf is backlogged
+  };
+
+  uint32_t m_defaultClass;                                //!< Leaf of the unclassified packets
+  uint32_t m_r2q;                                         //!< Rate to quantum divisor
+  std::vector<ClassState> m_state;                        //!< State of the classes
+  std::array<std::list<uint32_t>, N_PRIORITIES> m_active; //!< Backlogged leaves of each priority
+  EventId m_watchdog;                                     //!< The watchdog event
+};
+
+} // namespace ns3
+
+#endif /* HTB_QUEUE_DISC_H */
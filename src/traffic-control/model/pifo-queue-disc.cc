@@ -0,0 +1,381 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/packet.h"
+#include "pifo-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PifoQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (PifoRankTag);
+
+TypeId
+PifoRankTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PifoRankTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<PifoRankTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+PifoRankTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+PifoRankTag::GetSerializedSize (void) const
+{
+  return 8;
+}
+
+void
+PifoRankTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU64 (m_rank);
+}
+
+void
+PifoRankTag::Deserialize (TagBuffer buf)
+{
+  m_rank = buf.ReadU64 ();
+}
+
+void
+PifoRankTag::Print (std::ostream &os) const
+{
+  os << "Rank=" << m_rank;
+}
+
+PifoRankTag::PifoRankTag ()
+  : Tag (),
+    m_rank (0)
+{
+}
+
+PifoRankTag::PifoRankTag (uint64_t rank)
+  : Tag (),
+    m_rank (rank)
+{
+}
+
+void
+PifoRankTag::SetRank (uint64_t rank)
+{
+  m_rank = rank;
+}
+
+uint64_t
+PifoRankTag::GetRank (void) const
+{
+  return m_rank;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (PifoQueueDisc);
+
+constexpr uint32_t PifoQueueDisc::NO_BUCKET;
+constexpr uint32_t PifoQueueDisc::NO_SLOT;
+
+TypeId PifoQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PifoQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<PifoQueueDisc> ()
+    .AddAttribute ("MaxSize",
+                   "The max queue size",
+                   QueueSizeValue (QueueSize ("1000p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("NumBuckets",
+                   "The number of FIFO buckets approximating the PIFO",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&PifoQueueDisc::m_nBuckets),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Granularity",
+                   "The number of consecutive ranks stored in a bucket",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PifoQueueDisc::m_granularity),
+                   MakeUintegerChecker<uint64_t> (1))
+    .AddAttribute ("PushOut",
+                   "When full, drop the last packet of the highest rank bucket "
+                   "instead of an arriving packet of lower rank",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PifoQueueDisc::m_pushOut),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+PifoQueueDisc::PifoQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES),
+    m_freeSlot (NO_SLOT)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PifoQueueDisc::~PifoQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PifoQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_buckets.clear ();
+  m_slots.clear ();
+  m_rank = MakeNullCallback<uint64_t, Ptr<const QueueDiscItem> > ();
+  QueueDisc::DoDispose ();
+}
+
+void
+PifoQueueDisc::SetRankCallback (RankCallback cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_rank = cb;
+}
+
+uint32_t
+PifoQueueDisc::GetBucket (uint64_t rank) const
+{
+  return static_cast<uint32_t> (std::min<uint64_t> (rank / m_granularity, m_nBuckets - 1));
+}
+
+uint64_t
+PifoQueueDisc::GetRank (Ptr<const QueueDiscItem> item) const
+{
+  if (!m_rank.IsNull ())
+    {
+      return m_rank (item);
+    }
+  PifoRankTag tag;
+  if (item->GetPacket ()->PeekPacketTag (tag))
+    {
+      return tag.GetRank ();
+    }
+  return 0;
+}
+
+void
+PifoQueueDisc::PushBack (uint32_t bucket, Ptr<QueueDiscItem> item)
+{
+  uint32_t slot = m_freeSlot;
+  if (slot == NO_SLOT)
+    {
+      slot = m_slots.size ();
+      m_slots.push_back (Slot ());
+    }
+  else
+    {
+      m_freeSlot = m_slots[slot].prev;
+    }
+
+  Bucket &b = m_buckets[bucket];
+  m_slots[slot].item = item;
+  m_slots[slot].prev = b.tail;
+  m_slots[slot].next = NO_SLOT;
+  if (b.tail == NO_SLOT)
+    {
+      b.head = slot;
+      SetBit (bucket, true);
+    }
+  else
+    {
+      m_slots[b.tail].next = slot;
+    }
+  b.tail = slot;
+}
+
+Ptr<QueueDiscItem>
+PifoQueueDisc::Pop (uint32_t bucket, bool front)
+{
+  Bucket &b = m_buckets[bucket];
+  NS_ASSERT (b.head != NO_SLOT);
+
+  uint32_t slot = front ? b.head : b.tail;
+  Ptr<QueueDiscItem> item = m_slots[slot].item;
+  if (front)
+    {
+      b.head = m_slots[slot].next;
+      if (b.head != NO_SLOT)
+        {
+          m_slots[b.head].prev = NO_SLOT;
+        }
+    }
+  else
+    {
+      b.tail = m_slots[slot].prev;
+      if (b.tail != NO_SLOT)
+        {
+          m_slots[b.tail].next = NO_SLOT;
+        }
+    }
+  if (b.head == NO_SLOT || b.tail == NO_SLOT)
+    {
+      b.head = b.tail = NO_SLOT;
+      SetBit (bucket, false);
+    }
+
+  // put the slot on the free list
+  m_slots[slot].item = 0;
+  m_slots[slot].prev = m_freeSlot;
+  m_freeSlot = slot;
+  return item;
+}
+
+void
+PifoQueueDisc::SetBit (uint32_t bucket, bool nonEmpty)
+{
+  uint32_t word = bucket / 64;
+  if (nonEmpty)
+    {
+      m_bitmap[word] |= (uint64_t (1) << (bucket % 64));
+      m_summary[word / 64] |= (uint64_t (1) << (word % 64));
+    }
+  else
+    {
+      m_bitmap[word] &= ~(uint64_t (1) << (bucket % 64));
+      if (m_bitmap[word] == 0)
+        {
+          m_summary[word / 64] &= ~(uint64_t (1) << (word % 64));
+        }
+    }
+}
+
+uint32_t
+PifoQueueDisc::FindFirst (void) const
+{
+  for (uint32_t s = 0; s < m_summary.size (); s++)
+    {
+      if (m_summary[s])
+        {
+          uint32_t word = s * 64 + __builtin_ctzll (m_summary[s]);
+          return word * 64 + __builtin_ctzll (m_bitmap[word]);
+        }
+    }
+  return NO_BUCKET;
+}
+
+uint32_t
+PifoQueueDisc::FindLast (void) const
+{
+  for (uint32_t s = m_summary.size (); s-- > 0; )
+    {
+      if (m_summary[s])
+        {
+          uint32_t word = s * 64 + 63 - __builtin_clzll (m_summary[s]);
+          return word * 64 + 63 - __builtin_clzll (m_bitmap[word]);
+        }
+    }
+  return NO_BUCKET;
+}
+
+bool
+PifoQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  uint32_t bucket = GetBucket (GetRank (item));
+
+  while (GetCurrentSize () + item > GetMaxSize ())
+    {
+      uint32_t last = FindLast ();
+      if (!m_pushOut || last == NO_BUCKET || bucket >= last)
+        {
+          NS_LOG_LOGIC ("Queue disc limit exceeded -- dropping packet");
+          DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
+          return false;
+        }
+
+      Ptr<QueueDiscItem> victim = Pop (last, false);
+      NS_LOG_LOGIC ("Pushing out a packet of bucket " << last);
+      PacketDequeued (victim);
+      DropAfterDequeue (victim, PUSHED_OUT_DROP);
+    }
+
+  PushBack (bucket, item);
+  PacketEnqueued (item);
+
+  NS_LOG_LOGIC ("Enqueued in bucket " << bucket);
+  return true;
+}
+
+Ptr<QueueDiscItem>
+PifoQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t first = FindFirst ();
+  if (first == NO_BUCKET)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  Ptr<QueueDiscItem> item = Pop (first, true);
+  PacketDequeued (item);
+
+  NS_LOG_LOGIC ("Dequeued from bucket " << first);
+  return item;
+}
+
+bool
+PifoQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("PifoQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNPacketFilters () > 0)
+    {
+      NS_LOG_ERROR ("PifoQueueDisc cannot have packet filters");
+      return false;
+    }
+
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("PifoQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  return true;
+}
+
+void
+PifoQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nWords = (m_nBuckets + 63) / 64;
+  m_buckets.assign (m_nBuckets, Bucket {NO_SLOT, NO_SLOT});
+  m_slots.clear ();
+  m_freeSlot = NO_SLOT;
+  m_bitmap.assign (nWords, 0);
+  m_summary.assign ((nWords + 63) / 64, 0);
+}
+
+} // namespace ns3
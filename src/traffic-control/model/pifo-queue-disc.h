@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PIFO_QUEUE_DISC_H
+#define PIFO_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/tag.h"
+#include "ns3/callback.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Packet tag carrying the rank of a packet for the PifoQueueDisc
+ */
+class PifoRankTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  PifoRankTag ();
+
+  /**
+   * Constructs a PifoRankTag with the given rank
+   * \param rank the rank
+   */
+  PifoRankTag (uint64_t rank);
+  /**
+   * Set the rank
+   * \param rank the rank
+   */
+  void SetRank (uint64_t rank);
+  /**
+   * Get the rank
+   * \return the rank
+   */
+  uint64_t GetRank (void) const;
+
+private:
+  uint64_t m_rank; //!< Rank of the packet
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Programmable Push-In First-Out (PIFO) queue disc
+ *
+ * Packets are pushed in at a position given by their rank and dequeued in
+ * increasing order of rank. The rank of a packet is computed by the rank
+ * callback, if set, or else read from its PifoRankTag; packets without a tag
+ * have rank 0. Scheduling disciplines such as SRPT, LSTF or pFabric can hence
+ * be expressed as a rank function instead of a new queue disc.
+ *
+ * The PIFO is approximated by NumBuckets FIFO buckets, each covering
+ * Granularity consecutive ranks (the last bucket also holds all the larger
+ * ranks). The packets of a bucket are linked through a pool of slots, and a
+ * two-level bitmap of the non-empty buckets lets the first (or last)
+ * non-empty bucket be found with a few bit scans. Packets whose ranks fall in
+ * the same bucket are served in FIFO order; with a Granularity of 1, the
+ * order is exact for ranks lower than NumBuckets.
+ *
+ * When the queue disc is full, the arriving packet is dropped unless PushOut
+ * is true and it has a lower rank bucket than the highest non-empty bucket,
+ * in which case the last packet of that bucket is dropped instead (as in
+ * pFabric).
+ */
+class PifoQueueDisc : public QueueDisc
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief PifoQueueDisc constructor
+   */
+  PifoQueueDisc ();
+
+  virtual ~PifoQueueDisc ();
+
+  /**
+   * Callback computing the rank of a packet (lower ranks are dequeued first)
+   */
+  typedef Callback<uint64_t, Ptr<const QueueDiscItem> > RankCallback;
+
+  /**
+   * \brief Set the callback computing the rank of the packets
+   * \param cb the rank callback, or a null callback to use the PifoRankTag
+   */
+  void SetRankCallback (RankCallback cb);
+
+  /**
+   * \brief Get the bucket storing the packets of a given rank
+   * \param rank the rank
+   * \return the index of the bucket
+   */
+  uint32_t GetBucket (uint64_t rank) const;
+
+  // Reasons for dropping packets
+  static constexpr const char* LIMIT_EXCEEDED_DROP = "Queue disc limit exceeded";  //!< Packet dropped due to queue disc limit exceeded
+  static constexpr const char* PUSHED_OUT_DROP = "Pushed out by a lower rank";     //!< Queued packet dropped to admit a lower rank packet
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief Compute the rank of a packet
+   * \param item the packet
+   * \return the rank
+   */
+  uint64_t GetRank (Ptr<const QueueDiscItem> item) const;
+
+  /**
+   * \brief Append a packet to a bucket
+   * \param bucket the bucket
+   * \param item the packet
+   */
+  void PushBack (uint32_t bucket, Ptr<QueueDiscItem> item);
+
+  /**
+   * \brief Remove the first or the last packet of a non-empty bucket
+   * \param bucket the bucket
+   * \param front whether to remove the first packet rather than the last
+   * \return the packet
+   */
+  Ptr<QueueDiscItem> Pop (uint32_t bucket, bool front);
+
+  /**
+   * \brief Flag a bucket as empty or non-empty in the bitmap
+   * \param bucket the bucket
+   * \param nonEmpty whether the bucket is non-empty
+   */
+  void SetBit (uint32_t bucket, bool nonEmpty);
+
+  /**
+   * \brief Find the first non-empty bucket
+   * \return the index of the bucket, NO_BUCKET if all the buckets are empty
+   */
+  uint32_t FindFirst (void) const;
+
+  /**
+   * \brief Find the last non-empty bucket
+   * \return the index of the bucket, NO_BUCKET if all the buckets are empty
+   */
+  uint32_t FindLast (void) const;
+
+  static constexpr uint32_t NO_BUCKET = UINT32_MAX;  //!< No bucket
+  static constexpr uint32_t NO_SLOT = UINT32_MAX;    //!< No slot
+
+  /// A packet in the doubly linked list of a bucket
+  struct Slot
+  {
+    Ptr<QueueDiscItem> item;  //!< The packet
+    uint32_t prev;            //!< Previous slot in the bucket, or next free slot
+    uint32_t next;            //!< Next slot in the bucket
+  };
+
+  /// First and last slots of a bucket
+  struct Bucket
+  {
+    uint32_t head;            //!< First slot
+    uint32_t tail;            //!< Last slot
+  };
+
+  uint32_t m_nBuckets;                                   //!< Number of buckets
+  uint64_t m_granularity;                                //!< Ranks covered by a bucket
+  bool m_pushOut;                                        //!< Push out the highest rank when full
+  RankCallback m_rank;                                   //!< Rank callback
+  std::vector<Bucket> m_buckets;                         //!< The buckets
+  std::vector<Slot> m_slots;                             //!< The slots, grown on demand
+  uint32_t m_freeSlot;                                   //!< First free slot
+  std::vector<uint64_t> m_bitmap;                        //!< Non-empty buckets, one bit each
+  std::vector<uint64_t> m_summary;                       //!< Non-zero words of m_bitmap, one bit each
+};
+
+} // namespace ns3
+
+#endif /* PIFO_QUEUE_DISC_H */
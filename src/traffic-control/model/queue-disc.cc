@@ -27,13 +27,123 @@
 #include "ns3/unused.h"
 #include "ns3/simulator.h"
 #include "queue-disc.h"
+#include "shared-buffer.h"
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/queue.h"
+#include <deque>
+#include <algorithm>
+#include <cstring>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("QueueDisc");
 
+namespace {
+
+/**
+ * \ingroup traffic-control
+ *
+ * The reasons to drop or mark packets seen so far in the simulation
+ */
+struct ReasonRegistry
+{
+  std::deque<std::string> names;           //!< Reasons, indexed by identifier
+  std::map<std::string, uint32_t> ids;     //!< Identifier of each reason
+};
+
+/**
+ * \brief Get the reason registry
+ * \return the reason registry
+ */
+ReasonRegistry &
+GetReasonRegistry (void)
+{
+  static ReasonRegistry registry;
+  return registry;
+}
+
+/**
+ * \brief Look up the identifier of a reason without interning it
+ * \param reason the reason
+ * \param id the identifier of the reason, if found
+ * \return true if the reason has been interned
+ */
+bool
+FindReasonId (const std::string &reason, uint32_t &id)
+{
+  ReasonRegistry &registry = GetReasonRegistry ();
+  auto it = registry.ids.find (reason);
+  if (it == registry.ids.end ())
+    {
+      return false;
+    }
+  id = it->second;
+  return true;
+}
+
+/**
+ * \brief Make room in the counters for a reason
+ * \param counters the counters, indexed by reason identifier
+ * \param id the identifier of the reason
+ */
+template <typename T>
+void
+ExtendReasonCounters (std::vector<T> &counters, uint32_t id)
+{
+  if (id >= counters.size ())
+    {
+      counters.resize (id + 1, 0);
+    }
+}
+
+/**
+ * \brief Get the counter of a reason
+ * \param counters the counters, indexed by reason identifier
+ * \param reason the reason
+ * \return the value of the counter
+ */
+template <typename T>
+T
+GetReasonCounter (const std::vector<T> &counters, const std::string &reason)
+{
+  uint32_t id;
+  if (FindReasonId (reason, id) && id < counters.size ())
+    {
+      return counters[id];
+    }
+  return 0;
+}
+
+/**
+ * \brief Print the packet and byte counters of every reason, sorted by reason
+ * \param os the output stream
+ * \param packets the packet counters, indexed by reason identifier
+ * \param bytes the byte counters, indexed by reason identifier
+ */
+void
+PrintReasonCounters (std::ostream &os, const std::vector<uint32_t> &packets,
+                     const std::vector<uint64_t> &bytes)
+{
+  NS_ASSERT (packets.size () == bytes.size ());
+  std::vector<uint32_t> ids;
+  for (uint32_t id = 0; id < packets.size (); id++)
+    {
+      if (packets[id] > 0)
+        {
+          ids.push_back (id);
+        }
+    }
+  std::sort (ids.begin (), ids.end (), [] (uint32_t a, uint32_t b)
+             { return std::strcmp (QueueDisc::GetReason (a), QueueDisc::GetReason (b)) < 0; });
+  for (uint32_t id : ids)
+    {
+      os << std::endl << "  " << QueueDisc::GetReason (id) << ": "
+         << packets[id] << " / " << bytes[id];
+    }
+}
+
+} // unnamed namespace
+
 
 NS_OBJECT_ENSURE_REGISTERED (QueueDiscClass);
 
@@ -109,77 +219,32 @@ QueueDisc::Stats::Stats ()
 uint32_t
 QueueDisc::Stats::GetNDroppedPackets (std::string reason) const
 {
-  uint32_t count = 0;
-  auto it = nDroppedPacketsBeforeEnqueue.find (reason);
-
-  if (it != nDroppedPacketsBeforeEnqueue.end ())
-    {
-      count += it->second;
-    }
-
-  it = nDroppedPacketsAfterDequeue.find (reason);
-
-  if (it != nDroppedPacketsAfterDequeue.end ())
-    {
-      count += it->second;
-    }
-
-  return count;
+  return GetReasonCounter (nDroppedPacketsBeforeEnqueue, reason)
+         + GetReasonCounter (nDroppedPacketsAfterDequeue, reason);
 }
 
 uint64_t
 QueueDisc::Stats::GetNDroppedBytes (std::string reason) const
 {
-  uint64_t count = 0;
-  auto it = nDroppedBytesBeforeEnqueue.find (reason);
-
-  if (it != nDroppedBytesBeforeEnqueue.end ())
-    {
-      count += it->second;
-    }
-
-  it = nDroppedBytesAfterDequeue.find (reason);
-
-  if (it != nDroppedBytesAfterDequeue.end ())
-    {
-      count += it->second;
-    }
-
-  return count;
+  return GetReasonCounter (nDroppedBytesBeforeEnqueue, reason)
+         + GetReasonCounter (nDroppedBytesAfterDequeue, reason);
 }
 
 uint32_t
 QueueDisc::Stats::GetNMarkedPackets (std::string reason) const
 {
-  auto it = nMarkedPackets.find (reason);
-
-  if (it != nMarkedPackets.end ())
-    {
-      return it->second;
-    }
-
-  return 0;
+  return GetReasonCounter (nMarkedPackets, reason);
 }
 
 uint64_t
 QueueDisc::Stats::GetNMarkedBytes (std::string reason) const
 {
-  auto it = nMarkedBytes.find (reason);
-
-  if (it != nMarkedBytes.end ())
-    {
-      return it->second;
-    }
-
-  return 0;
+  return GetReasonCounter (nMarkedBytes, reason);
 }
 
 void
 QueueDisc::Stats::Print (std::ostream &os) const
 {
-  std::map<std::string, uint32_t>::const_iterator itp;
-  std::map<std::string, uint64_t>::const_iterator itb;
-
   os << std::endl << "Packets/Bytes received: "
                   << nTotalReceivedPackets << " / "
                   << nTotalReceivedBytes
@@ -199,35 +264,13 @@ QueueDisc::Stats::Print (std::ostream &os) const
                   << nTotalDroppedPacketsBeforeEnqueue << " / "
                   << nTotalDroppedBytesBeforeEnqueue;
 
-  itp = nDroppedPacketsBeforeEnqueue.begin ();
-  itb = nDroppedBytesBeforeEnqueue.begin ();
-
-  while (itp != nDroppedPacketsBeforeEnqueue.end () &&
-         itb != nDroppedBytesBeforeEnqueue.end ())
-    {
-      NS_ASSERT (itp->first.compare (itb->first) == 0);
-      os << std::endl << "  " << itp->first << ": "
-         << itp->second << " / " << itb->second;
-      itp++;
-      itb++;
-    }
+  PrintReasonCounters (os, nDroppedPacketsBeforeEnqueue, nDroppedBytesBeforeEnqueue);
 
   os << std::endl << "Packets/Bytes dropped after dequeue: "
                   << nTotalDroppedPacketsAfterDequeue << " / "
                   << nTotalDroppedBytesAfterDequeue;
 
-  itp = nDroppedPacketsAfterDequeue.begin ();
-  itb = nDroppedBytesAfterDequeue.begin ();
-
-  while (itp != nDroppedPacketsAfterDequeue.end () &&
-         itb != nDroppedBytesAfterDequeue.end ())
-    {
-      NS_ASSERT (itp->first.compare (itb->first) == 0);
-      os << std::endl << "  " << itp->first << ": "
-         << itp->second << " / " << itb->second;
-      itp++;
-      itb++;
-    }
+  PrintReasonCounters (os, nDroppedPacketsAfterDequeue, nDroppedBytesAfterDequeue);
 
   os << std::endl << "Packets/Bytes sent: "
                   << nTotalSentPackets << " / "
@@ -236,18 +279,7 @@ QueueDisc::Stats::Print (std::ostream &os) const
                   << nTotalMarkedPackets << " / "
                   << nTotalMarkedBytes;
 
-  itp = nMarkedPackets.begin ();
-  itb = nMarkedBytes.begin ();
-
-  while (itp != nMarkedPackets.end () &&
-         itb != nMarkedBytes.end ())
-    {
-      NS_ASSERT (itp->first.compare (itb->first) == 0);
-      os << std::endl << "  " << itp->first << ": "
-         << itp->second << " / " << itb->second;
-      itp++;
-      itb++;
-    }
+  PrintReasonCounters (os, nMarkedPackets, nMarkedBytes);
 
   os << std::endl;
 }
@@ -270,6 +302,17 @@ TypeId QueueDisc::GetTypeId (void)
                    MakeUintegerAccessor (&QueueDisc::SetQuota,
                                          &QueueDisc::GetQuota),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxBatchPackets",
+                   "The maximum number of packets sent to the device in a batch "
+                   "(1 disables batches)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&QueueDisc::m_maxBatchPackets),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxBatchBytes",
+                   "The maximum number of bytes sent to the device in a batch",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&QueueDisc::m_maxBatchBytes),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("InternalQueueList", "The list of internal queues.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&QueueDisc::m_queues),
@@ -282,6 +325,11 @@ TypeId QueueDisc::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&QueueDisc::m_classes),
                    MakeObjectVectorChecker<QueueDiscClass> ())
+    .AddAttribute ("SharedBuffer", "The buffer shared with other queue discs, if any.",
+                   PointerValue (),
+                   MakePointerAccessor (&QueueDisc::SetSharedBuffer,
+                                        &QueueDisc::GetSharedBuffer),
+                   MakePointerChecker<SharedBuffer> ())
     .AddTraceSource ("Enqueue", "Enqueue a packet in the queue disc",
                      MakeTraceSourceAccessor (&QueueDisc::m_traceEnqueue),
                      "ns3::QueueDiscItem::TracedCallback")
@@ -319,6 +367,53 @@ TypeId QueueDisc::GetTypeId (void)
   return tid;
 }
 
+uint32_t
+QueueDisc::GetReasonId (const char* reason)
+{
+  uint32_t id;
+  if (!FindReasonId (reason, id))
+    {
+      ReasonRegistry &registry = GetReasonRegistry ();
+      id = registry.names.size ();
+      registry.names.push_back (reason);
+      registry.ids[reason] = id;
+      NS_LOG_LOGIC ("Reason \"" << reason << "\" has identifier " << id);
+    }
+  return id;
+}
+
+const char*
+QueueDisc::GetReason (uint32_t id)
+{
+  ReasonRegistry &registry = GetReasonRegistry ();
+  NS_ASSERT (id < registry.names.size ());
+  return registry.names[id].c_str ();
+}
+
+uint32_t
+QueueDisc::LookupReason (ReasonTable &table, const char* reason, const char* prefix)
+{
+  // a queue disc drops and marks packets for a handful of reasons, which are
+  // recognized by the address of their string
+  for (auto &entry : table)
+    {
+      if (entry.first == reason)
+        {
+          return entry.second;
+        }
+    }
+
+  uint32_t id = GetReasonId (std::string (prefix).append (reason).c_str ());
+  ExtendReasonCounters (m_stats.nDroppedPacketsBeforeEnqueue, id);
+  ExtendReasonCounters (m_stats.nDroppedBytesBeforeEnqueue, id);
+  ExtendReasonCounters (m_stats.nDroppedPacketsAfterDequeue, id);
+  ExtendReasonCounters (m_stats.nDroppedBytesAfterDequeue, id);
+  ExtendReasonCounters (m_stats.nMarkedPackets, id);
+  ExtendReasonCounters (m_stats.nMarkedBytes, id);
+  table.push_back (std::make_pair (reason, id));
+  return id;
+}
+
 QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
   :  m_nPackets (0),
      m_nBytes (0),
@@ -326,7 +421,8 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
      m_running (false),
      m_peeked (false),
      m_sizePolicy (policy),
-     m_prohibitChangeMode (false)
+     m_prohibitChangeMode (false),
+     m_sharedBufferPort (0)
 {
   NS_LOG_FUNCTION (this << (uint16_t)policy);
 
@@ -352,18 +448,16 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
   // the packet is dropped.
   m_childQueueDiscDbeFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropBeforeEnqueue (item,
-                                m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      return DropBeforeEnqueue (item, LookupReason (m_childDropReasons, r, CHILD_QUEUE_DISC_DROP));
     };
   m_childQueueDiscDadFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropAfterDequeue (item,
-                               m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      return DropAfterDequeue (item, LookupReason (m_childDropReasons, r, CHILD_QUEUE_DISC_DROP));
     };
   m_childQueueDiscMarkFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
       return Mark (const_cast<QueueDiscItem *> (PeekPointer (item)),
-                   m_childQueueDiscMarkMsg.assign (CHILD_QUEUE_DISC_MARK).append (r).data ());
+                   LookupReason (m_childMarkReasons, r, CHILD_QUEUE_DISC_MARK));
     };
 }
 
@@ -388,7 +482,10 @@ QueueDisc::DoDispose (void)
   m_classes.clear ();
   m_devQueueIface = 0;
   m_send = nullptr;
+  m_sendBatch = nullptr;
+  m_batchCapacity = nullptr;
   m_requeued = 0;
+  m_sharedBuffer = 0;
   m_internalQueueDbeFunctor = nullptr;
   m_internalQueueDadFunctor = nullptr;
   m_childQueueDiscDbeFunctor = nullptr;
@@ -535,6 +632,25 @@ QueueDisc::GetCurrentSize (void)
   NS_ABORT_MSG ("Unknown queue size unit");
 }
 
+void
+QueueDisc::SetSharedBuffer (Ptr<SharedBuffer> buffer)
+{
+  NS_LOG_FUNCTION (this << buffer);
+  NS_ABORT_MSG_IF (m_nPackets.Get () > 0, "Cannot attach a non-empty queue disc to a shared buffer");
+
+  m_sharedBuffer = buffer;
+  if (m_sharedBuffer)
+    {
+      m_sharedBufferPort = m_sharedBuffer->AddPort ();
+    }
+}
+
+Ptr<SharedBuffer>
+QueueDisc::GetSharedBuffer (void) const
+{
+  return m_sharedBuffer;
+}
+
 void
 QueueDisc::SetNetDeviceQueueInterface (Ptr<NetDeviceQueueInterface> ndqi)
 {
@@ -563,6 +679,14 @@ QueueDisc::GetSendCallback (void) const
   return m_send;
 }
 
+void
+QueueDisc::SetSendBatchCallback (SendBatchCallback send, BatchCapacityCallback capacity)
+{
+  NS_LOG_FUNCTION (this);
+  m_sendBatch = send;
+  m_batchCapacity = capacity;
+}
+
 void
 QueueDisc::SetQuota (const uint32_t quota)
 {
@@ -699,6 +823,19 @@ QueueDisc::PacketEnqueued (Ptr<const QueueDiscItem> item)
   m_stats.nTotalEnqueuedPackets++;
   m_stats.nTotalEnqueuedBytes += item->GetSize ();
 
+  if (m_sharedBuffer)
+    {
+      uint8_t priority = SharedBuffer::GetPriority (item);
+      m_sharedBuffer->Allocate (m_sharedBufferPort, priority, item->GetSize ());
+
+      // packets received from another device are tagged if the buffer does PFC
+      IngressDeviceTag ingressTag;
+      if (item->GetPacket ()->PeekPacketTag (ingressTag))
+        {
+          m_sharedBuffer->AllocateIngress (ingressTag.GetIfIndex (), priority, item->GetSize ());
+        }
+    }
+
   NS_LOG_LOGIC ("m_traceEnqueue (p)");
   m_traceEnqueue (item);
 }
@@ -718,6 +855,19 @@ QueueDisc::PacketDequeued (Ptr<const QueueDiscItem> item)
       m_stats.nTotalDequeuedPackets++;
       m_stats.nTotalDequeuedBytes += item->GetSize ();
 
+      if (m_sharedBuffer)
+        {
+          uint8_t priority = SharedBuffer::GetPriority (item);
+          m_sharedBuffer->Release (m_sharedBufferPort, priority, item->GetSize ());
+
+          // the tag is not needed past the node
+          IngressDeviceTag ingressTag;
+          if (item->GetPacket ()->RemovePacketTag (ingressTag))
+            {
+              m_sharedBuffer->ReleaseIngress (ingressTag.GetIfIndex (), priority, item->GetSize ());
+            }
+        }
+
       m_sojourn (Simulator::Now () - item->GetTimeStamp ());
 
       NS_LOG_LOGIC ("m_traceDequeue (p)");
@@ -728,6 +878,13 @@ QueueDisc::PacketDequeued (Ptr<const QueueDiscItem> item)
 void
 QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
 {
+  DropBeforeEnqueue (item, LookupReason (m_reasons, reason));
+}
+
+void
+QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, uint32_t id)
+{
+  const char* reason = GetReason (id);
   NS_LOG_FUNCTION (this << item << reason);
 
   m_stats.nTotalDroppedPackets++;
@@ -735,26 +892,9 @@ QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
   m_stats.nTotalDroppedPacketsBeforeEnqueue++;
   m_stats.nTotalDroppedBytesBeforeEnqueue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsBeforeEnqueue.find (reason);
-  if (itp != m_stats.nDroppedPacketsBeforeEnqueue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsBeforeEnqueue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesBeforeEnqueue.find (reason);
-  if (itb != m_stats.nDroppedBytesBeforeEnqueue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesBeforeEnqueue[reason] = item->GetSize ();
-    }
+  // update the counters of the given reason
+  m_stats.nDroppedPacketsBeforeEnqueue[id]++;
+  m_stats.nDroppedBytesBeforeEnqueue[id] += item->GetSize ();
 
   NS_LOG_DEBUG ("Total packets/bytes dropped before enqueue: "
                 << m_stats.nTotalDroppedPacketsBeforeEnqueue << " / "
@@ -767,6 +907,13 @@ QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
 void
 QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
 {
+  DropAfterDequeue (item, LookupReason (m_reasons, reason));
+}
+
+void
+QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, uint32_t id)
+{
+  const char* reason = GetReason (id);
   NS_LOG_FUNCTION (this << item << reason);
 
   m_stats.nTotalDroppedPackets++;
@@ -774,26 +921,9 @@ QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
   m_stats.nTotalDroppedPacketsAfterDequeue++;
   m_stats.nTotalDroppedBytesAfterDequeue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsAfterDequeue.find (reason);
-  if (itp != m_stats.nDroppedPacketsAfterDequeue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsAfterDequeue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesAfterDequeue.find (reason);
-  if (itb != m_stats.nDroppedBytesAfterDequeue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesAfterDequeue[reason] = item->GetSize ();
-    }
+  // update the counters of the given reason
+  m_stats.nDroppedPacketsAfterDequeue[id]++;
+  m_stats.nDroppedBytesAfterDequeue[id] += item->GetSize ();
 
   // if in the context of a peek request a dequeued packet is dropped, we need
   // to update the statistics and fire the dequeue trace before firing the drop
@@ -817,6 +947,13 @@ QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
 bool
 QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
 {
+  return Mark (item, LookupReason (m_reasons, reason));
+}
+
+bool
+QueueDisc::Mark (Ptr<QueueDiscItem> item, uint32_t id)
+{
+  const char* reason = GetReason (id);
   NS_LOG_FUNCTION (this << item << reason);
 
   bool retval = item->Mark ();
@@ -829,26 +966,9 @@ QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
   m_stats.nTotalMarkedPackets++;
   m_stats.nTotalMarkedBytes += item->GetSize ();
 
-  // update the number of packets marked for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nMarkedPackets.find (reason);
-  if (itp != m_stats.nMarkedPackets.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nMarkedPackets[reason] = 1;
-    }
-  // update the amount of bytes marked for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nMarkedBytes.find (reason);
-  if (itb != m_stats.nMarkedBytes.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nMarkedBytes[reason] = item->GetSize ();
-    }
+  // update the counters of the given reason
+  m_stats.nMarkedPackets[id]++;
+  m_stats.nMarkedBytes[id] += item->GetSize ();
 
   NS_LOG_DEBUG ("Total packets/bytes marked: "
                 << m_stats.nTotalMarkedPackets << " / "
@@ -865,11 +985,29 @@ QueueDisc::Enqueue (Ptr<QueueDiscItem> item)
   m_stats.nTotalReceivedPackets++;
   m_stats.nTotalReceivedBytes += item->GetSize ();
 
+  // Dynamic Threshold admission and ECN marking by the shared buffer, if any.
+  // The packet is only marked if it is then enqueued
+  bool sharedBufferMark = false;
+  if (m_sharedBuffer)
+    {
+      if (!m_sharedBuffer->Admit (m_sharedBufferPort, SharedBuffer::GetPriority (item),
+                                  item->GetSize ()))
+        {
+          DropBeforeEnqueue (item, SHARED_BUFFER_DROP);
+          return false;
+        }
+      sharedBufferMark = m_sharedBuffer->ShouldMark (m_sharedBufferPort);
+    }
+
   bool retval = DoEnqueue (item);
 
   if (retval)
     {
       item->SetTimeStamp (Simulator::Now ());
+      if (sharedBufferMark)
+        {
+          Mark (item, SHARED_BUFFER_MARK);
+        }
     }
 
   // DoEnqueue may return false because:
@@ -926,6 +1064,26 @@ QueueDisc::Dequeue (void)
   return item;
 }
 
+std::vector<Ptr<QueueDiscItem> >
+QueueDisc::DequeueBatch (uint32_t maxPackets, uint32_t maxBytes)
+{
+  NS_LOG_FUNCTION (this << maxPackets << maxBytes);
+
+  std::vector<Ptr<QueueDiscItem> > items;
+  uint32_t nBytes = 0;
+  while (items.size () < maxPackets && nBytes < maxBytes)
+    {
+      Ptr<QueueDiscItem> item = Dequeue ();
+      if (item == 0)
+        {
+          break;
+        }
+      nBytes += item->GetSize ();
+      items.push_back (item);
+    }
+  return items;
+}
+
 Ptr<const QueueDiscItem>
 QueueDisc::Peek (void)
 {
@@ -959,14 +1117,15 @@ QueueDisc::Run (void)
   if (RunBegin ())
     {
       uint32_t quota = m_quota;
-      while (Restart ())
+      uint32_t nPackets = 0;
+      while (Restart (quota, nPackets))
         {
-          quota -= 1;
-          if (quota <= 0)
+          if (nPackets >= quota)
             {
               /// \todo netif_schedule (q);
               break;
             }
+          quota -= nPackets;
         }
       RunEnd ();
     }
@@ -993,9 +1152,10 @@ QueueDisc::RunEnd (void)
 }
 
 bool
-QueueDisc::Restart (void)
+QueueDisc::Restart (uint32_t quota, uint32_t &nPackets)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << quota);
+  nPackets = 0;
   Ptr<QueueDiscItem> item = DequeuePacket();
   if (item == 0)
     {
@@ -1003,6 +1163,27 @@ QueueDisc::Restart (void)
       return false;
     }
 
+  // Batches are only sent to single queue devices, and never contain more
+  // packets than the device can accept without dropping them
+  if (m_maxBatchPackets > 1 && m_sendBatch && m_batchCapacity
+      && (!m_devQueueIface || m_devQueueIface->GetNTxQueues () == 1))
+    {
+      uint32_t maxPackets = std::min ({m_maxBatchPackets, m_batchCapacity (), quota});
+      if (maxPackets > 1 && item->GetSize () < m_maxBatchBytes)
+        {
+          std::vector<Ptr<QueueDiscItem> > items {item};
+          for (auto& i : DequeueBatch (maxPackets - 1, m_maxBatchBytes - item->GetSize ()))
+            {
+              i->AddHeader ();
+              items.push_back (i);
+            }
+          NS_LOG_LOGIC ("Sending a batch of " << items.size () << " packets");
+          nPackets = items.size ();
+          return TransmitBatch (items);
+        }
+    }
+
+  nPackets = 1;
   return Transmit (item);
 }
 
@@ -1049,7 +1230,7 @@ QueueDisc::DequeuePacket ()
             {
               item->AddHeader ();
             }
-          // Here, Linux tries bulk dequeues
+          // Here, Linux tries bulk dequeues (see Restart)
         }
     }
   return item;
@@ -1118,4 +1299,26 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   return true;
 }
 
+bool
+QueueDisc::TransmitBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  for (auto& item : items)
+    {
+      SocketPriorityTag priorityTag;
+      item->GetPacket ()->RemovePacketTag (priorityTag);
+    }
+  m_sendBatch (items);
+
+  // as in Transmit, the packets are assumed to be consumed by the netdevice
+  if (GetNPackets () == 0 ||
+      (m_devQueueIface && m_devQueueIface->GetTxQueue (0)->IsStopped ()))
+    {
+      return false;
+    }
+
+  return true;
+}
+
 } // namespace ns3
@@ -36,6 +36,7 @@ namespace ns3 {
 class QueueDisc;
 template <typename Item> class Queue;
 class NetDeviceQueueInterface;
+class SharedBuffer;
 
 /**
  * \ingroup traffic-control
@@ -204,34 +205,34 @@ public:
     uint32_t nTotalDroppedPackets;
     /// Total packets dropped before enqueue
     uint32_t nTotalDroppedPacketsBeforeEnqueue;
-    /// Packets dropped before enqueue, for each reason
-    std::map<std::string, uint32_t> nDroppedPacketsBeforeEnqueue;
+    /// Packets dropped before enqueue, indexed by reason identifier
+    std::vector<uint32_t> nDroppedPacketsBeforeEnqueue;
     /// Total packets dropped after dequeue
     uint32_t nTotalDroppedPacketsAfterDequeue;
-    /// Packets dropped after dequeue, for each reason
-    std::map<std::string, uint32_t> nDroppedPacketsAfterDequeue;
+    /// Packets dropped after dequeue, indexed by reason identifier
+    std::vector<uint32_t> nDroppedPacketsAfterDequeue;
     /// Total dropped bytes
     uint64_t nTotalDroppedBytes;
     /// Total bytes dropped before enqueue
     uint64_t nTotalDroppedBytesBeforeEnqueue;
-    /// Bytes dropped before enqueue, for each reason
-    std::map<std::string, uint64_t> nDroppedBytesBeforeEnqueue;
+    /// Bytes dropped before enqueue, indexed by reason identifier
+    std::vector<uint64_t> nDroppedBytesBeforeEnqueue;
     /// Total bytes dropped after dequeue
     uint64_t nTotalDroppedBytesAfterDequeue;
-    /// Bytes dropped after dequeue, for each reason
-    std::map<std::string, uint64_t> nDroppedBytesAfterDequeue;
+    /// Bytes dropped after dequeue, indexed by reason identifier
+    std::vector<uint64_t> nDroppedBytesAfterDequeue;
     /// Total requeued packets
     uint32_t nTotalRequeuedPackets;
     /// Total requeued bytes
     uint64_t nTotalRequeuedBytes;
     /// Total marked packets
     uint32_t nTotalMarkedPackets;
-    /// Marked packets, for each reason
-    std::map<std::string, uint32_t> nMarkedPackets;
+    /// Marked packets, indexed by reason identifier
+    std::vector<uint32_t> nMarkedPackets;
     /// Total marked bytes
     uint32_t nTotalMarkedBytes;
-    /// Marked bytes, for each reason
-    std::map<std::string, uint64_t> nMarkedBytes;
+    /// Marked bytes, indexed by reason identifier
+    std::vector<uint64_t> nMarkedBytes;
 
     /// constructor
     Stats ();
@@ -273,6 +274,25 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief Get the identifier of a reason to drop or mark packets
+   *
+   * Reasons are interned when a queue disc registers them, i.e., the first
+   * time it drops or marks a packet for a reason, and the per reason counters
+   * of the Stats are arrays indexed by the identifier of the reason.
+   * Identifiers are shared by all the queue discs of a simulation.
+   * \param reason the reason
+   * \return the identifier of the reason
+   */
+  static uint32_t GetReasonId (const char* reason);
+
+  /**
+   * \brief Get the reason having the given identifier
+   * \param id the identifier of the reason
+   * \return the reason
+   */
+  static const char* GetReason (uint32_t id);
+
   /**
    * \brief Constructor
    * \param policy the policy to handle the queue disc size
@@ -331,6 +351,24 @@ public:
    */
   QueueSize GetCurrentSize (void);
 
+  /**
+   * \brief Make this queue disc draw from a buffer shared with other queue discs
+   *
+   * Packets are then admitted only if the shared buffer admits them, in
+   * addition to the checks of the queue disc (hence, the maximum size of the
+   * queue disc should be set large enough not to interfere). Only root queue
+   * discs should be attached to a shared buffer.
+   *
+   * \param buffer the shared buffer
+   */
+  void SetSharedBuffer (Ptr<SharedBuffer> buffer);
+
+  /**
+   * \brief Get the shared buffer this queue disc draws from, if any
+   * \return the shared buffer, or a null pointer
+   */
+  Ptr<SharedBuffer> GetSharedBuffer (void) const;
+
   /**
    * \brief Retrieve all the collected statistics.
    * \return the collected statistics.
@@ -372,6 +410,22 @@ public:
    */
   SendCallback GetSendCallback (void) const;
 
+  /// Callback invoked to send a batch of packets to the receiving object when Run is called
+  typedef std::function<void (const std::vector<Ptr<QueueDiscItem> > &)> SendBatchCallback;
+
+  /// Callback invoked to get the number of packets the receiving object can accept in a batch
+  typedef std::function<uint32_t (void)> BatchCapacityCallback;
+
+  /**
+   * \param send the callback to send a batch of packets to the receiving object.
+   * \param capacity the callback returning the number of packets the receiving
+   *        object can accept in a batch.
+   *
+   * Set the callbacks used by the Run method to send batches of packets to the
+   * receiving object when the MaxBatchPackets attribute is greater than one.
+   */
+  void SetSendBatchCallback (SendBatchCallback send, BatchCapacityCallback capacity);
+
   /**
    * \brief Set the maximum number of dequeue operations following a packet enqueue
    * \param quota the maximum number of dequeue operations following a packet enqueue.
@@ -402,6 +456,18 @@ public:
    */
   Ptr<QueueDiscItem> Dequeue (void);
 
+  /**
+   * Dequeue up to the given number of packets by calling Dequeue repeatedly.
+   * Packets are dequeued as long as the total size of the packets dequeued so
+   * far is less than the given number of bytes, hence the last packet may
+   * exceed such a limit (as done by Linux bulk dequeues).
+   *
+   * \param maxPackets the maximum number of packets to dequeue
+   * \param maxBytes the maximum number of bytes to dequeue
+   * \return the dequeued items, in dequeue order
+   */
+  std::vector<Ptr<QueueDiscItem> > DequeueBatch (uint32_t maxPackets, uint32_t maxBytes);
+
   /**
    * Get a copy of the next packet the queue discipline will extract. This
    * function only calls the (private) DoPeek function. This base class provides
@@ -516,6 +582,8 @@ public:
   static constexpr const char* INTERNAL_QUEUE_DROP = "Dropped by internal queue";    //!< Packet dropped by an internal queue
   static constexpr const char* CHILD_QUEUE_DISC_DROP = "(Dropped by child queue disc) "; //!< Packet dropped by a child queue disc
   static constexpr const char* CHILD_QUEUE_DISC_MARK = "(Marked by child queue disc) "; //!< Packet marked by a child queue disc
+  static constexpr const char* SHARED_BUFFER_DROP = "Shared buffer threshold exceeded"; //!< Packet not admitted by the shared buffer
+  static constexpr const char* SHARED_BUFFER_MARK = "Shared buffer occupancy above threshold"; //!< Packet marked by the shared buffer
 
 protected:
   /**
@@ -540,7 +608,9 @@ protected:
    *  \param item item that was dropped
    *  \param reason the reason why the item was dropped
    *  This method must be called by subclasses to record that a packet was
-   *  dropped before enqueue for the specified reason
+   *  dropped before enqueue for the specified reason. The reason is
+   *  recognized by the address of its string, which must hence remain valid
+   *  and unchanged (e.g., a string constant of the queue disc)
    */
   void DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason);
 
@@ -550,7 +620,8 @@ protected:
    *  \param item item that was dropped
    *  \param reason the reason why the item was dropped
    *  This method must be called by subclasses to record that a packet was
-   *  dropped after dequeue for the specified reason
+   *  dropped after dequeue for the specified reason. As for DropBeforeEnqueue,
+   *  the reason must remain valid and unchanged
    */
   void DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason);
 
@@ -563,6 +634,27 @@ protected:
    */
   bool Mark (Ptr<QueueDiscItem> item, const char* reason);
 
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet enqueue
+   *  \param item item that was enqueued
+   *  This method is called through the traces of the internal queues and of
+   *  the child queue discs. Subclasses storing packets in their own data
+   *  structures must call it for each packet they store.
+   */
+  void PacketEnqueued (Ptr<const QueueDiscItem> item);
+
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet dequeue
+   *  \param item item that was dequeued
+   *  This method is called through the traces of the internal queues and of
+   *  the child queue discs. Subclasses storing packets in their own data
+   *  structures must call it for each packet they extract, including the
+   *  packets they extract in order to drop them.
+   */
+  void PacketDequeued (Ptr<const QueueDiscItem> item);
+
 private:
   /**
    * \brief Copy constructor
@@ -572,6 +664,46 @@ private:
    */
   QueueDisc (const QueueDisc &o);
 
+  /// Reasons registered by a queue disc: address of the reason and identifier
+  typedef std::vector<std::pair<const char*, uint32_t> > ReasonTable;
+
+  /**
+   * \brief Get the identifier under which this queue disc counts a reason
+   *
+   * The reason is looked up by the address of its string. If it is not in
+   * the table yet, it is registered: the prefix followed by the reason is
+   * interned, the per reason counters are extended to its identifier and the
+   * reason is added to the table. Hence, only registration allocates memory.
+   * \param table the reasons registered so far
+   * \param reason the reason
+   * \param prefix the prefix of the reason counted (CHILD_QUEUE_DISC_DROP or
+   *        CHILD_QUEUE_DISC_MARK for the reasons of a child queue disc)
+   * \return the identifier of the reason
+   */
+  uint32_t LookupReason (ReasonTable &table, const char* reason, const char* prefix = "");
+
+  /**
+   * \brief Record a packet dropped before enqueue
+   * \param item item that was dropped
+   * \param id the identifier of the reason, as returned by LookupReason
+   */
+  void DropBeforeEnqueue (Ptr<const QueueDiscItem> item, uint32_t id);
+
+  /**
+   * \brief Record a packet dropped after dequeue
+   * \param item item that was dropped
+   * \param id the identifier of the reason, as returned by LookupReason
+   */
+  void DropAfterDequeue (Ptr<const QueueDiscItem> item, uint32_t id);
+
+  /**
+   * \brief Mark a packet and, if successful, record it
+   * \param item item that has to be marked
+   * \param id the identifier of the reason, as returned by LookupReason
+   * \return true if the item was successfully marked, false otherwise
+   */
+  bool Mark (Ptr<QueueDiscItem> item, uint32_t id);
+
   /**
    * \brief Assignment operator
    * \param o object to copy
@@ -651,9 +783,14 @@ private:
   /**
    * Modelled after the Linux function qdisc_restart (net/sched/sch_generic.c)
    * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling Transmit).
-   * \return true if a packet is successfully sent to the device.
+   * If batches are enabled and supported by the device, further packets are
+   * dequeued (as done by Linux bulk dequeues) and sent to the device along with
+   * the first one (by calling TransmitBatch).
+   * \param quota the maximum number of packets that can be sent
+   * \param nPackets set to the number of packets sent to the device
+   * \return true if the packets are successfully sent to the device.
    */
-  bool Restart (void);
+  bool Restart (uint32_t quota, uint32_t &nPackets);
 
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
@@ -678,18 +815,13 @@ private:
   bool Transmit (Ptr<QueueDiscItem> item);
 
   /**
-   *  \brief Perform the actions required when the queue disc is notified of
-   *         a packet enqueue
-   *  \param item item that was enqueued
-   */
-  void PacketEnqueued (Ptr<const QueueDiscItem> item);
-
-  /**
-   *  \brief Perform the actions required when the queue disc is notified of
-   *         a packet dequeue
-   *  \param item item that was dequeued
+   * Send a batch of packets to the device with a single call. Batches are only
+   * used with single queue devices, whose queue is not stopped when the batch
+   * is dequeued (see DequeuePacket).
+   * \param items the packets to transmit
+   * \return true if the device queue is not stopped and the queue disc is not empty
    */
-  void PacketDequeued (Ptr<const QueueDiscItem> item);
+  bool TransmitBatch (const std::vector<Ptr<QueueDiscItem> > &items);
 
   static const uint32_t DEFAULT_QUOTA = 64; //!< Default quota (as in /proc/sys/net/core/dev_weight)
 
@@ -706,13 +838,20 @@ private:
   uint32_t m_quota;                 //!< Maximum number of packets dequeued in a qdisc run
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   SendCallback m_send;              //!< Callback used to send a packet to the receiving object
+  SendBatchCallback m_sendBatch;    //!< Callback used to send a batch of packets to the receiving object
+  BatchCapacityCallback m_batchCapacity; //!< Callback returning the room for a batch in the receiving object
+  uint32_t m_maxBatchPackets;       //!< Maximum number of packets sent to the device in a batch
+  uint32_t m_maxBatchBytes;         //!< Maximum number of bytes sent to the device in a batch
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
   Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
   bool m_peeked;                    //!< A packet was dequeued because Peek was called
-  std::string m_childQueueDiscDropMsg;  //!< Reason why a packet was dropped by a child queue disc
-  std::string m_childQueueDiscMarkMsg;  //!< Reason why a packet was marked by a child queue disc
   QueueDiscSizePolicy m_sizePolicy;     //!< The queue disc size policy
   bool m_prohibitChangeMode;            //!< True if changing mode is prohibited
+  Ptr<SharedBuffer> m_sharedBuffer;     //!< The shared buffer, if any
+  uint32_t m_sharedBufferPort;          //!< Index of this queue disc in the shared buffer
+  ReasonTable m_reasons;                //!< Reasons of the drops and marks of this queue disc
+  ReasonTable m_childDropReasons;       //!< Reasons of the drops of the child queue discs
+  ReasonTable m_childMarkReasons;       //!< Reasons of the marks of the child queue discs
 
   /// Traced callback: fired when a packet is enqueued
   TracedCallback<Ptr<const QueueDiscItem> > m_traceEnqueue;
@@ -218,6 +218,21 @@ TypeId RedQueueDisc::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&RedQueueDisc::m_useHardDrop),
                    MakeBooleanChecker ())
+    .AddAttribute ("MarkingMode",
+                   "Whether packets are marked on enqueue based on the average queue size "
+                   "(RED), or on dequeue based on the instantaneous queue size (compared to "
+                   "MinTh) or on the sojourn time (compared to SojournThreshold). "
+                   "Dequeue marking requires UseEcn and disables early drops",
+                   EnumValue (ENQUEUE_MARKING),
+                   MakeEnumAccessor (&RedQueueDisc::m_markingMode),
+                   MakeEnumChecker (ENQUEUE_MARKING, "Enqueue",
+                                    DEQUEUE_LENGTH_MARKING, "DequeueLength",
+                                    DEQUEUE_SOJOURN_MARKING, "DequeueSojourn"))
+    .AddAttribute ("SojournThreshold",
+                   "The sojourn time above which packets are marked in DequeueSojourn mode",
+                   TimeValue (MicroSeconds (200)),
+                   MakeTimeAccessor (&RedQueueDisc::m_sojournThreshold),
+                   MakeTimeChecker ())
   ;
 
   return tid;
@@ -373,7 +388,8 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   m_countBytes += item->GetSize ();
 
   uint32_t dropType = DTYPE_NONE;
-  if (m_qAvg >= m_minTh && nQueued > 1)
+  // with dequeue marking, packets are only dropped when the queue is full
+  if (m_markingMode == ENQUEUE_MARKING && m_qAvg >= m_minTh && nQueued > 1)
     {
       if ((!m_isGentle && m_qAvg >= m_maxTh) ||
           (m_isGentle && m_qAvg >= 2 * m_maxTh))
@@ -830,6 +846,21 @@ RedQueueDisc::DoDequeue (void)
       NS_LOG_LOGIC ("Number packets " << GetInternalQueue (0)->GetNPackets ());
       NS_LOG_LOGIC ("Number bytes " << GetInternalQueue (0)->GetNBytes ());
 
+      // the queue size left behind, or the time spent in the queue, tell
+      // the congestion faced by the packet when it leaves the queue
+      if (m_markingMode == DEQUEUE_LENGTH_MARKING
+          && GetInternalQueue (0)->GetCurrentSize ().GetValue () >= m_minTh)
+        {
+          NS_LOG_DEBUG ("\t Marking due to the queue size on dequeue");
+          Mark (item, DEQUEUE_LENGTH_MARK);
+        }
+      else if (m_markingMode == DEQUEUE_SOJOURN_MARKING
+               && Simulator::Now () - item->GetTimeStamp () > m_sojournThreshold)
+        {
+          NS_LOG_DEBUG ("\t Marking due to the sojourn time on dequeue");
+          Mark (item, DEQUEUE_SOJOURN_MARK);
+        }
+
       return item;
     }
 }
@@ -886,6 +917,12 @@ RedQueueDisc::CheckConfig (void)
       NS_LOG_ERROR ("m_isAdaptMaxP and m_isFengAdaptive cannot be simultaneously true");
     }
 
+  if (m_markingMode != ENQUEUE_MARKING && !m_useEcn)
+    {
+      NS_LOG_ERROR ("Dequeue marking requires UseEcn");
+      return false;
+    }
+
   return true;
 }
 
@@ -118,6 +118,16 @@ public:
     DTYPE_UNFORCED,    //!< An "unforced" (random) drop
   };
 
+  /**
+   * \brief Where and how packets are marked when ECN is used
+   */
+  enum MarkingMode
+  {
+    ENQUEUE_MARKING,         //!< RED marking on enqueue, based on m_qAvg
+    DEQUEUE_LENGTH_MARKING,  //!< Marking on dequeue when the instantaneous queue size is at least m_minTh
+    DEQUEUE_SOJOURN_MARKING, //!< Marking on dequeue when the sojourn time exceeds m_sojournThreshold
+  };
+
    /**
     * \brief Set the alpha value to adapt m_curMaxP.
     *
@@ -198,6 +208,8 @@ public:
   // Reasons for marking packets
   static constexpr const char* UNFORCED_MARK = "Unforced mark";  //!< Early probability marks
   static constexpr const char* FORCED_MARK = "Forced mark";      //!< Forced marks, m_qAvg > m_maxTh
+  static constexpr const char* DEQUEUE_LENGTH_MARK = "Dequeue length mark";    //!< Dequeue marks, queue size >= m_minTh
+  static constexpr const char* DEQUEUE_SOJOURN_MARK = "Dequeue sojourn mark";  //!< Dequeue marks, sojourn time > m_sojournThreshold
 
 protected:
   /**
@@ -286,6 +298,8 @@ private:
   Time m_linkDelay;         //!< Link delay
   bool m_useEcn;            //!< True if ECN is used (packets are marked instead of being dropped)
   bool m_useHardDrop;       //!< True if packets are always dropped above max threshold
+  MarkingMode m_markingMode; //!< Where and how packets are marked
+  Time m_sojournThreshold;  //!< Sojourn time above which packets are marked on dequeue
 
   // ** Variables maintained by RED
   double m_vA;              //!< 1.0 / (m_maxTh - m_minTh)
@@ -0,0 +1,440 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/socket.h"
+#include "ns3/queue-item.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/pfc-header.h"
+#include "shared-buffer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SharedBuffer");
+
+NS_OBJECT_ENSURE_REGISTERED (IngressDeviceTag);
+
+TypeId
+IngressDeviceTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::IngressDeviceTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<IngressDeviceTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+IngressDeviceTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+IngressDeviceTag::IngressDeviceTag ()
+  : m_ifIndex (0)
+{
+}
+
+IngressDeviceTag::IngressDeviceTag (uint32_t ifIndex)
+  : m_ifIndex (ifIndex)
+{
+}
+
+uint32_t
+IngressDeviceTag::GetIfIndex (void) const
+{
+  return m_ifIndex;
+}
+
+uint32_t
+IngressDeviceTag::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+IngressDeviceTag::Serialize (TagBuffer i) const
+{
+  i.WriteU32 (m_ifIndex);
+}
+
+void
+IngressDeviceTag::Deserialize (TagBuffer i)
+{
+  m_ifIndex = i.ReadU32 ();
+}
+
+void
+IngressDeviceTag::Print (std::ostream &os) const
+{
+  os << "IngressDevice=" << m_ifIndex;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (SharedBuffer);
+
+constexpr uint8_t SharedBuffer::N_PRIORITIES;
+
+TypeId SharedBuffer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SharedBuffer")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<SharedBuffer> ()
+    .AddAttribute ("Size",
+                   "The size of the buffer pool (in bytes)",
+                   QueueSizeValue (QueueSize ("128KB")),
+                   MakeQueueSizeAccessor (&SharedBuffer::SetSize,
+                                          &SharedBuffer::GetSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("Alpha",
+                   "The Dynamic Threshold alpha parameter of all the priorities",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&SharedBuffer::SetDefaultAlpha,
+                                       &SharedBuffer::GetDefaultAlpha),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("PortMarkThreshold",
+                   "Mark the packets admitted to a port storing at least this many bytes (0B to disable)",
+                   QueueSizeValue (QueueSize ("0B")),
+                   MakeQueueSizeAccessor (&SharedBuffer::m_portMarkThreshold),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("SharedMarkThreshold",
+                   "Mark the packets admitted when the pool stores at least this many bytes (0B to disable)",
+                   QueueSizeValue (QueueSize ("0B")),
+                   MakeQueueSizeAccessor (&SharedBuffer::m_sharedMarkThreshold),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("PfcXoffThreshold",
+                   "Pause a priority on an ingress device storing at least this many bytes of it (0B to disable PFC)",
+                   QueueSizeValue (QueueSize ("0B")),
+                   MakeQueueSizeAccessor (&SharedBuffer::m_xoff),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("PfcXonThreshold",
+                   "Resume a paused priority on an ingress device storing at most this many bytes of it",
+                   QueueSizeValue (QueueSize ("0B")),
+                   MakeQueueSizeAccessor (&SharedBuffer::m_xon),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("PfcPauseQuanta",
+                   "The pause time carried by PFC pause frames, in pause quanta (512 bit times)",
+                   UintegerValue (0xffff),
+                   MakeUintegerAccessor (&SharedBuffer::m_pauseQuanta),
+                   MakeUintegerChecker<uint16_t> (1))
+    .AddAttribute ("PfcRefreshInterval",
+                   "The interval between the PFC pause frames sent while a priority stays paused",
+                   TimeValue (MicroSeconds (100)),
+                   MakeTimeAccessor (&SharedBuffer::m_refreshInterval),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Occupancy",
+                     "Number of bytes currently stored in the buffer pool",
+                     MakeTraceSourceAccessor (&SharedBuffer::m_occupancy),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("PortOccupancy",
+                     "Number of bytes of a priority currently stored by a port",
+                     MakeTraceSourceAccessor (&SharedBuffer::m_portOccupancy),
+                     "ns3::SharedBuffer::PortOccupancyTracedCallback")
+    .AddTraceSource ("Pfc",
+                     "A PFC frame pausing or resuming a priority is sent through an ingress device",
+                     MakeTraceSourceAccessor (&SharedBuffer::m_pfcTrace),
+                     "ns3::SharedBuffer::PfcTracedCallback")
+  ;
+  return tid;
+}
+
+SharedBuffer::SharedBuffer ()
+  : m_size (0),
+    m_defaultAlpha (1.0),
+    m_occupancy (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_alpha.fill (1.0);
+}
+
+SharedBuffer::~SharedBuffer ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SharedBuffer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (auto &ingress : m_ingress)
+    {
+      for (auto &event : ingress.refresh)
+        {
+          event.Cancel ();
+        }
+    }
+  m_ingress.clear ();
+  Object::DoDispose ();
+}
+
+uint32_t
+SharedBuffer::AddPort (void)
+{
+  NS_LOG_FUNCTION (this);
+  Port port;
+  port.bytes = 0;
+  port.priorityBytes.fill (0);
+  m_ports.push_back (port);
+  return m_ports.size () - 1;
+}
+
+uint32_t
+SharedBuffer::GetNPorts (void) const
+{
+  return m_ports.size ();
+}
+
+uint8_t
+SharedBuffer::GetPriority (Ptr<const QueueDiscItem> item)
+{
+  SocketPriorityTag priorityTag;
+  if (item->GetPacket ()->PeekPacketTag (priorityTag))
+    {
+      return std::min<uint8_t> (priorityTag.GetPriority (), N_PRIORITIES - 1);
+    }
+  return 0;
+}
+
+bool
+SharedBuffer::Admit (uint32_t port, uint8_t priority, uint32_t size) const
+{
+  NS_LOG_FUNCTION (this << port << +priority << size);
+  NS_ASSERT (port < m_ports.size () && priority < N_PRIORITIES);
+
+  if (m_occupancy + size > m_size)
+    {
+      NS_LOG_LOGIC ("The buffer pool is full");
+      return false;
+    }
+  if (m_ports[port].priorityBytes[priority] >= GetThreshold (priority))
+    {
+      NS_LOG_LOGIC ("Port " << port << " priority " << +priority << " stores "
+                    << m_ports[port].priorityBytes[priority] << " bytes, threshold "
+                    << GetThreshold (priority));
+      return false;
+    }
+  return true;
+}
+
+bool
+SharedBuffer::ShouldMark (uint32_t port) const
+{
+  NS_ASSERT (port < m_ports.size ());
+  return (m_portMarkThreshold.GetValue () > 0
+          && m_ports[port].bytes >= m_portMarkThreshold.GetValue ())
+         || (m_sharedMarkThreshold.GetValue () > 0
+             && m_occupancy >= m_sharedMarkThreshold.GetValue ());
+}
+
+void
+SharedBuffer::Allocate (uint32_t port, uint8_t priority, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << port << +priority << size);
+  NS_ASSERT (port < m_ports.size () && priority < N_PRIORITIES);
+
+  Port &p = m_ports[port];
+  p.bytes += size;
+  p.priorityBytes[priority] += size;
+  m_occupancy += size;
+  m_portOccupancy (port, priority, p.priorityBytes[priority]);
+}
+
+void
+SharedBuffer::Release (uint32_t port, uint8_t priority, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << port << +priority << size);
+  NS_ASSERT (port < m_ports.size () && priority < N_PRIORITIES);
+
+  Port &p = m_ports[port];
+  NS_ASSERT_MSG (p.priorityBytes[priority] >= size && m_occupancy >= size,
+                 "Releasing more bytes than allocated");
+  p.bytes -= size;
+  p.priorityBytes[priority] -= size;
+  m_occupancy -= size;
+  m_portOccupancy (port, priority, p.priorityBytes[priority]);
+}
+
+QueueSize
+SharedBuffer::GetSize (void) const
+{
+  return QueueSize (QueueSizeUnit::BYTES, m_size);
+}
+
+void
+SharedBuffer::SetSize (QueueSize size)
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ABORT_MSG_IF (size.GetUnit () != QueueSizeUnit::BYTES,
+                   "The size of a shared buffer must be expressed in bytes");
+  m_size = size.GetValue ();
+}
+
+uint32_t
+SharedBuffer::GetOccupancy (void) const
+{
+  return m_occupancy;
+}
+
+uint32_t
+SharedBuffer::GetPortOccupancy (uint32_t port) const
+{
+  NS_ASSERT (port < m_ports.size ());
+  return m_ports[port].bytes;
+}
+
+uint32_t
+SharedBuffer::GetPortOccupancy (uint32_t port, uint8_t priority) const
+{
+  NS_ASSERT (port < m_ports.size () && priority < N_PRIORITIES);
+  return m_ports[port].priorityBytes[priority];
+}
+
+void
+SharedBuffer::SetAlpha (uint8_t priority, double alpha)
+{
+  NS_LOG_FUNCTION (this << +priority << alpha);
+  NS_ASSERT (priority < N_PRIORITIES && alpha >= 0);
+  m_alpha[priority] = alpha;
+}
+
+double
+SharedBuffer::GetAlpha (uint8_t priority) const
+{
+  NS_ASSERT (priority < N_PRIORITIES);
+  return m_alpha[priority];
+}
+
+void
+SharedBuffer::SetDefaultAlpha (double alpha)
+{
+  NS_LOG_FUNCTION (this << alpha);
+  m_defaultAlpha = alpha;
+  m_alpha.fill (alpha);
+}
+
+double
+SharedBuffer::GetDefaultAlpha (void) const
+{
+  return m_defaultAlpha;
+}
+
+uint32_t
+SharedBuffer::GetThreshold (uint8_t priority) const
+{
+  NS_ASSERT (priority < N_PRIORITIES);
+  // The pool may have been shrunk below its occupancy
+  uint32_t occupancy = m_occupancy;
+  uint32_t free = (occupancy < m_size ? m_size - occupancy : 0);
+  return static_cast<uint32_t> (m_alpha[priority] * free);
+}
+
+bool
+SharedBuffer::IsPfcEnabled (void) const
+{
+  return m_xoff.GetValue () > 0;
+}
+
+void
+SharedBuffer::AllocateIngress (uint32_t ifIndex, uint8_t priority, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << ifIndex << +priority << size);
+  NS_ASSERT (priority < N_PRIORITIES);
+
+  if (ifIndex >= m_ingress.size ())
+    {
+      Ingress ingress;
+      ingress.bytes.fill (0);
+      ingress.paused.fill (false);
+      m_ingress.resize (ifIndex + 1, ingress);
+    }
+
+  Ingress &in = m_ingress[ifIndex];
+  in.bytes[priority] += size;
+  if (!in.paused[priority] && in.bytes[priority] >= m_xoff.GetValue ())
+    {
+      NS_LOG_LOGIC ("Device " << ifIndex << " priority " << +priority << " reached XOFF");
+      in.paused[priority] = true;
+      SendPfc (ifIndex, priority, true);
+    }
+}
+
+void
+SharedBuffer::ReleaseIngress (uint32_t ifIndex, uint8_t priority, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << ifIndex << +priority << size);
+  NS_ASSERT (ifIndex < m_ingress.size () && priority < N_PRIORITIES);
+
+  Ingress &in = m_ingress[ifIndex];
+  NS_ASSERT_MSG (in.bytes[priority] >= size, "Releasing more bytes than allocated");
+  in.bytes[priority] -= size;
+  if (in.paused[priority] && in.bytes[priority] <= m_xon.GetValue ())
+    {
+      NS_LOG_LOGIC ("Device " << ifIndex << " priority " << +priority << " fell to XON");
+      in.paused[priority] = false;
+      in.refresh[priority].Cancel ();
+      SendPfc (ifIndex, priority, false);
+    }
+}
+
+uint32_t
+SharedBuffer::GetIngressOccupancy (uint32_t ifIndex, uint8_t priority) const
+{
+  NS_ASSERT (priority < N_PRIORITIES);
+  return ifIndex < m_ingress.size () ? m_ingress[ifIndex].bytes[priority] : 0;
+}
+
+bool
+SharedBuffer::IsPaused (uint32_t ifIndex, uint8_t priority) const
+{
+  NS_ASSERT (priority < N_PRIORITIES);
+  return ifIndex < m_ingress.size () && m_ingress[ifIndex].paused[priority];
+}
+
+void
+SharedBuffer::SendPfc (uint32_t ifIndex, uint8_t priority, bool pause)
+{
+  NS_LOG_FUNCTION (this << ifIndex << +priority << pause);
+
+  m_pfcTrace (ifIndex, priority, pause);
+  if (pause && !m_refreshInterval.IsZero ())
+    {
+      m_ingress[ifIndex].refresh[priority] = Simulator::Schedule (m_refreshInterval,
+                                                                  &SharedBuffer::SendPfc, this,
+                                                                  ifIndex, priority, true);
+    }
+
+  Ptr<Node> node = GetObject<Node> ();
+  if (node == 0 || ifIndex >= node->GetNDevices ())
+    {
+      NS_LOG_WARN ("No device " << ifIndex << " to send the PFC frame through");
+      return;
+    }
+
+  Ptr<NetDevice> device = node->GetDevice (ifIndex);
+  PfcHeader pfc;
+  pfc.SetPauseQuanta (priority, pause ? m_pauseQuanta : 0);
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (pfc);
+  device->Send (p, device->GetBroadcast (), PfcHeader::PROT_NUMBER);
+}
+
+} // namespace ns3
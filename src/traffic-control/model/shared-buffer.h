@@ -0,0 +1,353 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SHARED_BUFFER_H
+#define SHARED_BUFFER_H
+
+#include "ns3/object.h"
+#include "ns3/traced-value.h"
+#include "ns3/traced-callback.h"
+#include "ns3/queue-size.h"
+#include "ns3/tag.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include <vector>
+#include <array>
+
+namespace ns3 {
+
+class QueueDiscItem;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Tag recording the device a packet was received from
+ *
+ * The traffic control layer of a node with a SharedBuffer doing Priority-based
+ * Flow Control tags the received packets, so that the buffer can account for
+ * them per ingress device.
+ */
+class IngressDeviceTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  IngressDeviceTag ();
+  /**
+   * \brief Constructor
+   * \param ifIndex the index of the ingress device
+   */
+  IngressDeviceTag (uint32_t ifIndex);
+
+  /**
+   * \brief Get the index of the ingress device
+   * \return the index of the ingress device
+   */
+  uint32_t GetIfIndex (void) const;
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint32_t m_ifIndex;   //!< Index of the ingress device
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A packet buffer shared by the ports of a switch
+ *
+ * The root queue discs installed on the devices of a node can draw from a
+ * single buffer pool instead of having a private buffer each. Admission
+ * follows the Dynamic Threshold (DT) scheme of Choudhury and Hahne: a packet
+ * of priority p is admitted to a port if the bytes that the port already
+ * stores for priority p are below
+ *
+ *   T(p) = alpha(p) * (Size - Occupancy)
+ *
+ * where Occupancy is the number of bytes stored in the whole pool, and if the
+ * packet fits in the free space of the pool. A port that is alone in the
+ * switch can hence take alpha / (1 + alpha) of the pool, while N congested
+ * ports get alpha / (1 + N * alpha) each. The priority of a packet is given
+ * by its SocketPriorityTag (values larger than 7 are treated as 7).
+ *
+ * Admitted packets can also be marked (if ECN capable) when the port stores
+ * at least PortMarkThreshold bytes, or when the pool stores at least
+ * SharedMarkThreshold bytes.
+ *
+ * If PfcXoffThreshold is not null, the buffer also accounts for the stored
+ * packets per ingress device and priority, and performs Priority-based Flow
+ * Control (IEEE 802.1Qbb): when the bytes of a priority received from a
+ * device reach PfcXoffThreshold, a PFC frame pausing that priority for
+ * PfcPauseQuanta is sent through the device, and refreshed every
+ * PfcRefreshInterval; when they fall to PfcXonThreshold, a PFC frame resuming
+ * the priority is sent. The buffer has to be aggregated to the node (see
+ * TrafficControlHelper::InstallSharedBuffer) and the devices of the upstream
+ * nodes have to obey PFC frames (e.g., the PfcEnabled attribute of
+ * PointToPointNetDevice). The DT threshold and the pool size still apply, so
+ * for a lossless fabric they should leave room for the packets in flight
+ * when a pause is sent (the headroom).
+ */
+class SharedBuffer : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  SharedBuffer ();
+  virtual ~SharedBuffer ();
+
+  static constexpr uint8_t N_PRIORITIES = 8; //!< Number of priorities
+
+  /**
+   * \brief Add a port to the buffer
+   * \return the index of the port
+   */
+  uint32_t AddPort (void);
+
+  /**
+   * \brief Get the number of ports
+   * \return the number of ports
+   */
+  uint32_t GetNPorts (void) const;
+
+  /**
+   * \brief Get the priority of a packet
+   * \param item the packet
+   * \return the priority, between 0 and N_PRIORITIES - 1
+   */
+  static uint8_t GetPriority (Ptr<const QueueDiscItem> item);
+
+  /**
+   * \brief Check whether a packet can be stored
+   * \param port the port
+   * \param priority the priority of the packet
+   * \param size the size of the packet
+   * \return true if the DT threshold of the port and priority is not
+   *         exceeded and the packet fits in the pool
+   */
+  bool Admit (uint32_t port, uint8_t priority, uint32_t size) const;
+
+  /**
+   * \brief Check whether a packet admitted to a port should be marked
+   * \param port the port
+   * \return true if either the port or the pool occupancy is above its
+   *         marking threshold
+   */
+  bool ShouldMark (uint32_t port) const;
+
+  /**
+   * \brief Account for a packet stored by a port
+   * \param port the port
+   * \param priority the priority of the packet
+   * \param size the size of the packet
+   */
+  void Allocate (uint32_t port, uint8_t priority, uint32_t size);
+
+  /**
+   * \brief Account for a packet leaving a port
+   * \param port the port
+   * \param priority the priority of the packet
+   * \param size the size of the packet
+   */
+  void Release (uint32_t port, uint8_t priority, uint32_t size);
+
+  /**
+   * \brief Get the size of the pool
+   * \return the size of the pool, in bytes
+   */
+  QueueSize GetSize (void) const;
+
+  /**
+   * \brief Set the size of the pool
+   *
+   * The pool can be shrunk below its occupancy, in which case no packet is
+   * admitted until enough bytes have been released.
+   *
+   * \param size the size of the pool, in bytes
+   */
+  void SetSize (QueueSize size);
+
+  /**
+   * \brief Get the number of bytes stored in the pool
+   * \return the number of bytes stored in the pool
+   */
+  uint32_t GetOccupancy (void) const;
+
+  /**
+   * \brief Get the number of bytes stored by a port
+   * \param port the port
+   * \return the number of bytes stored by the port
+   */
+  uint32_t GetPortOccupancy (uint32_t port) const;
+
+  /**
+   * \brief Get the number of bytes of a priority stored by a port
+   * \param port the port
+   * \param priority the priority
+   * \return the number of bytes of the given priority stored by the port
+   */
+  uint32_t GetPortOccupancy (uint32_t port, uint8_t priority) const;
+
+  /**
+   * \brief Set the alpha parameter of a priority
+   * \param priority the priority
+   * \param alpha the alpha parameter
+   */
+  void SetAlpha (uint8_t priority, double alpha);
+
+  /**
+   * \brief Get the alpha parameter of a priority
+   * \param priority the priority
+   * \return the alpha parameter
+   */
+  double GetAlpha (uint8_t priority) const;
+
+  /**
+   * \brief Get the current DT threshold of a priority
+   * \param priority the priority
+   * \return the maximum number of bytes of the priority a port can store
+   */
+  uint32_t GetThreshold (uint8_t priority) const;
+
+  /**
+   * \brief Check whether Priority-based Flow Control is enabled
+   * \return true if PfcXoffThreshold is not null
+   */
+  bool IsPfcEnabled (void) const;
+
+  /**
+   * \brief Account for a packet received from a device and stored by a port
+   * \param ifIndex the index of the ingress device
+   * \param priority the priority of the packet
+   * \param size the size of the packet
+   */
+  void AllocateIngress (uint32_t ifIndex, uint8_t priority, uint32_t size);
+
+  /**
+   * \brief Account for a packet received from a device leaving a port
+   * \param ifIndex the index of the ingress device
+   * \param priority the priority of the packet
+   * \param size the size of the packet
+   */
+  void ReleaseIngress (uint32_t ifIndex, uint8_t priority, uint32_t size);
+
+  /**
+   * \brief Get the number of bytes of a priority received from a device
+   * \param ifIndex the index of the ingress device
+   * \param priority the priority
+   * \return the number of bytes stored
+   */
+  uint32_t GetIngressOccupancy (uint32_t ifIndex, uint8_t priority) const;
+
+  /**
+   * \brief Check whether a priority is paused on an ingress device
+   * \param ifIndex the index of the ingress device
+   * \param priority the priority
+   * \return true if the last PFC frame sent for the priority paused it
+   */
+  bool IsPaused (uint32_t ifIndex, uint8_t priority) const;
+
+  /**
+   * TracedCallback signature for port occupancy changes.
+   *
+   * \param [in] port the port
+   * \param [in] priority the priority
+   * \param [in] bytes the bytes of the priority stored by the port
+   */
+  typedef void (* PortOccupancyTracedCallback)(uint32_t port, uint8_t priority, uint32_t bytes);
+
+  /**
+   * TracedCallback signature for PFC frames.
+   *
+   * \param [in] ifIndex the index of the ingress device
+   * \param [in] priority the priority
+   * \param [in] pause true for a pause, false for a resume
+   */
+  typedef void (* PfcTracedCallback)(uint32_t ifIndex, uint8_t priority, bool pause);
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Set the alpha parameter of all the priorities
+   * \param alpha the alpha parameter
+   */
+  void SetDefaultAlpha (double alpha);
+  /**
+   * \brief Get the alpha parameter last set for all the priorities
+   * \return the alpha parameter
+   */
+  double GetDefaultAlpha (void) const;
+
+  /// Bytes stored by a port, for each priority
+  struct Port
+  {
+    uint32_t bytes;                                   //!< Total bytes
+    std::array<uint32_t, N_PRIORITIES> priorityBytes; //!< Bytes of each priority
+  };
+
+  /// PFC state of an ingress device
+  struct Ingress
+  {
+    std::array<uint32_t, N_PRIORITIES> bytes;   //!< Bytes of each priority
+    std::array<bool, N_PRIORITIES> paused;      //!< Whether each priority is paused
+    std::array<EventId, N_PRIORITIES> refresh;  //!< Refresh of the pause of each priority
+  };
+
+  /**
+   * \brief Send a PFC frame through an ingress device
+   * \param ifIndex the index of the ingress device
+   * \param priority the priority
+   * \param pause true to pause the priority, false to resume it
+   */
+  void SendPfc (uint32_t ifIndex, uint8_t priority, bool pause);
+
+  uint32_t m_size;                                 //!< Size of the pool, in bytes
+  double m_defaultAlpha;                           //!< Alpha of all the priorities
+  std::array<double, N_PRIORITIES> m_alpha;        //!< Alpha of each priority
+  QueueSize m_portMarkThreshold;                   //!< Port occupancy marking threshold
+  QueueSize m_sharedMarkThreshold;                 //!< Pool occupancy marking threshold
+  std::vector<Port> m_ports;                       //!< The ports
+  TracedValue<uint32_t> m_occupancy;               //!< Bytes stored in the pool
+  /// Traced callback: fired when the occupancy of a port changes
+  TracedCallback<uint32_t, uint8_t, uint32_t> m_portOccupancy;
+  QueueSize m_xoff;                                //!< PFC XOFF threshold
+  QueueSize m_xon;                                 //!< PFC XON threshold
+  uint16_t m_pauseQuanta;                          //!< Pause time of the PFC frames
+  Time m_refreshInterval;                          //!< Interval between PFC pause frames
+  std::vector<Ingress> m_ingress;                  //!< State of the ingress devices
+  /// Traced callback: fired when a PFC frame is sent
+  TracedCallback<uint32_t, uint8_t, bool> m_pfcTrace;
+};
+
+} // namespace ns3
+
+#endif /* SHARED_BUFFER_H */
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/simulator.h"
+#include "ns3/drop-tail-queue.h"
+#include "step-marking-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StepMarkingQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (StepMarkingQueueDisc);
+
+TypeId StepMarkingQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::StepMarkingQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<StepMarkingQueueDisc> ()
+    .AddAttribute ("MaxSize",
+                   "The max queue size",
+                   QueueSizeValue (QueueSize ("1000p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("MarkingMode",
+                   "Whether packets are marked on enqueue or on dequeue based on the "
+                   "queue size (compared to MarkingThreshold), or on dequeue based on "
+                   "the sojourn time (compared to SojournThreshold)",
+                   EnumValue (ENQUEUE_LENGTH_MARKING),
+                   MakeEnumAccessor (&StepMarkingQueueDisc::m_markingMode),
+                   MakeEnumChecker (ENQUEUE_LENGTH_MARKING, "EnqueueLength",
+                                    DEQUEUE_LENGTH_MARKING, "DequeueLength",
+                                    DEQUEUE_SOJOURN_MARKING, "DequeueSojourn"))
+    .AddAttribute ("MarkingThreshold",
+                   "The queue size from which packets are marked, in the unit of MaxSize",
+                   QueueSizeValue (QueueSize ("20p")),
+                   MakeQueueSizeAccessor (&StepMarkingQueueDisc::m_threshold),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("SojournThreshold",
+                   "The sojourn time above which packets are marked",
+                   TimeValue (MicroSeconds (200)),
+                   MakeTimeAccessor (&StepMarkingQueueDisc::m_sojournThreshold),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+StepMarkingQueueDisc::StepMarkingQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::SINGLE_INTERNAL_QUEUE)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+StepMarkingQueueDisc::~StepMarkingQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+StepMarkingQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
+      return false;
+    }
+
+  if (m_markingMode == ENQUEUE_LENGTH_MARKING && GetInternalQueue (0)->GetCurrentSize () >= m_threshold)
+    {
+      NS_LOG_LOGIC ("Marking due to the queue size on enqueue");
+      Mark (item, STEP_MARK);
+    }
+
+  bool retval = GetInternalQueue (0)->Enqueue (item);
+
+  // If Queue::Enqueue fails, QueueDisc::DropBeforeEnqueue is called by the
+  // internal queue because QueueDisc::AddInternalQueue sets the trace callback
+
+  NS_LOG_LOGIC ("Number packets " << GetInternalQueue (0)->GetNPackets ());
+  NS_LOG_LOGIC ("Number bytes " << GetInternalQueue (0)->GetNBytes ());
+
+  return retval;
+}
+
+Ptr<QueueDiscItem>
+StepMarkingQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<QueueDiscItem> item = GetInternalQueue (0)->Dequeue ();
+
+  if (!item)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  if ((m_markingMode == DEQUEUE_LENGTH_MARKING && GetInternalQueue (0)->GetCurrentSize () >= m_threshold)
+      || (m_markingMode == DEQUEUE_SOJOURN_MARKING
+          && Simulator::Now () - item->GetTimeStamp () > m_sojournThreshold))
+    {
+      NS_LOG_LOGIC ("Marking on dequeue");
+      Mark (item, STEP_MARK);
+    }
+
+  return item;
+}
+
+Ptr<const QueueDiscItem>
+StepMarkingQueueDisc::DoPeek (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<const QueueDiscItem> item = GetInternalQueue (0)->Peek ();
+
+  if (!item)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  return item;
+}
+
+bool
+StepMarkingQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("StepMarkingQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNPacketFilters () > 0)
+    {
+      NS_LOG_ERROR ("StepMarkingQueueDisc needs no packet filter");
+      return false;
+    }
+
+  if (m_markingMode != DEQUEUE_SOJOURN_MARKING && m_threshold.GetUnit () != GetMaxSize ().GetUnit ())
+    {
+      NS_LOG_ERROR ("The marking threshold and the max size must have the same unit");
+      return false;
+    }
+
+  if (GetNInternalQueues () == 0)
+    {
+      // add a DropTail queue
+      AddInternalQueue (CreateObjectWithAttributes<DropTailQueue<QueueDiscItem> >
+                          ("MaxSize", QueueSizeValue (GetMaxSize ())));
+    }
+
+  if (GetNInternalQueues () != 1)
+    {
+      NS_LOG_ERROR ("StepMarkingQueueDisc needs 1 internal queue");
+      return false;
+    }
+
+  return true;
+}
+
+void
+StepMarkingQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+} // namespace ns3
@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef STEP_MARKING_QUEUE_DISC_H
+#define STEP_MARKING_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A FIFO queue disc with step ECN marking, as used by DCTCP switches
+ *
+ * Packets are marked (if ECN capable) whenever the congestion exceeds a
+ * threshold, without any averaging or randomness, and only dropped when the
+ * queue is full. The congestion is measured, depending on the MarkingMode:
+ *
+ * - on enqueue, as the instantaneous queue size found by the packet, compared
+ *   to the MarkingThreshold (the classic DCTCP marking);
+ * - on dequeue, as the instantaneous queue size left behind by the packet,
+ *   compared to the MarkingThreshold;
+ * - on dequeue, as the sojourn time of the packet, compared to the
+ *   SojournThreshold.
+ *
+ * Dequeue marking conveys the state of the queue when the packet leaves it,
+ * rather than when it arrived, and so signals congestion (and its end) one
+ * queue drain time earlier.
+ */
+class StepMarkingQueueDisc : public QueueDisc
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief StepMarkingQueueDisc constructor
+   */
+  StepMarkingQueueDisc ();
+
+  virtual ~StepMarkingQueueDisc ();
+
+  /**
+   * \brief Where and how packets are marked
+   */
+  enum MarkingMode
+  {
+    ENQUEUE_LENGTH_MARKING,  //!< Marking on enqueue based on the queue size
+    DEQUEUE_LENGTH_MARKING,  //!< Marking on dequeue based on the queue size
+    DEQUEUE_SOJOURN_MARKING, //!< Marking on dequeue based on the sojourn time
+  };
+
+  // Reasons for dropping packets
+  static constexpr const char* LIMIT_EXCEEDED_DROP = "Queue disc limit exceeded";  //!< Packet dropped due to queue disc limit exceeded
+  // Reasons for marking packets
+  static constexpr const char* STEP_MARK = "Step mark";  //!< Packet marked because the congestion exceeded the threshold
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual Ptr<const QueueDiscItem> DoPeek (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  MarkingMode m_markingMode;  //!< Where and how packets are marked
+  QueueSize m_threshold;      //!< Queue size threshold of the length modes
+  Time m_sojournThreshold;    //!< Sojourn time threshold of the sojourn mode
+};
+
+} // namespace ns3
+
+#endif /* STEP_MARKING_QUEUE_DISC_H */
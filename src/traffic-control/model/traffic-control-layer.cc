@@ -24,7 +24,9 @@
 #include "ns3/packet.h"
 #include "ns3/socket.h"
 #include "ns3/queue-disc.h"
+#include "ns3/shared-buffer.h"
 #include <tuple>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -70,6 +72,7 @@ TrafficControlLayer::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_node = 0;
+  m_sharedBuffer = 0;
   m_handlers.clear ();
   m_netDevices.clear ();
   Object::DoDispose ();
@@ -186,13 +189,24 @@ TrafficControlLayer::ScanDevices (void)
               ndi->second.m_queueDiscsToWake.push_back (ndi->second.m_rootQueueDisc);
             }
 
-          // set the NetDeviceQueueInterface object and the SendCallback on the queue discs
+          // set the NetDeviceQueueInterface object and the send callbacks on the queue discs
           // into which packets are enqueued and dequeued by calling Run
           for (auto& q : ndi->second.m_queueDiscsToWake)
             {
               q->SetNetDeviceQueueInterface (ndqi);
               q->SetSendCallback ([dev] (Ptr<QueueDiscItem> item)
                                   { dev->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ()); });
+              q->SetSendBatchCallback ([dev] (const std::vector<Ptr<QueueDiscItem> > &items)
+                                       {
+                                         std::vector<NetDevice::BatchItem> batch;
+                                         batch.reserve (items.size ());
+                                         for (auto& item : items)
+                                           {
+                                             batch.push_back ({item->GetPacket (), item->GetAddress (), item->GetProtocol ()});
+                                           }
+                                         dev->SendBatch (batch);
+                                       },
+                                       [dev] () { return dev->GetSendBatchCapacity (); });
             }
         }
     }
@@ -297,6 +311,11 @@ TrafficControlLayer::NotifyNewAggregate ()
           this->SetNode (node);
         }
     }
+  if (m_sharedBuffer == 0)
+    {
+      // the shared buffer, if any, is aggregated to the node after this object
+      m_sharedBuffer = this->GetObject<SharedBuffer> ();
+    }
   Object::NotifyNewAggregate ();
 }
 
@@ -314,6 +333,13 @@ TrafficControlLayer::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
 {
   NS_LOG_FUNCTION (this << device << p << protocol << from << to << packetType);
 
+  if (m_sharedBuffer != 0 && m_sharedBuffer->IsPfcEnabled ())
+    {
+      // let the shared buffer account for the packet per ingress device
+      IngressDeviceTag ingressTag (device->GetIfIndex ());
+      ConstCast<Packet> (p)->ReplacePacketTag (ingressTag);
+    }
+
   bool found = false;
 
   for (ProtocolHandlerList::iterator i = m_handlers.begin ();
@@ -346,6 +372,15 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
   NS_LOG_DEBUG ("Send packet to device " << device << " protocol number " <<
                 item->GetProtocol ());
 
+  // A segmentation offload super-packet is split here, right before the first
+  // point where packets are handled one by one (queue disc or device)
+  std::vector<Ptr<QueueDiscItem> > segments;
+  if (item->Segment (segments))
+    {
+      SendSegments (device, segments);
+      return;
+    }
+
   Ptr<NetDeviceQueueInterface> devQueueIface;
   std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (device);
 
@@ -398,4 +433,48 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
     }
 }
 
+void
+TrafficControlLayer::SendSegments (Ptr<NetDevice> device, const std::vector<Ptr<QueueDiscItem> > &segments)
+{
+  NS_LOG_FUNCTION (this << device << segments.size ());
+
+  std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (device);
+
+  if (ndi == m_netDevices.end () || ndi->second.m_rootQueueDisc == 0)
+    {
+      for (auto& segment : segments)
+        {
+          Send (device, segment);
+        }
+      return;
+    }
+
+  // Enqueue all the segments and then run the queue discs only once
+  Ptr<NetDeviceQueueInterface> devQueueIface = ndi->second.m_ndqi;
+  std::vector<Ptr<QueueDisc> > toRun;
+  for (auto& segment : segments)
+    {
+      std::size_t txq = 0;
+      if (devQueueIface && devQueueIface->GetNTxQueues () > 1)
+        {
+          txq = devQueueIface->GetSelectQueueCallback () (segment);
+        }
+      NS_ASSERT (!devQueueIface || txq < devQueueIface->GetNTxQueues ());
+      segment->SetTxQueueIndex (txq);
+
+      Ptr<QueueDisc> qDisc = ndi->second.m_queueDiscsToWake[txq];
+      NS_ASSERT (qDisc);
+      qDisc->Enqueue (segment);
+      if (std::find (toRun.begin (), toRun.end (), qDisc) == toRun.end ())
+        {
+          toRun.push_back (qDisc);
+        }
+    }
+
+  for (auto& qDisc : toRun)
+    {
+      qDisc->Run ();
+    }
+}
+
 } // namespace ns3
@@ -32,6 +32,7 @@ namespace ns3 {
 class Packet;
 class QueueDisc;
 class NetDeviceQueueInterface;
+class SharedBuffer;
 
 /**
  * \defgroup traffic-control
@@ -213,6 +214,18 @@ private:
    * Disable default implementation to avoid misuse
    */
   TrafficControlLayer& operator= (TrafficControlLayer const &);
+
+  /**
+   * \brief Send the segments a segmentation offload packet has been split into.
+   *
+   * If the device has a root queue disc, all the segments are enqueued before
+   * the queue discs are run, so that a super-packet costs a single run of the
+   * queue disc. Otherwise, each segment is sent to the device.
+   *
+   * \param device the device the segments must be sent to
+   * \param segments the segments to send
+   */
+  void SendSegments (Ptr<NetDevice> device, const std::vector<Ptr<QueueDiscItem> > &segments);
   /**
    * \brief Protocol handler entry.
    * This structure is used to demultiplex all the protocols.
@@ -251,6 +264,8 @@ private:
 
   /// The node this TrafficControlLayer object is aggregated to
   Ptr<Node> m_node;
+  /// The buffer shared by the queue discs of the node, if any
+  Ptr<SharedBuffer> m_sharedBuffer;
   /// Map storing the required information for each device with a queue disc installed
   std::map<Ptr<NetDevice>, NetDeviceInfo> m_netDevices;
   ProtocolHandlerList m_handlers;  //!< List of upper-layer handlers
@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/drr-queue-disc.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Drr Queue Disc Test Item
+ */
+class DrrQueueDiscTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param addr the address
+   */
+  DrrQueueDiscTestItem (Ptr<Packet> p, const Address & addr);
+  virtual ~DrrQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+
+private:
+  DrrQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  DrrQueueDiscTestItem (const DrrQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  DrrQueueDiscTestItem &operator = (const DrrQueueDiscTestItem &);
+};
+
+DrrQueueDiscTestItem::DrrQueueDiscTestItem (Ptr<Packet> p, const Address & addr)
+  : QueueDiscItem (p, addr, 0)
+{
+}
+
+DrrQueueDiscTestItem::~DrrQueueDiscTestItem ()
+{
+}
+
+void
+DrrQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+DrrQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Drr Queue Disc Test Case
+ *
+ * Checks that the backlogged classes share the dequeued bytes in proportion
+ * to their quantum, also when the quantum is smaller than the packets, and
+ * that packets which cannot be classified are dropped.
+ */
+class DrrQueueDiscTestCase : public TestCase
+{
+public:
+  DrrQueueDiscTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Create a DRR queue disc
+   * \param quanta the quantum of each class
+   * \return the queue disc
+   */
+  Ptr<DrrQueueDisc> CreateDrr (std::vector<uint32_t> quanta);
+  /**
+   * Enqueue a packet
+   * \param q the queue disc
+   * \param classId the class of the packet, used as its priority
+   * \param size the size of the packet
+   * \return whether the packet was enqueued
+   */
+  bool Enqueue (Ptr<DrrQueueDisc> q, uint8_t classId, uint32_t size);
+};
+
+DrrQueueDiscTestCase::DrrQueueDiscTestCase ()
+  : TestCase ("Sanity check on the drr queue disc implementation")
+{
+}
+
+Ptr<DrrQueueDisc>
+DrrQueueDiscTestCase::CreateDrr (std::vector<uint32_t> quanta)
+{
+  Ptr<DrrQueueDisc> q = CreateObject<DrrQueueDisc> ();
+  for (uint32_t quantum : quanta)
+    {
+      Ptr<QueueDisc> child = CreateObjectWithAttributes<FifoQueueDisc> ("MaxSize", StringValue ("10000p"));
+      child->Initialize ();
+      Ptr<DrrClass> c = CreateObjectWithAttributes<DrrClass> ("Quantum", UintegerValue (quantum));
+      c->SetQueueDisc (child);
+      q->AddQueueDiscClass (c);
+    }
+  q->Initialize ();
+  return q;
+}
+
+bool
+DrrQueueDiscTestCase::Enqueue (Ptr<DrrQueueDisc> q, uint8_t classId, uint32_t size)
+{
+  Address dest;
+  Ptr<Packet> p = Create<Packet> (size);
+  SocketPriorityTag priorityTag;
+  priorityTag.SetPriority (classId);
+  p->AddPacketTag (priorityTag);
+  return q->Enqueue (Create<DrrQueueDiscTestItem> (p, dest));
+}
+
+void
+DrrQueueDiscTestCase::DoRun (void)
+{
+  // Classes of quantum 500, 1000 and 1500 sending 500 byte packets: each
+  // round serves 1, 2 and 3 packets, respectively
+  Ptr<DrrQueueDisc> q = CreateDrr ({500, 1000, 1500});
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      for (uint8_t c = 0; c < 3; c++)
+        {
+          Enqueue (q, c, 500);
+        }
+    }
+  std::vector<uint32_t> nPackets (3, 0);
+  for (uint32_t i = 0; i < 12; i++)
+    {
+      Ptr<QueueDiscItem> item = q->Dequeue ();
+      SocketPriorityTag priorityTag;
+      item->GetPacket ()->PeekPacketTag (priorityTag);
+      nPackets[priorityTag.GetPriority ()]++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (nPackets[0], 2, "Class 0 should have sent 1 packet per round");
+  NS_TEST_EXPECT_MSG_EQ (nPackets[1], 4, "Class 1 should have sent 2 packets per round");
+  NS_TEST_EXPECT_MSG_EQ (nPackets[2], 6, "Class 2 should have sent 3 packets per round");
+
+  // An idle class is skipped: once class 2 is empty, classes 0 and 1 share
+  // the next rounds
+  while (q->GetQueueDiscClass (2)->GetQueueDisc ()->GetNPackets () > 0)
+    {
+      q->Dequeue ();
+    }
+  nPackets.assign (3, 0);
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Ptr<QueueDiscItem> item = q->Dequeue ();
+      SocketPriorityTag priorityTag;
+      item->GetPacket ()->PeekPacketTag (priorityTag);
+      nPackets[priorityTag.GetPriority ()]++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (nPackets[0], 2, "Class 0 should have sent 1 packet per round");
+  NS_TEST_EXPECT_MSG_EQ (nPackets[1], 4, "Class 1 should have sent 2 packets per round");
+  uint32_t remaining = q->GetNPackets ();
+  uint32_t n = 0;
+  while (q->Dequeue ())
+    {
+      n++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, remaining, "All the packets should be dequeued");
+
+  // A quantum smaller than the packets: class 0 sends one packet every three
+  // rounds
+  q = CreateDrr ({500, 1500});
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      Enqueue (q, 0, 1500);
+      Enqueue (q, 1, 1500);
+    }
+  nPackets.assign (2, 0);
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      Ptr<QueueDiscItem> item = q->Dequeue ();
+      SocketPriorityTag priorityTag;
+      item->GetPacket ()->PeekPacketTag (priorityTag);
+      nPackets[priorityTag.GetPriority ()]++;
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (nPackets[1], 3 * nPackets[0], 3, "Class 1 should send three times as much as class 0");
+
+  // Unclassified packets
+  NS_TEST_EXPECT_MSG_EQ (Enqueue (q, 5, 100), false, "The packet should be dropped");
+  Address dest;
+  NS_TEST_EXPECT_MSG_EQ (q->Enqueue (Create<DrrQueueDiscTestItem> (Create<Packet> (100), dest)), false,
+                         "The packet should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (q->GetStats ().GetNDroppedPackets (DrrQueueDisc::UNCLASSIFIED_DROP), 2,
+                         "There should be two unclassified packets");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Drr Queue Disc Test Suite
+ */
+static class DrrQueueDiscTestSuite : public TestSuite
+{
+public:
+  DrrQueueDiscTestSuite ()
+    : TestSuite ("drr-queue-disc", UNIT)
+  {
+    AddTestCase (new DrrQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_drrQueueDiscTestSuite; ///< the test suite
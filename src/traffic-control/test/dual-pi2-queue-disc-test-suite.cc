@@ -0,0 +1,343 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/dual-pi2-queue-disc.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief DualPi2 Queue Disc Test Item
+ */
+class DualPi2QueueDiscTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param addr the address
+   * \param ecn the value of the ECN field
+   */
+  DualPi2QueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint8_t ecn);
+  virtual ~DualPi2QueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  virtual bool GetUint8Value (Uint8Values field, uint8_t &value) const;
+
+private:
+  DualPi2QueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  DualPi2QueueDiscTestItem (const DualPi2QueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  DualPi2QueueDiscTestItem &operator = (const DualPi2QueueDiscTestItem &);
+  uint8_t m_ecn; //!< Value of the ECN field
+};
+
+DualPi2QueueDiscTestItem::DualPi2QueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint8_t ecn)
+  : QueueDiscItem (p, addr, 0),
+    m_ecn (ecn)
+{
+}
+
+DualPi2QueueDiscTestItem::~DualPi2QueueDiscTestItem ()
+{
+}
+
+void
+DualPi2QueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+DualPi2QueueDiscTestItem::Mark (void)
+{
+  if (m_ecn == 0)
+    {
+      return false;
+    }
+  m_ecn = 3;
+  return true;
+}
+
+bool
+DualPi2QueueDiscTestItem::GetUint8Value (Uint8Values field, uint8_t &value) const
+{
+  if (field == IP_DSFIELD)
+    {
+      value = m_ecn;
+      return true;
+    }
+  return false;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief DualPi2 Queue Disc Classification Test Case
+ *
+ * ECT(1) and CE packets have to be stored in the L4S queue, Not-ECT and
+ * ECT(0) packets in the Classic queue, and the two queues share the limit.
+ */
+class DualPi2QueueDiscClassificationTestCase : public TestCase
+{
+public:
+  DualPi2QueueDiscClassificationTestCase ();
+  virtual void DoRun (void);
+};
+
+DualPi2QueueDiscClassificationTestCase::DualPi2QueueDiscClassificationTestCase ()
+  : TestCase ("Sanity check on the classification and limit of the dual pi2 queue disc")
+{
+}
+
+void
+DualPi2QueueDiscClassificationTestCase::DoRun (void)
+{
+  Ptr<DualPi2QueueDisc> queue = CreateObjectWithAttributes<DualPi2QueueDisc> ("MaxSize", StringValue ("6p"));
+  queue->Initialize ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNInternalQueues (), 2, "There should be two internal queues");
+
+  Address dest;
+  for (uint8_t ecn = 0; ecn < 4; ecn++)
+    {
+      queue->Enqueue (Create<DualPi2QueueDiscTestItem> (Create<Packet> (1000), dest, ecn));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (DualPi2QueueDisc::CLASSIC)->GetNPackets (), 2,
+                         "Not-ECT and ECT(0) packets should be in the Classic queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (DualPi2QueueDisc::L4S)->GetNPackets (), 2,
+                         "ECT(1) and CE packets should be in the L4S queue");
+
+  queue->Enqueue (Create<DualPi2QueueDiscTestItem> (Create<Packet> (1000), dest, 1));
+  queue->Enqueue (Create<DualPi2QueueDiscTestItem> (Create<Packet> (1000), dest, 0));
+  NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (Create<DualPi2QueueDiscTestItem> (Create<Packet> (1000), dest, 1)),
+                         false, "The shared limit should be reached");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNDroppedPackets (DualPi2QueueDisc::FORCED_DROP), 1,
+                         "There should be one forced drop");
+
+  // With empty queues the L4S queue is served first
+  Ptr<QueueDiscItem> item = queue->Dequeue ();
+  uint8_t tos;
+  item->GetUint8Value (QueueItem::IP_DSFIELD, tos);
+  NS_TEST_EXPECT_MSG_EQ ((tos & 0x1), 1, "The L4S queue should be served first");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief DualPi2 Queue Disc Step Marking Test Case
+ *
+ * L4S packets are marked as soon as their sojourn time exceeds MinTh, even
+ * if the Classic queue is empty.
+ */
+class DualPi2QueueDiscStepMarkingTestCase : public TestCase
+{
+public:
+  DualPi2QueueDiscStepMarkingTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Dequeue a packet and check whether it was marked
+   * \param queue the queue disc
+   * \param marked whether the packet should have been marked
+   */
+  void DequeueAndCheck (Ptr<DualPi2QueueDisc> queue, bool marked);
+};
+
+DualPi2QueueDiscStepMarkingTestCase::DualPi2QueueDiscStepMarkingTestCase ()
+  : TestCase ("Sanity check on the step marking of the dual pi2 queue disc")
+{
+}
+
+void
+DualPi2QueueDiscStepMarkingTestCase::DequeueAndCheck (Ptr<DualPi2QueueDisc> queue, bool marked)
+{
+  Ptr<QueueDiscItem> item = queue->Dequeue ();
+  NS_TEST_ASSERT_MSG_NE (item, 0, "There should be a packet to dequeue");
+  uint8_t tos;
+  item->GetUint8Value (QueueItem::IP_DSFIELD, tos);
+  bool ce = ((tos & 0x3) == 3);
+  NS_TEST_EXPECT_MSG_EQ (ce, marked, "Unexpected marking at " << Simulator::Now ().As (Time::US));
+}
+
+void
+DualPi2QueueDiscStepMarkingTestCase::DoRun (void)
+{
+  Ptr<DualPi2QueueDisc> queue = CreateObject<DualPi2QueueDisc> ();
+  queue->AssignStreams (1);
+  queue->Initialize ();
+
+  Address dest;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      queue->Enqueue (Create<DualPi2QueueDiscTestItem> (Create<Packet> (1000), dest, 1));
+    }
+  Simulator::Schedule (MicroSeconds (500), &DualPi2QueueDiscStepMarkingTestCase::DequeueAndCheck,
+                       this, queue, false);
+  Simulator::Schedule (MicroSeconds (1000), &DualPi2QueueDiscStepMarkingTestCase::DequeueAndCheck,
+                       this, queue, false);
+  Simulator::Schedule (MicroSeconds (1500), &DualPi2QueueDiscStepMarkingTestCase::DequeueAndCheck,
+                       this, queue, true);
+  Simulator::Stop (MilliSeconds (100));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNMarkedPackets (DualPi2QueueDisc::STEP_MARK), 1,
+                         "One packet should have been marked by the step");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetBaseProbability (), 0, "The base probability should be null");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief DualPi2 Queue Disc Mixed Load Test Case
+ *
+ * A 1 packet/ms link is overloaded by unresponsive Classic (1.25 packets/ms)
+ * and L4S (0.25 packets/ms) traffic. The PI controller has to keep the
+ * Classic queue delay around its target by dropping Classic packets, the
+ * coupling has to mark the L4S packets, and the L4S packets have to see a
+ * queue delay below the step threshold.
+ */
+class DualPi2QueueDiscMixedLoadTestCase : public TestCase
+{
+public:
+  DualPi2QueueDiscMixedLoadTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Enqueue a packet and schedule the next one
+   * \param queue the queue disc
+   * \param ecn the ECN field of the packets
+   * \param interval the interval between two packets
+   */
+  void Send (Ptr<DualPi2QueueDisc> queue, uint8_t ecn, Time interval);
+  /**
+   * Dequeue a packet, record its sojourn time and schedule the next dequeue
+   * \param queue the queue disc
+   */
+  void Transmit (Ptr<DualPi2QueueDisc> queue);
+
+  Time m_measureStart {Seconds (5)}; //!< Start of the measurement
+  Time m_sojourn[2];                 //!< Total sojourn time of each class
+  Time m_maxSojourn[2];              //!< Maximum sojourn time of each class
+  uint32_t m_nPackets[2] {0, 0};     //!< Packets of each class transmitted
+};
+
+DualPi2QueueDiscMixedLoadTestCase::DualPi2QueueDiscMixedLoadTestCase ()
+  : TestCase ("Check the L4S queue delay of the dual pi2 queue disc under mixed load")
+{
+}
+
+void
+DualPi2QueueDiscMixedLoadTestCase::Send (Ptr<DualPi2QueueDisc> queue, uint8_t ecn, Time interval)
+{
+  Address dest;
+  queue->Enqueue (Create<DualPi2QueueDiscTestItem> (Create<Packet> (1000), dest, ecn));
+  Simulator::Schedule (interval, &DualPi2QueueDiscMixedLoadTestCase::Send, this, queue, ecn, interval);
+}
+
+void
+DualPi2QueueDiscMixedLoadTestCase::Transmit (Ptr<DualPi2QueueDisc> queue)
+{
+  Ptr<QueueDiscItem> item = queue->Dequeue ();
+  if (item && Simulator::Now () >= m_measureStart)
+    {
+      uint8_t tos;
+      item->GetUint8Value (QueueItem::IP_DSFIELD, tos);
+      uint32_t index = (tos & 0x1) ? DualPi2QueueDisc::L4S : DualPi2QueueDisc::CLASSIC;
+      Time sojourn = Simulator::Now () - item->GetTimeStamp ();
+      m_sojourn[index] += sojourn;
+      m_maxSojourn[index] = std::max (m_maxSojourn[index], sojourn);
+      m_nPackets[index]++;
+    }
+  Simulator::Schedule (MilliSeconds (1), &DualPi2QueueDiscMixedLoadTestCase::Transmit, this, queue);
+}
+
+void
+DualPi2QueueDiscMixedLoadTestCase::DoRun (void)
+{
+  Ptr<DualPi2QueueDisc> queue = CreateObject<DualPi2QueueDisc> ();
+  queue->AssignStreams (1);
+  queue->Initialize ();
+
+  Simulator::Schedule (MicroSeconds (100), &DualPi2QueueDiscMixedLoadTestCase::Send,
+                       this, queue, 0, MicroSeconds (800));
+  Simulator::Schedule (MicroSeconds (300), &DualPi2QueueDiscMixedLoadTestCase::Send,
+                       this, queue, 1, MilliSeconds (4));
+  Simulator::Schedule (MilliSeconds (1), &DualPi2QueueDiscMixedLoadTestCase::Transmit, this, queue);
+  Simulator::Stop (Seconds (15));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_nPackets[DualPi2QueueDisc::CLASSIC], 0, "No Classic packet was transmitted");
+  NS_TEST_ASSERT_MSG_GT (m_nPackets[DualPi2QueueDisc::L4S], 0, "No L4S packet was transmitted");
+  Time classicDelay = Seconds (m_sojourn[DualPi2QueueDisc::CLASSIC].GetSeconds () / m_nPackets[DualPi2QueueDisc::CLASSIC]);
+  Time l4sDelay = Seconds (m_sojourn[DualPi2QueueDisc::L4S].GetSeconds () / m_nPackets[DualPi2QueueDisc::L4S]);
+
+  NS_TEST_EXPECT_MSG_LT (l4sDelay, MilliSeconds (1), "The L4S queue delay should stay below the step threshold");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_maxSojourn[DualPi2QueueDisc::L4S], MilliSeconds (1),
+                               "No L4S packet should wait more than a transmission time");
+  NS_TEST_EXPECT_MSG_GT (classicDelay, MilliSeconds (10), "The Classic queue delay should be close to the target");
+  NS_TEST_EXPECT_MSG_LT (classicDelay, MilliSeconds (20), "The Classic queue delay should be close to the target");
+  NS_TEST_EXPECT_MSG_GT (queue->GetStats ().GetNDroppedPackets (DualPi2QueueDisc::UNFORCED_CLASSIC_DROP), 0,
+                         "Classic packets should have been dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNDroppedPackets (DualPi2QueueDisc::FORCED_DROP), 0,
+                         "The shared limit should not be reached");
+  NS_TEST_EXPECT_MSG_GT (queue->GetStats ().GetNMarkedPackets (DualPi2QueueDisc::UNFORCED_L4S_MARK), 0,
+                         "L4S packets should have been marked by the coupling");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief DualPi2 Queue Disc Test Suite
+ */
+static class DualPi2QueueDiscTestSuite : public TestSuite
+{
+public:
+  DualPi2QueueDiscTestSuite ()
+    : TestSuite ("dual-pi2-queue-disc", UNIT)
+  {
+    AddTestCase (new DualPi2QueueDiscClassificationTestCase (), TestCase::QUICK);
+    AddTestCase (new DualPi2QueueDiscStepMarkingTestCase (), TestCase::QUICK);
+    AddTestCase (new DualPi2QueueDiscMixedLoadTestCase (), TestCase::QUICK);
+  }
+} g_dualPi2QueueDiscTestSuite; ///< the test suite
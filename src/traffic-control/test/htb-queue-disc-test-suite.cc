@@ -0,0 +1,258 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/htb-queue-disc.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/integer.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Htb Queue Disc Test Item
+ */
+class HtbQueueDiscTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param addr the address
+   */
+  HtbQueueDiscTestItem (Ptr<Packet> p, const Address & addr);
+  virtual ~HtbQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+
+private:
+  HtbQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  HtbQueueDiscTestItem (const HtbQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  HtbQueueDiscTestItem &operator = (const HtbQueueDiscTestItem &);
+};
+
+HtbQueueDiscTestItem::HtbQueueDiscTestItem (Ptr<Packet> p, const Address & addr)
+  : QueueDiscItem (p, addr, 0)
+{
+}
+
+HtbQueueDiscTestItem::~HtbQueueDiscTestItem ()
+{
+}
+
+void
+HtbQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+HtbQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Htb Queue Disc Test Case
+ *
+ * A root class of 8Mbps has two leaves. The queue disc sends the packets
+ * as soon as they are dequeued, and the bytes sent by each leaf in one second
+ * are checked: a leaf alone borrows up to its ceil, two backlogged leaves get
+ * their guaranteed rates, and the excess capacity is shared among leaves of
+ * the same priority in proportion to their quantum, or given to the leaf of
+ * lowest priority value.
+ */
+class HtbQueueDiscTestCase : public TestCase
+{
+public:
+  HtbQueueDiscTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /// Configuration of a leaf
+  struct Leaf
+  {
+    std::string rate;     //!< Guaranteed rate
+    std::string ceil;     //!< Maximum rate
+    uint8_t priority;     //!< Priority
+    uint32_t nPackets;    //!< Packets enqueued at the beginning
+  };
+
+  /**
+   * Run a scenario
+   * \param leaves the configuration of the leaves
+   * \return the bytes sent by each leaf in one second
+   */
+  std::vector<uint64_t> RunScenario (std::vector<Leaf> leaves);
+  /**
+   * Record a packet sent by the queue disc
+   * \param item the packet
+   */
+  void Send (Ptr<QueueDiscItem> item);
+
+  std::vector<uint64_t> m_sent;   //!< Bytes sent by each leaf
+  static const uint32_t PKT_SIZE = 1000;  //!< Size of the packets of the first leaf
+};
+
+HtbQueueDiscTestCase::HtbQueueDiscTestCase ()
+  : TestCase ("Sanity check on the htb queue disc implementation")
+{
+}
+
+void
+HtbQueueDiscTestCase::Send (Ptr<QueueDiscItem> item)
+{
+  // the packets of leaf i (class i + 1) are PKT_SIZE + i bytes long
+  m_sent[item->GetSize () - PKT_SIZE] += item->GetSize ();
+}
+
+std::vector<uint64_t>
+HtbQueueDiscTestCase::RunScenario (std::vector<Leaf> leaves)
+{
+  Ptr<HtbQueueDisc> q = CreateObject<HtbQueueDisc> ();
+  std::vector<Ptr<HtbClass> > classes;
+  classes.push_back (CreateObjectWithAttributes<HtbClass> ("Rate", StringValue ("8Mbps")));
+  for (const auto &leaf : leaves)
+    {
+      classes.push_back (CreateObjectWithAttributes<HtbClass> ("Parent", IntegerValue (0),
+                                                               "Rate", StringValue (leaf.rate),
+                                                               "Ceil", StringValue (leaf.ceil),
+                                                               "Priority", UintegerValue (leaf.priority)));
+    }
+  for (auto &c : classes)
+    {
+      Ptr<QueueDisc> child = CreateObjectWithAttributes<FifoQueueDisc> ("MaxSize", StringValue ("10000p"));
+      child->Initialize ();
+      c->SetQueueDisc (child);
+      q->AddQueueDiscClass (c);
+    }
+  q->SetSendCallback ([this] (Ptr<QueueDiscItem> item) { Send (item); });
+  q->Initialize ();
+
+  NS_TEST_EXPECT_MSG_EQ (q->GetLevel (0), 1, "The root class should have level 1");
+  NS_TEST_EXPECT_MSG_EQ (q->GetLevel (1), 0, "A leaf should have level 0");
+
+  Address dest;
+  for (uint32_t i = 0; i < leaves.size (); i++)
+    {
+      for (uint32_t j = 0; j < leaves[i].nPackets; j++)
+        {
+          Ptr<Packet> p = Create<Packet> (PKT_SIZE + i);
+          SocketPriorityTag priorityTag;
+          priorityTag.SetPriority (i + 1);
+          p->AddPacketTag (priorityTag);
+          q->Enqueue (Create<HtbQueueDiscTestItem> (p, dest));
+        }
+    }
+
+  m_sent.assign (leaves.size (), 0);
+  Simulator::Schedule (Seconds (0), &QueueDisc::Run, q);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_sent;
+}
+
+void
+HtbQueueDiscTestCase::DoRun (void)
+{
+  // A leaf alone borrows from the root up to its ceil
+  std::vector<uint64_t> sent = RunScenario ({{"2Mbps", "8Mbps", 0, 2000}});
+  NS_TEST_EXPECT_MSG_EQ_TOL (sent[0], 1000000, 20000, "The leaf should be sent at its ceil");
+
+  sent = RunScenario ({{"2Mbps", "4Mbps", 0, 2000}});
+  NS_TEST_EXPECT_MSG_EQ_TOL (sent[0], 500000, 10000, "The leaf should not exceed its ceil");
+
+  // Two backlogged leaves get their guaranteed rates
+  sent = RunScenario ({{"2Mbps", "8Mbps", 0, 2000}, {"6Mbps", "8Mbps", 0, 2000}});
+  NS_TEST_EXPECT_MSG_EQ_TOL (sent[0], 250000, 10000, "The first leaf should get its rate");
+  NS_TEST_EXPECT_MSG_EQ_TOL (sent[1], 750000, 15000, "The second leaf should get its rate");
+
+  // The excess capacity is shared among the leaves of the same priority
+  sent = RunScenario ({{"1Mbps", "8Mbps", 0, 2000}, {"1Mbps", "8Mbps", 0, 2000}});
+  NS_TEST_EXPECT_MSG_EQ_TOL (sent[0], 500000, 20000, "The leaves should share the capacity");
+  NS_TEST_EXPECT_MSG_EQ_TOL (sent[1], 500000, 20000, "The leaves should share the capacity");
+
+  // ... or given to the leaf of lowest priority value
+  sent = RunScenario ({{"1Mbps", "8Mbps", 1, 2000}, {"1Mbps", "8Mbps", 0, 2000}});
+  NS_TEST_EXPECT_MSG_EQ_TOL (sent[0], 125000, 10000, "The first leaf should only get its rate");
+  NS_TEST_EXPECT_MSG_EQ_TOL (sent[1], 875000, 20000, "The second leaf should get the excess capacity");
+
+  // A leaf without backlog leaves its rate to the others
+  sent = RunScenario ({{"6Mbps", "8Mbps", 0, 100}, {"2Mbps", "8Mbps", 0, 2000}});
+  NS_TEST_EXPECT_MSG_EQ (sent[0], 100 * PKT_SIZE, "The first leaf should send all its packets");
+  NS_TEST_EXPECT_MSG_EQ_TOL (sent[1], 900000, 20000, "The second leaf should get the remaining capacity");
+
+  // Packets of the root class or with no class are dropped
+  Ptr<HtbQueueDisc> q = CreateObject<HtbQueueDisc> ();
+  Ptr<HtbClass> c = CreateObjectWithAttributes<HtbClass> ("Rate", StringValue ("8Mbps"));
+  Ptr<QueueDisc> child = CreateObject<FifoQueueDisc> ();
+  child->Initialize ();
+  c->SetQueueDisc (child);
+  q->AddQueueDiscClass (c);
+  c = CreateObjectWithAttributes<HtbClass> ("Rate", StringValue ("8Mbps"), "Parent", IntegerValue (0));
+  child = CreateObject<FifoQueueDisc> ();
+  child->Initialize ();
+  c->SetQueueDisc (child);
+  q->AddQueueDiscClass (c);
+  q->Initialize ();
+  Address dest;
+  NS_TEST_EXPECT_MSG_EQ (q->Enqueue (Create<HtbQueueDiscTestItem> (Create<Packet> (100), dest)), false,
+                         "The packet should be dropped");
+  q->SetAttribute ("DefaultClass", UintegerValue (1));
+  NS_TEST_EXPECT_MSG_EQ (q->Enqueue (Create<HtbQueueDiscTestItem> (Create<Packet> (100), dest)), true,
+                         "The packet should be enqueued in the default class");
+  NS_TEST_EXPECT_MSG_EQ (q->GetStats ().GetNDroppedPackets (HtbQueueDisc::UNCLASSIFIED_DROP), 1,
+                         "There should be one unclassified packet");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Htb Queue Disc Test Suite
+ */
+static class HtbQueueDiscTestSuite : public TestSuite
+{
+public:
+  HtbQueueDiscTestSuite ()
+    : TestSuite ("htb-queue-disc", UNIT)
+  {
+    AddTestCase (new HtbQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_htbQueueDiscTestSuite; ///< the test suite
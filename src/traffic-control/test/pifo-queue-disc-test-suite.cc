@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/pifo-queue-disc.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Pifo Queue Disc Test Item
+ */
+class PifoQueueDiscTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param addr the address
+   */
+  PifoQueueDiscTestItem (Ptr<Packet> p, const Address & addr);
+  virtual ~PifoQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+
+private:
+  PifoQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  PifoQueueDiscTestItem (const PifoQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  PifoQueueDiscTestItem &operator = (const PifoQueueDiscTestItem &);
+};
+
+PifoQueueDiscTestItem::PifoQueueDiscTestItem (Ptr<Packet> p, const Address & addr)
+  : QueueDiscItem (p, addr, 0)
+{
+}
+
+PifoQueueDiscTestItem::~PifoQueueDiscTestItem ()
+{
+}
+
+void
+PifoQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+PifoQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Pifo Queue Disc Test Case
+ *
+ * Checks the dequeue order given by the rank tags and by a rank callback,
+ * the mapping of ranks to buckets, the tail drop and push out policies and,
+ * with many buckets, that ranks are dequeued in non-decreasing order.
+ */
+class PifoQueueDiscTestCase : public TestCase
+{
+public:
+  PifoQueueDiscTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Enqueue a packet
+   * \param q the queue disc
+   * \param size the size of the packet, used to identify it
+   * \param rank the rank carried by the PifoRankTag of the packet
+   * \return whether the packet was enqueued
+   */
+  bool Enqueue (Ptr<PifoQueueDisc> q, uint32_t size, uint64_t rank);
+  /**
+   * Dequeue a packet
+   * \param q the queue disc
+   * \return the size of the packet, 0 if the queue disc is empty
+   */
+  uint32_t Dequeue (Ptr<PifoQueueDisc> q);
+  /**
+   * Rank callback: the size of the packet
+   * \param item the packet
+   * \return the rank
+   */
+  static uint64_t SizeRank (Ptr<const QueueDiscItem> item);
+};
+
+PifoQueueDiscTestCase::PifoQueueDiscTestCase ()
+  : TestCase ("Sanity check on the pifo queue disc implementation")
+{
+}
+
+bool
+PifoQueueDiscTestCase::Enqueue (Ptr<PifoQueueDisc> q, uint32_t size, uint64_t rank)
+{
+  Address dest;
+  Ptr<Packet> p = Create<Packet> (size);
+  p->AddPacketTag (PifoRankTag (rank));
+  return q->Enqueue (Create<PifoQueueDiscTestItem> (p, dest));
+}
+
+uint32_t
+PifoQueueDiscTestCase::Dequeue (Ptr<PifoQueueDisc> q)
+{
+  Ptr<QueueDiscItem> item = q->Dequeue ();
+  return item ? item->GetSize () : 0;
+}
+
+uint64_t
+PifoQueueDiscTestCase::SizeRank (Ptr<const QueueDiscItem> item)
+{
+  return item->GetSize ();
+}
+
+void
+PifoQueueDiscTestCase::DoRun (void)
+{
+  // Dequeue in increasing order of rank, FIFO for equal ranks
+  Ptr<PifoQueueDisc> q = CreateObject<PifoQueueDisc> ();
+  q->Initialize ();
+  Enqueue (q, 100, 5);
+  Enqueue (q, 200, 1);
+  Enqueue (q, 300, 3);
+  Enqueue (q, 400, 1);
+  Address dest;
+  q->Enqueue (Create<PifoQueueDiscTestItem> (Create<Packet> (500), dest));
+  NS_TEST_EXPECT_MSG_EQ (q->GetNPackets (), 5, "There should be 5 packets");
+  NS_TEST_EXPECT_MSG_EQ (q->Peek ()->GetSize (), 500, "Untagged packets should have rank 0");
+  uint32_t expected[] = {500, 200, 400, 300, 100, 0};
+  for (uint32_t size : expected)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Dequeue (q), size, "Wrong dequeue order");
+    }
+
+  // Rank callback and buckets of 10 ranks, the last one holding larger ranks
+  q = CreateObjectWithAttributes<PifoQueueDisc> ("NumBuckets", UintegerValue (4),
+                                                 "Granularity", UintegerValue (10));
+  q->SetRankCallback (MakeCallback (&PifoQueueDiscTestCase::SizeRank));
+  q->Initialize ();
+  NS_TEST_EXPECT_MSG_EQ (q->GetBucket (9), 0, "Wrong bucket");
+  NS_TEST_EXPECT_MSG_EQ (q->GetBucket (25), 2, "Wrong bucket");
+  NS_TEST_EXPECT_MSG_EQ (q->GetBucket (1000), 3, "Wrong bucket");
+  uint32_t sizes[] = {25, 5, 100, 35, 2};
+  for (uint32_t size : sizes)
+    {
+      Enqueue (q, size, 0);
+    }
+  uint32_t bucketOrder[] = {5, 2, 25, 100, 35, 0};
+  for (uint32_t size : bucketOrder)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Dequeue (q), size, "Wrong dequeue order");
+    }
+
+  // Tail drop
+  q = CreateObjectWithAttributes<PifoQueueDisc> ("MaxSize", StringValue ("3p"));
+  q->Initialize ();
+  Enqueue (q, 10, 10);
+  Enqueue (q, 20, 20);
+  Enqueue (q, 30, 30);
+  NS_TEST_EXPECT_MSG_EQ (Enqueue (q, 5, 5), false, "The packet should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (q->GetStats ().GetNDroppedPackets (PifoQueueDisc::LIMIT_EXCEEDED_DROP), 1,
+                         "There should be one drop");
+
+  // Push out
+  q = CreateObjectWithAttributes<PifoQueueDisc> ("MaxSize", StringValue ("3p"),
+                                                 "PushOut", BooleanValue (true));
+  q->Initialize ();
+  Enqueue (q, 10, 10);
+  Enqueue (q, 20, 20);
+  Enqueue (q, 30, 30);
+  NS_TEST_EXPECT_MSG_EQ (Enqueue (q, 5, 5), true, "The packet should push out the highest rank");
+  NS_TEST_EXPECT_MSG_EQ (Enqueue (q, 40, 40), false, "The packet should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (q->GetStats ().GetNDroppedPackets (PifoQueueDisc::PUSHED_OUT_DROP), 1,
+                         "There should be one packet pushed out");
+  NS_TEST_EXPECT_MSG_EQ (q->GetStats ().GetNDroppedPackets (PifoQueueDisc::LIMIT_EXCEEDED_DROP), 1,
+                         "There should be one drop");
+  NS_TEST_EXPECT_MSG_EQ (q->GetNPackets (), 3, "There should be 3 packets");
+  uint32_t pushOutOrder[] = {5, 10, 20, 0};
+  for (uint32_t size : pushOutOrder)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Dequeue (q), size, "Wrong dequeue order");
+    }
+
+  // Many buckets, interleaved enqueues and dequeues
+  q = CreateObjectWithAttributes<PifoQueueDisc> ("NumBuckets", UintegerValue (10000),
+                                                 "MaxSize", StringValue ("10000p"));
+  q->SetRankCallback (MakeCallback (&PifoQueueDiscTestCase::SizeRank));
+  q->Initialize ();
+  uint32_t x = 1;
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      x = x * 1103515245 + 12345;
+      Enqueue (q, 1 + (x >> 8) % 9999, 0);
+      if (i % 3 == 2)
+        {
+          q->Dequeue ();
+        }
+    }
+  uint32_t last = 0;
+  bool ordered = true;
+  while (uint32_t size = Dequeue (q))
+    {
+      ordered &= (size >= last);
+      last = size;
+    }
+  NS_TEST_EXPECT_MSG_EQ (ordered, true, "Ranks should be dequeued in non-decreasing order");
+  NS_TEST_EXPECT_MSG_EQ (q->GetNPackets (), 0, "The queue disc should be empty");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Pifo Queue Disc Test Suite
+ */
+static class PifoQueueDiscTestSuite : public TestSuite
+{
+public:
+  PifoQueueDiscTestSuite ()
+    : TestSuite ("pifo-queue-disc", UNIT)
+  {
+    AddTestCase (new PifoQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_pifoQueueDiscTestSuite; ///< the test suite
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue Disc Batch Test Item
+ */
+class QueueDiscBatchTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   */
+  QueueDiscBatchTestItem (Ptr<Packet> p);
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+};
+
+QueueDiscBatchTestItem::QueueDiscBatchTestItem (Ptr<Packet> p)
+  : QueueDiscItem (p, Mac48Address (), 0)
+{
+}
+
+void
+QueueDiscBatchTestItem::AddHeader (void)
+{
+}
+
+bool
+QueueDiscBatchTestItem::Mark (void)
+{
+  return false;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue Disc Batch Test Case
+ *
+ * Enqueue packets into a FIFO queue disc and check the batches of packets
+ * sent by the Run method for several configurations of the batch limits, of
+ * the capacity of the device and of the quota.
+ */
+class QueueDiscBatchTestCase : public TestCase
+{
+public:
+  QueueDiscBatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Run a scenario
+   * \param maxBatchPackets the value of the MaxBatchPackets attribute
+   * \param maxBatchBytes the value of the MaxBatchBytes attribute
+   * \param capacity the number of packets the device accepts in a batch
+   * \param quota the value of the Quota attribute
+   * \param batches the expected sizes of the batches
+   * \param nSingle the expected number of packets sent one by one
+   */
+  void RunScenario (uint32_t maxBatchPackets, uint32_t maxBatchBytes, uint32_t capacity,
+                    uint32_t quota, std::vector<uint32_t> batches, uint32_t nSingle);
+
+  std::vector<uint64_t> m_sent;     //!< UIDs of the sent packets
+  std::vector<uint32_t> m_batches;  //!< Sizes of the sent batches
+  uint32_t m_nSingle;               //!< Number of packets sent one by one
+};
+
+QueueDiscBatchTestCase::QueueDiscBatchTestCase ()
+  : TestCase ("Sanity check on the batches sent by queue discs"),
+    m_nSingle (0)
+{
+}
+
+void
+QueueDiscBatchTestCase::RunScenario (uint32_t maxBatchPackets, uint32_t maxBatchBytes,
+                                     uint32_t capacity, uint32_t quota,
+                                     std::vector<uint32_t> batches, uint32_t nSingle)
+{
+  const uint32_t nPackets = 10;
+  const uint32_t pktSize = 1000;
+
+  m_sent.clear ();
+  m_batches.clear ();
+  m_nSingle = 0;
+
+  Ptr<FifoQueueDisc> queue = CreateObject<FifoQueueDisc> ();
+  queue->SetAttribute ("MaxBatchPackets", UintegerValue (maxBatchPackets));
+  queue->SetAttribute ("MaxBatchBytes", UintegerValue (maxBatchBytes));
+  queue->SetQuota (quota);
+  queue->SetSendCallback ([this] (Ptr<QueueDiscItem> item)
+                          {
+                            m_sent.push_back (item->GetPacket ()->GetUid ());
+                            m_nSingle++;
+                          });
+  queue->SetSendBatchCallback ([this] (const std::vector<Ptr<QueueDiscItem> > &items)
+                               {
+                                 for (auto& item : items)
+                                   {
+                                     m_sent.push_back (item->GetPacket ()->GetUid ());
+                                   }
+                                 m_batches.push_back (items.size ());
+                               },
+                               [capacity] () { return capacity; });
+  queue->Initialize ();
+
+  std::vector<uint64_t> uids;
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (pktSize);
+      uids.push_back (p->GetUid ());
+      queue->Enqueue (Create<QueueDiscBatchTestItem> (p));
+    }
+
+  queue->Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_batches.size (), batches.size (), "Unexpected number of batches");
+  for (uint32_t i = 0; i < std::min (m_batches.size (), batches.size ()); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_batches[i], batches[i], "Unexpected size of batch " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_nSingle, nSingle, "Unexpected number of packets sent one by one");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets () + m_sent.size (), nPackets, "Packets were lost");
+  for (uint32_t i = 0; i < m_sent.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_sent[i], uids[i], "Packets sent out of order");
+    }
+  QueueDisc::Stats stats = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalSentPackets, m_sent.size (), "Wrong number of sent packets");
+}
+
+void
+QueueDiscBatchTestCase::DoRun (void)
+{
+  // batches disabled
+  RunScenario (1, 65536, 100, 64, {}, 10);
+  // batches limited by MaxBatchPackets
+  RunScenario (4, 65536, 100, 64, {4, 4, 2}, 0);
+  // batches limited by the capacity of the device
+  RunScenario (4, 65536, 3, 64, {3, 3, 3, 1}, 0);
+  // batches limited by MaxBatchBytes (the last packet may exceed the limit)
+  RunScenario (8, 2500, 100, 64, {3, 3, 3, 1}, 0);
+  // the device does not support batches
+  RunScenario (4, 65536, 0, 64, {}, 10);
+  // batches limited by the quota
+  RunScenario (4, 65536, 100, 5, {4}, 1);
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue Disc Batch Test Suite
+ */
+static class QueueDiscBatchTestSuite : public TestSuite
+{
+public:
+  QueueDiscBatchTestSuite ()
+    : TestSuite ("queue-disc-batch", UNIT)
+  {
+    AddTestCase (new QueueDiscBatchTestCase (), TestCase::QUICK);
+  }
+} g_queueDiscBatchTestSuite; ///< the test suite
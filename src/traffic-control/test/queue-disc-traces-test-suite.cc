@@ -25,6 +25,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include <map>
+#include <sstream>
 
 using namespace ns3;
 
@@ -555,6 +556,33 @@ QueueDiscTracesTestCase::DoRun (void)
   CheckDroppedBeforeEnqueue (child, 1, pktSizeUnit * 5);
   CheckDroppedAfterDequeue (child, 2, pktSizeUnit * 3);
 
+  // The root queue disc counts the drops of the child queue disc under the
+  // reasons of the child queue disc prefixed by CHILD_QUEUE_DISC_DROP
+  std::string rootDbe = std::string (QueueDisc::CHILD_QUEUE_DISC_DROP) + TestChildQueueDisc::BEFORE_ENQUEUE;
+  std::string rootDad = std::string (QueueDisc::CHILD_QUEUE_DISC_DROP) + TestChildQueueDisc::AFTER_DEQUEUE;
+
+  NS_TEST_EXPECT_MSG_EQ (child->GetStats ().GetNDroppedPackets (TestChildQueueDisc::BEFORE_ENQUEUE), 1,
+                         "Verify that the packets dropped for a reason are counted correctly");
+  NS_TEST_EXPECT_MSG_EQ (child->GetStats ().GetNDroppedBytes (TestChildQueueDisc::AFTER_DEQUEUE), pktSizeUnit * 3,
+                         "Verify that the bytes dropped for a reason are counted correctly");
+  NS_TEST_EXPECT_MSG_EQ (root->GetStats ().GetNDroppedPackets (rootDbe), 1,
+                         "Verify that the packets dropped by the child are counted correctly");
+  NS_TEST_EXPECT_MSG_EQ (root->GetStats ().GetNDroppedPackets (rootDad), 2,
+                         "Verify that the packets dropped by the child are counted correctly");
+  NS_TEST_EXPECT_MSG_EQ (root->GetStats ().GetNDroppedPackets (TestChildQueueDisc::AFTER_DEQUEUE), 0,
+                         "The root queue disc did not drop packets itself");
+  NS_TEST_EXPECT_MSG_EQ (root->GetStats ().GetNDroppedPackets ("Unknown reason"), 0,
+                         "No packet was dropped for a reason never used");
+  NS_TEST_EXPECT_MSG_EQ (QueueDisc::GetReason (QueueDisc::GetReasonId (rootDad.c_str ())), rootDad,
+                         "Verify that reasons are interned correctly");
+
+  std::ostringstream oss;
+  oss << root->GetStats ();
+  NS_TEST_EXPECT_MSG_NE (oss.str ().find (rootDbe + ": 1 / 500"), std::string::npos,
+                         "The statistics should report the reasons of the drops");
+  NS_TEST_EXPECT_MSG_NE (oss.str ().find (rootDad + ": 2 / 300"), std::string::npos,
+                         "The statistics should report the reasons of the drops");
+
   Simulator::Destroy ();
 }
 
@@ -515,6 +515,103 @@ RedQueueDiscTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Red Queue Disc Dequeue Marking Test Case
+ *
+ * With dequeue marking, no packet is marked or dropped early on enqueue;
+ * packets are marked on dequeue while the queue they leave behind is at least
+ * MinTh, or when their sojourn time exceeds the SojournThreshold.
+ */
+class RedDequeueMarkingTestCase : public TestCase
+{
+public:
+  RedDequeueMarkingTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Create a RED queue disc
+   * \param mode the marking mode
+   * \return the queue disc
+   */
+  Ptr<RedQueueDisc> CreateQueue (std::string mode);
+  /**
+   * Dequeue a packet
+   * \param queue the queue disc
+   */
+  void Dequeue (Ptr<RedQueueDisc> queue);
+};
+
+RedDequeueMarkingTestCase::RedDequeueMarkingTestCase ()
+  : TestCase ("Check the dequeue marking modes of the red queue disc")
+{
+}
+
+Ptr<RedQueueDisc>
+RedDequeueMarkingTestCase::CreateQueue (std::string mode)
+{
+  Ptr<RedQueueDisc> queue = CreateObject<RedQueueDisc> ();
+  queue->SetAttribute ("MinTh", DoubleValue (5));
+  queue->SetAttribute ("MaxTh", DoubleValue (15));
+  queue->SetAttribute ("QW", DoubleValue (1));
+  queue->SetAttribute ("MaxSize", QueueSizeValue (QueueSize ("30p")));
+  queue->SetAttribute ("UseEcn", BooleanValue (true));
+  queue->SetAttribute ("MarkingMode", StringValue (mode));
+  queue->SetAttribute ("SojournThreshold", TimeValue (MicroSeconds (200)));
+  queue->Initialize ();
+  return queue;
+}
+
+void
+RedDequeueMarkingTestCase::Dequeue (Ptr<RedQueueDisc> queue)
+{
+  queue->Dequeue ();
+}
+
+void
+RedDequeueMarkingTestCase::DoRun (void)
+{
+  Address dest;
+
+  // marking on the queue size left behind
+  Ptr<RedQueueDisc> queue = CreateQueue ("DequeueLength");
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      queue->Enqueue (Create<RedQueueDiscTestItem> (Create<Packet> (1000), dest, true));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().nTotalMarkedPackets, 0, "There should be no marks on enqueue");
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      queue->Dequeue ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNMarkedPackets (RedQueueDisc::DEQUEUE_LENGTH_MARK), 15,
+                         "The packets leaving at least MinTh packets behind should be marked");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().nTotalMarkedPackets, 15, "There should only be dequeue marks");
+
+  // packets which are not ECN capable are only dropped when the queue is full
+  for (uint32_t i = 0; i < 31; i++)
+    {
+      queue->Enqueue (Create<RedQueueDiscTestItem> (Create<Packet> (1000), dest, false));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().nTotalDroppedPackets, 1, "Only the packet exceeding the limit should be dropped");
+
+  // marking on the sojourn time
+  queue = CreateQueue ("DequeueSojourn");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      queue->Enqueue (Create<RedQueueDiscTestItem> (Create<Packet> (1000), dest, true));
+    }
+  Simulator::Schedule (MicroSeconds (100), &RedDequeueMarkingTestCase::Dequeue, this, queue);
+  Simulator::Schedule (MicroSeconds (300), &RedDequeueMarkingTestCase::Dequeue, this, queue);
+  Simulator::Schedule (MicroSeconds (400), &RedDequeueMarkingTestCase::Dequeue, this, queue);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().GetNMarkedPackets (RedQueueDisc::DEQUEUE_SOJOURN_MARK), 2,
+                         "The packets queued for more than 200us should be marked");
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -528,5 +625,6 @@ public:
     : TestSuite ("red-queue-disc", UNIT)
   {
     AddTestCase (new RedQueueDiscTestCase (), TestCase::QUICK);
+    AddTestCase (new RedDequeueMarkingTestCase (), TestCase::QUICK);
   }
 } g_redQueueTestSuite; ///< the test suite
@@ -0,0 +1,380 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/shared-buffer.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/double.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Shared Buffer Test Item
+ */
+class SharedBufferTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param addr the address
+   */
+  SharedBufferTestItem (Ptr<Packet> p, const Address & addr);
+  virtual ~SharedBufferTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+
+private:
+  SharedBufferTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  SharedBufferTestItem (const SharedBufferTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  SharedBufferTestItem &operator = (const SharedBufferTestItem &);
+};
+
+SharedBufferTestItem::SharedBufferTestItem (Ptr<Packet> p, const Address & addr)
+  : QueueDiscItem (p, addr, 0)
+{
+}
+
+SharedBufferTestItem::~SharedBufferTestItem ()
+{
+}
+
+void
+SharedBufferTestItem::AddHeader (void)
+{
+}
+
+bool
+SharedBufferTestItem::Mark (void)
+{
+  return true;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Shared Buffer Test Case
+ *
+ * Two fifo queue discs draw from a 10000-byte shared buffer. The test checks
+ * the Dynamic Threshold admission of each port and priority, the ECN marking
+ * on port and pool occupancy (but not of the packets dropped by a queue
+ * disc), and the occupancy trace.
+ */
+class SharedBufferTestCase : public TestCase
+{
+public:
+  SharedBufferTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Create a fifo queue disc attached to the given buffer
+   * \param buffer the shared buffer
+   * \return the queue disc
+   */
+  Ptr<FifoQueueDisc> CreateQueueDisc (Ptr<SharedBuffer> buffer);
+  /**
+   * Enqueue 1000-byte packets until one is not admitted
+   * \param q the queue disc
+   * \param priority the priority of the packets
+   * \return the number of packets admitted
+   */
+  uint32_t Fill (Ptr<FifoQueueDisc> q, uint8_t priority);
+  /**
+   * Trace the occupancy of the pool
+   * \param oldValue the old value
+   * \param newValue the new value
+   */
+  void Occupancy (uint32_t oldValue, uint32_t newValue);
+
+  uint32_t m_maxOccupancy {0}; //!< Highest occupancy of the pool
+};
+
+SharedBufferTestCase::SharedBufferTestCase ()
+  : TestCase ("Sanity check on the shared buffer implementation")
+{
+}
+
+Ptr<FifoQueueDisc>
+SharedBufferTestCase::CreateQueueDisc (Ptr<SharedBuffer> buffer)
+{
+  Ptr<FifoQueueDisc> q = CreateObject<FifoQueueDisc> ();
+  q->SetMaxSize (QueueSize ("1000p"));
+  q->SetSharedBuffer (buffer);
+  q->Initialize ();
+  return q;
+}
+
+uint32_t
+SharedBufferTestCase::Fill (Ptr<FifoQueueDisc> q, uint8_t priority)
+{
+  uint32_t admitted = 0;
+  Address dest;
+  while (admitted < 100)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      SocketPriorityTag priorityTag;
+      priorityTag.SetPriority (priority);
+      p->AddPacketTag (priorityTag);
+      if (!q->Enqueue (Create<SharedBufferTestItem> (p, dest)))
+        {
+          break;
+        }
+      admitted++;
+    }
+  return admitted;
+}
+
+void
+SharedBufferTestCase::Occupancy (uint32_t oldValue, uint32_t newValue)
+{
+  m_maxOccupancy = std::max (m_maxOccupancy, newValue);
+}
+
+void
+SharedBufferTestCase::DoRun (void)
+{
+  Ptr<SharedBuffer> buffer = CreateObject<SharedBuffer> ();
+  buffer->SetAttribute ("Size", QueueSizeValue (QueueSize ("10000B")));
+  buffer->SetAttribute ("Alpha", DoubleValue (1));
+  buffer->TraceConnectWithoutContext ("Occupancy", MakeCallback (&SharedBufferTestCase::Occupancy, this));
+  Ptr<FifoQueueDisc> q0 = CreateQueueDisc (buffer);
+  Ptr<FifoQueueDisc> q1 = CreateQueueDisc (buffer);
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetNPorts (), 2, "Two ports should draw from the buffer");
+
+  // A port alone gets alpha / (1 + alpha) of the pool
+  NS_TEST_EXPECT_MSG_EQ (Fill (q0, 0), 5, "The first port should store 5 packets");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetPortOccupancy (0), 5000, "Wrong occupancy of the first port");
+  NS_TEST_EXPECT_MSG_EQ (q0->GetStats ().GetNDroppedPackets (QueueDisc::SHARED_BUFFER_DROP), 1,
+                         "One packet should have been refused");
+
+  // The second port gets alpha times the remaining free space
+  NS_TEST_EXPECT_MSG_EQ (Fill (q1, 0), 3, "The second port should store 3 packets");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetOccupancy (), 8000, "Wrong occupancy of the pool");
+
+  // Dequeuing frees space for the first port
+  q0->Dequeue ();
+  q0->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetOccupancy (), 6000, "Dequeued packets should be released");
+  NS_TEST_EXPECT_MSG_EQ (Fill (q0, 0), 1, "The first port should store one more packet");
+  NS_TEST_EXPECT_MSG_EQ (m_maxOccupancy, 8000, "Wrong peak occupancy of the pool");
+
+  // Each priority has its own threshold
+  buffer->SetAlpha (1, 0.5);
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetThreshold (1), 1500, "Wrong threshold of priority 1");
+  NS_TEST_EXPECT_MSG_EQ (Fill (q1, 1), 1, "The second port should store 1 packet of priority 1");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetPortOccupancy (1, 1), 1000, "Wrong occupancy of priority 1");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetPortOccupancy (1), 4000, "Wrong occupancy of the second port");
+
+  while (q0->Dequeue ())
+    {
+    }
+  while (q1->Dequeue ())
+    {
+    }
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetOccupancy (), 0, "The pool should be empty");
+
+  // Marking on the occupancy of the port and of the pool
+  buffer->SetAttribute ("PortMarkThreshold", QueueSizeValue (QueueSize ("2000B")));
+  NS_TEST_EXPECT_MSG_EQ (Fill (q0, 0), 5, "The first port should store 5 packets");
+  NS_TEST_EXPECT_MSG_EQ (q0->GetStats ().GetNMarkedPackets (QueueDisc::SHARED_BUFFER_MARK), 3,
+                         "Packets admitted above the port threshold should be marked");
+  buffer->SetAttribute ("PortMarkThreshold", QueueSizeValue (QueueSize ("0B")));
+  buffer->SetAttribute ("SharedMarkThreshold", QueueSizeValue (QueueSize ("6000B")));
+  NS_TEST_EXPECT_MSG_EQ (Fill (q1, 0), 3, "The second port should store 3 packets");
+  NS_TEST_EXPECT_MSG_EQ (q1->GetStats ().GetNMarkedPackets (QueueDisc::SHARED_BUFFER_MARK), 2,
+                         "Packets admitted above the pool threshold should be marked");
+
+  // Shrinking the pool below its occupancy leaves no free space
+  buffer->SetAttribute ("Size", QueueSizeValue (QueueSize ("4000B")));
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetThreshold (0), 0, "A full pool should have no free space");
+  NS_TEST_EXPECT_MSG_EQ (Fill (q0, 0), 0, "No packet should be admitted in a shrunk pool");
+
+  // Packets admitted by the buffer but dropped by the queue disc are not marked
+  Ptr<SharedBuffer> markBuffer = CreateObject<SharedBuffer> ();
+  markBuffer->SetAttribute ("Size", QueueSizeValue (QueueSize ("10000B")));
+  markBuffer->SetAttribute ("PortMarkThreshold", QueueSizeValue (QueueSize ("1000B")));
+  Ptr<FifoQueueDisc> q2 = CreateQueueDisc (markBuffer);
+  q2->SetMaxSize (QueueSize ("3p"));
+  NS_TEST_EXPECT_MSG_EQ (Fill (q2, 0), 3, "The queue disc should store 3 packets");
+  NS_TEST_EXPECT_MSG_EQ (q2->GetStats ().nTotalDroppedPacketsBeforeEnqueue, 1,
+                         "The fourth packet should have been dropped by the queue disc");
+  NS_TEST_EXPECT_MSG_EQ (q2->GetStats ().GetNMarkedPackets (QueueDisc::SHARED_BUFFER_MARK), 2,
+                         "Dropped packets should not be marked");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Shared Buffer PFC Test Case
+ *
+ * A fifo queue disc draws from a shared buffer doing PFC with XOFF and XON
+ * thresholds of 3000 and 1000 bytes. The test checks that the packets are
+ * accounted per ingress device and priority, that a pause is sent when XOFF
+ * is reached and refreshed while the priority stays paused, and that a
+ * resume is sent when the bytes fall to XON.
+ */
+class SharedBufferPfcTestCase : public TestCase
+{
+public:
+  SharedBufferPfcTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Enqueue a 1000-byte packet
+   * \param q the queue disc
+   * \param ifIndex the ingress device, if tagged
+   * \param priority the priority of the packet
+   * \param tagged whether the packet has an ingress device
+   */
+  void Enqueue (Ptr<FifoQueueDisc> q, uint32_t ifIndex, uint8_t priority, bool tagged = true);
+  /**
+   * Trace the PFC frames
+   * \param ifIndex the ingress device
+   * \param priority the priority
+   * \param pause whether the frame is a pause
+   */
+  void Pfc (uint32_t ifIndex, uint8_t priority, bool pause);
+
+  uint32_t m_nPauses {0};   //!< Number of pause frames
+  uint32_t m_nResumes {0};  //!< Number of resume frames
+};
+
+SharedBufferPfcTestCase::SharedBufferPfcTestCase ()
+  : TestCase ("Sanity check on the PFC of the shared buffer")
+{
+}
+
+void
+SharedBufferPfcTestCase::Enqueue (Ptr<FifoQueueDisc> q, uint32_t ifIndex, uint8_t priority, bool tagged)
+{
+  Address dest;
+  Ptr<Packet> p = Create<Packet> (1000);
+  SocketPriorityTag priorityTag;
+  priorityTag.SetPriority (priority);
+  p->AddPacketTag (priorityTag);
+  if (tagged)
+    {
+      IngressDeviceTag ingressTag (ifIndex);
+      p->AddPacketTag (ingressTag);
+    }
+  q->Enqueue (Create<SharedBufferTestItem> (p, dest));
+}
+
+void
+SharedBufferPfcTestCase::Pfc (uint32_t ifIndex, uint8_t priority, bool pause)
+{
+  NS_TEST_EXPECT_MSG_EQ (ifIndex, 1, "Only device 1 should be paused");
+  NS_TEST_EXPECT_MSG_EQ (+priority, 3, "Only priority 3 should be paused");
+  (pause ? m_nPauses : m_nResumes)++;
+}
+
+void
+SharedBufferPfcTestCase::DoRun (void)
+{
+  Ptr<SharedBuffer> buffer = CreateObject<SharedBuffer> ();
+  buffer->SetAttribute ("PfcXoffThreshold", QueueSizeValue (QueueSize ("3000B")));
+  buffer->SetAttribute ("PfcXonThreshold", QueueSizeValue (QueueSize ("1000B")));
+  buffer->SetAttribute ("PfcRefreshInterval", TimeValue (MicroSeconds (100)));
+  buffer->TraceConnectWithoutContext ("Pfc", MakeCallback (&SharedBufferPfcTestCase::Pfc, this));
+  NS_TEST_EXPECT_MSG_EQ (buffer->IsPfcEnabled (), true, "PFC should be enabled");
+
+  Ptr<FifoQueueDisc> q = CreateObject<FifoQueueDisc> ();
+  q->SetMaxSize (QueueSize ("1000p"));
+  q->SetSharedBuffer (buffer);
+  q->Initialize ();
+
+  // Packets of other priorities or devices, or not received from a device,
+  // are accounted separately
+  Enqueue (q, 1, 3);
+  Enqueue (q, 1, 3);
+  Enqueue (q, 1, 0);
+  Enqueue (q, 2, 3);
+  Enqueue (q, 0, 3, false);
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetIngressOccupancy (1, 3), 2000, "Wrong ingress occupancy");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetIngressOccupancy (2, 3), 1000, "Wrong ingress occupancy");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetIngressOccupancy (0, 3), 0, "Untagged packets should not be accounted");
+  NS_TEST_EXPECT_MSG_EQ (m_nPauses, 0, "No priority should be paused");
+
+  // XOFF is reached
+  Enqueue (q, 1, 3);
+  NS_TEST_EXPECT_MSG_EQ (buffer->IsPaused (1, 3), true, "Priority 3 of device 1 should be paused");
+  NS_TEST_EXPECT_MSG_EQ (m_nPauses, 1, "A pause should have been sent");
+
+  // The pause is refreshed until the bytes fall to XON
+  Simulator::Stop (MicroSeconds (250));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_nPauses, 3, "The pause should have been refreshed twice");
+
+  uint32_t nDequeued = 0;
+  while (buffer->IsPaused (1, 3))
+    {
+      Ptr<QueueDiscItem> item = q->Dequeue ();
+      IngressDeviceTag ingressTag;
+      NS_TEST_EXPECT_MSG_EQ (item->GetPacket ()->PeekPacketTag (ingressTag), false,
+                             "The ingress tag should be removed");
+      nDequeued++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (nDequeued, 2, "Priority 3 of device 1 should resume at 1000 bytes");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetIngressOccupancy (1, 3), 1000, "Wrong ingress occupancy");
+  NS_TEST_EXPECT_MSG_EQ (m_nResumes, 1, "A resume should have been sent");
+
+  Simulator::Stop (MicroSeconds (250));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_nPauses, 3, "No pause should be sent after the resume");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Shared Buffer Test Suite
+ */
+static class SharedBufferTestSuite : public TestSuite
+{
+public:
+  SharedBufferTestSuite ()
+    : TestSuite ("shared-buffer", UNIT)
+  {
+    AddTestCase (new SharedBufferTestCase (), TestCase::QUICK);
+    AddTestCase (new SharedBufferPfcTestCase (), TestCase::QUICK);
+  }
+} g_sharedBufferTestSuite; ///< the test suite
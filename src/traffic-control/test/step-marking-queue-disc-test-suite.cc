@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/step-marking-queue-disc.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Step Marking Queue Disc Test Item
+ */
+class StepMarkingQueueDiscTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param addr the address
+   * \param ecnCapable ECN capable flag
+   */
+  StepMarkingQueueDiscTestItem (Ptr<Packet> p, const Address & addr, bool ecnCapable);
+  virtual ~StepMarkingQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  /**
+   * \return true if the item was marked
+   */
+  bool IsMarked (void) const;
+
+private:
+  StepMarkingQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  StepMarkingQueueDiscTestItem (const StepMarkingQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  StepMarkingQueueDiscTestItem &operator = (const StepMarkingQueueDiscTestItem &);
+  bool m_ecnCapable;  //!< ECN capable packet?
+  bool m_marked;      //!< Marked packet?
+};
+
+StepMarkingQueueDiscTestItem::StepMarkingQueueDiscTestItem (Ptr<Packet> p, const Address & addr, bool ecnCapable)
+  : QueueDiscItem (p, addr, 0),
+    m_ecnCapable (ecnCapable),
+    m_marked (false)
+{
+}
+
+StepMarkingQueueDiscTestItem::~StepMarkingQueueDiscTestItem ()
+{
+}
+
+void
+StepMarkingQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+StepMarkingQueueDiscTestItem::Mark (void)
+{
+  m_marked = m_ecnCapable;
+  return m_ecnCapable;
+}
+
+bool
+StepMarkingQueueDiscTestItem::IsMarked (void) const
+{
+  return m_marked;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Step Marking Queue Disc Test Case
+ *
+ * Thirty packets are enqueued with a marking threshold of 20 packets. On
+ * enqueue, the last ten packets are marked; on dequeue, the first ten packets
+ * are marked, as they leave at least 20 packets behind. In the sojourn mode,
+ * the packets dequeued after the SojournThreshold are marked. Packets which
+ * are not ECN capable are neither marked nor dropped below the limit.
+ */
+class StepMarkingQueueDiscTestCase : public TestCase
+{
+public:
+  StepMarkingQueueDiscTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Create a queue disc
+   * \param mode the marking mode
+   * \return the queue disc
+   */
+  Ptr<StepMarkingQueueDisc> CreateQueue (std::string mode);
+  /**
+   * Enqueue packets
+   * \param q the queue disc
+   * \param n the number of packets
+   * \param ecnCapable ECN capable flag
+   */
+  void Enqueue (Ptr<StepMarkingQueueDisc> q, uint32_t n, bool ecnCapable);
+  /**
+   * Dequeue all the packets and record which ones are marked
+   * \param q the queue disc
+   * \return the marks of the dequeued packets, in order
+   */
+  std::vector<bool> DequeueAll (Ptr<StepMarkingQueueDisc> q);
+  /**
+   * Dequeue a packet and record whether it is marked
+   * \param q the queue disc
+   */
+  void Dequeue (Ptr<StepMarkingQueueDisc> q);
+
+  std::vector<bool> m_marks;  //!< Marks of the packets dequeued by Dequeue
+};
+
+StepMarkingQueueDiscTestCase::StepMarkingQueueDiscTestCase ()
+  : TestCase ("Sanity check on the step marking queue disc implementation")
+{
+}
+
+Ptr<StepMarkingQueueDisc>
+StepMarkingQueueDiscTestCase::CreateQueue (std::string mode)
+{
+  Ptr<StepMarkingQueueDisc> q = CreateObjectWithAttributes<StepMarkingQueueDisc> (
+    "MaxSize", StringValue ("30p"),
+    "MarkingThreshold", StringValue ("20p"),
+    "SojournThreshold", StringValue ("200us"),
+    "MarkingMode", StringValue (mode));
+  q->Initialize ();
+  return q;
+}
+
+void
+StepMarkingQueueDiscTestCase::Enqueue (Ptr<StepMarkingQueueDisc> q, uint32_t n, bool ecnCapable)
+{
+  Address dest;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      q->Enqueue (Create<StepMarkingQueueDiscTestItem> (Create<Packet> (1000), dest, ecnCapable));
+    }
+}
+
+std::vector<bool>
+StepMarkingQueueDiscTestCase::DequeueAll (Ptr<StepMarkingQueueDisc> q)
+{
+  std::vector<bool> marks;
+  Ptr<QueueDiscItem> item;
+  while ((item = q->Dequeue ()))
+    {
+      marks.push_back (DynamicCast<StepMarkingQueueDiscTestItem> (item)->IsMarked ());
+    }
+  return marks;
+}
+
+void
+StepMarkingQueueDiscTestCase::Dequeue (Ptr<StepMarkingQueueDisc> q)
+{
+  Ptr<QueueDiscItem> item = q->Dequeue ();
+  m_marks.push_back (DynamicCast<StepMarkingQueueDiscTestItem> (item)->IsMarked ());
+}
+
+void
+StepMarkingQueueDiscTestCase::DoRun (void)
+{
+  // marking on enqueue: the packets finding at least 20 packets are marked
+  Ptr<StepMarkingQueueDisc> q = CreateQueue ("EnqueueLength");
+  Enqueue (q, 31, true);
+  NS_TEST_EXPECT_MSG_EQ (q->GetStats ().GetNDroppedPackets (StepMarkingQueueDisc::LIMIT_EXCEEDED_DROP), 1,
+                         "The packet exceeding the limit should be dropped");
+  std::vector<bool> marks = DequeueAll (q);
+  NS_TEST_ASSERT_MSG_EQ (marks.size (), 30, "Unexpected number of dequeued packets");
+  for (uint32_t i = 0; i < marks.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (marks[i], (i >= 20), "Unexpected mark of packet " << i);
+    }
+
+  // marking on dequeue: the packets leaving at least 20 packets are marked
+  q = CreateQueue ("DequeueLength");
+  Enqueue (q, 30, true);
+  NS_TEST_EXPECT_MSG_EQ (q->GetStats ().nTotalMarkedPackets, 0, "There should be no marks on enqueue");
+  marks = DequeueAll (q);
+  NS_TEST_ASSERT_MSG_EQ (marks.size (), 30, "Unexpected number of dequeued packets");
+  for (uint32_t i = 0; i < marks.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (marks[i], (i < 10), "Unexpected mark of packet " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (q->GetStats ().GetNMarkedPackets (StepMarkingQueueDisc::STEP_MARK), 10,
+                         "Unexpected number of marks");
+
+  // packets which are not ECN capable are neither marked nor dropped
+  Enqueue (q, 30, false);
+  DequeueAll (q);
+  NS_TEST_EXPECT_MSG_EQ (q->GetStats ().GetNMarkedPackets (StepMarkingQueueDisc::STEP_MARK), 10,
+                         "Packets which are not ECN capable should not be marked");
+  NS_TEST_EXPECT_MSG_EQ (q->GetStats ().nTotalDroppedPackets, 0, "No packet should be dropped");
+
+  // marking on the sojourn time
+  q = CreateQueue ("DequeueSojourn");
+  Enqueue (q, 3, true);
+  Simulator::Schedule (MicroSeconds (100), &StepMarkingQueueDiscTestCase::Dequeue, this, q);
+  Simulator::Schedule (MicroSeconds (300), &StepMarkingQueueDiscTestCase::Dequeue, this, q);
+  Simulator::Schedule (MicroSeconds (400), &StepMarkingQueueDiscTestCase::Dequeue, this, q);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_marks.size (), 3, "Unexpected number of dequeued packets");
+  NS_TEST_EXPECT_MSG_EQ (m_marks[0], false, "The packet queued for 100us should not be marked");
+  NS_TEST_EXPECT_MSG_EQ (m_marks[1], true, "The packet queued for 300us should be marked");
+  NS_TEST_EXPECT_MSG_EQ (m_marks[2], true, "The packet queued for 400us should be marked");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Step Marking Queue Disc Test Suite
+ */
+static class StepMarkingQueueDiscTestSuite : public TestSuite
+{
+public:
+  StepMarkingQueueDiscTestSuite ()
+    : TestSuite ("step-marking-queue-disc", UNIT)
+  {
+    AddTestCase (new StepMarkingQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_stepMarkingQueueDiscTestSuite; ///< the test suite
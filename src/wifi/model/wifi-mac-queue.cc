@@ -72,7 +72,7 @@ WifiMacQueue::~WifiMacQueue ()
   NS_LOG_FUNCTION_NOARGS ();
 }
 
-static std::list<Ptr<WifiMacQueueItem>> g_emptyWifiMacQueue;
+static CircularBuffer<Ptr<WifiMacQueueItem> > g_emptyWifiMacQueue;
 
 const WifiMacQueue::ConstIterator WifiMacQueue::EMPTY = g_emptyWifiMacQueue.end ();
 
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the per-packet CPU cost of the
+// FqCoDel queue disc for increasing sizes of its flow table. The queue disc
+// is first loaded with 'backlog' packets of each of 'flows' IPv4 flows; then
+// 'packets' times a packet is dequeued and enqueued again, and the wall-clock
+// time per enqueue/dequeue pair is reported for each number of buckets.
+// Sample usage:  ./waf --run 'bench-fq-codel --flows=4000 --packets=5000000'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-module.h"
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+/**
+ * Run the benchmark for a given number of buckets.
+ * \param buckets the number of buckets of the flow table
+ * \param flows the number of flows
+ * \param backlog the number of packets queued for each flow
+ * \param packets the number of enqueue/dequeue pairs
+ * \param setAssociative whether the set associative hash is enabled
+ */
+static void
+RunBench (uint32_t buckets, uint32_t flows, uint32_t backlog, uint64_t packets, bool setAssociative)
+{
+  Ptr<FqCoDelQueueDisc> queueDisc = CreateObjectWithAttributes<FqCoDelQueueDisc> (
+    "Flows", UintegerValue (buckets),
+    "MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, flows * backlog + 1)),
+    "EnableSetAssociativeHash", BooleanValue (setAssociative));
+  queueDisc->SetQuantum (1500);
+  queueDisc->Initialize ();
+
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (1000);
+  hdr.SetDestination (Ipv4Address ("10.0.0.1"));
+  hdr.SetProtocol (6);
+  Address dest;
+  for (uint32_t i = 0; i < backlog; i++)
+    {
+      for (uint32_t f = 0; f < flows; f++)
+        {
+          hdr.SetSource (Ipv4Address (0x0b000000 + f));
+          queueDisc->Enqueue (Create<Ipv4QueueDiscItem> (Create<Packet> (1000), dest, 0, hdr));
+        }
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint64_t i = 0; i < packets; i++)
+    {
+      queueDisc->Enqueue (queueDisc->Dequeue ());
+    }
+  int64_t elapsed = clock.End ();
+
+  // all the flow queues are created at initialization, count those that
+  // received packets
+  uint32_t used = 0;
+  for (uint32_t i = 0; i < queueDisc->GetNQueueDiscClasses (); i++)
+    {
+      if (queueDisc->GetQueueDiscClass (i)->GetQueueDisc ()->GetStats ().nTotalReceivedPackets > 0)
+        {
+          used++;
+        }
+    }
+
+  std::cout << std::left << std::setw (8) << buckets
+            << used << " flow queues used, "
+            << packets << " packets in " << elapsed << " ms: "
+            << (packets > 0 ? 1e6 * elapsed / packets : 0) << " ns/packet"
+            << std::endl;
+
+  queueDisc->Dispose ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t flows = 1000;
+  uint32_t backlog = 4;
+  uint64_t packets = 2000000;
+  bool setAssociative = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("flows", "number of flows", flows);
+  cmd.AddValue ("backlog", "number of packets queued for each flow", backlog);
+  cmd.AddValue ("packets", "number of enqueue/dequeue pairs", packets);
+  cmd.AddValue ("setAssociative", "enable the set associative hash", setAssociative);
+  cmd.Parse (argc, argv);
+
+  std::cout << "Running bench-fq-codel with flows=" << flows << " backlog=" << backlog
+            << " packets=" << packets << std::endl;
+  for (uint32_t buckets = 1024; buckets <= 65536; buckets *= 4)
+    {
+      RunBench (buckets, flows, backlog, packets, setAssociative);
+    }
+
+  return 0;
+}
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the cost of updating the global
+// routes when links fail and are repaired. A k-ary fat-tree is built, its
+// routes are computed, and then 'failures' host links and 'failures' fabric
+// links fail and are repaired, one after the other, first with global routing
+// computing all the routes again on every interface event, then with global
+// routing updating only the routes affected by the link (IncrementalUpdates
+// attribute). The wall-clock time of the initial computation and the average
+// time of a failure or repair of a link are reported.
+// Sample usage:  ./waf --run 'bench-link-failure --k=16 --failures=10'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+/**
+ * Fail or repair a link and account for the wall-clock time spent.
+ * \param device a device attached to the link
+ * \param up whether the link is repaired
+ * \param elapsed the total time spent, in ms
+ */
+static void
+ToggleLink (Ptr<NetDevice> device, bool up, int64_t *elapsed)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+  if (up)
+    {
+      LinkFailureHelper::SetLinkUp (device);
+    }
+  else
+    {
+      LinkFailureHelper::SetLinkDown (device);
+    }
+  *elapsed += clock.End ();
+}
+
+/**
+ * Set the global routing attributes of all the nodes.
+ * \param incremental whether the routes are updated incrementally
+ */
+static void
+SetIncremental (bool incremental)
+{
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      Ptr<GlobalRouter> router = (*i)->GetObject<GlobalRouter> ();
+      if (router)
+        {
+          router->GetRoutingProtocol ()->SetAttribute ("RespondToInterfaceEvents", BooleanValue (true));
+          router->GetRoutingProtocol ()->SetAttribute ("IncrementalUpdates", BooleanValue (incremental));
+        }
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t k = 8;
+  uint32_t failures = 10;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("k", "number of ports of the fat-tree switches", k);
+  cmd.AddValue ("failures", "number of links failed and repaired in each mode", failures);
+  cmd.Parse (argc, argv);
+
+  PointToPointHelper hostLinks;
+  PointToPointHelper fabricLinks;
+  PointToPointFatTreeHelper fatTree (k, hostLinks, fabricLinks);
+  InternetStackHelper stack;
+  fatTree.InstallStack (stack);
+  fatTree.AssignIpv4Addresses (Ipv4AddressHelper ("10.0.0.0", "255.255.255.252"),
+                               Ipv4AddressHelper ("11.0.0.0", "255.255.255.252"));
+
+  std::cout << "Running bench-link-failure with k=" << k << " (" << fatTree.HostCount ()
+            << " hosts, " << fatTree.SwitchCount () << " switches)" << std::endl;
+  SystemWallClockMs clock;
+  clock.Start ();
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::cout << "  " << std::left << std::setw (33) << "initial routes" << clock.End () << " ms" << std::endl;
+
+  // fail and repair host links and fabric links spread over the fat-tree,
+  // first computing all the routes again, then updating them incrementally
+  uint32_t nHostLinks = fatTree.HostCount ();
+  uint32_t nFabricLinks = fatTree.FabricLinkCount ();
+  failures = std::min (failures, nHostLinks);
+  int64_t elapsed[2][2] = {{0, 0}, {0, 0}};
+  double t = 1;
+  for (uint32_t mode = 0; mode < 2; mode++)
+    {
+      Simulator::Schedule (Seconds (t), &SetIncremental, mode == 1);
+      for (uint32_t type = 0; type < 2; type++)
+        {
+          for (uint32_t i = 0; i < failures; i++)
+            {
+              Ptr<NetDevice> device = (type == 0
+                                       ? fatTree.GetHostLink (i * nHostLinks / failures).Get (0)
+                                       : fatTree.GetFabricLink (i * nFabricLinks / failures).Get (0));
+              Simulator::Schedule (Seconds (t + 0.1), &ToggleLink, device, false, &elapsed[mode][type]);
+              Simulator::Schedule (Seconds (t + 0.5), &ToggleLink, device, true, &elapsed[mode][type]);
+              t += 1;
+            }
+        }
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::string modes[] = {"full recomputation", "incremental update"};
+  std::string types[] = {"host link", "fabric link"};
+  for (uint32_t mode = 0; mode < 2; mode++)
+    {
+      for (uint32_t type = 0; type < 2; type++)
+        {
+          std::cout << "  " << std::left << std::setw (20) << modes[mode] << std::setw (13) << types[type]
+                    << (failures ? elapsed[mode][type] / (2.0 * failures) : 0)
+                    << " ms per failure or repair" << std::endl;
+        }
+    }
+  return 0;
+}
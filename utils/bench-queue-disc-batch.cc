@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the batch interface between queue
+// discs and devices on saturated links. 'links' point-to-point links are
+// created and the FIFO queue disc installed on the sending device of each
+// link is kept backlogged for 'duration' simulated seconds, so that the
+// device is always busy. The simulation is run once with packets sent one by
+// one to the devices and once with batches of up to 'batch' packets (the
+// device queues are woken up when there is room for a batch); the wall-clock
+// time and the number of packets per second are reported for both runs.
+// Sample usage:  ./waf --run 'bench-queue-disc-batch --links=16 --batch=32'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/traffic-control-module.h"
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+/**
+ * Top up the backlog of a queue disc and reschedule.
+ * \param tc the traffic control layer of the sending node
+ * \param dev the sending device
+ * \param qdisc the root queue disc of the sending device
+ * \param backlog the number of packets to keep in the queue disc
+ * \param packetSize the size of the packets
+ * \param interval the interval between two top ups
+ */
+static void
+TopUp (Ptr<TrafficControlLayer> tc, Ptr<NetDevice> dev, Ptr<QueueDisc> qdisc,
+       uint32_t backlog, uint32_t packetSize, Time interval)
+{
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (packetSize);
+  hdr.SetProtocol (17);
+  while (qdisc->GetNPackets () < backlog)
+    {
+      // the interface of the receiving node is down, hence packets are
+      // discarded upon reception
+      tc->Send (dev, Create<Ipv4QueueDiscItem> (Create<Packet> (packetSize),
+                                                dev->GetBroadcast (), Ipv4L3Protocol::PROT_NUMBER, hdr));
+    }
+  Simulator::Schedule (interval, &TopUp, tc, dev, qdisc, backlog, packetSize, interval);
+}
+
+/**
+ * Run the benchmark for a given batch size.
+ * \param links the number of links
+ * \param batch the maximum number of packets in a batch
+ * \param rate the rate of the links
+ * \param packetSize the size of the packets
+ * \param duration the simulated time
+ */
+static void
+RunBench (uint32_t links, uint32_t batch, DataRate rate, uint32_t packetSize, Time duration)
+{
+  Config::SetDefault ("ns3::NetDeviceQueue::WakeThreshold", UintegerValue (batch));
+
+  NodeContainer senders;
+  senders.Create (links);
+  NodeContainer receivers;
+  receivers.Create (links);
+
+  InternetStackHelper internet;
+  internet.Install (senders);
+  internet.Install (receivers);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", DataRateValue (rate));
+  p2p.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (1)));
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::FifoQueueDisc",
+                        "MaxSize", QueueSizeValue (QueueSize ("10000p")),
+                        "MaxBatchPackets", UintegerValue (batch));
+
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.0");
+  std::vector<Ptr<QueueDisc> > qdiscs;
+  Time interval = rate.CalculateBytesTxTime (packetSize * 64);
+  for (uint32_t i = 0; i < links; i++)
+    {
+      NetDeviceContainer devices = p2p.Install (senders.Get (i), receivers.Get (i));
+      QueueDiscContainer qdc = tch.Install (devices.Get (0));
+      address.Assign (devices);
+      address.NewNetwork ();
+      Ptr<Ipv4> ipv4 = receivers.Get (i)->GetObject<Ipv4> ();
+      ipv4->SetDown (ipv4->GetInterfaceForDevice (devices.Get (1)));
+      qdiscs.push_back (qdc.Get (0));
+      Simulator::Schedule (interval * i / links, &TopUp,
+                           senders.Get (i)->GetObject<TrafficControlLayer> (),
+                           devices.Get (0), qdc.Get (0), 1000, packetSize, interval);
+    }
+
+  Simulator::Stop (duration);
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  uint64_t sent = 0;
+  for (auto& q : qdiscs)
+    {
+      sent += q->GetStats ().nTotalSentPackets;
+    }
+
+  std::cout << std::left << std::setw (8) << batch
+            << sent << " packets in " << elapsed << " ms: "
+            << (elapsed > 0 ? sent / (1e3 * elapsed) : 0) << " Mpps, "
+            << (sent * packetSize * 8.0 / links / duration.GetSeconds () / 1e9)
+            << " Gbps per link" << std::endl;
+
+  Simulator::Destroy ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t links = 16;
+  uint32_t batch = 32;
+  DataRate rate ("10Gbps");
+  uint32_t packetSize = 1000;
+  Time duration = MilliSeconds (100);
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("links", "Number of saturated links", links);
+  cmd.AddValue ("batch", "Maximum number of packets in a batch", batch);
+  cmd.AddValue ("rate", "Rate of the links", rate);
+  cmd.AddValue ("packetSize", "Size of the packets", packetSize);
+  cmd.AddValue ("duration", "Simulated time", duration);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::left << std::setw (8) << "batch" << "results" << std::endl;
+  RunBench (links, 1, rate, packetSize, duration);
+  RunBench (links, batch, rate, packetSize, duration);
+
+  return 0;
+}
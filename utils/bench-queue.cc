@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the per-packet CPU cost of the
+// DropTailQueue users: the DropTailQueue<Packet> of the net devices and the
+// DropTailQueue<QueueDiscItem> internal queue of a FifoQueueDisc. For each
+// backlog, the queue is repeatedly filled with 'backlog' packets and then
+// drained, until 'packets' packets have been enqueued and dequeued, and the
+// wall-clock time per enqueue/dequeue pair is reported. The same pattern is
+// also run on the CircularBuffer backing the queues and, for reference, on
+// the std::list which used to back them.
+// Sample usage:  ./waf --run 'bench-queue --packets=10000000'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-module.h"
+#include <iostream>
+#include <iomanip>
+#include <list>
+
+using namespace ns3;
+
+/**
+ * Print the cost per packet.
+ * \param name the name of the queue
+ * \param backlog the backlog
+ * \param packets the number of enqueue/dequeue pairs
+ * \param elapsed the elapsed time in ms
+ */
+static void
+Report (std::string name, uint32_t backlog, uint64_t packets, int64_t elapsed)
+{
+  std::cout << "  " << std::left << std::setw (30) << name << std::setw (8) << backlog
+            << packets << " packets in " << elapsed << " ms: "
+            << (packets > 0 ? 1e6 * elapsed / packets : 0) << " ns/packet" << std::endl;
+}
+
+/**
+ * Run the benchmark on a DropTailQueue<Packet>.
+ * \param backlog the backlog
+ * \param packets the number of enqueue/dequeue pairs
+ * \param pool the packets to enqueue
+ */
+static void
+BenchDeviceQueue (uint32_t backlog, uint64_t packets, const std::vector<Ptr<Packet> > &pool)
+{
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetMaxSize (QueueSize (QueueSizeUnit::PACKETS, backlog));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint64_t i = 0; i < packets; i += backlog)
+    {
+      for (uint32_t j = 0; j < backlog; j++)
+        {
+          queue->Enqueue (pool[j]);
+        }
+      for (uint32_t j = 0; j < backlog; j++)
+        {
+          queue->Dequeue ();
+        }
+    }
+  Report ("DropTailQueue<Packet>", backlog, packets, clock.End ());
+}
+
+/**
+ * Run the benchmark on a FifoQueueDisc.
+ * \param backlog the backlog
+ * \param packets the number of enqueue/dequeue pairs
+ * \param pool the packets to enqueue
+ */
+static void
+BenchQueueDisc (uint32_t backlog, uint64_t packets, const std::vector<Ptr<QueueDiscItem> > &pool)
+{
+  Ptr<FifoQueueDisc> queueDisc = CreateObjectWithAttributes<FifoQueueDisc> (
+    "MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, backlog)));
+  queueDisc->Initialize ();
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint64_t i = 0; i < packets; i += backlog)
+    {
+      for (uint32_t j = 0; j < backlog; j++)
+        {
+          queueDisc->Enqueue (pool[j]);
+        }
+      for (uint32_t j = 0; j < backlog; j++)
+        {
+          queueDisc->Dequeue ();
+        }
+    }
+  Report ("FifoQueueDisc", backlog, packets, clock.End ());
+  queueDisc->Dispose ();
+}
+
+/**
+ * Run the benchmark on a std::list.
+ * \param backlog the backlog
+ * \param packets the number of enqueue/dequeue pairs
+ * \param pool the packets to enqueue
+ */
+static void
+BenchList (uint32_t backlog, uint64_t packets, const std::vector<Ptr<Packet> > &pool)
+{
+  std::list<Ptr<Packet> > list;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint64_t i = 0; i < packets; i += backlog)
+    {
+      for (uint32_t j = 0; j < backlog; j++)
+        {
+          list.push_back (pool[j]);
+        }
+      for (uint32_t j = 0; j < backlog; j++)
+        {
+          list.pop_front ();
+        }
+    }
+  Report ("std::list<Ptr<Packet> >", backlog, packets, clock.End ());
+}
+
+/**
+ * Run the benchmark on a CircularBuffer, the container backing the queues.
+ * \param backlog the backlog
+ * \param packets the number of enqueue/dequeue pairs
+ * \param pool the packets to enqueue
+ */
+static void
+BenchCircularBuffer (uint32_t backlog, uint64_t packets, const std::vector<Ptr<Packet> > &pool)
+{
+  CircularBuffer<Ptr<Packet> > buffer;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint64_t i = 0; i < packets; i += backlog)
+    {
+      for (uint32_t j = 0; j < backlog; j++)
+        {
+          buffer.push_back (pool[j]);
+        }
+      for (uint32_t j = 0; j < backlog; j++)
+        {
+          buffer.pop_front ();
+        }
+    }
+  Report ("CircularBuffer<Ptr<Packet> >", backlog, packets, clock.End ());
+}
+
+int main (int argc, char *argv[])
+{
+  uint64_t packets = 10000000;
+  uint32_t maxBacklog = 4096;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("packets", "number of enqueue/dequeue pairs", packets);
+  cmd.AddValue ("maxBacklog", "maximum backlog", maxBacklog);
+  cmd.Parse (argc, argv);
+
+  std::vector<Ptr<Packet> > packetPool;
+  std::vector<Ptr<QueueDiscItem> > itemPool;
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (1000);
+  for (uint32_t i = 0; i < maxBacklog; i++)
+    {
+      packetPool.push_back (Create<Packet> (1000));
+      itemPool.push_back (Create<Ipv4QueueDiscItem> (packetPool.back (), Address (), 0, hdr));
+    }
+
+  std::cout << "Running bench-queue with packets=" << packets << std::endl;
+  for (uint32_t backlog = 1; backlog <= maxBacklog; backlog *= 16)
+    {
+      BenchDeviceQueue (backlog, packets, packetPool);
+      BenchQueueDisc (backlog, packets, itemPool);
+      BenchCircularBuffer (backlog, packets, packetPool);
+      BenchList (backlog, packets, packetPool);
+    }
+
+  return 0;
+}
@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the time needed to set up a large
+// topology before the simulation starts. 'hosts' hosts are connected to
+// 'switches' switches, which are connected in a ring, either by
+// point-to-point links or by simple links (whose devices need ARP). The
+// Internet stack is installed on all the nodes and every link is assigned
+// its own network, either by calling Ipv4AddressHelper::AssignLinks for all
+// the links at once or by calling Ipv4AddressHelper::Assign for each link.
+// The switches can get either the full Internet stack or only the
+// forwarding components (InternetStackHelper::SetForwardingOnly).
+// The wall-clock time and the growth of the resident memory of each phase
+// of the setup (including the initialization of the nodes at the beginning
+// of the simulation) are reported, together with the memory per node of the
+// installation of the Internet stack. The resident memory is read from
+// /proc/self/statm and is not reported on systems lacking it. A single
+// setup is run by each invocation, so that results are not biased by the
+// memory allocated by a previous run.
+// Sample usage:  ./waf --run 'bench-startup --hosts=10000 --switches=400'
+//                ./waf --run 'bench-startup --switches=10000 --forwardingOnly=true'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * Get the resident memory of the process.
+ * \returns the resident memory in bytes, or 0 if it is not available
+ */
+static uint64_t
+GetResidentMemory (void)
+{
+  std::ifstream statm ("/proc/self/statm");
+  uint64_t size = 0;
+  uint64_t resident = 0;
+  if (!(statm >> size >> resident))
+    {
+      return 0;
+    }
+  return resident * sysconf (_SC_PAGESIZE);
+}
+
+/**
+ * Print the time spent and the memory allocated in a phase, and restart
+ * the clock.
+ * \param clock the clock
+ * \param memory the resident memory at the beginning of the phase, updated
+ *        to the resident memory at the end of the phase
+ * \param phase the name of the phase
+ * \param nodes the number of nodes set up by the phase, to report the
+ *        memory per node (0 to omit it)
+ * \returns the time spent in the phase
+ */
+static int64_t
+Report (SystemWallClockMs &clock, uint64_t &memory, std::string phase, uint32_t nodes = 0)
+{
+  int64_t elapsed = clock.End ();
+  std::cout << "  " << std::left << std::setw (20) << phase << std::setw (10)
+            << (std::to_string (elapsed) + " ms");
+  uint64_t current = GetResidentMemory ();
+  if (current > 0)
+    {
+      uint64_t growth = (current > memory ? current - memory : 0);
+      std::cout << "+" << growth / 1024 << " KiB";
+      if (nodes > 0)
+        {
+          std::cout << " (" << growth / nodes << " bytes/node)";
+        }
+      memory = current;
+    }
+  std::cout << std::endl;
+  clock.Start ();
+  return elapsed;
+}
+
+/**
+ * Run the benchmark.
+ * \param hosts the number of hosts
+ * \param switches the number of switches
+ * \param simple whether to use simple links
+ * \param bulk whether to assign the addresses of all the links at once
+ * \param forwardingOnly whether to install only the forwarding components
+ *        of the Internet stack on the switches
+ */
+static void
+RunBench (uint32_t hosts, uint32_t switches, bool simple, bool bulk, bool forwardingOnly)
+{
+  uint64_t memory = GetResidentMemory ();
+  uint64_t initial = memory;
+  SystemWallClockMs clock;
+  clock.Start ();
+  int64_t total = 0;
+
+  NodeContainer hostNodes;
+  hostNodes.Create (hosts);
+  NodeContainer switchNodes;
+  switchNodes.Create (switches);
+
+  PointToPointHelper p2p;
+  SimpleNetDeviceHelper simpleHelper;
+  NetDeviceContainer links;
+  for (uint32_t i = 0; i < hosts + switches; i++)
+    {
+      Ptr<Node> a = (i < hosts ? hostNodes.Get (i) : switchNodes.Get (i - hosts));
+      Ptr<Node> b = (i < hosts ? switchNodes.Get (i % switches)
+                               : switchNodes.Get ((i - hosts + 1) % switches));
+      links.Add (simple ? simpleHelper.Install (NodeContainer (a, b)) : p2p.Install (a, b));
+    }
+  total += Report (clock, memory, "Nodes and links");
+
+  InternetStackHelper stack;
+  stack.Install (hostNodes);
+  total += Report (clock, memory, "Hosts stack", hosts);
+  InternetStackHelper switchStack;
+  switchStack.SetForwardingOnly (forwardingOnly);
+  switchStack.Install (switchNodes);
+  total += Report (clock, memory, "Switches stack", switches);
+
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  if (bulk)
+    {
+      address.AssignLinks (links, 2);
+    }
+  else
+    {
+      for (uint32_t i = 0; i < links.GetN (); i += 2)
+        {
+          address.Assign (NetDeviceContainer (links.Get (i), links.Get (i + 1)));
+          address.NewNetwork ();
+        }
+    }
+  total += Report (clock, memory, "IPv4 addresses");
+
+  Simulator::Stop (Seconds (0));
+  Simulator::Run ();
+  total += Report (clock, memory, "Initialization");
+  std::cout << "  " << std::left << std::setw (20) << "Total" << std::setw (10)
+            << (std::to_string (total) + " ms");
+  if (memory > 0)
+    {
+      std::cout << "+" << (memory > initial ? memory - initial : 0) / 1024 << " KiB";
+    }
+  std::cout << std::endl;
+
+  Simulator::Destroy ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t hosts = 10000;
+  uint32_t switches = 400;
+  bool simple = false;
+  bool bulk = true;
+  bool forwardingOnly = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("hosts", "Number of hosts", hosts);
+  cmd.AddValue ("switches", "Number of switches", switches);
+  cmd.AddValue ("simple", "Use simple links instead of point-to-point links", simple);
+  cmd.AddValue ("bulk", "Assign the addresses of all the links at once", bulk);
+  cmd.AddValue ("forwardingOnly", "Install only the forwarding components on the switches", forwardingOnly);
+  cmd.Parse (argc, argv);
+
+  std::cout << hosts << " hosts, " << switches << " switches, "
+            << (simple ? "simple" : "point-to-point") << " links, "
+            << (bulk ? "Ipv4AddressHelper::AssignLinks" : "Ipv4AddressHelper::Assign per link")
+            << (forwardingOnly ? ", forwarding-only switches" : "")
+            << std::endl;
+  RunBench (hosts, switches, simple, bulk, forwardingOnly);
+
+  return 0;
+}
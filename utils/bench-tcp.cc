@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the per-segment CPU cost of TCP.
+// A single bulk transfer of 'bytes' bytes runs over a point-to-point
+// SimpleNetDevice link, once with the TcpSocketBase header prediction fast
+// path disabled and once with it enabled, and the wall-clock time per
+// received segment is reported for each run.
+// Sample usage:  ./waf --run 'bench-tcp --bytes=100000000'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+/// Bytes still to be written by the sender
+static uint64_t g_toSend = 0;
+/// Data segments received by the receiver
+static uint64_t g_segments = 0;
+
+/**
+ * Fill the Tx buffer of the sender.
+ * \param sock the sender socket
+ * \param available the available Tx buffer space
+ */
+static void
+SenderSend (Ptr<Socket> sock, uint32_t available)
+{
+  while (g_toSend > 0 && sock->GetTxAvailable () > 0)
+    {
+      uint32_t toSend = static_cast<uint32_t> (std::min<uint64_t> (g_toSend, sock->GetTxAvailable ()));
+      int sent = sock->Send (Create<Packet> (toSend));
+      if (sent <= 0)
+        {
+          break;
+        }
+      g_toSend -= sent;
+    }
+}
+
+/**
+ * Connect the sender and start the transfer.
+ * \param sock the sender socket
+ * \param remote the address of the receiver
+ */
+static void
+StartTransfer (Ptr<Socket> sock, Address remote)
+{
+  sock->Connect (remote);
+  SenderSend (sock, sock->GetTxAvailable ());
+}
+
+/**
+ * Drain the receiver socket.
+ * \param sock the receiver socket
+ */
+static void
+ReceiverRecv (Ptr<Socket> sock)
+{
+  Ptr<Packet> p;
+  while ((p = sock->Recv ()) && p->GetSize () > 0)
+    {
+    }
+}
+
+/**
+ * Accept a connection on the receiver.
+ * \param sock the new socket
+ * \param from the address of the peer
+ */
+static void
+ReceiverAccept (Ptr<Socket> sock, const Address &from)
+{
+  sock->SetRecvCallback (MakeCallback (&ReceiverRecv));
+}
+
+/**
+ * Count the data segments received by the IPv4 layer.
+ * \param p the packet
+ * \param ipv4 the IPv4 object
+ * \param interface the interface
+ */
+static void
+IpRx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (p->GetSize () > 100)
+    {
+      g_segments++;
+    }
+}
+
+/**
+ * Run a bulk transfer and report the cost per segment.
+ * \param bytes the bytes to transfer
+ * \param headerPrediction whether the fast path is enabled
+ */
+static void
+RunBench (uint64_t bytes, bool headerPrediction)
+{
+  g_toSend = bytes;
+  g_segments = 0;
+  Config::SetDefault ("ns3::TcpSocketBase::HeaderPrediction", BooleanValue (headerPrediction));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simple;
+  simple.SetNetDevicePointToPointMode (true);
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Gbps")));
+  simple.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (10)));
+  NetDeviceContainer devices = simple.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  nodes.Get (1)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Rx",
+                                                                          MakeCallback (&IpRx));
+
+  Ptr<Socket> receiver = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  receiver->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  receiver->Listen ();
+  receiver->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                               MakeCallback (&ReceiverAccept));
+
+  Ptr<Socket> sender = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  sender->SetSendCallback (MakeCallback (&SenderSend));
+  Simulator::Schedule (MilliSeconds (1), &StartTransfer, sender,
+                       InetSocketAddress (interfaces.GetAddress (1), 5000));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+  Simulator::Destroy ();
+
+  std::cout << std::left << std::setw (18)
+            << (headerPrediction ? "header prediction" : "slow path")
+            << g_segments << " segments in " << elapsed << " ms: "
+            << (g_segments > 0 ? 1e6 * elapsed / g_segments : 0) << " ns/segment"
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint64_t bytes = 50000000;
+  uint32_t segmentSize = 1448;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("bytes", "number of bytes to transfer", bytes);
+  cmd.AddValue ("segmentSize", "TCP segment size", segmentSize);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (segmentSize));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 22));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 22));
+
+  std::cout << "Running bench-tcp with bytes=" << bytes << std::endl;
+  RunBench (bytes, false);
+  RunBench (bytes, true);
+
+  return 0;
+}